@@ -0,0 +1,94 @@
+#include "BenchHarness.h"
+#include <QElapsedTimer>
+#include <QJsonObject>
+
+namespace {
+
+volatile qint64 g_sink = 0;
+
+} // namespace
+
+BenchContext::BenchContext(const QString& name, int iterationOverride, const QString& fixturesDirectory)
+    : m_name(name)
+    , m_iterationOverride(iterationOverride)
+    , m_fixturesDirectory(fixturesDirectory)
+    , m_totalNs(0)
+    , m_itemsPerIteration(0)
+    , m_bytesPerIteration(0)
+{
+}
+
+void BenchContext::measure(int iterations, const std::function<void()>& body, int warmup,
+                           const std::function<void()>& setup) {
+    if (m_iterationOverride > 0) {
+        iterations = m_iterationOverride;
+    }
+    for (int i = 0; i < warmup; ++i) {
+        if (setup) {
+            setup();
+        }
+        body();
+    }
+
+    QElapsedTimer timer;
+    for (int i = 0; i < iterations; ++i) {
+        if (setup) {
+            setup();
+        }
+        timer.start();
+        body();
+        const qint64 elapsedNs = timer.nsecsElapsed();
+        m_samples.record(elapsedNs);
+        m_totalNs += elapsedNs;
+    }
+}
+
+void BenchContext::setItemsPerIteration(qint64 items) {
+    m_itemsPerIteration = items;
+}
+
+void BenchContext::setBytesPerIteration(qint64 bytes) {
+    m_bytesPerIteration = bytes;
+}
+
+void BenchContext::setParameter(const QString& key, const QJsonValue& value) {
+    m_parameters[key] = value;
+}
+
+void BenchContext::addMetric(const QString& key, double value) {
+    m_metrics[key] = value;
+}
+
+void BenchContext::skip(const QString& reason) {
+    m_skipReason = reason;
+}
+
+QJsonObject BenchContext::toJson() const {
+    QJsonObject json;
+    json["name"] = m_name;
+    if (isSkipped()) {
+        json["skipped"] = m_skipReason;
+        return json;
+    }
+
+    json["iterations"] = static_cast<double>(m_samples.count());
+    json["timeNs"] = m_samples.toJson();
+    const double seconds = m_totalNs / 1e9;
+    if (seconds > 0.0 && m_itemsPerIteration > 0) {
+        json["itemsPerSecond"] = m_itemsPerIteration * static_cast<double>(m_samples.count()) / seconds;
+    }
+    if (seconds > 0.0 && m_bytesPerIteration > 0) {
+        json["bytesPerSecond"] = m_bytesPerIteration * static_cast<double>(m_samples.count()) / seconds;
+    }
+    if (!m_parameters.isEmpty()) {
+        json["parameters"] = m_parameters;
+    }
+    if (!m_metrics.isEmpty()) {
+        json["metrics"] = m_metrics;
+    }
+    return json;
+}
+
+void BenchContext::consume(qint64 value) {
+    g_sink = g_sink + value;
+}
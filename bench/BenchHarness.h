@@ -0,0 +1,69 @@
+#pragma once
+
+#include "services/Telemetry.h"
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <functional>
+
+/**
+ * @brief One benchmark's run: timed samples, throughput and whatever else it reports
+ *
+ * Every call of the measured body is one sample, timed in nanoseconds into a
+ * LatencyHistogram, so results carry p50/p95/p99 the same way the app's telemetry
+ * does. Inputs come from fixed seeds and fixed sizes, so two builds run the same
+ * work and their JSON can be compared line by line.
+ */
+class BenchContext {
+public:
+    BenchContext(const QString& name, int iterationOverride, const QString& fixturesDirectory);
+
+    // @p warmup untimed calls first; --iterations replaces @p iterations when given.
+    // @p setup runs before every call of @p body, outside the timing
+    void measure(int iterations, const std::function<void()>& body, int warmup = DEFAULT_WARMUP,
+                 const std::function<void()>& setup = {});
+
+    // Work done by one call of the body, for the throughput figures
+    void setItemsPerIteration(qint64 items);
+    void setBytesPerIteration(qint64 bytes);
+
+    void setParameter(const QString& key, const QJsonValue& value);
+    void addMetric(const QString& key, double value);
+    void skip(const QString& reason);
+
+    QString name() const { return m_name; }
+    QString fixturesDirectory() const { return m_fixturesDirectory; }
+    bool isSkipped() const { return !m_skipReason.isEmpty(); }
+    const LatencyHistogram& samples() const { return m_samples; }
+
+    QJsonObject toJson() const;
+
+    // Keeps the compiler from dropping work whose result is otherwise unused
+    static void consume(qint64 value);
+
+    static constexpr int DEFAULT_WARMUP = 3;
+
+private:
+    QString m_name;
+    int m_iterationOverride;
+    QString m_fixturesDirectory;
+    LatencyHistogram m_samples;
+    qint64 m_totalNs;
+    qint64 m_itemsPerIteration;
+    qint64 m_bytesPerIteration;
+    QJsonObject m_parameters;
+    QJsonObject m_metrics;
+    QString m_skipReason;
+};
+
+struct Benchmark {
+    QString name; // "area/what/variant"
+    std::function<void(BenchContext&)> run;
+};
+using BenchmarkList = QList<Benchmark>;
+
+void addAudioBenchmarks(BenchmarkList& benchmarks);
+void addStorageBenchmarks(BenchmarkList& benchmarks);
+void addEnhancementBenchmarks(BenchmarkList& benchmarks);
+void addTextBenchmarks(BenchmarkList& benchmarks);
+void addWhisperBenchmarks(BenchmarkList& benchmarks);
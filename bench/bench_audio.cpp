@@ -0,0 +1,143 @@
+#include "BenchHarness.h"
+#include "services/AudioLevelAnalyzer.h"
+#include "services/AudioLevelIODevice.h"
+#include "services/RecordingFileWriter.h"
+#include <QFile>
+#include <QMetaObject>
+#include <QTemporaryDir>
+#include <cmath>
+#include <random>
+
+namespace {
+
+constexpr int SAMPLE_RATE = 48000;
+constexpr int CHUNK_MS = 10;          // What QAudioSource typically hands over at once
+constexpr int WRITER_SECONDS = 60;    // Audio per writer iteration
+
+AudioFileReader::Format captureFormat(int channels, bool isFloat) {
+    AudioFileReader::Format format;
+    format.sampleRate = SAMPLE_RATE;
+    format.channelCount = channels;
+    format.bytesPerSample = isFloat ? 4 : 2;
+    format.isFloat = isFloat;
+    return format;
+}
+
+// Noise shaped like speech levels: a quiet floor with louder bursts; same for every run
+QByteArray makeAudio(const AudioFileReader::Format& format, int milliseconds) {
+    const qint64 frames = static_cast<qint64>(format.sampleRate) * milliseconds / 1000;
+    QByteArray data(frames * format.channelCount * format.bytesPerSample, Qt::Uninitialized);
+    std::mt19937 generator(42);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    for (qint64 frame = 0; frame < frames; ++frame) {
+        const bool burst = (frame / (format.sampleRate / 4)) % 3 != 0;
+        for (int channel = 0; channel < format.channelCount; ++channel) {
+            const float value = qBound(-1.0f, noise(generator) * (burst ? 0.2f : 0.01f), 1.0f);
+            const qint64 index = frame * format.channelCount + channel;
+            if (format.isFloat) {
+                reinterpret_cast<float*>(data.data())[index] = value;
+            } else {
+                reinterpret_cast<qint16*>(data.data())[index] = static_cast<qint16>(std::lround(value * 32767.0f));
+            }
+        }
+    }
+    return data;
+}
+
+void benchLevelAnalyze(BenchContext& context, const AudioFileReader::Format& format) {
+    const QByteArray chunk = makeAudio(format, CHUNK_MS);
+    context.setParameter("kernel", AudioLevelAnalyzer::activeKernel());
+    context.setParameter("chunkMs", CHUNK_MS);
+    context.setBytesPerIteration(chunk.size());
+    context.measure(20000, [&]() {
+        const AudioLevelStats stats = AudioLevelAnalyzer::analyze(chunk.constData(), chunk.size(), format);
+        BenchContext::consume(stats.clippedSamples);
+    });
+}
+
+// One drain tick's worth of capture: the audio thread's writes, then the tick itself
+void benchIoDeviceTick(BenchContext& context, bool processing) {
+    QTemporaryDir directory;
+    QFile file(directory.filePath("capture.wav"));
+    const AudioFileReader::Format format = captureFormat(1, false);
+    AudioLevelIODevice device(&file);
+    device.setAudioFormat(format.sampleRate, format.channelCount, format.bytesPerSample, format.isFloat);
+    device.setFileCodec(AudioCodec::Pcm);
+    device.setNoiseReduction(processing);
+    device.setAutoGainControl(processing);
+    if (!device.open(QIODevice::WriteOnly)) {
+        context.skip("Cannot open the capture device: " + device.errorString());
+        return;
+    }
+
+    constexpr int chunksPerTick = 3; // NOTIFY_INTERVAL_MS of 10 ms chunks
+    const QByteArray chunk = makeAudio(format, CHUNK_MS);
+    context.setParameter("processing", processing);
+    context.setBytesPerIteration(chunk.size() * chunksPerTick);
+    context.measure(2000, [&]() {
+        for (int i = 0; i < chunksPerTick; ++i) {
+            device.write(chunk);
+        }
+        QMetaObject::invokeMethod(&device, "drainRingBuffer", Qt::DirectConnection);
+    });
+    BenchContext::consume(static_cast<qint64>(device.getCurrentLevel() * 1000));
+    device.close();
+}
+
+// Start to finish(), including the flush, so the figure is what reaches the disk
+void benchWriter(BenchContext& context, AudioCodec codec) {
+    QTemporaryDir directory;
+    const AudioFileReader::Format format = captureFormat(1, false);
+    const QByteArray chunk = makeAudio(format, CHUNK_MS);
+    const int chunks = WRITER_SECONDS * 1000 / CHUNK_MS;
+    context.setParameter("codec", codec == AudioCodec::Flac ? "flac" : "pcm");
+    context.setParameter("audioSeconds", WRITER_SECONDS);
+    context.setBytesPerIteration(static_cast<qint64>(chunk.size()) * chunks);
+
+    QString errorMessage;
+    context.measure(5, [&]() {
+        QFile file(directory.filePath("writer.bin"));
+        RecordingFileWriter writer(&file);
+        writer.setCodec(codec);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || !writer.start(format)) {
+            errorMessage = file.errorString();
+            return;
+        }
+        for (int i = 0; i < chunks; ++i) {
+            writer.write(chunk.constData(), chunk.size());
+        }
+        if (!writer.finish()) {
+            errorMessage = writer.errorString();
+        }
+        BenchContext::consume(writer.fileSize());
+    }, 1);
+    if (!errorMessage.isEmpty()) {
+        context.skip("Writer failed: " + errorMessage);
+    }
+}
+
+} // namespace
+
+void addAudioBenchmarks(BenchmarkList& benchmarks) {
+    benchmarks.append({"audio/level_analyze/int16_mono", [](BenchContext& context) {
+        benchLevelAnalyze(context, captureFormat(1, false));
+    }});
+    benchmarks.append({"audio/level_analyze/int16_stereo", [](BenchContext& context) {
+        benchLevelAnalyze(context, captureFormat(2, false));
+    }});
+    benchmarks.append({"audio/level_analyze/float_mono", [](BenchContext& context) {
+        benchLevelAnalyze(context, captureFormat(1, true));
+    }});
+    benchmarks.append({"audio/io_device_tick/raw", [](BenchContext& context) {
+        benchIoDeviceTick(context, false);
+    }});
+    benchmarks.append({"audio/io_device_tick/processed", [](BenchContext& context) {
+        benchIoDeviceTick(context, true);
+    }});
+    benchmarks.append({"audio/writer/pcm", [](BenchContext& context) {
+        benchWriter(context, AudioCodec::Pcm);
+    }});
+    benchmarks.append({"audio/writer/flac", [](BenchContext& context) {
+        benchWriter(context, AudioCodec::Flac);
+    }});
+}
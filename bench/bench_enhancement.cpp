@@ -0,0 +1,130 @@
+#include "BenchHarness.h"
+#include "services/EnhancementCache.h"
+#include <QTemporaryDir>
+#include <random>
+
+namespace {
+
+constexpr int CACHED_ENTRIES = 1000;
+constexpr int TEXT_LENGTH = 2000; // Characters of original and enhanced text per entry
+
+EnhancementRequest makeRequest(int index) {
+    EnhancementRequest request;
+    request.text = QString("Recording %1: ").arg(index) + QString(TEXT_LENGTH, QChar('a' + index % 26));
+    request.settings.mode = EnhancementMode::GrammarOnly;
+    request.settings.preserveFormatting = true;
+    request.settings.maxOutputLength = 0;
+    request.settings.creativity = 0.2;
+    request.preferredProvider = EnhancementProvider::GeminiFlash;
+    return request;
+}
+
+EnhancementResult makeResult(const EnhancementRequest& request) {
+    EnhancementResult result;
+    result.originalText = request.text;
+    result.enhancedText = request.text.toUpper();
+    result.mode = request.settings.mode;
+    result.provider = request.preferredProvider;
+    result.processingTime = 850;
+    result.improvementScore = 0.4;
+    return result;
+}
+
+QList<QByteArray> fillCache(EnhancementCache& cache, int entries) {
+    QList<QByteArray> keys;
+    for (int i = 0; i < entries; ++i) {
+        const EnhancementRequest request = makeRequest(i);
+        keys.append(EnhancementCache::makeKey(request));
+        cache.store(keys.last(), makeResult(request));
+    }
+    return keys;
+}
+
+void benchMakeKey(BenchContext& context) {
+    const EnhancementRequest request = makeRequest(0);
+    context.setBytesPerIteration(request.text.size() * static_cast<qint64>(sizeof(QChar)));
+    context.measure(20000, [&]() {
+        BenchContext::consume(EnhancementCache::makeKey(request).size());
+    });
+}
+
+void benchMemoryHit(BenchContext& context) {
+    EnhancementCache cache;
+    const QList<QByteArray> keys = fillCache(cache, CACHED_ENTRIES);
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> picker(0, CACHED_ENTRIES - 1);
+    EnhancementResult result;
+    context.setParameter("entries", CACHED_ENTRIES);
+    context.measure(50000, [&]() {
+        BenchContext::consume(cache.lookup(keys.at(picker(generator)), result));
+    });
+    context.addMetric("memoryHits", static_cast<double>(cache.stats().memoryHits));
+}
+
+void benchMiss(BenchContext& context) {
+    EnhancementCache cache;
+    fillCache(cache, CACHED_ENTRIES);
+    const QByteArray missing = EnhancementCache::makeKey(makeRequest(CACHED_ENTRIES));
+    EnhancementResult result;
+    context.measure(50000, [&]() {
+        BenchContext::consume(cache.lookup(missing, result));
+    });
+}
+
+// A memory tier that holds a tenth of what is stored, so every store evicts
+void benchStoreWithEviction(BenchContext& context) {
+    EnhancementCache cache;
+    const QList<QByteArray> keys = fillCache(cache, CACHED_ENTRIES);
+    cache.setMaxMemoryBytes(cache.sizeBytes() / 10);
+    QList<EnhancementResult> results;
+    for (int i = 0; i < CACHED_ENTRIES; ++i) {
+        results.append(makeResult(makeRequest(i)));
+    }
+    int next = 0;
+    context.setParameter("maxMemoryBytes", static_cast<double>(cache.sizeBytes()));
+    context.measure(20000, [&]() {
+        cache.store(keys.at(next % CACHED_ENTRIES), results.at(next % CACHED_ENTRIES));
+        ++next;
+    });
+    context.addMetric("memoryEntries", cache.stats().memoryEntries);
+}
+
+// A second cache on the same file starts with an empty memory tier: every key is
+// read from disk once and promoted
+void benchDiskHit(BenchContext& context) {
+    QTemporaryDir directory;
+    const QString databasePath = directory.filePath("enhancements.db");
+    const int entries = CACHED_ENTRIES;
+    QList<QByteArray> keys;
+    {
+        EnhancementCache writer;
+        if (!writer.openDatabase(databasePath)) {
+            context.skip("Cannot open the disk tier");
+            return;
+        }
+        keys = fillCache(writer, entries);
+    }
+
+    EnhancementCache reader;
+    if (!reader.openDatabase(databasePath)) {
+        context.skip("Cannot open the disk tier");
+        return;
+    }
+    int next = 0;
+    EnhancementResult result;
+    context.setParameter("entries", entries);
+    context.measure(entries, [&]() {
+        BenchContext::consume(reader.lookup(keys.at(next++ % entries), result));
+    }, 0);
+    context.addMetric("diskHits", static_cast<double>(reader.stats().diskHits));
+}
+
+} // namespace
+
+void addEnhancementBenchmarks(BenchmarkList& benchmarks) {
+    benchmarks.append({"enhancement_cache/make_key", benchMakeKey});
+    benchmarks.append({"enhancement_cache/memory_hit", benchMemoryHit});
+    benchmarks.append({"enhancement_cache/miss", benchMiss});
+    benchmarks.append({"enhancement_cache/store_evict", benchStoreWithEviction});
+    benchmarks.append({"enhancement_cache/disk_hit", benchDiskHit});
+}
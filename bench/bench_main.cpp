@@ -0,0 +1,117 @@
+#include "BenchHarness.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QThread>
+
+/**
+ * quillscribe_bench - micro and macro benchmarks with JSON output
+ *
+ *   quillscribe_bench [--filter <regex>] [--iterations <n>] [--fixtures <dir>] [--output <file>]
+ *
+ * Results go to --output, or stdout, as one JSON document: the build and machine it
+ * ran on, then one entry per benchmark with its timing percentiles in nanoseconds,
+ * throughput and any extra metrics. Progress goes to stderr. The whisper benchmarks
+ * decode every WAV or FLAC file in the fixtures directory with each downloaded model.
+ */
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    // Settings written by the services stay apart from the app's own
+    QCoreApplication::setOrganizationName("QuillScribe");
+    QCoreApplication::setApplicationName("QuillScribeBench");
+    QCoreApplication::setApplicationVersion(QUILLSCRIBE_VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("QuillScribe benchmarks");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    const QCommandLineOption filterOption("filter", "Run only benchmarks whose name matches <regex>.", "regex");
+    const QCommandLineOption iterationsOption("iterations", "Timed iterations for every benchmark.", "n");
+    const QCommandLineOption fixturesOption("fixtures", "Audio fixtures for the whisper benchmarks.", "dir",
+                                            QUILLSCRIBE_BENCH_FIXTURES_DIR);
+    const QCommandLineOption outputOption("output", "Write the JSON results to <file>.", "file");
+    const QCommandLineOption listOption("list", "List the benchmarks and exit.");
+    parser.addOptions({filterOption, iterationsOption, fixturesOption, outputOption, listOption});
+    parser.process(app);
+
+    BenchmarkList benchmarks;
+    addAudioBenchmarks(benchmarks);
+    addStorageBenchmarks(benchmarks);
+    addEnhancementBenchmarks(benchmarks);
+    addTextBenchmarks(benchmarks);
+    addWhisperBenchmarks(benchmarks);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const QRegularExpression filter(parser.value(filterOption));
+    if (!filter.isValid()) {
+        err << "Invalid --filter: " << filter.errorString() << Qt::endl;
+        return 2;
+    }
+    if (parser.isSet(listOption)) {
+        for (const Benchmark& benchmark : std::as_const(benchmarks)) {
+            if (filter.match(benchmark.name).hasMatch()) {
+                out << benchmark.name << Qt::endl;
+            }
+        }
+        return 0;
+    }
+
+    const int iterations = parser.value(iterationsOption).toInt();
+    const QDateTime startedAt = QDateTime::currentDateTime();
+    QJsonArray results;
+    for (const Benchmark& benchmark : std::as_const(benchmarks)) {
+        if (!filter.match(benchmark.name).hasMatch()) {
+            continue;
+        }
+        err << benchmark.name << " ..." << Qt::flush;
+        BenchContext context(benchmark.name, iterations, parser.value(fixturesOption));
+        benchmark.run(context);
+        if (context.isSkipped()) {
+            err << " skipped" << Qt::endl;
+        } else {
+            const LatencyHistogram& samples = context.samples();
+            err << QString(" p50 %1 us, p99 %2 us")
+                       .arg(samples.percentile(0.50) / 1000.0, 0, 'f', 1)
+                       .arg(samples.percentile(0.99) / 1000.0, 0, 'f', 1)
+                << Qt::endl;
+        }
+        results.append(context.toJson());
+    }
+
+    QJsonObject build;
+    build["version"] = QUILLSCRIBE_VERSION;
+    build["commit"] = QUILLSCRIBE_GIT_COMMIT;
+    build["buildType"] = QUILLSCRIBE_BUILD_TYPE;
+    build["qt"] = qVersion();
+
+    QJsonObject machine;
+    machine["cpu"] = QSysInfo::currentCpuArchitecture();
+    machine["cores"] = QThread::idealThreadCount();
+    machine["os"] = QSysInfo::prettyProductName();
+
+    QJsonObject report;
+    report["formatVersion"] = 1;
+    report["startedAt"] = startedAt.toString(Qt::ISODateWithMs);
+    report["build"] = build;
+    report["machine"] = machine;
+    report["benchmarks"] = results;
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (!parser.isSet(outputOption)) {
+        out << json;
+        return 0;
+    }
+    QSaveFile file(parser.value(outputOption));
+    if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit()) {
+        err << "Cannot write " << file.fileName() << ": " << file.errorString() << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include "BenchHarness.h"
+#include "models/Recording.h"
+#include "models/Transcription.h"
+#include "models/UserSession.h"
+#include "services/StorageManager.h"
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <memory>
+#include <random>
+
+namespace {
+
+constexpr int BATCH_ROWS = 1000;
+constexpr int WORDS_PER_TRANSCRIPT = 60;
+constexpr int PAGE_SIZE = 100;
+
+const QStringList& vocabulary() {
+    static const QStringList words = {
+        "meeting", "budget", "schedule", "client", "project", "review", "deadline", "design",
+        "release", "customer", "feedback", "roadmap", "quarter", "invoice", "contract", "team",
+        "the", "and", "we", "should", "next", "week", "move", "forward", "with", "plan",
+        "please", "send", "notes", "after", "call", "about", "update", "priority", "launch",
+        "marketing", "hiring", "interview", "travel", "workshop"
+    };
+    return words;
+}
+
+// Terms of differing frequency, from a handful of rows to most of them
+const QStringList SEARCH_TERMS = {"workshop", "invoice", "roadmap", "budget", "meeting", "the"};
+
+/**
+ * One database filled with @p rows recordings and a transcription for each. Kept
+ * between benchmarks of the same size so search and list run on what insert made.
+ */
+struct StorageFixture {
+    explicit StorageFixture(int rows) : rows(rows) {}
+
+    bool open(QString* errorMessage) {
+        storage = std::make_unique<StorageManager>();
+        if (!directory.isValid() || !storage->initialize(directory.filePath("bench.db"))) {
+            *errorMessage = "Cannot open the database: " + storage->getErrorString();
+            return false;
+        }
+        sessionId = storage->getUserSessionStorage()->saveUserSession(UserSession("Benchmark"));
+        return true;
+    }
+
+    // Rows [batch * BATCH_ROWS, +BATCH_ROWS)
+    void makeBatch(int batch) {
+        recordings.clear();
+        transcriptions.clear();
+        for (int i = 0; i < BATCH_ROWS; ++i) {
+            const int row = batch * BATCH_ROWS + i;
+            Recording recording(sessionId, QString("/bench/recording-%1.flac").arg(row));
+            recording.setTimestamp(baseTime.addSecs(row));
+            recording.setDuration(30000 + row % 60000);
+            recording.setFileSize(480000);
+            recording.setStatus(RecordingStatus::Completed);
+            recordings.append(recording);
+
+            QStringList words;
+            for (int w = 0; w < WORDS_PER_TRANSCRIPT; ++w) {
+                words.append(vocabulary().at(wordPicker(generator)));
+            }
+            transcriptions.append(Transcription(recording.getId(), words.join(' ')));
+        }
+    }
+
+    // The batch makeBatch() prepared, committed when it returns
+    bool storeBatch() {
+        const QStringList ids = storage->getRecordingStorage()->saveRecordings(recordings);
+        storage->getTranscriptionStorage()->saveTranscriptions(transcriptions);
+        // Reads wait for the writer, so this returns once both batches are committed
+        return !ids.isEmpty() && storage->getTranscriptionStorage()->transcriptionExists(transcriptions.last().getId());
+    }
+
+    bool fill() {
+        for (int batch = 0; batch < rows / BATCH_ROWS; ++batch) {
+            makeBatch(batch);
+            if (!storeBatch()) {
+                return false;
+            }
+        }
+        filled = true;
+        return true;
+    }
+
+    int rows;
+    QTemporaryDir directory;
+    std::unique_ptr<StorageManager> storage;
+    QString sessionId;
+    QDateTime baseTime = QDateTime(QDate(2024, 1, 1), QTime(0, 0));
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> wordPicker{0, static_cast<int>(vocabulary().size()) - 1};
+    QList<Recording> recordings;
+    QList<Transcription> transcriptions;
+    bool filled = false;
+};
+
+std::unique_ptr<StorageFixture> g_fixture;
+
+// The filled database of that size; null and the benchmark skipped if it cannot be made
+StorageFixture* filledFixture(BenchContext& context, int rows) {
+    if (!g_fixture || g_fixture->rows != rows || !g_fixture->filled) {
+        g_fixture = std::make_unique<StorageFixture>(rows);
+        QString errorMessage;
+        if (!g_fixture->open(&errorMessage) || !g_fixture->fill()) {
+            context.skip(errorMessage.isEmpty() ? QString("Cannot fill the database") : errorMessage);
+            g_fixture.reset();
+            return nullptr;
+        }
+    }
+    return g_fixture.get();
+}
+
+void benchInsert(BenchContext& context, int rows) {
+    // Always a fresh database, so every run inserts into the same sizes
+    g_fixture = std::make_unique<StorageFixture>(rows);
+    QString errorMessage;
+    if (!g_fixture->open(&errorMessage)) {
+        context.skip(errorMessage);
+        g_fixture.reset();
+        return;
+    }
+
+    int batch = 0;
+    bool ok = true;
+    context.setParameter("rows", rows);
+    context.setItemsPerIteration(BATCH_ROWS * 2); // A recording and a transcription per row
+    context.measure(rows / BATCH_ROWS, [&]() {
+        ok = g_fixture->storeBatch() && ok;
+    }, 0, [&]() {
+        g_fixture->makeBatch(batch++);
+    });
+    g_fixture->filled = ok && batch == rows / BATCH_ROWS;
+    if (!ok) {
+        context.skip("Insert failed: " + g_fixture->storage->getErrorString());
+    }
+}
+
+void benchSearchRanked(BenchContext& context, int rows) {
+    StorageFixture* fixture = filledFixture(context, rows);
+    if (!fixture) {
+        return;
+    }
+    int query = 0;
+    context.setParameter("rows", rows);
+    context.setParameter("limit", 50);
+    context.measure(200, [&]() {
+        const QString& term = SEARCH_TERMS.at(query++ % SEARCH_TERMS.size());
+        BenchContext::consume(fixture->storage->getTranscriptionStorage()->searchTranscriptionsRanked(term, 50).size());
+    });
+}
+
+void benchSearchRecordings(BenchContext& context, int rows) {
+    StorageFixture* fixture = filledFixture(context, rows);
+    if (!fixture) {
+        return;
+    }
+    QueryOptions options;
+    options.limit = PAGE_SIZE;
+    int query = 0;
+    context.setParameter("rows", rows);
+    context.measure(100, [&]() {
+        const QString term = QString("recording-%1").arg(query++ * 7919 % rows);
+        BenchContext::consume(fixture->storage->getRecordingStorage()->searchRecordings(term, options).size());
+    });
+}
+
+// The history list scrolling down: each page continues after the last one
+void benchListKeyset(BenchContext& context, int rows) {
+    StorageFixture* fixture = filledFixture(context, rows);
+    if (!fixture) {
+        return;
+    }
+    PageRequest request;
+    request.pageSize = PAGE_SIZE;
+    context.setParameter("rows", rows);
+    context.setParameter("pageSize", PAGE_SIZE);
+    context.setItemsPerIteration(PAGE_SIZE);
+    context.measure(500, [&]() {
+        auto cursor = fixture->storage->getRecordingStorage()->openRecordingCursor(request);
+        KeysetPosition last;
+        while (cursor && cursor->next()) {
+            BenchContext::consume(cursor->current().getDuration());
+            last = cursor->position();
+        }
+        request.after = last; // Back to the top after the last page
+    });
+}
+
+// The same pages by offset, for comparison with the keyset cursor
+void benchListOffset(BenchContext& context, int rows) {
+    StorageFixture* fixture = filledFixture(context, rows);
+    if (!fixture) {
+        return;
+    }
+    QueryOptions options;
+    options.limit = PAGE_SIZE;
+    context.setParameter("rows", rows);
+    context.setParameter("pageSize", PAGE_SIZE);
+    context.setItemsPerIteration(PAGE_SIZE);
+    context.measure(200, [&]() {
+        BenchContext::consume(fixture->storage->getRecordingStorage()->getAllRecordings(options).size());
+        options.offset = (options.offset + PAGE_SIZE) % rows;
+    });
+}
+
+} // namespace
+
+void addStorageBenchmarks(BenchmarkList& benchmarks) {
+    // The storage must go before the application object does
+    qAddPostRoutine([]() { g_fixture.reset(); });
+
+    for (const int rows : {10000, 100000}) {
+        const QString size = QString("%1k").arg(rows / 1000);
+        benchmarks.append({"storage/insert/" + size, [rows](BenchContext& context) { benchInsert(context, rows); }});
+        benchmarks.append({"storage/search_ranked/" + size, [rows](BenchContext& context) { benchSearchRanked(context, rows); }});
+        benchmarks.append({"storage/search_recordings/" + size, [rows](BenchContext& context) { benchSearchRecordings(context, rows); }});
+        benchmarks.append({"storage/list_keyset/" + size, [rows](BenchContext& context) { benchListKeyset(context, rows); }});
+        benchmarks.append({"storage/list_offset/" + size, [rows](BenchContext& context) { benchListOffset(context, rows); }});
+    }
+}
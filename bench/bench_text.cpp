@@ -0,0 +1,84 @@
+#include "BenchHarness.h"
+#include "services/TextAnalyzer.h"
+#include "services/TextChunker.h"
+#include "services/TextEnhancementService.h"
+#include <random>
+
+namespace {
+
+// The sizes TextEnhancementService chunks long text to
+constexpr int CHUNK_TARGET_LENGTH = 4000;
+constexpr int CHUNK_MAX_LENGTH = 10000;
+constexpr int CHUNK_CONTEXT_LENGTH = 400;
+
+const QStringList& sentences() {
+    static const QStringList list = {
+        "We went over the budget for the next quarter and agreed to keep hiring on hold.",
+        "The client recieve the first draft on Monday, and their feedback was mostly positive.",
+        "It's own schedule was definately too tight, so the launch was moved by a week.",
+        "Please send the notes from the call to everyone who could not make it.",
+        "The design review occured later than planned because two of the reviewers were travelling.",
+        "Marketing wants a separate landing page, which means the roadmap needs another look before we commit to anything.",
+    };
+    return list;
+}
+
+// Transcript-like text of about @p length characters, with paragraph breaks and a few
+// of the mistakes the quality checks look for; the same text on every run
+QString makeText(int length) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> picker(0, static_cast<int>(sentences().size()) - 1);
+    QString text;
+    int sentenceCount = 0;
+    while (text.size() < length) {
+        text += sentences().at(picker(generator));
+        text += ++sentenceCount % 5 == 0 ? QStringLiteral("\n\n") : QStringLiteral(" ");
+    }
+    return text.left(length);
+}
+
+void benchAnalyze(BenchContext& context, int length) {
+    const QString text = makeText(length);
+    context.setParameter("characters", length);
+    context.setItemsPerIteration(length);
+    context.measure(length >= 100000 ? 50 : 500, [&]() {
+        const TextAnalysis analysis = TextAnalyzer::analyze(text);
+        BenchContext::consume(analysis.wordCount);
+    });
+}
+
+void benchChunk(BenchContext& context, int length) {
+    const QString text = makeText(length);
+    context.setParameter("characters", length);
+    context.setItemsPerIteration(length);
+    context.measure(100, [&]() {
+        BenchContext::consume(TextChunker::split(text, CHUNK_TARGET_LENGTH, CHUNK_MAX_LENGTH,
+                                                 CHUNK_CONTEXT_LENGTH).size());
+    });
+}
+
+// The editor's checks as the service runs them; alternating between two texts
+// defeats the service's memo of the last analysis, as typing does
+void benchQualityChecks(BenchContext& context, int length) {
+    TextEnhancementService service;
+    const QString texts[2] = {makeText(length), makeText(length) + QStringLiteral(" Done.")};
+    int next = 0;
+    context.setParameter("characters", length);
+    context.measure(500, [&]() {
+        const QString& text = texts[next++ % 2];
+        BenchContext::consume(static_cast<qint64>(service.assessTextQuality(text) * 1000));
+        BenchContext::consume(service.identifyIssues(text).size());
+        BenchContext::consume(service.suggestBestMode(text).size());
+    });
+}
+
+} // namespace
+
+void addTextBenchmarks(BenchmarkList& benchmarks) {
+    for (const int length : {1000, 10000, 100000}) {
+        const QString size = QString("%1k").arg(length / 1000);
+        benchmarks.append({"text/analyze/" + size, [length](BenchContext& context) { benchAnalyze(context, length); }});
+        benchmarks.append({"text/quality_checks/" + size, [length](BenchContext& context) { benchQualityChecks(context, length); }});
+    }
+    benchmarks.append({"text/chunk/100k", [](BenchContext& context) { benchChunk(context, 100000); }});
+}
@@ -0,0 +1,123 @@
+#include "BenchHarness.h"
+#include "services/AudioFileReader.h"
+#include "services/TranscriptionService.h"
+#include <QDir>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QJsonArray>
+
+namespace {
+
+struct Fixture {
+    QString path;
+    qint64 audioMs = 0;
+};
+
+QList<Fixture> loadFixtures(const QString& directory) {
+    QList<Fixture> fixtures;
+    const QFileInfoList files = QDir(directory).entryInfoList({"*.wav", "*.flac"}, QDir::Files, QDir::Name);
+    for (const QFileInfo& file : files) {
+        QVector<float> samples;
+        if (AudioFileReader::readSamples(file.absoluteFilePath(), samples)) {
+            fixtures.append({file.absoluteFilePath(), samples.size() * 1000LL / AudioFileReader::TARGET_SAMPLE_RATE});
+        }
+    }
+    return fixtures;
+}
+
+// Submits and waits; the wall time of this call is the sample
+bool transcribe(TranscriptionService& service, TranscriptionProvider model, const QString& path, QString* errorMessage) {
+    TranscriptionRequest request;
+    request.audioFilePath = path;
+    request.language = "en";
+    request.preferredProvider = model;
+    request.timeoutMs = 0;
+    request.maxRetries = 0;
+    request.options["useCache"] = false; // Every run decodes
+
+    QEventLoop loop;
+    QString requestId;
+    bool ok = false;
+    QObject::connect(&service, &ITranscriptionService::transcriptionCompleted, &loop,
+                     [&](const QString& id, const TranscriptionResult&) {
+        if (id == requestId) {
+            ok = true;
+            loop.quit();
+        }
+    });
+    QObject::connect(&service, &ITranscriptionService::transcriptionFailed, &loop,
+                     [&](const QString& id, TranscriptionError, const QString& message) {
+        if (id == requestId) {
+            *errorMessage = message;
+            loop.quit();
+        }
+    });
+
+    // Results arrive through queued signals, so none can be missed before exec()
+    requestId = service.submitTranscription(request);
+    if (requestId.isEmpty()) {
+        *errorMessage = service.getErrorString();
+        return false;
+    }
+    loop.exec();
+    return ok;
+}
+
+void benchRealTimeFactor(BenchContext& context, TranscriptionProvider model, const QString& modelName) {
+    TranscriptionService service;
+    if (!service.isModelDownloaded(model)) {
+        context.skip("Model " + modelName + " is not downloaded");
+        return;
+    }
+    const QList<Fixture> fixtures = loadFixtures(context.fixturesDirectory());
+    if (fixtures.isEmpty()) {
+        context.skip("No WAV or FLAC fixtures in " + context.fixturesDirectory());
+        return;
+    }
+
+    QJsonArray names;
+    qint64 fixtureAudioMs = 0;
+    for (const Fixture& fixture : fixtures) {
+        names.append(QFileInfo(fixture.path).fileName());
+        fixtureAudioMs += fixture.audioMs;
+    }
+    context.setParameter("model", modelName);
+    context.setParameter("fixtures", names);
+    context.setParameter("audioMs", static_cast<double>(fixtureAudioMs));
+
+    // One pass over every fixture per iteration; the warm-up pass loads the model
+    QString errorMessage;
+    bool ok = true;
+    context.measure(3, [&]() {
+        for (const Fixture& fixture : fixtures) {
+            ok = ok && transcribe(service, model, fixture.path, &errorMessage);
+        }
+    }, 1);
+    if (!ok) {
+        context.skip("Transcription failed: " + errorMessage);
+        return;
+    }
+
+    // Below 1.0 the model keeps up with live audio
+    const double meanMs = context.samples().mean() / 1e6;
+    context.addMetric("realTimeFactor", fixtureAudioMs > 0 ? meanMs / fixtureAudioMs : 0.0);
+    context.addMetric("p95RealTimeFactor",
+                      fixtureAudioMs > 0 ? context.samples().percentile(0.95) / 1e6 / fixtureAudioMs : 0.0);
+}
+
+} // namespace
+
+void addWhisperBenchmarks(BenchmarkList& benchmarks) {
+    const QList<QPair<TranscriptionProvider, QString>> models = {
+        {TranscriptionProvider::WhisperCppTiny, "tiny"},
+        {TranscriptionProvider::WhisperCppBase, "base"},
+        {TranscriptionProvider::WhisperCppSmall, "small"},
+        {TranscriptionProvider::WhisperCppMedium, "medium"},
+        {TranscriptionProvider::WhisperCppLarge, "large"},
+    };
+    for (const auto& model : models) {
+        benchmarks.append({"whisper/rtf/" + model.second, [model](BenchContext& context) {
+            benchRealTimeFactor(context, model.first, model.second);
+        }});
+    }
+}
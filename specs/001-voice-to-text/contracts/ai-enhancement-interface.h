@@ -148,6 +148,8 @@ public:
     // Progress notifications
     void enhancementStarted(const QString& requestId, EnhancementProvider provider);
     void enhancementProgress(const QString& requestId, int progressPercent);
+    // Streaming providers: all text generated so far, before enhancementCompleted
+    void enhancementPartialResult(const QString& requestId, const QString& partialText);
     void enhancementCompleted(const QString& requestId, const EnhancementResult& result);
     void enhancementFailed(const QString& requestId,
                            EnhancementError error,
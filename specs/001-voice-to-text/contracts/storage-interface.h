@@ -8,6 +8,9 @@
 #include <QDateTime>
 #include <QJsonObject>
 #include <QList>
+#include <QStringList>
+#include <QVariant>
+#include <memory>
 
 // Forward declarations for data models
 class Recording;
@@ -54,6 +57,43 @@ struct QueryOptions {
     bool includeDeleted = false;
 };
 
+/**
+ * @brief Where a keyset page ends: the sort key and id of its last row
+ */
+struct KeysetPosition {
+    QVariant timestamp;     // Sort key exactly as stored
+    QString id;             // Breaks ties between equal timestamps
+
+    bool isValid() const { return !id.isEmpty(); }
+};
+
+/**
+ * @brief One page of a keyset (seek) paginated listing
+ */
+struct PageRequest {
+    int pageSize = 100;                         // <= 0 for no limit
+    KeysetPosition after;                       // Continue after this row; invalid starts at the top
+    SortOrder sortOrder = SortOrder::Descending;
+    QStringList columns;                        // Columns to load; empty loads all of them
+    QList<QueryFilter> filters;                 // Comparisons on table columns, all of which must hold
+};
+
+/**
+ * @brief Forward-only cursor over a page; rows are decoded only when current() is called
+ *
+ * A cursor reads on the connection of the thread that opened it: use it on that
+ * thread only, and do not let it outlive the storage.
+ */
+template <typename Model>
+class StorageCursor {
+public:
+    virtual ~StorageCursor() = default;
+
+    virtual bool next() = 0;
+    virtual Model current() const = 0;
+    virtual KeysetPosition position() const = 0;    // Of the current row; PageRequest::after for the next page
+};
+
 /**
  * @brief Interface for recording data persistence
  * 
@@ -75,11 +115,17 @@ public:
     virtual bool deleteRecording(const QString& id) = 0;
     virtual bool recordingExists(const QString& id) const = 0;
 
+    // Bulk Operations: one transaction and one aggregated signal per call
+    virtual QStringList saveRecordings(const QList<Recording>& recordings) = 0;
+    virtual bool updateRecordings(const QList<Recording>& recordings) = 0;
+
     // Query Operations
     virtual QList<Recording> getAllRecordings(const QueryOptions& options = {}) const = 0;
     virtual QList<Recording> getRecordingsBySession(const QString& sessionId, const QueryOptions& options = {}) const = 0;
     virtual QList<Recording> getRecordingsByDateRange(const QDateTime& start, const QDateTime& end) const = 0;
     virtual QList<Recording> searchRecordings(const QString& searchTerm, const QueryOptions& options = {}) const = 0;
+    // Ordered by (timestamp, id)
+    virtual std::unique_ptr<StorageCursor<Recording>> openRecordingCursor(const PageRequest& request = {}) const = 0;
 
     // Statistics
     virtual int getRecordingCount() const = 0;
@@ -97,6 +143,18 @@ signals:
     void recordingCreated(const QString& id);
     void recordingUpdated(const QString& id);
     void recordingDeleted(const QString& id);
+    void recordingsCreated(const QStringList& ids);
+    void recordingsUpdated(const QStringList& ids);
+};
+
+/**
+ * @brief One ranked full-text match; enhanced-text matches report their transcription
+ */
+struct TranscriptionSearchHit {
+    QString transcriptionId;
+    QString snippet;                // Matching passage, terms wrapped in the highlight markers
+    double score = 0.0;             // Higher is more relevant (negated BM25)
+    bool matchedEnhancedText = false;
 };
 
 /**
@@ -116,11 +174,22 @@ public:
     virtual bool deleteTranscription(const QString& id) = 0;
     virtual bool transcriptionExists(const QString& id) const = 0;
 
+    // Bulk Operations
+    virtual QStringList saveTranscriptions(const QList<Transcription>& transcriptions) = 0;
+    virtual bool updateTranscriptions(const QList<Transcription>& transcriptions) = 0;
+
     // Query Operations
     virtual QList<Transcription> getAllTranscriptions(const QueryOptions& options = {}) const = 0;
     virtual Transcription getTranscriptionByRecording(const QString& recordingId) const = 0;
     virtual QList<Transcription> searchTranscriptions(const QString& searchTerm, const QueryOptions& options = {}) const = 0;
     virtual QList<Transcription> getTranscriptionsByProvider(const QString& provider) const = 0;
+    // Ordered by (created_at, id)
+    virtual std::unique_ptr<StorageCursor<Transcription>> openTranscriptionCursor(const PageRequest& request = {}) const = 0;
+
+    // Ranked search over transcription and enhanced text; the last word matches as a prefix
+    virtual QList<TranscriptionSearchHit> searchTranscriptionsRanked(const QString& searchTerm, int limit = 50,
+                                                                     const QString& highlightOpen = "<b>",
+                                                                     const QString& highlightClose = "</b>") const = 0;
 
     // Statistics
     virtual int getTranscriptionCount() const = 0;
@@ -131,6 +200,8 @@ signals:
     void transcriptionCreated(const QString& id);
     void transcriptionUpdated(const QString& id);
     void transcriptionDeleted(const QString& id);
+    void transcriptionsCreated(const QStringList& ids);
+    void transcriptionsUpdated(const QStringList& ids);
 };
 
 /**
@@ -150,6 +221,9 @@ public:
     virtual bool deleteEnhancedText(const QString& id) = 0;
     virtual bool enhancedTextExists(const QString& id) const = 0;
 
+    // Bulk Operations
+    virtual QStringList saveEnhancedTexts(const QList<EnhancedText>& enhancedTexts) = 0;
+
     // Query Operations
     virtual QList<EnhancedText> getAllEnhancedTexts(const QueryOptions& options = {}) const = 0;
     virtual QList<EnhancedText> getEnhancedTextsByTranscription(const QString& transcriptionId) const = 0;
@@ -165,6 +239,7 @@ signals:
     void enhancedTextCreated(const QString& id);
     void enhancedTextUpdated(const QString& id);
     void enhancedTextDeleted(const QString& id);
+    void enhancedTextsCreated(const QStringList& ids);
 };
 
 /**
@@ -194,6 +269,8 @@ public:
     virtual QList<UserSession> getAllSessions(const QueryOptions& options = {}) const = 0;
     virtual QList<UserSession> getSessionsByDateRange(const QDateTime& start, const QDateTime& end) const = 0;
     virtual QList<UserSession> searchSessions(const QString& searchTerm, const QueryOptions& options = {}) const = 0;
+    // Ordered by (started_at, id)
+    virtual std::unique_ptr<StorageCursor<UserSession>> openSessionCursor(const PageRequest& request = {}) const = 0;
 
     // Statistics
     virtual int getSessionCount() const = 0;
@@ -272,6 +349,9 @@ public:
 
     // Backup & Restore
     virtual bool backupDatabase(const QString& backupPath) = 0;
+    // Copies in the background; reports through backupProgress/backupCompleted/backupFailed
+    virtual bool startBackup(const QString& backupPath) = 0;
+    virtual bool isBackupRunning() const = 0;
     virtual bool restoreDatabase(const QString& backupPath) = 0;
     virtual QStringList getAvailableBackups(const QString& backupDir) const = 0;
 
@@ -301,6 +381,8 @@ signals:
     void databaseDisconnected();
     void errorOccurred(StorageError error, const QString& errorMessage);
     void backupCompleted(const QString& backupPath);
+    void backupProgress(const QString& backupPath, qint64 bytesWritten, qint64 bytesTotal);
+    void backupFailed(const QString& backupPath, const QString& errorMessage);
     void migrationProgress(int currentVersion, int targetVersion);
 };
 
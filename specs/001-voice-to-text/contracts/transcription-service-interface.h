@@ -7,6 +7,7 @@
 #include <QString>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QVector>
 #include <QUrl>
 #include <QNetworkReply>
 
@@ -28,6 +29,12 @@ enum class TranscriptionStatus {
     Cancelled
 };
 
+enum class TranscriptionPriority {
+    Interactive,        // Live dictation; always served first
+    Normal,
+    Background          // Batch and archival work
+};
+
 enum class TranscriptionError {
     NoError,
     ModelNotFound,
@@ -52,13 +59,29 @@ struct TranscriptionResult {
     QJsonObject metadata;       // Provider-specific data
 };
 
+/**
+ * @brief Shared, reference-counted PCM samples handed from recorder to transcriber
+ *
+ * Samples are normalized mono floats. Copies share one implicitly shared array,
+ * so passing a buffer through requests and queued signals never duplicates audio.
+ */
+struct AudioSampleBuffer {
+    QVector<float> samples;
+    int sampleRate = 16000;
+
+    bool isEmpty() const { return samples.isEmpty(); }
+    qint64 durationMs() const { return sampleRate > 0 ? samples.size() * 1000 / sampleRate : 0; }
+};
+
 struct TranscriptionRequest {
     QString audioFilePath;
     QString language;           // "auto" for auto-detection
     TranscriptionProvider preferredProvider;
     QJsonObject options;        // Provider-specific options
     int maxRetries = 3;
-    int timeoutMs = 30000;      // 30 second timeout
+    int timeoutMs = -1;         // Limit for the whole request; < 0 uses the service's setTimeout() scaled to the audio, 0 disables it
+    AudioSampleBuffer audioBuffer; // In-memory audio; takes precedence over audioFilePath when set
+    TranscriptionPriority priority = TranscriptionPriority::Normal;
 };
 
 /**
@@ -107,6 +130,13 @@ public:
     virtual QStringList submitBatchTranscription(const QList<TranscriptionRequest>& requests) = 0;
     virtual QList<TranscriptionResult> getBatchResults(const QStringList& requestIds) const = 0;
 
+    // Streaming Operations (live transcription while recording)
+    // request.options may carry "sampleRate", "channelCount" and "bytesPerSample" of the PCM fed in
+    virtual QString startStreamingTranscription(const TranscriptionRequest& request) = 0;
+    virtual void appendStreamingAudio(const QString& streamId, const QByteArray& pcmData) = 0;
+    virtual void finishStreamingTranscription(const QString& streamId) = 0;
+    virtual void cancelStreamingTranscription(const QString& streamId) = 0;
+
     // Configuration
     virtual void setMaxConcurrentRequests(int maxRequests) = 0;
     virtual void setTimeout(int timeoutMs) = 0;
@@ -135,6 +165,11 @@ signals:
     void transcriptionFailed(const QString& requestId, TranscriptionError error, const QString& errorMessage);
     void transcriptionCancelled(const QString& requestId);
 
+    // Streaming notifications; times are milliseconds from the start of the stream
+    void partialTranscription(const QString& streamId, const QString& text, qint64 startMs, qint64 endMs);
+    void segmentFinalized(const QString& streamId, const QString& text, qint64 startMs, qint64 endMs);
+    void streamingTranscriptionFinished(const QString& streamId, const TranscriptionResult& result);
+
     // Model management
     void modelDownloadStarted(TranscriptionProvider model);
     void modelDownloadProgress(TranscriptionProvider model, int progressPercent);
@@ -0,0 +1,357 @@
+#include "BatchTranscriber.h"
+#include "services/StorageManager.h"
+#include "services/TextEnhancementService.h"
+#include "services/TranscriptionService.h"
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSet>
+#include <QTextStream>
+#include <algorithm>
+
+namespace {
+
+QString modelName(TranscriptionProvider model) {
+    switch (model) {
+        case TranscriptionProvider::WhisperCppTiny: return "tiny";
+        case TranscriptionProvider::WhisperCppBase: return "base";
+        case TranscriptionProvider::WhisperCppSmall: return "small";
+        case TranscriptionProvider::WhisperCppMedium: return "medium";
+        case TranscriptionProvider::WhisperCppLarge: return "large";
+        default: return "unknown";
+    }
+}
+
+QTextStream& err() {
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+} // namespace
+
+BatchTranscriber::BatchTranscriber(const Options& options, QObject* parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_total(0)
+    , m_finished(0)
+    , m_failed(0)
+    , m_skipped(0)
+{
+    m_options.jobs = qMax(1, m_options.jobs);
+}
+
+BatchTranscriber::~BatchTranscriber() = default;
+
+int BatchTranscriber::run() {
+    QString errorMessage;
+    if (!initializeServices(&errorMessage)) {
+        err() << "Error: " << errorMessage << Qt::endl;
+        return EXIT_ERROR;
+    }
+    collectInputs();
+
+    err() << "Transcribing " << m_pending.size() << " recording(s) with the " << modelName(m_options.model)
+          << " model, " << m_options.jobs << " at a time";
+    if (m_skipped > 0) {
+        err() << " (" << m_skipped << " already done)";
+    }
+    err() << Qt::endl;
+
+    submitPending();
+    if (!m_running.isEmpty()) {
+        m_loop.exec();
+    }
+    if (!m_sessionId.isEmpty()) {
+        m_storageManager->getUserSessionStorage()->endSession(m_sessionId, QDateTime::currentDateTime());
+    }
+
+    err() << "Done: " << m_finished << " transcribed, " << m_failed << " failed, "
+          << m_skipped << " skipped" << Qt::endl;
+    if (m_failed > 0) {
+        return m_finished > 0 ? EXIT_FAILURES : EXIT_ERROR;
+    }
+    return 0;
+}
+
+bool BatchTranscriber::initializeServices(QString* errorMessage) {
+    if (m_options.store) {
+        m_storageManager = std::make_unique<StorageManager>();
+        if (!m_storageManager->initialize(m_options.databasePath)) {
+            *errorMessage = "Failed to open the database: " + m_storageManager->getErrorString();
+            return false;
+        }
+        m_sessionId = m_storageManager->getUserSessionStorage()->createNewSession(
+            QString("Batch %1").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm")));
+        if (m_sessionId.isEmpty()) {
+            *errorMessage = "Failed to start a session in the database";
+            return false;
+        }
+    }
+
+    // Saves each transcript itself when it has the storage
+    m_transcriptionService = std::make_unique<TranscriptionService>(m_storageManager.get());
+    if (!m_transcriptionService->isModelDownloaded(m_options.model)) {
+        *errorMessage = QString("The %1 model (%2) is not downloaded; download it from the app first")
+                            .arg(modelName(m_options.model), m_transcriptionService->getModelFileName(m_options.model));
+        return false;
+    }
+    m_transcriptionService->setMaxConcurrentRequests(m_options.jobs);
+
+    // The pipeline needs one even when nothing is enhanced; the API key comes from the app's settings
+    m_textEnhancementService = std::make_unique<TextEnhancementService>();
+    m_textEnhancementService->setLocalComputePool(m_transcriptionService->getDecodePool(),
+                                                  m_transcriptionService->getDecodeThreadCount());
+
+    m_pipeline = std::make_unique<ProcessingPipeline>(m_transcriptionService.get(), m_textEnhancementService.get(),
+                                                      m_storageManager ? m_storageManager->getAsyncStorage() : nullptr);
+    // A queue as deep as the workers, so the next recording is ready as soon as one finishes
+    m_pipeline->setStageLimits(ProcessingPipeline::Stage::Transcribe, m_options.jobs, m_options.jobs);
+
+    connect(m_pipeline.get(), &ProcessingPipeline::acceptingChanged, this, [this](bool accepting) {
+        if (accepting) {
+            submitPending();
+        }
+    });
+    // Timed from when a worker picks it up, not from when it was queued
+    connect(m_pipeline.get(), &ProcessingPipeline::jobStageChanged, this,
+            [this](const QString& jobId, ProcessingPipeline::Stage stage) {
+        auto it = m_running.find(jobId);
+        if (it != m_running.end() && stage == ProcessingPipeline::Stage::Transcribe) {
+            it->timer.start();
+        }
+    });
+    connect(m_pipeline.get(), &ProcessingPipeline::jobTranscribed, this, &BatchTranscriber::handleTranscribed);
+    connect(m_pipeline.get(), &ProcessingPipeline::jobEnhanced, this, &BatchTranscriber::handleEnhanced);
+    connect(m_pipeline.get(), &ProcessingPipeline::jobFinished, this, &BatchTranscriber::handleFinished);
+    connect(m_pipeline.get(), &ProcessingPipeline::jobFailed, this, &BatchTranscriber::handleFailed);
+    return true;
+}
+
+void BatchTranscriber::collectInputs() {
+    QStringList nameFilters;
+    for (const QString& format : m_transcriptionService->getSupportedFormats()) {
+        nameFilters.append("*." + format);
+    }
+
+    QSet<QString> seen;
+    QList<Item> items;
+    auto add = [&](const QString& path, const QString& root) {
+        const QString canonical = QFileInfo(path).canonicalFilePath();
+        if (!seen.contains(canonical)) {
+            seen.insert(canonical);
+            items.append({canonical, outputPathFor(canonical, root)});
+        }
+    };
+
+    // A bad path costs only itself; it counts as a failure so the exit code still reports it
+    int rejected = 0;
+    auto reject = [&](const QString& input, const QString& reason) {
+        err() << "Skipping " << input << ": " << reason << Qt::endl;
+        ++rejected;
+    };
+
+    for (const QString& input : std::as_const(m_options.inputs)) {
+        const QFileInfo info(input);
+        if (info.isDir()) {
+            const QString root = info.canonicalFilePath();
+            QDirIterator it(root, nameFilters, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                add(it.next(), root);
+            }
+        } else if (info.isFile()) {
+            if (!m_transcriptionService->isFormatSupported(info.suffix())) {
+                reject(input, "unsupported audio format");
+                continue;
+            }
+            add(input, info.canonicalPath());
+        } else {
+            reject(input, "no such file or directory");
+        }
+    }
+
+    // Same order on every run, so progress lines from a resumed run line up with the last one
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+        return a.sourcePath < b.sourcePath;
+    });
+    for (const Item& item : std::as_const(items)) {
+        if (!m_options.overwrite && isDone(item)) {
+            ++m_skipped;
+        } else {
+            m_pending.enqueue(item);
+        }
+    }
+    m_failed += rejected;
+    m_total = static_cast<int>(m_pending.size()) + rejected;
+}
+
+bool BatchTranscriber::isDone(const Item& item) const {
+    const QFileInfo output(item.outputPath);
+    return output.exists() && output.lastModified() >= QFileInfo(item.sourcePath).lastModified();
+}
+
+QString BatchTranscriber::outputPathFor(const QString& sourcePath, const QString& root) const {
+    const QString extension = m_options.format == OutputFormat::Json ? ".json" : ".txt";
+    if (m_options.outputDirectory.isEmpty()) {
+        return sourcePath + extension;
+    }
+    // Keeps the input's layout, so recordings with the same name in different folders stay apart
+    return QDir(m_options.outputDirectory).filePath(QDir(root).relativeFilePath(sourcePath) + extension);
+}
+
+void BatchTranscriber::submitPending() {
+    while (!m_pending.isEmpty() && m_pipeline->isAccepting()) {
+        const Item item = m_pending.dequeue();
+
+        Running running;
+        running.item = item;
+        running.timer.start();
+
+        TranscriptionRequest request;
+        request.audioFilePath = item.sourcePath;
+        request.language = m_options.language;
+        request.preferredProvider = m_options.model;
+        request.timeoutMs = 0; // Long recordings are expected here
+        request.priority = TranscriptionPriority::Background;
+
+        ProcessingPipeline::Job job;
+        if (m_storageManager) {
+            Recording recording(m_sessionId, item.sourcePath);
+            recording.setTimestamp(QFileInfo(item.sourcePath).lastModified());
+            recording.setFileSize(QFileInfo(item.sourcePath).size());
+            recording.setStatus(RecordingStatus::Processing);
+            if (!m_storageManager->getRecordingStorage()->saveRecording(recording).isEmpty()) {
+                running.recording = recording;
+                request.options["recordingId"] = recording.getId();
+                request.options["sessionId"] = m_sessionId;
+                job.recordingId = recording.getId();
+            }
+        }
+        job.transcription = request;
+        job.enhance = m_options.enhance;
+        job.enhancementSettings = m_textEnhancementService->getDefaultSettings(m_options.enhancementMode);
+        job.enhancementProvider = m_textEnhancementService->getCurrentProvider();
+
+        // Only refused when the pipeline stops accepting, which the loop checks first
+        const QString jobId = m_pipeline->submit(job);
+        if (jobId.isEmpty()) {
+            ++m_failed;
+            markRecording(running, RecordingStatus::Error);
+            reportProgress(item.sourcePath, "FAILED: the pipeline refused it");
+            continue;
+        }
+        m_running.insert(jobId, running);
+    }
+    quitIfDone();
+}
+
+void BatchTranscriber::handleTranscribed(const QString& jobId, const TranscriptionResult& result) {
+    auto it = m_running.find(jobId);
+    if (it != m_running.end()) {
+        it->transcription = result;
+    }
+}
+
+void BatchTranscriber::handleEnhanced(const QString& jobId, const EnhancementResult& result) {
+    auto it = m_running.find(jobId);
+    if (it != m_running.end()) {
+        it->enhancement = result;
+        it->enhanced = true;
+    }
+}
+
+void BatchTranscriber::handleFinished(const QString& jobId) {
+    Running running = m_running.take(jobId);
+    if (running.item.sourcePath.isEmpty()) {
+        return;
+    }
+
+    QString errorMessage;
+    if (!writeResult(running, &errorMessage)) {
+        ++m_failed;
+        markRecording(running, RecordingStatus::Error);
+        reportProgress(running.item.sourcePath, "FAILED: " + errorMessage);
+    } else {
+        ++m_finished;
+        markRecording(running, RecordingStatus::Completed);
+        reportProgress(running.item.sourcePath,
+                       QString("done in %1 s").arg(running.timer.elapsed() / 1000.0, 0, 'f', 1));
+    }
+    quitIfDone();
+}
+
+void BatchTranscriber::handleFailed(const QString& jobId, ProcessingPipeline::Stage stage, const QString& errorMessage) {
+    Running running = m_running.take(jobId);
+    if (running.item.sourcePath.isEmpty()) {
+        return;
+    }
+
+    // No result is written, so the next run tries the recording again
+    ++m_failed;
+    markRecording(running, RecordingStatus::Error);
+    const QString stageName = stage == ProcessingPipeline::Stage::Transcribe ? "transcription"
+                            : stage == ProcessingPipeline::Stage::Enhance    ? "enhancement"
+                                                                             : "saving";
+    reportProgress(running.item.sourcePath, QString("FAILED (%1): %2").arg(stageName, errorMessage));
+    quitIfDone();
+}
+
+bool BatchTranscriber::writeResult(const Running& running, QString* errorMessage) const {
+    const TranscriptionResult& result = running.transcription;
+
+    QByteArray content;
+    if (m_options.format == OutputFormat::Json) {
+        QJsonObject json;
+        json["source"] = running.item.sourcePath;
+        json["model"] = modelName(m_options.model);
+        json["language"] = result.language;
+        json["text"] = result.text;
+        json["confidence"] = result.confidence;
+        json["processingTimeMs"] = result.processingTime;
+        json["audioDurationMs"] = result.metadata.value("audioDurationMs");
+        json["words"] = result.wordTimestamps;
+        json["transcribedAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+        if (running.enhanced) {
+            QJsonObject enhanced;
+            enhanced["mode"] = enhancementModeToString(running.enhancement.mode);
+            enhanced["text"] = running.enhancement.enhancedText;
+            json["enhanced"] = enhanced;
+        }
+        content = QJsonDocument(json).toJson(QJsonDocument::Indented);
+    } else {
+        content = (running.enhanced ? running.enhancement.enhancedText : result.text).toUtf8() + '\n';
+    }
+
+    const QFileInfo output(running.item.outputPath);
+    if (!QDir().mkpath(output.absolutePath())) {
+        *errorMessage = "Cannot create " + output.absolutePath();
+        return false;
+    }
+    QSaveFile file(running.item.outputPath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size() || !file.commit()) {
+        *errorMessage = "Cannot write " + running.item.outputPath + ": " + file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void BatchTranscriber::markRecording(Running& running, RecordingStatus status) {
+    if (!m_storageManager || running.recording.getId().isEmpty()) {
+        return;
+    }
+    running.recording.setStatus(status);
+    m_storageManager->getRecordingStorage()->updateRecording(running.recording);
+}
+
+void BatchTranscriber::reportProgress(const QString& sourcePath, const QString& status) {
+    err() << "[" << (m_finished + m_failed) << "/" << m_total << "] " << sourcePath << ": " << status << Qt::endl;
+}
+
+void BatchTranscriber::quitIfDone() {
+    if (m_pending.isEmpty() && m_running.isEmpty()) {
+        m_loop.quit();
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "services/ProcessingPipeline.h"
+#include "models/Recording.h"
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QStringList>
+#include <memory>
+
+class StorageManager;
+class TextEnhancementService;
+class TranscriptionService;
+
+/**
+ * @brief Headless transcription of files and directories, for `quillscribe --transcribe`
+ *
+ * Recordings go through a ProcessingPipeline whose transcription stage runs as
+ * many decodes at once as there are jobs; the batch keeps its queue topped up as
+ * they finish. Each result is written next to its recording, or under the output
+ * directory in the same layout as the input, as "<file>.json" or "<file>.txt".
+ *
+ * Results are written through QSaveFile, so an interrupted run leaves either a
+ * whole result or none. A recording whose result exists and is newer than it is
+ * skipped: running the same command again resumes where the last run stopped.
+ *
+ * Progress goes to stderr, one line per recording. Needs no display.
+ */
+class BatchTranscriber : public QObject {
+    Q_OBJECT
+
+public:
+    enum class OutputFormat {
+        Json,   // Transcript, language, confidence, word timings and the enhanced text
+        Text    // The enhanced text when enhancing, otherwise the transcript
+    };
+
+    struct Options {
+        QStringList inputs;         // Recordings and directories; directories are searched recursively
+        TranscriptionProvider model = TranscriptionProvider::WhisperCppBase;
+        QString language = "auto";
+        int jobs = DEFAULT_JOBS;
+        OutputFormat format = OutputFormat::Json;
+        QString outputDirectory;    // Empty: next to each recording
+        bool overwrite = false;     // Redo recordings that already have a result
+        bool enhance = false;
+        EnhancementMode enhancementMode = EnhancementMode::GrammarOnly;
+        bool store = false;         // Also save recordings, transcripts and enhanced text under a new session
+        QString databasePath;
+    };
+
+    explicit BatchTranscriber(const Options& options, QObject* parent = nullptr);
+    ~BatchTranscriber() override;
+
+    // Runs until every recording is done; returns the process exit code
+    int run();
+
+    static constexpr int DEFAULT_JOBS = 2;
+    static constexpr int EXIT_FAILURES = 1;  // Some recordings failed; the rest were written
+    static constexpr int EXIT_ERROR = 2;     // Nothing was transcribed
+
+private:
+    struct Item {
+        QString sourcePath;
+        QString outputPath;
+    };
+
+    struct Running {
+        Item item;
+        Recording recording;       // Only with --store
+        TranscriptionResult transcription;
+        EnhancementResult enhancement;
+        bool enhanced = false;
+        QElapsedTimer timer;
+    };
+
+    bool initializeServices(QString* errorMessage);
+    void collectInputs();
+    bool isDone(const Item& item) const;
+    QString outputPathFor(const QString& sourcePath, const QString& root) const;
+
+    void submitPending();
+    void handleTranscribed(const QString& jobId, const TranscriptionResult& result);
+    void handleEnhanced(const QString& jobId, const EnhancementResult& result);
+    void handleFinished(const QString& jobId);
+    void handleFailed(const QString& jobId, ProcessingPipeline::Stage stage, const QString& errorMessage);
+
+    bool writeResult(const Running& running, QString* errorMessage) const;
+    void markRecording(Running& running, RecordingStatus status);
+    void reportProgress(const QString& sourcePath, const QString& status);
+    void quitIfDone();
+
+    Options m_options;
+
+    // Declared in teardown order: the pipeline goes before the services it drives
+    std::unique_ptr<StorageManager> m_storageManager;
+    std::unique_ptr<TranscriptionService> m_transcriptionService;
+    std::unique_ptr<TextEnhancementService> m_textEnhancementService;
+    std::unique_ptr<ProcessingPipeline> m_pipeline;
+
+    QQueue<Item> m_pending;
+    QHash<QString, Running> m_running; // Job ID -> recording in the pipeline
+    QString m_sessionId;
+    QEventLoop m_loop;
+    int m_total;
+    int m_finished;
+    int m_failed;
+    int m_skipped;
+};
@@ -0,0 +1,251 @@
+#pragma once
+
+#include "../specs/001-voice-to-text/contracts/storage-interface.h"
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <algorithm>
+#include <memory>
+
+/**
+ * @brief List model over a keyset-paginated storage listing, newest first
+ *
+ * Rows are fetched a page at a time through canFetchMore()/fetchMore(), so a view
+ * reads only as far as it scrolls. The storage's change signals are applied as row
+ * deltas: a new entity newer than every row is prepended and an update replaces its
+ * row, both in constant time; an entity between loaded rows is inserted in place,
+ * and one older than the last loaded row is left for a later page. Display text is
+ * built when a view first asks for a row, which it only does for visible rows.
+ *
+ * Subclasses open the cursor, load single entities and format them; Qt::UserRole
+ * is the entity's id.
+ */
+template <typename Entity>
+class KeysetListModel : public QAbstractListModel {
+public:
+    explicit KeysetListModel(QObject* parent = nullptr)
+        : QAbstractListModel(parent)
+        , m_atEnd(true)
+        , m_firstSequence(0)
+    {
+    }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+    }
+
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override {
+        if (!index.isValid() || index.row() >= m_rows.size()) {
+            return QVariant();
+        }
+        const Row& row = m_rows.at(index.row());
+        switch (role) {
+            case Qt::DisplayRole:
+                if (row.display.isNull()) {
+                    row.display = displayText(row.entity);
+                }
+                return row.display;
+            case Qt::UserRole:
+                return row.entity.getId();
+            default:
+                return QVariant();
+        }
+    }
+
+    bool canFetchMore(const QModelIndex& parent = QModelIndex()) const override {
+        return !parent.isValid() && !m_atEnd;
+    }
+
+    void fetchMore(const QModelIndex& parent = QModelIndex()) override {
+        if (parent.isValid() || m_atEnd) {
+            return;
+        }
+
+        PageRequest request;
+        request.pageSize = FETCH_PAGE_SIZE;
+        request.after = m_nextPage;
+        request.sortOrder = SortOrder::Descending;
+        request.columns = columns();
+        request.filters = filters();
+
+        QList<Entity> page;
+        int fetched = 0;
+        std::unique_ptr<StorageCursor<Entity>> cursor = openCursor(request);
+        while (cursor && cursor->next()) {
+            const Entity entity = cursor->current();
+            m_nextPage = cursor->position();
+            ++fetched;
+            // Already inserted by a change signal
+            if (!m_rowById.contains(entity.getId())) {
+                page.append(entity);
+            }
+        }
+        // A short page from the cursor is the end; rows skipped above still count
+        if (!cursor || fetched < FETCH_PAGE_SIZE) {
+            m_atEnd = true;
+        }
+        if (page.isEmpty()) {
+            return;
+        }
+
+        const int first = static_cast<int>(m_rows.size());
+        beginInsertRows(QModelIndex(), first, first + static_cast<int>(page.size()) - 1);
+        for (const Entity& entity : page) {
+            m_rowById.insert(entity.getId(), m_firstSequence + m_rows.size());
+            m_rows.append(Row{entity, QString()});
+        }
+        endInsertRows();
+    }
+
+    // -1 when the entity has not been fetched
+    int rowOf(const QString& id) const {
+        const auto it = m_rowById.constFind(id);
+        return it == m_rowById.constEnd() ? -1 : static_cast<int>(it.value() - m_firstSequence);
+    }
+
+    QString idAt(int row) const {
+        return row >= 0 && row < m_rows.size() ? m_rows.at(row).entity.getId() : QString();
+    }
+
+    // Fetches pages until @p id is loaded or the listing ends; returns its row or -1
+    int fetchUntil(const QString& id) {
+        int row = rowOf(id);
+        while (row < 0 && canFetchMore()) {
+            fetchMore();
+            row = rowOf(id);
+        }
+        return row;
+    }
+
+    // Drops every row; the next fetchMore() starts from the top
+    void reload() {
+        beginResetModel();
+        m_rows.clear();
+        m_rowById.clear();
+        m_firstSequence = 0;
+        m_nextPage = KeysetPosition();
+        m_atEnd = !hasSource();
+        endResetModel();
+    }
+
+    static constexpr int FETCH_PAGE_SIZE = 100;
+
+protected:
+    virtual bool hasSource() const = 0;
+    virtual std::unique_ptr<StorageCursor<Entity>> openCursor(const PageRequest& request) const = 0;
+    virtual Entity loadEntity(const QString& id) const = 0;
+    virtual QDateTime sortTime(const Entity& entity) const = 0;
+    virtual QString displayText(const Entity& entity) const = 0;
+    // Whether an entity belongs in the listing; must agree with filters()
+    virtual bool accepts(const Entity& entity) const { return entity.isValid(); }
+    virtual QStringList columns() const { return {}; }
+    virtual QList<QueryFilter> filters() const { return {}; }
+
+    void entityCreated(const QString& id) {
+        if (!hasSource() || rowOf(id) >= 0) {
+            return;
+        }
+        const Entity entity = loadEntity(id);
+        if (accepts(entity)) {
+            insertSorted(entity);
+        }
+    }
+
+    void entityUpdated(const QString& id) {
+        const int row = rowOf(id);
+        if (row < 0) {
+            // Not fetched yet, or it has only now come to match the listing
+            entityCreated(id);
+            return;
+        }
+        const Entity entity = loadEntity(id);
+        if (!accepts(entity) || sortTime(entity) != sortTime(m_rows.at(row).entity)) {
+            removeRowAt(row);
+            if (accepts(entity)) {
+                insertSorted(entity);
+            }
+            return;
+        }
+        m_rows[row] = Row{entity, QString()};
+        const QModelIndex changed = index(row);
+        emit dataChanged(changed, changed);
+    }
+
+    void entityDeleted(const QString& id) {
+        const int row = rowOf(id);
+        if (row >= 0) {
+            removeRowAt(row);
+        }
+    }
+
+    // One signal for many entities; a batch larger than a page reloads instead
+    void entitiesChanged(const QStringList& ids) {
+        if (ids.size() > FETCH_PAGE_SIZE) {
+            reload();
+            return;
+        }
+        for (const QString& id : ids) {
+            entityUpdated(id);
+        }
+    }
+
+private:
+    struct Row {
+        Entity entity;
+        mutable QString display;    // Built on first use
+    };
+
+    // Newest first: by time, then id, both descending, as the cursor orders them
+    bool isBefore(const Entity& a, const Entity& b) const {
+        const QDateTime timeA = sortTime(a);
+        const QDateTime timeB = sortTime(b);
+        return timeA != timeB ? timeA > timeB : a.getId() > b.getId();
+    }
+
+    void insertSorted(const Entity& entity) {
+        const auto position = std::lower_bound(m_rows.cbegin(), m_rows.cend(), entity,
+            [this](const Row& row, const Entity& value) { return isBefore(row.entity, value); });
+        const int row = static_cast<int>(position - m_rows.cbegin());
+        if (row == m_rows.size() && !m_atEnd) {
+            return; // Older than everything fetched: a later page brings it
+        }
+
+        beginInsertRows(QModelIndex(), row, row);
+        if (row == 0) {
+            // Every other row keeps its sequence number
+            --m_firstSequence;
+            m_rows.prepend(Row{entity, QString()});
+        } else {
+            m_rows.insert(row, Row{entity, QString()});
+            for (int below = row + 1; below < m_rows.size(); ++below) {
+                ++m_rowById[m_rows.at(below).entity.getId()];
+            }
+        }
+        m_rowById.insert(entity.getId(), m_firstSequence + row);
+        endInsertRows();
+    }
+
+    void removeRowAt(int row) {
+        beginRemoveRows(QModelIndex(), row, row);
+        m_rowById.remove(m_rows.at(row).entity.getId());
+        if (row == 0) {
+            ++m_firstSequence;
+        } else {
+            for (int below = row + 1; below < m_rows.size(); ++below) {
+                --m_rowById[m_rows.at(below).entity.getId()];
+            }
+        }
+        m_rows.removeAt(row);
+        endRemoveRows();
+    }
+
+    QList<Row> m_rows;
+    // Id -> sequence number; a row's index is its sequence minus m_firstSequence,
+    // so prepending only moves m_firstSequence
+    QHash<QString, qint64> m_rowById;
+    KeysetPosition m_nextPage;
+    bool m_atEnd;
+    qint64 m_firstSequence;
+};
@@ -3,8 +3,12 @@
 #include "services/TranscriptionService.h"
 #include "services/TextEnhancementService.h"
 #include "services/StorageManager.h"
+#include "services/ProcessingPipeline.h"
+#include "services/Telemetry.h"
 #include "services/ErrorHandler.h"
 #include "services/ConfigurationManager.h"
+#include "RecordingHistoryModel.h"
+#include "SessionListModel.h"
 #include "models/Recording.h"
 #include "models/Transcription.h"
 #include "models/EnhancedText.h"
@@ -13,7 +17,9 @@
 #include <QApplication>
 #include <QCloseEvent>
 #include <QResizeEvent>
+#include <QShowEvent>
 #include <QSettings>
+#include <QFileInfo>
 #include <QStandardPaths>
 #include <QMessageBox>
 #include <QFileDialog>
@@ -28,7 +34,7 @@
 #include <QComboBox>
 #include <QProgressBar>
 #include <QSlider>
-#include <QListWidget>
+#include <QListView>
 #include <QMenuBar>
 #include <QStatusBar>
 #include <QTimer>
@@ -38,12 +44,18 @@ MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
     , m_centralWidget(nullptr)
     , m_mainSplitter(nullptr)
+    , m_streamSegmented(false)
     , m_isRecording(false)
     , m_isPaused(false)
+    , m_startupScheduled(false)
     , m_uiUpdateTimer(new QTimer(this))
+    , m_telemetryExportTimer(new QTimer(this))
     , m_errorHandler(new ErrorHandler(this))
     , m_configManager(new ConfigurationManager(this))
 {
+    // Replaced by main()'s timer when it has one, which also covers what ran before us
+    m_launchTimer.start();
+    
     setWindowTitle("QuillScribe - Voice-to-Text with AI Enhancement");
     setMinimumSize(MIN_WINDOW_WIDTH, MIN_WINDOW_HEIGHT);
     resize(getOptimalWindowSize());
@@ -53,10 +65,11 @@ MainWindow::MainWindow(QWidget* parent)
     connect(m_errorHandler, &ErrorHandler::statusMessageRequested, this, &MainWindow::showStatusMessage);
     
     // Setup configuration manager
-    connect(m_configManager, &ConfigurationManager::settingChanged, this, &MainWindow::onSettingChanged);
+    connect(m_configManager, &ConfigurationManager::settingsChanged, this, &MainWindow::onSettingsChanged);
     connect(m_configManager, &ConfigurationManager::configurationLoaded, this, &MainWindow::onConfigurationLoaded);
     
-    // Initialize services first
+    // Initialize services first; nothing here touches the database or loads a model,
+    // both wait for completeStartup() once the window is up
     initializeServices();
     
     // Setup UI
@@ -74,10 +87,10 @@ MainWindow::MainWindow(QWidget* parent)
     connect(m_uiUpdateTimer, &QTimer::timeout, this, &MainWindow::updateUI);
     m_uiUpdateTimer->start();
     
-    // Create initial session if none exists
-    if (m_currentSessionId.isEmpty()) {
-        createNewSession();
-    }
+    // Percentiles for whoever watches the file; written only when a path is configured
+    m_telemetryExportTimer->setInterval(TELEMETRY_EXPORT_INTERVAL_MS);
+    connect(m_telemetryExportTimer, &QTimer::timeout, this, &MainWindow::exportTelemetry);
+    m_telemetryExportTimer->start();
     
     // Apply styling
     setupApplicationStyle();
@@ -112,9 +125,56 @@ void MainWindow::closeEvent(QCloseEvent* event) {
     
     saveCurrentSession();
     saveSettings();
+    exportTelemetry();
     event->accept();
 }
 
+void MainWindow::showEvent(QShowEvent* event) {
+    QMainWindow::showEvent(event);
+    
+    // Queued, so the window is laid out and painted before the deferred work starts
+    if (!m_startupScheduled) {
+        m_startupScheduled = true;
+        QTimer::singleShot(0, this, &MainWindow::completeStartup);
+    }
+}
+
+void MainWindow::setLaunchTimer(const QElapsedTimer& timer) {
+    m_launchTimer = timer;
+}
+
+void MainWindow::completeStartup() {
+    // One event loop turn with the window on screen: this is what the user waited for
+    const qint64 startupUs = m_launchTimer.nsecsElapsed() / 1000;
+    if (m_telemetry) {
+        m_telemetry->recordStage(Telemetry::STAGE_STARTUP, startupUs);
+    }
+    qInfo() << "Time to interactive:" << startupUs / 1000 << "ms";
+    if (startupUs / 1000 > TIME_TO_INTERACTIVE_TARGET_MS) {
+        qWarning() << "Startup exceeded its" << TIME_TO_INTERACTIVE_TARGET_MS << "ms target";
+    }
+    
+    initializeStorage();
+    
+    // Calibration and the model load both run on background threads; recording works meanwhile
+    applyBackendCalibration();
+    warmUpTranscriptionModel();
+}
+
+void MainWindow::warmUpTranscriptionModel() {
+    const auto provider = static_cast<TranscriptionProvider>(m_transcriptionProviderCombo->currentData().toInt());
+    if (!m_transcriptionService->isModelDownloaded(provider)) {
+        m_transcriptionStatusLabel->setText("Speech model not downloaded");
+        return;
+    }
+    
+    m_transcriptionService->setProvider(provider);
+    if (!m_transcriptionService->isModelLoaded(provider)) {
+        m_transcriptionStatusLabel->setText("Loading speech model...");
+        m_transcriptionService->preloadModel(provider);
+    }
+}
+
 void MainWindow::resizeEvent(QResizeEvent* event) {
     QMainWindow::resizeEvent(event);
     // Could handle responsive layout changes here
@@ -305,7 +365,10 @@ void MainWindow::setupSessionPanel() {
     // Session selection
     QHBoxLayout* sessionLayout = new QHBoxLayout;
     QLabel* sessionLabel = new QLabel("Current Session:");
+    // Both lists fill from the database page by page and follow its change signals
+    m_sessionModel = new SessionListModel(this);
     m_sessionComboBox = new QComboBox;
+    m_sessionComboBox->setModel(m_sessionModel);
     m_newSessionButton = new QPushButton("📋 New");
     
     sessionLayout->addWidget(sessionLabel);
@@ -314,7 +377,10 @@ void MainWindow::setupSessionPanel() {
     
     // Recording history
     QLabel* historyLabel = new QLabel("Recording History:");
-    m_recordingHistoryList = new QListWidget;
+    m_historyModel = new RecordingHistoryModel(this);
+    m_recordingHistoryList = new QListView;
+    m_recordingHistoryList->setUniformItemSizes(true); // Layout without measuring every row
+    m_recordingHistoryList->setModel(m_historyModel);
     m_recordingHistoryList->setMaximumHeight(200);
     
     // Action buttons
@@ -423,7 +489,8 @@ void MainWindow::setupConnections() {
     connect(m_transcriptionProviderCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onTranscriptionProviderChanged);
     connect(m_enhancementModeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onEnhancementModeChanged);
     connect(m_sessionComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onSessionSelectionChanged);
-    connect(m_recordingHistoryList, &QListWidget::currentItemChanged, this, &MainWindow::onRecordingSelectionChanged);
+    connect(m_recordingHistoryList->selectionModel(), &QItemSelectionModel::currentChanged,
+            this, &MainWindow::onRecordingSelectionChanged);
     
     connect(m_enhanceButton, &QPushButton::clicked, this, &MainWindow::onEnhanceButtonClicked);
     connect(m_retranscribeButton, &QPushButton::clicked, this, &MainWindow::retranscribe);
@@ -447,17 +514,21 @@ void MainWindow::setupConnections() {
 }
 
 void MainWindow::initializeServices() {
-    // Initialize storage manager first
+    // Every service records its stage timings here
+    m_telemetry = std::make_unique<Telemetry>();
+    
+    // Created first so the other services can hold it; opened by initializeStorage()
     m_storageManager = std::make_unique<StorageManager>();
-    QString dbPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/quillscribe.db";
-    if (!m_storageManager->initialize(dbPath)) {
-        m_errorHandler->reportCriticalError("Database Initialization Failed", 
-                                           "Failed to initialize database: " + m_storageManager->getErrorString());
-        return;
-    }
+    m_storageManager->setTelemetry(m_telemetry.get());
     
     // Initialize audio recorder service
     m_audioRecorderService = std::make_unique<AudioRecorderService>(m_storageManager.get());
+    m_audioRecorderService->setRecordingCodec(
+        audioCodecFromString(m_configManager->getAudioSetting("Format", "flac").toString()));
+    m_audioRecorderService->setAutoGainControl(m_configManager->getAudioSetting("AutoGainControl", true).toBool());
+    m_audioRecorderService->setNoiseReduction(m_configManager->getAudioSetting("NoiseReduction", true).toBool());
+    m_audioRecorderService->setSegmentDuration(segmentDurationSetting());
+    m_audioRecorderService->setTelemetry(m_telemetry.get());
     
     // Connect audio recorder signals
     connect(m_audioRecorderService.get(), &IAudioRecorder::recordingStarted, this, &MainWindow::onRecordingStarted);
@@ -470,31 +541,125 @@ void MainWindow::initializeServices() {
     
     // Initialize transcription service
     m_transcriptionService = std::make_unique<TranscriptionService>(m_storageManager.get());
+    m_transcriptionService->setModelMemoryBudget(
+        m_configManager->getTranscriptionSetting("ModelMemoryBudgetMB", 2048).toLongLong() * 1024 * 1024);
+    m_transcriptionService->setTelemetry(m_telemetry.get());
+    
+    // Warm-up finishes in the background; until then recording works and decodes wait for it
+    connect(m_transcriptionService.get(), &TranscriptionService::modelReady, this,
+            [this](TranscriptionProvider model, qint64 loadMs) {
+        if (model != m_transcriptionService->getCurrentProvider()) {
+            return;
+        }
+        if (m_transcriptionStatusLabel->text() == "Loading speech model...") {
+            m_transcriptionStatusLabel->setText("No transcription");
+        }
+        showStatusMessage(QString("Speech model ready (loaded in %1 ms)").arg(loadMs), 3000);
+    });
     
     // Connect transcription signals
     connect(m_transcriptionService.get(), &ITranscriptionService::transcriptionCompleted, this, &MainWindow::onTranscriptionCompleted);
     connect(m_transcriptionService.get(), &ITranscriptionService::transcriptionFailed, this, &MainWindow::onTranscriptionFailed);
     connect(m_transcriptionService.get(), &ITranscriptionService::transcriptionProgress, this, &MainWindow::onTranscriptionProgress);
+    connect(m_transcriptionService.get(), &ITranscriptionService::partialTranscription, this, &MainWindow::onPartialTranscription);
+    connect(m_transcriptionService.get(), &ITranscriptionService::segmentFinalized, this, &MainWindow::onSegmentFinalized);
+    connect(m_transcriptionService.get(), &ITranscriptionService::streamingTranscriptionFinished, this, &MainWindow::onStreamingTranscriptionFinished);
+    
+    // Remember the detected language on the session so later recordings skip detection
+    connect(m_transcriptionService.get(), &TranscriptionService::sessionLanguageDetected, this,
+            [this](const QString& sessionId, const QString& languageCode) {
+        if (auto* sessionStorage = m_storageManager->getUserSessionStorage()) {
+            UserSession session = sessionStorage->getUserSession(sessionId);
+            if (session.getId() == sessionId) {
+                session.setDetectedLanguage(languageCode);
+                sessionStorage->updateUserSession(session);
+            }
+        }
+    });
+    
+    // Feed captured PCM into the live transcription stream while recording, and keep
+    // short recordings in memory so re-transcription skips the disk round trip
+    m_audioRecorderService->setPcmStreamingEnabled(true);
+    m_audioRecorderService->setInMemoryCaptureEnabled(true);
+    connect(m_audioRecorderService.get(), &AudioRecorderService::pcmDataCaptured, this, [this](const QByteArray& pcmData) {
+        if (!m_streamId.isEmpty() && !m_streamSegmented) {
+            m_transcriptionService->appendStreamingAudio(m_streamId, pcmData);
+        }
+    });
+    
+    // In segmented mode each closed segment is transcribed while recording continues
+    connect(m_audioRecorderService.get(), &AudioRecorderService::recordingSegmentCompleted, this,
+            [this](int index, const QString& filePath, qint64 startMs, qint64 durationMs) {
+        Q_UNUSED(index)
+        Q_UNUSED(durationMs)
+        if (!m_streamId.isEmpty() && m_streamSegmented) {
+            m_transcriptionService->appendTranscriptionSegment(m_streamId, filePath, startMs);
+        }
+    });
     
     // Initialize text enhancement service  
     m_textEnhancementService = std::make_unique<TextEnhancementService>();
     // Note: TextEnhancementService doesn't need StorageManager constructor as it uses QSettings
+    // The local model decodes on the whisper pool, so the two never oversubscribe the cores
+    m_textEnhancementService->setLocalComputePool(m_transcriptionService->getDecodePool(),
+                                                  m_transcriptionService->getDecodeThreadCount());
+    m_textEnhancementService->setTelemetry(m_telemetry.get());
     
     // Connect enhancement signals
     connect(m_textEnhancementService.get(), &ITextEnhancementService::enhancementCompleted, this, &MainWindow::onEnhancementCompleted);
     connect(m_textEnhancementService.get(), &ITextEnhancementService::enhancementFailed, this, &MainWindow::onEnhancementFailed);
     connect(m_textEnhancementService.get(), &ITextEnhancementService::enhancementProgress, this, &MainWindow::onEnhancementProgress);
+    connect(m_textEnhancementService.get(), &ITextEnhancementService::enhancementPartialResult, this, &MainWindow::onEnhancementPartialResult);
     
     // Connect storage manager signals for real-time UI updates
     connect(m_storageManager.get(), &IStorageManager::databaseConnected, this, &MainWindow::onDatabaseConnected);
     connect(m_storageManager.get(), &IStorageManager::databaseDisconnected, this, &MainWindow::onDatabaseDisconnected);
     connect(m_storageManager.get(), &IStorageManager::errorOccurred, this, &MainWindow::onStorageError);
     
+    qDebug() << "All services initialized successfully";
+}
+
+void MainWindow::initializeStorage() {
+    QString dbPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/quillscribe.db";
+    const bool opened = m_storageManager->initialize(dbPath);
+    if (opened) {
+        m_audioRecorderService->recoverInterruptedRecordings();
+    } else {
+        // Transcription still works; nothing is saved
+        m_errorHandler->reportCriticalError("Database Initialization Failed", 
+                                           "Failed to initialize database: " + m_storageManager->getErrorString());
+    }
+    
+    // Recordings go through transcription, enhancement and storage as overlapping
+    // stages; the services' own signals still drive the panels
+    m_pipeline = std::make_unique<ProcessingPipeline>(m_transcriptionService.get(), m_textEnhancementService.get(),
+                                                      m_storageManager->getAsyncStorage());
+    connect(m_pipeline.get(), &ProcessingPipeline::acceptingChanged, this, [this](bool accepting) {
+        updateRecordingControls();
+        if (!accepting) {
+            showStatusMessage("Still processing earlier recordings - recording resumes shortly");
+        }
+    });
+    connect(m_pipeline.get(), &ProcessingPipeline::jobFailed, this,
+            [this](const QString& jobId, ProcessingPipeline::Stage stage, const QString& errorMessage) {
+        Q_UNUSED(jobId)
+        if (stage == ProcessingPipeline::Stage::Transcribe) {
+            m_transcriptionProgressBar->setVisible(false);
+            m_transcriptionStatusLabel->setText("Transcription failed");
+        } else if (stage == ProcessingPipeline::Stage::Enhance) {
+            m_enhancementProgressBar->setVisible(false);
+            m_enhancementStatusLabel->setText("Enhancement failed");
+        }
+        showStatusMessage("Processing failed: " + errorMessage);
+    });
+    
     // Connect recording storage signals
     if (auto* recordingStorage = m_storageManager->getRecordingStorage()) {
         connect(recordingStorage, &IRecordingStorage::recordingCreated, this, &MainWindow::onRecordingCreated);
         connect(recordingStorage, &IRecordingStorage::recordingUpdated, this, &MainWindow::onRecordingUpdated);
         connect(recordingStorage, &IRecordingStorage::recordingDeleted, this, &MainWindow::onRecordingDeleted);
+        connect(recordingStorage, &IRecordingStorage::recordingsCreated, this, &MainWindow::onRecordingsChanged);
+        connect(recordingStorage, &IRecordingStorage::recordingsUpdated, this, &MainWindow::onRecordingsChanged);
     }
     
     // Connect session storage signals  
@@ -504,7 +669,28 @@ void MainWindow::initializeServices() {
         connect(sessionStorage, &IUserSessionStorage::sessionEnded, this, &MainWindow::onSessionEnded);
     }
     
-    qDebug() << "All services initialized successfully";
+    if (!opened) {
+        return;
+    }
+    
+    m_historyModel->setSessionId(m_currentSessionId);
+    m_historyModel->setStorage(m_storageManager->getRecordingStorage());
+    m_sessionModel->setStorage(m_storageManager->getUserSessionStorage());
+    updateSessionList();
+    
+    // The last session's detected language is a read, so it runs off the GUI thread
+    if (!m_currentSessionId.isEmpty()) {
+        const QString sessionId = m_currentSessionId;
+        m_storageManager->getAsyncStorage()->getUserSession(sessionId).then(this, [this, sessionId](const UserSession& session) {
+            if (session.getId() == sessionId && !session.getDetectedLanguage().isEmpty()) {
+                m_transcriptionService->setSessionLanguage(sessionId, session.getDetectedLanguage());
+            }
+        });
+    } else {
+        createNewSession();
+    }
+    
+    qDebug() << "Storage initialized";
 }
 
 void MainWindow::initializeSettings() {
@@ -535,6 +721,7 @@ void MainWindow::loadSettings() {
     }
     
     // Service settings
+    // Its detected language is looked up once the database is open
     QString lastSessionId = m_configManager->getCurrentSessionId();
     if (!lastSessionId.isEmpty()) {
         m_currentSessionId = lastSessionId;
@@ -547,8 +734,10 @@ void MainWindow::loadSettings() {
     }
     
     // Provider selections
+    // Without the change signal: the model is warmed up after the window is shown
     int transcriptionProvider = m_configManager->getTranscriptionProvider();
     if (m_transcriptionProviderCombo) {
+        QSignalBlocker blocker(m_transcriptionProviderCombo);
         m_transcriptionProviderCombo->setCurrentIndex(transcriptionProvider);
     }
     
@@ -582,6 +771,9 @@ void MainWindow::saveSettings() {
     if (m_enhancementModeCombo) {
         m_configManager->setEnhancementMode(m_enhancementModeCombo->currentIndex());
     }
+    
+    // Called on the way out; don't leave it to the debounce timer
+    m_configManager->flush();
 }
 
 // Recording control slots
@@ -616,12 +808,25 @@ void MainWindow::onRecordingStarted() {
 }
 
 void MainWindow::onRecordingStopped(const QString& filePath, qint64 duration) {
-    Q_UNUSED(filePath)
     Q_UNUSED(duration)
     
+    m_lastRecordingPath = filePath;
     m_isRecording = false;
     m_isPaused = false;
     updateRecordingControls();
+    
+    // A live stream only needs to decode its last window
+    if (!m_streamId.isEmpty()) {
+        showStatusMessage("Recording completed - Finalizing transcription...");
+        m_transcriptionStatusLabel->setText("Finalizing transcription...");
+        if (m_streamSegmented) {
+            m_transcriptionService->finishSegmentedTranscription(m_streamId);
+        } else {
+            m_transcriptionService->finishStreamingTranscription(m_streamId);
+        }
+        return;
+    }
+    
     showStatusMessage("Recording completed - Starting transcription...");
     
     // Start transcription automatically
@@ -682,7 +887,9 @@ void MainWindow::onTranscriptionCompleted(const QString& requestId, const Transc
 }
 
 void MainWindow::onTranscriptionFailed(const QString& requestId, TranscriptionError error, const QString& errorMessage) {
-    Q_UNUSED(requestId)
+    if (requestId == m_streamId) {
+        m_streamId.clear();
+    }
     
     m_transcriptionProgressBar->setVisible(false);
     m_transcriptionStatusLabel->setText("Transcription failed");
@@ -699,6 +906,49 @@ void MainWindow::onTranscriptionProgress(const QString& requestId, int progressP
     m_transcriptionStatusLabel->setText(QString("Transcribing... %1%").arg(progressPercent));
 }
 
+void MainWindow::onPartialTranscription(const QString& streamId, const QString& text, qint64 startMs, qint64 endMs) {
+    Q_UNUSED(startMs)
+    Q_UNUSED(endMs)
+    
+    if (streamId != m_streamId) {
+        return;
+    }
+    
+    m_transcriptionStatusLabel->setText("Transcribing live...");
+    m_transcriptionTextEdit->setPlainText((m_streamFinalizedText + " " + text).trimmed());
+}
+
+void MainWindow::onSegmentFinalized(const QString& streamId, const QString& text, qint64 startMs, qint64 endMs) {
+    Q_UNUSED(startMs)
+    Q_UNUSED(endMs)
+    
+    if (streamId != m_streamId) {
+        return;
+    }
+    
+    m_streamFinalizedText = (m_streamFinalizedText + " " + text).trimmed();
+    m_transcriptionTextEdit->setPlainText(m_streamFinalizedText);
+}
+
+void MainWindow::onStreamingTranscriptionFinished(const QString& streamId, const TranscriptionResult& result) {
+    if (streamId != m_streamId) {
+        return;
+    }
+    
+    m_streamId.clear();
+    onTranscriptionCompleted(streamId, result);
+    
+    if (m_configManager->getEnhancementSetting("AutoEnhance", false).toBool() && !result.text.trimmed().isEmpty()) {
+        ProcessingPipeline::Job job;
+        job.text = result.text;
+        // Only segmented streams save their transcript against the recording
+        job.recordingId = m_streamSegmented ? m_currentRecordingId : QString();
+        job.enhancementSettings = currentEnhancementSettings();
+        job.enhancementProvider = m_textEnhancementService->getCurrentProvider();
+        m_pipeline->submit(job);
+    }
+}
+
 void MainWindow::onEnhancementCompleted(const QString& requestId, const EnhancementResult& result) {
     Q_UNUSED(requestId)
     
@@ -727,6 +977,13 @@ void MainWindow::onEnhancementProgress(const QString& requestId, int progressPer
     m_enhancementStatusLabel->setText(QString("Enhancing... %1%").arg(progressPercent));
 }
 
+void MainWindow::onEnhancementPartialResult(const QString& requestId, const QString& partialText) {
+    Q_UNUSED(requestId)
+    
+    // Streamed text shows up as it is generated; enhancementCompleted replaces it with the final result
+    m_enhancedTextEdit->setText(partialText);
+}
+
 // UI interaction slots (simplified implementations)
 void MainWindow::onDeviceSelectionChanged() {
     if (!m_audioRecorderService || !m_deviceComboBox) {
@@ -765,6 +1022,7 @@ void MainWindow::onTranscriptionProviderChanged() {
     if (m_transcriptionProviderCombo) {
         int provider = m_transcriptionProviderCombo->currentIndex();
         m_configManager->setTranscriptionProvider(provider);
+        warmUpTranscriptionModel();
     }
 }
 
@@ -778,6 +1036,10 @@ void MainWindow::onEnhancementModeChanged() {
 
 void MainWindow::onSessionSelectionChanged() {
     // Load selected session
+    if (m_sessionComboBox && m_sessionComboBox->currentData().isValid()) {
+        m_currentSessionId = m_sessionComboBox->currentData().toString();
+    }
+    updateRecordingHistory();
 }
 
 void MainWindow::onRecordingSelectionChanged() {
@@ -848,30 +1110,32 @@ void MainWindow::onStorageError(StorageError error, const QString& errorMessage)
 
 void MainWindow::onRecordingCreated(const QString& recordingId) {
     qDebug() << "Recording created in database:" << recordingId;
-    updateRecordingHistory();
     updateStatusBar();
 }
 
 void MainWindow::onRecordingUpdated(const QString& recordingId) {
     qDebug() << "Recording updated in database:" << recordingId;
-    updateRecordingHistory();
+    updateStatusBar();
+}
+
+void MainWindow::onRecordingsChanged(const QStringList& recordingIds) {
+    qDebug() << recordingIds.size() << "recordings written to database";
     updateStatusBar();
 }
 
 void MainWindow::onRecordingDeleted(const QString& recordingId) {
     qDebug() << "Recording deleted from database:" << recordingId;
-    updateRecordingHistory();
     updateStatusBar();
 }
 
 void MainWindow::onSessionCreated(const QString& sessionId) {
     qDebug() << "Session created in database:" << sessionId;
-    updateSessionList();
     
     // Set as current session if we don't have one
     if (m_currentSessionId.isEmpty()) {
         m_currentSessionId = sessionId;
     }
+    updateSessionList();
 }
 
 void MainWindow::onSessionStarted(const QString& sessionId) {
@@ -882,22 +1146,38 @@ void MainWindow::onSessionStarted(const QString& sessionId) {
 void MainWindow::onSessionEnded(const QString& sessionId) {
     qDebug() << "Session ended:" << sessionId;
     showStatusMessage("Session ended: " + sessionId);
-    updateSessionList();
 }
 
 // Configuration management slots
-void MainWindow::onSettingChanged(const QString& key, const QVariant& value) {
-    qDebug() << "Setting changed:" << key << "=" << value;
-    
-    // Handle specific setting changes that require immediate UI updates
-    if (key == "Audio/InputGain" && m_inputGainSlider) {
-        m_inputGainSlider->setValue(value.toInt());
-    } else if (key == "Transcription/Provider" && m_transcriptionProviderCombo) {
-        m_transcriptionProviderCombo->setCurrentIndex(value.toInt());
-    } else if (key == "Enhancement/Mode" && m_enhancementModeCombo) {
-        m_enhancementModeCombo->setCurrentIndex(value.toInt());
-    } else if (key == "Application/CurrentSessionId") {
-        m_currentSessionId = value.toString();
+void MainWindow::onSettingsChanged(ConfigurationManager::SettingsCategory category, const QStringList& keys) {
+    qDebug() << "Settings changed:" << keys;
+    
+    // Everything in it is state this window saved itself
+    if (category == ConfigurationManager::SettingsCategory::UI) {
+        return;
+    }
+    
+    // A batch can hold several writes of one key: apply the current value, once
+    if (keys.contains("Audio/InputGain") && m_inputGainSlider) {
+        m_inputGainSlider->setValue(m_configManager->getInputGain());
+    }
+    if (keys.contains("Audio/AutoGainControl") && m_audioRecorderService) {
+        m_audioRecorderService->setAutoGainControl(m_configManager->getAudioSetting("AutoGainControl", true).toBool());
+    }
+    if (keys.contains("Audio/NoiseReduction") && m_audioRecorderService) {
+        m_audioRecorderService->setNoiseReduction(m_configManager->getAudioSetting("NoiseReduction", true).toBool());
+    }
+    if ((keys.contains("Audio/SegmentedRecording") || keys.contains("Audio/SegmentSeconds")) && m_audioRecorderService) {
+        m_audioRecorderService->setSegmentDuration(segmentDurationSetting());
+    }
+    if (keys.contains("Transcription/Provider") && m_transcriptionProviderCombo) {
+        m_transcriptionProviderCombo->setCurrentIndex(m_configManager->getTranscriptionProvider());
+    }
+    if (keys.contains("Enhancement/Mode") && m_enhancementModeCombo) {
+        m_enhancementModeCombo->setCurrentIndex(m_configManager->getEnhancementMode());
+    }
+    if (keys.contains("Application/CurrentSessionId")) {
+        m_currentSessionId = m_configManager->getCurrentSessionId();
         updateSessionList();
     }
 }
@@ -927,6 +1207,7 @@ void MainWindow::updateRecordingControls() {
             m_recordButton->setStyleSheet("QPushButton { background-color: #ff9800; color: white; font-weight: bold; padding: 10px; }");
             m_pauseButton->setEnabled(true);
         }
+        m_recordButton->setEnabled(true);
         m_stopButton->setEnabled(true);
         m_recordingStatusLabel->setText(m_isPaused ? "Paused" : "Recording...");
     } else {
@@ -934,7 +1215,10 @@ void MainWindow::updateRecordingControls() {
         m_recordButton->setStyleSheet("QPushButton { background-color: #4CAF50; color: white; font-weight: bold; padding: 10px; }");
         m_pauseButton->setEnabled(false);
         m_stopButton->setEnabled(false);
-        m_recordingStatusLabel->setText("Ready");
+        // Backpressure: no new recordings while earlier ones are still queued up
+        const bool accepting = !m_pipeline || m_pipeline->isAccepting();
+        m_recordButton->setEnabled(accepting);
+        m_recordingStatusLabel->setText(accepting ? "Ready" : "Processing...");
     }
 }
 
@@ -983,11 +1267,26 @@ void MainWindow::updateDeviceList() {
 }
 
 void MainWindow::updateSessionList() {
-    // Update session list
+    // The model keeps the rows current; this only selects the current session
+    if (!m_sessionComboBox || !m_sessionModel) {
+        return;
+    }
+    
+    // Rows the combo fetches here must not switch sessions on their own
+    QSignalBlocker blocker(m_sessionComboBox);
+    if (m_sessionModel->rowCount() == 0 && m_sessionModel->canFetchMore()) {
+        m_sessionModel->fetchMore();
+    }
+    const int row = m_currentSessionId.isEmpty() ? -1 : m_sessionModel->fetchUntil(m_currentSessionId);
+    m_sessionComboBox->setCurrentIndex(row);
+    updateRecordingHistory();
 }
 
 void MainWindow::updateRecordingHistory() {
-    // Update recording history
+    // Reloads only when the session changed; the view fetches pages as it scrolls
+    if (m_historyModel) {
+        m_historyModel->setSessionId(m_currentSessionId);
+    }
 }
 
 void MainWindow::updateStatusBar() {
@@ -1001,7 +1300,8 @@ void MainWindow::startRecording() {
     
     // Generate recording file path
     QString recordingPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + 
-                           "/recordings/" + QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss") + ".wav";
+                           "/recordings/" + QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss") + "." +
+                           m_audioRecorderService->getRecordingFileSuffix();
     
     // Create recording directory if it doesn't exist
     QDir().mkpath(QFileInfo(recordingPath).absolutePath());
@@ -1013,6 +1313,27 @@ void MainWindow::startRecording() {
         // Recording will be automatically saved to storage by the AudioRecorderService
         // Get the recording ID from the service
         m_currentRecordingId = m_audioRecorderService->getCurrentRecordingId();
+        
+        // Start live transcription alongside the recording
+        const QAudioFormat format = m_audioRecorderService->getAudioFormat();
+        TranscriptionRequest request;
+        request.language = "auto";
+        request.preferredProvider = TranscriptionProvider::Unknown;
+        request.priority = TranscriptionPriority::Interactive;
+        request.options["sessionId"] = m_currentSessionId;
+        request.options["sampleRate"] = format.sampleRate();
+        request.options["channelCount"] = format.channelCount();
+        request.options["bytesPerSample"] = format.bytesPerSample();
+        request.options["isFloat"] = format.sampleFormat() == QAudioFormat::Float;
+        
+        m_streamFinalizedText.clear();
+        m_streamSegmented = m_audioRecorderService->getSegmentDuration() > 0;
+        if (m_streamSegmented) {
+            request.options["recordingId"] = m_currentRecordingId;
+            m_streamId = m_transcriptionService->startSegmentedTranscription(request);
+        } else {
+            m_streamId = m_transcriptionService->startStreamingTranscription(request);
+        }
     }
 }
 
@@ -1034,9 +1355,15 @@ void MainWindow::resumeRecording() {
     }
 }
 
+int MainWindow::segmentDurationSetting() const {
+    if (!m_configManager->getAudioSetting("SegmentedRecording", false).toBool()) {
+        return 0;
+    }
+    const int defaultSeconds = AudioRecorderService::DEFAULT_SEGMENT_DURATION_MS / 1000;
+    return qMax(1, m_configManager->getAudioSetting("SegmentSeconds", defaultSeconds).toInt()) * 1000;
+}
+
 void MainWindow::startTranscription(const QString& recordingId) {
-    Q_UNUSED(recordingId)
-    
     if (!validateTranscriptionSettings()) {
         return;
     }
@@ -1045,7 +1372,31 @@ void MainWindow::startTranscription(const QString& recordingId) {
     m_transcriptionProgressBar->setVisible(true);
     m_transcriptionProgressBar->setValue(0);
     
-    // Implementation would create transcription request and submit to service
+    TranscriptionRequest request;
+    // Prefer the whisper-ready copy converted during capture
+    const QString transcriptionStreamPath = m_audioRecorderService->getTranscriptionStreamPath();
+    request.audioFilePath = QFileInfo::exists(transcriptionStreamPath) ? transcriptionStreamPath : m_lastRecordingPath;
+    request.audioBuffer = m_audioRecorderService->getCapturedAudio(); // Shared, not copied
+    request.language = "auto";
+    request.preferredProvider = TranscriptionProvider::Unknown;
+    request.priority = TranscriptionPriority::Interactive;
+    request.options["recordingId"] = recordingId;
+    request.options["sessionId"] = m_currentSessionId;
+    
+    ProcessingPipeline::Job job;
+    job.transcription = request;
+    job.recordingId = recordingId;
+    job.enhance = m_configManager->getEnhancementSetting("AutoEnhance", false).toBool();
+    job.enhancementSettings = currentEnhancementSettings();
+    job.enhancementProvider = m_textEnhancementService->getCurrentProvider();
+    
+    m_currentTranscriptionId = m_pipeline->submit(job);
+    if (m_currentTranscriptionId.isEmpty()) {
+        m_transcriptionProgressBar->setVisible(false);
+        m_transcriptionStatusLabel->setText("Transcription queue full");
+        m_errorHandler->reportWarning("Transcription Busy",
+                                      "Earlier recordings are still being transcribed. Please try again shortly.");
+    }
 }
 
 void MainWindow::retranscribe() {
@@ -1067,11 +1418,24 @@ void MainWindow::startEnhancement(const QString& transcriptionId) {
         return;
     }
     
+    ProcessingPipeline::Job job;
+    job.text = textToEnhance;
+    job.recordingId = m_currentRecordingId;
+    job.enhancementSettings = currentEnhancementSettings();
+    job.enhancementProvider = m_textEnhancementService->getCurrentProvider();
+    if (m_pipeline->submit(job).isEmpty()) {
+        m_errorHandler->reportWarning("Enhancement Busy", "Too many enhancements are queued. Please try again shortly.");
+        return;
+    }
+    
     m_enhancementStatusLabel->setText("Starting enhancement...");
     m_enhancementProgressBar->setVisible(true);
     m_enhancementProgressBar->setValue(0);
-    
-    // Implementation would create enhancement request and submit to service
+}
+
+EnhancementSettings MainWindow::currentEnhancementSettings() const {
+    const auto mode = static_cast<EnhancementMode>(m_enhancementModeCombo->currentData().toInt());
+    return m_textEnhancementService->getDefaultSettings(mode);
 }
 
 void MainWindow::createNewSession() {
@@ -1114,6 +1478,38 @@ bool MainWindow::validateRecordingSettings() {
     return true;
 }
 
+void MainWindow::applyBackendCalibration() {
+    // Reuse measurements from earlier runs; the active model is benchmarked once on first use
+    for (TranscriptionProvider model : m_transcriptionService->getAvailableProviders()) {
+        const QVariantMap calibration = m_configManager->getBackendCalibration(m_transcriptionService->getModelFileName(model));
+        if (calibration.isEmpty()) {
+            continue;
+        }
+        
+        TranscriptionService::BackendConfig config;
+        config.useGpu = calibration.value("useGpu", true).toBool();
+        config.threadCount = calibration.value("threadCount").toInt();
+        config.encodeMs = calibration.value("encodeMs").toDouble();
+        m_transcriptionService->setBackendConfig(model, config);
+    }
+    
+    connect(m_transcriptionService.get(), &TranscriptionService::backendCalibrated, this,
+            [this](TranscriptionProvider model, bool useGpu, int threadCount, double encodeMs) {
+        QVariantMap calibration;
+        calibration["useGpu"] = useGpu;
+        calibration["threadCount"] = threadCount;
+        calibration["encodeMs"] = encodeMs;
+        m_configManager->setBackendCalibration(m_transcriptionService->getModelFileName(model), calibration);
+        qDebug() << "Calibrated" << m_transcriptionService->getModelFileName(model) << calibration;
+    });
+    
+    const TranscriptionProvider current = m_transcriptionService->getCurrentProvider();
+    if (m_transcriptionService->getBackendConfig(current).threadCount <= 0 &&
+        m_transcriptionService->isModelDownloaded(current)) {
+        m_transcriptionService->calibrateBackend(current);
+    }
+}
+
 bool MainWindow::validateTranscriptionSettings() {
     return m_transcriptionService != nullptr;
 }
@@ -1240,6 +1636,17 @@ QSize MainWindow::getOptimalWindowSize() const {
     return QSize(DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT);
 }
 
+void MainWindow::exportTelemetry() {
+    const QString exportPath = m_configManager->getApplicationSetting("TelemetryExportPath").toString();
+    if (!m_telemetry || exportPath.isEmpty()) {
+        return;
+    }
+    QString errorMessage;
+    if (!m_telemetry->exportJson(exportPath, &errorMessage)) {
+        qWarning() << errorMessage;
+    }
+}
+
 void MainWindow::updateRecordingTimer() {
     if (m_isRecording && !m_isPaused) {
         qint64 elapsed = m_recordingTimer.elapsed();
@@ -12,7 +12,7 @@
 #include <QHBoxLayout>
 #include <QGridLayout>
 #include <QGroupBox>
-#include <QListWidget>
+#include <QListView>
 #include <QSplitter>
 #include <QMenuBar>
 #include <QStatusBar>
@@ -27,12 +27,18 @@
 #include "../specs/001-voice-to-text/contracts/transcription-service-interface.h"
 #include "../specs/001-voice-to-text/contracts/ai-enhancement-interface.h"
 #include "../specs/001-voice-to-text/contracts/storage-interface.h"
+#include "models/Recording.h"
+#include "services/ConfigurationManager.h"
 
 // Forward declarations for services
 class AudioRecorderService;
 class TranscriptionService;
 class TextEnhancementService;
 class StorageManager;
+class ProcessingPipeline;
+class Telemetry;
+class RecordingHistoryModel;
+class SessionListModel;
 
 // Forward declarations for models
 class Recording;
@@ -54,7 +60,11 @@ public:
     explicit MainWindow(QWidget* parent = nullptr);
     ~MainWindow() override;
 
+    // Started when the process did; time-to-interactive is measured from it
+    void setLaunchTimer(const QElapsedTimer& timer);
+
 protected:
+    void showEvent(QShowEvent* event) override;
     void closeEvent(QCloseEvent* event) override;
     void resizeEvent(QResizeEvent* event) override;
 
@@ -78,11 +88,15 @@ private slots:
     void onTranscriptionCompleted(const QString& requestId, const TranscriptionResult& result);
     void onTranscriptionFailed(const QString& requestId, TranscriptionError error, const QString& errorMessage);
     void onTranscriptionProgress(const QString& requestId, int progressPercent);
+    void onPartialTranscription(const QString& streamId, const QString& text, qint64 startMs, qint64 endMs);
+    void onSegmentFinalized(const QString& streamId, const QString& text, qint64 startMs, qint64 endMs);
+    void onStreamingTranscriptionFinished(const QString& streamId, const TranscriptionResult& result);
     
     // Enhancement slots
     void onEnhancementCompleted(const QString& requestId, const EnhancementResult& result);
     void onEnhancementFailed(const QString& requestId, EnhancementError error, const QString& errorMessage);
     void onEnhancementProgress(const QString& requestId, int progressPercent);
+    void onEnhancementPartialResult(const QString& requestId, const QString& partialText);
     
     // UI interaction slots
     void onDeviceSelectionChanged();
@@ -109,13 +123,14 @@ private slots:
     void onStorageError(StorageError error, const QString& errorMessage);
     void onRecordingCreated(const QString& recordingId);
     void onRecordingUpdated(const QString& recordingId);
+    void onRecordingsChanged(const QStringList& recordingIds);
     void onRecordingDeleted(const QString& recordingId);
     void onSessionCreated(const QString& sessionId);
     void onSessionStarted(const QString& sessionId);
     void onSessionEnded(const QString& sessionId);
     
     // Configuration management slots
-    void onSettingChanged(const QString& key, const QVariant& value);
+    void onSettingsChanged(ConfigurationManager::SettingsCategory category, const QStringList& keys);
     void onConfigurationLoaded();
     
     // Update slots
@@ -125,10 +140,12 @@ private slots:
 
 private:
     // Core services
+    std::unique_ptr<Telemetry> m_telemetry; // First, so it outlives every service recording into it
     std::unique_ptr<AudioRecorderService> m_audioRecorderService;
     std::unique_ptr<TranscriptionService> m_transcriptionService;
     std::unique_ptr<TextEnhancementService> m_textEnhancementService;
     std::unique_ptr<StorageManager> m_storageManager;
+    std::unique_ptr<ProcessingPipeline> m_pipeline; // Last, so it is gone before the services it drives
     
     // Error handling
     class ErrorHandler* m_errorHandler;
@@ -140,8 +157,14 @@ private:
     QString m_currentSessionId;
     QString m_currentRecordingId;
     QString m_currentTranscriptionId;
+    QString m_lastRecordingPath;
+    QString m_streamId;             // Live transcription of the current recording
+    QString m_streamFinalizedText;
+    bool m_streamSegmented;         // m_streamId decodes closed segment files instead of live PCM
     bool m_isRecording;
     bool m_isPaused;
+    bool m_startupScheduled;
+    QElapsedTimer m_launchTimer;
     QElapsedTimer m_recordingTimer;
     
     // UI Components - Main Layout
@@ -178,8 +201,10 @@ private:
     // Session and History Panel
     QGroupBox* m_sessionGroup;
     QComboBox* m_sessionComboBox;
+    SessionListModel* m_sessionModel;
     QPushButton* m_newSessionButton;
-    QListWidget* m_recordingHistoryList;
+    QListView* m_recordingHistoryList;
+    RecordingHistoryModel* m_historyModel;
     QPushButton* m_clearButton;
     QPushButton* m_saveButton;
     
@@ -192,6 +217,7 @@ private:
     // Status and Progress
     QProgressBar* m_globalProgressBar;
     QTimer* m_uiUpdateTimer;
+    QTimer* m_telemetryExportTimer;
     
     // Menu and toolbar
     QMenuBar* m_menuBar;
@@ -222,6 +248,10 @@ private:
     
     // Initialization methods
     void initializeServices();
+    // After the first show: opens the database, then warms the model in the background
+    void completeStartup();
+    void initializeStorage();
+    void warmUpTranscriptionModel();
     void initializeSettings();
     void loadSettings();
     void saveSettings();
@@ -245,9 +275,12 @@ private:
     void startTranscription(const QString& recordingId);
     void retranscribe();
     bool validateTranscriptionSettings();
+    void applyBackendCalibration();
+    int segmentDurationSetting() const; // 0 when segmented recording is off
     
     // Enhancement management
     void startEnhancement(const QString& transcriptionId);
+    EnhancementSettings currentEnhancementSettings() const;
     bool validateEnhancementSettings();
     
     // Session management
@@ -274,8 +307,13 @@ private:
     void setupApplicationStyle();
     QSize getOptimalWindowSize() const;
     
+    // Writes the telemetry snapshot to Application/TelemetryExportPath, when set
+    void exportTelemetry();
+    
     // Constants
     static constexpr int UI_UPDATE_INTERVAL_MS = 100;
+    static constexpr int TELEMETRY_EXPORT_INTERVAL_MS = 60000;
+    static constexpr int TIME_TO_INTERACTIVE_TARGET_MS = 1000;
     static constexpr int DEFAULT_WINDOW_WIDTH = 1200;
     static constexpr int DEFAULT_WINDOW_HEIGHT = 800;
     static constexpr int MIN_WINDOW_WIDTH = 800;
@@ -0,0 +1,63 @@
+#include "RecordingHistoryModel.h"
+
+RecordingHistoryModel::RecordingHistoryModel(QObject* parent)
+    : KeysetListModel<Recording>(parent)
+{
+}
+
+void RecordingHistoryModel::setStorage(IRecordingStorage* storage) {
+    if (m_storage) {
+        disconnect(m_storage, nullptr, this, nullptr);
+    }
+    m_storage = storage;
+    if (m_storage) {
+        connect(m_storage, &IRecordingStorage::recordingCreated, this, [this](const QString& id) { entityCreated(id); });
+        connect(m_storage, &IRecordingStorage::recordingUpdated, this, [this](const QString& id) { entityUpdated(id); });
+        connect(m_storage, &IRecordingStorage::recordingDeleted, this, [this](const QString& id) { entityDeleted(id); });
+        connect(m_storage, &IRecordingStorage::recordingsCreated, this, [this](const QStringList& ids) { entitiesChanged(ids); });
+        connect(m_storage, &IRecordingStorage::recordingsUpdated, this, [this](const QStringList& ids) { entitiesChanged(ids); });
+    }
+    reload();
+}
+
+void RecordingHistoryModel::setSessionId(const QString& sessionId) {
+    if (sessionId == m_sessionId) {
+        return;
+    }
+    m_sessionId = sessionId;
+    reload();
+}
+
+std::unique_ptr<StorageCursor<Recording>> RecordingHistoryModel::openCursor(const PageRequest& request) const {
+    return m_storage ? m_storage->openRecordingCursor(request) : nullptr;
+}
+
+Recording RecordingHistoryModel::loadEntity(const QString& id) const {
+    return m_storage ? m_storage->getRecording(id) : Recording();
+}
+
+QString RecordingHistoryModel::displayText(const Recording& recording) const {
+    return QString("%1  (%2 s)")
+        .arg(recording.getTimestamp().toString("yyyy-MM-dd hh:mm:ss"))
+        .arg(recording.getDuration() / 1000);
+}
+
+bool RecordingHistoryModel::accepts(const Recording& recording) const {
+    return recording.isValid() && (m_sessionId.isEmpty() || recording.getSessionId() == m_sessionId);
+}
+
+QStringList RecordingHistoryModel::columns() const {
+    // The waveform and segment columns are the bulk of a row; the list needs neither
+    return {"session_id", "duration", "status"};
+}
+
+QList<QueryFilter> RecordingHistoryModel::filters() const {
+    if (m_sessionId.isEmpty()) {
+        return {};
+    }
+    QueryFilter filter;
+    filter.field = "session_id";
+    filter.operation = "=";
+    filter.value = m_sessionId;
+    return {filter};
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "KeysetListModel.h"
+#include "models/Recording.h"
+#include <QPointer>
+
+/**
+ * @brief The recording history list: every recording, or one session's, newest first
+ *
+ * Pages come from IRecordingStorage::openRecordingCursor() with only the columns the
+ * list shows; the storage's recording signals keep the rows current without reloading.
+ */
+class RecordingHistoryModel : public KeysetListModel<Recording> {
+    Q_OBJECT
+
+public:
+    explicit RecordingHistoryModel(QObject* parent = nullptr);
+
+    // Reloads; null empties the list
+    void setStorage(IRecordingStorage* storage);
+    // Empty lists every session's recordings
+    void setSessionId(const QString& sessionId);
+    QString sessionId() const { return m_sessionId; }
+
+protected:
+    bool hasSource() const override { return !m_storage.isNull(); }
+    std::unique_ptr<StorageCursor<Recording>> openCursor(const PageRequest& request) const override;
+    Recording loadEntity(const QString& id) const override;
+    QDateTime sortTime(const Recording& recording) const override { return recording.getTimestamp(); }
+    QString displayText(const Recording& recording) const override;
+    bool accepts(const Recording& recording) const override;
+    QStringList columns() const override;
+    QList<QueryFilter> filters() const override;
+
+private:
+    QPointer<IRecordingStorage> m_storage;
+    QString m_sessionId;
+};
@@ -0,0 +1,40 @@
+#include "SessionListModel.h"
+
+SessionListModel::SessionListModel(QObject* parent)
+    : KeysetListModel<UserSession>(parent)
+{
+}
+
+void SessionListModel::setStorage(IUserSessionStorage* storage) {
+    if (m_storage) {
+        disconnect(m_storage, nullptr, this, nullptr);
+    }
+    m_storage = storage;
+    if (m_storage) {
+        connect(m_storage, &IUserSessionStorage::sessionCreated, this, [this](const QString& id) { entityCreated(id); });
+        connect(m_storage, &IUserSessionStorage::sessionUpdated, this, [this](const QString& id) { entityUpdated(id); });
+        connect(m_storage, &IUserSessionStorage::sessionDeleted, this, [this](const QString& id) { entityDeleted(id); });
+        // Starting and ending change the status shown next to the name
+        connect(m_storage, &IUserSessionStorage::sessionStarted, this, [this](const QString& id) { entityUpdated(id); });
+        connect(m_storage, &IUserSessionStorage::sessionEnded, this, [this](const QString& id) { entityUpdated(id); });
+    }
+    reload();
+}
+
+std::unique_ptr<StorageCursor<UserSession>> SessionListModel::openCursor(const PageRequest& request) const {
+    return m_storage ? m_storage->openSessionCursor(request) : nullptr;
+}
+
+UserSession SessionListModel::loadEntity(const QString& id) const {
+    return m_storage ? m_storage->getUserSession(id) : UserSession();
+}
+
+QString SessionListModel::displayText(const UserSession& session) const {
+    QString text = session.getName().isEmpty()
+        ? QString("Session %1").arg(session.getStartTime().toString("yyyy-MM-dd hh:mm"))
+        : session.getName();
+    if (session.getStatus() == SessionStatus::Active) {
+        text += " (active)";
+    }
+    return text;
+}
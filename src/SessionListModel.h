@@ -0,0 +1,31 @@
+#pragma once
+
+#include "KeysetListModel.h"
+#include "models/UserSession.h"
+#include <QPointer>
+
+/**
+ * @brief The session picker's list, most recently started first
+ *
+ * Pages come from IUserSessionStorage::openSessionCursor(); the storage's session
+ * signals keep the rows current without reloading.
+ */
+class SessionListModel : public KeysetListModel<UserSession> {
+    Q_OBJECT
+
+public:
+    explicit SessionListModel(QObject* parent = nullptr);
+
+    // Reloads; null empties the list
+    void setStorage(IUserSessionStorage* storage);
+
+protected:
+    bool hasSource() const override { return !m_storage.isNull(); }
+    std::unique_ptr<StorageCursor<UserSession>> openCursor(const PageRequest& request) const override;
+    UserSession loadEntity(const QString& id) const override;
+    QDateTime sortTime(const UserSession& session) const override { return session.getStartTime(); }
+    QString displayText(const UserSession& session) const override;
+
+private:
+    QPointer<IUserSessionStorage> m_storage;
+};
@@ -1,4 +1,6 @@
 #include "MainWindow.h"
+#include "BatchTranscriber.h"
+#include "services/AsyncLogger.h"
 #include <QApplication>
 #include <QDir>
 #include <QStandardPaths>
@@ -9,6 +11,7 @@
 #include <QSplashScreen>
 #include <QPixmap>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QDebug>
 #include <QCommandLineParser>
 #include <QCommandLineOption>
@@ -19,20 +22,20 @@
 #include <QFile>
 #include <QStorageInfo>
 #include <QCoreApplication>
+#include <QMap>
+#include <cstdio>
 #include <exception>
 
 // Enable logging categories for debugging
 Q_LOGGING_CATEGORY(appMain, "app.main")
 
 /**
- * @brief Setup application directories
+ * @brief Locate the application data directory
  * 
- * Creates necessary application directories for data storage,
- * recordings, models, etc. For portable apps, uses app directory.
+ * For portable apps, a directory next to the executable; otherwise the
+ * standard AppData location.
  */
-bool setupApplicationDirectories() {
-    QString appDataPath;
-    
+QString applicationDataPath() {
     // Check if this is a portable installation (executable directory has 'portable' marker or models)
     QString appDir = QCoreApplication::applicationDirPath();
     QString portableMarker = appDir + "/portable.txt";
@@ -40,13 +43,21 @@ bool setupApplicationDirectories() {
     
     if (QFile::exists(portableMarker) || QDir(modelsDir).exists()) {
         // Use portable mode - store data relative to executable
-        appDataPath = appDir + "/data";
-        qCDebug(appMain) << "Running in portable mode, using:" << appDataPath;
-    } else {
-        // Use standard AppData location
-        appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-        qCDebug(appMain) << "Running in installed mode, using:" << appDataPath;
+        return appDir + "/data";
     }
+    // Use standard AppData location
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+}
+
+/**
+ * @brief Setup application directories
+ * 
+ * Creates necessary application directories for data storage,
+ * recordings, models, etc. For portable apps, uses app directory.
+ */
+bool setupApplicationDirectories() {
+    QString appDataPath = applicationDataPath();
+    qCDebug(appMain) << "Using data directory:" << appDataPath;
     
     QStringList directories = {
         appDataPath,
@@ -74,9 +85,10 @@ bool setupApplicationDirectories() {
  * @brief Setup application logging
  * 
  * Configures logging to file and console with appropriate levels
- * based on build configuration.
+ * based on build configuration. Messages from every category go to
+ * @p logger, which writes logs/quillscribe.log off the calling threads.
  */
-void setupLogging() {
+void setupLogging(AsyncLogger& logger) {
     // Set default logging rules
 #ifdef QT_DEBUG
     // Debug build - verbose logging
@@ -97,6 +109,12 @@ void setupLogging() {
     );
 #endif
     
+    if (logger.start()) {
+        logger.install();
+    } else {
+        qCWarning(appMain) << "Logging to the console only; cannot open" << logger.filePath();
+    }
+    
     qCDebug(appMain) << "Logging configuration applied";
 }
 
@@ -318,6 +336,124 @@ void parseCommandLine(QApplication& app) {
     }
 }
 
+/**
+ * @brief Check for a headless batch run
+ * 
+ * Looks at the raw arguments, before any application object exists: a batch
+ * run uses QCoreApplication, since QApplication needs a display.
+ */
+bool isBatchInvocation(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        const QByteArray argument(argv[i]);
+        if (argument == "--transcribe" || argument.startsWith("--transcribe=")) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Parse the batch options and transcribe
+ * 
+ * Example: quillscribe --transcribe /mnt/share/calls --model base --jobs 4 --out json
+ * Returns the process exit code.
+ */
+int runBatchTranscription(QCoreApplication& app) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("QuillScribe - batch transcription without a window");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    
+    QCommandLineOption transcribeOption("transcribe",
+                                       "Transcribe a recording, or every recording under a directory. "
+                                       "May be repeated; further paths may follow the options.",
+                                       "path");
+    QCommandLineOption modelOption("model", "Whisper model: tiny, base, small, medium or large (default: base)",
+                                   "model", "base");
+    QCommandLineOption jobsOption("jobs", "Recordings transcribed at the same time (default: 2)",
+                                  "count", QString::number(BatchTranscriber::DEFAULT_JOBS));
+    QCommandLineOption outOption("out", "Result format: json or txt (default: json)", "format", "json");
+    QCommandLineOption outputDirOption("output-dir",
+                                       "Write results here, in the input's layout, instead of next to each recording",
+                                       "directory");
+    QCommandLineOption languageOption("language", "Language code, or auto to detect it (default: auto)",
+                                      "code", "auto");
+    QCommandLineOption overwriteOption("overwrite", "Transcribe recordings again even if they have a result");
+    QCommandLineOption enhanceOption("enhance", "Also enhance the text: grammar, style, summary or formal", "mode");
+    QCommandLineOption storeOption("store", "Also save recordings, transcripts and enhanced text to the QuillScribe database, under a new session");
+    QCommandLineOption debugOption("debug", "Enable debug output");
+    parser.addOptions({transcribeOption, modelOption, jobsOption, outOption, outputDirOption, languageOption,
+                       overwriteOption, enhanceOption, storeOption, debugOption});
+    parser.addPositionalArgument("paths", "More recordings or directories to transcribe", "[paths...]");
+    
+    parser.process(app);
+    
+    if (parser.isSet(debugOption)) {
+        QLoggingCategory::setFilterRules("*.debug=true");
+    }
+    
+    auto usageError = [](const QString& message) {
+        fprintf(stderr, "%s\n", qPrintable(message));
+        return BatchTranscriber::EXIT_ERROR;
+    };
+    
+    BatchTranscriber::Options options;
+    options.inputs = parser.values(transcribeOption) + parser.positionalArguments();
+    
+    const QMap<QString, TranscriptionProvider> models = {
+        {"tiny", TranscriptionProvider::WhisperCppTiny},
+        {"base", TranscriptionProvider::WhisperCppBase},
+        {"small", TranscriptionProvider::WhisperCppSmall},
+        {"medium", TranscriptionProvider::WhisperCppMedium},
+        {"large", TranscriptionProvider::WhisperCppLarge}
+    };
+    const QString model = parser.value(modelOption).toLower();
+    if (!models.contains(model)) {
+        return usageError("Unknown model: " + model);
+    }
+    options.model = models.value(model);
+    
+    bool jobsOk = false;
+    options.jobs = parser.value(jobsOption).toInt(&jobsOk);
+    if (!jobsOk || options.jobs < 1) {
+        return usageError("--jobs needs a positive number");
+    }
+    
+    const QString format = parser.value(outOption).toLower();
+    if (format == "json") {
+        options.format = BatchTranscriber::OutputFormat::Json;
+    } else if (format == "txt" || format == "text") {
+        options.format = BatchTranscriber::OutputFormat::Text;
+    } else {
+        return usageError("Unknown output format: " + format);
+    }
+    
+    if (parser.isSet(enhanceOption)) {
+        const QMap<QString, EnhancementMode> modes = {
+            {"grammar", EnhancementMode::GrammarOnly},
+            {"style", EnhancementMode::StyleImprovement},
+            {"summary", EnhancementMode::Summarization},
+            {"formal", EnhancementMode::Formalization}
+        };
+        const QString mode = parser.value(enhanceOption).toLower();
+        if (!modes.contains(mode)) {
+            return usageError("Unknown enhancement mode: " + mode);
+        }
+        options.enhance = true;
+        options.enhancementMode = modes.value(mode);
+    }
+    
+    options.language = parser.value(languageOption);
+    options.outputDirectory = parser.value(outputDirOption);
+    options.overwrite = parser.isSet(overwriteOption);
+    options.store = parser.isSet(storeOption);
+    // The same database the window opens
+    options.databasePath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/quillscribe.db";
+    
+    BatchTranscriber transcriber(options);
+    return transcriber.run();
+}
+
 /**
  * @brief Initialize application metadata
  * 
@@ -354,6 +490,22 @@ void handleUncaughtException() {
  */
 int main(int argc, char *argv[])
 {
+    // Batch runs go to servers without a display: no QApplication, splash or window
+    if (isBatchInvocation(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        initializeApplicationMetadata();
+        AsyncLogger logger(applicationDataPath() + "/logs/quillscribe.log");
+        setupLogging(logger);
+        if (!setupApplicationDirectories()) {
+            return BatchTranscriber::EXIT_ERROR;
+        }
+        return runBatchTranscription(app);
+    }
+    
+    // Time-to-interactive is measured from here; MainWindow reports it
+    QElapsedTimer launchTimer;
+    launchTimer.start();
+    
     // Create Qt application
     QApplication app(argc, argv);
     
@@ -363,8 +515,9 @@ int main(int argc, char *argv[])
     // Parse command line arguments
     parseCommandLine(app);
     
-    // Setup logging
-    setupLogging();
+    // Setup logging; the logger outlives the window and every service that logs
+    AsyncLogger logger(applicationDataPath() + "/logs/quillscribe.log");
+    setupLogging(logger);
     
     qCInfo(appMain) << "Starting QuillScribe version" << QCoreApplication::applicationVersion();
     qCDebug(appMain) << "Qt version:" << qVersion();
@@ -409,15 +562,13 @@ int main(int argc, char *argv[])
         splash->showMessage("Loading main window...", Qt::AlignBottom | Qt::AlignCenter, Qt::white);
         app.processEvents();
         
+        // Shown as soon as it is built; the database and the model follow in the background
         MainWindow window;
-        
-        // Simulate some initialization time for splash screen
-        QTimer::singleShot(1500, [&]() {
-            splash->finish(&window);
-            window.show();
-            window.raise();
-            window.activateWindow();
-        });
+        window.setLaunchTimer(launchTimer);
+        splash->finish(&window);
+        window.show();
+        window.raise();
+        window.activateWindow();
         
         qCInfo(appMain) << "QuillScribe initialized successfully";
         
@@ -127,3 +127,19 @@ EnhancementMode enhancementModeFromString(const QString& mode) {
     if (mode == "Custom") return EnhancementMode::Custom;
     return EnhancementMode::GrammarOnly; // Default for unknown values
 }
+
+// AudioCodec conversion functions
+QString audioCodecToString(AudioCodec codec) {
+    switch (codec) {
+        case AudioCodec::Flac:
+            return "flac";
+        case AudioCodec::Pcm:
+        default:
+            return "pcm";
+    }
+}
+
+AudioCodec audioCodecFromString(const QString& codec) {
+    if (codec == "flac") return AudioCodec::Flac;
+    return AudioCodec::Pcm; // Recordings made before the codec was stored are raw PCM
+}
@@ -53,6 +53,11 @@ enum class SessionStatus {
     Archived        // Archived for history
 };
 
+enum class AudioCodec {
+    Pcm,            // Uncompressed WAV (or headerless PCM from older versions)
+    Flac            // Lossless FLAC
+};
+
 // Utility functions for enum conversion
 QString recordingStatusToString(RecordingStatus status);
 RecordingStatus recordingStatusFromString(const QString& status);
@@ -65,3 +70,6 @@ SessionStatus sessionStatusFromString(const QString& status);
 
 QString enhancementModeToString(EnhancementMode mode);
 EnhancementMode enhancementModeFromString(const QString& mode);
+
+QString audioCodecToString(AudioCodec codec);
+AudioCodec audioCodecFromString(const QString& codec);
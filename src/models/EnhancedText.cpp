@@ -268,6 +268,8 @@ QString EnhancedText::getProviderDisplayName() const {
         return "Gemini Flash";
     } else if (m_provider.startsWith("gemini")) {
         return "Google Gemini";
+    } else if (m_provider == "local-llm") {
+        return "On-device model";
     }
     
     return m_provider.isEmpty() ? "Unknown Provider" : m_provider;
@@ -277,7 +279,8 @@ QStringList EnhancedText::getSupportedProviders() const {
     return QStringList{
         "gemini-pro",
         "gemini-flash",
-        "gemini-pro-vision"
+        "gemini-pro-vision",
+        "local-llm"
     };
 }
 
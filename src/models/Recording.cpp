@@ -1,4 +1,5 @@
 #include "Recording.h"
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QFileInfo>
 #include <QDir>
@@ -14,6 +15,7 @@ Recording::Recording()
     , m_language("en-US")
     , m_deviceName("")
     , m_status(RecordingStatus::Recording)
+    , m_codec(AudioCodec::Pcm)
 {
 }
 
@@ -28,6 +30,7 @@ Recording::Recording(const QString& sessionId, const QString& filePath)
     , m_language("en-US")
     , m_deviceName("")
     , m_status(RecordingStatus::Recording)
+    , m_codec(AudioCodec::Pcm)
 {
     if (!filePath.isEmpty()) {
         m_fileSize = calculateActualFileSize();
@@ -51,6 +54,9 @@ Recording::Recording(const Recording& other)
     , m_language(other.m_language)
     , m_deviceName(other.m_deviceName)
     , m_status(other.m_status)
+    , m_codec(other.m_codec)
+    , m_waveformPeaks(other.m_waveformPeaks)
+    , m_segments(other.m_segments)
 {
 }
 
@@ -66,6 +72,9 @@ Recording& Recording::operator=(const Recording& other) {
         m_language = other.m_language;
         m_deviceName = other.m_deviceName;
         m_status = other.m_status;
+        m_codec = other.m_codec;
+        m_waveformPeaks = other.m_waveformPeaks;
+        m_segments = other.m_segments;
     }
     return *this;
 }
@@ -86,6 +95,20 @@ QJsonObject Recording::toJson() const {
     json["language"] = m_language;
     json["deviceName"] = m_deviceName;
     json["status"] = recordingStatusToString(m_status);
+    json["codec"] = audioCodecToString(m_codec);
+    
+    if (!m_segments.isEmpty()) {
+        QJsonArray segments;
+        for (const RecordingSegment& segment : m_segments) {
+            QJsonObject entry;
+            entry["index"] = segment.index;
+            entry["filePath"] = segment.filePath;
+            entry["startMs"] = segment.startMs;
+            entry["durationMs"] = segment.durationMs;
+            segments.append(entry);
+        }
+        json["segments"] = segments;
+    }
     return json;
 }
 
@@ -112,6 +135,19 @@ bool Recording::fromJson(const QJsonObject& json) {
     
     QString statusStr = json.value("status").toString("Recording");
     m_status = recordingStatusFromString(statusStr);
+    m_codec = audioCodecFromString(json.value("codec").toString());
+    
+    m_segments.clear();
+    const QJsonArray segments = json.value("segments").toArray();
+    for (const QJsonValue& value : segments) {
+        const QJsonObject entry = value.toObject();
+        RecordingSegment segment;
+        segment.index = entry.value("index").toInt();
+        segment.filePath = entry.value("filePath").toString();
+        segment.startMs = entry.value("startMs").toVariant().toLongLong();
+        segment.durationMs = entry.value("durationMs").toVariant().toLongLong();
+        m_segments.append(segment);
+    }
     
     return true;
 }
@@ -194,6 +230,18 @@ void Recording::setStatus(RecordingStatus status) {
     m_status = status;
 }
 
+void Recording::setCodec(AudioCodec codec) {
+    m_codec = codec;
+}
+
+void Recording::setWaveformPeaks(const WaveformPeaks& peaks) {
+    m_waveformPeaks = peaks;
+}
+
+void Recording::setSegments(const QList<RecordingSegment>& segments) {
+    m_segments = segments;
+}
+
 bool Recording::fileExists() const {
     return !m_filePath.isEmpty() && QFileInfo::exists(m_filePath);
 }
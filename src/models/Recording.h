@@ -1,8 +1,23 @@
 #pragma once
 
 #include "BaseModel.h"
+#include "WaveformPeaks.h"
 #include <QDateTime>
 #include <QFileInfo>
+#include <QList>
+
+/**
+ * @brief One segment file of a recording written in segmented mode
+ *
+ * The files are joined into the recording when it stops; until then (or after a
+ * crash) they are what lets transcription and recovery work on the recording.
+ */
+struct RecordingSegment {
+    int index = 0;
+    QString filePath;
+    qint64 startMs = 0;
+    qint64 durationMs = 0;
+};
 
 /**
  * @brief Recording model class
@@ -37,6 +52,9 @@ public:
     QString getLanguage() const { return m_language; }
     QString getDeviceName() const { return m_deviceName; }
     RecordingStatus getStatus() const { return m_status; }
+    AudioCodec getCodec() const { return m_codec; }
+    const WaveformPeaks& getWaveformPeaks() const { return m_waveformPeaks; }
+    const QList<RecordingSegment>& getSegments() const { return m_segments; }
     
     // Setters
     void setSessionId(const QString& sessionId);
@@ -48,6 +66,9 @@ public:
     void setLanguage(const QString& language);
     void setDeviceName(const QString& deviceName);
     void setStatus(RecordingStatus status);
+    void setCodec(AudioCodec codec);
+    void setWaveformPeaks(const WaveformPeaks& peaks);
+    void setSegments(const QList<RecordingSegment>& segments);
     
     // Utility methods
     bool fileExists() const;
@@ -78,6 +99,9 @@ private:
     QString m_language;         // Language code (e.g., "en-US")
     QString m_deviceName;       // Audio input device name
     RecordingStatus m_status;
+    AudioCodec m_codec;         // How the audio file is encoded
+    WaveformPeaks m_waveformPeaks; // Stored as a BLOB, not part of the JSON form
+    QList<RecordingSegment> m_segments; // Segment index; empty unless recorded in segments
     
     // Validation helpers
     bool validateDuration() const;
@@ -11,7 +11,7 @@ Transcription::Transcription()
     , m_provider("")
     , m_language("en-US")
     , m_processingTime(0)
-    , m_wordTimestamps(QJsonArray())
+    , m_wordTimings()
     , m_createdAt(QDateTime::currentDateTime())
     , m_status(TranscriptionStatus::Pending)
 {
@@ -25,7 +25,7 @@ Transcription::Transcription(const QString& recordingId, const QString& text)
     , m_provider("")
     , m_language("en-US")
     , m_processingTime(0)
-    , m_wordTimestamps(QJsonArray())
+    , m_wordTimings()
     , m_createdAt(QDateTime::currentDateTime())
     , m_status(TranscriptionStatus::Pending)
 {
@@ -45,7 +45,7 @@ Transcription::Transcription(const Transcription& other)
     , m_provider(other.m_provider)
     , m_language(other.m_language)
     , m_processingTime(other.m_processingTime)
-    , m_wordTimestamps(other.m_wordTimestamps)
+    , m_wordTimings(other.m_wordTimings)
     , m_createdAt(other.m_createdAt)
     , m_status(other.m_status)
 {
@@ -60,7 +60,7 @@ Transcription& Transcription::operator=(const Transcription& other) {
         m_provider = other.m_provider;
         m_language = other.m_language;
         m_processingTime = other.m_processingTime;
-        m_wordTimestamps = other.m_wordTimestamps;
+        m_wordTimings = other.m_wordTimings;
         m_createdAt = other.m_createdAt;
         m_status = other.m_status;
     }
@@ -80,7 +80,7 @@ QJsonObject Transcription::toJson() const {
     json["provider"] = m_provider;
     json["language"] = m_language;
     json["processingTime"] = static_cast<qint64>(m_processingTime);
-    json["wordTimestamps"] = m_wordTimestamps;
+    json["wordTimestamps"] = m_wordTimings.toJson();
     json["createdAt"] = m_createdAt.toString(Qt::ISODate);
     json["status"] = transcriptionStatusToString(m_status);
     return json;
@@ -98,7 +98,7 @@ bool Transcription::fromJson(const QJsonObject& json) {
     m_provider = json.value("provider").toString();
     m_language = json.value("language").toString("en-US");
     m_processingTime = json.value("processingTime").toVariant().toLongLong();
-    m_wordTimestamps = json.value("wordTimestamps").toArray();
+    m_wordTimings = WordTimingTable::fromJson(json.value("wordTimestamps").toArray());
     
     QString createdAtStr = json.value("createdAt").toString();
     m_createdAt = QDateTime::fromString(createdAtStr, Qt::ISODate);
@@ -181,7 +181,11 @@ void Transcription::setProcessingTime(qint64 processingTime) {
 }
 
 void Transcription::setWordTimestamps(const QJsonArray& wordTimestamps) {
-    m_wordTimestamps = wordTimestamps;
+    m_wordTimings = WordTimingTable::fromJson(wordTimestamps);
+}
+
+void Transcription::setWordTimings(const WordTimingTable& wordTimings) {
+    m_wordTimings = wordTimings;
 }
 
 void Transcription::setCreatedAt(const QDateTime& createdAt) {
@@ -229,7 +233,7 @@ QStringList Transcription::getSupportedProviders() const {
 }
 
 bool Transcription::hasWordTimestamps() const {
-    return !m_wordTimestamps.isEmpty();
+    return !m_wordTimings.isEmpty();
 }
 
 QString Transcription::getFormattedProcessingTime() const {
@@ -339,24 +343,23 @@ Transcription::WordTimestamp Transcription::WordTimestamp::fromJson(const QJsonO
 
 QList<Transcription::WordTimestamp> Transcription::getWordTimestampList() const {
     QList<WordTimestamp> timestamps;
+    timestamps.reserve(m_wordTimings.size());
     
-    for (const QJsonValue& value : m_wordTimestamps) {
-        if (value.isObject()) {
-            timestamps.append(WordTimestamp::fromJson(value.toObject()));
-        }
+    for (int i = 0; i < m_wordTimings.size(); ++i) {
+        timestamps.append({m_wordTimings.word(i), m_wordTimings.startTime(i),
+                           m_wordTimings.endTime(i), m_wordTimings.confidence(i)});
     }
     
     return timestamps;
 }
 
 void Transcription::setWordTimestampList(const QList<WordTimestamp>& timestamps) {
-    QJsonArray jsonArray;
+    m_wordTimings.clear();
+    m_wordTimings.reserve(timestamps.size());
     
     for (const WordTimestamp& timestamp : timestamps) {
-        jsonArray.append(timestamp.toJson());
+        m_wordTimings.append(timestamp.word, timestamp.startTime, timestamp.endTime, timestamp.confidence);
     }
-    
-    m_wordTimestamps = jsonArray;
 }
 
 bool Transcription::operator==(const Transcription& other) const {
@@ -390,24 +393,10 @@ bool Transcription::validateProvider() const {
 }
 
 bool Transcription::validateWordTimestamps() const {
-    // Word timestamps are optional, so empty array is valid
-    if (m_wordTimestamps.isEmpty()) {
-        return true;
-    }
-    
-    // If present, each timestamp should be a valid object
-    for (const QJsonValue& value : m_wordTimestamps) {
-        if (!value.isObject()) {
-            return false;
-        }
-        
-        QJsonObject obj = value.toObject();
-        if (!obj.contains("word") || !obj.contains("startTime") || !obj.contains("endTime")) {
-            return false;
-        }
-        
-        double startTime = obj["startTime"].toDouble();
-        double endTime = obj["endTime"].toDouble();
+    // Word timestamps are optional, so an empty table is valid
+    for (int i = 0; i < m_wordTimings.size(); ++i) {
+        const double startTime = m_wordTimings.startTime(i);
+        const double endTime = m_wordTimings.endTime(i);
         
         if (startTime < 0 || endTime < startTime) {
             return false;
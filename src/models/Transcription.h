@@ -1,6 +1,7 @@
 #pragma once
 
 #include "BaseModel.h"
+#include "WordTimingTable.h"
 #include <QDateTime>
 #include <QJsonArray>
 
@@ -34,7 +35,8 @@ public:
     QString getProvider() const { return m_provider; }
     QString getLanguage() const { return m_language; }
     qint64 getProcessingTime() const { return m_processingTime; }
-    QJsonArray getWordTimestamps() const { return m_wordTimestamps; }
+    QJsonArray getWordTimestamps() const { return m_wordTimings.toJson(); } // Builds JSON on each call
+    const WordTimingTable& getWordTimings() const { return m_wordTimings; }
     QDateTime getCreatedAt() const { return m_createdAt; }
     TranscriptionStatus getStatus() const { return m_status; }
     
@@ -46,6 +48,7 @@ public:
     void setLanguage(const QString& language);
     void setProcessingTime(qint64 processingTime);
     void setWordTimestamps(const QJsonArray& wordTimestamps);
+    void setWordTimings(const WordTimingTable& wordTimings);
     void setCreatedAt(const QDateTime& createdAt);
     void setStatus(TranscriptionStatus status);
     
@@ -99,7 +102,7 @@ private:
     QString m_provider;             // STT provider used
     QString m_language;             // Detected language
     qint64 m_processingTime;        // Time taken for transcription (ms)
-    QJsonArray m_wordTimestamps;    // Word-level timing data
+    WordTimingTable m_wordTimings;  // Word-level timing data
     QDateTime m_createdAt;          // When transcription was completed
     TranscriptionStatus m_status;   // Processing state
     
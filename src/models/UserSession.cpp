@@ -13,6 +13,7 @@ UserSession::UserSession()
     , m_tags(QStringList())
     , m_notes("")
     , m_status(SessionStatus::Active)
+    , m_detectedLanguage("")
 {
 }
 
@@ -26,6 +27,7 @@ UserSession::UserSession(const QString& name)
     , m_tags(QStringList())
     , m_notes("")
     , m_status(SessionStatus::Active)
+    , m_detectedLanguage("")
 {
 }
 
@@ -45,6 +47,7 @@ UserSession::UserSession(const UserSession& other)
     , m_tags(other.m_tags)
     , m_notes(other.m_notes)
     , m_status(other.m_status)
+    , m_detectedLanguage(other.m_detectedLanguage)
 {
 }
 
@@ -59,6 +62,7 @@ UserSession& UserSession::operator=(const UserSession& other) {
         m_tags = other.m_tags;
         m_notes = other.m_notes;
         m_status = other.m_status;
+        m_detectedLanguage = other.m_detectedLanguage;
     }
     return *this;
 }
@@ -84,6 +88,7 @@ QJsonObject UserSession::toJson() const {
     
     json["notes"] = m_notes;
     json["status"] = sessionStatusToString(m_status);
+    json["detectedLanguage"] = m_detectedLanguage;
     return json;
 }
 
@@ -119,6 +124,7 @@ bool UserSession::fromJson(const QJsonObject& json) {
     
     QString statusStr = json.value("status").toString("Active");
     m_status = sessionStatusFromString(statusStr);
+    m_detectedLanguage = json.value("detectedLanguage").toString();
     
     return true;
 }
@@ -143,6 +149,10 @@ bool UserSession::isValid() const {
     return true;
 }
 
+void UserSession::setDetectedLanguage(const QString& languageCode) {
+    m_detectedLanguage = languageCode;
+}
+
 // Implementation of remaining methods would continue here...
 // Due to space constraints, showing abbreviated implementation
 
@@ -36,6 +36,7 @@ public:
     QStringList getTags() const { return m_tags; }
     QString getNotes() const { return m_notes; }
     SessionStatus getStatus() const { return m_status; }
+    QString getDetectedLanguage() const { return m_detectedLanguage; }
     
     // Setters
     void setName(const QString& name);
@@ -46,6 +47,7 @@ public:
     void setTags(const QStringList& tags);
     void setNotes(const QString& notes);
     void setStatus(SessionStatus status);
+    void setDetectedLanguage(const QString& languageCode);
     
     // Session management
     void startSession();
@@ -123,6 +125,7 @@ private:
     QStringList m_tags;             // User-assigned tags
     QString m_notes;                // User notes about the session
     SessionStatus m_status;         // Active, Completed, Archived
+    QString m_detectedLanguage;     // Spoken language found by auto-detection; reused for later recordings
     
     // Validation helpers
     bool validateName() const;
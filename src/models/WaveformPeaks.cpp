@@ -0,0 +1,200 @@
+#include "WaveformPeaks.h"
+#include <QDataStream>
+#include <QIODevice>
+#include <QtEndian>
+
+// BLOB layout, little-endian throughout:
+//   u32 magic, u16 version, u16 reserved, u32 sampleRate, u32 binSamples,
+//   u64 sampleCount, u32 binCount, then binCount x (i8 min, i8 max) of level 0
+
+namespace {
+
+qint8 quantize(float value) {
+    return static_cast<qint8>(qBound(-127, qRound(value * 127.0f), 127));
+}
+
+void merge(WaveformPeaks::Peak& into, const WaveformPeaks::Peak& peak) {
+    into.min = qMin(into.min, peak.min);
+    into.max = qMax(into.max, peak.max);
+}
+
+} // namespace
+
+void WaveformPeaks::reset(int sampleRate) {
+    clear();
+    m_sampleRate = qMax(1, sampleRate);
+    m_binSamples = qMax(1, m_sampleRate * BASE_BIN_MS / 1000);
+    m_levels.resize(LEVEL_COUNT);
+}
+
+void WaveformPeaks::clear() {
+    m_sampleRate = 0;
+    m_binSamples = 0;
+    m_sampleCount = 0;
+    m_levels.clear();
+    m_pendingSamples = 0;
+}
+
+void WaveformPeaks::addSamples(const float* samples, qint64 count) {
+    if (!samples || count <= 0 || m_binSamples <= 0) {
+        return;
+    }
+
+    for (qint64 i = 0; i < count; ++i) {
+        const float value = samples[i];
+        if (m_pendingSamples == 0) {
+            m_pendingMin = value;
+            m_pendingMax = value;
+        } else {
+            m_pendingMin = qMin(m_pendingMin, value);
+            m_pendingMax = qMax(m_pendingMax, value);
+        }
+        if (++m_pendingSamples == m_binSamples) {
+            appendBasePeak({quantize(m_pendingMin), quantize(m_pendingMax)});
+            m_pendingSamples = 0;
+        }
+    }
+    m_sampleCount += count;
+}
+
+void WaveformPeaks::finish() {
+    if (m_pendingSamples > 0) {
+        appendBasePeak({quantize(m_pendingMin), quantize(m_pendingMax)});
+        m_pendingSamples = 0;
+    }
+}
+
+WaveformPeaks WaveformPeaks::fromSamples(const QVector<float>& samples, int sampleRate) {
+    WaveformPeaks peaks;
+    peaks.reset(sampleRate);
+    peaks.addSamples(samples.constData(), samples.size());
+    peaks.finish();
+    return peaks;
+}
+
+void WaveformPeaks::appendBasePeak(Peak peak) {
+    m_levels[0].append(peak);
+
+    // The new bin belongs to the last (possibly still partial) bin of every level above
+    qint64 index = m_levels[0].size() - 1;
+    for (int level = 1; level < m_levels.size(); ++level) {
+        index /= LEVEL_FACTOR;
+        QVector<Peak>& bins = m_levels[level];
+        if (index == bins.size()) {
+            bins.append(peak);
+        } else {
+            merge(bins.last(), peak);
+        }
+    }
+}
+
+qint64 WaveformPeaks::samplesPerBin(int level) const {
+    qint64 samples = m_binSamples;
+    for (int i = 0; i < level; ++i) {
+        samples *= LEVEL_FACTOR;
+    }
+    return samples;
+}
+
+QVector<WaveformPeaks::Peak> WaveformPeaks::peaksForRange(qint64 startSample, qint64 endSample, int maxBins) const {
+    QVector<Peak> result;
+    startSample = qMax<qint64>(0, startSample);
+    endSample = qMin(endSample, m_sampleCount);
+    if (isEmpty() || maxBins <= 0 || endSample <= startSample) {
+        return result;
+    }
+
+    // Coarsest level that still gives at least one bin per output peak
+    int level = m_levels.size() - 1;
+    while (level > 0 && (endSample - startSample + samplesPerBin(level) - 1) / samplesPerBin(level) < maxBins) {
+        --level;
+    }
+
+    const QVector<Peak>& bins = m_levels.at(level);
+    const qint64 binSamples = samplesPerBin(level);
+    const qint64 first = startSample / binSamples;
+    const qint64 last = qMin<qint64>(bins.size(), (endSample + binSamples - 1) / binSamples);
+    const qint64 available = last - first;
+    if (available <= 0) {
+        return result;
+    }
+
+    if (available <= maxBins) {
+        return bins.mid(static_cast<int>(first), static_cast<int>(available));
+    }
+
+    result.resize(maxBins);
+    for (int out = 0; out < maxBins; ++out) {
+        const qint64 begin = first + available * out / maxBins;
+        const qint64 end = first + available * (out + 1) / maxBins;
+        Peak peak = bins.at(static_cast<int>(begin));
+        for (qint64 i = begin + 1; i < end; ++i) {
+            merge(peak, bins.at(static_cast<int>(i)));
+        }
+        result[out] = peak;
+    }
+    return result;
+}
+
+QByteArray WaveformPeaks::toBlob() const {
+    QByteArray blob;
+    QDataStream stream(&blob, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    const QVector<Peak> base = isEmpty() ? QVector<Peak>() : m_levels.first();
+    stream << BLOB_MAGIC << BLOB_VERSION << quint16(0)
+           << static_cast<quint32>(m_sampleRate) << static_cast<quint32>(m_binSamples)
+           << static_cast<quint64>(m_sampleCount) << static_cast<quint32>(base.size());
+    for (const Peak& peak : base) {
+        stream << peak.min << peak.max;
+    }
+    return blob;
+}
+
+bool WaveformPeaks::isBlob(const QByteArray& data) {
+    return data.size() >= 4 && qFromLittleEndian<quint32>(data.constData()) == BLOB_MAGIC;
+}
+
+WaveformPeaks WaveformPeaks::fromBlob(const QByteArray& data, bool* ok) {
+    WaveformPeaks peaks;
+    if (ok) {
+        *ok = false;
+    }
+    if (!isBlob(data)) {
+        return peaks;
+    }
+
+    QDataStream stream(data);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint16 reserved = 0;
+    quint32 sampleRate = 0;
+    quint32 binSamples = 0;
+    quint64 sampleCount = 0;
+    quint32 binCount = 0;
+    stream >> magic >> version >> reserved >> sampleRate >> binSamples >> sampleCount >> binCount;
+    if (stream.status() != QDataStream::Ok || version != BLOB_VERSION || binSamples == 0 ||
+        static_cast<qint64>(binCount) * 2 > data.size()) {
+        return WaveformPeaks();
+    }
+
+    peaks.reset(static_cast<int>(sampleRate));
+    peaks.m_binSamples = static_cast<int>(binSamples);
+    peaks.m_levels[0].reserve(static_cast<int>(binCount));
+    for (quint32 i = 0; i < binCount; ++i) {
+        Peak peak;
+        stream >> peak.min >> peak.max;
+        peaks.appendBasePeak(peak);
+    }
+    peaks.m_sampleCount = static_cast<qint64>(sampleCount);
+
+    if (stream.status() != QDataStream::Ok) {
+        return WaveformPeaks();
+    }
+    if (ok) {
+        *ok = true;
+    }
+    return peaks;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QByteArray>
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief Min/max waveform peak pyramid of a recording
+ *
+ * Level 0 holds one min/max pair per BASE_BIN_MS of audio; every higher level
+ * merges LEVEL_FACTOR bins of the one below, so a waveform of any zoom can be
+ * drawn from a few KB. Samples are added incrementally while recording and
+ * each new base bin is folded into all of its parents, so every level is
+ * current at all times. Only level 0 is serialized; the rest is rebuilt on load.
+ */
+class WaveformPeaks {
+public:
+    struct Peak {
+        qint8 min = 0;
+        qint8 max = 0;
+    };
+
+    WaveformPeaks() = default;
+
+    void reset(int sampleRate);
+    void clear();
+
+    // Mono samples in [-1, 1]; finish() emits the last partial bin
+    void addSamples(const float* samples, qint64 count);
+    void finish();
+    static WaveformPeaks fromSamples(const QVector<float>& samples, int sampleRate);
+
+    bool isEmpty() const { return m_levels.isEmpty() || m_levels.first().isEmpty(); }
+    int sampleRate() const { return m_sampleRate; }
+    qint64 sampleCount() const { return m_sampleCount; }
+    int levelCount() const { return m_levels.size(); }
+    const QVector<Peak>& level(int index) const { return m_levels.at(index); }
+    qint64 samplesPerBin(int level) const;
+
+    // At most @p maxBins peaks covering [startSample, endSample), from the coarsest level
+    // that still has enough detail (e.g. one peak per pixel column)
+    QVector<Peak> peaksForRange(qint64 startSample, qint64 endSample, int maxBins) const;
+
+    // Stable storage encoding
+    QByteArray toBlob() const;
+    static bool isBlob(const QByteArray& data);
+    static WaveformPeaks fromBlob(const QByteArray& data, bool* ok = nullptr);
+
+    static constexpr int BASE_BIN_MS = 20;
+    static constexpr int LEVEL_FACTOR = 4;
+    static constexpr int LEVEL_COUNT = 8;   // Top level: one bin per ~5.5 minutes
+    static constexpr quint32 BLOB_MAGIC = 0x50575351; // "QSWP" read as little-endian
+    static constexpr quint16 BLOB_VERSION = 1;
+
+private:
+    void appendBasePeak(Peak peak);
+
+    int m_sampleRate = 0;
+    int m_binSamples = 0;               // Samples per level-0 bin
+    qint64 m_sampleCount = 0;
+    QVector<QVector<Peak>> m_levels;
+
+    // Level-0 bin being filled
+    float m_pendingMin = 0.0f;
+    float m_pendingMax = 0.0f;
+    int m_pendingSamples = 0;
+};
@@ -0,0 +1,180 @@
+#include "WordTimingTable.h"
+#include <QDataStream>
+#include <QIODevice>
+#include <QJsonObject>
+#include <QtEndian>
+
+// BLOB layout, little-endian throughout:
+//   u32 magic, u16 version, u16 reserved, u32 stringCount, u32 wordCount,
+//   stringCount x (u32 byteLength, UTF-8 bytes),
+//   wordCount x u32 string index, then wordCount x f32 for start, end and confidence
+
+void WordTimingTable::append(const QString& word, double startTime, double endTime, double confidence) {
+    auto it = m_stringIndex.constFind(word);
+    if (it == m_stringIndex.constEnd()) {
+        it = m_stringIndex.insert(word, static_cast<quint32>(m_strings.size()));
+        m_strings.append(word);
+    }
+
+    m_wordRefs.append(it.value());
+    m_startTimes.append(static_cast<float>(startTime));
+    m_endTimes.append(static_cast<float>(endTime));
+    m_confidences.append(static_cast<float>(confidence));
+}
+
+void WordTimingTable::reserve(int count) {
+    m_wordRefs.reserve(count);
+    m_startTimes.reserve(count);
+    m_endTimes.reserve(count);
+    m_confidences.reserve(count);
+}
+
+void WordTimingTable::clear() {
+    m_strings.clear();
+    m_stringIndex.clear();
+    m_wordRefs.clear();
+    m_startTimes.clear();
+    m_endTimes.clear();
+    m_confidences.clear();
+}
+
+QByteArray WordTimingTable::toBlob() const {
+    QByteArray blob;
+    QDataStream stream(&blob, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    stream << BLOB_MAGIC << BLOB_VERSION << quint16(0)
+           << static_cast<quint32>(m_strings.size()) << static_cast<quint32>(m_wordRefs.size());
+
+    for (const QString& word : m_strings) {
+        const QByteArray utf8 = word.toUtf8();
+        stream << static_cast<quint32>(utf8.size());
+        stream.writeRawData(utf8.constData(), static_cast<int>(utf8.size()));
+    }
+
+    for (quint32 ref : m_wordRefs) {
+        stream << ref;
+    }
+    for (const QVector<float>* column : {&m_startTimes, &m_endTimes, &m_confidences}) {
+        for (float value : *column) {
+            stream << value;
+        }
+    }
+
+    return blob;
+}
+
+bool WordTimingTable::isBlob(const QByteArray& data) {
+    return data.size() >= 4 && qFromLittleEndian<quint32>(data.constData()) == BLOB_MAGIC;
+}
+
+WordTimingTable WordTimingTable::fromBlob(const QByteArray& data, bool* ok) {
+    WordTimingTable table;
+    if (ok) {
+        *ok = false;
+    }
+    if (!isBlob(data)) {
+        return table;
+    }
+
+    QDataStream stream(data);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint16 reserved = 0;
+    quint32 stringCount = 0;
+    quint32 wordCount = 0;
+    stream >> magic >> version >> reserved >> stringCount >> wordCount;
+    if (version != BLOB_VERSION) {
+        return table;
+    }
+
+    // Every string needs at least its length prefix and every word 16 bytes of columns,
+    // so a corrupt header cannot make us allocate more than the BLOB could hold
+    const qint64 remaining = data.size() - stream.device()->pos();
+    if (static_cast<qint64>(stringCount) * 4 + static_cast<qint64>(wordCount) * 16 > remaining) {
+        return table;
+    }
+
+    table.m_strings.reserve(static_cast<int>(stringCount));
+    for (quint32 i = 0; i < stringCount; ++i) {
+        quint32 length = 0;
+        stream >> length;
+        if (length > data.size() - stream.device()->pos()) {
+            return WordTimingTable();
+        }
+        QByteArray utf8(static_cast<int>(length), Qt::Uninitialized);
+        stream.readRawData(utf8.data(), static_cast<int>(length));
+        const QString word = QString::fromUtf8(utf8);
+        table.m_stringIndex.insert(word, i);
+        table.m_strings.append(word);
+    }
+
+    table.m_wordRefs.resize(static_cast<int>(wordCount));
+    for (quint32& ref : table.m_wordRefs) {
+        stream >> ref;
+        if (ref >= stringCount) {
+            return WordTimingTable();
+        }
+    }
+    for (QVector<float>* column : {&table.m_startTimes, &table.m_endTimes, &table.m_confidences}) {
+        column->resize(static_cast<int>(wordCount));
+        for (float& value : *column) {
+            stream >> value;
+        }
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        return WordTimingTable();
+    }
+
+    if (ok) {
+        *ok = true;
+    }
+    return table;
+}
+
+QJsonArray WordTimingTable::toJson() const {
+    QJsonArray json;
+    for (int i = 0; i < size(); ++i) {
+        QJsonObject entry;
+        entry["word"] = word(i);
+        entry["startTime"] = startTime(i);
+        entry["endTime"] = endTime(i);
+        entry["confidence"] = confidence(i);
+        json.append(entry);
+    }
+    return json;
+}
+
+WordTimingTable WordTimingTable::fromJson(const QJsonArray& json) {
+    WordTimingTable table;
+    table.reserve(json.size());
+    for (const QJsonValue& value : json) {
+        if (!value.isObject()) {
+            continue;
+        }
+        const QJsonObject entry = value.toObject();
+        table.append(entry.value("word").toString(),
+                     entry.value("startTime").toDouble(),
+                     entry.value("endTime").toDouble(),
+                     entry.value("confidence").toDouble());
+    }
+    return table;
+}
+
+bool WordTimingTable::operator==(const WordTimingTable& other) const {
+    if (size() != other.size()) {
+        return false;
+    }
+    for (int i = 0; i < size(); ++i) {
+        if (word(i) != other.word(i) || m_startTimes.at(i) != other.m_startTimes.at(i) ||
+            m_endTimes.at(i) != other.m_endTimes.at(i) || m_confidences.at(i) != other.m_confidences.at(i)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief Packed, column-oriented word timing data
+ *
+ * Stores each distinct word once in a string table and keeps per-word
+ * references, start/end times (seconds) and confidences in flat arrays, so an
+ * hour of word timings costs a few arrays instead of one JSON object per word.
+ * The BLOB encoding is versioned and little-endian; JSON is only produced when
+ * a caller asks for it.
+ */
+class WordTimingTable {
+public:
+    WordTimingTable() = default;
+
+    void append(const QString& word, double startTime, double endTime, double confidence);
+    void reserve(int count);
+    void clear();
+
+    int size() const { return m_wordRefs.size(); }
+    bool isEmpty() const { return m_wordRefs.isEmpty(); }
+
+    QString word(int index) const { return m_strings.at(m_wordRefs.at(index)); }
+    double startTime(int index) const { return m_startTimes.at(index); }
+    double endTime(int index) const { return m_endTimes.at(index); }
+    double confidence(int index) const { return m_confidences.at(index); }
+    int distinctWordCount() const { return m_strings.size(); }
+
+    // Stable storage encoding
+    QByteArray toBlob() const;
+    static bool isBlob(const QByteArray& data);
+    static WordTimingTable fromBlob(const QByteArray& data, bool* ok = nullptr);
+
+    // Explicit conversion to and from the {word, startTime, endTime, confidence} JSON form
+    QJsonArray toJson() const;
+    static WordTimingTable fromJson(const QJsonArray& json);
+
+    bool operator==(const WordTimingTable& other) const;
+    bool operator!=(const WordTimingTable& other) const { return !(*this == other); }
+
+    static constexpr quint32 BLOB_MAGIC = 0x54575351; // "QSWT" read as little-endian
+    static constexpr quint16 BLOB_VERSION = 1;
+
+private:
+    QStringList m_strings;          // Distinct words, referenced by index
+    QHash<QString, quint32> m_stringIndex;
+    QVector<quint32> m_wordRefs;    // Per word: index into m_strings
+    QVector<float> m_startTimes;
+    QVector<float> m_endTimes;
+    QVector<float> m_confidences;
+};
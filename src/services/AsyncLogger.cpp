@@ -0,0 +1,347 @@
+#include "AsyncLogger.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <cstdio>
+
+static_assert((AsyncLogger::QUEUE_CAPACITY & (AsyncLogger::QUEUE_CAPACITY - 1)) == 0,
+              "QUEUE_CAPACITY must be a power of two");
+
+QAtomicPointer<AsyncLogger> AsyncLogger::s_installed;
+
+AsyncLogger::AsyncLogger(const QString& filePath)
+    : m_filePath(filePath)
+    , m_maxFileBytes(MAX_FILE_BYTES)
+    , m_maxFiles(MAX_FILES)
+    , m_repeatWindowMs(REPEAT_WINDOW_MS)
+    , m_echoToConsole(true)
+    , m_installed(false)
+    , m_previousHandler(nullptr)
+    , m_slots(new Slot[QUEUE_CAPACITY])
+    , m_mask(QUEUE_CAPACITY - 1)
+    , m_enqueueIndex(0)
+    , m_dequeueIndex(0)
+    , m_dropped(0)
+    , m_suppressed(0)
+    , m_thread(nullptr)
+    , m_stopping(false)
+    , m_reportedDropped(0)
+{
+    // A slot is free for the producer whose index matches its sequence
+    for (int i = 0; i < QUEUE_CAPACITY; ++i) {
+        m_slots[i].sequence.storeRelaxed(i);
+    }
+}
+
+AsyncLogger::~AsyncLogger() {
+    uninstall();
+    stop();
+}
+
+void AsyncLogger::setMaxFileBytes(qint64 bytes) {
+    m_maxFileBytes = qMax<qint64>(1024, bytes);
+}
+
+void AsyncLogger::setMaxFiles(int files) {
+    m_maxFiles = qMax(1, files);
+}
+
+void AsyncLogger::setRepeatWindow(int milliseconds) {
+    m_repeatWindowMs = qMax(0, milliseconds);
+}
+
+void AsyncLogger::setEchoToConsole(bool enabled) {
+    m_echoToConsole = enabled;
+}
+
+bool AsyncLogger::start() {
+    if (m_thread) {
+        return true;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!openFile()) {
+            return false;
+        }
+        m_stopping = false;
+    }
+
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("AsyncLogger");
+    m_thread->start(QThread::LowPriority);
+    return true;
+}
+
+void AsyncLogger::stop() {
+    if (!m_thread) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeOne();
+    }
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+
+    QMutexLocker locker(&m_mutex);
+    m_file.close();
+}
+
+void AsyncLogger::install() {
+    if (m_installed) {
+        return;
+    }
+    s_installed.storeRelease(this);
+    m_previousHandler = qInstallMessageHandler(&AsyncLogger::messageHandler);
+    m_installed = true;
+}
+
+void AsyncLogger::uninstall() {
+    if (!m_installed) {
+        return;
+    }
+    qInstallMessageHandler(m_previousHandler);
+    s_installed.testAndSetOrdered(this, nullptr);
+    m_installed = false;
+}
+
+bool AsyncLogger::log(QtMsgType type, const char* category, const QString& message) {
+    // Bounded multi-producer queue: claim a slot by advancing the enqueue index,
+    // fill it, then publish it through its sequence number
+    quint64 index = m_enqueueIndex.loadRelaxed();
+    Slot* slot = nullptr;
+    for (;;) {
+        slot = &m_slots[index & m_mask];
+        const qint64 lag = static_cast<qint64>(slot->sequence.loadAcquire() - index);
+        if (lag == 0) {
+            if (m_enqueueIndex.testAndSetRelaxed(index, index + 1, index)) {
+                break;
+            }
+        } else if (lag < 0) {
+            // The consumer has not freed this slot yet: the queue is full
+            m_dropped.fetchAndAddRelaxed(1);
+            return false;
+        } else {
+            index = m_enqueueIndex.loadRelaxed();
+        }
+    }
+
+    slot->timestampMs = QDateTime::currentMSecsSinceEpoch();
+    slot->type = type;
+    slot->category = QByteArray(category ? category : "default");
+    slot->message = message; // Shares the data; formatting happens on the flush thread
+    slot->sequence.storeRelease(index + 1);
+    return true;
+}
+
+void AsyncLogger::flush() {
+    // The flush thread holds the mutex while it drains; a fatal message raised there
+    // is left for it to write
+    if (m_thread && QThread::currentThread() == m_thread) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    drain();
+}
+
+QString AsyncLogger::rotatedPath(const QString& filePath, int index) {
+    if (index <= 0) {
+        return filePath;
+    }
+    const QFileInfo info(filePath);
+    QString name = info.completeBaseName() + QString(".%1").arg(index);
+    if (!info.suffix().isEmpty()) {
+        name += "." + info.suffix();
+    }
+    return info.dir().filePath(name);
+}
+
+void AsyncLogger::messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message) {
+    AsyncLogger* logger = s_installed.loadAcquire();
+    if (!logger) {
+        return;
+    }
+    logger->log(type, context.category, message);
+    if (type == QtFatalMsg) {
+        // Qt aborts once the handler returns
+        logger->flush();
+    }
+}
+
+const char* AsyncLogger::typeToString(QtMsgType type) {
+    switch (type) {
+        case QtDebugMsg: return "DEBUG";
+        case QtInfoMsg: return "INFO";
+        case QtWarningMsg: return "WARNING";
+        case QtCriticalMsg: return "CRITICAL";
+        case QtFatalMsg: return "FATAL";
+        default: return "UNKNOWN";
+    }
+}
+
+void AsyncLogger::run() {
+    QMutexLocker locker(&m_mutex);
+    while (!m_stopping) {
+        m_wake.wait(&m_mutex, FLUSH_INTERVAL_MS);
+        drain();
+    }
+    drain();
+    flushExpiredRepeats(QDateTime::currentMSecsSinceEpoch(), true);
+    writeBatch();
+}
+
+void AsyncLogger::drain() {
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    for (;;) {
+        Slot& slot = m_slots[m_dequeueIndex & m_mask];
+        if (slot.sequence.loadAcquire() != m_dequeueIndex + 1) {
+            break; // Empty, or the next producer has not published yet
+        }
+        if (acceptRepeat(slot)) {
+            appendLine(slot.timestampMs, slot.type, slot.category, slot.message);
+        }
+        slot.category.clear();
+        slot.message.clear();
+        slot.sequence.storeRelease(m_dequeueIndex + m_mask + 1);
+        ++m_dequeueIndex;
+    }
+
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    const quint64 dropped = m_dropped.loadRelaxed();
+    if (dropped != m_reportedDropped) {
+        appendLine(nowMs, QtWarningMsg, "log",
+                   QString("%1 messages dropped, the log queue was full").arg(dropped - m_reportedDropped));
+        m_reportedDropped = dropped;
+    }
+    flushExpiredRepeats(nowMs, false);
+    writeBatch();
+}
+
+bool AsyncLogger::acceptRepeat(const Slot& slot) {
+    if (m_repeatWindowMs <= 0) {
+        return true;
+    }
+
+    QByteArray key = slot.category;
+    key += '\0';
+    key += QByteArray::number(static_cast<int>(slot.type));
+    key += '\0';
+    key += slot.message.toUtf8();
+
+    auto it = m_repeats.find(key);
+    if (it != m_repeats.end()) {
+        if (slot.timestampMs - it->windowStartMs < m_repeatWindowMs) {
+            ++it->suppressed;
+            it->lastSeenMs = slot.timestampMs;
+            m_suppressed.fetchAndAddRelaxed(1);
+            return false;
+        }
+        // The window closed before the drain noticed: summarize it and open a new one
+        if (it->suppressed > 0) {
+            appendLine(it->lastSeenMs, it->type, it->category,
+                       QString("(repeated %1 more times) %2").arg(it->suppressed).arg(it->message));
+        }
+        it->windowStartMs = slot.timestampMs;
+        it->lastSeenMs = slot.timestampMs;
+        it->suppressed = 0;
+        return true;
+    }
+
+    if (m_repeats.size() >= MAX_TRACKED_MESSAGES) {
+        flushExpiredRepeats(slot.timestampMs, false);
+        if (m_repeats.size() >= MAX_TRACKED_MESSAGES) {
+            flushExpiredRepeats(slot.timestampMs, true);
+        }
+    }
+
+    Repeat repeat;
+    repeat.windowStartMs = slot.timestampMs;
+    repeat.lastSeenMs = slot.timestampMs;
+    repeat.type = slot.type;
+    repeat.category = slot.category;
+    repeat.message = slot.message;
+    m_repeats.insert(key, repeat);
+    return true;
+}
+
+void AsyncLogger::flushExpiredRepeats(qint64 nowMs, bool all) {
+    for (auto it = m_repeats.begin(); it != m_repeats.end();) {
+        if (!all && nowMs - it->windowStartMs < m_repeatWindowMs) {
+            ++it;
+            continue;
+        }
+        if (it->suppressed > 0) {
+            appendLine(it->lastSeenMs, it->type, it->category,
+                       QString("(repeated %1 more times) %2").arg(it->suppressed).arg(it->message));
+        }
+        it = m_repeats.erase(it);
+    }
+}
+
+void AsyncLogger::appendLine(qint64 timestampMs, QtMsgType type, const QByteArray& category, const QString& message) {
+    m_batch += '[';
+    m_batch += QDateTime::fromMSecsSinceEpoch(timestampMs).toString(Qt::ISODateWithMs).toUtf8();
+    m_batch += "] ";
+    m_batch += typeToString(type);
+    m_batch += ' ';
+    m_batch += category;
+    m_batch += ": ";
+    m_batch += message.toUtf8();
+    m_batch += '\n';
+}
+
+void AsyncLogger::writeBatch() {
+    if (m_batch.isEmpty()) {
+        return;
+    }
+
+    if (m_echoToConsole) {
+        fwrite(m_batch.constData(), 1, static_cast<size_t>(m_batch.size()), stderr);
+        fflush(stderr);
+    }
+
+    // Rotate before a write that would outgrow the limit, and on the first write of a new day
+    if (m_file.isOpen() && m_file.size() > 0
+        && (m_file.size() + m_batch.size() > m_maxFileBytes || m_fileDate != QDate::currentDate())) {
+        rotate();
+    }
+    if (m_file.isOpen()) {
+        m_file.write(m_batch);
+        m_file.flush();
+    }
+    m_batch.clear();
+}
+
+bool AsyncLogger::openFile() {
+    const QFileInfo info(m_filePath);
+    QDir().mkpath(info.absolutePath());
+
+    m_file.setFileName(m_filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        fprintf(stderr, "Cannot open log file %s: %s\n", qPrintable(m_filePath), qPrintable(m_file.errorString()));
+        return false;
+    }
+    // A file left from an earlier day rotates on the first write
+    m_fileDate = m_file.size() > 0 ? QFileInfo(m_filePath).lastModified().date() : QDate::currentDate();
+    return true;
+}
+
+void AsyncLogger::rotate() {
+    m_file.close();
+
+    QFile::remove(rotatedPath(m_filePath, m_maxFiles - 1));
+    for (int index = m_maxFiles - 2; index >= 0; --index) {
+        QFile::rename(rotatedPath(m_filePath, index), rotatedPath(m_filePath, index + 1));
+    }
+    // With a single file, the rename loop is empty and the removal above truncated it
+
+    openFile();
+}
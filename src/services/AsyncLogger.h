@@ -0,0 +1,134 @@
+#pragma once
+
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <QByteArray>
+#include <QDate>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <memory>
+
+/**
+ * @brief AsyncLogger - Buffered log file written from its own thread
+ *
+ * Installed as the Qt message handler, it takes every qCDebug()/qCWarning() and
+ * ErrorHandler report. Producers only claim a slot in a fixed-size lock-free queue;
+ * a flush thread formats the queued messages and writes them in one batch every
+ * FLUSH_INTERVAL_MS, so a burst of errors costs the GUI and audio threads no disk
+ * I/O. When the queue is full new messages are dropped and counted, and the count
+ * is written once the queue drains.
+ *
+ * The same message from the same category seen again within the repeat window is
+ * not written; a "repeated N times" line follows once the window closes. The file
+ * rotates to "<name>.1.log" ... "<name>.<MAX_FILES - 1>.log" when it would outgrow
+ * the size limit or when the day changes.
+ *
+ * The message handler is process-wide: the installed logger has to outlive every
+ * thread that logs, and uninstalls itself when destroyed.
+ */
+class AsyncLogger {
+public:
+    explicit AsyncLogger(const QString& filePath);
+    ~AsyncLogger();
+
+    // Rotation and rate-limiting settings; call before start()
+    void setMaxFileBytes(qint64 bytes);
+    void setMaxFiles(int files);           // Including the current file
+    void setRepeatWindow(int milliseconds); // 0 writes every repeat
+    // Also write every line to stderr, from the flush thread
+    void setEchoToConsole(bool enabled);
+
+    // Opens the file and starts the flush thread
+    bool start();
+    // Writes everything queued and joins the flush thread
+    void stop();
+    bool isRunning() const { return m_thread != nullptr; }
+
+    // Routes the Qt message handler here, until uninstall() or destruction
+    void install();
+    void uninstall();
+
+    // Producer side; lock-free, never blocks or touches the disk. @p category may be null
+    bool log(QtMsgType type, const char* category, const QString& message);
+    // Blocks until everything queued so far is written
+    void flush();
+
+    QString filePath() const { return m_filePath; }
+    quint64 droppedCount() const { return m_dropped.loadRelaxed(); }
+    quint64 suppressedCount() const { return m_suppressed.loadRelaxed(); }
+
+    // "<dir>/<name>.<index>.<suffix>"; index 0 is the file itself
+    static QString rotatedPath(const QString& filePath, int index);
+
+    static constexpr int QUEUE_CAPACITY = 4096;             // Power of two
+    static constexpr int FLUSH_INTERVAL_MS = 200;
+    static constexpr qint64 MAX_FILE_BYTES = 5 * 1024 * 1024;
+    static constexpr int MAX_FILES = 5;
+    static constexpr int REPEAT_WINDOW_MS = 10000;
+    static constexpr int MAX_TRACKED_MESSAGES = 256;        // Repeat tracking drops older ones beyond this
+
+private:
+    struct Slot {
+        QAtomicInteger<quint64> sequence;
+        qint64 timestampMs = 0;
+        QtMsgType type = QtDebugMsg;
+        QByteArray category;
+        QString message;
+    };
+
+    struct Repeat {
+        qint64 windowStartMs = 0;
+        qint64 lastSeenMs = 0;
+        int suppressed = 0;
+        QtMsgType type = QtDebugMsg;
+        QByteArray category;
+        QString message;
+    };
+
+    static void messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message);
+    static const char* typeToString(QtMsgType type);
+
+    // Flush thread, or flush() holding m_mutex
+    void run();
+    void drain();
+    bool acceptRepeat(const Slot& slot);
+    void flushExpiredRepeats(qint64 nowMs, bool all);
+    void appendLine(qint64 timestampMs, QtMsgType type, const QByteArray& category, const QString& message);
+    void writeBatch();
+    bool openFile();
+    void rotate();
+
+    QString m_filePath;
+    qint64 m_maxFileBytes;
+    int m_maxFiles;
+    int m_repeatWindowMs;
+    bool m_echoToConsole;
+    bool m_installed;
+    QtMessageHandler m_previousHandler;
+
+    std::unique_ptr<Slot[]> m_slots;
+    quint64 m_mask;
+    // Claimed by any producer; the consumer's index is only touched under m_mutex
+    alignas(64) QAtomicInteger<quint64> m_enqueueIndex;
+    alignas(64) quint64 m_dequeueIndex;
+    QAtomicInteger<quint64> m_dropped;
+    QAtomicInteger<quint64> m_suppressed;
+
+    // Consumer state, guarded by m_mutex
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    QThread* m_thread;
+    bool m_stopping;
+    QFile m_file;
+    QDate m_fileDate;
+    QByteArray m_batch;
+    quint64 m_reportedDropped;
+    QHash<QByteArray, Repeat> m_repeats;
+
+    static QAtomicPointer<AsyncLogger> s_installed;
+};
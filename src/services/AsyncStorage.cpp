@@ -0,0 +1,218 @@
+#include "AsyncStorage.h"
+#include "StorageManager.h"
+#include <QDebug>
+
+AsyncStorage::AsyncStorage(IStorageManager* storage, SqliteWriter* writer, RecordingStorage* recordings,
+                           TranscriptionStorage* transcriptions, EnhancedTextStorage* enhancedTexts)
+    : m_storage(storage)
+    , m_writer(writer)
+    , m_recordings(recordings)
+    , m_transcriptions(transcriptions)
+    , m_enhancedTexts(enhancedTexts)
+{
+    m_pool.setMaxThreadCount(MAX_THREADS);
+    m_pool.setExpiryTimeout(-1); // Idle threads keep their read connections open
+    m_pool.setObjectName("AsyncStorage");
+}
+
+AsyncStorage::~AsyncStorage() {
+    waitForDone();
+}
+
+void AsyncStorage::waitForDone() {
+    m_pool.waitForDone();
+}
+
+template <typename T>
+QFuture<T> AsyncStorage::run(std::function<T()> task) {
+    auto promise = std::make_shared<QPromise<T>>();
+    QFuture<T> future = promise->future();
+    promise->start();
+    m_pool.start([promise, task = std::move(task)]() {
+        // Cancelled while queued: skip the query altogether
+        if (!promise->isCanceled()) {
+            promise->addResult(task());
+        }
+        promise->finish();
+    });
+    return future;
+}
+
+template <typename T>
+SqliteWriter::Completion AsyncStorage::finishWith(std::shared_ptr<QPromise<T>> promise, T committed, T failed) {
+    return [promise, committed, failed](bool ok, const QString& errorMessage) {
+        if (!ok) {
+            qWarning() << "AsyncStorage: write failed:" << errorMessage;
+        }
+        promise->addResult(ok ? committed : failed);
+        promise->finish();
+    };
+}
+
+QFuture<bool> AsyncStorage::runOnWriter(const QString& sql, bool standalone) {
+    auto promise = std::make_shared<QPromise<bool>>();
+    QFuture<bool> future = promise->future();
+    promise->start();
+    // Completes on the writer thread; then() moves continuations where they belong
+    auto done = [promise](bool ok, const QString& errorMessage) {
+        Q_UNUSED(errorMessage)
+        promise->addResult(ok);
+        promise->finish();
+    };
+    if (standalone) {
+        m_writer->enqueueStandalone(sql, nullptr, done);
+    } else {
+        m_writer->enqueue(SqliteWriter::Statement{sql, {}, {}}, nullptr, done);
+    }
+    return future;
+}
+
+QFuture<Recording> AsyncStorage::getRecording(const QString& id) {
+    IRecordingStorage* recordings = m_storage->getRecordingStorage();
+    return run<Recording>([recordings, id]() { return recordings->getRecording(id); });
+}
+
+QFuture<QList<Recording>> AsyncStorage::getAllRecordings(const QueryOptions& options) {
+    IRecordingStorage* recordings = m_storage->getRecordingStorage();
+    return run<QList<Recording>>([recordings, options]() { return recordings->getAllRecordings(options); });
+}
+
+QFuture<QList<Recording>> AsyncStorage::getRecordingsBySession(const QString& sessionId, const QueryOptions& options) {
+    IRecordingStorage* recordings = m_storage->getRecordingStorage();
+    return run<QList<Recording>>([recordings, sessionId, options]() {
+        return recordings->getRecordingsBySession(sessionId, options);
+    });
+}
+
+QFuture<QList<Recording>> AsyncStorage::searchRecordings(const QString& searchTerm, const QueryOptions& options) {
+    IRecordingStorage* recordings = m_storage->getRecordingStorage();
+    return run<QList<Recording>>([recordings, searchTerm, options]() {
+        return recordings->searchRecordings(searchTerm, options);
+    });
+}
+
+QFuture<Transcription> AsyncStorage::getTranscription(const QString& id) {
+    ITranscriptionStorage* transcriptions = m_storage->getTranscriptionStorage();
+    return run<Transcription>([transcriptions, id]() { return transcriptions->getTranscription(id); });
+}
+
+QFuture<Transcription> AsyncStorage::getTranscriptionByRecording(const QString& recordingId) {
+    ITranscriptionStorage* transcriptions = m_storage->getTranscriptionStorage();
+    return run<Transcription>([transcriptions, recordingId]() {
+        return transcriptions->getTranscriptionByRecording(recordingId);
+    });
+}
+
+QFuture<QList<TranscriptionSearchHit>> AsyncStorage::searchTranscriptionsRanked(const QString& searchTerm, int limit) {
+    ITranscriptionStorage* transcriptions = m_storage->getTranscriptionStorage();
+    return run<QList<TranscriptionSearchHit>>([transcriptions, searchTerm, limit]() {
+        return transcriptions->searchTranscriptionsRanked(searchTerm, limit);
+    });
+}
+
+QFuture<UserSession> AsyncStorage::getUserSession(const QString& id) {
+    IUserSessionStorage* sessions = m_storage->getUserSessionStorage();
+    return run<UserSession>([sessions, id]() { return sessions->getUserSession(id); });
+}
+
+QFuture<QList<UserSession>> AsyncStorage::getAllSessions(const QueryOptions& options) {
+    IUserSessionStorage* sessions = m_storage->getUserSessionStorage();
+    return run<QList<UserSession>>([sessions, options]() { return sessions->getAllSessions(options); });
+}
+
+QFuture<QStringList> AsyncStorage::getOrphanedAudioFiles() {
+    IRecordingStorage* recordings = m_storage->getRecordingStorage();
+    return run<QStringList>([recordings]() { return recordings->getOrphanedAudioFiles(); });
+}
+
+QFuture<QString> AsyncStorage::saveRecording(const Recording& recording) {
+    auto promise = std::make_shared<QPromise<QString>>();
+    QFuture<QString> future = promise->future();
+    promise->start();
+    m_recordings->queueSave(recording, finishWith<QString>(promise, recording.getId(), QString()));
+    return future;
+}
+
+QFuture<bool> AsyncStorage::updateRecording(const Recording& recording) {
+    RecordingStorage* recordings = m_recordings;
+    auto promise = std::make_shared<QPromise<bool>>();
+    QFuture<bool> future = promise->future();
+    promise->start();
+    // The existence check reads on the pool; the update is then queued from the storage's thread
+    const QString id = recording.getId();
+    run<bool>([recordings, id]() { return recordings->recordingExists(id); })
+        .then(recordings, [recordings, recording, promise](bool exists) {
+            if (!exists) {
+                promise->addResult(false);
+                promise->finish();
+                return;
+            }
+            recordings->queueUpdate(recording, finishWith<bool>(promise, true, false));
+        });
+    return future;
+}
+
+QFuture<bool> AsyncStorage::deleteRecording(const QString& id) {
+    auto promise = std::make_shared<QPromise<bool>>();
+    QFuture<bool> future = promise->future();
+    promise->start();
+    m_recordings->queueDelete(id, finishWith<bool>(promise, true, false));
+    return future;
+}
+
+QFuture<QString> AsyncStorage::saveTranscription(const Transcription& transcription) {
+    auto promise = std::make_shared<QPromise<QString>>();
+    QFuture<QString> future = promise->future();
+    promise->start();
+    m_transcriptions->queueSave(transcription, finishWith<QString>(promise, transcription.getId(), QString()));
+    return future;
+}
+
+QFuture<bool> AsyncStorage::updateTranscription(const Transcription& transcription) {
+    TranscriptionStorage* transcriptions = m_transcriptions;
+    auto promise = std::make_shared<QPromise<bool>>();
+    QFuture<bool> future = promise->future();
+    promise->start();
+    const QString id = transcription.getId();
+    run<bool>([transcriptions, id]() { return transcriptions->transcriptionExists(id); })
+        .then(transcriptions, [transcriptions, transcription, promise](bool exists) {
+            if (!exists) {
+                promise->addResult(false);
+                promise->finish();
+                return;
+            }
+            transcriptions->queueUpdate(transcription, finishWith<bool>(promise, true, false));
+        });
+    return future;
+}
+
+QFuture<QString> AsyncStorage::saveEnhancedText(const QString& recordingId, const EnhancedText& enhancedText) {
+    TranscriptionStorage* transcriptions = m_transcriptions;
+    EnhancedTextStorage* enhancedTexts = m_enhancedTexts;
+    auto promise = std::make_shared<QPromise<QString>>();
+    QFuture<QString> future = promise->future();
+    promise->start();
+    // The lookup runs on the pool; the INSERT is queued from the storage's thread and
+    // the future finishes once it has committed
+    run<Transcription>([transcriptions, recordingId]() {
+        return transcriptions->getTranscriptionByRecording(recordingId);
+    }).then(enhancedTexts, [enhancedTexts, enhancedText, promise](const Transcription& transcription) {
+        if (!transcription.isValid()) {
+            promise->addResult(QString());
+            promise->finish();
+            return;
+        }
+        EnhancedText linked = enhancedText;
+        linked.setTranscriptionId(transcription.getId());
+        enhancedTexts->queueSave(linked, finishWith<QString>(promise, linked.getId(), QString()));
+    });
+    return future;
+}
+
+QFuture<bool> AsyncStorage::analyze() {
+    return runOnWriter("ANALYZE", false);
+}
+
+QFuture<bool> AsyncStorage::vacuum() {
+    return runOnWriter("VACUUM", true);
+}
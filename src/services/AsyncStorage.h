@@ -0,0 +1,88 @@
+#pragma once
+
+#include "SqliteWriter.h"
+#include "../models/EnhancedText.h"
+#include "../models/Recording.h"
+#include "../models/Transcription.h"
+#include "../models/UserSession.h"
+#include "../../specs/001-voice-to-text/contracts/storage-interface.h"
+#include <QFuture>
+#include <QList>
+#include <QPromise>
+#include <QString>
+#include <QThreadPool>
+#include <functional>
+#include <memory>
+
+class EnhancedTextStorage;
+class RecordingStorage;
+class TranscriptionStorage;
+
+/**
+ * @brief AsyncStorage - QFuture counterparts of the storage calls made from the GUI
+ *
+ * Reads run on a small thread pool, each thread on its own read connection from the
+ * ConnectionPool, so a slot can ask for data and get it through then(this, ...)
+ * without waiting on disk. Writes are queued to the writer as before, and their
+ * future finishes from the writer's completion: with the result once the write has
+ * committed, or the failure value when it did not; an update checks that its row
+ * exists on the pool before it is queued. ANALYZE and VACUUM run on the writer
+ * thread, so maintenance never blocks the GUI or fails the writes queued behind it.
+ *
+ * Cancelling a future before its task has started skips the query. A task that is
+ * already running completes, but continuations of a cancelled future do not run.
+ * Call the methods from the storage manager's thread.
+ */
+class AsyncStorage {
+public:
+    AsyncStorage(IStorageManager* storage, SqliteWriter* writer, RecordingStorage* recordings,
+                 TranscriptionStorage* transcriptions, EnhancedTextStorage* enhancedTexts);
+    ~AsyncStorage();
+
+    // Reads
+    QFuture<Recording> getRecording(const QString& id);
+    QFuture<QList<Recording>> getAllRecordings(const QueryOptions& options = {});
+    QFuture<QList<Recording>> getRecordingsBySession(const QString& sessionId, const QueryOptions& options = {});
+    QFuture<QList<Recording>> searchRecordings(const QString& searchTerm, const QueryOptions& options = {});
+    QFuture<Transcription> getTranscription(const QString& id);
+    QFuture<Transcription> getTranscriptionByRecording(const QString& recordingId);
+    QFuture<QList<TranscriptionSearchHit>> searchTranscriptionsRanked(const QString& searchTerm, int limit = 50);
+    QFuture<UserSession> getUserSession(const QString& id);
+    QFuture<QList<UserSession>> getAllSessions(const QueryOptions& options = {});
+    QFuture<QStringList> getOrphanedAudioFiles();
+
+    // Writes; the result reflects the committed row
+    QFuture<QString> saveRecording(const Recording& recording);
+    QFuture<bool> updateRecording(const Recording& recording);
+    QFuture<bool> deleteRecording(const QString& id);
+    QFuture<QString> saveTranscription(const Transcription& transcription);
+    QFuture<bool> updateTranscription(const Transcription& transcription);
+    // Linked to the recording's transcription, looked up once this storage's own
+    // writes of it have committed; empty when the recording has none or the
+    // INSERT did not commit
+    QFuture<QString> saveEnhancedText(const QString& recordingId, const EnhancedText& enhancedText);
+
+    // Maintenance
+    QFuture<bool> analyze();
+    QFuture<bool> vacuum();
+
+    // Blocks until every started task has finished
+    void waitForDone();
+
+    static constexpr int MAX_THREADS = 4;
+
+private:
+    template <typename T>
+    QFuture<T> run(std::function<T()> task);
+    QFuture<bool> runOnWriter(const QString& sql, bool standalone);
+    // Finishes @p promise with @p committed or @p failed from a write's outcome
+    template <typename T>
+    static SqliteWriter::Completion finishWith(std::shared_ptr<QPromise<T>> promise, T committed, T failed);
+
+    IStorageManager* m_storage;
+    SqliteWriter* m_writer;
+    RecordingStorage* m_recordings;
+    TranscriptionStorage* m_transcriptions;
+    EnhancedTextStorage* m_enhancedTexts;
+    QThreadPool m_pool;
+};
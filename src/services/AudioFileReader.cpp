@@ -0,0 +1,217 @@
+#include "AudioFileReader.h"
+#include "FlacCodec.h"
+#include "PolyphaseResampler.h"
+#include <QFile>
+#include <QtEndian>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr quint16 WAVE_FORMAT_PCM = 0x0001;
+constexpr quint16 WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+constexpr quint16 WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+quint16 readU16(const char* p) {
+    return qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(p));
+}
+
+quint32 readU32(const char* p) {
+    return qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(p));
+}
+
+void setErrorMessage(QString* errorMessage, const QString& message) {
+    if (errorMessage) {
+        *errorMessage = message;
+    }
+}
+
+} // namespace
+
+bool AudioFileReader::readSamples(const QString& filePath, QVector<float>& samples, QString* errorMessage) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        setErrorMessage(errorMessage, "Cannot open audio file: " + file.errorString());
+        return false;
+    }
+
+    const QByteArray probe = file.peek(WAV_HEADER_PROBE_SIZE);
+    if (FlacDecoder::isFlac(probe)) {
+        return readFlacSamples(&file, samples, errorMessage);
+    }
+
+    Format format;
+    qint64 dataOffset = parseWavHeader(probe, format);
+    if (dataOffset < 0) {
+        // Headerless stream written by older AudioRecorderService versions (16 kHz mono PCM16)
+        format = Format();
+        dataOffset = 0;
+    }
+
+    if (format.bytesPerSample <= 0 || format.channelCount <= 0 || format.sampleRate <= 0) {
+        setErrorMessage(errorMessage, "Unsupported audio format");
+        return false;
+    }
+
+    file.seek(dataOffset);
+    const QByteArray pcm = file.readAll();
+    if (pcm.isEmpty()) {
+        setErrorMessage(errorMessage, "Audio file contains no samples");
+        return false;
+    }
+
+    samples = convertToFloat(pcm.constData(), pcm.size(), format);
+    if (format.sampleRate != TARGET_SAMPLE_RATE) {
+        samples = resample(samples, format.sampleRate, TARGET_SAMPLE_RATE);
+    }
+
+    if (samples.isEmpty()) {
+        setErrorMessage(errorMessage, "Unsupported sample format");
+        return false;
+    }
+    return true;
+}
+
+bool AudioFileReader::readFlacSamples(QIODevice* device, QVector<float>& samples, QString* errorMessage) {
+    FlacDecoder decoder(device);
+    if (!decoder.readHeader()) {
+        setErrorMessage(errorMessage, decoder.errorString());
+        return false;
+    }
+
+    const Format format = decoder.format();
+    const float scale = std::ldexp(1.0f, -(decoder.bitsPerSample() - 1)) / format.channelCount;
+    PolyphaseResampler resampler(format.sampleRate, TARGET_SAMPLE_RATE);
+
+    samples.clear();
+    if (decoder.totalSamples() > 0) {
+        samples.reserve(static_cast<int>(decoder.totalSamples() * TARGET_SAMPLE_RATE / format.sampleRate + 1));
+    }
+
+    QVector<qint32> frame;
+    QVector<float> mono;
+    int frameSamples;
+    while ((frameSamples = decoder.readFrame(frame)) > 0) {
+        mono.resize(frameSamples);
+        const qint32* p = frame.constData();
+        for (int i = 0; i < frameSamples; ++i) {
+            qint64 sum = 0;
+            for (int ch = 0; ch < format.channelCount; ++ch) {
+                sum += *p++;
+            }
+            mono[i] = static_cast<float>(sum) * scale;
+        }
+        resampler.process(mono.constData(), frameSamples, samples);
+    }
+
+    if (frameSamples < 0) {
+        setErrorMessage(errorMessage, decoder.errorString());
+        return false;
+    }
+    if (samples.isEmpty()) {
+        setErrorMessage(errorMessage, "Audio file contains no samples");
+        return false;
+    }
+    return true;
+}
+
+qint64 AudioFileReader::parseWavHeader(const QByteArray& header, Format& format, qint64* dataSize) {
+    if (header.size() < 12 || (std::memcmp(header.constData(), "RIFF", 4) != 0 &&
+                               std::memcmp(header.constData(), "RF64", 4) != 0) ||
+        std::memcmp(header.constData() + 8, "WAVE", 4) != 0) {
+        return -1;
+    }
+
+    const char* base = header.constData();
+    qint64 offset = 12;
+    bool haveFormat = false;
+    qint64 rf64DataSize = -1; // RF64 keeps the real data size in its ds64 chunk
+
+    while (offset + 8 <= header.size()) {
+        const char* chunk = base + offset;
+        const quint32 chunkSize = readU32(chunk + 4);
+
+        if (std::memcmp(chunk, "ds64", 4) == 0 && offset + 8 + 16 <= header.size()) {
+            rf64DataSize = static_cast<qint64>(qFromLittleEndian<quint64>(reinterpret_cast<const uchar*>(chunk + 16)));
+        } else if (std::memcmp(chunk, "fmt ", 4) == 0 && offset + 8 + 16 <= header.size()) {
+            quint16 audioFormat = readU16(chunk + 8);
+            if (audioFormat == WAVE_FORMAT_EXTENSIBLE && chunkSize >= 40 &&
+                offset + 8 + 26 <= header.size()) {
+                // First two bytes of the sub-format GUID carry the real format tag
+                audioFormat = readU16(chunk + 8 + 24);
+            }
+            if (audioFormat != WAVE_FORMAT_PCM && audioFormat != WAVE_FORMAT_IEEE_FLOAT) {
+                return -1;
+            }
+
+            format.channelCount = readU16(chunk + 10);
+            format.sampleRate = static_cast<int>(readU32(chunk + 12));
+            format.bytesPerSample = readU16(chunk + 22) / 8;
+            format.isFloat = audioFormat == WAVE_FORMAT_IEEE_FLOAT;
+            haveFormat = true;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat) {
+                return -1;
+            }
+            if (dataSize) {
+                *dataSize = chunkSize == 0xFFFFFFFFu && rf64DataSize >= 0 ? rf64DataSize : chunkSize;
+            }
+            return offset + 8;
+        }
+
+        // Chunks are padded to an even number of bytes
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    return -1;
+}
+
+QVector<float> AudioFileReader::convertToFloat(const char* data, qint64 len, const Format& format) {
+    QVector<float> output;
+    const int frameSize = format.bytesPerSample * format.channelCount;
+    if (!data || frameSize <= 0) {
+        return output;
+    }
+
+    const qint64 frameCount = len / frameSize;
+    output.resize(static_cast<int>(frameCount));
+    const float channelScale = 1.0f / static_cast<float>(format.channelCount);
+
+    for (qint64 frame = 0; frame < frameCount; ++frame) {
+        const char* p = data + frame * frameSize;
+        float sum = 0.0f;
+
+        for (int ch = 0; ch < format.channelCount; ++ch, p += format.bytesPerSample) {
+            if (format.isFloat && format.bytesPerSample == 4) {
+                float value;
+                std::memcpy(&value, p, sizeof(value));
+                sum += value;
+            } else if (format.bytesPerSample == 2) {
+                sum += static_cast<float>(qFromLittleEndian<qint16>(p)) / 32768.0f;
+            } else if (format.bytesPerSample == 4) {
+                sum += static_cast<float>(qFromLittleEndian<qint32>(p)) / 2147483648.0f;
+            } else if (format.bytesPerSample == 1) {
+                sum += (static_cast<float>(static_cast<quint8>(*p)) - 128.0f) / 128.0f;
+            } else {
+                return QVector<float>();
+            }
+        }
+
+        output[static_cast<int>(frame)] = sum * channelScale;
+    }
+
+    return output;
+}
+
+QVector<float> AudioFileReader::resample(const QVector<float>& input, int inputRate, int outputRate) {
+    return PolyphaseResampler::resample(input, inputRate, outputRate);
+}
+
+AudioFileReader::Format AudioFileReader::whisperFormat() {
+    Format format;
+    format.sampleRate = TARGET_SAMPLE_RATE;
+    format.channelCount = 1;
+    format.bytesPerSample = 4;
+    format.isFloat = true;
+    return format;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+class QIODevice;
+
+/**
+ * @brief AudioFileReader - Loads recorded audio as 16 kHz mono float samples
+ *
+ * whisper.cpp consumes normalized 32-bit float PCM at 16 kHz. This helper reads
+ * RIFF/RF64 WAVE files (PCM16, PCM32, float32), FLAC recordings and the headerless
+ * PCM16 stream older versions of AudioRecorderService wrote, and converts them to that layout.
+ * FLAC is decoded frame by frame straight into the resampler, without an intermediate file.
+ */
+class AudioFileReader {
+public:
+    struct Format {
+        int sampleRate = 16000;
+        int channelCount = 1;
+        int bytesPerSample = 2;
+        bool isFloat = false;
+    };
+
+    // Read the whole file, down-mixing and resampling to 16 kHz mono
+    static bool readSamples(const QString& filePath, QVector<float>& samples, QString* errorMessage = nullptr);
+
+    // Parse a RIFF/RF64 WAVE header; returns the offset of the data chunk or -1
+    static qint64 parseWavHeader(const QByteArray& header, Format& format, qint64* dataSize = nullptr);
+
+    // Sample conversion helpers
+    static QVector<float> convertToFloat(const char* data, qint64 len, const Format& format);
+    static QVector<float> resample(const QVector<float>& input, int inputRate, int outputRate);
+
+    // 16 kHz mono float32, the layout whisper.cpp decodes without conversion
+    static Format whisperFormat();
+
+    static constexpr int TARGET_SAMPLE_RATE = 16000;
+
+private:
+    static bool readFlacSamples(QIODevice* device, QVector<float>& samples, QString* errorMessage);
+
+    static constexpr int WAV_HEADER_PROBE_SIZE = 4096;
+};
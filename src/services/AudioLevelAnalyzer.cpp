@@ -0,0 +1,359 @@
+#include "AudioLevelAnalyzer.h"
+#include <QtMath>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QUILLSCRIBE_AUDIO_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// AVX2 needs no build flag on GCC/Clang: the kernels are compiled for it individually and
+// picked at runtime. MSVC only gets them when the whole build targets AVX2.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QUILLSCRIBE_AUDIO_AVX2 1
+#define QUILLSCRIBE_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(__AVX2__)
+#define QUILLSCRIBE_AUDIO_AVX2 1
+#define QUILLSCRIBE_TARGET_AVX2
+#include <immintrin.h>
+#endif
+
+#if !defined(QUILLSCRIBE_AUDIO_SSE2) && (defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64))
+#define QUILLSCRIBE_AUDIO_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Partial sums are flushed to double every block, so float lanes never lose precision
+constexpr qint64 BLOCK_SIZE = 4096;
+constexpr float CLIP = AudioLevelAnalyzer::CLIP_THRESHOLD;
+
+struct Accumulator {
+    double sumSquares = 0.0;
+    float peak = 0.0f;
+    qint64 clipped = 0;
+};
+
+inline float toUnit(quint8 sample) { return (static_cast<float>(sample) - 128.0f) * (1.0f / 128.0f); }
+inline float toUnit(qint16 sample) { return static_cast<float>(sample) * (1.0f / 32768.0f); }
+inline float toUnit(qint32 sample) { return static_cast<float>(sample) * (1.0f / 2147483648.0f); }
+inline float toUnit(float sample) { return sample; }
+
+template <typename T>
+void scalarKernel(const T* samples, qint64 count, Accumulator& acc) {
+    for (qint64 block = 0; block < count; block += BLOCK_SIZE) {
+        const qint64 end = qMin(count, block + BLOCK_SIZE);
+        float sum = 0.0f;
+        for (qint64 i = block; i < end; ++i) {
+            const float x = toUnit(samples[i]);
+            const float magnitude = std::fabs(x);
+            sum += x * x;
+            acc.peak = qMax(acc.peak, magnitude);
+            acc.clipped += magnitude >= CLIP ? 1 : 0;
+        }
+        acc.sumSquares += sum;
+    }
+}
+
+#ifdef QUILLSCRIBE_AUDIO_SSE2
+struct Sse2Int16 {
+    using Sample = qint16;
+    static constexpr int STEP = 4;
+    static inline __m128 load(const qint16* p) {
+        const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+        const __m128i widened = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        return _mm_mul_ps(_mm_cvtepi32_ps(widened), _mm_set1_ps(1.0f / 32768.0f));
+    }
+};
+
+struct Sse2Int32 {
+    using Sample = qint32;
+    static constexpr int STEP = 4;
+    static inline __m128 load(const qint32* p) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        return _mm_mul_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(1.0f / 2147483648.0f));
+    }
+};
+
+struct Sse2Float {
+    using Sample = float;
+    static constexpr int STEP = 4;
+    static inline __m128 load(const float* p) { return _mm_loadu_ps(p); }
+};
+
+// Returns how many leading samples were consumed; the caller finishes the tail
+template <typename Loader>
+qint64 sse2Kernel(const typename Loader::Sample* samples, qint64 count, Accumulator& acc) {
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 clip = _mm_set1_ps(CLIP);
+    const qint64 vectorEnd = count - count % Loader::STEP;
+    __m128 peak = _mm_setzero_ps();
+
+    for (qint64 block = 0; block < vectorEnd; block += BLOCK_SIZE) {
+        const qint64 end = qMin(vectorEnd, block + BLOCK_SIZE);
+        __m128 sum = _mm_setzero_ps();
+        __m128i clipped = _mm_setzero_si128();
+        for (qint64 i = block; i < end; i += Loader::STEP) {
+            const __m128 x = Loader::load(samples + i);
+            const __m128 magnitude = _mm_andnot_ps(signMask, x);
+            sum = _mm_add_ps(sum, _mm_mul_ps(x, x));
+            peak = _mm_max_ps(peak, magnitude);
+            // Comparison lanes are all ones (-1) when clipped
+            clipped = _mm_sub_epi32(clipped, _mm_castps_si128(_mm_cmpge_ps(magnitude, clip)));
+        }
+
+        float sums[4];
+        qint32 counts[4];
+        _mm_storeu_ps(sums, sum);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(counts), clipped);
+        acc.sumSquares += static_cast<double>(sums[0]) + sums[1] + sums[2] + sums[3];
+        acc.clipped += static_cast<qint64>(counts[0]) + counts[1] + counts[2] + counts[3];
+    }
+
+    float peaks[4];
+    _mm_storeu_ps(peaks, peak);
+    acc.peak = qMax(acc.peak, qMax(qMax(peaks[0], peaks[1]), qMax(peaks[2], peaks[3])));
+    return vectorEnd;
+}
+#endif
+
+#ifdef QUILLSCRIBE_AUDIO_AVX2
+struct Avx2Int16 {
+    using Sample = qint16;
+    static constexpr int STEP = 8;
+    QUILLSCRIBE_TARGET_AVX2 static inline __m256 load(const qint16* p) {
+        const __m256i widened = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(widened), _mm256_set1_ps(1.0f / 32768.0f));
+    }
+};
+
+struct Avx2Int32 {
+    using Sample = qint32;
+    static constexpr int STEP = 8;
+    QUILLSCRIBE_TARGET_AVX2 static inline __m256 load(const qint32* p) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(v), _mm256_set1_ps(1.0f / 2147483648.0f));
+    }
+};
+
+struct Avx2Float {
+    using Sample = float;
+    static constexpr int STEP = 8;
+    QUILLSCRIBE_TARGET_AVX2 static inline __m256 load(const float* p) { return _mm256_loadu_ps(p); }
+};
+
+template <typename Loader>
+QUILLSCRIBE_TARGET_AVX2 qint64 avx2Kernel(const typename Loader::Sample* samples, qint64 count, Accumulator& acc) {
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 clip = _mm256_set1_ps(CLIP);
+    const qint64 vectorEnd = count - count % Loader::STEP;
+    __m256 peak = _mm256_setzero_ps();
+
+    for (qint64 block = 0; block < vectorEnd; block += BLOCK_SIZE) {
+        const qint64 end = qMin(vectorEnd, block + BLOCK_SIZE);
+        __m256 sum = _mm256_setzero_ps();
+        __m256i clipped = _mm256_setzero_si256();
+        for (qint64 i = block; i < end; i += Loader::STEP) {
+            const __m256 x = Loader::load(samples + i);
+            const __m256 magnitude = _mm256_andnot_ps(signMask, x);
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(x, x));
+            peak = _mm256_max_ps(peak, magnitude);
+            clipped = _mm256_sub_epi32(clipped, _mm256_castps_si256(_mm256_cmp_ps(magnitude, clip, _CMP_GE_OQ)));
+        }
+
+        float sums[8];
+        qint32 counts[8];
+        _mm256_storeu_ps(sums, sum);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(counts), clipped);
+        for (int lane = 0; lane < 8; ++lane) {
+            acc.sumSquares += sums[lane];
+            acc.clipped += counts[lane];
+        }
+    }
+
+    float peaks[8];
+    _mm256_storeu_ps(peaks, peak);
+    for (float lanePeak : peaks) {
+        acc.peak = qMax(acc.peak, lanePeak);
+    }
+    return vectorEnd;
+}
+
+bool hasAvx2() {
+#if defined(__GNUC__)
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return true; // Built with /arch:AVX2
+#endif
+}
+#endif
+
+#ifdef QUILLSCRIBE_AUDIO_NEON
+struct NeonInt16 {
+    using Sample = qint16;
+    static constexpr int STEP = 4;
+    static inline float32x4_t load(const qint16* p) {
+        return vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vld1_s16(p))), 1.0f / 32768.0f);
+    }
+};
+
+struct NeonInt32 {
+    using Sample = qint32;
+    static constexpr int STEP = 4;
+    static inline float32x4_t load(const qint32* p) {
+        return vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(p)), 1.0f / 2147483648.0f);
+    }
+};
+
+struct NeonFloat {
+    using Sample = float;
+    static constexpr int STEP = 4;
+    static inline float32x4_t load(const float* p) { return vld1q_f32(p); }
+};
+
+template <typename Loader>
+qint64 neonKernel(const typename Loader::Sample* samples, qint64 count, Accumulator& acc) {
+    const float32x4_t clip = vdupq_n_f32(CLIP);
+    const qint64 vectorEnd = count - count % Loader::STEP;
+    float32x4_t peak = vdupq_n_f32(0.0f);
+
+    for (qint64 block = 0; block < vectorEnd; block += BLOCK_SIZE) {
+        const qint64 end = qMin(vectorEnd, block + BLOCK_SIZE);
+        float32x4_t sum = vdupq_n_f32(0.0f);
+        uint32x4_t clipped = vdupq_n_u32(0);
+        for (qint64 i = block; i < end; i += Loader::STEP) {
+            const float32x4_t x = Loader::load(samples + i);
+            const float32x4_t magnitude = vabsq_f32(x);
+            sum = vmlaq_f32(sum, x, x);
+            peak = vmaxq_f32(peak, magnitude);
+            clipped = vsubq_u32(clipped, vcgeq_f32(magnitude, clip));
+        }
+
+        float sums[4];
+        quint32 counts[4];
+        vst1q_f32(sums, sum);
+        vst1q_u32(counts, clipped);
+        acc.sumSquares += static_cast<double>(sums[0]) + sums[1] + sums[2] + sums[3];
+        acc.clipped += static_cast<qint64>(counts[0]) + counts[1] + counts[2] + counts[3];
+    }
+
+    float peaks[4];
+    vst1q_f32(peaks, peak);
+    acc.peak = qMax(acc.peak, qMax(qMax(peaks[0], peaks[1]), qMax(peaks[2], peaks[3])));
+    return vectorEnd;
+}
+#endif
+
+// Vector prefix for each sample type; 8-bit capture is rare enough to stay scalar
+qint64 vectorKernel(const quint8*, qint64, Accumulator&) {
+    return 0;
+}
+
+qint64 vectorKernel(const qint16* samples, qint64 count, Accumulator& acc) {
+#ifdef QUILLSCRIBE_AUDIO_AVX2
+    if (hasAvx2()) {
+        return avx2Kernel<Avx2Int16>(samples, count, acc);
+    }
+#endif
+#if defined(QUILLSCRIBE_AUDIO_SSE2)
+    return sse2Kernel<Sse2Int16>(samples, count, acc);
+#elif defined(QUILLSCRIBE_AUDIO_NEON)
+    return neonKernel<NeonInt16>(samples, count, acc);
+#else
+    Q_UNUSED(samples)
+    Q_UNUSED(count)
+    Q_UNUSED(acc)
+    return 0;
+#endif
+}
+
+qint64 vectorKernel(const qint32* samples, qint64 count, Accumulator& acc) {
+#ifdef QUILLSCRIBE_AUDIO_AVX2
+    if (hasAvx2()) {
+        return avx2Kernel<Avx2Int32>(samples, count, acc);
+    }
+#endif
+#if defined(QUILLSCRIBE_AUDIO_SSE2)
+    return sse2Kernel<Sse2Int32>(samples, count, acc);
+#elif defined(QUILLSCRIBE_AUDIO_NEON)
+    return neonKernel<NeonInt32>(samples, count, acc);
+#else
+    Q_UNUSED(samples)
+    Q_UNUSED(count)
+    Q_UNUSED(acc)
+    return 0;
+#endif
+}
+
+qint64 vectorKernel(const float* samples, qint64 count, Accumulator& acc) {
+#ifdef QUILLSCRIBE_AUDIO_AVX2
+    if (hasAvx2()) {
+        return avx2Kernel<Avx2Float>(samples, count, acc);
+    }
+#endif
+#if defined(QUILLSCRIBE_AUDIO_SSE2)
+    return sse2Kernel<Sse2Float>(samples, count, acc);
+#elif defined(QUILLSCRIBE_AUDIO_NEON)
+    return neonKernel<NeonFloat>(samples, count, acc);
+#else
+    Q_UNUSED(samples)
+    Q_UNUSED(count)
+    Q_UNUSED(acc)
+    return 0;
+#endif
+}
+
+template <typename T>
+void analyzeSamples(const char* data, qint64 len, Accumulator& acc, qint64& sampleCount) {
+    const T* samples = reinterpret_cast<const T*>(data);
+    sampleCount = len / static_cast<qint64>(sizeof(T));
+    const qint64 done = vectorKernel(samples, sampleCount, acc);
+    scalarKernel(samples + done, sampleCount - done, acc);
+}
+
+} // namespace
+
+AudioLevelStats AudioLevelAnalyzer::analyze(const char* data, qint64 len, const AudioFileReader::Format& format) {
+    AudioLevelStats stats;
+    if (!data || len <= 0) {
+        return stats;
+    }
+
+    Accumulator acc;
+    if (format.isFloat && format.bytesPerSample == 4) {
+        analyzeSamples<float>(data, len, acc, stats.sampleCount);
+    } else if (format.bytesPerSample == 2) {
+        analyzeSamples<qint16>(data, len, acc, stats.sampleCount);
+    } else if (format.bytesPerSample == 4) {
+        analyzeSamples<qint32>(data, len, acc, stats.sampleCount);
+    } else if (format.bytesPerSample == 1) {
+        analyzeSamples<quint8>(data, len, acc, stats.sampleCount);
+    } else {
+        return stats;
+    }
+
+    if (stats.sampleCount > 0) {
+        stats.rms = qBound(0.0, qSqrt(acc.sumSquares / stats.sampleCount), 1.0);
+        stats.peak = qBound(0.0, static_cast<double>(acc.peak), 1.0);
+        stats.clippedSamples = acc.clipped;
+    }
+    return stats;
+}
+
+QString AudioLevelAnalyzer::activeKernel() {
+#ifdef QUILLSCRIBE_AUDIO_AVX2
+    if (hasAvx2()) {
+        return QStringLiteral("avx2");
+    }
+#endif
+#if defined(QUILLSCRIBE_AUDIO_SSE2)
+    return QStringLiteral("sse2");
+#elif defined(QUILLSCRIBE_AUDIO_NEON)
+    return QStringLiteral("neon");
+#else
+    return QStringLiteral("scalar");
+#endif
+}
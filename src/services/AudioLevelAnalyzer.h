@@ -0,0 +1,34 @@
+#pragma once
+
+#include "AudioFileReader.h"
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief Result of one AudioLevelAnalyzer pass, normalized to [0, 1]
+ */
+struct AudioLevelStats {
+    double rms = 0.0;
+    double peak = 0.0;          // Largest absolute sample
+    qint64 clippedSamples = 0;  // Samples at or above AudioLevelAnalyzer::CLIP_THRESHOLD
+    qint64 sampleCount = 0;
+
+    bool isClipping() const { return clippedSamples > 0; }
+};
+
+/**
+ * @brief AudioLevelAnalyzer - Single-pass RMS, peak and clip detection
+ *
+ * Vectorized with AVX2 (selected at runtime where the compiler allows it), SSE2
+ * or NEON, with a scalar fallback. Handles interleaved 8-bit unsigned, 16/32-bit
+ * signed and 32-bit float PCM; all channels are measured together.
+ */
+class AudioLevelAnalyzer {
+public:
+    static AudioLevelStats analyze(const char* data, qint64 len, const AudioFileReader::Format& format);
+
+    // Name of the kernel analyze() dispatches to ("avx2", "sse2", "neon" or "scalar")
+    static QString activeKernel();
+
+    static constexpr float CLIP_THRESHOLD = 0.999f; // Within ~0.01 dB of full scale
+};
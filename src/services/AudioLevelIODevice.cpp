@@ -1,18 +1,29 @@
 #include "AudioLevelIODevice.h"
+#include "Telemetry.h"
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QtMath>
 #include <algorithm>
 
 AudioLevelIODevice::AudioLevelIODevice(QFile* outputFile, QObject* parent)
     : QIODevice(parent)
     , m_outputFile(outputFile)
+    , m_writer(outputFile)
+    , m_transcriptionFile(nullptr)
+    , m_drainTimer(new QTimer(this))
+    , m_dspTimings(DSP_TIMING_SLOTS * static_cast<qsizetype>(sizeof(qint64)))
+    , m_telemetry(nullptr)
     , m_sampleRate(16000)
     , m_channelCount(1)
     , m_bytesPerSample(2)
-    , m_currentLevel(0.0)
+    , m_isFloat(false)
+    , m_pcmTapEnabled(false)
 {
     // Set up the device as write-only (we're recording)
     setOpenMode(QIODevice::WriteOnly);
+    
+    m_drainTimer->setInterval(NOTIFY_INTERVAL_MS);
+    connect(m_drainTimer, &QTimer::timeout, this, &AudioLevelIODevice::drainRingBuffer);
 }
 
 AudioLevelIODevice::~AudioLevelIODevice() {
@@ -22,7 +33,7 @@ AudioLevelIODevice::~AudioLevelIODevice() {
 }
 
 bool AudioLevelIODevice::isSequential() const {
-    return m_outputFile ? m_outputFile->isSequential() : true;
+    return true; // The file belongs to the writer thread while recording
 }
 
 bool AudioLevelIODevice::open(OpenMode mode) {
@@ -38,6 +49,43 @@ bool AudioLevelIODevice::open(OpenMode mode) {
     }
     
     if (m_outputFile->isOpen() || m_outputFile->open(mode)) {
+        AudioFileReader::Format format;
+        format.sampleRate = m_sampleRate;
+        format.channelCount = m_channelCount;
+        format.bytesPerSample = m_bytesPerSample;
+        format.isFloat = m_isFloat;
+        if (m_dsp.configure(format)) {
+            qDebug() << "Capture processing enabled, latency" << m_dsp.latencyFrames() << "frames";
+        } else {
+            qWarning() << "Capture processing unavailable for this sample format; recording unprocessed audio";
+        }
+        if (!m_writer.start(format)) {
+            setErrorString(m_writer.errorString());
+            m_outputFile->close();
+            return false;
+        }
+        
+        if (m_transcriptionFile) {
+            // The copy is optional: without it transcription falls back to the main file
+            m_transcriptionWriter = std::make_unique<RecordingFileWriter>(m_transcriptionFile);
+            m_transcriptionWriter->setFileFormat(AudioFileReader::whisperFormat());
+            if (!m_transcriptionFile->open(QIODevice::WriteOnly) || !m_transcriptionWriter->start(format)) {
+                qWarning() << "Cannot create transcription stream:" << m_transcriptionFile->errorString();
+                m_transcriptionWriter.reset();
+                m_transcriptionFile->close();
+                QFile::remove(m_transcriptionFile->fileName());
+            }
+        }
+        
+        // Sized once here so the audio thread never allocates
+        const qsizetype bytesPerSecond = static_cast<qsizetype>(m_sampleRate) * m_channelCount * m_bytesPerSample;
+        m_ringBuffer.reset(qMax(MIN_RING_BUFFER_BYTES, bytesPerSecond * RING_BUFFER_MS / 1000));
+        m_drainBuffer.reserve(m_ringBuffer.capacity());
+        {
+            QMutexLocker locker(&m_levelMutex);
+            m_waveformPeaks.reset(m_sampleRate);
+        }
+        m_drainTimer->start();
         return QIODevice::open(mode);
     }
     
@@ -46,6 +94,43 @@ bool AudioLevelIODevice::open(OpenMode mode) {
 }
 
 void AudioLevelIODevice::close() {
+    // The end of the recording is still inside the processing stages
+    if (isOpen() && m_dsp.isActive()) {
+        const QByteArray& tail = m_dsp.flush();
+        deliver(tail.constData(), tail.size());
+    }
+    
+    // Deliver whatever the audio thread wrote since the last tick
+    m_drainTimer->stop();
+    drainRingBuffer();
+    {
+        QMutexLocker locker(&m_levelMutex);
+        m_waveformPeaks.finish();
+    }
+    if (m_ringBuffer.droppedBytes() > 0) {
+        qWarning() << "AudioLevelIODevice dropped" << m_ringBuffer.droppedBytes() << "bytes of monitoring data";
+    }
+    
+    // Flushes the queue and finalizes the file header before the file is closed
+    if (m_writer.isRunning() && !m_writer.finish()) {
+        qWarning() << "Recording may be incomplete:" << m_writer.errorString();
+    }
+    if (m_writer.droppedBytes() > 0) {
+        qWarning() << "Recording lost" << m_writer.droppedBytes() << "bytes while the disk stalled";
+    }
+    emitCompletedSegments();
+    if (!m_writer.joinSegments()) {
+        // The segment files are kept; recovery stitches them on the next start
+        qWarning() << "Cannot join recording segments:" << m_writer.errorString();
+    }
+    if (m_transcriptionWriter) {
+        if (!m_transcriptionWriter->finish()) {
+            qWarning() << "Transcription stream may be incomplete:" << m_transcriptionWriter->errorString();
+        }
+        m_transcriptionWriter.reset();
+        m_transcriptionFile->close();
+    }
+    
     if (m_outputFile && m_outputFile->isOpen()) {
         m_outputFile->close();
     }
@@ -53,27 +138,31 @@ void AudioLevelIODevice::close() {
 }
 
 qint64 AudioLevelIODevice::size() const {
-    return m_outputFile ? m_outputFile->size() : 0;
+    // Includes audio still queued for the writer thread
+    return m_writer.isRunning() ? m_writer.fileSize() : (m_outputFile ? m_outputFile->size() : 0);
 }
 
 qint64 AudioLevelIODevice::pos() const {
-    return m_outputFile ? m_outputFile->pos() : 0;
+    return size();
 }
 
 bool AudioLevelIODevice::seek(qint64 pos) {
-    if (m_outputFile && m_outputFile->seek(pos)) {
-        return QIODevice::seek(pos);
-    }
+    Q_UNUSED(pos)
     return false;
 }
 
 bool AudioLevelIODevice::atEnd() const {
-    return m_outputFile ? m_outputFile->atEnd() : true;
+    return true;
 }
 
 double AudioLevelIODevice::getCurrentLevel() const {
     QMutexLocker locker(&m_levelMutex);
-    return m_currentLevel;
+    return m_currentStats.rms;
+}
+
+AudioLevelStats AudioLevelIODevice::getCurrentStats() const {
+    QMutexLocker locker(&m_levelMutex);
+    return m_currentStats;
 }
 
 QByteArray AudioLevelIODevice::getLastAudioData() const {
@@ -81,16 +170,79 @@ QByteArray AudioLevelIODevice::getLastAudioData() const {
     return m_lastAudioData;
 }
 
-void AudioLevelIODevice::setAudioFormat(int sampleRate, int channelCount, int bytesPerSample) {
+WaveformPeaks AudioLevelIODevice::getWaveformPeaks() const {
+    QMutexLocker locker(&m_levelMutex);
+    return m_waveformPeaks;
+}
+
+void AudioLevelIODevice::setAudioFormat(int sampleRate, int channelCount, int bytesPerSample, bool isFloat) {
     QMutexLocker locker(&m_levelMutex);
     m_sampleRate = sampleRate;
     m_channelCount = channelCount;
     m_bytesPerSample = bytesPerSample;
+    m_isFloat = isFloat;
     
     qDebug() << "AudioLevelIODevice format set:" 
              << "sampleRate=" << m_sampleRate
              << "channelCount=" << m_channelCount  
-             << "bytesPerSample=" << m_bytesPerSample;
+             << "bytesPerSample=" << m_bytesPerSample
+             << "isFloat=" << m_isFloat;
+}
+
+void AudioLevelIODevice::setPcmTapEnabled(bool enabled) {
+    QMutexLocker locker(&m_levelMutex);
+    m_pcmTapEnabled = enabled;
+}
+
+bool AudioLevelIODevice::isPcmTapEnabled() const {
+    QMutexLocker locker(&m_levelMutex);
+    return m_pcmTapEnabled;
+}
+
+void AudioLevelIODevice::setFileFormat(const AudioFileReader::Format& format) {
+    m_writer.setFileFormat(format);
+}
+
+void AudioLevelIODevice::setFileCodec(AudioCodec codec) {
+    m_writer.setCodec(codec);
+}
+
+AudioCodec AudioLevelIODevice::getFileCodec() const {
+    return m_writer.codec();
+}
+
+void AudioLevelIODevice::setTranscriptionOutputPath(const QString& filePath) {
+    delete m_transcriptionFile;
+    m_transcriptionFile = filePath.isEmpty() ? nullptr : new QFile(filePath, this);
+}
+
+QString AudioLevelIODevice::getTranscriptionOutputPath() const {
+    return m_transcriptionFile ? m_transcriptionFile->fileName() : QString();
+}
+
+void AudioLevelIODevice::setSegmentDuration(int milliseconds) {
+    m_writer.setSegmentDuration(milliseconds);
+}
+
+void AudioLevelIODevice::setNoiseReduction(bool enabled) {
+    m_dsp.setNoiseReduction(enabled);
+}
+
+void AudioLevelIODevice::setAutoGainControl(bool enabled) {
+    m_dsp.setAutoGainControl(enabled);
+}
+
+void AudioLevelIODevice::setInputGain(double gain) {
+    m_dsp.setInputGain(gain);
+}
+
+void AudioLevelIODevice::setTelemetry(Telemetry* telemetry) {
+    m_telemetry = telemetry;
+    m_writer.setTelemetry(telemetry);
+}
+
+quint64 AudioLevelIODevice::getDroppedBytes() const {
+    return m_ringBuffer.droppedBytes();
 }
 
 qint64 AudioLevelIODevice::readData(char* data, qint64 maxlen) {
@@ -108,75 +260,100 @@ qint64 AudioLevelIODevice::writeData(const char* data, qint64 len) {
         return -1;
     }
     
-    // Write data to the underlying file first
-    qint64 bytesWritten = m_outputFile->write(data, len);
-    
-    if (bytesWritten > 0) {
-        // Update audio level monitoring with the actual data being written
-        updateLevel(data, bytesWritten);
-    } else if (bytesWritten < 0) {
-        setErrorString(m_outputFile->errorString());
+    if (m_writer.hasError()) {
+        setErrorString(m_writer.errorString());
+        return -1;
     }
     
-    return bytesWritten;
+    if (m_dsp.isActive()) {
+        // Shorter than the input while the stages fill up; close() flushes the rest
+        QElapsedTimer timer;
+        timer.start();
+        const QByteArray& processed = m_dsp.process(data, len);
+        if (m_telemetry) {
+            // Whole slots only, so a full buffer drops a timing rather than splitting one
+            const qint64 elapsedNs = timer.nsecsElapsed();
+            m_dspTimings.write(reinterpret_cast<const char*>(&elapsedNs), sizeof(elapsedNs));
+        }
+        deliver(processed.constData(), processed.size());
+    } else {
+        deliver(data, len);
+    }
+    return len;
 }
 
-double AudioLevelIODevice::calculateRMSLevel(const char* data, qint64 len) const {
-    if (!data || len <= 0 || m_bytesPerSample <= 0) {
-        return 0.0;
+void AudioLevelIODevice::deliver(const char* data, qint64 len) {
+    if (len <= 0) {
+        return;
     }
     
-    // Calculate number of samples
-    qint64 sampleCount = len / m_bytesPerSample;
-    if (sampleCount == 0) {
-        return 0.0;
+    // Queued for the writer thread(s); the disk is never touched here
+    m_writer.write(data, len);
+    if (m_transcriptionWriter) {
+        m_transcriptionWriter->write(data, len);
     }
     
-    double sum = 0.0;
+    // Hand the chunk to the consumer side; levels and signals are produced there
+    m_ringBuffer.write(data, len);
+}
+
+void AudioLevelIODevice::drainRingBuffer() {
+    emitCompletedSegments();
     
-    if (m_bytesPerSample == 2) {
-        // 16-bit signed integer samples
-        const int16_t* samples = reinterpret_cast<const int16_t*>(data);
-        for (qint64 i = 0; i < sampleCount; ++i) {
-            double sample = static_cast<double>(samples[i]) / 32768.0; // Normalize to [-1, 1]
-            sum += sample * sample;
-        }
-    } else if (m_bytesPerSample == 4) {
-        // 32-bit signed integer samples  
-        const int32_t* samples = reinterpret_cast<const int32_t*>(data);
-        for (qint64 i = 0; i < sampleCount; ++i) {
-            double sample = static_cast<double>(samples[i]) / 2147483648.0; // Normalize to [-1, 1]
-            sum += sample * sample;
-        }
-    } else if (m_bytesPerSample == 1) {
-        // 8-bit unsigned samples
-        const uint8_t* samples = reinterpret_cast<const uint8_t*>(data);
-        for (qint64 i = 0; i < sampleCount; ++i) {
-            double sample = (static_cast<double>(samples[i]) - 128.0) / 128.0; // Normalize to [-1, 1]
-            sum += sample * sample;
-        }
-    } else {
-        qWarning() << "Unsupported bytes per sample:" << m_bytesPerSample;
-        return 0.0;
+    qint64 elapsedNs = 0;
+    while (m_telemetry && m_dspTimings.read(reinterpret_cast<char*>(&elapsedNs), sizeof(elapsedNs)) == sizeof(elapsedNs)) {
+        m_telemetry->recordStage(Telemetry::STAGE_CAPTURE, elapsedNs / 1000);
     }
     
-    // Calculate RMS and clamp to [0, 1]
-    double rms = qSqrt(sum / sampleCount);
-    return qBound(0.0, rms, 1.0);
-}
-
-void AudioLevelIODevice::updateLevel(const char* data, qint64 len) {
-    QMutexLocker locker(&m_levelMutex);
+    // Only whole frames, so a partially dropped chunk cannot shift sample alignment
+    const qsizetype frameBytes = qMax(1, m_channelCount * m_bytesPerSample);
+    const qsizetype available = m_ringBuffer.availableToRead() / frameBytes * frameBytes;
+    if (available <= 0) {
+        return;
+    }
     
-    // Calculate new level from the actual audio data
-    double newLevel = calculateRMSLevel(data, len);
-    m_currentLevel = newLevel;
+    m_drainBuffer.resize(available);
+    m_ringBuffer.read(m_drainBuffer.data(), available);
     
-    // Store a copy of the audio data (limited size for memory efficiency)
-    qint64 dataSize = qMin(len, static_cast<qint64>(MAX_AUDIO_DATA_SIZE));
-    m_lastAudioData = QByteArray(data, static_cast<int>(dataSize));
+    QByteArray lastAudioData;
+    double newLevel = 0.0;
+    bool tapEnabled = false;
+    {
+        QMutexLocker locker(&m_levelMutex);
+        
+        // The level covers everything captured since the previous tick
+        AudioFileReader::Format format;
+        format.sampleRate = m_sampleRate;
+        format.channelCount = m_channelCount;
+        format.bytesPerSample = m_bytesPerSample;
+        format.isFloat = m_isFloat;
+        m_currentStats = AudioLevelAnalyzer::analyze(m_drainBuffer.constData(), available, format);
+        newLevel = m_currentStats.rms;
+        
+        const QVector<float> mono = AudioFileReader::convertToFloat(m_drainBuffer.constData(), available, format);
+        m_waveformPeaks.addSamples(mono.constData(), mono.size());
+        
+        // Keep the most recent audio (limited size for memory efficiency)
+        const qsizetype dataSize = qMin(available, static_cast<qsizetype>(MAX_AUDIO_DATA_SIZE) / frameBytes * frameBytes);
+        m_lastAudioData = m_drainBuffer.right(dataSize);
+        lastAudioData = m_lastAudioData;
+        tapEnabled = m_pcmTapEnabled;
+    }
     
-    // Emit signals (Qt will queue these if called from different thread)
     emit levelChanged(newLevel);
-    emit audioDataReady(m_lastAudioData);
+    emit audioDataReady(lastAudioData);
+    
+    // Unlike audioDataReady, the tap carries all of the data
+    if (tapEnabled) {
+        emit pcmDataWritten(m_drainBuffer);
+    }
+}
+
+void AudioLevelIODevice::emitCompletedSegments() {
+    const QList<RecordingFileWriter::Segment> segments = m_writer.takeCompletedSegments();
+    for (const RecordingFileWriter::Segment& segment : segments) {
+        const qint64 rate = qMax(1, segment.sampleRate);
+        emit segmentCompleted(segment.index, segment.filePath, segment.startFrame * 1000 / rate,
+                              segment.frames * 1000 / rate);
+    }
 }
@@ -1,16 +1,35 @@
 #pragma once
 
+#include "../models/WaveformPeaks.h"
+#include "AudioLevelAnalyzer.h"
+#include "AudioRingBuffer.h"
+#include "CaptureDspStage.h"
+#include "RecordingFileWriter.h"
 #include <QIODevice>
 #include <QFile>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QTimer>
+#include <memory>
+
+class Telemetry;
 
 /**
  * @brief AudioLevelIODevice - Wraps a QFile to monitor audio levels during recording
  * 
  * This class acts as a proxy between QAudioSource and the output file, allowing us to
  * calculate real-time audio levels from the actual audio stream being recorded.
- * It forwards all write operations to the underlying file while computing RMS levels.
+ * Written audio goes to a RecordingFileWriter, which produces a WAV or FLAC file on
+ * its own thread, while RMS levels are computed alongside. Every chunk first passes
+ * the CaptureDspStage (noise suppression, AGC and input gain), so the files, meters
+ * and live transcription all see the processed signal.
+ *
+ * The audio thread only copies each chunk into a lock-free ring buffer. A timer on the
+ * device's own thread drains it every NOTIFY_INTERVAL_MS, computes the level and emits
+ * levelChanged/audioDataReady/pcmDataWritten, so the signals are rate-limited and
+ * the real-time path never locks or allocates. The same tick extends the recording's
+ * waveform peak pyramid and reports segments the writer has closed. Capture processing
+ * times travel to the tick through a ring buffer of their own and are recorded there.
  */
 class AudioLevelIODevice : public QIODevice {
     Q_OBJECT
@@ -30,35 +49,87 @@ public:
 
     // Audio level monitoring
     double getCurrentLevel() const;
+    AudioLevelStats getCurrentStats() const; // RMS, peak and clipping of the last tick
     QByteArray getLastAudioData() const;
-    void setAudioFormat(int sampleRate, int channelCount, int bytesPerSample);
+    WaveformPeaks getWaveformPeaks() const; // Complete once close() has returned
+    void setAudioFormat(int sampleRate, int channelCount, int bytesPerSample, bool isFloat = false);
+    
+    // Output file layout when it should differ from the capture (mono float only)
+    void setFileFormat(const AudioFileReader::Format& format);
+    
+    // Codec of the output file; set before open(). getFileCodec() reports what is written
+    void setFileCodec(AudioCodec codec);
+    AudioCodec getFileCodec() const;
+    
+    // Also write a 16 kHz mono float copy for transcription; set before open()
+    void setTranscriptionOutputPath(const QString& filePath);
+    QString getTranscriptionOutputPath() const;
+    
+    // Forward every written chunk through pcmDataWritten (used for live transcription)
+    void setPcmTapEnabled(bool enabled);
+    bool isPcmTapEnabled() const;
+    
+    // Write the recording as segment files of this length, joined on close(); set before open()
+    void setSegmentDuration(int milliseconds);
+    
+    // Capture processing; may be changed while recording
+    void setNoiseReduction(bool enabled);
+    void setAutoGainControl(bool enabled);
+    void setInputGain(double gain);
+    
+    // Capture processing and file write timings; set before open()
+    void setTelemetry(Telemetry* telemetry);
+    
+    // Bytes the consumer side could not keep up with since open()
+    quint64 getDroppedBytes() const;
 
 signals:
     void levelChanged(double level);
     void audioDataReady(const QByteArray& data);
+    void pcmDataWritten(const QByteArray& data);
+    // A finalized segment file; the last one is emitted by close() before the join removes it
+    void segmentCompleted(int index, const QString& filePath, qint64 startMs, qint64 durationMs);
 
 protected:
     // QIODevice interface - main data flow
     qint64 readData(char* data, qint64 maxlen) override;
     qint64 writeData(const char* data, qint64 len) override;
 
+private slots:
+    void drainRingBuffer();
+
 private:
+    void deliver(const char* data, qint64 len);
+    void emitCompletedSegments();
+
     QFile* m_outputFile;
-    mutable QMutex m_levelMutex;
+    CaptureDspStage m_dsp;      // Audio thread only, apart from its atomic settings
+    RecordingFileWriter m_writer;
+    QFile* m_transcriptionFile;
+    std::unique_ptr<RecordingFileWriter> m_transcriptionWriter;
+    mutable QMutex m_levelMutex; // Guards consumer-side state; never taken in writeData()
+    AudioRingBuffer m_ringBuffer;
+    QTimer* m_drainTimer;
+    QByteArray m_drainBuffer;
+    AudioRingBuffer m_dspTimings; // Nanoseconds per processed chunk, as qint64
+    Telemetry* m_telemetry;
     
     // Audio format parameters
     int m_sampleRate;
     int m_channelCount;
     int m_bytesPerSample;
+    bool m_isFloat;
     
     // Level monitoring
-    double m_currentLevel;
+    AudioLevelStats m_currentStats;
     QByteArray m_lastAudioData;
-    
-    // Level calculation
-    double calculateRMSLevel(const char* data, qint64 len) const;
-    void updateLevel(const char* data, qint64 len);
+    WaveformPeaks m_waveformPeaks;
+    bool m_pcmTapEnabled;
     
     // Constants
     static constexpr int MAX_AUDIO_DATA_SIZE = 4096;
+    static constexpr int NOTIFY_INTERVAL_MS = 30;          // Signal rate while recording
+    static constexpr int RING_BUFFER_MS = 2000;            // Audio the consumer may fall behind by
+    static constexpr qsizetype MIN_RING_BUFFER_BYTES = 64 * 1024;
+    static constexpr int DSP_TIMING_SLOTS = 256;           // Chunks timed between two ticks, at most
 };
@@ -1,5 +1,7 @@
 #include "AudioRecorderService.h"
 #include "AudioLevelIODevice.h"
+#include "AudioLevelAnalyzer.h"
+#include "RecordingFileWriter.h"
 #include "StorageManager.h"
 #include "../models/Recording.h"
 #include <QAudioSource>
@@ -24,7 +26,14 @@ AudioRecorderService::AudioRecorderService(QObject* parent)
     , m_autoGainControl(true)
     , m_noiseReduction(true)
     , m_inputGain(1.0)
+    , m_pcmStreamingEnabled(false)
+    , m_inMemoryCaptureEnabled(false)
+    , m_transcriptionStreamMode(TranscriptionStreamMode::Alongside)
+    , m_recordingCodec(AudioCodec::Flac)
+    , m_segmentDurationMs(0)
+    , m_captureOverflowed(false)
     , m_storageManager(nullptr)
+    , m_telemetry(nullptr)
 {
     // Setup monitoring timers
     m_levelTimer = new QTimer(this);
@@ -136,6 +145,12 @@ QAudioFormat AudioRecorderService::getRecommendedFormat() const {
     format.setSampleRate(16000);        // 16kHz for whisper.cpp
     format.setChannelCount(1);          // Mono
     format.setSampleFormat(QAudioFormat::Int16);  // 16-bit signed integer
+    
+    // Devices that cannot capture it natively record in their own format; the
+    // transcription stream is then converted while recording
+    if (!m_currentDevice.isNull() && !m_currentDevice.isFormatSupported(format)) {
+        return m_currentDevice.preferredFormat();
+    }
     return format;
 }
 
@@ -170,13 +185,13 @@ bool AudioRecorderService::startRecording(const QString& outputPath) {
     m_levelIODevice->setAudioFormat(
         m_audioFormat.sampleRate(),
         m_audioFormat.channelCount(),
-        m_audioFormat.sampleFormat() == QAudioFormat::Int16 ? 2 : 
-        m_audioFormat.sampleFormat() == QAudioFormat::Int32 ? 4 : 1
+        m_audioFormat.bytesPerSample(),
+        m_audioFormat.sampleFormat() == QAudioFormat::Float
     );
     
     // Connect level monitoring signals
     connect(m_levelIODevice, &AudioLevelIODevice::levelChanged, this, [this](double level) {
-        m_currentInputLevel = level * m_inputGain;
+        m_currentInputLevel = level; // Measured after gain and noise suppression
         emit inputLevelChanged(m_currentInputLevel);
     });
     
@@ -185,6 +200,43 @@ bool AudioRecorderService::startRecording(const QString& outputPath) {
         emit audioDataReady(data);
     });
     
+    // Reset in-memory capture for the new recording
+    m_capturedAudio = AudioSampleBuffer();
+    m_waveformPeaks.clear();
+    m_segments.clear();
+    m_captureOverflowed = false;
+    m_captureFormat.sampleRate = m_audioFormat.sampleRate();
+    m_captureFormat.channelCount = m_audioFormat.channelCount();
+    m_captureFormat.bytesPerSample = m_audioFormat.bytesPerSample();
+    m_captureFormat.isFloat = m_audioFormat.sampleFormat() == QAudioFormat::Float;
+    m_captureResampler.configure(m_captureFormat.sampleRate, AudioFileReader::TARGET_SAMPLE_RATE);
+    
+    // A 16 kHz mono capture is already what whisper reads cheaply
+    const bool captureIsWhisperReady = m_captureFormat.sampleRate == AudioFileReader::TARGET_SAMPLE_RATE &&
+                                       m_captureFormat.channelCount == 1;
+    m_transcriptionStreamPath = outputPath;
+    if (!captureIsWhisperReady && m_transcriptionStreamMode == TranscriptionStreamMode::Replace) {
+        m_levelIODevice->setFileFormat(AudioFileReader::whisperFormat());
+    } else if (!captureIsWhisperReady && m_transcriptionStreamMode == TranscriptionStreamMode::Alongside) {
+        const QFileInfo info(outputPath);
+        m_transcriptionStreamPath = info.dir().filePath(info.completeBaseName() + ".16k.wav");
+        m_levelIODevice->setTranscriptionOutputPath(m_transcriptionStreamPath);
+    }
+    m_levelIODevice->setFileCodec(m_recordingCodec);
+    m_levelIODevice->setNoiseReduction(m_noiseReduction);
+    m_levelIODevice->setAutoGainControl(m_autoGainControl);
+    m_levelIODevice->setInputGain(m_inputGain);
+    m_levelIODevice->setTelemetry(m_telemetry);
+    if (m_segmentDurationMs > 0) {
+        m_levelIODevice->setSegmentDuration(m_segmentDurationMs);
+        connect(m_levelIODevice, &AudioLevelIODevice::segmentCompleted, this, &AudioRecorderService::handleSegmentCompleted);
+    }
+    
+    if (m_pcmStreamingEnabled || m_inMemoryCaptureEnabled) {
+        m_levelIODevice->setPcmTapEnabled(true);
+        connect(m_levelIODevice, &AudioLevelIODevice::pcmDataWritten, this, &AudioRecorderService::handlePcmData);
+    }
+    
     if (!m_levelIODevice->open(QIODevice::WriteOnly)) {
         setError(AudioError::IoError, "Cannot create output file: " + outputPath);
         delete m_levelIODevice;
@@ -298,6 +350,7 @@ void AudioRecorderService::stopRecording() {
     if (m_levelIODevice) {
         m_recordedBytes = m_levelIODevice->size();
         m_levelIODevice->close();
+        m_waveformPeaks = m_levelIODevice->getWaveformPeaks();
         delete m_levelIODevice;
         m_levelIODevice = nullptr;
     }
@@ -353,9 +406,16 @@ void AudioRecorderService::cancelRecording() {
         }
     }
     
+    if (m_transcriptionStreamPath != filePath) {
+        QFile::remove(m_transcriptionStreamPath);
+    }
+    m_transcriptionStreamPath.clear();
+    
     m_recordingDuration = 0;
     m_recordedBytes = 0;
     m_currentOutputPath.clear();
+    m_capturedAudio = AudioSampleBuffer();
+    m_waveformPeaks.clear();
     
     setState(AudioRecordingState::Stopped);
     emit recordingCancelled();
@@ -391,19 +451,33 @@ QByteArray AudioRecorderService::getCurrentAudioData() const {
 }
 
 bool AudioRecorderService::isClipping() const {
+    // Sample peaks from the live stream are exact; the level is a fallback when idle
+    if (m_levelIODevice && m_state == AudioRecordingState::Recording) {
+        return m_levelIODevice->getCurrentStats().isClipping();
+    }
     return isClippingLevel(m_currentInputLevel);
 }
 
+// Applied to the samples by the capture stage; changes take effect mid-recording
 void AudioRecorderService::setAutoGainControl(bool enabled) {
     m_autoGainControl = enabled;
+    if (m_levelIODevice) {
+        m_levelIODevice->setAutoGainControl(enabled);
+    }
 }
 
 void AudioRecorderService::setNoiseReduction(bool enabled) {
     m_noiseReduction = enabled;
+    if (m_levelIODevice) {
+        m_levelIODevice->setNoiseReduction(enabled);
+    }
 }
 
 void AudioRecorderService::setInputGain(double gain) {
-    m_inputGain = qBound(0.0, gain, 2.0);
+    m_inputGain = qBound(0.0, gain, CaptureDspStage::MAX_INPUT_GAIN);
+    if (m_levelIODevice) {
+        m_levelIODevice->setInputGain(m_inputGain);
+    }
 }
 
 void AudioRecorderService::onDeviceChanged() {
@@ -483,7 +557,7 @@ void AudioRecorderService::handleInputLevelChanged() {
     if (m_state == AudioRecordingState::Recording && m_levelIODevice) {
         // Get current level from the real audio stream
         try {
-            m_currentInputLevel = m_levelIODevice->getCurrentLevel() * m_inputGain;
+            m_currentInputLevel = m_levelIODevice->getCurrentLevel();
             m_currentAudioData = m_levelIODevice->getLastAudioData();
             
             // Note: inputLevelChanged signal is now emitted directly from AudioLevelIODevice
@@ -514,11 +588,8 @@ void AudioRecorderService::initializeAudioInput() {
     
     m_audioSource = new QAudioSource(m_currentDevice, m_audioFormat, this);
     
-    // Apply settings
-    if (m_autoGainControl) {
-        // Qt doesn't have direct AGC control, but we can adjust buffer sizes
-        m_audioSource->setBufferSize(AUDIO_BUFFER_SIZE);
-    }
+    // Gain and noise suppression run in AudioLevelIODevice, on this source's data
+    m_audioSource->setBufferSize(AUDIO_BUFFER_SIZE);
     
     // Connect state change signals
     connect(m_audioSource, QOverload<QAudio::State>::of(&QAudioSource::stateChanged),
@@ -576,7 +647,7 @@ void AudioRecorderService::calculateInputLevel() {
     // This method is now deprecated - real level calculation is done in AudioLevelIODevice
     // Keep for compatibility but levels are calculated from actual audio stream
     if (m_levelIODevice && m_state == AudioRecordingState::Recording) {
-        m_currentInputLevel = m_levelIODevice->getCurrentLevel() * m_inputGain;
+        m_currentInputLevel = m_levelIODevice->getCurrentLevel();
         m_currentAudioData = m_levelIODevice->getLastAudioData();
     } else {
         m_currentInputLevel = 0.0;
@@ -585,26 +656,10 @@ void AudioRecorderService::calculateInputLevel() {
 }
 
 double AudioRecorderService::calculateRMSLevel(const QByteArray& buffer) const {
-    if (buffer.isEmpty()) {
-        return 0.0;
-    }
-    
-    const int16_t* samples = reinterpret_cast<const int16_t*>(buffer.data());
-    int sampleCount = buffer.size() / sizeof(int16_t);
-    
-    if (sampleCount == 0) {
-        return 0.0;
-    }
-    
-    // Calculate RMS level
-    double sum = 0.0;
-    for (int i = 0; i < sampleCount; ++i) {
-        double sample = static_cast<double>(samples[i]) / 32768.0; // Normalize to [-1, 1]
-        sum += sample * sample;
-    }
-    
-    double rms = qSqrt(sum / sampleCount);
-    return qBound(0.0, rms, 1.0);
+    AudioFileReader::Format format;
+    format.bytesPerSample = m_audioFormat.bytesPerSample();
+    format.isFloat = m_audioFormat.sampleFormat() == QAudioFormat::Float;
+    return AudioLevelAnalyzer::analyze(buffer.constData(), buffer.size(), format).rms;
 }
 
 bool AudioRecorderService::isClippingLevel(double level) const {
@@ -671,6 +726,10 @@ IStorageManager* AudioRecorderService::getStorageManager() const {
     return m_storageManager;
 }
 
+void AudioRecorderService::setTelemetry(Telemetry* telemetry) {
+    m_telemetry = telemetry;
+}
+
 void AudioRecorderService::setCurrentSessionId(const QString& sessionId) {
     m_currentSessionId = sessionId;
 }
@@ -683,6 +742,178 @@ QString AudioRecorderService::getCurrentRecordingId() const {
     return m_currentRecordingId;
 }
 
+void AudioRecorderService::handlePcmData(const QByteArray& pcmData) {
+    if (m_pcmStreamingEnabled) {
+        emit pcmDataCaptured(pcmData);
+    }
+    
+    if (!m_inMemoryCaptureEnabled || m_captureOverflowed) {
+        return;
+    }
+    
+    const QVector<float> samples = AudioFileReader::convertToFloat(pcmData.constData(), pcmData.size(), m_captureFormat);
+    
+    if (m_capturedAudio.samples.isEmpty()) {
+        // Reserve a few seconds up front to avoid regrowing on every chunk
+        m_capturedAudio.samples.reserve(AudioFileReader::TARGET_SAMPLE_RATE * 10);
+    }
+    m_captureResampler.process(samples.constData(), samples.size(), m_capturedAudio.samples);
+    
+    if (m_capturedAudio.durationMs() > MAX_IN_MEMORY_CAPTURE_MS) {
+        // Too long to keep in memory; consumers fall back to the recorded file
+        m_capturedAudio = AudioSampleBuffer();
+        m_captureOverflowed = true;
+    }
+}
+
+void AudioRecorderService::setInMemoryCaptureEnabled(bool enabled) {
+    m_inMemoryCaptureEnabled = enabled;
+}
+
+bool AudioRecorderService::isInMemoryCaptureEnabled() const {
+    return m_inMemoryCaptureEnabled;
+}
+
+AudioSampleBuffer AudioRecorderService::getCapturedAudio() const {
+    return m_capturedAudio;
+}
+
+AudioSampleBuffer AudioRecorderService::takeCapturedAudio() {
+    AudioSampleBuffer buffer = std::move(m_capturedAudio);
+    m_capturedAudio = AudioSampleBuffer();
+    return buffer;
+}
+
+void AudioRecorderService::setPcmStreamingEnabled(bool enabled) {
+    m_pcmStreamingEnabled = enabled;
+}
+
+bool AudioRecorderService::isPcmStreamingEnabled() const {
+    return m_pcmStreamingEnabled;
+}
+
+void AudioRecorderService::setTranscriptionStreamMode(TranscriptionStreamMode mode) {
+    m_transcriptionStreamMode = mode; // Takes effect on the next startRecording
+}
+
+AudioRecorderService::TranscriptionStreamMode AudioRecorderService::getTranscriptionStreamMode() const {
+    return m_transcriptionStreamMode;
+}
+
+QString AudioRecorderService::getTranscriptionStreamPath() const {
+    return m_transcriptionStreamPath;
+}
+
+WaveformPeaks AudioRecorderService::getWaveformPeaks() const {
+    return m_levelIODevice ? m_levelIODevice->getWaveformPeaks() : m_waveformPeaks;
+}
+
+void AudioRecorderService::setRecordingCodec(AudioCodec codec) {
+    m_recordingCodec = codec;
+}
+
+void AudioRecorderService::setSegmentDuration(int milliseconds) {
+    m_segmentDurationMs = qMax(0, milliseconds);
+}
+
+int AudioRecorderService::getSegmentDuration() const {
+    return m_segmentDurationMs;
+}
+
+QList<RecordingSegment> AudioRecorderService::getSegments() const {
+    return m_segments;
+}
+
+void AudioRecorderService::handleSegmentCompleted(int index, const QString& filePath, qint64 startMs, qint64 durationMs) {
+    RecordingSegment segment;
+    segment.index = index;
+    segment.filePath = filePath;
+    segment.startMs = startMs;
+    segment.durationMs = durationMs;
+    m_segments.append(segment);
+    
+    // The stored index is what a crash leaves behind to recover from
+    if (m_storageManager && !m_currentRecordingId.isEmpty() && m_storageManager->getRecordingStorage()) {
+        auto* recordingStorage = m_storageManager->getRecordingStorage();
+        Recording recording = recordingStorage->getRecording(m_currentRecordingId);
+        if (recording.isValid()) {
+            recording.setSegments(m_segments);
+            recording.setDuration(startMs + durationMs);
+            recordingStorage->updateRecording(recording);
+        }
+    }
+    
+    emit recordingSegmentCompleted(index, filePath, startMs, durationMs);
+}
+
+AudioCodec AudioRecorderService::getRecordingCodec() const {
+    return m_recordingCodec;
+}
+
+QString AudioRecorderService::getRecordingFileSuffix() const {
+    // Mirrors the choice RecordingFileWriter makes once the format is known
+    const bool captureIsWhisperReady = m_audioFormat.sampleRate() == AudioFileReader::TARGET_SAMPLE_RATE &&
+                                       m_audioFormat.channelCount() == 1;
+    const bool writesFloat = m_audioFormat.sampleFormat() == QAudioFormat::Float ||
+                             (!captureIsWhisperReady && m_transcriptionStreamMode == TranscriptionStreamMode::Replace);
+    return m_recordingCodec == AudioCodec::Flac && !writesFloat ? "flac" : "wav";
+}
+
+int AudioRecorderService::recoverInterruptedRecordings() {
+    if (!m_storageManager || !m_storageManager->getRecordingStorage()) {
+        return 0;
+    }
+    
+    auto* recordingStorage = m_storageManager->getRecordingStorage();
+    int recovered = 0;
+    
+    for (Recording recording : recordingStorage->getAllRecordings()) {
+        if (recording.getStatus() != RecordingStatus::Recording || recording.getId() == m_currentRecordingId) {
+            continue;
+        }
+        
+        AudioFileReader::Format format;
+        qint64 dataBytes = 0;
+        const QStringList segments = RecordingFileWriter::findSegments(recording.getFilePath());
+        const bool repaired = segments.isEmpty()
+            ? RecordingFileWriter::repairHeader(recording.getFilePath(), &format, &dataBytes)
+            : joinInterruptedSegments(recording.getFilePath(), segments, &format, &dataBytes);
+        if (repaired) {
+            const qint64 bytesPerSecond = static_cast<qint64>(format.sampleRate) * format.channelCount * format.bytesPerSample;
+            recording.setDuration(bytesPerSecond > 0 ? dataBytes * 1000 / bytesPerSecond : 0);
+            recording.setFileSize(QFileInfo(recording.getFilePath()).size());
+            recording.setStatus(RecordingStatus::Completed);
+            ++recovered;
+            qDebug() << "Recovered interrupted recording:" << recording.getFilePath();
+        } else {
+            recording.setStatus(RecordingStatus::Error);
+            qWarning() << "Cannot recover interrupted recording:" << recording.getFilePath();
+        }
+        recordingStorage->updateRecording(recording);
+    }
+    
+    return recovered;
+}
+
+bool AudioRecorderService::joinInterruptedSegments(const QString& filePath, QStringList segmentPaths,
+                                                   AudioFileReader::Format* format, qint64* dataBytes) {
+    // Only the last segment can still have been open
+    if (!RecordingFileWriter::repairHeader(segmentPaths.last())) {
+        qWarning() << "Dropping unreadable recording segment:" << segmentPaths.last();
+        segmentPaths.removeLast();
+        if (segmentPaths.isEmpty()) {
+            return false;
+        }
+    }
+    
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadWrite)) {
+        qWarning() << "Cannot open recording to join its segments:" << file.errorString();
+        return false;
+    }
+    return RecordingFileWriter::stitchSegments(file, segmentPaths, format, dataBytes);
+}
+
 void AudioRecorderService::saveRecordingToStorage() {
     if (!m_storageManager || m_currentSessionId.isEmpty()) {
         return;
@@ -694,6 +925,7 @@ void AudioRecorderService::saveRecordingToStorage() {
     recording.setStatus(RecordingStatus::Recording);
     recording.setDeviceName(m_currentDevice.description());
     recording.setSampleRate(m_audioFormat.sampleRate());
+    recording.setCodec(m_levelIODevice ? m_levelIODevice->getFileCodec() : AudioCodec::Pcm);
     recording.setLanguage("en"); // Default language
 
     auto* recordingStorage = m_storageManager->getRecordingStorage();
@@ -737,6 +969,8 @@ void AudioRecorderService::markRecordingComplete() {
     if (recording.isValid()) {
         recording.setDuration(m_recordingDuration);
         recording.setFileSize(m_recordedBytes);
+        recording.setWaveformPeaks(m_waveformPeaks);
+        recording.setSegments(m_segments);
         recording.setStatus(RecordingStatus::Completed);
         recordingStorage->updateRecording(recording);
         qDebug() << "Marked recording as complete:" << m_currentRecordingId;
@@ -1,8 +1,12 @@
 #pragma once
 
 #include "../models/BaseModel.h"
+#include "../models/Recording.h"
 #include "../../specs/001-voice-to-text/contracts/audio-recording-interface.h"
 #include "../../specs/001-voice-to-text/contracts/storage-interface.h"
+#include "../../specs/001-voice-to-text/contracts/transcription-service-interface.h"
+#include "AudioFileReader.h"
+#include "PolyphaseResampler.h"
 #include <QObject>
 #include <QString>
 #include <QAudioSource>
@@ -18,6 +22,7 @@
 
 class IStorageManager;
 class AudioLevelIODevice;
+class Telemetry;
 
 /**
  * @brief AudioRecorderService implementation
@@ -36,6 +41,9 @@ public:
     // Storage management
     void setStorageManager(IStorageManager* storageManager);
     IStorageManager* getStorageManager() const;
+    
+    // Capture and file write timings go to @p telemetry; takes effect on the next startRecording
+    void setTelemetry(Telemetry* telemetry);
 
     // Device Management
     QList<QAudioDevice> getAvailableDevices() const override;
@@ -76,6 +84,57 @@ public:
     void setCurrentSessionId(const QString& sessionId);
     QString getCurrentSessionId() const;
     QString getCurrentRecordingId() const;
+    
+    // Live PCM tap for streaming transcription (takes effect on the next startRecording)
+    void setPcmStreamingEnabled(bool enabled);
+    bool isPcmStreamingEnabled() const;
+    
+    // In-memory capture of short recordings as 16 kHz mono float for direct transcription.
+    // Recordings longer than MAX_IN_MEMORY_CAPTURE_MS fall back to the file on disk.
+    void setInMemoryCaptureEnabled(bool enabled);
+    bool isInMemoryCaptureEnabled() const;
+    AudioSampleBuffer getCapturedAudio() const;
+    AudioSampleBuffer takeCapturedAudio(); // Hands the buffer over without copying
+    
+    // Whisper-ready (16 kHz mono float) output converted while recording
+    enum class TranscriptionStreamMode {
+        Disabled,   // Only the archival file in the capture format
+        Alongside,  // Archival file plus a "<name>.16k.wav" copy
+        Replace     // The recording itself is written as 16 kHz mono float
+    };
+    void setTranscriptionStreamMode(TranscriptionStreamMode mode);
+    TranscriptionStreamMode getTranscriptionStreamMode() const;
+    // Best file to transcribe for the current or last recording
+    QString getTranscriptionStreamPath() const;
+    
+    // Codec of the archival file. FLAC applies to integer PCM captures; float captures
+    // and the whisper-ready stream stay WAV. Takes effect on the next startRecording
+    void setRecordingCodec(AudioCodec codec);
+    AudioCodec getRecordingCodec() const;
+    // File extension startRecording's output path should use ("flac" or "wav")
+    QString getRecordingFileSuffix() const;
+    
+    // Min/max peak pyramid of the current recording, or of the last one once stopped;
+    // it is also stored with the Recording
+    WaveformPeaks getWaveformPeaks() const;
+    
+    // Write the archival file as segments of this length (0 = one file), each handed out
+    // through recordingSegmentCompleted as it closes and joined when recording stops.
+    // Takes effect on the next startRecording
+    void setSegmentDuration(int milliseconds);
+    int getSegmentDuration() const;
+    static constexpr int DEFAULT_SEGMENT_DURATION_MS = 30000;
+    // Segments of the current recording, or of the last one once stopped
+    QList<RecordingSegment> getSegments() const;
+    
+    // Repairs the WAV/FLAC headers of recordings left in the Recording state by a crash and
+    // marks them completed, joining segmented ones first; returns how many were recovered
+    int recoverInterruptedRecordings();
+
+signals:
+    void pcmDataCaptured(const QByteArray& pcmData);
+    // The segment file stays readable until the recording is stopped
+    void recordingSegmentCompleted(int index, const QString& filePath, qint64 startMs, qint64 durationMs);
 
 public slots:
     void onDeviceChanged() override;
@@ -85,6 +144,8 @@ private slots:
     void handleStateChanged(QAudio::State state);
     void handleInputLevelChanged();
     void updateRecordingDuration();
+    void handlePcmData(const QByteArray& pcmData);
+    void handleSegmentCompleted(int index, const QString& filePath, qint64 startMs, qint64 durationMs);
 
 private:
     // Core recording components
@@ -113,6 +174,20 @@ private:
     bool m_autoGainControl;
     bool m_noiseReduction;
     double m_inputGain;
+    bool m_pcmStreamingEnabled;
+    bool m_inMemoryCaptureEnabled;
+    TranscriptionStreamMode m_transcriptionStreamMode;
+    QString m_transcriptionStreamPath;
+    AudioCodec m_recordingCodec;
+    WaveformPeaks m_waveformPeaks;  // Of the last stopped recording
+    int m_segmentDurationMs;
+    QList<RecordingSegment> m_segments;
+    
+    // In-memory capture
+    AudioSampleBuffer m_capturedAudio;
+    AudioFileReader::Format m_captureFormat;
+    PolyphaseResampler m_captureResampler; // Stateful, so chunk boundaries leave no seams
+    bool m_captureOverflowed;
     
     // Monitoring
     QTimer* m_levelTimer;
@@ -121,6 +196,7 @@ private:
     
     // Storage integration
     IStorageManager* m_storageManager;
+    Telemetry* m_telemetry;
     
     // Helper methods
     void initializeAudioInput();
@@ -134,6 +210,9 @@ private:
     void updateRecordingInStorage();
     void markRecordingComplete();
     
+    static bool joinInterruptedSegments(const QString& filePath, QStringList segmentPaths,
+                                        AudioFileReader::Format* format, qint64* dataBytes);
+    
     bool validateOutputPath(const QString& path);
     void calculateInputLevel();
     double calculateRMSLevel(const QByteArray& buffer) const;
@@ -154,4 +233,5 @@ private:
     static constexpr int LEVEL_UPDATE_INTERVAL_MS = 50;
     static constexpr int DURATION_UPDATE_INTERVAL_MS = 100;
     static constexpr int AUDIO_BUFFER_SIZE = 4096;
+    static constexpr int MAX_IN_MEMORY_CAPTURE_MS = 120000; // 2 minutes (~7.5MB of float samples)
 };
@@ -0,0 +1,77 @@
+#include "AudioRingBuffer.h"
+#include <cstring>
+
+AudioRingBuffer::AudioRingBuffer(qsizetype capacity)
+    : m_mask(0)
+    , m_writeIndex(0)
+    , m_readIndex(0)
+    , m_droppedBytes(0)
+{
+    if (capacity > 0) {
+        reset(capacity);
+    }
+}
+
+void AudioRingBuffer::reset(qsizetype capacity) {
+    qsizetype size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    m_buffer = QByteArray(size, Qt::Uninitialized);
+    m_mask = static_cast<quint64>(size - 1);
+    m_writeIndex.storeRelaxed(0);
+    m_readIndex.storeRelaxed(0);
+    m_droppedBytes.storeRelaxed(0);
+}
+
+qsizetype AudioRingBuffer::write(const char* data, qsizetype len) {
+    if (m_buffer.isEmpty() || len <= 0) {
+        return 0;
+    }
+
+    // Indices grow monotonically; only the masked value addresses the storage
+    const quint64 writeIndex = m_writeIndex.loadRelaxed();
+    const quint64 readIndex = m_readIndex.loadAcquire();
+    const quint64 space = static_cast<quint64>(m_buffer.size()) - (writeIndex - readIndex);
+    const quint64 count = qMin(space, static_cast<quint64>(len));
+    if (count < static_cast<quint64>(len)) {
+        m_droppedBytes.fetchAndAddRelaxed(static_cast<quint64>(len) - count);
+    }
+
+    char* storage = m_buffer.data();
+    const quint64 start = writeIndex & m_mask;
+    const quint64 firstPart = qMin(count, static_cast<quint64>(m_buffer.size()) - start);
+    std::memcpy(storage + start, data, firstPart);
+    std::memcpy(storage, data + firstPart, count - firstPart);
+
+    m_writeIndex.storeRelease(writeIndex + count);
+    return static_cast<qsizetype>(count);
+}
+
+qsizetype AudioRingBuffer::read(char* data, qsizetype maxLen) {
+    if (m_buffer.isEmpty() || maxLen <= 0) {
+        return 0;
+    }
+
+    const quint64 readIndex = m_readIndex.loadRelaxed();
+    const quint64 writeIndex = m_writeIndex.loadAcquire();
+    const quint64 count = qMin(writeIndex - readIndex, static_cast<quint64>(maxLen));
+
+    const char* storage = m_buffer.constData();
+    const quint64 start = readIndex & m_mask;
+    const quint64 firstPart = qMin(count, static_cast<quint64>(m_buffer.size()) - start);
+    std::memcpy(data, storage + start, firstPart);
+    std::memcpy(data + firstPart, storage, count - firstPart);
+
+    m_readIndex.storeRelease(readIndex + count);
+    return static_cast<qsizetype>(count);
+}
+
+qsizetype AudioRingBuffer::availableToWrite() const {
+    return m_buffer.size() - static_cast<qsizetype>(m_writeIndex.loadRelaxed() - m_readIndex.loadAcquire());
+}
+
+qsizetype AudioRingBuffer::availableToRead() const {
+    return static_cast<qsizetype>(m_writeIndex.loadAcquire() - m_readIndex.loadRelaxed());
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QtGlobal>
+
+/**
+ * @brief Fixed-capacity, lock-free single-producer/single-consumer byte ring
+ *
+ * The audio thread writes captured PCM without locking or allocating; one
+ * consumer thread drains it at its own pace. When the consumer falls behind,
+ * new data that does not fit is dropped and counted rather than blocking the
+ * producer. reset() must not race with either side.
+ */
+class AudioRingBuffer {
+public:
+    explicit AudioRingBuffer(qsizetype capacity = 0);
+
+    // Allocates the storage, rounded up to a power of two, and empties the ring
+    void reset(qsizetype capacity);
+
+    // Producer side; returns the number of bytes accepted
+    qsizetype write(const char* data, qsizetype len);
+    // At least this much fits; the consumer only ever makes more room
+    qsizetype availableToWrite() const;
+
+    // Consumer side
+    qsizetype read(char* data, qsizetype maxLen);
+    qsizetype availableToRead() const;
+
+    qsizetype capacity() const { return m_buffer.size(); }
+    quint64 droppedBytes() const { return m_droppedBytes.loadRelaxed(); }
+
+private:
+    QByteArray m_buffer;
+    quint64 m_mask;
+
+    // Each index is written by one side only; kept on separate cache lines
+    alignas(64) QAtomicInteger<quint64> m_writeIndex;
+    alignas(64) QAtomicInteger<quint64> m_readIndex;
+    QAtomicInteger<quint64> m_droppedBytes;
+};
@@ -0,0 +1,217 @@
+#include "CaptureDspStage.h"
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+inline float toUnit(quint8 sample) { return (static_cast<float>(sample) - 128.0f) * (1.0f / 128.0f); }
+inline float toUnit(qint16 sample) { return static_cast<float>(sample) * (1.0f / 32768.0f); }
+inline float toUnit(qint32 sample) { return static_cast<float>(sample) * (1.0f / 2147483648.0f); }
+inline float toUnit(float sample) { return sample; }
+
+// Gain can push samples past full scale; the integer formats saturate
+inline void fromUnit(float value, quint8& sample) {
+    sample = static_cast<quint8>(qBound(0, qRound(value * 127.0f) + 128, 255));
+}
+inline void fromUnit(float value, qint16& sample) {
+    sample = static_cast<qint16>(qBound(-32768, qRound(value * 32767.0f), 32767));
+}
+inline void fromUnit(float value, qint32& sample) {
+    const double scaled = qBound(-1.0, static_cast<double>(value), 1.0) * 2147483647.0;
+    sample = static_cast<qint32>(std::lrint(scaled));
+}
+inline void fromUnit(float value, float& sample) {
+    sample = qBound(-1.0f, value, 1.0f);
+}
+
+template <typename T>
+void deinterleave(const char* data, int frames, int channels, float* planar, int stride) {
+    for (int frame = 0; frame < frames; ++frame) {
+        for (int c = 0; c < channels; ++c) {
+            T sample;
+            std::memcpy(&sample, data, sizeof(T));
+            data += sizeof(T);
+            planar[c * stride + frame] = toUnit(sample);
+        }
+    }
+}
+
+template <typename T>
+void writeSamples(const float* interleaved, qint64 count, char* out) {
+    for (qint64 i = 0; i < count; ++i) {
+        T sample;
+        fromUnit(interleaved[i], sample);
+        std::memcpy(out, &sample, sizeof(T));
+        out += sizeof(T);
+    }
+}
+
+} // namespace
+
+CaptureDspStage::CaptureDspStage()
+    : m_frameBytes(0)
+    , m_active(false)
+    , m_noiseReduction(1)
+    , m_autoGainControl(1)
+    , m_inputGainMilli(1000)
+    , m_skipFrames(0)
+{
+}
+
+bool CaptureDspStage::configure(const AudioFileReader::Format& format) {
+    m_format = format;
+    m_frameBytes = format.bytesPerSample * format.channelCount;
+    const bool supportedSample = format.isFloat ? format.bytesPerSample == 4
+                                                : (format.bytesPerSample == 1 || format.bytesPerSample == 2 ||
+                                                   format.bytesPerSample == 4);
+    m_active = supportedSample && format.channelCount >= 1 && format.channelCount <= MAX_CHANNELS &&
+               format.sampleRate > 0;
+    if (!m_active) {
+        return false;
+    }
+
+    m_suppressors.resize(format.channelCount);
+    for (SpectralNoiseSuppressor& suppressor : m_suppressors) {
+        suppressor.configure(format.sampleRate);
+    }
+    m_agc.configure(format.sampleRate, format.channelCount);
+
+    m_planar.resize(format.channelCount * CHUNK_FRAMES);
+    m_interleaved.resize(format.channelCount * CHUNK_FRAMES);
+    m_partialFrame.reserve(m_frameBytes);
+    m_partialFrame.resize(0);
+    m_output.reserve(CHUNK_FRAMES * m_frameBytes);
+    m_output.resize(0);
+    m_skipFrames = latencyFrames();
+    return true;
+}
+
+void CaptureDspStage::setInputGain(double gain) {
+    m_inputGainMilli.storeRelaxed(qRound(qBound(0.0, gain, MAX_INPUT_GAIN) * 1000.0));
+}
+
+int CaptureDspStage::latencyFrames() const {
+    if (!m_active) {
+        return 0;
+    }
+    return m_suppressors.first().latency() + m_agc.latency();
+}
+
+const QByteArray& CaptureDspStage::process(const char* data, qint64 len) {
+    m_output.resize(0);
+    if (!m_active || !data || len <= 0) {
+        return m_output;
+    }
+
+    // Finish a frame split across chunks first
+    if (!m_partialFrame.isEmpty()) {
+        const qint64 needed = qMin<qint64>(m_frameBytes - m_partialFrame.size(), len);
+        m_partialFrame.append(data, static_cast<int>(needed));
+        data += needed;
+        len -= needed;
+        if (m_partialFrame.size() < m_frameBytes) {
+            return m_output;
+        }
+        processFrames(m_partialFrame.constData(), 1);
+        m_partialFrame.resize(0);
+    }
+
+    qint64 frames = len / m_frameBytes;
+    while (frames > 0) {
+        const int chunk = static_cast<int>(qMin<qint64>(frames, CHUNK_FRAMES));
+        processFrames(data, chunk);
+        data += static_cast<qint64>(chunk) * m_frameBytes;
+        len -= static_cast<qint64>(chunk) * m_frameBytes;
+        frames -= chunk;
+    }
+    if (len > 0) {
+        m_partialFrame.append(data, static_cast<int>(len));
+    }
+    return m_output;
+}
+
+const QByteArray& CaptureDspStage::flush() {
+    m_output.resize(0);
+    if (!m_active) {
+        return m_output;
+    }
+
+    m_partialFrame.resize(0);
+    int remaining = latencyFrames();
+    while (remaining > 0) {
+        const int chunk = qMin(remaining, CHUNK_FRAMES);
+        processFrames(nullptr, chunk);
+        remaining -= chunk;
+    }
+    return m_output;
+}
+
+void CaptureDspStage::processFrames(const char* data, int frames) {
+    const int channels = m_format.channelCount;
+    if (data) {
+        decode(data, frames);
+    } else {
+        std::fill(m_planar.begin(), m_planar.end(), 0.0f);
+    }
+
+    const bool noiseReduction = m_noiseReduction.loadRelaxed() != 0;
+    for (int c = 0; c < channels; ++c) {
+        m_suppressors[c].setEnabled(noiseReduction);
+        m_suppressors[c].process(m_planar.data() + c * CHUNK_FRAMES, frames);
+    }
+
+    float* interleaved = m_interleaved.data();
+    for (int frame = 0; frame < frames; ++frame) {
+        for (int c = 0; c < channels; ++c) {
+            interleaved[frame * channels + c] = m_planar[c * CHUNK_FRAMES + frame];
+        }
+    }
+
+    m_agc.setEnabled(m_autoGainControl.loadRelaxed() != 0);
+    m_agc.setManualGain(static_cast<float>(m_inputGainMilli.loadRelaxed()) / 1000.0f);
+    m_agc.process(interleaved, frames);
+
+    encode(frames);
+}
+
+void CaptureDspStage::decode(const char* data, int frames) {
+    const int channels = m_format.channelCount;
+    float* planar = m_planar.data();
+    if (m_format.isFloat) {
+        deinterleave<float>(data, frames, channels, planar, CHUNK_FRAMES);
+    } else if (m_format.bytesPerSample == 2) {
+        deinterleave<qint16>(data, frames, channels, planar, CHUNK_FRAMES);
+    } else if (m_format.bytesPerSample == 4) {
+        deinterleave<qint32>(data, frames, channels, planar, CHUNK_FRAMES);
+    } else {
+        deinterleave<quint8>(data, frames, channels, planar, CHUNK_FRAMES);
+    }
+}
+
+void CaptureDspStage::encode(int frames) {
+    // The first latencyFrames() of output predate the recording
+    const int skipped = static_cast<int>(qMin<qint64>(m_skipFrames, frames));
+    m_skipFrames -= skipped;
+    const int kept = frames - skipped;
+    if (kept <= 0) {
+        return;
+    }
+
+    const int channels = m_format.channelCount;
+    const qsizetype offset = m_output.size();
+    m_output.resize(offset + static_cast<qsizetype>(kept) * m_frameBytes);
+    const float* samples = m_interleaved.constData() + skipped * channels;
+    const qint64 count = static_cast<qint64>(kept) * channels;
+    char* out = m_output.data() + offset;
+    if (m_format.isFloat) {
+        writeSamples<float>(samples, count, out);
+    } else if (m_format.bytesPerSample == 2) {
+        writeSamples<qint16>(samples, count, out);
+    } else if (m_format.bytesPerSample == 4) {
+        writeSamples<qint32>(samples, count, out);
+    } else {
+        writeSamples<quint8>(samples, count, out);
+    }
+}
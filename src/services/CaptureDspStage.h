@@ -0,0 +1,69 @@
+#pragma once
+
+#include "AudioFileReader.h"
+#include "LookaheadAgc.h"
+#include "SpectralNoiseSuppressor.h"
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * @brief CaptureDspStage - Noise suppression and gain applied to captured audio
+ *
+ * Sits on the audio thread between QAudioSource and the recording writers: each
+ * chunk is converted to float, run through one SpectralNoiseSuppressor per channel
+ * and a linked LookaheadAgc, and converted back to the capture format. Work is done
+ * in CHUNK_FRAMES pieces on buffers sized by configure(), so the per-block cost is
+ * bounded and nothing is allocated once the output buffer has grown to the chunk
+ * size the device delivers.
+ *
+ * The settings can change from any thread while recording. They switch processing
+ * inside the stages rather than bypassing them, so the delay never changes: the
+ * first latencyFrames() of output are dropped and flush() returns the same amount
+ * at the end, leaving the output exactly as long as, and aligned with, the input.
+ */
+class CaptureDspStage {
+public:
+    CaptureDspStage();
+
+    // 8-bit unsigned, 16/32-bit signed or 32-bit float; anything else passes through
+    bool configure(const AudioFileReader::Format& format);
+    bool isActive() const { return m_active; }
+
+    void setNoiseReduction(bool enabled) { m_noiseReduction.storeRelaxed(enabled ? 1 : 0); }
+    void setAutoGainControl(bool enabled) { m_autoGainControl.storeRelaxed(enabled ? 1 : 0); }
+    void setInputGain(double gain); // Linear, 0 to MAX_INPUT_GAIN
+
+    // Processed bytes for @p len more capture bytes; valid until the next call
+    const QByteArray& process(const char* data, qint64 len);
+    // The audio still inside the stages, padded out with silence
+    const QByteArray& flush();
+
+    int latencyFrames() const;
+
+    static constexpr int CHUNK_FRAMES = 1024;
+    static constexpr int MAX_CHANNELS = 8;
+    static constexpr double MAX_INPUT_GAIN = 2.0;
+
+private:
+    void processFrames(const char* data, int frames);
+    void decode(const char* data, int frames);
+    void encode(int frames);
+
+    AudioFileReader::Format m_format;
+    int m_frameBytes;
+    bool m_active;
+
+    QAtomicInt m_noiseReduction;
+    QAtomicInt m_autoGainControl;
+    QAtomicInt m_inputGainMilli;    // Gain x 1000, so it can be stored atomically
+
+    QVector<SpectralNoiseSuppressor> m_suppressors;
+    LookaheadAgc m_agc;
+
+    QVector<float> m_planar;        // MAX_CHANNELS x CHUNK_FRAMES
+    QVector<float> m_interleaved;   // CHUNK_FRAMES x channels
+    QByteArray m_partialFrame;      // Capture bytes short of a whole frame
+    QByteArray m_output;
+    qint64 m_skipFrames;            // Leading output that is only latency
+};
@@ -8,19 +8,27 @@
 #include <QFileInfo>
 #include <QApplication>
 #include <QCoreApplication>
+#include <QTimer>
+#include <utility>
 
 // Default value constants
 const int ConfigurationManager::DEFAULT_INPUT_GAIN = 100;
 const int ConfigurationManager::DEFAULT_TRANSCRIPTION_PROVIDER = 1; // Base model
 const int ConfigurationManager::DEFAULT_ENHANCEMENT_MODE = 1; // Style improvement
 const QString ConfigurationManager::DEFAULT_LANGUAGE = "en";
-const QString ConfigurationManager::DEFAULT_AUDIO_FORMAT = "wav";
+const QString ConfigurationManager::DEFAULT_AUDIO_FORMAT = "flac";
 
 ConfigurationManager::ConfigurationManager(QObject* parent)
     : QObject(parent)
     , m_settings(nullptr)
     , m_autoSave(true)
+    , m_clearPending(false)
+    , m_flushTimer(new QTimer(this))
+    , m_notificationScheduled(false)
 {
+    m_flushTimer->setSingleShot(true);
+    connect(m_flushTimer, &QTimer::timeout, this, &ConfigurationManager::flush);
+    
     // Set application properties for QSettings
     QCoreApplication::setOrganizationName("QuillScribe");
     QCoreApplication::setOrganizationDomain("quillscribe.app");
@@ -45,43 +53,69 @@ ConfigurationManager::~ConfigurationManager() {
 }
 
 bool ConfigurationManager::contains(const QString& key) const {
-    return m_settings->contains(key);
+    return m_values.contains(key);
 }
 
 void ConfigurationManager::remove(const QString& key) {
-    m_settings->remove(key);
-    if (m_autoSave) {
-        m_settings->sync();
+    if (m_values.remove(key) > 0) {
+        markRemoved(key);
+        queueNotification(key);
     }
 }
 
 QStringList ConfigurationManager::keys() const {
-    return m_settings->allKeys();
+    QStringList allKeys = m_values.keys();
+    allKeys.sort();
+    return allKeys;
+}
+
+void ConfigurationManager::flush() {
+    m_flushTimer->stop();
+    if (!m_clearPending && m_dirtyKeys.isEmpty() && m_removedKeys.isEmpty()) {
+        return;
+    }
+    
+    if (m_clearPending) {
+        m_settings->clear();
+        m_clearPending = false;
+    }
+    for (const QString& key : std::as_const(m_removedKeys)) {
+        m_settings->remove(key);
+    }
+    for (const QString& key : std::as_const(m_dirtyKeys)) {
+        m_settings->setValue(key, m_values.value(key));
+    }
+    m_removedKeys.clear();
+    m_dirtyKeys.clear();
+    
+    // One sync for the whole batch
+    m_settings->sync();
+    emit configurationSaved();
 }
 
 // Category-specific getters
 QVariant ConfigurationManager::getApplicationSetting(const QString& key, const QVariant& defaultValue) const {
-    return m_settings->value("Application/" + key, defaultValue);
+    return cachedValue("Application/" + key, defaultValue);
 }
 
 QVariant ConfigurationManager::getAudioSetting(const QString& key, const QVariant& defaultValue) const {
-    return m_settings->value("Audio/" + key, defaultValue);
+    return cachedValue("Audio/" + key, defaultValue);
 }
 
 QVariant ConfigurationManager::getTranscriptionSetting(const QString& key, const QVariant& defaultValue) const {
-    return m_settings->value("Transcription/" + key, defaultValue);
+    return cachedValue("Transcription/" + key, defaultValue);
 }
 
 QVariant ConfigurationManager::getEnhancementSetting(const QString& key, const QVariant& defaultValue) const {
-    return m_settings->value("Enhancement/" + key, defaultValue);
+    return cachedValue("Enhancement/" + key, defaultValue);
 }
 
 QVariant ConfigurationManager::getStorageSetting(const QString& key, const QVariant& defaultValue) const {
-    return m_settings->value("Storage/" + key, defaultValue);
+    return cachedValue("Storage/" + key, defaultValue);
 }
 
 QVariant ConfigurationManager::getUISetting(const QString& key, const QVariant& defaultValue) const {
-    return m_settings->value("UI/" + key, defaultValue);
+    return cachedValue("UI/" + key, defaultValue);
 }
 
 // Category-specific setters
@@ -150,6 +184,14 @@ void ConfigurationManager::setInputGain(int gain) {
     setAudioSetting("InputGain", gain);
 }
 
+QVariantMap ConfigurationManager::getBackendCalibration(const QString& modelName) const {
+    return getTranscriptionSetting("Calibration/" + modelName).toMap();
+}
+
+void ConfigurationManager::setBackendCalibration(const QString& modelName, const QVariantMap& calibration) {
+    setTranscriptionSetting("Calibration/" + modelName, calibration);
+}
+
 // Window and UI state
 QByteArray ConfigurationManager::getWindowGeometry() const {
     return getUISetting("WindowGeometry", QByteArray()).toByteArray();
@@ -180,9 +222,9 @@ bool ConfigurationManager::exportSettings(const QString& filePath) const {
     QJsonObject settingsObj;
     
     // Export all settings by category
-    QStringList allKeys = m_settings->allKeys();
+    const QStringList allKeys = keys();
     for (const QString& key : allKeys) {
-        QVariant value = m_settings->value(key);
+        QVariant value = m_values.value(key);
         
         // Only export serializable values
         if (value.canConvert<QString>()) {
@@ -244,38 +286,43 @@ bool ConfigurationManager::importSettings(const QString& filePath) {
 
 // Reset to defaults
 void ConfigurationManager::resetCategory(SettingsCategory category) {
-    QString categoryStr = categoryToString(category);
+    const QString prefix = categoryToString(category) + "/";
     
     // Remove all keys in the category
-    m_settings->beginGroup(categoryStr);
-    m_settings->remove("");
-    m_settings->endGroup();
+    const QStringList allKeys = m_values.keys();
+    for (const QString& key : allKeys) {
+        if (key.startsWith(prefix)) {
+            m_values.remove(key);
+            markRemoved(key);
+            queueNotification(key);
+        }
+    }
     
     // Restore defaults for this category
     for (auto it = m_defaults.begin(); it != m_defaults.end(); ++it) {
-        if (it.key().startsWith(categoryStr + "/")) {
-            m_settings->setValue(it.key(), it.value());
+        if (it.key().startsWith(prefix)) {
+            m_values.insert(it.key(), it.value());
+            markDirty(it.key());
         }
     }
     
-    if (m_autoSave) {
-        m_settings->sync();
-    }
-    
     emit settingsReset(category);
-    emit categoryChanged(category);
 }
 
 void ConfigurationManager::resetAll() {
-    m_settings->clear();
+    const QStringList allKeys = m_values.keys();
+    for (const QString& key : allKeys) {
+        queueNotification(key);
+    }
+    m_values.clear();
+    m_dirtyKeys.clear();
+    m_removedKeys.clear();
+    m_clearPending = true;
     
     // Restore all defaults
     for (auto it = m_defaults.begin(); it != m_defaults.end(); ++it) {
-        m_settings->setValue(it.key(), it.value());
-    }
-    
-    if (m_autoSave) {
-        m_settings->sync();
+        m_values.insert(it.key(), it.value());
+        markDirty(it.key());
     }
     
     emit settingsReset(SettingsCategory::Application);
@@ -302,7 +349,8 @@ QString ConfigurationManager::getConfigFilePath() const {
     return m_settings->fileName();
 }
 
-bool ConfigurationManager::backupSettings(const QString& backupPath) const {
+bool ConfigurationManager::backupSettings(const QString& backupPath) {
+    flush();
     QString configPath = getConfigFilePath();
     return QFile::copy(configPath, backupPath);
 }
@@ -321,7 +369,11 @@ bool ConfigurationManager::restoreSettings(const QString& backupPath) {
     
     // Copy backup to config location
     if (QFile::copy(backupPath, configPath)) {
-        // Reload settings
+        // Reload settings; changes not yet flushed belonged to the replaced file
+        m_flushTimer->stop();
+        m_dirtyKeys.clear();
+        m_removedKeys.clear();
+        m_clearPending = false;
         delete m_settings;
         m_settings = new QSettings(this);
         loadSettings();
@@ -353,6 +405,7 @@ void ConfigurationManager::initializeDefaults() {
     m_defaults["Transcription/ModelPath"] = QString();
     m_defaults["Transcription/MaxConcurrent"] = 2;
     m_defaults["Transcription/Timeout"] = 30000;
+    m_defaults["Transcription/ModelMemoryBudgetMB"] = 2048;
     
     // Enhancement defaults
     m_defaults["Enhancement/Mode"] = DEFAULT_ENHANCEMENT_MODE;
@@ -385,23 +438,93 @@ void ConfigurationManager::initializeDefaults() {
 }
 
 void ConfigurationManager::loadSettings() {
-    // Set defaults for missing keys
-    for (auto it = m_defaults.begin(); it != m_defaults.end(); ++it) {
-        if (!m_settings->contains(it.key())) {
-            m_settings->setValue(it.key(), it.value());
-        }
+    // The only full read of the file; everything after is served from memory
+    m_values.clear();
+    const QStringList storedKeys = m_settings->allKeys();
+    for (const QString& key : storedKeys) {
+        m_values.insert(key, m_settings->value(key));
     }
     
-    if (m_autoSave) {
-        m_settings->sync();
+    // Set defaults for missing keys; written with the first flush rather than at startup
+    for (auto it = m_defaults.begin(); it != m_defaults.end(); ++it) {
+        if (!m_values.contains(it.key())) {
+            m_values.insert(it.key(), it.value());
+            markDirty(it.key());
+        }
     }
     
     emit configurationLoaded();
 }
 
 void ConfigurationManager::saveSettings() {
-    m_settings->sync();
-    emit configurationSaved();
+    flush();
+}
+
+QVariant ConfigurationManager::cachedValue(const QString& key, const QVariant& defaultValue) const {
+    auto it = m_values.constFind(key);
+    return it != m_values.constEnd() ? it.value() : defaultValue;
+}
+
+void ConfigurationManager::storeValue(const QString& key, const QVariant& value) {
+    auto it = m_values.find(key);
+    if ((it != m_values.end() && it.value() == value) || !validateSetting(key, value)) {
+        return;
+    }
+    
+    m_values.insert(key, value);
+    markDirty(key);
+    queueNotification(key);
+}
+
+void ConfigurationManager::markDirty(const QString& key) {
+    m_removedKeys.remove(key);
+    m_dirtyKeys.insert(key);
+    scheduleFlush();
+}
+
+void ConfigurationManager::markRemoved(const QString& key) {
+    m_dirtyKeys.remove(key);
+    m_removedKeys.insert(key);
+    scheduleFlush();
+}
+
+void ConfigurationManager::scheduleFlush() {
+    if (!m_autoSave) {
+        return; // Saved by saveSettings() only
+    }
+    
+    // Debounced, but a steady stream of changes (a slider drag) still gets written
+    if (!m_flushTimer->isActive()) {
+        m_firstUnsavedChange.start();
+    }
+    const qint64 remaining = MAX_FLUSH_DELAY_MS - m_firstUnsavedChange.elapsed();
+    m_flushTimer->start(static_cast<int>(qBound<qint64>(0, remaining, FLUSH_DELAY_MS)));
+}
+
+void ConfigurationManager::queueNotification(const QString& key) {
+    QStringList& keys = m_pendingNotifications[categoryOfKey(key)];
+    if (!keys.contains(key)) {
+        keys.append(key);
+    }
+    
+    if (!m_notificationScheduled) {
+        m_notificationScheduled = true;
+        QMetaObject::invokeMethod(this, &ConfigurationManager::deliverNotifications, Qt::QueuedConnection);
+    }
+}
+
+void ConfigurationManager::deliverNotifications() {
+    m_notificationScheduled = false;
+    const QMap<SettingsCategory, QStringList> pending = std::exchange(m_pendingNotifications, {});
+    for (auto it = pending.begin(); it != pending.end(); ++it) {
+        emit settingsChanged(it.key(), it.value());
+        emit categoryChanged(it.key());
+    }
+}
+
+ConfigurationManager::SettingsCategory ConfigurationManager::categoryOfKey(const QString& key) const {
+    auto it = m_keyCategories.constFind(key);
+    return it != m_keyCategories.constEnd() ? it.value() : categoryFromString(key.section('/', 0, 0));
 }
 
 QString ConfigurationManager::categoryToString(SettingsCategory category) const {
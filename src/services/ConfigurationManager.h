@@ -5,13 +5,25 @@
 #include <QString>
 #include <QVariant>
 #include <QMap>
+#include <QHash>
+#include <QSet>
 #include <QStringList>
+#include <QElapsedTimer>
+
+class QTimer;
 
 /**
  * @brief Centralized configuration and settings management
  * 
  * Manages application settings, user preferences, and configuration
  * with validation, defaults, and change notifications.
+ * 
+ * Every setting is held in memory, so reads never reach QSettings. Writes
+ * update the cache at once and are persisted in batches: FLUSH_DELAY_MS after
+ * the last change, at most MAX_FLUSH_DELAY_MS after the first unsaved one, on
+ * flush() and on destruction. Change notifications are collected the same way
+ * and delivered on the next event loop turn, once per category, with the keys
+ * that changed. Use from the GUI thread.
  */
 class ConfigurationManager : public QObject {
     Q_OBJECT
@@ -39,6 +51,9 @@ public:
     bool contains(const QString& key) const;
     void remove(const QString& key);
     QStringList keys() const;
+    
+    // Writes pending changes to disk now instead of on the timer
+    void flush();
 
     // Category-specific getters
     QVariant getApplicationSetting(const QString& key, const QVariant& defaultValue = QVariant()) const;
@@ -71,6 +86,10 @@ public:
     
     int getInputGain() const;
     void setInputGain(int gain);
+    
+    // Decode backend measured per whisper model (empty until the model is calibrated)
+    QVariantMap getBackendCalibration(const QString& modelName) const;
+    void setBackendCalibration(const QString& modelName, const QVariantMap& calibration);
 
     // Window and UI state
     QByteArray getWindowGeometry() const;
@@ -96,12 +115,13 @@ public:
 
     // Configuration file management
     QString getConfigFilePath() const;
-    bool backupSettings(const QString& backupPath) const;
+    bool backupSettings(const QString& backupPath); // Flushes first, so the copy is current
     bool restoreSettings(const QString& backupPath);
 
 signals:
-    void settingChanged(const QString& key, const QVariant& value);
-    void categoryChanged(SettingsCategory category);
+    // Batched: once per category per event loop turn; read current values with the getters
+    void settingsChanged(ConfigurationManager::SettingsCategory category, const QStringList& keys);
+    void categoryChanged(ConfigurationManager::SettingsCategory category);
     void settingsReset(SettingsCategory category);
     void configurationLoaded();
     void configurationSaved();
@@ -114,12 +134,36 @@ private:
     SettingsCategory categoryFromString(const QString& categoryStr) const;
     QVariant getDefaultValue(const QString& key) const;
     bool validateSetting(const QString& key, const QVariant& value) const;
+    
+    QVariant cachedValue(const QString& key, const QVariant& defaultValue) const;
+    void storeValue(const QString& key, const QVariant& value);
+    void markDirty(const QString& key);
+    void markRemoved(const QString& key);
+    void scheduleFlush();
+    void queueNotification(const QString& key);
+    void deliverNotifications();
+    SettingsCategory categoryOfKey(const QString& key) const;
 
     QSettings* m_settings;
     QMap<QString, QVariant> m_defaults;
     QMap<QString, SettingsCategory> m_keyCategories;
     bool m_autoSave;
     
+    // Write-back cache
+    QHash<QString, QVariant> m_values;  // Everything in m_settings, plus what is not flushed yet
+    QSet<QString> m_dirtyKeys;
+    QSet<QString> m_removedKeys;
+    bool m_clearPending;                // resetAll(): wipe the file before writing m_dirtyKeys
+    QTimer* m_flushTimer;
+    QElapsedTimer m_firstUnsavedChange;
+    
+    // Per-category keys waiting for the next notification
+    QMap<SettingsCategory, QStringList> m_pendingNotifications;
+    bool m_notificationScheduled;
+    
+    static constexpr int FLUSH_DELAY_MS = 1000;
+    static constexpr int MAX_FLUSH_DELAY_MS = 5000;
+    
     // Default values constants
     static const int DEFAULT_INPUT_GAIN;
     static const int DEFAULT_TRANSCRIPTION_PROVIDER;
@@ -131,26 +175,10 @@ private:
 // Template implementations
 template<typename T>
 T ConfigurationManager::getValue(const QString& key, const T& defaultValue) const {
-    return m_settings->value(key, QVariant::fromValue(defaultValue)).template value<T>();
+    return cachedValue(key, QVariant::fromValue(defaultValue)).template value<T>();
 }
 
 template<typename T>
 void ConfigurationManager::setValue(const QString& key, const T& value) {
-    QVariant oldValue = m_settings->value(key);
-    QVariant newValue = QVariant::fromValue(value);
-    
-    if (oldValue != newValue && validateSetting(key, newValue)) {
-        m_settings->setValue(key, newValue);
-        
-        if (m_autoSave) {
-            m_settings->sync();
-        }
-        
-        emit settingChanged(key, newValue);
-        
-        // Check if this affects a category
-        if (m_keyCategories.contains(key)) {
-            emit categoryChanged(m_keyCategories.value(key));
-        }
-    }
+    storeValue(key, QVariant::fromValue(value));
 }
@@ -0,0 +1,139 @@
+#include "ConnectionPool.h"
+#include "SqliteWriter.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlQuery>
+
+ConnectionPool::ThreadConnection::~ThreadConnection() {
+    // Runs on the owning thread as it exits
+    if (pool) {
+        QMutexLocker locker(&pool->m_mutex);
+        if (!pool->m_open.remove(this)) {
+            return; // Already closed by ConnectionPool::close()
+        }
+    }
+    closeConnection(this);
+}
+
+ConnectionPool::ConnectionPool()
+    : m_generation(0)
+    , m_nextId(0)
+{
+}
+
+ConnectionPool::~ConnectionPool() {
+    close();
+}
+
+void ConnectionPool::open(const QString& databasePath, const QString& connectionPrefix) {
+    close();
+    QMutexLocker locker(&m_mutex);
+    m_databasePath = databasePath;
+    m_prefix = connectionPrefix;
+}
+
+void ConnectionPool::close() {
+    QSet<ThreadConnection*> open;
+    {
+        QMutexLocker locker(&m_mutex);
+        open.swap(m_open);
+        ++m_generation; // Handles still held by threads reconnect on next use
+    }
+    for (ThreadConnection* connection : std::as_const(open)) {
+        closeConnection(connection);
+    }
+}
+
+QSqlDatabase ConnectionPool::database() {
+    ThreadConnection* connection = current();
+    return QSqlDatabase::database(connection->name, false);
+}
+
+StatementCache& ConnectionPool::statements() {
+    return current()->statements;
+}
+
+int ConnectionPool::connectionCount() const {
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_open.size());
+}
+
+StatementCache::Stats ConnectionPool::statementStats() const {
+    QMutexLocker locker(&m_mutex);
+    StatementCache::Stats total;
+    for (const ThreadConnection* connection : m_open) {
+        const StatementCache::Stats stats = connection->statements.stats();
+        total.hits += stats.hits;
+        total.misses += stats.misses;
+        total.evictions += stats.evictions;
+        total.size += stats.size;
+    }
+    return total;
+}
+
+ConnectionPool::ThreadConnection* ConnectionPool::current() {
+    if (!m_local.hasLocalData()) {
+        auto* connection = new ThreadConnection;
+        connection->pool = this;
+        m_local.setLocalData(connection);
+    }
+
+    ThreadConnection* connection = m_local.localData();
+    int generation = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        generation = m_generation;
+    }
+    if (connection->generation != generation) {
+        openConnection(connection);
+    }
+    return connection;
+}
+
+void ConnectionPool::openConnection(ThreadConnection* connection) {
+    QString databasePath;
+    {
+        QMutexLocker locker(&m_mutex);
+        databasePath = m_databasePath;
+        connection->name = QString("%1_read_%2").arg(m_prefix).arg(++m_nextId);
+        connection->generation = m_generation;
+    }
+
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", connection->name);
+        database.setDatabaseName(databasePath);
+        QString errorMessage;
+        if (!database.open()) {
+            errorMessage = database.lastError().text();
+        } else if (SqliteWriter::configureConnection(database, &errorMessage)) {
+            // Writes belong to the writer thread; a stray one here fails loudly
+            QSqlQuery query(database);
+            if (!query.exec("PRAGMA query_only = ON")) {
+                errorMessage = query.lastError().text();
+            }
+        }
+        if (!errorMessage.isEmpty()) {
+            qWarning() << "ConnectionPool: read connection" << connection->name << "failed:" << errorMessage;
+        }
+        connection->statements.setDatabase(database);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_open.insert(connection);
+}
+
+void ConnectionPool::closeConnection(ThreadConnection* connection) {
+    connection->statements.clear();
+    connection->statements.setDatabase(QSqlDatabase());
+    if (connection->name.isEmpty()) {
+        return;
+    }
+    {
+        QSqlDatabase database = QSqlDatabase::database(connection->name, false);
+        if (database.isOpen()) {
+            database.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connection->name);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "StatementCache.h"
+#include <QMutex>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QString>
+#include <QThreadStorage>
+
+/**
+ * @brief ConnectionPool - One read-only SQLite connection per thread
+ *
+ * A QSqlDatabase may only be used on the thread that opened it, so every thread
+ * that reads through the storages gets its own connection, opened on first use
+ * with the same WAL settings as the writer plus query_only. In WAL mode these
+ * readers run in parallel with each other and with the writer thread; writes
+ * never go through the pool.
+ *
+ * A thread's connection is closed when the thread exits. close() closes them all
+ * and must only be called while no other thread is inside a query; a thread that
+ * reads again after a reopen gets a fresh connection.
+ */
+class ConnectionPool {
+public:
+    ConnectionPool();
+    ~ConnectionPool();
+
+    void open(const QString& databasePath, const QString& connectionPrefix);
+    void close();
+
+    // The calling thread's connection and its statements; opened on first use
+    QSqlDatabase database();
+    StatementCache& statements();
+
+    int connectionCount() const;
+    StatementCache::Stats statementStats() const; // Summed over all connections
+
+private:
+    struct ThreadConnection {
+        ConnectionPool* pool = nullptr;
+        QString name;
+        StatementCache statements;
+        int generation = -1;
+
+        ~ThreadConnection();
+    };
+
+    ThreadConnection* current();
+    void openConnection(ThreadConnection* connection);
+    static void closeConnection(ThreadConnection* connection);
+
+    QThreadStorage<ThreadConnection*> m_local;
+    mutable QMutex m_mutex;
+    QSet<ThreadConnection*> m_open;
+    QString m_databasePath;
+    QString m_prefix;
+    int m_generation;
+    int m_nextId;
+};
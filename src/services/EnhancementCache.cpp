@@ -0,0 +1,375 @@
+#include "EnhancementCache.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+
+namespace {
+
+// Strings, the JSON blobs and the bookkeeping QCache keeps per entry
+constexpr qint64 ENTRY_OVERHEAD_BYTES = 256;
+
+} // namespace
+
+EnhancementCache::EnhancementCache()
+    : m_memory(DEFAULT_MAX_MEMORY_BYTES)
+    , m_nextUse(0)
+    , m_diskBytes(0)
+    , m_maxDiskBytes(DEFAULT_MAX_DISK_BYTES)
+    , m_expiryHours(DEFAULT_EXPIRY_HOURS)
+{
+}
+
+EnhancementCache::~EnhancementCache() {
+    closeDatabase();
+}
+
+QByteArray EnhancementCache::makeKey(const EnhancementRequest& request, const QString& context) {
+    // QDataStream writes every string and list with its length in front
+    QByteArray encoded;
+    QDataStream stream(&encoded, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << qint32(FORMAT_VERSION)
+           << request.text
+           << qint32(request.settings.mode)
+           << request.settings.customPrompt
+           << request.settings.preserveFormatting
+           << qint32(request.settings.maxOutputLength)
+           << request.settings.creativity
+           << request.settings.targetAudience
+           << request.settings.tone
+           << request.settings.preserveTerms
+           << qint32(request.preferredProvider)
+           << request.language
+           << context;
+
+    return QCryptographicHash::hash(encoded, QCryptographicHash::Blake2b_256);
+}
+
+bool EnhancementCache::lookup(const QByteArray& key, EnhancementResult& result) {
+    QMutexLocker locker(&m_mutex);
+
+    if (const Entry* entry = m_memory.object(key)) {
+        if (!isExpired(entry->storedAt)) {
+            result = entry->result;
+            ++m_stats.memoryHits;
+            return true;
+        }
+        m_memory.remove(key);
+    }
+
+    if (lookupDiskLocked(key, result)) {
+        ++m_stats.diskHits;
+        const qint64 cost = entryCost(result);
+        m_memory.insert(key, new Entry{result, QDateTime::currentDateTime()}, cost);
+        return true;
+    }
+
+    ++m_stats.misses;
+    return false;
+}
+
+void EnhancementCache::store(const QByteArray& key, const EnhancementResult& result) {
+    if (key.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    const QDateTime now = QDateTime::currentDateTime();
+    // QCache evicts least recently used entries until the new one fits, and drops
+    // one that is bigger than the whole budget
+    m_memory.insert(key, new Entry{result, now}, entryCost(result));
+    storeDiskLocked(key, resultToJson(result), now);
+}
+
+void EnhancementCache::clear() {
+    QMutexLocker locker(&m_mutex);
+    m_memory.clear();
+
+    if (!m_connectionName.isEmpty()) {
+        queueWrite({"DELETE FROM enhancement_cache", {}, {}});
+        m_diskIndex.clear();
+        m_diskOrder.clear();
+        m_diskBytes = 0;
+    }
+}
+
+bool EnhancementCache::openDatabase(const QString& databasePath) {
+    closeDatabase();
+    QDir().mkpath(QFileInfo(databasePath).absolutePath());
+
+    const QString connectionName = QString("enhancement_cache_%1").arg(reinterpret_cast<quintptr>(this));
+    QString errorMessage;
+    QHash<QByteArray, DiskEntry> index;
+    QMap<quint64, QByteArray> order;
+    qint64 diskBytes = 0;
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        database.setDatabaseName(databasePath);
+        if (!database.open()) {
+            errorMessage = database.lastError().text();
+        } else if (SqliteWriter::configureConnection(database, &errorMessage)) {
+            QSqlQuery query(database);
+            const QStringList schema = {
+                "CREATE TABLE IF NOT EXISTS enhancement_cache ("
+                "key BLOB PRIMARY KEY, result TEXT NOT NULL, size INTEGER NOT NULL, "
+                "stored_at INTEGER NOT NULL, last_used INTEGER NOT NULL) WITHOUT ROWID",
+                "CREATE INDEX IF NOT EXISTS idx_enhancement_cache_last_used ON enhancement_cache(last_used)",
+            };
+            for (const QString& sql : schema) {
+                if (errorMessage.isEmpty() && !query.exec(sql)) {
+                    errorMessage = query.lastError().text();
+                }
+            }
+
+            // Entries written by another format are unusable; expired ones just take space
+            if (errorMessage.isEmpty() && query.exec("PRAGMA user_version") && query.next() &&
+                query.value(0).toInt() != FORMAT_VERSION) {
+                query.exec("DELETE FROM enhancement_cache");
+                query.exec(QString("PRAGMA user_version = %1").arg(FORMAT_VERSION));
+            }
+            query.prepare("DELETE FROM enhancement_cache WHERE stored_at < ?");
+            query.addBindValue(QDateTime::currentDateTime().addSecs(-qint64(m_expiryHours) * 3600).toSecsSinceEpoch());
+            query.exec();
+
+            // The index replaces per-lookup and per-store queries from here on
+            query.setForwardOnly(true);
+            if (errorMessage.isEmpty() && !query.exec("SELECT key, size FROM enhancement_cache ORDER BY last_used")) {
+                errorMessage = query.lastError().text();
+            }
+            while (errorMessage.isEmpty() && query.next()) {
+                const quint64 use = static_cast<quint64>(order.size());
+                const DiskEntry entry{query.value(1).toLongLong(), use};
+                index.insert(query.value(0).toByteArray(), entry);
+                order.insert(use, query.value(0).toByteArray());
+                diskBytes += entry.size;
+            }
+            query.finish();
+
+            if (errorMessage.isEmpty() && !m_writer.start(databasePath, connectionName + "_writer")) {
+                errorMessage = m_writer.lastError();
+            }
+        }
+        if (!errorMessage.isEmpty()) {
+            database.close();
+        }
+    }
+
+    if (!errorMessage.isEmpty()) {
+        QSqlDatabase::removeDatabase(connectionName);
+        qWarning() << "Enhancement cache stays in memory only:" << errorMessage;
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_connectionName = connectionName;
+    m_diskIndex = std::move(index);
+    m_diskOrder = std::move(order);
+    m_nextUse = static_cast<quint64>(m_diskOrder.size());
+    m_diskBytes = diskBytes;
+    pruneDiskLocked();
+    return true;
+}
+
+void EnhancementCache::closeDatabase() {
+    QString connectionName;
+    {
+        QMutexLocker locker(&m_mutex);
+        connectionName.swap(m_connectionName);
+        m_diskIndex.clear();
+        m_diskOrder.clear();
+        m_diskBytes = 0;
+    }
+    if (connectionName.isEmpty()) {
+        return;
+    }
+    m_writer.stop();
+    {
+        QSqlDatabase database = QSqlDatabase::database(connectionName, false);
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+bool EnhancementCache::isPersistent() const {
+    QMutexLocker locker(&m_mutex);
+    return !m_connectionName.isEmpty();
+}
+
+void EnhancementCache::setMaxMemoryBytes(qint64 bytes) {
+    QMutexLocker locker(&m_mutex);
+    m_memory.setMaxCost(qMax<qint64>(0, bytes));
+}
+
+void EnhancementCache::setMaxDiskBytes(qint64 bytes) {
+    QMutexLocker locker(&m_mutex);
+    m_maxDiskBytes = qMax<qint64>(0, bytes);
+    pruneDiskLocked();
+}
+
+void EnhancementCache::setExpiryHours(int hours) {
+    QMutexLocker locker(&m_mutex);
+    m_expiryHours = qMax(1, hours);
+}
+
+qint64 EnhancementCache::sizeBytes() const {
+    QMutexLocker locker(&m_mutex);
+    return m_memory.totalCost() + m_diskBytes;
+}
+
+EnhancementCache::Stats EnhancementCache::stats() const {
+    QMutexLocker locker(&m_mutex);
+    Stats stats = m_stats;
+    stats.memoryEntries = static_cast<int>(m_memory.size());
+    stats.memoryBytes = m_memory.totalCost();
+    stats.diskBytes = m_diskBytes;
+    return stats;
+}
+
+QByteArray EnhancementCache::resultToJson(const EnhancementResult& result) {
+    QJsonObject json;
+    json["originalText"] = result.originalText;
+    json["enhancedText"] = result.enhancedText;
+    json["mode"] = static_cast<int>(result.mode);
+    json["provider"] = static_cast<int>(result.provider);
+    json["processingTime"] = result.processingTime;
+    json["improvementScore"] = result.improvementScore;
+    json["changes"] = result.changes;
+    json["metadata"] = result.metadata;
+    json["reasoning"] = result.reasoning;
+    return QJsonDocument(json).toJson(QJsonDocument::Compact);
+}
+
+EnhancementResult EnhancementCache::resultFromJson(const QByteArray& data) {
+    const QJsonObject json = QJsonDocument::fromJson(data).object();
+    EnhancementResult result;
+    result.originalText = json.value("originalText").toString();
+    result.enhancedText = json.value("enhancedText").toString();
+    result.mode = static_cast<EnhancementMode>(json.value("mode").toInt());
+    result.provider = static_cast<EnhancementProvider>(json.value("provider").toInt());
+    result.processingTime = json.value("processingTime").toVariant().toLongLong();
+    result.improvementScore = json.value("improvementScore").toDouble();
+    result.changes = json.value("changes").toObject();
+    result.metadata = json.value("metadata").toObject();
+    result.reasoning = json.value("reasoning").toString();
+    return result;
+}
+
+qint64 EnhancementCache::entryCost(const EnhancementResult& result) {
+    // QString stores UTF-16; the JSON objects are priced at their compact encoding
+    const qint64 textBytes = (result.id.size() + result.originalText.size() +
+                              result.enhancedText.size() + result.reasoning.size()) * qint64(sizeof(QChar));
+    const qint64 jsonBytes = QJsonDocument(result.changes).toJson(QJsonDocument::Compact).size() +
+                             QJsonDocument(result.metadata).toJson(QJsonDocument::Compact).size();
+    return textBytes + jsonBytes + ENTRY_OVERHEAD_BYTES;
+}
+
+bool EnhancementCache::isExpired(const QDateTime& storedAt) const {
+    return storedAt.addSecs(qint64(m_expiryHours) * 3600) < QDateTime::currentDateTime();
+}
+
+bool EnhancementCache::lookupDiskLocked(const QByteArray& key, EnhancementResult& result) {
+    // A key the index does not know is a miss without a query
+    const auto indexed = m_diskIndex.constFind(key);
+    if (m_connectionName.isEmpty() || indexed == m_diskIndex.constEnd()) {
+        return false;
+    }
+    const qint64 size = indexed->size;
+
+    QSqlDatabase database = QSqlDatabase::database(m_connectionName, false);
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    query.prepare("SELECT result, stored_at FROM enhancement_cache WHERE key = ?");
+    query.addBindValue(key);
+    if (!query.exec() || !query.next()) {
+        return false; // Its store is still queued to the writer
+    }
+    const QByteArray json = query.value(0).toByteArray();
+    const QDateTime storedAt = QDateTime::fromSecsSinceEpoch(query.value(1).toLongLong());
+    query.finish();
+
+    if (isExpired(storedAt)) {
+        forgetDiskLocked(key);
+        queueWrite({"DELETE FROM enhancement_cache WHERE key = ?", {key}, {}});
+        return false;
+    }
+
+    result = resultFromJson(json);
+    touchDiskLocked(key, size);
+    queueWrite({"UPDATE enhancement_cache SET last_used = ? WHERE key = ?",
+                {QDateTime::currentSecsSinceEpoch(), key}, {}});
+    return true;
+}
+
+void EnhancementCache::storeDiskLocked(const QByteArray& key, const QByteArray& json, const QDateTime& storedAt) {
+    if (m_connectionName.isEmpty()) {
+        return;
+    }
+
+    const qint64 size = key.size() + json.size();
+    queueWrite({"INSERT OR REPLACE INTO enhancement_cache (key, result, size, stored_at, last_used) "
+                "VALUES (?, ?, ?, ?, ?)",
+                {key, QString::fromUtf8(json), size, storedAt.toSecsSinceEpoch(), storedAt.toSecsSinceEpoch()}, {}});
+    // Replaces the size of the entry it overwrites, if any
+    touchDiskLocked(key, size);
+    pruneDiskLocked();
+}
+
+void EnhancementCache::pruneDiskLocked() {
+    if (m_connectionName.isEmpty() || m_diskBytes <= m_maxDiskBytes) {
+        return;
+    }
+
+    // Least recently used first, all in one batched write
+    SqliteWriter::Statement remove;
+    remove.sql = "DELETE FROM enhancement_cache WHERE key = ?";
+    while (m_diskBytes > m_maxDiskBytes && !m_diskOrder.isEmpty()) {
+        const QByteArray key = m_diskOrder.first();
+        forgetDiskLocked(key);
+        remove.rows.append(QVariantList{key});
+        ++m_stats.evictions;
+    }
+    if (!remove.rows.isEmpty()) {
+        queueWrite(remove);
+    }
+}
+
+void EnhancementCache::touchDiskLocked(const QByteArray& key, qint64 size) {
+    auto it = m_diskIndex.find(key);
+    if (it != m_diskIndex.end()) {
+        m_diskBytes -= it->size;
+        m_diskOrder.remove(it->lastUse);
+    } else {
+        it = m_diskIndex.insert(key, DiskEntry());
+    }
+    it->size = size;
+    it->lastUse = m_nextUse++;
+    m_diskOrder.insert(it->lastUse, key);
+    m_diskBytes += size;
+}
+
+void EnhancementCache::forgetDiskLocked(const QByteArray& key) {
+    const auto it = m_diskIndex.constFind(key);
+    if (it == m_diskIndex.constEnd()) {
+        return;
+    }
+    m_diskBytes -= it->size;
+    m_diskOrder.remove(it->lastUse);
+    m_diskIndex.erase(it);
+}
+
+void EnhancementCache::queueWrite(const SqliteWriter::Statement& statement) {
+    // A failed write leaves the index ahead of the table; the next openDatabase() rereads it
+    m_writer.enqueue(statement, nullptr, [](bool ok, const QString& errorMessage) {
+        if (!ok) {
+            qWarning() << "Cannot write enhancement cache:" << errorMessage;
+        }
+    });
+}
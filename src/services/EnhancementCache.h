@@ -0,0 +1,105 @@
+#pragma once
+
+#include "SqliteWriter.h"
+#include "../../specs/001-voice-to-text/contracts/ai-enhancement-interface.h"
+#include <QByteArray>
+#include <QCache>
+#include <QDateTime>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+
+/**
+ * @brief Two-tier cache of enhancement results
+ *
+ * The memory tier is an LRU bounded by the bytes its results take: lookups and
+ * evictions are O(1), and the size is tracked as entries come and go instead of
+ * being recomputed. The optional disk tier is a small SQLite database of its own,
+ * so repeat enhancements survive a restart; it is pruned least recently used first
+ * once it grows past its own budget, and a hit there is promoted to memory.
+ *
+ * The disk tier's keys, sizes and use order are indexed in memory, so a miss and
+ * the pruning decisions cost no query. Its writes (stores, hit-time touches,
+ * pruning) go to a SqliteWriter of its own; only a disk hit reads the row, by key,
+ * on the caller's thread.
+ *
+ * Keys are a BLAKE2b digest of every field that shapes the output, each written
+ * with its length, so no two requests encode the same. Entries older than the
+ * expiry are misses. The read connection belongs to the thread that called
+ * openDatabase(); closeDatabase() commits the writes still queued.
+ */
+class EnhancementCache {
+public:
+    struct Stats {
+        quint64 memoryHits = 0;
+        quint64 diskHits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0; // Disk rows pruned; memory evictions are not counted
+        int memoryEntries = 0;
+        qint64 memoryBytes = 0;
+        qint64 diskBytes = 0;
+    };
+
+    EnhancementCache();
+    ~EnhancementCache();
+
+    // @p context is the preceding text a chunk of a longer document is rewritten against
+    static QByteArray makeKey(const EnhancementRequest& request, const QString& context = QString());
+
+    bool lookup(const QByteArray& key, EnhancementResult& result);
+    void store(const QByteArray& key, const EnhancementResult& result);
+    void clear();
+
+    // Opens (creating if needed) the disk tier; closeDatabase() drops back to memory only
+    bool openDatabase(const QString& databasePath);
+    void closeDatabase();
+    bool isPersistent() const;
+
+    void setMaxMemoryBytes(qint64 bytes);
+    void setMaxDiskBytes(qint64 bytes);
+    void setExpiryHours(int hours);
+
+    qint64 sizeBytes() const; // Both tiers
+    Stats stats() const;
+
+    static QByteArray resultToJson(const EnhancementResult& result);
+    static EnhancementResult resultFromJson(const QByteArray& json);
+
+    static constexpr int FORMAT_VERSION = 2; // Bump when the key fields or stored result change
+    static constexpr qint64 DEFAULT_MAX_MEMORY_BYTES = 50LL * 1024 * 1024;
+    static constexpr qint64 DEFAULT_MAX_DISK_BYTES = 200LL * 1024 * 1024;
+    static constexpr int DEFAULT_EXPIRY_HOURS = 24;
+
+private:
+    struct Entry {
+        EnhancementResult result;
+        QDateTime storedAt;
+    };
+
+    struct DiskEntry {
+        qint64 size = 0;
+        quint64 lastUse = 0;    // Key in m_diskOrder
+    };
+
+    static qint64 entryCost(const EnhancementResult& result);
+    bool isExpired(const QDateTime& storedAt) const;
+    bool lookupDiskLocked(const QByteArray& key, EnhancementResult& result);
+    void storeDiskLocked(const QByteArray& key, const QByteArray& json, const QDateTime& storedAt);
+    void pruneDiskLocked();
+    void touchDiskLocked(const QByteArray& key, qint64 size);   // Adds or moves to most recent
+    void forgetDiskLocked(const QByteArray& key);
+    void queueWrite(const SqliteWriter::Statement& statement);
+
+    mutable QMutex m_mutex;
+    QCache<QByteArray, Entry> m_memory;
+    QString m_connectionName;   // Empty while there is no disk tier
+    SqliteWriter m_writer;
+    QHash<QByteArray, DiskEntry> m_diskIndex;
+    QMap<quint64, QByteArray> m_diskOrder;  // Least recently used first
+    quint64 m_nextUse;
+    qint64 m_diskBytes;
+    qint64 m_maxDiskBytes;
+    int m_expiryHours;
+    Stats m_stats;
+};
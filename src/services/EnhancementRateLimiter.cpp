@@ -0,0 +1,146 @@
+#include "EnhancementRateLimiter.h"
+#include <QMutexLocker>
+#include <QRandomGenerator>
+#include <QtMath>
+
+namespace {
+
+constexpr double MS_PER_MINUTE = 60000.0;
+
+} // namespace
+
+EnhancementRateLimiter::EnhancementRateLimiter()
+    : m_lastRefillMs(0)
+    , m_requestCapacity(DEFAULT_REQUESTS_PER_MINUTE)
+    , m_tokenCapacity(DEFAULT_TOKENS_PER_MINUTE)
+    , m_availableRequests(DEFAULT_REQUESTS_PER_MINUTE)
+    , m_availableTokens(DEFAULT_TOKENS_PER_MINUTE)
+    , m_limit(1.0)
+    , m_maxLimit(1)
+    , m_lastDecreaseMs(-DECREASE_COOLDOWN_MS)
+    , m_pausedUntilMs(0)
+    , m_throttled(0)
+{
+    m_clock.start();
+}
+
+void EnhancementRateLimiter::setQuota(int requestsPerMinute, int tokensPerMinute) {
+    QMutexLocker locker(&m_mutex);
+    refillLocked();
+    m_requestCapacity = qMax(1, requestsPerMinute);
+    m_tokenCapacity = qMax(1, tokensPerMinute);
+    m_availableRequests = qMin(m_availableRequests, m_requestCapacity);
+    m_availableTokens = qMin(m_availableTokens, m_tokenCapacity);
+}
+
+void EnhancementRateLimiter::setConcurrencyBounds(int initial, int maximum) {
+    QMutexLocker locker(&m_mutex);
+    m_maxLimit = qMax(1, maximum);
+    m_limit = qBound(1.0, static_cast<double>(initial), static_cast<double>(m_maxLimit));
+}
+
+bool EnhancementRateLimiter::tryAcquire(qint64 tokens, qint64* waitMs) {
+    QMutexLocker locker(&m_mutex);
+    refillLocked();
+
+    const qint64 nowMs = m_clock.elapsed();
+    if (nowMs < m_pausedUntilMs) {
+        *waitMs = m_pausedUntilMs - nowMs;
+        return false;
+    }
+
+    // A request larger than a minute's quota waits for a full bucket rather than forever
+    const double needed = qMin(static_cast<double>(qMax<qint64>(0, tokens)), m_tokenCapacity);
+    if (m_availableRequests >= 1.0 && m_availableTokens >= needed) {
+        m_availableRequests -= 1.0;
+        m_availableTokens -= needed;
+        *waitMs = 0;
+        return true;
+    }
+
+    const double requestWait = (1.0 - m_availableRequests) * MS_PER_MINUTE / m_requestCapacity;
+    const double tokenWait = (needed - m_availableTokens) * MS_PER_MINUTE / m_tokenCapacity;
+    *waitMs = qMax<qint64>(1, qCeil(qMax(requestWait, tokenWait)));
+    return false;
+}
+
+void EnhancementRateLimiter::recordUsage(qint64 estimatedTokens, qint64 actualTokens) {
+    QMutexLocker locker(&m_mutex);
+    refillLocked();
+
+    // Refunds an overestimate, charges an underestimate; the bucket may go negative
+    m_availableTokens = qMin(m_tokenCapacity, m_availableTokens + estimatedTokens - actualTokens);
+
+    const qint64 nowMs = m_clock.elapsed();
+    m_completions.enqueue({nowMs, actualTokens});
+    expireCompletionsLocked(nowMs);
+}
+
+int EnhancementRateLimiter::concurrencyLimit() const {
+    QMutexLocker locker(&m_mutex);
+    return qMax(1, static_cast<int>(m_limit));
+}
+
+void EnhancementRateLimiter::onSuccess() {
+    QMutexLocker locker(&m_mutex);
+    m_limit = qMin(static_cast<double>(m_maxLimit), m_limit + 1.0 / m_limit);
+}
+
+void EnhancementRateLimiter::onThrottled(qint64 retryAfterMs) {
+    QMutexLocker locker(&m_mutex);
+    ++m_throttled;
+
+    const qint64 nowMs = m_clock.elapsed();
+    if (nowMs - m_lastDecreaseMs >= DECREASE_COOLDOWN_MS) {
+        m_limit = qMax(1.0, m_limit / 2.0);
+        m_lastDecreaseMs = nowMs;
+    }
+    if (retryAfterMs > 0) {
+        m_pausedUntilMs = qMax(m_pausedUntilMs, nowMs + retryAfterMs);
+    }
+}
+
+qint64 EnhancementRateLimiter::retryDelayMs(int attempt, qint64 retryAfterMs) const {
+    // The server's delay, plus a little so queued retries do not return at the same instant
+    if (retryAfterMs > 0) {
+        return retryAfterMs + QRandomGenerator::global()->bounded(RETRY_AFTER_JITTER_MS);
+    }
+
+    // Equal jitter: at least half the exponential delay, never all clients in lockstep
+    const qint64 ceiling = qMin(MAX_BACKOFF_MS, BASE_BACKOFF_MS << qBound(0, attempt, 16));
+    return ceiling / 2 + QRandomGenerator::global()->bounded(ceiling / 2 + 1);
+}
+
+EnhancementRateLimiter::Metrics EnhancementRateLimiter::metrics() const {
+    QMutexLocker locker(&m_mutex);
+    const qint64 nowMs = m_clock.elapsed();
+    expireCompletionsLocked(nowMs);
+
+    // What the buckets hold now, without refilling them from a const method
+    const double elapsed = static_cast<double>(nowMs - m_lastRefillMs);
+    Metrics metrics;
+    metrics.concurrencyLimit = m_limit;
+    metrics.availableRequests = qMin(m_requestCapacity, m_availableRequests + elapsed * m_requestCapacity / MS_PER_MINUTE);
+    metrics.availableTokens = qMin(m_tokenCapacity, m_availableTokens + elapsed * m_tokenCapacity / MS_PER_MINUTE);
+    metrics.requestsLastMinute = static_cast<int>(m_completions.size());
+    for (const Completion& completion : std::as_const(m_completions)) {
+        metrics.tokensLastMinute += completion.tokens;
+    }
+    metrics.throttledResponses = m_throttled;
+    metrics.pausedForMs = qMax<qint64>(0, m_pausedUntilMs - nowMs);
+    return metrics;
+}
+
+void EnhancementRateLimiter::refillLocked() {
+    const qint64 nowMs = m_clock.elapsed();
+    const double elapsed = static_cast<double>(nowMs - m_lastRefillMs);
+    m_lastRefillMs = nowMs;
+    m_availableRequests = qMin(m_requestCapacity, m_availableRequests + elapsed * m_requestCapacity / MS_PER_MINUTE);
+    m_availableTokens = qMin(m_tokenCapacity, m_availableTokens + elapsed * m_tokenCapacity / MS_PER_MINUTE);
+}
+
+void EnhancementRateLimiter::expireCompletionsLocked(qint64 nowMs) const {
+    while (!m_completions.isEmpty() && nowMs - m_completions.head().atMs > static_cast<qint64>(MS_PER_MINUTE)) {
+        m_completions.dequeue();
+    }
+}
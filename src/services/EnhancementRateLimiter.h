@@ -0,0 +1,92 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QQueue>
+#include <QtGlobal>
+
+/**
+ * @brief Client-side quota and concurrency control for enhancement requests
+ *
+ * Two token buckets mirror the provider's per-minute quotas, one for requests
+ * (RPM) and one for tokens (TPM). Each holds at most one minute's worth and
+ * refills continuously. tryAcquire() says how long to wait when either bucket is
+ * short. When a reply reports its real token count, recordUsage() settles the
+ * difference from the estimate.
+ *
+ * Concurrency follows AIMD. Every success raises the limit by 1/limit, so about
+ * one more slot per window of successes. A 429 or 503 halves it, at most once per
+ * cooldown, so one burst of rejections counts once. A throttle carrying a
+ * Retry-After also pauses all dispatch for that long. retryDelayMs() gives jittered
+ * exponential backoff that honours such a delay.
+ *
+ * Safe to use from any thread.
+ */
+class EnhancementRateLimiter {
+public:
+    struct Metrics {
+        double concurrencyLimit = 0.0;
+        double availableRequests = 0.0;
+        double availableTokens = 0.0;
+        int requestsLastMinute = 0;    // Completed, whatever the outcome
+        qint64 tokensLastMinute = 0;
+        quint64 throttledResponses = 0;
+        qint64 pausedForMs = 0;        // Remaining Retry-After pause
+        // Filled in by the service, which owns the queue
+        int queued = 0;
+        int inFlight = 0;
+    };
+
+    EnhancementRateLimiter();
+
+    void setQuota(int requestsPerMinute, int tokensPerMinute);
+    void setConcurrencyBounds(int initial, int maximum);
+
+    // Takes one request and @p tokens if both are available; otherwise returns false
+    // and the milliseconds until they will be
+    bool tryAcquire(qint64 tokens, qint64* waitMs);
+    // Once per finished request; @p actualTokens is 0 when the reply carried no usage
+    void recordUsage(qint64 estimatedTokens, qint64 actualTokens);
+
+    int concurrencyLimit() const;
+    void onSuccess();
+    // 429 or 503; @p retryAfterMs is the server's requested delay, if it sent one
+    void onThrottled(qint64 retryAfterMs);
+
+    qint64 retryDelayMs(int attempt, qint64 retryAfterMs) const;
+
+    Metrics metrics() const;
+
+    static constexpr int DEFAULT_REQUESTS_PER_MINUTE = 60;
+    static constexpr int DEFAULT_TOKENS_PER_MINUTE = 1000000;
+    static constexpr qint64 DECREASE_COOLDOWN_MS = 2000;
+    static constexpr qint64 BASE_BACKOFF_MS = 1000;
+    static constexpr qint64 MAX_BACKOFF_MS = 60000;
+    static constexpr qint64 RETRY_AFTER_JITTER_MS = 500;
+
+private:
+    struct Completion {
+        qint64 atMs;
+        qint64 tokens;
+    };
+
+    void refillLocked();
+    void expireCompletionsLocked(qint64 nowMs) const;
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    qint64 m_lastRefillMs;
+
+    double m_requestCapacity;
+    double m_tokenCapacity;
+    double m_availableRequests;
+    double m_availableTokens;
+
+    double m_limit;
+    int m_maxLimit;
+    qint64 m_lastDecreaseMs;
+    qint64 m_pausedUntilMs;
+    quint64 m_throttled;
+
+    mutable QQueue<Completion> m_completions; // Last minute, for throughput
+};
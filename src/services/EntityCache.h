@@ -0,0 +1,87 @@
+#pragma once
+
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QString>
+#include <optional>
+
+struct EntityCacheStats {
+    quint64 hits = 0;
+    quint64 misses = 0;
+    quint64 invalidations = 0;
+    int size = 0;
+
+    double hitRate() const {
+        const quint64 lookups = hits + misses;
+        return lookups > 0 ? static_cast<double>(hits) / lookups : 0.0;
+    }
+};
+
+/**
+ * @brief EntityCache - Bounded LRU identity map of recently read entities
+ *
+ * Keeps the models the UI asks for over and over (the selected recording, its
+ * transcription) so repeated lookups skip SQLite and the model rebuild. Entries
+ * are dropped by the storage whenever it writes the row and again when the write's
+ * signal arrives; anything else goes once the cache is over capacity, least
+ * recently used first. Safe to use from any thread.
+ *
+ * A miss hands out a generation token to pass to insert(): if an invalidation
+ * happened while the row was being read the value may be stale, and it is not kept.
+ */
+template <typename T>
+class EntityCache {
+public:
+    explicit EntityCache(int capacity = DEFAULT_CAPACITY)
+        : m_entries(capacity)
+    {
+    }
+
+    std::optional<T> find(const QString& key, quint64* generation) {
+        QMutexLocker locker(&m_mutex);
+        if (const T* value = m_entries.object(key)) {
+            ++m_stats.hits;
+            return *value;
+        }
+        ++m_stats.misses;
+        *generation = m_generation;
+        return std::nullopt;
+    }
+
+    void insert(const QString& key, const T& value, quint64 generation) {
+        QMutexLocker locker(&m_mutex);
+        if (generation == m_generation) {
+            m_entries.insert(key, new T(value));
+        }
+    }
+
+    void remove(const QString& key) {
+        QMutexLocker locker(&m_mutex);
+        ++m_generation;
+        ++m_stats.invalidations;
+        m_entries.remove(key);
+    }
+
+    void clear() {
+        QMutexLocker locker(&m_mutex);
+        ++m_generation;
+        ++m_stats.invalidations;
+        m_entries.clear();
+    }
+
+    EntityCacheStats stats() const {
+        QMutexLocker locker(&m_mutex);
+        EntityCacheStats stats = m_stats;
+        stats.size = static_cast<int>(m_entries.size());
+        return stats;
+    }
+
+    static constexpr int DEFAULT_CAPACITY = 256;
+
+private:
+    mutable QMutex m_mutex;
+    QCache<QString, T> m_entries;
+    quint64 m_generation = 0;
+    EntityCacheStats m_stats;
+};
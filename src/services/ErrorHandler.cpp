@@ -1,12 +1,11 @@
 #include "ErrorHandler.h"
 #include <QDebug>
 #include <QDateTime>
-#include <QStandardPaths>
-#include <QDir>
-#include <QFile>
-#include <QTextStream>
+#include <QLoggingCategory>
 #include <QApplication>
 
+Q_LOGGING_CATEGORY(errorHandlerLog, "app.errors")
+
 ErrorHandler::ErrorHandler(QObject* parent)
     : QObject(parent)
     , m_parentWidget(nullptr)
@@ -14,11 +13,6 @@ ErrorHandler::ErrorHandler(QObject* parent)
     , m_loggingEnabled(true)
     , m_errorTimer(new QTimer(this))
 {
-    // Setup default log path
-    QString appDataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    QDir().mkpath(appDataDir);
-    m_logFilePath = QDir(appDataDir).absoluteFilePath("quillscribe.log");
-    
     m_errorTimer->setSingleShot(true);
     connect(m_errorTimer, &QTimer::timeout, this, &ErrorHandler::onErrorTimeout);
 }
@@ -32,6 +26,10 @@ void ErrorHandler::reportError(ErrorSeverity severity, const QString& title, con
     // Emit signal for other components
     emit errorOccurred(severity, title, message);
     
+    if (isRepeatedNotification(severity, title, message)) {
+        return;
+    }
+    
     // Handle notifications based on type
     switch (notification) {
         case NotificationType::MessageBox:
@@ -271,10 +269,6 @@ void ErrorHandler::enableLogging(bool enabled) {
     m_loggingEnabled = enabled;
 }
 
-void ErrorHandler::setLogFilePath(const QString& logPath) {
-    m_logFilePath = logPath;
-}
-
 void ErrorHandler::onErrorTimeout() {
     // Handle error timeouts if needed
 }
@@ -311,17 +305,42 @@ void ErrorHandler::showSystemTrayNotification(const QString& title, const QStrin
 }
 
 void ErrorHandler::logError(ErrorSeverity severity, const QString& title, const QString& message) {
-    QFile logFile(m_logFilePath);
-    if (!logFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
-        return;
+    // Queued for the log file; the timestamp and level are added there
+    const QString text = QString("%1 - %2").arg(title, message);
+    switch (severity) {
+        case ErrorSeverity::Info:
+            qCInfo(errorHandlerLog).noquote() << text;
+            break;
+        case ErrorSeverity::Warning:
+            qCWarning(errorHandlerLog).noquote() << text;
+            break;
+        case ErrorSeverity::Critical:
+        case ErrorSeverity::Fatal:
+            qCCritical(errorHandlerLog).noquote() << severityToString(severity) + ": " + text;
+            break;
     }
+}
+
+bool ErrorHandler::isRepeatedNotification(ErrorSeverity severity, const QString& title, const QString& message) {
+    const QString key = severityToString(severity) + '\n' + title + '\n' + message;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
     
-    QTextStream stream(&logFile);
-    QString timestamp = QDateTime::currentDateTime().toString(Qt::ISODate);
-    QString severityStr = severityToString(severity);
+    auto it = m_lastNotified.find(key);
+    if (it != m_lastNotified.end() && now - it.value() < NOTIFICATION_REPEAT_WINDOW_MS) {
+        return true;
+    }
     
-    stream << QString("[%1] %2: %3 - %4")
-              .arg(timestamp, severityStr, title, message) << Qt::endl;
+    if (m_lastNotified.size() >= MAX_TRACKED_NOTIFICATIONS) {
+        for (auto entry = m_lastNotified.begin(); entry != m_lastNotified.end();) {
+            if (now - entry.value() >= NOTIFICATION_REPEAT_WINDOW_MS) {
+                entry = m_lastNotified.erase(entry);
+            } else {
+                ++entry;
+            }
+        }
+    }
+    m_lastNotified.insert(key, now);
+    return false;
 }
 
 QString ErrorHandler::severityToString(ErrorSeverity severity) const {
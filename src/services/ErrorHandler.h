@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QHash>
 #include <QObject>
 #include <QString>
 #include <QTimer>
@@ -16,6 +17,11 @@
  * 
  * Provides consistent error handling, logging, and user notification
  * across the entire application.
+ *
+ * Reports are logged through the "app.errors" category, which the installed
+ * AsyncLogger writes off the calling thread. The same report within
+ * NOTIFICATION_REPEAT_WINDOW_MS of being shown is logged but not shown again,
+ * so a flapping device does not stack up message boxes and tray balloons.
  */
 class ErrorHandler : public QObject {
     Q_OBJECT
@@ -55,7 +61,9 @@ public:
     void setParentWidget(QWidget* parent);
     void setSystemTrayIcon(QSystemTrayIcon* trayIcon);
     void enableLogging(bool enabled);
-    void setLogFilePath(const QString& logPath);
+
+    static constexpr int NOTIFICATION_REPEAT_WINDOW_MS = 10000;
+    static constexpr int MAX_TRACKED_NOTIFICATIONS = 64;
 
 signals:
     void errorOccurred(ErrorSeverity severity, const QString& title, const QString& message);
@@ -68,12 +76,13 @@ private:
     void showMessageBox(ErrorSeverity severity, const QString& title, const QString& message);
     void showSystemTrayNotification(const QString& title, const QString& message);
     void logError(ErrorSeverity severity, const QString& title, const QString& message);
+    bool isRepeatedNotification(ErrorSeverity severity, const QString& title, const QString& message);
     QString severityToString(ErrorSeverity severity) const;
     QMessageBox::Icon severityToIcon(ErrorSeverity severity) const;
 
     QWidget* m_parentWidget;
     QSystemTrayIcon* m_systemTrayIcon;
     bool m_loggingEnabled;
-    QString m_logFilePath;
+    QHash<QString, qint64> m_lastNotified; // Report -> when it was last shown
     QTimer* m_errorTimer;
 };
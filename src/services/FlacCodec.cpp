@@ -0,0 +1,945 @@
+#include "FlacCodec.h"
+#include <QIODevice>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+constexpr quint32 SYNC_CODE = 0x3FFE;          // 14 bits at the start of every frame
+constexpr int SUBFRAME_CONSTANT = 0;
+constexpr int SUBFRAME_VERBATIM = 1;
+constexpr int SUBFRAME_FIXED = 8;               // 8 + order
+constexpr int SUBFRAME_LPC = 32;                // 32 + order - 1
+constexpr int CHANNELS_LEFT_SIDE = 8;
+constexpr int CHANNELS_SIDE_RIGHT = 9;
+constexpr int CHANNELS_MID_SIDE = 10;
+constexpr int RICE_PARAMETER_BITS = 4;
+constexpr int RICE2_PARAMETER_BITS = 5;
+constexpr int MAX_RICE_PARAMETER = 14;          // 15 is the escape code
+constexpr int MAX_RICE2_PARAMETER = 30;         // 31 is the escape code
+constexpr int STREAMINFO_SIZE = 34;
+
+struct CrcTables {
+    quint8 crc8[256];
+    quint16 crc16[256];
+
+    CrcTables() {
+        for (int i = 0; i < 256; ++i) {
+            quint8 c8 = static_cast<quint8>(i);
+            quint16 c16 = static_cast<quint16>(i << 8);
+            for (int bit = 0; bit < 8; ++bit) {
+                c8 = static_cast<quint8>((c8 & 0x80) ? (c8 << 1) ^ 0x07 : c8 << 1);
+                c16 = static_cast<quint16>((c16 & 0x8000) ? (c16 << 1) ^ 0x8005 : c16 << 1);
+            }
+            crc8[i] = c8;
+            crc16[i] = c16;
+        }
+    }
+};
+
+const CrcTables& crcTables() {
+    static const CrcTables tables;
+    return tables;
+}
+
+quint8 crc8(const uchar* data, qint64 len) {
+    const CrcTables& tables = crcTables();
+    quint8 crc = 0;
+    for (qint64 i = 0; i < len; ++i) {
+        crc = tables.crc8[crc ^ data[i]];
+    }
+    return crc;
+}
+
+quint16 crc16(const uchar* data, qint64 len) {
+    const CrcTables& tables = crcTables();
+    quint16 crc = 0;
+    for (qint64 i = 0; i < len; ++i) {
+        crc = static_cast<quint16>((crc << 8) ^ tables.crc16[(crc >> 8) ^ data[i]]);
+    }
+    return crc;
+}
+
+quint32 lowBits(int count) {
+    return count >= 32 ? 0xFFFFFFFFu : (1u << count) - 1u;
+}
+
+quint32 foldSigned(qint32 value) {
+    // Zig-zag: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+    return (static_cast<quint32>(value) << 1) ^ static_cast<quint32>(value >> 31);
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(QByteArray& output) : m_output(output), m_cache(0), m_bits(0) {}
+
+    void put(quint32 value, int count) {
+        if (count <= 0) {
+            return;
+        }
+        m_cache = (m_cache << count) | (value & lowBits(count));
+        m_bits += count;
+        while (m_bits >= 8) {
+            m_bits -= 8;
+            m_output.append(static_cast<char>(m_cache >> m_bits));
+        }
+        m_cache &= lowBits(m_bits);
+    }
+
+    void putSigned(qint32 value, int count) { put(static_cast<quint32>(value), count); }
+
+    void putUnary(quint32 zeros) {
+        while (zeros >= 32) {
+            put(0, 32);
+            zeros -= 32;
+        }
+        put(1, static_cast<int>(zeros) + 1);
+    }
+
+    void putRice(qint32 value, int parameter) {
+        const quint32 folded = foldSigned(value);
+        putUnary(folded >> parameter);
+        put(folded, parameter);
+    }
+
+    void alignToByte() {
+        if (m_bits > 0) {
+            put(0, 8 - m_bits);
+        }
+    }
+
+private:
+    QByteArray& m_output;
+    quint64 m_cache;
+    int m_bits;
+};
+
+class BitReader {
+public:
+    BitReader(const uchar* data, qint64 size) : m_data(data), m_sizeBits(size * 8), m_pos(0), m_overrun(false) {}
+
+    quint32 read(int count) {
+        if (count <= 0) {
+            return 0;
+        }
+        if (m_pos + count > m_sizeBits) {
+            m_overrun = true;
+            m_pos = m_sizeBits;
+            return 0;
+        }
+        quint64 result = 0;
+        while (count > 0) {
+            const int available = 8 - static_cast<int>(m_pos & 7);
+            const int take = qMin(available, count);
+            const quint32 byte = m_data[m_pos >> 3];
+            result = (result << take) | ((byte >> (available - take)) & lowBits(take));
+            m_pos += take;
+            count -= take;
+        }
+        return static_cast<quint32>(result);
+    }
+
+    qint32 readSigned(int count) {
+        if (count <= 0) {
+            return 0;
+        }
+        const quint32 value = read(count);
+        if (count >= 32) {
+            return static_cast<qint32>(value);
+        }
+        const int shift = 32 - count;
+        return static_cast<qint32>(value << shift) >> shift;
+    }
+
+    quint32 readUnary() {
+        quint32 zeros = 0;
+        while (m_pos < m_sizeBits) {
+            // Skip whole zero bytes at once
+            if ((m_pos & 7) == 0 && m_data[m_pos >> 3] == 0 && m_pos + 8 <= m_sizeBits) {
+                zeros += 8;
+                m_pos += 8;
+                continue;
+            }
+            const bool bit = (m_data[m_pos >> 3] >> (7 - (m_pos & 7))) & 1;
+            ++m_pos;
+            if (bit) {
+                return zeros;
+            }
+            ++zeros;
+        }
+        m_overrun = true;
+        return zeros;
+    }
+
+    void alignToByte() { m_pos = qMin(m_sizeBits, (m_pos + 7) & ~qint64(7)); }
+    qint64 bytePosition() const { return m_pos >> 3; }
+    bool overrun() const { return m_overrun; }
+
+private:
+    const uchar* m_data;
+    qint64 m_sizeBits;
+    qint64 m_pos;
+    bool m_overrun;
+};
+
+// Residual of the fixed polynomial predictor of @p order at sample @p i
+qint64 fixedResidual(const qint32* x, int i, int order) {
+    switch (order) {
+    case 0: return x[i];
+    case 1: return qint64(x[i]) - x[i - 1];
+    case 2: return qint64(x[i]) - 2 * qint64(x[i - 1]) + x[i - 2];
+    case 3: return qint64(x[i]) - 3 * qint64(x[i - 1]) + 3 * qint64(x[i - 2]) - x[i - 3];
+    default: return qint64(x[i]) - 4 * qint64(x[i - 1]) + 6 * qint64(x[i - 2]) - 4 * qint64(x[i - 3]) + x[i - 4];
+    }
+}
+
+bool fitsResidual(qint64 value) {
+    return value >= std::numeric_limits<qint32>::min() && value <= std::numeric_limits<qint32>::max();
+}
+
+// Sum of |residual| for the best fixed order; a cheap proxy for the encoded size
+quint64 estimateFixed(const qint32* x, int count, int* bestOrder) {
+    quint64 best = std::numeric_limits<quint64>::max();
+    *bestOrder = 0;
+    if (count <= FlacEncoder::MAX_FIXED_ORDER) {
+        return best;
+    }
+    for (int order = 0; order <= FlacEncoder::MAX_FIXED_ORDER; ++order) {
+        quint64 sum = 0;
+        bool fits = true;
+        for (int i = FlacEncoder::MAX_FIXED_ORDER; i < count && fits; ++i) {
+            const qint64 residual = fixedResidual(x, i, order);
+            fits = fitsResidual(residual);
+            sum += static_cast<quint64>(residual < 0 ? -residual : residual);
+        }
+        if (fits && sum < best) {
+            best = sum;
+            *bestOrder = order;
+        }
+    }
+    return best;
+}
+
+struct RicePlan {
+    int partitionOrder = 0;
+    QVector<int> parameters;
+    quint64 bits = std::numeric_limits<quint64>::max();
+    bool useRice2 = false;
+};
+
+int riceParameterFor(quint64 count, quint64 sum, quint64* bits) {
+    int parameter = 0;
+    while (parameter < MAX_RICE2_PARAMETER && (count << (parameter + 1)) <= sum) {
+        ++parameter;
+    }
+    *bits = count * (parameter + 1) + (sum >> parameter);
+    return parameter;
+}
+
+// Picks the partition order and per-partition parameters for residual[order..count)
+RicePlan planResidual(const QVector<qint32>& residual, int count, int order) {
+    int maxOrder = 0;
+    while (maxOrder < FlacEncoder::MAX_PARTITION_ORDER && count % (2 << maxOrder) == 0 &&
+           (count >> (maxOrder + 1)) > order) {
+        ++maxOrder;
+    }
+
+    // Folded sums at the finest partitioning, merged pairwise for coarser ones
+    QVector<quint64> sums(1 << maxOrder, 0);
+    const int finestSize = count >> maxOrder;
+    for (int i = order; i < count; ++i) {
+        sums[i / finestSize] += foldSigned(residual[i]);
+    }
+
+    RicePlan best;
+    for (int partitionOrder = maxOrder; partitionOrder >= 0; --partitionOrder) {
+        const int partitions = 1 << partitionOrder;
+        const int partitionSize = count >> partitionOrder;
+        RicePlan plan;
+        plan.partitionOrder = partitionOrder;
+        plan.parameters.resize(partitions);
+        plan.bits = 2 + 4;
+        for (int p = 0; p < partitions; ++p) {
+            const quint64 samples = partitionSize - (p == 0 ? order : 0);
+            quint64 bits = 0;
+            plan.parameters[p] = riceParameterFor(samples, sums[p], &bits);
+            plan.useRice2 = plan.useRice2 || plan.parameters[p] > MAX_RICE_PARAMETER;
+            plan.bits += bits;
+        }
+        plan.bits += static_cast<quint64>(partitions) * (plan.useRice2 ? RICE2_PARAMETER_BITS : RICE_PARAMETER_BITS);
+        if (plan.bits < best.bits) {
+            best = plan;
+        }
+
+        if (partitionOrder > 0) {
+            for (int p = 0; p < partitions / 2; ++p) {
+                sums[p] = sums[2 * p] + sums[2 * p + 1];
+            }
+        }
+    }
+    return best;
+}
+
+void writeSubframe(BitWriter& writer, const qint32* samples, int count, int bitsPerSample) {
+    // Wasted bits: low bits that are zero in every sample (e.g. 24-bit audio in Int32)
+    quint32 combined = 0;
+    bool constant = true;
+    for (int i = 0; i < count; ++i) {
+        combined |= static_cast<quint32>(samples[i]);
+        constant = constant && samples[i] == samples[0];
+    }
+
+    if (constant) {
+        writer.put(SUBFRAME_CONSTANT << 1, 8);
+        writer.putSigned(samples[0], bitsPerSample);
+        return;
+    }
+
+    int wasted = 0;
+    while (wasted < bitsPerSample - 1 && !(combined & (1u << wasted))) {
+        ++wasted;
+    }
+    QVector<qint32> shifted;
+    if (wasted > 0) {
+        shifted.resize(count);
+        for (int i = 0; i < count; ++i) {
+            shifted[i] = samples[i] >> wasted;
+        }
+        samples = shifted.constData();
+    }
+    const int effectiveBits = bitsPerSample - wasted;
+
+    int order = 0;
+    bool canPredict = estimateFixed(samples, count, &order) != std::numeric_limits<quint64>::max();
+    QVector<qint32> residual;
+    RicePlan plan;
+    if (canPredict) {
+        residual.resize(count);
+        for (int i = order; i < count && canPredict; ++i) {
+            const qint64 value = fixedResidual(samples, i, order);
+            canPredict = fitsResidual(value);
+            residual[i] = static_cast<qint32>(value);
+        }
+    }
+    if (canPredict) {
+        plan = planResidual(residual, count, order);
+    }
+
+    const quint64 verbatimBits = static_cast<quint64>(count) * effectiveBits;
+    const bool useFixed = canPredict && static_cast<quint64>(order) * effectiveBits + plan.bits < verbatimBits;
+    const int type = useFixed ? SUBFRAME_FIXED + order : SUBFRAME_VERBATIM;
+
+    writer.put(static_cast<quint32>(type << 1) | (wasted > 0 ? 1u : 0u), 8);
+    if (wasted > 0) {
+        writer.putUnary(static_cast<quint32>(wasted - 1));
+    }
+
+    if (!useFixed) {
+        for (int i = 0; i < count; ++i) {
+            writer.putSigned(samples[i], effectiveBits);
+        }
+        return;
+    }
+
+    for (int i = 0; i < order; ++i) {
+        writer.putSigned(samples[i], effectiveBits);
+    }
+    writer.put(plan.useRice2 ? 1 : 0, 2);
+    writer.put(static_cast<quint32>(plan.partitionOrder), 4);
+    const int partitionSize = count >> plan.partitionOrder;
+    int i = order;
+    for (int p = 0; p < plan.parameters.size(); ++p) {
+        const int parameter = plan.parameters[p];
+        writer.put(static_cast<quint32>(parameter), plan.useRice2 ? RICE2_PARAMETER_BITS : RICE_PARAMETER_BITS);
+        for (const int end = (p + 1) * partitionSize; i < end; ++i) {
+            writer.putRice(residual[i], parameter);
+        }
+    }
+}
+
+void writeFrameNumber(BitWriter& writer, quint64 value) {
+    // UTF-8 style variable-length code, up to 36 bits
+    if (value < 0x80) {
+        writer.put(static_cast<quint32>(value), 8);
+        return;
+    }
+    int continuation = 1;
+    while (continuation < 6 && value >= (quint64(1) << (6 + 5 * continuation))) {
+        ++continuation;
+    }
+    const int leadBits = 6 - continuation; // Value bits left in the lead byte
+    const quint32 lead = (0xFF00u >> (continuation + 1)) & 0xFFu;
+    writer.put(lead | static_cast<quint32>((value >> (6 * continuation)) & lowBits(leadBits)), 8);
+    for (int c = continuation - 1; c >= 0; --c) {
+        writer.put(0x80u | static_cast<quint32>((value >> (6 * c)) & 0x3F), 8);
+    }
+}
+
+int sampleSizeCode(int bitsPerSample) {
+    switch (bitsPerSample) {
+    case 8: return 1;
+    case 16: return 4;
+    case 24: return 6;
+    case 32: return 7;
+    default: return 0;
+    }
+}
+
+} // namespace
+
+// FlacEncoder
+
+FlacEncoder::FlacEncoder()
+    : m_bitsPerSample(16)
+    , m_pendingSamples(0)
+    , m_frameNumber(0)
+    , m_totalSamples(0)
+    , m_minFrameBytes(0)
+    , m_maxFrameBytes(0)
+{
+}
+
+bool FlacEncoder::supportsFormat(const AudioFileReader::Format& format) {
+    return !format.isFloat && format.channelCount >= 1 && format.channelCount <= 8 &&
+           format.sampleRate > 0 && format.sampleRate < (1 << 20) &&
+           (format.bytesPerSample == 1 || format.bytesPerSample == 2 || format.bytesPerSample == 4);
+}
+
+bool FlacEncoder::configure(const AudioFileReader::Format& format) {
+    if (!supportsFormat(format)) {
+        return false;
+    }
+    m_format = format;
+    m_bitsPerSample = format.bytesPerSample * 8;
+    reset();
+    return true;
+}
+
+void FlacEncoder::reset() {
+    m_channels = QVector<QVector<qint32>>(m_format.channelCount, QVector<qint32>(BLOCK_SIZE));
+    m_pendingSamples = 0;
+    m_partialFrame.clear();
+    m_frameNumber = 0;
+    m_totalSamples = 0;
+    m_minFrameBytes = 0;
+    m_maxFrameBytes = 0;
+}
+
+void FlacEncoder::encode(const char* data, qint64 len, QByteArray& output) {
+    if (!data || len <= 0) {
+        return;
+    }
+
+    const int frameBytes = m_format.channelCount * m_format.bytesPerSample;
+    QByteArray joined;
+    if (!m_partialFrame.isEmpty()) {
+        joined = m_partialFrame + QByteArray::fromRawData(data, static_cast<int>(len));
+        data = joined.constData();
+        len = joined.size();
+    }
+    const qint64 frames = len / frameBytes;
+
+    const char* p = data;
+    for (qint64 frame = 0; frame < frames; ++frame) {
+        for (int ch = 0; ch < m_format.channelCount; ++ch, p += m_format.bytesPerSample) {
+            qint32 sample;
+            if (m_format.bytesPerSample == 2) {
+                sample = qFromLittleEndian<qint16>(p);
+            } else if (m_format.bytesPerSample == 4) {
+                sample = qFromLittleEndian<qint32>(p);
+            } else {
+                sample = static_cast<qint32>(static_cast<quint8>(*p)) - 128; // FLAC 8-bit is signed
+            }
+            m_channels[ch][m_pendingSamples] = sample;
+        }
+        if (++m_pendingSamples == BLOCK_SIZE) {
+            encodeBlock(BLOCK_SIZE, output);
+        }
+    }
+    m_partialFrame = QByteArray(data + frames * frameBytes, static_cast<int>(len - frames * frameBytes));
+}
+
+void FlacEncoder::flush(QByteArray& output) {
+    if (m_pendingSamples > 0) {
+        encodeBlock(m_pendingSamples, output);
+    }
+    m_partialFrame.clear();
+}
+
+void FlacEncoder::encodeBlock(int blockSize, QByteArray& output) {
+    int assignment = m_format.channelCount - 1;
+    QVector<qint32> side;
+    QVector<qint32> mid;
+
+    // Side channels need one more bit, which 32-bit input cannot spare
+    if (m_format.channelCount == 2 && m_bitsPerSample < 32) {
+        const qint32* left = m_channels[0].constData();
+        const qint32* right = m_channels[1].constData();
+        side.resize(blockSize);
+        mid.resize(blockSize);
+        for (int i = 0; i < blockSize; ++i) {
+            side[i] = left[i] - right[i];
+            mid[i] = (left[i] + right[i]) >> 1;
+        }
+
+        int order = 0;
+        const quint64 l = estimateFixed(left, blockSize, &order);
+        const quint64 r = estimateFixed(right, blockSize, &order);
+        const quint64 s = estimateFixed(side.constData(), blockSize, &order);
+        const quint64 m = estimateFixed(mid.constData(), blockSize, &order);
+        if (l != std::numeric_limits<quint64>::max()) {
+            quint64 best = l + r;
+            if (l + s < best) { best = l + s; assignment = CHANNELS_LEFT_SIDE; }
+            if (s + r < best) { best = s + r; assignment = CHANNELS_SIDE_RIGHT; }
+            if (m + s < best) { assignment = CHANNELS_MID_SIDE; }
+        }
+    }
+
+    QByteArray frame;
+    frame.reserve(blockSize * m_format.channelCount * m_format.bytesPerSample / 2 + 64);
+    BitWriter writer(frame);
+
+    const int blockSizeCode = blockSize == BLOCK_SIZE ? 12 : (blockSize <= 256 ? 6 : 7);
+    writer.put(SYNC_CODE, 14);
+    writer.put(0, 1);                       // Reserved
+    writer.put(0, 1);                       // Fixed block size
+    writer.put(static_cast<quint32>(blockSizeCode), 4);
+    writer.put(0, 4);                       // Sample rate from STREAMINFO
+    writer.put(static_cast<quint32>(assignment), 4);
+    writer.put(static_cast<quint32>(sampleSizeCode(m_bitsPerSample)), 3);
+    writer.put(0, 1);                       // Reserved
+    writeFrameNumber(writer, m_frameNumber);
+    if (blockSizeCode == 6) {
+        writer.put(static_cast<quint32>(blockSize - 1), 8);
+    } else if (blockSizeCode == 7) {
+        writer.put(static_cast<quint32>(blockSize - 1), 16);
+    }
+    writer.put(crc8(reinterpret_cast<const uchar*>(frame.constData()), frame.size()), 8);
+
+    switch (assignment) {
+    case CHANNELS_LEFT_SIDE:
+        writeSubframe(writer, m_channels[0].constData(), blockSize, m_bitsPerSample);
+        writeSubframe(writer, side.constData(), blockSize, m_bitsPerSample + 1);
+        break;
+    case CHANNELS_SIDE_RIGHT:
+        writeSubframe(writer, side.constData(), blockSize, m_bitsPerSample + 1);
+        writeSubframe(writer, m_channels[1].constData(), blockSize, m_bitsPerSample);
+        break;
+    case CHANNELS_MID_SIDE:
+        writeSubframe(writer, mid.constData(), blockSize, m_bitsPerSample);
+        writeSubframe(writer, side.constData(), blockSize, m_bitsPerSample + 1);
+        break;
+    default:
+        for (int ch = 0; ch < m_format.channelCount; ++ch) {
+            writeSubframe(writer, m_channels[ch].constData(), blockSize, m_bitsPerSample);
+        }
+        break;
+    }
+    writer.alignToByte();
+    writer.put(crc16(reinterpret_cast<const uchar*>(frame.constData()), frame.size()), 16);
+
+    const quint32 frameBytes = static_cast<quint32>(frame.size());
+    m_minFrameBytes = m_minFrameBytes == 0 ? frameBytes : qMin(m_minFrameBytes, frameBytes);
+    m_maxFrameBytes = qMax(m_maxFrameBytes, frameBytes);
+    ++m_frameNumber;
+    m_totalSamples += blockSize;
+    m_pendingSamples = 0;
+    output.append(frame);
+}
+
+QByteArray FlacEncoder::streamHeader() const {
+    return makeStreamHeader(m_format, m_totalSamples, m_minFrameBytes, m_maxFrameBytes);
+}
+
+QByteArray FlacEncoder::makeStreamHeader(const AudioFileReader::Format& format, quint64 totalSamples,
+                                         quint32 minFrameBytes, quint32 maxFrameBytes) {
+    QByteArray header;
+    header.reserve(HEADER_SIZE);
+    header.append("fLaC", 4);
+
+    BitWriter writer(header);
+    writer.put(1, 1);                       // Last metadata block
+    writer.put(0, 7);                       // STREAMINFO
+    writer.put(STREAMINFO_SIZE, 24);
+    writer.put(BLOCK_SIZE, 16);             // Minimum block size (the last one may be shorter)
+    writer.put(BLOCK_SIZE, 16);
+    writer.put(minFrameBytes, 24);
+    writer.put(maxFrameBytes, 24);
+    writer.put(static_cast<quint32>(format.sampleRate), 20);
+    writer.put(static_cast<quint32>(format.channelCount - 1), 3);
+    writer.put(static_cast<quint32>(format.bytesPerSample * 8 - 1), 5);
+    writer.put(static_cast<quint32>(totalSamples >> 32) & 0xF, 4);
+    writer.put(static_cast<quint32>(totalSamples), 32);
+    header.append(16, '\0');                // MD5 left unset
+    return header;
+}
+
+// FlacDecoder
+
+FlacDecoder::FlacDecoder(QIODevice* device)
+    : m_device(device)
+    , m_bufferPos(device ? device->pos() : 0)
+    , m_readPos(0)
+    , m_atEnd(false)
+    , m_sampleRate(0)
+    , m_channelCount(0)
+    , m_bitsPerSample(0)
+    , m_maxBlockSize(0)
+    , m_maxFrameBytes(0)
+    , m_totalSamples(0)
+    , m_decodedSamples(0)
+    , m_lastFrameEnd(0)
+{
+}
+
+bool FlacDecoder::isFlac(const QByteArray& header) {
+    return header.size() >= 4 && std::memcmp(header.constData(), "fLaC", 4) == 0;
+}
+
+bool FlacDecoder::fillBuffer(qint64 minBytes) {
+    if (m_buffer.size() - m_readPos >= minBytes) {
+        return true;
+    }
+
+    if (m_readPos > 0) {
+        m_buffer.remove(0, static_cast<int>(m_readPos));
+        m_bufferPos += m_readPos;
+        m_readPos = 0;
+    }
+    while (!m_atEnd && m_buffer.size() < minBytes) {
+        const QByteArray chunk = m_device->read(qMax<qint64>(READ_CHUNK_BYTES, minBytes - m_buffer.size()));
+        if (chunk.isEmpty()) {
+            m_atEnd = true;
+            break;
+        }
+        m_buffer.append(chunk);
+    }
+    return m_buffer.size() >= minBytes;
+}
+
+bool FlacDecoder::readHeader() {
+    if (!m_device || !fillBuffer(4) || !isFlac(m_buffer.mid(static_cast<int>(m_readPos), 4))) {
+        m_errorString = "Not a FLAC stream";
+        return false;
+    }
+    m_readPos += 4;
+
+    bool haveStreamInfo = false;
+    bool last = false;
+    while (!last) {
+        if (!fillBuffer(4)) {
+            m_errorString = "Truncated FLAC metadata";
+            return false;
+        }
+        const uchar* p = reinterpret_cast<const uchar*>(m_buffer.constData() + m_readPos);
+        last = (p[0] & 0x80) != 0;
+        const int type = p[0] & 0x7F;
+        const qint64 length = (qint64(p[1]) << 16) | (qint64(p[2]) << 8) | p[3];
+        m_readPos += 4;
+        if (!fillBuffer(length)) {
+            m_errorString = "Truncated FLAC metadata";
+            return false;
+        }
+
+        if (type == 0 && length >= STREAMINFO_SIZE) {
+            BitReader reader(reinterpret_cast<const uchar*>(m_buffer.constData() + m_readPos), length);
+            reader.read(16);                // Minimum block size
+            m_maxBlockSize = static_cast<int>(reader.read(16));
+            reader.read(24);                // Minimum frame size
+            m_maxFrameBytes = reader.read(24);
+            m_sampleRate = static_cast<int>(reader.read(20));
+            m_channelCount = static_cast<int>(reader.read(3)) + 1;
+            m_bitsPerSample = static_cast<int>(reader.read(5)) + 1;
+            m_totalSamples = (quint64(reader.read(4)) << 32) | reader.read(32);
+            haveStreamInfo = true;
+        }
+        m_readPos += length;
+    }
+
+    if (!haveStreamInfo || m_sampleRate <= 0 || m_bitsPerSample < 4) {
+        m_errorString = "FLAC stream has no usable STREAMINFO";
+        return false;
+    }
+    if (m_maxBlockSize < 16) {
+        m_maxBlockSize = 65535;
+    }
+    m_channels = QVector<QVector<qint32>>(m_channelCount);
+    m_lastFrameEnd = m_bufferPos + m_readPos;
+    return true;
+}
+
+AudioFileReader::Format FlacDecoder::format() const {
+    AudioFileReader::Format format;
+    format.sampleRate = m_sampleRate;
+    format.channelCount = m_channelCount;
+    format.bytesPerSample = (m_bitsPerSample + 7) / 8;
+    format.isFloat = false;
+    return format;
+}
+
+int FlacDecoder::readFrame(QVector<qint32>& interleaved) {
+    if (m_channelCount <= 0) {
+        m_errorString = "FLAC header has not been read";
+        return -1;
+    }
+
+    // Worst case for one frame: every subframe verbatim, plus headers
+    const qint64 frameBound = 18 + qint64(m_channelCount) * ((qint64(m_maxBlockSize) * 33 + 7) / 8 + 16);
+    forever {
+        fillBuffer(frameBound);
+        const qint64 available = m_buffer.size() - m_readPos;
+        if (available < 2) {
+            return 0;
+        }
+
+        const uchar* p = reinterpret_cast<const uchar*>(m_buffer.constData() + m_readPos);
+        if (p[0] != 0xFF || (p[1] & 0xFE) != 0xF8) {
+            // Lost sync; look for the next candidate frame
+            const void* next = std::memchr(p + 1, 0xFF, static_cast<size_t>(available - 1));
+            m_readPos = next ? static_cast<const char*>(next) - m_buffer.constData() : m_buffer.size();
+            continue;
+        }
+
+        qint64 frameBytes = 0;
+        const int samples = decodeFrameAt(m_readPos, interleaved, &frameBytes);
+        if (samples > 0) {
+            m_readPos += frameBytes;
+            m_lastFrameEnd = m_bufferPos + m_readPos;
+            m_decodedSamples += samples;
+            return samples;
+        }
+        if (samples == 0 && m_atEnd) {
+            return 0; // Truncated last frame
+        }
+        ++m_readPos;
+    }
+}
+
+int FlacDecoder::decodeFrameAt(qint64 offset, QVector<qint32>& interleaved, qint64* frameBytes) {
+    const uchar* data = reinterpret_cast<const uchar*>(m_buffer.constData() + offset);
+    BitReader reader(data, m_buffer.size() - offset);
+
+    if (reader.read(14) != SYNC_CODE || reader.read(1) != 0) {
+        return -1;
+    }
+    reader.read(1);                         // Blocking strategy
+    const int blockSizeCode = static_cast<int>(reader.read(4));
+    const int sampleRateCode = static_cast<int>(reader.read(4));
+    const int assignment = static_cast<int>(reader.read(4));
+    const int sampleSize = static_cast<int>(reader.read(3));
+    if (reader.read(1) != 0 || blockSizeCode == 0 || sampleRateCode == 15 || sampleSize == 3) {
+        return -1;
+    }
+
+    // Frame or sample number, UTF-8 coded
+    const quint32 lead = reader.read(8);
+    int continuation = 0;
+    if (lead & 0x80) {
+        while (continuation < 7 && (lead & (0x40u >> continuation))) {
+            ++continuation;
+        }
+        if (continuation == 0 || continuation > 6) {
+            return -1;
+        }
+    }
+    for (int c = 0; c < continuation; ++c) {
+        if ((reader.read(8) & 0xC0) != 0x80) {
+            return -1;
+        }
+    }
+
+    int blockSize;
+    if (blockSizeCode == 1) {
+        blockSize = 192;
+    } else if (blockSizeCode <= 5) {
+        blockSize = 576 << (blockSizeCode - 2);
+    } else if (blockSizeCode == 6) {
+        blockSize = static_cast<int>(reader.read(8)) + 1;
+    } else if (blockSizeCode == 7) {
+        blockSize = static_cast<int>(reader.read(16)) + 1;
+    } else {
+        blockSize = 256 << (blockSizeCode - 8);
+    }
+    if (sampleRateCode == 12) {
+        reader.read(8);
+    } else if (sampleRateCode == 13 || sampleRateCode == 14) {
+        reader.read(16);
+    }
+
+    static const int sampleSizes[8] = { 0, 8, 12, 0, 16, 20, 24, 32 };
+    const int bitsPerSample = sampleSize == 0 ? m_bitsPerSample : sampleSizes[sampleSize];
+    const int channels = assignment < CHANNELS_LEFT_SIDE ? assignment + 1 : 2;
+    if (assignment > CHANNELS_MID_SIDE || channels != m_channelCount || blockSize > m_maxBlockSize) {
+        return -1;
+    }
+
+    const qint64 headerBytes = reader.bytePosition();
+    const quint32 headerCrc = reader.read(8);
+    if (reader.overrun()) {
+        return 0;
+    }
+    if (headerCrc != crc8(data, headerBytes)) {
+        return -1;
+    }
+
+    for (int ch = 0; ch < channels; ++ch) {
+        const bool isSide = (assignment == CHANNELS_LEFT_SIDE && ch == 1) ||
+                            (assignment == CHANNELS_SIDE_RIGHT && ch == 0) ||
+                            (assignment == CHANNELS_MID_SIDE && ch == 1);
+        int bits = bitsPerSample + (isSide ? 1 : 0);
+        QVector<qint32>& out = m_channels[ch];
+        out.resize(blockSize);
+        qint32* x = out.data();
+
+        if (reader.read(1) != 0) {
+            return -1;
+        }
+        const int type = static_cast<int>(reader.read(6));
+        int wasted = 0;
+        if (reader.read(1)) {
+            wasted = static_cast<int>(reader.readUnary()) + 1;
+            bits -= wasted;
+        }
+        if (bits <= 0 || bits > 32) {
+            return -1;
+        }
+
+        int order = 0;
+        QVector<qint32> coefficients;
+        int shift = 0;
+        if (type == SUBFRAME_CONSTANT) {
+            const qint32 value = reader.readSigned(bits);
+            std::fill(x, x + blockSize, value);
+        } else if (type == SUBFRAME_VERBATIM) {
+            for (int i = 0; i < blockSize; ++i) {
+                x[i] = reader.readSigned(bits);
+            }
+        } else if ((type >= SUBFRAME_FIXED && type <= SUBFRAME_FIXED + 4) || type >= SUBFRAME_LPC) {
+            order = type >= SUBFRAME_LPC ? type - SUBFRAME_LPC + 1 : type - SUBFRAME_FIXED;
+            if (order > blockSize) {
+                return -1;
+            }
+            for (int i = 0; i < order; ++i) {
+                x[i] = reader.readSigned(bits);
+            }
+            if (type >= SUBFRAME_LPC) {
+                const int precision = static_cast<int>(reader.read(4)) + 1;
+                shift = reader.readSigned(5);
+                if (precision > 15 || shift < 0) {
+                    return -1;
+                }
+                coefficients.resize(order);
+                for (int j = 0; j < order; ++j) {
+                    coefficients[j] = reader.readSigned(precision);
+                }
+            }
+
+            // Partitioned Rice residual
+            const int method = static_cast<int>(reader.read(2));
+            if (method > 1) {
+                return -1;
+            }
+            const int parameterBits = method == 0 ? RICE_PARAMETER_BITS : RICE2_PARAMETER_BITS;
+            const int escape = (1 << parameterBits) - 1;
+            const int partitionOrder = static_cast<int>(reader.read(4));
+            const int partitions = 1 << partitionOrder;
+            if (blockSize % partitions != 0 || (blockSize >> partitionOrder) < order) {
+                return -1;
+            }
+            int i = order;
+            for (int p = 0; p < partitions && !reader.overrun(); ++p) {
+                const int end = (p + 1) * (blockSize >> partitionOrder);
+                const int parameter = static_cast<int>(reader.read(parameterBits));
+                if (parameter == escape) {
+                    const int rawBits = static_cast<int>(reader.read(5));
+                    for (; i < end; ++i) {
+                        x[i] = reader.readSigned(rawBits);
+                    }
+                    continue;
+                }
+                for (; i < end && !reader.overrun(); ++i) {
+                    const quint32 folded = (reader.readUnary() << parameter) | reader.read(parameter);
+                    x[i] = static_cast<qint32>((folded >> 1) ^ (0u - (folded & 1)));
+                }
+            }
+
+            // Undo the prediction
+            if (type >= SUBFRAME_LPC) {
+                for (int n = order; n < blockSize; ++n) {
+                    qint64 prediction = 0;
+                    for (int j = 0; j < order; ++j) {
+                        prediction += qint64(coefficients[j]) * x[n - 1 - j];
+                    }
+                    x[n] = static_cast<qint32>(x[n] + (prediction >> shift));
+                }
+            } else {
+                for (int n = order; n < blockSize; ++n) {
+                    qint64 value = x[n];
+                    switch (order) {
+                    case 1: value += x[n - 1]; break;
+                    case 2: value += 2 * qint64(x[n - 1]) - x[n - 2]; break;
+                    case 3: value += 3 * qint64(x[n - 1]) - 3 * qint64(x[n - 2]) + x[n - 3]; break;
+                    case 4: value += 4 * qint64(x[n - 1]) - 6 * qint64(x[n - 2]) + 4 * qint64(x[n - 3]) - x[n - 4]; break;
+                    default: break;
+                    }
+                    x[n] = static_cast<qint32>(value);
+                }
+            }
+        } else {
+            return -1;
+        }
+
+        if (reader.overrun()) {
+            return 0;
+        }
+        if (wasted > 0) {
+            for (int i = 0; i < blockSize; ++i) {
+                x[i] = static_cast<qint32>(static_cast<quint32>(x[i]) << wasted);
+            }
+        }
+    }
+
+    reader.alignToByte();
+    const qint64 crcBytes = reader.bytePosition();
+    const quint32 frameCrc = reader.read(16);
+    if (reader.overrun()) {
+        return 0;
+    }
+    if (frameCrc != crc16(data, crcBytes)) {
+        return -1;
+    }
+    *frameBytes = reader.bytePosition();
+
+    interleaved.resize(blockSize * channels);
+    if (assignment >= CHANNELS_LEFT_SIDE) {
+        const qint32* a = m_channels[0].constData();
+        const qint32* b = m_channels[1].constData();
+        for (int i = 0; i < blockSize; ++i) {
+            qint64 left;
+            qint64 right;
+            if (assignment == CHANNELS_LEFT_SIDE) {
+                left = a[i];
+                right = qint64(a[i]) - b[i];
+            } else if (assignment == CHANNELS_SIDE_RIGHT) {
+                right = b[i];
+                left = qint64(a[i]) + b[i];
+            } else {
+                const qint64 mid = (qint64(a[i]) * 2) | (b[i] & 1);
+                left = (mid + b[i]) >> 1;
+                right = (mid - b[i]) >> 1;
+            }
+            interleaved[2 * i] = static_cast<qint32>(left);
+            interleaved[2 * i + 1] = static_cast<qint32>(right);
+        }
+    } else {
+        for (int ch = 0; ch < channels; ++ch) {
+            const qint32* x = m_channels[ch].constData();
+            for (int i = 0; i < blockSize; ++i) {
+                interleaved[i * channels + ch] = x[i];
+            }
+        }
+    }
+    return blockSize;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "AudioFileReader.h"
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+class QIODevice;
+
+/**
+ * @brief FlacEncoder - Streaming lossless FLAC encoder for integer PCM recordings
+ *
+ * Takes interleaved capture bytes of any length and emits complete FLAC frames of
+ * BLOCK_SIZE samples, so a recording can be compressed chunk by chunk on the writer
+ * thread. Each channel uses the cheapest of a constant, verbatim or fixed-predictor
+ * (orders 0-4) subframe with partitioned Rice residuals; stereo input also tries the
+ * side-channel decorrelations. Speech typically compresses to about half of PCM16.
+ *
+ * streamHeader() always has HEADER_SIZE bytes, so the totals can be patched in place.
+ */
+class FlacEncoder {
+public:
+    FlacEncoder();
+
+    // 8, 16 or 32-bit integer PCM, 1-8 channels
+    static bool supportsFormat(const AudioFileReader::Format& format);
+    bool configure(const AudioFileReader::Format& format);
+    void reset();
+
+    // Appends the frames completed by @p len more capture bytes
+    void encode(const char* data, qint64 len, QByteArray& output);
+    // Encodes the remaining partial block, if any
+    void flush(QByteArray& output);
+
+    // "fLaC" marker plus STREAMINFO describing everything encoded so far
+    QByteArray streamHeader() const;
+    static QByteArray makeStreamHeader(const AudioFileReader::Format& format, quint64 totalSamples,
+                                       quint32 minFrameBytes, quint32 maxFrameBytes);
+
+    quint64 totalSamples() const { return m_totalSamples; }
+    const AudioFileReader::Format& format() const { return m_format; }
+
+    static constexpr int BLOCK_SIZE = 4096;
+    static constexpr int HEADER_SIZE = 42;      // Marker + block header + STREAMINFO
+    static constexpr int MAX_PARTITION_ORDER = 6;
+    static constexpr int MAX_FIXED_ORDER = 4;
+
+private:
+    void encodeBlock(int blockSize, QByteArray& output);
+
+    AudioFileReader::Format m_format;
+    int m_bitsPerSample;
+    QVector<QVector<qint32>> m_channels;    // Pending samples, one block at most
+    int m_pendingSamples;
+    QByteArray m_partialFrame;              // Capture bytes short of a whole frame
+    quint64 m_frameNumber;
+    quint64 m_totalSamples;
+    quint32 m_minFrameBytes;
+    quint32 m_maxFrameBytes;
+};
+
+/**
+ * @brief FlacDecoder - Streaming FLAC decoder reading frame by frame from a device
+ *
+ * Reads through a bounded buffer instead of loading the whole file, and decodes
+ * every subframe type (constant, verbatim, fixed, LPC) so files from other encoders
+ * work too. A frame failing its CRC is skipped by searching for the next sync code;
+ * a truncated final frame - an interrupted recording - simply ends the stream.
+ */
+class FlacDecoder {
+public:
+    explicit FlacDecoder(QIODevice* device);
+
+    static bool isFlac(const QByteArray& header);
+
+    // Parses the marker and metadata blocks
+    bool readHeader();
+
+    // Decodes the next frame into interleaved samples; returns samples per channel,
+    // 0 at the end of the stream and -1 on an unrecoverable error
+    int readFrame(QVector<qint32>& interleaved);
+
+    AudioFileReader::Format format() const;
+    int bitsPerSample() const { return m_bitsPerSample; }
+    quint64 totalSamples() const { return m_totalSamples; } // 0 when unknown
+    quint64 decodedSamples() const { return m_decodedSamples; }
+    qint64 lastFrameEnd() const { return m_lastFrameEnd; }  // Device offset after the last good frame
+    QString errorString() const { return m_errorString; }
+
+    static constexpr int READ_CHUNK_BYTES = 256 * 1024;
+
+private:
+    bool fillBuffer(qint64 minBytes);
+    int decodeFrameAt(qint64 offset, QVector<qint32>& interleaved, qint64* frameBytes);
+
+    QIODevice* m_device;
+    QByteArray m_buffer;
+    qint64 m_bufferPos;         // Device offset of m_buffer[0]
+    qint64 m_readPos;           // Offset into m_buffer
+    bool m_atEnd;
+
+    int m_sampleRate;
+    int m_channelCount;
+    int m_bitsPerSample;
+    int m_maxBlockSize;
+    quint32 m_maxFrameBytes;
+    quint64 m_totalSamples;
+    quint64 m_decodedSamples;
+    qint64 m_lastFrameEnd;
+    QString m_errorString;
+
+    QVector<QVector<qint32>> m_channels;    // Per-channel scratch, reused across frames
+};
@@ -0,0 +1,127 @@
+#include "GeminiStreamParser.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonParseError>
+
+QString GeminiStreamParser::feed(const QByteArray& data) {
+    // Raw carriage returns only occur in line endings; JSON escapes them inside strings
+    QByteArray bytes = data;
+    bytes.replace('\r', QByteArray());
+    m_buffer += bytes;
+
+    QString added;
+    qsizetype end = 0;
+    while ((end = m_buffer.indexOf("\n\n")) >= 0) {
+        const QByteArray event = m_buffer.left(end);
+        m_buffer.remove(0, end + 2);
+        added += parseEvent(event);
+    }
+    return added;
+}
+
+QString GeminiStreamParser::finish() {
+    const QByteArray event = m_buffer.trimmed();
+    m_buffer.clear();
+    return event.isEmpty() ? QString() : parseEvent(event);
+}
+
+QString GeminiStreamParser::parseResponse(const QByteArray& body) {
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(body, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !document.isObject()) {
+        m_errorMessage = "Malformed response: " + parseError.errorString();
+        return QString();
+    }
+
+    ++m_eventCount;
+    return parseChunk(document.object());
+}
+
+void GeminiStreamParser::reset() {
+    *this = GeminiStreamParser();
+}
+
+QString GeminiStreamParser::extractText(const QJsonObject& response) {
+    QString text;
+    const QJsonArray candidates = response.value("candidates").toArray();
+    if (candidates.isEmpty()) {
+        return text;
+    }
+
+    // Only the first candidate is requested; thought summaries are not part of the answer
+    const QJsonArray parts = candidates.first().toObject().value("content").toObject().value("parts").toArray();
+    for (const QJsonValue& part : parts) {
+        const QJsonObject object = part.toObject();
+        if (!object.value("thought").toBool()) {
+            text += object.value("text").toString();
+        }
+    }
+    return text;
+}
+
+QString GeminiStreamParser::parseEvent(const QByteArray& event) {
+    // An event may split its payload over several data: lines; comments and other fields are ignored
+    QByteArray payload;
+    for (const QByteArray& line : event.split('\n')) {
+        if (!line.startsWith("data:")) {
+            continue;
+        }
+        if (!payload.isEmpty()) {
+            payload += '\n';
+        }
+        payload += line.mid(line.startsWith("data: ") ? 6 : 5);
+    }
+    if (payload.isEmpty()) {
+        return QString();
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(payload, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !document.isObject()) {
+        m_errorMessage = "Malformed stream event: " + parseError.errorString();
+        return QString();
+    }
+
+    ++m_eventCount;
+    return parseChunk(document.object());
+}
+
+QString GeminiStreamParser::parseChunk(const QJsonObject& chunk) {
+    if (chunk.contains("error")) {
+        const QJsonObject error = chunk.value("error").toObject();
+        m_errorCode = error.value("code").toInt();
+        m_errorMessage = error.value("message").toString("Unknown streaming error");
+        // Quota errors say when to come back, as a protobuf duration such as "37s"
+        for (const QJsonValue& detail : error.value("details").toArray()) {
+            const QJsonObject object = detail.toObject();
+            const QString delay = object.value("retryDelay").toString();
+            if (object.value("@type").toString().endsWith("google.rpc.RetryInfo") && delay.endsWith('s')) {
+                m_retryDelayMs = qRound64(delay.chopped(1).toDouble() * 1000.0);
+            }
+        }
+        return QString();
+    }
+
+    const QJsonArray candidates = chunk.value("candidates").toArray();
+    if (!candidates.isEmpty()) {
+        const QString finishReason = candidates.first().toObject().value("finishReason").toString();
+        if (!finishReason.isEmpty()) {
+            m_finishReason = finishReason;
+        }
+    }
+    const QString blockReason = chunk.value("promptFeedback").toObject().value("blockReason").toString();
+    if (!blockReason.isEmpty()) {
+        m_blockReason = blockReason;
+    }
+    // Usage is cumulative; the last chunk carries the totals
+    if (chunk.contains("usageMetadata")) {
+        m_usageMetadata = chunk.value("usageMetadata").toObject();
+    }
+    if (chunk.contains("modelVersion")) {
+        m_modelVersion = chunk.value("modelVersion").toString();
+    }
+
+    const QString added = extractText(chunk);
+    m_text += added;
+    return added;
+}
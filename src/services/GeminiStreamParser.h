@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+
+/**
+ * @brief Incremental parser for Gemini streamGenerateContent responses (alt=sse)
+ *
+ * The response arrives as server-sent events, each carrying one
+ * GenerateContentResponse chunk as JSON. feed() takes bytes as they come off the
+ * socket, in pieces of any size, and returns the text the complete events in them
+ * added; a partial event waits in the buffer for the rest. finish() handles a last
+ * event the server did not terminate with a blank line.
+ *
+ * Besides the text the parser keeps what the final chunks report: finish reason,
+ * prompt block reason, token usage, and any error object sent mid-stream.
+ */
+class GeminiStreamParser {
+public:
+    QString feed(const QByteArray& data);
+    QString finish();
+    // A whole non-streamed generateContent response, or an error body, taken as one chunk
+    QString parseResponse(const QByteArray& body);
+    void reset();
+
+    QString text() const { return m_text; }
+    int eventCount() const { return m_eventCount; }
+
+    QString finishReason() const { return m_finishReason; }
+    QString blockReason() const { return m_blockReason; }
+    QJsonObject usageMetadata() const { return m_usageMetadata; }
+    QString modelVersion() const { return m_modelVersion; }
+
+    // Set when the stream carried an {"error": ...} object or an event that is not JSON
+    bool hasError() const { return !m_errorMessage.isEmpty(); }
+    int errorCode() const { return m_errorCode; }
+    QString errorMessage() const { return m_errorMessage; }
+    qint64 retryDelayMs() const { return m_retryDelayMs; } // From the error's RetryInfo, 0 if none
+
+    // Text of one non-streamed generateContent response, or of one stream chunk
+    static QString extractText(const QJsonObject& response);
+
+private:
+    QString parseEvent(const QByteArray& event);
+    QString parseChunk(const QJsonObject& chunk);
+
+    QByteArray m_buffer;
+    QString m_text;
+    int m_eventCount = 0;
+
+    QString m_finishReason;
+    QString m_blockReason;
+    QJsonObject m_usageMetadata;
+    QString m_modelVersion;
+
+    int m_errorCode = 0;
+    QString m_errorMessage;
+    qint64 m_retryDelayMs = 0;
+};
@@ -0,0 +1,250 @@
+#include "LocalLlmEngine.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+#ifdef QUILLSCRIBE_LOCAL_LLM
+#include <llama.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace {
+
+#ifdef QUILLSCRIBE_LOCAL_LLM
+bool abortCallback(void* userData) {
+    const auto* abortFlag = static_cast<const QAtomicInt*>(userData);
+    return abortFlag && abortFlag->loadRelaxed();
+}
+
+// Wraps the prompt in the model's own chat template as a single user turn
+QByteArray applyChatTemplate(const llama_model* model, const QByteArray& prompt) {
+    const char* chatTemplate = llama_model_chat_template(model, nullptr);
+    if (!chatTemplate) {
+        return prompt;
+    }
+    const llama_chat_message message{"user", prompt.constData()};
+    std::vector<char> formatted(prompt.size() * 2 + 256);
+    int length = llama_chat_apply_template(chatTemplate, &message, 1, true, formatted.data(),
+                                           static_cast<int>(formatted.size()));
+    if (length > static_cast<int>(formatted.size())) {
+        formatted.resize(length);
+        length = llama_chat_apply_template(chatTemplate, &message, 1, true, formatted.data(), length);
+    }
+    return length < 0 ? prompt : QByteArray(formatted.data(), length);
+}
+#endif
+
+} // namespace
+
+LocalLlmEngine::LocalLlmEngine()
+    : m_model(nullptr)
+    , m_threadCount(DEFAULT_THREAD_COUNT)
+{
+}
+
+LocalLlmEngine::~LocalLlmEngine() {
+    unload();
+}
+
+bool LocalLlmEngine::isCompiledIn() {
+#ifdef QUILLSCRIBE_LOCAL_LLM
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool LocalLlmEngine::load(const QString& modelPath, QString* errorMessage) {
+#ifdef QUILLSCRIBE_LOCAL_LLM
+    if (!QFileInfo::exists(modelPath)) {
+        *errorMessage = "Local model not found: " + modelPath;
+        return false;
+    }
+
+    static std::once_flag backendInitialized;
+    std::call_once(backendInitialized, [] { llama_backend_init(); });
+
+    // Loaded outside the lock; generations keep using the old model meanwhile
+    llama_model_params params = llama_model_default_params();
+    llama_model* model = llama_model_load_from_file(QFile::encodeName(modelPath).constData(), params);
+    if (!model) {
+        *errorMessage = "Cannot load local model: " + modelPath;
+        return false;
+    }
+
+    QWriteLocker locker(&m_lock);
+    if (m_model) {
+        llama_model_free(m_model);
+    }
+    m_model = model;
+    m_modelPath = modelPath;
+    return true;
+#else
+    Q_UNUSED(modelPath)
+    *errorMessage = "QuillScribe was built without local model support";
+    return false;
+#endif
+}
+
+void LocalLlmEngine::unload() {
+    QWriteLocker locker(&m_lock);
+#ifdef QUILLSCRIBE_LOCAL_LLM
+    if (m_model) {
+        llama_model_free(m_model);
+    }
+#endif
+    m_model = nullptr;
+    m_modelPath.clear();
+}
+
+bool LocalLlmEngine::isLoaded() const {
+    QReadLocker locker(&m_lock);
+    return m_model != nullptr;
+}
+
+QString LocalLlmEngine::modelPath() const {
+    QReadLocker locker(&m_lock);
+    return m_modelPath;
+}
+
+void LocalLlmEngine::setThreadCount(int threadCount) {
+    m_threadCount.storeRelaxed(qMax(1, threadCount));
+}
+
+int LocalLlmEngine::threadCount() const {
+    return m_threadCount.loadRelaxed();
+}
+
+bool LocalLlmEngine::generate(const QString& prompt, int maxTokens, float temperature, const QAtomicInt* abortFlag,
+                              const std::function<void(const QByteArray&)>& onText, QString* output,
+                              int* tokenCount, QString* errorMessage) {
+#ifdef QUILLSCRIBE_LOCAL_LLM
+    QReadLocker locker(&m_lock);
+    if (!m_model) {
+        *errorMessage = "No local model loaded";
+        return false;
+    }
+    const llama_vocab* vocab = llama_model_get_vocab(m_model);
+
+    const QByteArray formatted = applyChatTemplate(m_model, prompt.toUtf8());
+    std::vector<llama_token> tokens(formatted.size() + 16);
+    int promptTokens = llama_tokenize(vocab, formatted.constData(), static_cast<int>(formatted.size()),
+                                      tokens.data(), static_cast<int>(tokens.size()), true, true);
+    if (promptTokens < 0) {
+        tokens.resize(-promptTokens);
+        promptTokens = llama_tokenize(vocab, formatted.constData(), static_cast<int>(formatted.size()),
+                                      tokens.data(), static_cast<int>(tokens.size()), true, true);
+    }
+    maxTokens = qMin(maxTokens, MAX_CONTEXT_TOKENS - promptTokens);
+    if (promptTokens <= 0 || maxTokens <= 0) {
+        *errorMessage = "Text is too long for the local model";
+        return false;
+    }
+
+    // Sized to this request, and the whole prompt goes in as one batch
+    llama_context_params contextParams = llama_context_default_params();
+    contextParams.n_ctx = static_cast<uint32_t>(promptTokens + maxTokens);
+    contextParams.n_batch = static_cast<uint32_t>(promptTokens);
+    contextParams.n_threads = threadCount();
+    contextParams.n_threads_batch = threadCount();
+    contextParams.abort_callback = &abortCallback;
+    contextParams.abort_callback_data = const_cast<QAtomicInt*>(abortFlag);
+    contextParams.no_perf = true;
+    std::unique_ptr<llama_context, decltype(&llama_free)> context(llama_init_from_model(m_model, contextParams), &llama_free);
+    if (!context) {
+        *errorMessage = "Cannot create a local model context";
+        return false;
+    }
+
+    // Corrections want the likeliest wording; a little temperature only when asked for
+    std::unique_ptr<llama_sampler, decltype(&llama_sampler_free)> sampler(
+        llama_sampler_chain_init(llama_sampler_chain_default_params()), &llama_sampler_free);
+    if (temperature <= 0.0f) {
+        llama_sampler_chain_add(sampler.get(), llama_sampler_init_greedy());
+    } else {
+        llama_sampler_chain_add(sampler.get(), llama_sampler_init_top_k(40));
+        llama_sampler_chain_add(sampler.get(), llama_sampler_init_top_p(0.9f, 1));
+        llama_sampler_chain_add(sampler.get(), llama_sampler_init_temp(temperature));
+        llama_sampler_chain_add(sampler.get(), llama_sampler_init_dist(LLAMA_DEFAULT_SEED));
+    }
+
+    QByteArray bytes; // Pieces can split a UTF-8 sequence, so text is decoded from the whole
+    llama_token token = 0;
+    llama_batch batch = llama_batch_get_one(tokens.data(), promptTokens);
+    int generated = 0;
+    for (; generated < maxTokens; ++generated) {
+        if (llama_decode(context.get(), batch) != 0) {
+            *errorMessage = abortFlag && abortFlag->loadRelaxed() ? QString("Enhancement cancelled")
+                                                                  : QString("Local model failed to decode");
+            return false;
+        }
+        token = llama_sampler_sample(sampler.get(), context.get(), -1);
+        if (llama_vocab_is_eog(vocab, token)) {
+            break;
+        }
+
+        char piece[256];
+        const int length = llama_token_to_piece(vocab, token, piece, sizeof(piece), 0, false);
+        if (length > 0) {
+            bytes.append(piece, length);
+            onText(bytes);
+        }
+        batch = llama_batch_get_one(&token, 1);
+    }
+
+    *output = QString::fromUtf8(bytes).trimmed();
+    *tokenCount = promptTokens + generated;
+    return true;
+#else
+    Q_UNUSED(prompt)
+    Q_UNUSED(maxTokens)
+    Q_UNUSED(temperature)
+    Q_UNUSED(abortFlag)
+    Q_UNUSED(onText)
+    Q_UNUSED(output)
+    Q_UNUSED(tokenCount)
+    *errorMessage = "QuillScribe was built without local model support";
+    return false;
+#endif
+}
+
+LocalEnhancementTask::LocalEnhancementTask(const QSharedPointer<LocalLlmEngine>& engine, const QString& requestId,
+                                           const QString& prompt, int maxTokens, float temperature,
+                                           const QSharedPointer<QAtomicInt>& abortFlag)
+    : m_engine(engine)
+    , m_requestId(requestId)
+    , m_prompt(prompt)
+    , m_maxTokens(maxTokens)
+    , m_temperature(temperature)
+    , m_abortFlag(abortFlag)
+{
+    setAutoDelete(true);
+}
+
+void LocalEnhancementTask::run() {
+    if (m_abortFlag && m_abortFlag->loadRelaxed()) {
+        emit taskFailed(m_requestId, "Enhancement cancelled");
+        return;
+    }
+
+    int pieces = 0;
+    QString output;
+    int tokenCount = 0;
+    QString errorMessage;
+    const bool ok = m_engine->generate(m_prompt, m_maxTokens, m_temperature, m_abortFlag.data(),
+        [this, &pieces](const QByteArray& utf8) {
+            if (++pieces % PARTIAL_INTERVAL_TOKENS == 0) {
+                emit taskPartialText(m_requestId, QString::fromUtf8(utf8));
+            }
+        },
+        &output, &tokenCount, &errorMessage);
+
+    if (!ok) {
+        emit taskFailed(m_requestId, errorMessage);
+        return;
+    }
+    emit taskCompleted(m_requestId, output, tokenCount);
+}
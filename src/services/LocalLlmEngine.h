@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QReadWriteLock>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QString>
+#include <functional>
+
+struct llama_model;
+
+/**
+ * @brief In-process instruction model for offline and low-latency enhancement
+ *
+ * Loads one small quantized model (GGUF) through llama.cpp, which builds on the
+ * same ggml as whisper.cpp. The weights are shared read-only; every generation
+ * gets a llama_context of its own sized to its prompt, so concurrent requests never
+ * share a KV cache. A generation blocks its thread, so it is meant to run as a
+ * LocalEnhancementTask on a worker pool.
+ *
+ * Without QUILLSCRIBE_LOCAL_LLM the engine builds as a stub that never loads.
+ */
+class LocalLlmEngine {
+public:
+    LocalLlmEngine();
+    ~LocalLlmEngine();
+
+    static bool isCompiledIn();
+
+    // Replaces the loaded model once running generations are done with it
+    bool load(const QString& modelPath, QString* errorMessage);
+    void unload();
+    bool isLoaded() const;
+    QString modelPath() const;
+
+    void setThreadCount(int threadCount);
+    int threadCount() const;
+
+    // Blocking. @p onText gets the UTF-8 output so far after every token; generation stops
+    // early when @p abortFlag is raised. @p tokenCount receives prompt plus output tokens.
+    bool generate(const QString& prompt, int maxTokens, float temperature, const QAtomicInt* abortFlag,
+                  const std::function<void(const QByteArray&)>& onText, QString* output,
+                  int* tokenCount, QString* errorMessage);
+
+    static constexpr int MAX_CONTEXT_TOKENS = 4096;
+    static constexpr int DEFAULT_THREAD_COUNT = 4;
+
+private:
+    mutable QReadWriteLock m_lock; // Generations read the model; load and unload replace it
+    llama_model* m_model;
+    QString m_modelPath;
+    QAtomicInt m_threadCount;
+};
+
+/**
+ * @brief One local generation, run on a worker pool
+ *
+ * Results reach the service through queued signals, like TranscriptionTask. The task
+ * shares ownership of the engine, so it may still be queued when the service goes away.
+ */
+class LocalEnhancementTask : public QObject, public QRunnable {
+    Q_OBJECT
+
+public:
+    LocalEnhancementTask(const QSharedPointer<LocalLlmEngine>& engine, const QString& requestId,
+                         const QString& prompt, int maxTokens, float temperature,
+                         const QSharedPointer<QAtomicInt>& abortFlag);
+    void run() override;
+
+    static constexpr int PARTIAL_INTERVAL_TOKENS = 8; // Tokens between partial results
+
+signals:
+    void taskPartialText(const QString& requestId, const QString& text);
+    void taskCompleted(const QString& requestId, const QString& text, int tokenCount);
+    void taskFailed(const QString& requestId, const QString& errorMessage);
+
+private:
+    QSharedPointer<LocalLlmEngine> m_engine;
+    QString m_requestId;
+    QString m_prompt;
+    int m_maxTokens;
+    float m_temperature;
+    QSharedPointer<QAtomicInt> m_abortFlag;
+};
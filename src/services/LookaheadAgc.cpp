@@ -0,0 +1,113 @@
+#include "LookaheadAgc.h"
+#include <algorithm>
+#include <cmath>
+
+LookaheadAgc::LookaheadAgc()
+    : m_sampleRate(0)
+    , m_channelCount(1)
+    , m_blockFrames(0)
+    , m_enabled(true)
+    , m_manualGain(1.0f)
+    , m_levelCoefficient(0.0f)
+    , m_releaseFactor(1.0f)
+    , m_blockPos(0)
+    , m_currentPeak(0.0f)
+    , m_currentPower(0.0f)
+    , m_speechPower(0.0f)
+    , m_gain(1.0f)
+{
+    configure(16000, 1);
+}
+
+void LookaheadAgc::configure(int sampleRate, int channelCount) {
+    m_sampleRate = qMax(1, sampleRate);
+    m_channelCount = qMax(1, channelCount);
+    m_blockFrames = qMax(1, m_sampleRate * BLOCK_MS / 1000);
+
+    const double blockSeconds = static_cast<double>(m_blockFrames) / m_sampleRate;
+    m_levelCoefficient = static_cast<float>(1.0 - std::exp(-blockSeconds * 1000.0 / LEVEL_WINDOW_MS));
+    m_releaseFactor = static_cast<float>(std::pow(10.0, RELEASE_DB_PER_SECOND * blockSeconds / 20.0));
+
+    const int samples = m_blockFrames * m_channelCount;
+    m_next.resize(samples);
+    m_current.resize(samples);
+    m_ready.resize(samples);
+    reset();
+}
+
+void LookaheadAgc::reset() {
+    std::fill(m_next.begin(), m_next.end(), 0.0f);
+    std::fill(m_current.begin(), m_current.end(), 0.0f);
+    std::fill(m_ready.begin(), m_ready.end(), 0.0f);
+    m_blockPos = 0;
+    m_currentPeak = 0.0f;
+    m_currentPower = 0.0f;
+    m_speechPower = TARGET_RMS * TARGET_RMS; // Unity gain until speech has been heard
+    m_gain = m_manualGain;
+}
+
+void LookaheadAgc::process(float* interleaved, int frames) {
+    const int channels = m_channelCount;
+    for (int frame = 0; frame < frames; ++frame) {
+        float* samples = interleaved + frame * channels;
+        float* next = m_next.data() + m_blockPos * channels;
+        const float* ready = m_ready.constData() + m_blockPos * channels;
+        for (int c = 0; c < channels; ++c) {
+            next[c] = samples[c];
+            samples[c] = ready[c];
+        }
+        if (++m_blockPos == m_blockFrames) {
+            processBlock();
+            m_blockPos = 0;
+        }
+    }
+}
+
+void LookaheadAgc::processBlock() {
+    float nextPeak = 0.0f;
+    double nextEnergy = 0.0;
+    for (float sample : m_next) {
+        nextPeak = std::max(nextPeak, std::fabs(sample));
+        nextEnergy += static_cast<double>(sample) * sample;
+    }
+    const float nextPower = static_cast<float>(nextEnergy / m_next.size());
+
+    // Gated level tracking: silence keeps the gain where speech left it
+    if (m_currentPower > GATE_LEVEL * GATE_LEVEL) {
+        m_speechPower += m_levelCoefficient * (m_currentPower - m_speechPower);
+    }
+
+    float desired = m_manualGain;
+    if (m_enabled) {
+        desired *= qBound(MIN_GAIN, TARGET_RMS / std::sqrt(std::max(m_speechPower, 1e-12f)), MAX_GAIN);
+    }
+    float target = desired < m_gain ? desired : std::min(desired, m_gain * m_releaseFactor);
+
+    // Both ends of the ramp stay under the limit for this block and the next
+    const float peak = std::max(m_currentPeak, nextPeak);
+    if (peak > 0.0f) {
+        target = std::min(target, PEAK_LIMIT / peak);
+    }
+    float start = m_gain;
+    if (m_currentPeak > 0.0f) {
+        start = std::min(start, PEAK_LIMIT / m_currentPeak);
+    }
+
+    const int channels = m_channelCount;
+    const float step = (target - start) / m_blockFrames;
+    const float* current = m_current.constData();
+    float* ready = m_ready.data();
+    float gain = start;
+    for (int frame = 0; frame < m_blockFrames; ++frame) {
+        gain += step;
+        for (int c = 0; c < channels; ++c) {
+            const int i = frame * channels + c;
+            ready[i] = current[i] * gain;
+        }
+    }
+    m_gain = target;
+
+    m_current.swap(m_next);
+    m_currentPeak = nextPeak;
+    m_currentPower = nextPower;
+}
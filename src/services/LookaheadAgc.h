@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief LookaheadAgc - Block-based automatic gain control with a look-ahead limiter
+ *
+ * Works on interleaved float frames in blocks of BLOCK_MS with all channels linked.
+ * The speech level is tracked only on blocks above GATE_LEVEL, so pauses are not
+ * pumped up into audible noise, and the gain moves towards TARGET_RMS within
+ * [MIN_GAIN, MAX_GAIN] - downwards at once, upwards at RELEASE_DB_PER_SECOND.
+ * One block of look-ahead lets the gain ramp down before a peak instead of
+ * clipping it: each block is ramped linearly between gains that keep both it
+ * and the following block under PEAK_LIMIT.
+ *
+ * With AGC disabled the stage applies just the manual gain, through the same
+ * path and delay. process() works in place and delays by latency() frames.
+ */
+class LookaheadAgc {
+public:
+    LookaheadAgc();
+
+    void configure(int sampleRate, int channelCount);
+    void reset();
+
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+    bool isEnabled() const { return m_enabled; }
+    // Applied on top of the automatic gain
+    void setManualGain(float gain) { m_manualGain = gain; }
+
+    void process(float* interleaved, int frames);
+
+    int blockFrames() const { return m_blockFrames; }
+    int latency() const { return 2 * m_blockFrames; }
+    float currentGain() const { return m_gain; }
+
+    static constexpr int BLOCK_MS = 10;
+    static constexpr float TARGET_RMS = 0.1f;          // -20 dBFS speech level
+    static constexpr float GATE_LEVEL = 0.00316f;      // -50 dBFS; quieter blocks hold the level
+    static constexpr float MIN_GAIN = 0.25f;
+    static constexpr float MAX_GAIN = 10.0f;            // +20 dB
+    static constexpr float PEAK_LIMIT = 0.98f;
+    static constexpr int LEVEL_WINDOW_MS = 400;         // Speech level averaging time
+    static constexpr float RELEASE_DB_PER_SECOND = 6.0f;
+
+private:
+    void processBlock();
+
+    int m_sampleRate;
+    int m_channelCount;
+    int m_blockFrames;
+    bool m_enabled;
+    float m_manualGain;
+    float m_levelCoefficient;   // Per-block smoothing of the speech power
+    float m_releaseFactor;      // Per-block upper bound of gain growth
+
+    QVector<float> m_next;      // Block being collected (the look-ahead)
+    QVector<float> m_current;   // Block gained once m_next is complete
+    QVector<float> m_ready;     // Gained block, read out while the next one fills
+    int m_blockPos;
+
+    float m_currentPeak;
+    float m_currentPower;
+    float m_speechPower;
+    float m_gain;               // Gain reached at the end of the last block
+};
@@ -0,0 +1,214 @@
+#include "MigrationRunner.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <QSqlError>
+#include <limits>
+#include <memory>
+
+namespace {
+
+QList<SqliteWriter::Statement> rangeStatements(const MigrationRunner::Backfill& backfill, qint64 after, qint64 last) {
+    QList<SqliteWriter::Statement> statements;
+    for (const QString& update : backfill.rangeUpdates) {
+        statements.append({update, {after, last}, {}});
+    }
+    return statements;
+}
+
+} // namespace
+
+MigrationRunner::MigrationRunner(SqliteWriter* writer, ConnectionPool* readers)
+    : m_writer(writer)
+    , m_readers(readers)
+    , m_thread(nullptr)
+    , m_stopping(false)
+{
+}
+
+MigrationRunner::~MigrationRunner() {
+    stop();
+}
+
+bool MigrationRunner::start(const QList<Backfill>& backfills, QObject* context, Progress progress, Completion done) {
+    if (isRunning() || backfills.isEmpty()) {
+        return false;
+    }
+    stop(); // Reaps a finished run
+
+    m_context = context;
+    m_progress = std::move(progress);
+    m_done = std::move(done);
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = false;
+    }
+
+    m_thread = QThread::create([this, backfills]() { run(backfills); });
+    m_thread->setObjectName("MigrationRunner");
+    m_thread->start(QThread::LowPriority);
+    return true;
+}
+
+void MigrationRunner::stop() {
+    if (!m_thread) {
+        return;
+    }
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+    }
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+bool MigrationRunner::isRunning() const {
+    return m_thread && !m_thread->isFinished();
+}
+
+QString MigrationRunner::cursorKey(int version) {
+    return QString("backfill_%1").arg(version);
+}
+
+QString MigrationRunner::cursorKey(const QString& name) {
+    return "backfill_" + name;
+}
+
+QString MigrationRunner::cursorKey(const Backfill& backfill) {
+    return backfill.version > 0 ? cursorKey(backfill.version) : cursorKey(backfill.name);
+}
+
+QString MigrationRunner::describe(const Backfill& backfill) {
+    return backfill.version > 0 ? QString("schema version %1").arg(backfill.version) : backfill.name;
+}
+
+bool MigrationRunner::stopping() const {
+    QMutexLocker locker(&m_mutex);
+    return m_stopping;
+}
+
+void MigrationRunner::run(const QList<Backfill>& backfills) {
+    for (const Backfill& backfill : backfills) {
+        QString errorMessage;
+        const bool ok = runBackfill(backfill, &errorMessage);
+        if (stopping()) {
+            return; // Resumes from the cursor next time; not a failure
+        }
+        if (m_done && m_context) {
+            const Completion done = m_done;
+            QMetaObject::invokeMethod(m_context.data(), [done, backfill, ok, errorMessage]() {
+                done(backfill, ok, errorMessage);
+            }, Qt::QueuedConnection);
+        }
+        if (!ok) {
+            return; // Later backfills may depend on this one
+        }
+    }
+}
+
+bool MigrationRunner::runBackfill(const Backfill& backfill, QString* errorMessage) {
+    const QString key = cursorKey(backfill);
+    qint64 cursor = 0;
+    qint64 lastRowId = 0;
+    {
+        QSqlQuery query(m_readers->database());
+        query.prepare("SELECT value FROM metadata WHERE key = ?");
+        query.addBindValue(key);
+        if (!query.exec()) {
+            *errorMessage = query.lastError().text();
+            return false;
+        }
+        if (!query.next()) {
+            return true; // Finished before
+        }
+        cursor = query.value(0).toLongLong();
+        // The rowid range stands in for a row count, which would need a full scan
+        if (query.exec(QString("SELECT coalesce(max(rowid), 0) FROM %1").arg(backfill.table)) && query.next()) {
+            lastRowId = query.value(0).toLongLong();
+        }
+    }
+    qDebug() << "Backfilling" << describe(backfill) << "on" << backfill.table << "from row" << cursor;
+
+    const QString select = QString("SELECT rowid, %1 FROM %2 WHERE rowid > ? ORDER BY rowid LIMIT ?")
+                               .arg(backfill.columns, backfill.table);
+    while (!stopping()) {
+        QList<SqliteWriter::Statement> rewritten;
+        for (const QString& update : backfill.updates) {
+            rewritten.append({update, {}, {}});
+        }
+        qint64 batchEnd = cursor;
+        {
+            auto rows = m_readers->statements().prepare(select);
+            rows->addBindValue(cursor);
+            rows->addBindValue(BATCH_ROWS);
+            if (!rows->exec()) {
+                *errorMessage = rows->lastError().text();
+                return false;
+            }
+            while (rows->next()) {
+                batchEnd = rows->value(0).toLongLong();
+                if (!backfill.rewrite) {
+                    continue;
+                }
+                if (std::optional<QVariantList> values = backfill.rewrite(*rows)) {
+                    for (SqliteWriter::Statement& statement : rewritten) {
+                        statement.rows.append(*values);
+                    }
+                }
+            }
+        }
+        if (batchEnd == cursor) {
+            // Past the last row
+            QList<SqliteWriter::Statement> statements =
+                rangeStatements(backfill, cursor, std::numeric_limits<qint64>::max());
+            statements.append({"DELETE FROM metadata WHERE key = ?", {key}, {}});
+            return commit(statements, errorMessage);
+        }
+
+        QList<SqliteWriter::Statement> statements;
+        if (!rewritten.isEmpty() && !rewritten.first().rows.isEmpty()) {
+            statements = rewritten;
+        }
+        statements += rangeStatements(backfill, cursor, batchEnd);
+        statements.append({"INSERT OR REPLACE INTO metadata (key, value, updated_at) VALUES (?, ?, CURRENT_TIMESTAMP)",
+                           {key, QString::number(batchEnd)}, {}});
+        if (!commit(statements, errorMessage)) {
+            return false;
+        }
+
+        cursor = batchEnd;
+        if (m_progress && m_context) {
+            const Progress progress = m_progress;
+            const qint64 total = qMax(lastRowId, cursor);
+            QMetaObject::invokeMethod(m_context.data(), [progress, backfill, cursor, total]() {
+                progress(backfill, cursor, total);
+            }, Qt::QueuedConnection);
+        }
+    }
+    return true;
+}
+
+bool MigrationRunner::commit(const QList<SqliteWriter::Statement>& statements, QString* errorMessage) {
+    // The completion runs on the writer thread after waitForWrite() may already have
+    // returned, so wait for the completion itself
+    struct Outcome {
+        QSemaphore done;
+        bool ok = false;
+        QString errorMessage;
+    };
+    auto outcome = std::make_shared<Outcome>();
+    m_writer->enqueue(statements, nullptr, [outcome](bool ok, const QString& error) {
+        outcome->ok = ok;
+        outcome->errorMessage = error;
+        outcome->done.release();
+    });
+    if (!outcome->done.tryAcquire(1, SqliteWriter::DEFAULT_WAIT_MS)) {
+        *errorMessage = "Timed out waiting for a backfill batch to commit";
+        return false;
+    }
+    if (!outcome->ok) {
+        *errorMessage = outcome->errorMessage;
+    }
+    return outcome->ok;
+}
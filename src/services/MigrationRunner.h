@@ -0,0 +1,82 @@
+#pragma once
+
+#include "ConnectionPool.h"
+#include "SqliteWriter.h"
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QSqlQuery>
+#include <QVariantList>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <functional>
+#include <optional>
+
+/**
+ * @brief MigrationRunner - Backfills migrated tables in bounded batches on a background thread
+ *
+ * A schema migration applies its DDL at startup, which SQLite does in constant time
+ * (ADD COLUMN does not rewrite the table), and leaves the row rewrite to a backfill.
+ * The runner reads BATCH_ROWS rows at a time in rowid order on its own read
+ * connection and queues the rewritten rows to the writer together with the backfill's
+ * cursor (metadata key "backfill_<version>", or "backfill_<name>" for a backfill outside
+ * the schema history), so each batch commits atomically with
+ * the position reached. The GUI's writes interleave with the batches, and a backfill
+ * interrupted by shutdown or a crash resumes from its cursor on the next start.
+ * Finishing a backfill deletes its cursor.
+ *
+ * Code reading a migrated table must accept rows the backfill has not reached yet.
+ */
+class MigrationRunner {
+public:
+    struct Backfill {
+        int version = 0;    // Schema version it completes; 0 when not part of a migration
+        QString name;       // Names the cursor when version is 0
+        QString table;
+        QString columns;    // Read after the rowid, in this order
+        QStringList updates; // Each run once per rewritten row, batched, in this order
+        // Bind values for every statement in @p updates, or nothing when the row needs no rewrite
+        std::function<std::optional<QVariantList>(const QSqlQuery& row)> rewrite;
+        // Each run once per batch, bound to its rowid range (after, last]. The final
+        // range is open-ended and commits with the cursor's removal, so rows written
+        // while the backfill ran are covered too.
+        QStringList rangeUpdates;
+    };
+    using Progress = std::function<void(const Backfill& backfill, qint64 rowsDone, qint64 rowsTotal)>;
+    using Completion = std::function<void(const Backfill& backfill, bool ok, const QString& errorMessage)>;
+
+    MigrationRunner(SqliteWriter* writer, ConnectionPool* readers);
+    ~MigrationRunner();
+
+    // Runs @p backfills one after another; callbacks run on the thread of @p context
+    bool start(const QList<Backfill>& backfills, QObject* context, Progress progress, Completion done);
+    // Stops after the batch in flight; the cursor keeps the position for the next start
+    void stop();
+    bool isRunning() const;
+
+    static QString cursorKey(int version);
+    static QString cursorKey(const QString& name);
+    static QString cursorKey(const Backfill& backfill);
+    // "schema version <version>", or the name
+    static QString describe(const Backfill& backfill);
+
+    static constexpr int BATCH_ROWS = 500;
+
+private:
+    void run(const QList<Backfill>& backfills);
+    bool runBackfill(const Backfill& backfill, QString* errorMessage);
+    bool commit(const QList<SqliteWriter::Statement>& statements, QString* errorMessage);
+    bool stopping() const;
+
+    SqliteWriter* m_writer;
+    ConnectionPool* m_readers;
+    QThread* m_thread;
+    QPointer<QObject> m_context;
+    Progress m_progress;
+    Completion m_done;
+
+    mutable QMutex m_mutex;
+    bool m_stopping;
+};
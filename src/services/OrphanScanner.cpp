@@ -0,0 +1,235 @@
+#include "OrphanScanner.h"
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+OrphanScanner::OrphanScanner()
+    : m_listed(0)
+    , m_skipped(0)
+    , m_knownLoaded(false)
+    , m_knownChanged(false)
+{
+    m_pool.setMaxThreadCount(MAX_THREADS);
+    m_pool.setObjectName("OrphanScanner");
+}
+
+OrphanScanner::~OrphanScanner() {
+    m_pool.waitForDone();
+}
+
+void OrphanScanner::setRoot(const QString& directory) {
+    QMutexLocker scanLocker(&m_scanMutex);
+    QMutexLocker locker(&m_mutex);
+    m_root = normalizedPath(directory);
+    m_listings.clear();
+}
+
+void OrphanScanner::setKnownFilesLoader(KnownFilesLoader loader) {
+    QMutexLocker locker(&m_mutex);
+    m_loader = std::move(loader);
+    m_knownLoaded = false;
+}
+
+void OrphanScanner::setKnownFiles(const QString& recordingId, const QStringList& files) {
+    QMutexLocker locker(&m_mutex);
+    if (!m_knownLoaded) {
+        m_knownChanged = true; // A load in progress may have read too early
+        return;
+    }
+    addKnownFiles(m_filesByRecording.value(recordingId), -1);
+    QStringList normalized;
+    for (const QString& file : files) {
+        if (!file.isEmpty()) {
+            normalized.append(normalizedPath(file));
+        }
+    }
+    m_filesByRecording.insert(recordingId, normalized);
+    addKnownFiles(normalized, 1);
+}
+
+void OrphanScanner::forgetRecording(const QString& recordingId) {
+    QMutexLocker locker(&m_mutex);
+    if (!m_knownLoaded) {
+        m_knownChanged = true;
+        return;
+    }
+    addKnownFiles(m_filesByRecording.take(recordingId), -1);
+}
+
+void OrphanScanner::invalidateKnownFiles() {
+    QMutexLocker locker(&m_mutex);
+    m_knownLoaded = false;
+    m_filesByRecording.clear();
+    m_knownFiles.clear();
+}
+
+OrphanScanner::Result OrphanScanner::scan() {
+    QMutexLocker scanLocker(&m_scanMutex);
+    QElapsedTimer timer;
+    timer.start();
+
+    QString root;
+    {
+        QMutexLocker locker(&m_mutex);
+        root = m_root;
+    }
+    Result result;
+    if (root.isEmpty() || !QFileInfo(root).isDir()) {
+        return result;
+    }
+
+    ensureKnownFilesLoaded();
+
+    {
+        QMutexLocker locker(&m_visitMutex);
+        m_visited.clear();
+        m_foundFiles.clear();
+        m_listed = 0;
+        m_skipped = 0;
+    }
+    visit(root);
+    m_pool.waitForDone(); // Includes the subdirectories visits queue as they go
+
+    QStringList found;
+    {
+        QMutexLocker locker(&m_visitMutex);
+        // Forget directories that are gone
+        for (auto it = m_listings.begin(); it != m_listings.end();) {
+            it = m_visited.contains(it.key()) ? std::next(it) : m_listings.erase(it);
+        }
+        found.swap(m_foundFiles);
+        result.directoriesListed = m_listed;
+        result.directoriesSkipped = m_skipped;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    for (const QString& file : std::as_const(found)) {
+        if (!m_knownFiles.contains(file)) {
+            result.orphanedFiles.append(file);
+        }
+    }
+    locker.unlock();
+
+    // Sizes are read fresh: a listing can be reused while its files grew
+    result.orphanedFiles.sort();
+    for (const QString& file : std::as_const(result.orphanedFiles)) {
+        result.reclaimableBytes += QFileInfo(file).size();
+    }
+    result.elapsedMs = timer.elapsed();
+
+    locker.relock();
+    m_lastResult = result;
+    return result;
+}
+
+OrphanScanner::Result OrphanScanner::lastResult() const {
+    QMutexLocker locker(&m_mutex);
+    return m_lastResult;
+}
+
+bool OrphanScanner::isAudioFile(const QString& fileName) {
+    static const QStringList suffixes = {"wav", "flac", "mp3", "m4a", "ogg", "opus"};
+    return suffixes.contains(QFileInfo(fileName).suffix(), Qt::CaseInsensitive);
+}
+
+void OrphanScanner::visit(const QString& directory) {
+    m_pool.start([this, directory]() {
+        // mtime before the listing, so a change made while listing shows up next time
+        const qint64 modifiedMs = QFileInfo(directory).lastModified().toMSecsSinceEpoch();
+
+        DirectoryListing listing;
+        bool reused = false;
+        {
+            QMutexLocker locker(&m_visitMutex);
+            if (m_visited.contains(directory)) {
+                return; // Reached twice through a bind mount or similar
+            }
+            m_visited.insert(directory, true);
+            auto it = m_listings.constFind(directory);
+            if (it != m_listings.constEnd() && it->modifiedMs == modifiedMs) {
+                listing = *it;
+                reused = true;
+            }
+        }
+
+        if (!reused) {
+            listing.modifiedMs = modifiedMs;
+            const QFileInfoList entries = QDir(directory).entryInfoList(
+                QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks | QDir::Hidden);
+            for (const QFileInfo& entry : entries) {
+                if (entry.isDir()) {
+                    listing.subdirectories.append(entry.absoluteFilePath());
+                } else if (isAudioFile(entry.fileName())) {
+                    listing.audioFiles.append(entry.absoluteFilePath());
+                }
+            }
+        }
+
+        {
+            QMutexLocker locker(&m_visitMutex);
+            m_foundFiles += listing.audioFiles;
+            if (reused) {
+                ++m_skipped;
+            } else {
+                ++m_listed;
+                m_listings.insert(directory, listing);
+            }
+        }
+
+        // A subdirectory's own mtime decides whether it is listed again
+        for (const QString& subdirectory : std::as_const(listing.subdirectories)) {
+            visit(subdirectory);
+        }
+    });
+}
+
+void OrphanScanner::ensureKnownFilesLoaded() {
+    KnownFilesLoader loader;
+    QHash<QString, QStringList> filesByRecording;
+    for (int attempt = 0; attempt < MAX_LOAD_ATTEMPTS; ++attempt) {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_knownLoaded || !m_loader) {
+                return;
+            }
+            if (attempt > 0 && !m_knownChanged) {
+                break;
+            }
+            loader = m_loader;
+            m_knownChanged = false;
+        }
+        filesByRecording = loader();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_filesByRecording.clear();
+    m_knownFiles.clear();
+    m_knownLoaded = true;
+    for (auto it = filesByRecording.constBegin(); it != filesByRecording.constEnd(); ++it) {
+        QStringList normalized;
+        for (const QString& file : it.value()) {
+            if (!file.isEmpty()) {
+                normalized.append(normalizedPath(file));
+            }
+        }
+        m_filesByRecording.insert(it.key(), normalized);
+        addKnownFiles(normalized, 1);
+    }
+}
+
+void OrphanScanner::addKnownFiles(const QStringList& files, int delta) {
+    for (const QString& file : files) {
+        const int count = m_knownFiles.value(file) + delta;
+        if (count > 0) {
+            m_knownFiles.insert(file, count);
+        } else {
+            m_knownFiles.remove(file);
+        }
+    }
+}
+
+QString OrphanScanner::normalizedPath(const QString& path) {
+    return QDir::cleanPath(QFileInfo(path).absoluteFilePath());
+}
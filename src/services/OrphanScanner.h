@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <functional>
+
+/**
+ * @brief OrphanScanner - Finds audio files in the recordings directory that no recording owns
+ *
+ * Directories are listed in parallel on a small thread pool. Each directory's
+ * modification time is remembered with its listing; a directory whose mtime has not
+ * changed since the last scan is not listed again (adding, removing or renaming an
+ * entry always bumps it), so a repeat scan of an unchanged archive costs one stat per
+ * directory. The files recordings refer to, including segment files, are held in a
+ * hash set that the storage updates as it writes, loaded once through the loader.
+ *
+ * scan() blocks and may be called from any thread; concurrent calls run one at a time.
+ */
+class OrphanScanner {
+public:
+    struct Result {
+        QStringList orphanedFiles;
+        qint64 reclaimableBytes = 0;
+        int directoriesListed = 0;      // New or changed since the last scan
+        int directoriesSkipped = 0;     // Unchanged, listing reused
+        qint64 elapsedMs = 0;
+    };
+    // Every recording's files, by recording id
+    using KnownFilesLoader = std::function<QHash<QString, QStringList>()>;
+
+    OrphanScanner();
+    ~OrphanScanner();
+
+    void setRoot(const QString& directory);
+    void setKnownFilesLoader(KnownFilesLoader loader);
+
+    // Kept current by the storage as it writes
+    void setKnownFiles(const QString& recordingId, const QStringList& files);
+    void forgetRecording(const QString& recordingId);
+    void invalidateKnownFiles();    // Reloaded on the next scan
+
+    Result scan();
+    Result lastResult() const;
+
+    static bool isAudioFile(const QString& fileName);
+
+    static constexpr int MAX_THREADS = 4;
+    static constexpr int MAX_LOAD_ATTEMPTS = 3;    // Reloads while writes keep racing the load
+
+private:
+    struct DirectoryListing {
+        qint64 modifiedMs = -1;
+        QStringList audioFiles;
+        QStringList subdirectories;
+    };
+
+    void visit(const QString& directory);
+    void ensureKnownFilesLoaded();
+    void addKnownFiles(const QStringList& files, int delta);
+    static QString normalizedPath(const QString& path);
+
+    QMutex m_scanMutex;             // One scan at a time
+    QThreadPool m_pool;
+
+    // Shared by the visiting tasks of a scan
+    QMutex m_visitMutex;
+    QHash<QString, DirectoryListing> m_listings;
+    QHash<QString, bool> m_visited;
+    QStringList m_foundFiles;
+    int m_listed;
+    int m_skipped;
+
+    mutable QMutex m_mutex;         // Everything below
+    QString m_root;
+    KnownFilesLoader m_loader;
+    bool m_knownLoaded;
+    bool m_knownChanged;        // A write arrived while the known files were loading
+    QHash<QString, QStringList> m_filesByRecording;
+    QHash<QString, int> m_knownFiles;   // Path -> number of recordings referring to it
+    Result m_lastResult;
+};
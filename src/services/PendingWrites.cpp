@@ -0,0 +1,48 @@
+#include "PendingWrites.h"
+#include "SqliteWriter.h"
+#include <QMutexLocker>
+
+PendingWrites::PendingWrites(SqliteWriter* writer)
+    : m_writer(writer)
+{
+}
+
+void PendingWrites::note(const QString& key, quint64 sequence) {
+    note(QStringList{key}, sequence);
+}
+
+void PendingWrites::note(const QStringList& keys, quint64 sequence) {
+    if (sequence == 0) {
+        return; // Not queued, or held by a group, which cannot be waited for by sequence
+    }
+
+    QMutexLocker locker(&m_mutex);
+    for (const QString& key : keys) {
+        m_sequences.insert(key, sequence);
+    }
+    if (m_sequences.size() > PRUNE_THRESHOLD) {
+        const quint64 committed = m_writer->committedSequence();
+        m_sequences.removeIf([committed](QHash<QString, quint64>::iterator it) {
+            return it.value() <= committed;
+        });
+    }
+}
+
+bool PendingWrites::waitFor(const QString& key) const {
+    quint64 sequence = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        sequence = m_sequences.value(key);
+    }
+    if (sequence == 0) {
+        return true;
+    }
+
+    const bool ok = m_writer->waitForWrite(sequence);
+    QMutexLocker locker(&m_mutex);
+    // A later write of the same key keeps its entry
+    if (m_sequences.value(key) == sequence && m_writer->committedSequence() >= sequence) {
+        m_sequences.remove(key);
+    }
+    return ok;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+class SqliteWriter;
+
+/**
+ * @brief PendingWrites - Last queued write per entity key
+ *
+ * Storage classes note the sequence number of every write against the keys it
+ * touches (row ids, or "recording:<id>" for rows found by recording). A point read
+ * then waits for the last write of its own key only, instead of for everything
+ * queued; reads of keys nobody wrote return at once. Listings do not wait: their
+ * consumers refresh on the storage signals, which are emitted after the commit.
+ * Safe to use from any thread.
+ */
+class PendingWrites {
+public:
+    explicit PendingWrites(SqliteWriter* writer);
+
+    void note(const QString& key, quint64 sequence);
+    void note(const QStringList& keys, quint64 sequence);
+
+    // False if that write failed or did not commit in time
+    bool waitFor(const QString& key) const;
+
+    static constexpr int PRUNE_THRESHOLD = 256; // Committed entries are dropped beyond this
+
+private:
+    SqliteWriter* m_writer;
+    mutable QMutex m_mutex;
+    mutable QHash<QString, quint64> m_sequences;
+};
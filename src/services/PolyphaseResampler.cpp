@@ -0,0 +1,168 @@
+#include "PolyphaseResampler.h"
+#include <cmath>
+#include <numeric>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QUILLSCRIBE_RESAMPLER_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define QUILLSCRIBE_RESAMPLER_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr double KAISER_BETA = 8.6;      // ~-90 dB stopband
+constexpr double CUTOFF_SCALE = 0.90;    // Passband edge relative to the lower Nyquist
+constexpr double PI = 3.14159265358979323846;
+
+// Zeroth-order modified Bessel function, for the Kaiser window
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+float dotProduct(const float* a, const float* b, int count) {
+    int i = 0;
+    float result = 0.0f;
+#if defined(QUILLSCRIBE_RESAMPLER_SSE2)
+    __m128 sum = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, sum);
+    result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(QUILLSCRIBE_RESAMPLER_NEON)
+    float32x4_t sum = vdupq_n_f32(0.0f);
+    for (; i + 4 <= count; i += 4) {
+        sum = vmlaq_f32(sum, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, sum);
+    result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < count; ++i) {
+        result += a[i] * b[i];
+    }
+    return result;
+}
+
+} // namespace
+
+PolyphaseResampler::PolyphaseResampler(int inputRate, int outputRate)
+    : m_inputRate(0)
+    , m_outputRate(0)
+    , m_upFactor(1)
+    , m_downFactor(1)
+    , m_inputIndex(0)
+    , m_phase(0)
+{
+    configure(inputRate, outputRate);
+}
+
+void PolyphaseResampler::configure(int inputRate, int outputRate) {
+    m_inputRate = qMax(1, inputRate);
+    m_outputRate = qMax(1, outputRate);
+
+    const int divisor = std::gcd(m_inputRate, m_outputRate);
+    m_upFactor = m_outputRate / divisor;
+    m_downFactor = m_inputRate / divisor;
+
+    designFilter();
+    reset();
+}
+
+void PolyphaseResampler::reset() {
+    // Start with TAPS_PER_PHASE - 1 samples of silence under the filter
+    m_history = QVector<float>(TAPS_PER_PHASE - 1, 0.0f);
+    m_inputIndex = TAPS_PER_PHASE - 1;
+    m_phase = 0;
+}
+
+void PolyphaseResampler::designFilter() {
+    m_coefficients.clear();
+    if (isPassthrough()) {
+        return;
+    }
+
+    // Prototype low-pass at the upsampled rate, cut below the lower of the two Nyquists
+    const int length = m_upFactor * TAPS_PER_PHASE;
+    const double cutoff = 0.5 * CUTOFF_SCALE / qMax(m_upFactor, m_downFactor);
+    const double center = (length - 1) / 2.0;
+    const double windowNorm = besselI0(KAISER_BETA);
+
+    QVector<double> prototype(length);
+    for (int k = 0; k < length; ++k) {
+        const double t = k - center;
+        const double sinc = t == 0.0 ? 1.0 : std::sin(2.0 * PI * cutoff * t) / (2.0 * PI * cutoff * t);
+        const double ratio = t / center;
+        const double window = besselI0(KAISER_BETA * std::sqrt(qMax(0.0, 1.0 - ratio * ratio))) / windowNorm;
+        // Gain of L makes up for the zeros the upsampler inserts
+        prototype[k] = 2.0 * cutoff * m_upFactor * sinc * window;
+    }
+
+    // Phase p uses taps p, p + L, p + 2L, ...; stored oldest-sample-first
+    m_coefficients.resize(length);
+    for (int phase = 0; phase < m_upFactor; ++phase) {
+        float* taps = m_coefficients.data() + phase * TAPS_PER_PHASE;
+        for (int j = 0; j < TAPS_PER_PHASE; ++j) {
+            taps[TAPS_PER_PHASE - 1 - j] = static_cast<float>(prototype[phase + j * m_upFactor]);
+        }
+    }
+}
+
+void PolyphaseResampler::process(const float* input, qint64 count, QVector<float>& output) {
+    if (!input || count <= 0) {
+        return;
+    }
+    if (isPassthrough()) {
+        output.reserve(output.size() + count);
+        for (qint64 i = 0; i < count; ++i) {
+            output.append(input[i]);
+        }
+        return;
+    }
+
+    m_history.reserve(m_history.size() + count);
+    for (qint64 i = 0; i < count; ++i) {
+        m_history.append(input[i]);
+    }
+    output.reserve(output.size() + count * m_upFactor / m_downFactor + 1);
+
+    const float* samples = m_history.constData();
+    const float* coefficients = m_coefficients.constData();
+    while (m_inputIndex < m_history.size()) {
+        output.append(dotProduct(coefficients + m_phase * TAPS_PER_PHASE,
+                                 samples + m_inputIndex - (TAPS_PER_PHASE - 1), TAPS_PER_PHASE));
+        m_phase += m_downFactor;
+        m_inputIndex += m_phase / m_upFactor;
+        m_phase %= m_upFactor;
+    }
+
+    // Keep only what the filter still needs
+    const qint64 consumed = qMin<qint64>(m_inputIndex - (TAPS_PER_PHASE - 1), m_history.size());
+    if (consumed > 0) {
+        m_history.remove(0, consumed);
+        m_inputIndex -= consumed;
+    }
+}
+
+QVector<float> PolyphaseResampler::resample(const QVector<float>& input, int inputRate, int outputRate) {
+    if (input.isEmpty() || inputRate <= 0 || outputRate <= 0 || inputRate == outputRate) {
+        return input;
+    }
+
+    PolyphaseResampler resampler(inputRate, outputRate);
+    QVector<float> output;
+    resampler.process(input.constData(), input.size(), output);
+    return output;
+}
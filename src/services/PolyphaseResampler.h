@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief PolyphaseResampler - Streaming rational-ratio resampler for mono float audio
+ *
+ * Converts by L/M (the reduced input/output rate ratio) with a Kaiser-windowed sinc
+ * low-pass split into L phases, so each output sample is one TAPS_PER_PHASE dot
+ * product (SSE2/NEON where available). State carries across process() calls, which
+ * lets capture chunks of any size be converted without seams.
+ */
+class PolyphaseResampler {
+public:
+    PolyphaseResampler(int inputRate = 16000, int outputRate = 16000);
+
+    void configure(int inputRate, int outputRate);
+    void reset();
+
+    // Appends the output produced by @p count new input samples
+    void process(const float* input, qint64 count, QVector<float>& output);
+
+    int getInputRate() const { return m_inputRate; }
+    int getOutputRate() const { return m_outputRate; }
+    bool isPassthrough() const { return m_inputRate == m_outputRate; }
+
+    // Whole-buffer convenience wrapper
+    static QVector<float> resample(const QVector<float>& input, int inputRate, int outputRate);
+
+    static constexpr int TAPS_PER_PHASE = 32;
+
+private:
+    void designFilter();
+
+    int m_inputRate;
+    int m_outputRate;
+    int m_upFactor;             // L
+    int m_downFactor;           // M
+    QVector<float> m_coefficients; // L phases x TAPS_PER_PHASE, reversed for a forward dot product
+    QVector<float> m_history;   // Last TAPS_PER_PHASE - 1 inputs followed by pending ones
+    qint64 m_inputIndex;        // Newest input sample under the filter, indexing m_history
+    int m_phase;
+};
@@ -0,0 +1,375 @@
+#include "ProcessingPipeline.h"
+#include "AsyncStorage.h"
+#include "../models/EnhancedText.h"
+#include <QDebug>
+
+namespace {
+
+QString enhancementProviderName(EnhancementProvider provider) {
+    switch (provider) {
+        case EnhancementProvider::GeminiPro:
+            return "gemini-pro";
+        case EnhancementProvider::GeminiFlash:
+            return "gemini-flash";
+        case EnhancementProvider::LocalLLM:
+            return "local-llm";
+        default:
+            return "unknown";
+    }
+}
+
+} // namespace
+
+ProcessingPipeline::ProcessingPipeline(ITranscriptionService* transcription, ITextEnhancementService* enhancement,
+                                       AsyncStorage* storage, QObject* parent)
+    : QObject(parent)
+    , m_transcription(transcription)
+    , m_enhancement(enhancement)
+    , m_storage(storage)
+    , m_jobCounter(0)
+    , m_accepting(true)
+    , m_pumping(false)
+    , m_pumpScheduled(false)
+{
+    setStageLimits(Stage::Transcribe, DEFAULT_TRANSCRIBE_QUEUE, DEFAULT_TRANSCRIBE_WORKERS);
+    setStageLimits(Stage::Enhance, DEFAULT_ENHANCE_QUEUE, DEFAULT_ENHANCE_WORKERS);
+    setStageLimits(Stage::Persist, DEFAULT_PERSIST_QUEUE, DEFAULT_PERSIST_WORKERS);
+
+    connect(m_transcription, &ITranscriptionService::transcriptionCompleted,
+            this, &ProcessingPipeline::handleTranscriptionCompleted);
+    connect(m_transcription, &ITranscriptionService::transcriptionFailed,
+            this, &ProcessingPipeline::handleTranscriptionFailed);
+    connect(m_enhancement, &ITextEnhancementService::enhancementCompleted,
+            this, &ProcessingPipeline::handleEnhancementCompleted);
+    connect(m_enhancement, &ITextEnhancementService::enhancementFailed,
+            this, &ProcessingPipeline::handleEnhancementFailed);
+}
+
+ProcessingPipeline::~ProcessingPipeline() {
+    cancelAll();
+}
+
+void ProcessingPipeline::setStageLimits(Stage at, int queueCapacity, int workers) {
+    StageState& state = stage(at);
+    state.queueCapacity = qMax(1, queueCapacity);
+    state.workers = qMax(1, workers);
+    schedulePump();
+}
+
+ProcessingPipeline::StageMetrics ProcessingPipeline::stageMetrics(Stage at) const {
+    const StageState& state = stage(at);
+    StageMetrics metrics;
+    metrics.queued = static_cast<int>(state.queue.size());
+    metrics.blocked = static_cast<int>(state.blocked.size());
+    metrics.running = state.running - metrics.blocked;
+    metrics.queueCapacity = state.queueCapacity;
+    metrics.workers = state.workers;
+    return metrics;
+}
+
+QString ProcessingPipeline::submit(const Job& job) {
+    const Stage entry = job.text.isEmpty() ? Stage::Transcribe : Stage::Enhance;
+    StageState& first = stage(entry);
+    if (first.queue.size() >= first.queueCapacity) {
+        return QString();
+    }
+
+    const QString jobId = QString("job_%1").arg(++m_jobCounter);
+    JobState state;
+    state.job = job;
+    state.job.enhance = job.enhance || entry == Stage::Enhance;
+    state.stage = entry;
+    state.transcript = job.text;
+    m_jobs.insert(jobId, state);
+    first.queue.enqueue(jobId);
+
+    // Started from the event loop, so the caller has the ID before any signal about it
+    updateAccepting();
+    schedulePump();
+    return jobId;
+}
+
+void ProcessingPipeline::cancel(const QString& jobId) {
+    auto it = m_jobs.find(jobId);
+    if (it == m_jobs.end()) {
+        return;
+    }
+
+    const QString requestId = it->requestId;
+    const Stage at = it->stage;
+    it->save.cancel();
+    releaseJob(jobId);
+    if (!requestId.isEmpty()) {
+        if (at == Stage::Transcribe) {
+            m_transcription->cancelTranscription(requestId);
+        } else {
+            m_enhancement->cancelEnhancement(requestId);
+        }
+    }
+    pump();
+}
+
+void ProcessingPipeline::cancelAll() {
+    // Queued jobs go first, so no worker freed below picks one up
+    const bool wasPumping = m_pumping;
+    m_pumping = true;
+    for (StageState& state : m_stages) {
+        for (const QString& jobId : std::as_const(state.queue)) {
+            m_jobs.remove(jobId);
+        }
+        state.queue.clear();
+    }
+    const QStringList jobIds = m_jobs.keys();
+    for (const QString& jobId : jobIds) {
+        cancel(jobId);
+    }
+    m_pumping = wasPumping;
+    updateAccepting();
+}
+
+bool ProcessingPipeline::isAccepting() const {
+    return m_accepting;
+}
+
+int ProcessingPipeline::jobCount() const {
+    return static_cast<int>(m_jobs.size());
+}
+
+void ProcessingPipeline::handleTranscriptionCompleted(const QString& requestId, const TranscriptionResult& result) {
+    const QString jobId = m_jobByRequest.value(requestId);
+    if (jobId.isEmpty()) {
+        return; // Not one of ours
+    }
+    m_jobs[jobId].transcript = result.text;
+    emit jobTranscribed(jobId, result);
+    finishStage(jobId);
+}
+
+void ProcessingPipeline::handleTranscriptionFailed(const QString& requestId, TranscriptionError error,
+                                                   const QString& errorMessage) {
+    Q_UNUSED(error)
+    const QString jobId = m_jobByRequest.value(requestId);
+    if (!jobId.isEmpty()) {
+        failJob(jobId, errorMessage);
+    }
+}
+
+void ProcessingPipeline::handleEnhancementCompleted(const QString& requestId, const EnhancementResult& result) {
+    const QString jobId = m_jobByRequest.value(requestId);
+    if (jobId.isEmpty()) {
+        return;
+    }
+    m_jobs[jobId].enhancement = result;
+    emit jobEnhanced(jobId, result);
+    finishStage(jobId);
+}
+
+void ProcessingPipeline::handleEnhancementFailed(const QString& requestId, EnhancementError error,
+                                                 const QString& errorMessage) {
+    Q_UNUSED(error)
+    const QString jobId = m_jobByRequest.value(requestId);
+    if (!jobId.isEmpty()) {
+        failJob(jobId, errorMessage);
+    }
+}
+
+ProcessingPipeline::StageState& ProcessingPipeline::stage(Stage at) {
+    return m_stages[static_cast<size_t>(at)];
+}
+
+const ProcessingPipeline::StageState& ProcessingPipeline::stage(Stage at) const {
+    return m_stages[static_cast<size_t>(at)];
+}
+
+void ProcessingPipeline::schedulePump() {
+    if (m_pumpScheduled) {
+        return;
+    }
+    m_pumpScheduled = true;
+    QMetaObject::invokeMethod(this, [this]() {
+        m_pumpScheduled = false;
+        pump();
+    }, Qt::QueuedConnection);
+}
+
+void ProcessingPipeline::pump() {
+    if (m_pumping) {
+        return; // The running pass sees whatever changed
+    }
+    m_pumping = true;
+
+    // Downstream first, so room made at the end travels to the front in one pass
+    bool progressed = true;
+    while (progressed) {
+        progressed = false;
+        for (int i = static_cast<int>(m_stages.size()) - 1; i >= 0; --i) {
+            const Stage at = static_cast<Stage>(i);
+            progressed |= advanceBlocked(at);
+            progressed |= startQueued(at);
+        }
+    }
+
+    m_pumping = false;
+    updateAccepting();
+}
+
+bool ProcessingPipeline::advanceBlocked(Stage from) {
+    if (from == Stage::Persist) {
+        return false; // Nothing after it; its jobs never block
+    }
+    StageState& current = stage(from);
+    const Stage to = static_cast<Stage>(static_cast<int>(from) + 1);
+    StageState& next = stage(to);
+
+    bool moved = false;
+    while (!current.blocked.isEmpty() && next.queue.size() < next.queueCapacity) {
+        const QString jobId = current.blocked.dequeue();
+        JobState& job = m_jobs[jobId];
+        job.blocked = false;
+        job.running = false;
+        --current.running;
+        job.stage = to;
+        next.queue.enqueue(jobId);
+        moved = true;
+    }
+    return moved;
+}
+
+bool ProcessingPipeline::startQueued(Stage at) {
+    StageState& current = stage(at);
+    bool started = false;
+    while (!current.queue.isEmpty() && current.running < current.workers) {
+        const QString jobId = current.queue.dequeue();
+        JobState& job = m_jobs[jobId];
+        job.running = true;
+        ++current.running;
+        started = true;
+
+        emit jobStageChanged(jobId, at);
+        auto it = m_jobs.find(jobId);
+        if (it != m_jobs.end()) { // A slot may have cancelled it
+            startStage(jobId, it.value());
+        }
+    }
+    return started;
+}
+
+void ProcessingPipeline::startStage(const QString& jobId, JobState& job) {
+    QString requestId;
+    switch (job.stage) {
+        case Stage::Transcribe:
+            requestId = m_transcription->submitTranscription(job.job.transcription);
+            if (requestId.isEmpty()) {
+                failJob(jobId, m_transcription->getErrorString());
+                return;
+            }
+            break;
+
+        case Stage::Enhance: {
+            EnhancementRequest request;
+            request.text = job.transcript;
+            request.settings = job.job.enhancementSettings;
+            request.preferredProvider = job.job.enhancementProvider;
+            requestId = m_enhancement->submitEnhancement(request);
+            if (requestId.isEmpty()) {
+                failJob(jobId, m_enhancement->getErrorString());
+                return;
+            }
+            break;
+        }
+
+        case Stage::Persist: {
+            const EnhancementResult& result = job.enhancement;
+            EnhancedText enhancedText(QString(), result.originalText, result.enhancedText);
+            enhancedText.setEnhancementMode(result.mode);
+            enhancedText.setProvider(enhancementProviderName(result.provider));
+            enhancedText.setProcessingTime(result.processingTime);
+            // A cancelled save never calls back
+            job.save = m_storage->saveEnhancedText(job.job.recordingId, enhancedText);
+            job.save.then(this, [this, jobId](const QString& savedId) {
+                if (!m_jobs.contains(jobId)) {
+                    return;
+                }
+                if (savedId.isEmpty()) {
+                    failJob(jobId, "Enhanced text not saved: no transcription for the recording, or the write failed");
+                } else {
+                    finishStage(jobId);
+                }
+            });
+            return;
+        }
+    }
+
+    job.requestId = requestId;
+    m_jobByRequest.insert(requestId, jobId);
+}
+
+void ProcessingPipeline::finishStage(const QString& jobId) {
+    auto it = m_jobs.find(jobId);
+    if (it == m_jobs.end()) {
+        return; // Cancelled by a slot
+    }
+    JobState& job = it.value();
+    m_jobByRequest.remove(job.requestId);
+    job.requestId.clear();
+
+    bool last = false;
+    switch (job.stage) {
+        case Stage::Transcribe:
+            last = !job.job.enhance || job.transcript.trimmed().isEmpty();
+            break;
+        case Stage::Enhance:
+            last = !m_storage || job.job.recordingId.isEmpty();
+            break;
+        case Stage::Persist:
+            last = true;
+            break;
+    }
+
+    if (last) {
+        releaseJob(jobId);
+        emit jobFinished(jobId);
+    } else {
+        job.blocked = true;
+        stage(job.stage).blocked.enqueue(jobId);
+    }
+    pump();
+}
+
+void ProcessingPipeline::failJob(const QString& jobId, const QString& errorMessage) {
+    auto it = m_jobs.find(jobId);
+    if (it == m_jobs.end()) {
+        return;
+    }
+    const Stage at = it->stage;
+    releaseJob(jobId);
+    qWarning() << "ProcessingPipeline:" << jobId << "failed:" << errorMessage;
+    emit jobFailed(jobId, at, errorMessage);
+    pump();
+}
+
+void ProcessingPipeline::releaseJob(const QString& jobId) {
+    auto it = m_jobs.find(jobId);
+    if (it == m_jobs.end()) {
+        return;
+    }
+    StageState& current = stage(it->stage);
+    current.queue.removeAll(jobId);
+    current.blocked.removeAll(jobId);
+    if (it->running) {
+        --current.running;
+    }
+    if (!it->requestId.isEmpty()) {
+        m_jobByRequest.remove(it->requestId);
+    }
+    m_jobs.erase(it);
+}
+
+void ProcessingPipeline::updateAccepting() {
+    const StageState& entry = stage(Stage::Transcribe);
+    const bool accepting = entry.queue.size() < entry.queueCapacity;
+    if (accepting != m_accepting) {
+        m_accepting = accepting;
+        emit acceptingChanged(accepting);
+    }
+}
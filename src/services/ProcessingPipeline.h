@@ -0,0 +1,142 @@
+#pragma once
+
+#include "../../specs/001-voice-to-text/contracts/ai-enhancement-interface.h"
+#include "../../specs/001-voice-to-text/contracts/transcription-service-interface.h"
+#include <QFuture>
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <array>
+
+class AsyncStorage;
+
+/**
+ * @brief Runs recordings through transcription, enhancement and storage as overlapping stages
+ *
+ * Each stage has a bounded queue in front of it and a fixed number of workers,
+ * which is how many requests it keeps in flight with its service. Transcriptions
+ * run on the decode pool, enhancements on the network or the local model's pool,
+ * and saves on the storage pool and writer. One recording is enhanced while the
+ * next one is transcribed.
+ *
+ * Backpressure: a job that finishes a stage holds its worker until the next
+ * stage's queue has room. A stage whose workers are all held takes no new work, so
+ * its own queue fills in turn. Once the transcription queue is full, submit()
+ * refuses recordings and acceptingChanged(false) tells the window to stop offering
+ * new ones. Cancelling a job takes it out of whichever stage holds it and cancels
+ * the request it has in flight, so nothing downstream runs for it.
+ *
+ * The transcript itself is saved by TranscriptionService. The persist stage inserts
+ * the enhanced text into enhanced_texts against it. A job finishes that stage only
+ * once the row has committed, and fails if it did not. Call from the thread that
+ * owns the services.
+ */
+class ProcessingPipeline : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Stage {
+        Transcribe,
+        Enhance,
+        Persist
+    };
+    Q_ENUM(Stage)
+
+    struct Job {
+        TranscriptionRequest transcription; // Unused when text is set
+        QString text;                       // Already transcribed: the job starts at Enhance
+        QString recordingId;                // The transcription the enhanced text is saved against
+        bool enhance = false;
+        EnhancementSettings enhancementSettings;
+        EnhancementProvider enhancementProvider = EnhancementProvider::GeminiPro;
+    };
+
+    struct StageMetrics {
+        int queued = 0;
+        int running = 0;  // In flight with the service
+        int blocked = 0;  // Done, waiting for room downstream
+        int queueCapacity = 0;
+        int workers = 0;
+    };
+
+    ProcessingPipeline(ITranscriptionService* transcription, ITextEnhancementService* enhancement,
+                       AsyncStorage* storage, QObject* parent = nullptr);
+    ~ProcessingPipeline() override;
+
+    void setStageLimits(Stage stage, int queueCapacity, int workers);
+    StageMetrics stageMetrics(Stage stage) const;
+
+    // Empty when the entry stage is full; try again after acceptingChanged(true)
+    QString submit(const Job& job);
+    void cancel(const QString& jobId);
+    void cancelAll();
+    bool isAccepting() const;
+    int jobCount() const;
+
+    static constexpr int DEFAULT_TRANSCRIBE_QUEUE = 4;
+    static constexpr int DEFAULT_TRANSCRIBE_WORKERS = 2;
+    static constexpr int DEFAULT_ENHANCE_QUEUE = 8;
+    static constexpr int DEFAULT_ENHANCE_WORKERS = 3;
+    static constexpr int DEFAULT_PERSIST_QUEUE = 16;
+    static constexpr int DEFAULT_PERSIST_WORKERS = 2;
+
+signals:
+    void jobStageChanged(const QString& jobId, ProcessingPipeline::Stage stage);
+    void jobTranscribed(const QString& jobId, const TranscriptionResult& result);
+    void jobEnhanced(const QString& jobId, const EnhancementResult& result);
+    void jobFinished(const QString& jobId);
+    void jobFailed(const QString& jobId, ProcessingPipeline::Stage stage, const QString& errorMessage);
+    void acceptingChanged(bool accepting);
+
+private slots:
+    void handleTranscriptionCompleted(const QString& requestId, const TranscriptionResult& result);
+    void handleTranscriptionFailed(const QString& requestId, TranscriptionError error, const QString& errorMessage);
+    void handleEnhancementCompleted(const QString& requestId, const EnhancementResult& result);
+    void handleEnhancementFailed(const QString& requestId, EnhancementError error, const QString& errorMessage);
+
+private:
+    struct JobState {
+        Job job;
+        Stage stage = Stage::Transcribe;
+        bool running = false;  // Holds one of the stage's workers
+        bool blocked = false;  // Finished the stage, waiting to move on
+        QString requestId;     // Service request in flight
+        QString transcript;
+        EnhancementResult enhancement;
+        QFuture<QString> save;
+    };
+
+    struct StageState {
+        QQueue<QString> queue;
+        QQueue<QString> blocked;
+        int running = 0; // Includes blocked jobs, which keep their worker
+        int queueCapacity = 0;
+        int workers = 0;
+    };
+
+    StageState& stage(Stage stage);
+    const StageState& stage(Stage stage) const;
+
+    void pump();
+    void schedulePump();
+    bool advanceBlocked(Stage from);
+    bool startQueued(Stage at);
+    void startStage(const QString& jobId, JobState& job);
+    void finishStage(const QString& jobId);
+    void failJob(const QString& jobId, const QString& errorMessage);
+    void releaseJob(const QString& jobId);
+    void updateAccepting();
+
+    ITranscriptionService* m_transcription;
+    ITextEnhancementService* m_enhancement;
+    AsyncStorage* m_storage;
+
+    std::array<StageState, 3> m_stages;
+    QHash<QString, JobState> m_jobs;
+    QHash<QString, QString> m_jobByRequest; // Service request ID -> job ID
+    int m_jobCounter;
+    bool m_accepting;
+    bool m_pumping;       // Set while pump() runs; slots it triggers must not re-enter it
+    bool m_pumpScheduled;
+};
@@ -0,0 +1,740 @@
+#include "RecordingFileWriter.h"
+#include "Telemetry.h"
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMap>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr quint16 WAVE_FORMAT_PCM = 0x0001;
+constexpr quint16 WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+constexpr quint64 MAX_RIFF_SIZE = 0xFFFFFFFFull;
+constexpr int DS64_CHUNK_SIZE = 28;
+
+void putU16(char* p, quint16 value) {
+    qToLittleEndian(value, reinterpret_cast<uchar*>(p));
+}
+
+void putU32(char* p, quint32 value) {
+    qToLittleEndian(value, reinterpret_cast<uchar*>(p));
+}
+
+void putU64(char* p, quint64 value) {
+    qToLittleEndian(value, reinterpret_cast<uchar*>(p));
+}
+
+} // namespace
+
+RecordingFileWriter::RecordingFileWriter(QFile* file)
+    : m_file(file)
+    , m_hasFileFormat(false)
+    , m_converting(false)
+    , m_codec(AudioCodec::Pcm)
+    , m_flac(false)
+    , m_thread(nullptr)
+    , m_target(file)
+    , m_telemetry(nullptr)
+    , m_segmentMs(0)
+    , m_segmentFrames(0)
+    , m_segmentIndex(0)
+    , m_segmentStartFrame(0)
+    , m_segmentBytes(0)
+    , m_stopping(false)
+    , m_queuedBytes(0)
+    , m_droppedBytes(0)
+    , m_fileBytes(0)
+    , m_failed(0)
+    , m_writtenBytes(0)
+{
+}
+
+RecordingFileWriter::~RecordingFileWriter() {
+    finish();
+}
+
+void RecordingFileWriter::setFileFormat(const AudioFileReader::Format& format) {
+    m_format = format;
+    m_hasFileFormat = true;
+}
+
+void RecordingFileWriter::setCodec(AudioCodec codec) {
+    m_codec = codec;
+}
+
+AudioCodec RecordingFileWriter::codec() const {
+    return m_flac ? AudioCodec::Flac : AudioCodec::Pcm;
+}
+
+void RecordingFileWriter::setTelemetry(Telemetry* telemetry) {
+    m_telemetry = telemetry;
+}
+
+void RecordingFileWriter::setSegmentDuration(int milliseconds) {
+    m_segmentMs = qMax(0, milliseconds);
+}
+
+QList<RecordingFileWriter::Segment> RecordingFileWriter::takeCompletedSegments() {
+    QMutexLocker locker(&m_mutex);
+    QList<Segment> segments;
+    segments.swap(m_completedSegments);
+    return segments;
+}
+
+bool RecordingFileWriter::start(const AudioFileReader::Format& captureFormat) {
+    if (!m_file || !m_file->isOpen() || m_thread) {
+        return false;
+    }
+
+    m_captureFormat = captureFormat;
+    if (!m_hasFileFormat) {
+        m_format = captureFormat;
+    }
+    m_converting = m_format.sampleRate != captureFormat.sampleRate ||
+                   m_format.channelCount != captureFormat.channelCount ||
+                   m_format.bytesPerSample != captureFormat.bytesPerSample ||
+                   m_format.isFloat != captureFormat.isFloat;
+    if (m_converting && (m_format.channelCount != 1 || !m_format.isFloat || m_format.bytesPerSample != 4)) {
+        fail("Recording file format must match the capture or be mono float32");
+        return false;
+    }
+    m_resampler.configure(captureFormat.sampleRate, m_format.sampleRate);
+    m_partialFrame.clear();
+    
+    m_flac = m_codec == AudioCodec::Flac && !m_converting && FlacEncoder::supportsFormat(m_format);
+    if (m_codec == AudioCodec::Flac && !m_flac) {
+        qDebug() << "RecordingFileWriter: FLAC needs integer PCM, writing WAV instead";
+    }
+    m_segmentFrames = static_cast<qint64>(m_segmentMs) * m_format.sampleRate / 1000;
+    if (m_flac) {
+        m_encoder.configure(m_format);
+        if (m_segmentFrames > 0) {
+            m_segmentFrames = (m_segmentFrames + FlacEncoder::BLOCK_SIZE - 1) / FlacEncoder::BLOCK_SIZE *
+                              FlacEncoder::BLOCK_SIZE;
+        }
+    }
+
+    m_ring.reset(RING_BYTES);
+    m_backBuffer.reserve(BUFFER_BYTES);
+    m_stopping = false;
+    m_errorString.clear();
+    m_queuedBytes.storeRelaxed(0);
+    m_droppedBytes.storeRelaxed(0);
+    m_fileBytes.storeRelaxed(0);
+    m_failed.storeRelaxed(0);
+    m_writtenBytes = 0;
+
+    // Valid (empty) file from the first byte, so an interrupted file is always repairable
+    const QByteArray header = m_flac ? m_encoder.streamHeader() : makeHeader(m_format, 0);
+    if (m_file->write(header) != header.size()) {
+        fail("Cannot write recording header: " + m_file->errorString());
+        return false;
+    }
+
+    m_target = m_file;
+    m_segmentStartFrame = 0;
+    m_segmentBytes = 0;
+    m_segmentPaths.clear();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_completedSegments.clear();
+    }
+    if (m_segmentFrames > 0 && !openSegment(0)) {
+        return false;
+    }
+
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("RecordingFileWriter");
+    m_thread->start(QThread::HighPriority);
+    return true;
+}
+
+bool RecordingFileWriter::finish() {
+    if (!m_thread) {
+        return !hasError();
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_dataReady.wakeOne();
+    }
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+
+    if (m_flac && !hasError()) {
+        m_encoded.resize(0);
+        m_encoder.flush(m_encoded);
+        writeEncoded(m_encoded);
+    }
+
+    if (m_segmentFile) {
+        return closeSegment();
+    }
+
+    // WAV data chunks are padded to an even length
+    if (!m_flac && !hasError() && (m_writtenBytes & 1)) {
+        const char pad = 0;
+        if (m_file->write(&pad, 1) != 1) {
+            fail("Cannot write WAV padding: " + m_file->errorString());
+        }
+    }
+
+    if (!hasError()) {
+        patchHeader();
+    }
+    if (!hasError()) {
+        syncToDisk();
+    }
+    return !hasError();
+}
+
+bool RecordingFileWriter::joinSegments() {
+    if (m_segmentPaths.isEmpty()) {
+        return true;
+    }
+    if (m_thread) {
+        return false;
+    }
+
+    m_target = m_file;
+    if (!stitchSegments(*m_file, m_segmentPaths)) {
+        fail("Cannot join recording segments into " + m_file->fileName());
+        return false;
+    }
+    m_segmentPaths.clear();
+    return syncToDisk();
+}
+
+void RecordingFileWriter::write(const char* data, qint64 len) {
+    if (len <= 0) {
+        return;
+    }
+
+    // All or nothing: a partial chunk would shift every later frame out of alignment.
+    // The writer thread polls, so nothing here can block on its mutex.
+    if (m_ring.availableToWrite() < len) {
+        m_droppedBytes.fetchAndAddRelaxed(static_cast<quint64>(len));
+        return;
+    }
+    m_ring.write(data, len);
+    m_queuedBytes.fetchAndAddRelaxed(len);
+}
+
+qint64 RecordingFileWriter::dataBytes() const {
+    const qint64 queued = m_queuedBytes.loadRelaxed();
+    if (!m_converting) {
+        return queued;
+    }
+
+    // Estimated from the capture bytes queued so far
+    const qint64 captureFrameBytes = qMax(1, m_captureFormat.channelCount * m_captureFormat.bytesPerSample);
+    const qint64 frames = queued / captureFrameBytes * m_format.sampleRate / qMax(1, m_captureFormat.sampleRate);
+    return frames * m_format.bytesPerSample;
+}
+
+qint64 RecordingFileWriter::fileSize() const {
+    if (m_flac) {
+        return FlacEncoder::HEADER_SIZE + m_fileBytes.loadRelaxed();
+    }
+    return HEADER_SIZE + dataBytes();
+}
+
+QString RecordingFileWriter::errorString() const {
+    QMutexLocker locker(&m_mutex);
+    return m_errorString;
+}
+
+void RecordingFileWriter::run() {
+    QElapsedTimer sinceSync;
+    sinceSync.start();
+
+    bool stopping = false;
+    while (!stopping) {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_stopping) {
+                m_dataReady.wait(&m_mutex, FLUSH_INTERVAL_MS);
+            }
+            stopping = m_stopping;
+        }
+
+        // Everything captured so far; the producer keeps filling the ring meanwhile.
+        // After a failure the audio is still drained, so write() never starts counting drops.
+        for (;;) {
+            m_backBuffer.resize(BUFFER_BYTES); // Within the reserved capacity
+            m_backBuffer.resize(m_ring.read(m_backBuffer.data(), BUFFER_BYTES));
+            if (m_backBuffer.isEmpty()) {
+                break;
+            }
+            if (!hasError()) {
+                QElapsedTimer writeTimer;
+                writeTimer.start();
+                writeBuffer(m_backBuffer);
+                if (m_telemetry) {
+                    m_telemetry->recordStage(Telemetry::STAGE_WRITE, writeTimer.nsecsElapsed() / 1000);
+                }
+            }
+        }
+
+        if (!stopping && sinceSync.elapsed() >= FSYNC_INTERVAL_MS && !hasError()) {
+            // Keep the on-disk header close to the data, in case we never get to finish()
+            patchHeader();
+            syncToDisk();
+            sinceSync.restart();
+        }
+    }
+}
+
+bool RecordingFileWriter::writeBuffer(const QByteArray& buffer) {
+    if (m_converting) {
+        return writeConverted(buffer);
+    }
+    if (!m_flac) {
+        return writeFileData(buffer.constData(), buffer.size());
+    }
+
+    // Fed up to each segment boundary, which is a block boundary, so every
+    // segment receives whole frames only
+    const char* data = buffer.constData();
+    qint64 remaining = buffer.size();
+    while (remaining > 0) {
+        if (segmentRoom() <= 0 && !openSegment(m_segmentIndex + 1)) {
+            return false;
+        }
+        const qint64 len = qMin(remaining, segmentRoom());
+        m_encoded.resize(0); // Keeps the capacity, like the swap buffers
+        m_encoder.encode(data, len, m_encoded);
+        if (!writeEncoded(m_encoded)) {
+            return false;
+        }
+        m_segmentBytes += len;
+        data += len;
+        remaining -= len;
+    }
+    return true;
+}
+
+bool RecordingFileWriter::writeFileData(const char* data, qint64 len) {
+    while (len > 0) {
+        if (segmentRoom() <= 0 && !openSegment(m_segmentIndex + 1)) {
+            return false;
+        }
+        const qint64 chunk = qMin(len, segmentRoom());
+        const qint64 written = m_target->write(data, chunk);
+        if (written != chunk) {
+            fail("Cannot write recording: " + m_target->errorString());
+            return false;
+        }
+        m_writtenBytes += written;
+        m_segmentBytes += written;
+        data += chunk;
+        len -= chunk;
+    }
+    return true;
+}
+
+qint64 RecordingFileWriter::segmentRoom() const {
+    if (m_segmentFrames <= 0) {
+        return std::numeric_limits<qint64>::max();
+    }
+    const qint64 frameBytes = qMax(1, m_format.channelCount * m_format.bytesPerSample);
+    return m_segmentFrames * frameBytes - m_segmentBytes;
+}
+
+bool RecordingFileWriter::openSegment(int index) {
+    // Opened lazily: a recording that ends on a boundary leaves no empty segment behind
+    if (m_segmentFile && !closeSegment()) {
+        return false;
+    }
+
+    const QString path = segmentPath(m_file->fileName(), index);
+    auto file = std::make_unique<QFile>(path);
+    const QByteArray header = m_flac ? FlacEncoder::makeStreamHeader(m_format, 0, 0, 0) : makeHeader(m_format, 0);
+    if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate) || file->write(header) != header.size()) {
+        fail("Cannot create recording segment " + path + ": " + file->errorString());
+        return false;
+    }
+
+    m_segmentFile = std::move(file);
+    m_target = m_segmentFile.get();
+    m_segmentIndex = index;
+    m_segmentBytes = 0;
+    m_writtenBytes = 0;
+    return true;
+}
+
+bool RecordingFileWriter::closeSegment() {
+    if (!m_segmentFile) {
+        return true;
+    }
+
+    if (!m_flac && !hasError() && (m_writtenBytes & 1)) {
+        const char pad = 0;
+        if (m_target->write(&pad, 1) != 1) {
+            fail("Cannot write WAV padding: " + m_target->errorString());
+        }
+    }
+    if (!hasError()) {
+        patchHeader();
+    }
+    if (!hasError()) {
+        syncToDisk();
+    }
+
+    Segment segment;
+    segment.index = m_segmentIndex;
+    segment.filePath = m_segmentFile->fileName();
+    segment.sampleRate = m_format.sampleRate;
+    segment.startFrame = m_segmentStartFrame;
+    segment.frames = m_segmentBytes / qMax(1, m_format.channelCount * m_format.bytesPerSample);
+    m_segmentFile->close();
+    m_segmentFile.reset();
+    m_target = m_file;
+    m_segmentStartFrame += segment.frames;
+    m_segmentPaths.append(segment.filePath);
+
+    if (!hasError()) {
+        QMutexLocker locker(&m_mutex);
+        m_completedSegments.append(segment);
+    }
+    return !hasError();
+}
+
+bool RecordingFileWriter::writeEncoded(const QByteArray& encoded) {
+    if (encoded.isEmpty()) {
+        return true; // Still filling the first block
+    }
+
+    const qint64 written = m_target->write(encoded);
+    if (written != encoded.size()) {
+        fail("Cannot write recording: " + m_target->errorString());
+        return false;
+    }
+    m_writtenBytes += written;
+    m_fileBytes.fetchAndAddRelaxed(written);
+    return true;
+}
+
+bool RecordingFileWriter::writeConverted(const QByteArray& buffer) {
+    // Frames may straddle two buffers; the remainder waits for the next one
+    const QByteArray joined = m_partialFrame.isEmpty() ? buffer : m_partialFrame + buffer;
+    const qint64 frameBytes = qMax(1, m_captureFormat.channelCount * m_captureFormat.bytesPerSample);
+    const qint64 wholeBytes = joined.size() / frameBytes * frameBytes;
+    m_partialFrame = joined.mid(wholeBytes);
+
+    const QVector<float> mono = AudioFileReader::convertToFloat(joined.constData(), wholeBytes, m_captureFormat);
+    m_converted.resize(0);
+    m_resampler.process(mono.constData(), mono.size(), m_converted);
+
+    // Float samples are written in host order; every platform we ship is little-endian
+    const qint64 bytes = static_cast<qint64>(m_converted.size()) * sizeof(float);
+    return writeFileData(reinterpret_cast<const char*>(m_converted.constData()), bytes);
+}
+
+bool RecordingFileWriter::patchHeader() {
+    QByteArray header;
+    if (!m_flac) {
+        header = makeHeader(m_format, static_cast<quint64>(m_writtenBytes));
+    } else if (m_segmentFile) {
+        header = FlacEncoder::makeStreamHeader(m_format, m_encoder.totalSamples() - m_segmentStartFrame, 0, 0);
+    } else {
+        header = m_encoder.streamHeader();
+    }
+
+    const qint64 end = m_target->pos();
+    if (!m_target->seek(0) || m_target->write(header) != header.size() || !m_target->seek(end)) {
+        fail("Cannot update recording header: " + m_target->errorString());
+        return false;
+    }
+    return true;
+}
+
+bool RecordingFileWriter::syncToDisk() {
+    if (!m_target->flush()) {
+        fail("Cannot flush recording: " + m_target->errorString());
+        return false;
+    }
+
+#ifdef Q_OS_WIN
+    const int rc = _commit(m_target->handle());
+#else
+    const int rc = ::fsync(m_target->handle());
+#endif
+    if (rc != 0) {
+        // Some network filesystems refuse fsync; the data has still reached the server
+        qWarning() << "RecordingFileWriter: fsync failed for" << m_target->fileName();
+    }
+    return true;
+}
+
+void RecordingFileWriter::fail(const QString& message) {
+    qWarning() << "RecordingFileWriter:" << message;
+    QMutexLocker locker(&m_mutex);
+    if (m_errorString.isEmpty()) {
+        m_errorString = message;
+    }
+    m_failed.storeRelaxed(1);
+}
+
+QByteArray RecordingFileWriter::makeHeader(const AudioFileReader::Format& format, quint64 dataBytes) {
+    QByteArray header(HEADER_SIZE, '\0');
+    char* p = header.data();
+
+    const quint16 blockAlign = static_cast<quint16>(format.channelCount * format.bytesPerSample);
+    const quint64 riffSize = HEADER_SIZE - 8 + dataBytes + (dataBytes & 1);
+    const bool rf64 = riffSize > MAX_RIFF_SIZE;
+
+    std::memcpy(p, rf64 ? "RF64" : "RIFF", 4);
+    putU32(p + 4, rf64 ? static_cast<quint32>(MAX_RIFF_SIZE) : static_cast<quint32>(riffSize));
+    std::memcpy(p + 8, "WAVE", 4);
+
+    // Reserved as JUNK so the 64-bit sizes can be added later without moving the data
+    std::memcpy(p + 12, rf64 ? "ds64" : "JUNK", 4);
+    putU32(p + 16, DS64_CHUNK_SIZE);
+    if (rf64) {
+        putU64(p + 20, riffSize);
+        putU64(p + 28, dataBytes);
+        putU64(p + 36, blockAlign > 0 ? dataBytes / blockAlign : 0);
+        putU32(p + 44, 0); // No table entries
+    }
+
+    std::memcpy(p + 48, "fmt ", 4);
+    putU32(p + 52, 16);
+    putU16(p + 56, format.isFloat ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM);
+    putU16(p + 58, static_cast<quint16>(format.channelCount));
+    putU32(p + 60, static_cast<quint32>(format.sampleRate));
+    putU32(p + 64, static_cast<quint32>(format.sampleRate) * blockAlign);
+    putU16(p + 68, blockAlign);
+    putU16(p + 70, static_cast<quint16>(format.bytesPerSample * 8));
+
+    std::memcpy(p + 72, "data", 4);
+    putU32(p + 76, rf64 ? static_cast<quint32>(MAX_RIFF_SIZE) : static_cast<quint32>(dataBytes));
+    return header;
+}
+
+QString RecordingFileWriter::segmentPath(const QString& filePath, int index) {
+    const QFileInfo info(filePath);
+    return info.dir().filePath(QString("%1.part%2.%3")
+                                   .arg(info.completeBaseName())
+                                   .arg(index, 3, 10, QChar('0'))
+                                   .arg(info.suffix()));
+}
+
+QStringList RecordingFileWriter::findSegments(const QString& filePath) {
+    const QFileInfo info(filePath);
+    const QRegularExpression pattern("^" + QRegularExpression::escape(info.completeBaseName()) +
+                                     "\\.part(\\d+)\\." + QRegularExpression::escape(info.suffix()) + "$");
+
+    // Ordered by the number, not the name: part1000 follows part999
+    QMap<int, QString> segments;
+    const QStringList names = info.dir().entryList({info.completeBaseName() + ".part*." + info.suffix()}, QDir::Files);
+    for (const QString& name : names) {
+        const QRegularExpressionMatch match = pattern.match(name);
+        if (match.hasMatch()) {
+            segments.insert(match.captured(1).toInt(), info.dir().filePath(name));
+        }
+    }
+    return segments.values();
+}
+
+bool RecordingFileWriter::stitchSegments(QFile& output, const QStringList& segmentPaths,
+                                         AudioFileReader::Format* format, qint64* dataBytes) {
+    struct Part {
+        QString path;
+        qint64 offset = 0;
+        qint64 bytes = 0;
+    };
+    QList<Part> parts;
+    AudioFileReader::Format common;
+    bool flac = false;
+    quint64 totalFrames = 0;
+    qint64 totalBytes = 0;
+
+    for (const QString& path : segmentPaths) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "Cannot open recording segment:" << path << file.errorString();
+            return false;
+        }
+
+        Part part;
+        part.path = path;
+        AudioFileReader::Format parsed;
+        quint64 frames = 0;
+        const QByteArray probe = file.peek(HEADER_SIZE);
+        const bool isFlac = FlacDecoder::isFlac(probe);
+        if (isFlac) {
+            // Our segments carry STREAMINFO as their only metadata block
+            FlacDecoder decoder(&file);
+            if (probe.size() < FlacEncoder::HEADER_SIZE || static_cast<uchar>(probe.at(4)) != 0x80 ||
+                !decoder.readHeader()) {
+                qWarning() << "Unexpected FLAC segment layout:" << path;
+                return false;
+            }
+            parsed = decoder.format();
+            frames = decoder.totalSamples();
+            part.offset = FlacEncoder::HEADER_SIZE;
+            part.bytes = file.size() - part.offset;
+        } else {
+            qint64 size = 0;
+            part.offset = AudioFileReader::parseWavHeader(probe, parsed, &size);
+            if (part.offset < 0) {
+                qWarning() << "Unexpected WAV segment layout:" << path;
+                return false;
+            }
+            const qint64 blockAlign = qMax(1, parsed.channelCount * parsed.bytesPerSample);
+            part.bytes = qMin(size, file.size() - part.offset) / blockAlign * blockAlign;
+            frames = static_cast<quint64>(part.bytes / blockAlign);
+        }
+
+        if (parts.isEmpty()) {
+            common = parsed;
+            flac = isFlac;
+        } else if (isFlac != flac || parsed.sampleRate != common.sampleRate ||
+                   parsed.channelCount != common.channelCount ||
+                   parsed.bytesPerSample != common.bytesPerSample || parsed.isFloat != common.isFloat) {
+            qWarning() << "Recording segment format differs from the first one:" << path;
+            return false;
+        }
+        totalFrames += frames;
+        totalBytes += part.bytes;
+        parts.append(part);
+    }
+    if (parts.isEmpty()) {
+        return false;
+    }
+
+    // Totals are known up front, so the header is final before any audio is copied
+    const QByteArray header = flac ? FlacEncoder::makeStreamHeader(common, totalFrames, 0, 0)
+                                   : makeHeader(common, static_cast<quint64>(totalBytes));
+    if (!output.resize(0) || !output.seek(0) || output.write(header) != header.size()) {
+        qWarning() << "Cannot write stitched recording:" << output.errorString();
+        return false;
+    }
+
+    QByteArray chunk;
+    for (const Part& part : parts) {
+        QFile file(part.path);
+        if (!file.open(QIODevice::ReadOnly) || !file.seek(part.offset)) {
+            qWarning() << "Cannot read recording segment:" << part.path << file.errorString();
+            return false;
+        }
+        qint64 remaining = part.bytes;
+        while (remaining > 0) {
+            chunk = file.read(qMin<qint64>(remaining, STITCH_CHUNK_BYTES));
+            if (chunk.isEmpty() || output.write(chunk) != chunk.size()) {
+                qWarning() << "Cannot copy recording segment:" << part.path << output.errorString();
+                return false;
+            }
+            remaining -= chunk.size();
+        }
+    }
+    if (!flac && (totalBytes & 1)) {
+        const char pad = 0;
+        if (output.write(&pad, 1) != 1) {
+            qWarning() << "Cannot write WAV padding:" << output.errorString();
+            return false;
+        }
+    }
+    if (!output.flush()) {
+        qWarning() << "Cannot flush stitched recording:" << output.errorString();
+        return false;
+    }
+
+    for (const Part& part : parts) {
+        QFile::remove(part.path);
+    }
+    if (format) {
+        *format = common;
+    }
+    if (dataBytes) {
+        *dataBytes = flac ? static_cast<qint64>(totalFrames) * common.channelCount * common.bytesPerSample : totalBytes;
+    }
+    return true;
+}
+
+bool RecordingFileWriter::repairHeader(const QString& filePath, AudioFileReader::Format* format, qint64* dataBytes) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadWrite)) {
+        qWarning() << "Cannot open recording for repair:" << file.errorString();
+        return false;
+    }
+
+    if (FlacDecoder::isFlac(file.peek(4))) {
+        return repairFlacHeader(file, format, dataBytes);
+    }
+
+    const QByteArray probe = file.read(HEADER_SIZE);
+    AudioFileReader::Format parsed;
+    if (probe.size() < HEADER_SIZE || AudioFileReader::parseWavHeader(probe, parsed) != HEADER_SIZE ||
+        std::memcmp(probe.constData() + 12, probe.startsWith("RF64") ? "ds64" : "JUNK", 4) != 0) {
+        // Not one of ours (or a headerless legacy recording); nothing we can safely rewrite
+        return false;
+    }
+
+    // Whatever follows the header is audio; drop a trailing partial frame
+    const qint64 blockAlign = qMax(1, parsed.channelCount * parsed.bytesPerSample);
+    const qint64 length = (file.size() - HEADER_SIZE) / blockAlign * blockAlign;
+    const QByteArray header = makeHeader(parsed, static_cast<quint64>(length));
+    if (!file.seek(0) || file.write(header) != header.size()) {
+        qWarning() << "Cannot repair recording header:" << file.errorString();
+        return false;
+    }
+    file.close();
+
+    if (format) {
+        *format = parsed;
+    }
+    if (dataBytes) {
+        *dataBytes = length;
+    }
+    return true;
+}
+
+bool RecordingFileWriter::repairFlacHeader(QFile& file, AudioFileReader::Format* format, qint64* dataBytes) {
+    // Our files carry STREAMINFO as their only metadata block; leave anything else alone
+    const QByteArray probe = file.peek(FlacEncoder::HEADER_SIZE);
+    if (probe.size() < FlacEncoder::HEADER_SIZE || static_cast<uchar>(probe.at(4)) != 0x80) {
+        return false;
+    }
+
+    // Frames are self-delimiting, so counting them recovers everything written
+    FlacDecoder decoder(&file);
+    if (!decoder.readHeader()) {
+        qWarning() << "Cannot repair recording header:" << decoder.errorString();
+        return false;
+    }
+    QVector<qint32> frame;
+    while (decoder.readFrame(frame) > 0) {
+    }
+
+    const AudioFileReader::Format parsed = decoder.format();
+    const QByteArray header = FlacEncoder::makeStreamHeader(parsed, decoder.decodedSamples(), 0, 0);
+    if (!file.resize(decoder.lastFrameEnd()) || !file.seek(0) || file.write(header) != header.size()) {
+        qWarning() << "Cannot repair recording header:" << file.errorString();
+        return false;
+    }
+    file.close();
+
+    if (format) {
+        *format = parsed;
+    }
+    if (dataBytes) {
+        *dataBytes = static_cast<qint64>(decoder.decodedSamples()) * parsed.channelCount * parsed.bytesPerSample;
+    }
+    return true;
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "../models/BaseModel.h"
+#include "AudioFileReader.h"
+#include "AudioRingBuffer.h"
+#include "FlacCodec.h"
+#include "PolyphaseResampler.h"
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+#include <memory>
+
+class Telemetry;
+
+/**
+ * @brief RecordingFileWriter - Writes captured PCM to a WAV file on its own thread
+ *
+ * The audio path only copies into a lock-free ring allocated by start(); a writer
+ * thread drains it every FLUSH_INTERVAL_MS and issues one large write per batch, so
+ * a slow disk or network share delays the file rather than the capture. A chunk
+ * that finds the ring full (the disk stalled for RING_BYTES of audio) is dropped
+ * whole and counted. The header is written
+ * up front, refreshed on every periodic fsync and finalized by finish(); files
+ * that outgrow 4 GB are converted to RF64 in place. repairHeader() fixes the
+ * sizes of a file whose recording was interrupted.
+ *
+ * With setFileFormat() the file can hold mono float audio at another rate than the
+ * capture; down-mixing and resampling then also happen on the writer thread.
+ * With setCodec(AudioCodec::Flac) integer PCM is compressed to FLAC on that thread
+ * instead; the STREAMINFO header is kept current the same way as the WAV header.
+ *
+ * With setSegmentLength() the audio goes to a series of complete, fixed-length segment
+ * files next to the target instead, each closed (header finalized and fsynced) as the
+ * next one starts, so transcription can pick them up while recording continues and a
+ * crash loses at most the open segment. joinSegments() stitches them into the target
+ * afterwards; FLAC segments end on block boundaries, so their frames are simply
+ * concatenated under one STREAMINFO.
+ */
+class RecordingFileWriter {
+public:
+    explicit RecordingFileWriter(QFile* file);
+    ~RecordingFileWriter();
+
+    // Mono float output, converted from the capture format; call before start()
+    void setFileFormat(const AudioFileReader::Format& format);
+    // Requested codec; float or converted output always stays WAV. Call before start()
+    void setCodec(AudioCodec codec);
+    AudioCodec codec() const; // As written once started
+    // Times every batched write on the writer thread; call before start()
+    void setTelemetry(Telemetry* telemetry);
+
+    struct Segment {
+        int index = 0;
+        QString filePath;
+        int sampleRate = 0;     // Of the file, which the frame counts use
+        qint64 startFrame = 0;
+        qint64 frames = 0;
+    };
+    // Roll over to a new segment file every @p milliseconds of audio; 0 writes the target
+    // directly. FLAC rounds up to whole blocks. Call before start()
+    void setSegmentDuration(int milliseconds);
+    // Segments closed since the last call; finish() closes the last one
+    QList<Segment> takeCompletedSegments();
+    // After finish(): writes the segments into the target file and removes them
+    bool joinSegments();
+
+    // The file must already be open for writing
+    bool start(const AudioFileReader::Format& captureFormat);
+    bool finish();
+    bool isRunning() const { return m_thread != nullptr; }
+
+    // Producer side; never locks, allocates or touches the disk
+    void write(const char* data, qint64 len);
+    quint64 droppedBytes() const { return m_droppedBytes.loadRelaxed(); }
+
+    qint64 dataBytes() const; // Bytes of audio in the file once everything queued is written
+    qint64 fileSize() const; // Encoded size for FLAC, which trails the queue slightly
+    bool hasError() const { return m_failed.loadRelaxed() != 0; }
+    QString errorString() const;
+
+    static QByteArray makeHeader(const AudioFileReader::Format& format, quint64 dataBytes);
+    // "<dir>/<name>.partNNN.<suffix>" for segment @p index of @p filePath
+    static QString segmentPath(const QString& filePath, int index);
+    static QStringList findSegments(const QString& filePath); // In index order
+    // Concatenates finalized segment files (all WAV or all FLAC, same format) into @p output
+    // and removes them; run repairHeader() on an interrupted last segment first
+    static bool stitchSegments(QFile& output, const QStringList& segmentPaths,
+                               AudioFileReader::Format* format = nullptr, qint64* dataBytes = nullptr);
+    // WAV or FLAC; @p dataBytes is the PCM size of the audio that survived
+    static bool repairHeader(const QString& filePath, AudioFileReader::Format* format = nullptr,
+                             qint64* dataBytes = nullptr);
+
+    static constexpr int HEADER_SIZE = 80;                   // RIFF + JUNK(ds64 reserve) + fmt + data
+    static constexpr int RING_BYTES = 8 * 1024 * 1024;       // About 40 s of 48 kHz stereo 16-bit
+    static constexpr int BUFFER_BYTES = 1024 * 1024;         // Largest batch drained per write
+    static constexpr int FLUSH_INTERVAL_MS = 500;
+    static constexpr int FSYNC_INTERVAL_MS = 5000;
+    static constexpr int STITCH_CHUNK_BYTES = 1024 * 1024;
+
+private:
+    void run();
+    bool writeBuffer(const QByteArray& buffer);
+    bool writeFileData(const char* data, qint64 len);
+    bool writeConverted(const QByteArray& buffer);
+    bool writeEncoded(const QByteArray& encoded);
+    static bool repairFlacHeader(QFile& file, AudioFileReader::Format* format, qint64* dataBytes);
+    qint64 segmentRoom() const; // File-format bytes the open segment can still take
+    bool openSegment(int index);
+    bool closeSegment();
+    bool patchHeader();
+    bool syncToDisk();
+    void fail(const QString& message);
+
+    QFile* m_file;
+    AudioFileReader::Format m_captureFormat;
+    AudioFileReader::Format m_format;       // As written to the file
+    bool m_hasFileFormat;
+    bool m_converting;
+    AudioCodec m_codec;
+    bool m_flac;
+    QThread* m_thread;
+    QFile* m_target;            // m_file, or the open segment
+    Telemetry* m_telemetry;
+
+    // Segmentation (writer thread, or after finish() has joined it)
+    int m_segmentMs;
+    qint64 m_segmentFrames;
+    std::unique_ptr<QFile> m_segmentFile;
+    int m_segmentIndex;
+    qint64 m_segmentStartFrame;
+    qint64 m_segmentBytes;      // File-format bytes fed into the open segment
+    QList<Segment> m_completedSegments; // Guarded by m_mutex
+    QStringList m_segmentPaths;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_dataReady;
+    AudioRingBuffer m_ring;     // Filled by write(), drained by the writer thread
+    QByteArray m_backBuffer;    // Writer thread only; keeps its capacity between batches
+    bool m_stopping;
+    QString m_errorString;
+
+    QAtomicInteger<qint64> m_queuedBytes;
+    QAtomicInteger<quint64> m_droppedBytes;
+    QAtomicInteger<qint64> m_fileBytes;  // FLAC bytes written after the header, for fileSize()
+    QAtomicInt m_failed;
+    qint64 m_writtenBytes;      // Written to m_target after its header; writer thread only
+    
+    // Format conversion state (writer thread only)
+    PolyphaseResampler m_resampler;
+    QByteArray m_partialFrame;
+    QVector<float> m_converted;
+    
+    // FLAC state (writer thread only, or after finish() has joined it)
+    FlacEncoder m_encoder;
+    QByteArray m_encoded;
+};
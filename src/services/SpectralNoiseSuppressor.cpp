@@ -0,0 +1,339 @@
+#include "SpectralNoiseSuppressor.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QUILLSCRIBE_NS_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define QUILLSCRIBE_NS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr float NOISE_EPSILON = 1e-12f;     // Keeps digital silence from dividing by zero
+constexpr float INITIAL_NOISE = 1e30f;      // The first frames set the floor
+
+#ifdef QUILLSCRIBE_NS_NEON
+inline float32x4_t divide(float32x4_t a, float32x4_t b) {
+#if defined(__aarch64__) || defined(_M_ARM64)
+    return vdivq_f32(a, b);
+#else
+    // ARMv7 has no vector divide: reciprocal estimate refined by two Newton steps
+    float32x4_t r = vrecpeq_f32(b);
+    r = vmulq_f32(vrecpsq_f32(b, r), r);
+    r = vmulq_f32(vrecpsq_f32(b, r), r);
+    return vmulq_f32(a, r);
+#endif
+}
+#endif
+
+void multiply(float* out, const float* a, const float* b, int count) {
+    int i = 0;
+#if defined(QUILLSCRIBE_NS_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+#elif defined(QUILLSCRIBE_NS_NEON)
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(out + i, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = a[i] * b[i];
+    }
+}
+
+// One radix-2 stage over a group: a' = a + w*b, b' = a - w*b
+void butterflies(float* aRe, float* aIm, float* bRe, float* bIm, const float* wRe, const float* wIm, int count) {
+    int k = 0;
+#if defined(QUILLSCRIBE_NS_SSE2)
+    for (; k + 4 <= count; k += 4) {
+        const __m128 xr = _mm_loadu_ps(bRe + k);
+        const __m128 xi = _mm_loadu_ps(bIm + k);
+        const __m128 cr = _mm_loadu_ps(wRe + k);
+        const __m128 ci = _mm_loadu_ps(wIm + k);
+        const __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, cr), _mm_mul_ps(xi, ci));
+        const __m128 ti = _mm_add_ps(_mm_mul_ps(xr, ci), _mm_mul_ps(xi, cr));
+        const __m128 ar = _mm_loadu_ps(aRe + k);
+        const __m128 ai = _mm_loadu_ps(aIm + k);
+        _mm_storeu_ps(aRe + k, _mm_add_ps(ar, tr));
+        _mm_storeu_ps(aIm + k, _mm_add_ps(ai, ti));
+        _mm_storeu_ps(bRe + k, _mm_sub_ps(ar, tr));
+        _mm_storeu_ps(bIm + k, _mm_sub_ps(ai, ti));
+    }
+#elif defined(QUILLSCRIBE_NS_NEON)
+    for (; k + 4 <= count; k += 4) {
+        const float32x4_t xr = vld1q_f32(bRe + k);
+        const float32x4_t xi = vld1q_f32(bIm + k);
+        const float32x4_t cr = vld1q_f32(wRe + k);
+        const float32x4_t ci = vld1q_f32(wIm + k);
+        const float32x4_t tr = vmlsq_f32(vmulq_f32(xr, cr), xi, ci);
+        const float32x4_t ti = vmlaq_f32(vmulq_f32(xr, ci), xi, cr);
+        const float32x4_t ar = vld1q_f32(aRe + k);
+        const float32x4_t ai = vld1q_f32(aIm + k);
+        vst1q_f32(aRe + k, vaddq_f32(ar, tr));
+        vst1q_f32(aIm + k, vaddq_f32(ai, ti));
+        vst1q_f32(bRe + k, vsubq_f32(ar, tr));
+        vst1q_f32(bIm + k, vsubq_f32(ai, ti));
+    }
+#endif
+    for (; k < count; ++k) {
+        const float tr = bRe[k] * wRe[k] - bIm[k] * wIm[k];
+        const float ti = bRe[k] * wIm[k] + bIm[k] * wRe[k];
+        bRe[k] = aRe[k] - tr;
+        bIm[k] = aIm[k] - ti;
+        aRe[k] += tr;
+        aIm[k] += ti;
+    }
+}
+
+struct GainState {
+    float* re;
+    float* im;
+    float* smoothedPower;
+    float* noisePower;
+    float* prevSnr;
+    float* gain;
+};
+
+inline void scalarGain(GainState& s, int k, float smoothing, float rise) {
+    const float power = s.re[k] * s.re[k] + s.im[k] * s.im[k];
+    const float smoothed = smoothing * s.smoothedPower[k] + (1.0f - smoothing) * power;
+    const float noise = std::min(smoothed, s.noisePower[k] * rise);
+    const float postSnr = power / (noise * SpectralNoiseSuppressor::NOISE_BIAS + NOISE_EPSILON);
+    const float alpha = SpectralNoiseSuppressor::DD_ALPHA;
+    const float prioSnr = alpha * s.prevSnr[k] + (1.0f - alpha) * std::max(postSnr - 1.0f, 0.0f);
+    const float gain = std::max(prioSnr / (1.0f + prioSnr), SpectralNoiseSuppressor::MIN_GAIN);
+    s.smoothedPower[k] = smoothed;
+    s.noisePower[k] = noise;
+    s.prevSnr[k] = gain * gain * postSnr;
+    s.gain[k] = gain;
+}
+
+void computeGains(GainState& s, int count, float smoothing, float rise) {
+    int k = 0;
+#if defined(QUILLSCRIBE_NS_SSE2)
+    const __m128 vSmoothing = _mm_set1_ps(smoothing);
+    const __m128 vInput = _mm_set1_ps(1.0f - smoothing);
+    const __m128 vRise = _mm_set1_ps(rise);
+    const __m128 vBias = _mm_set1_ps(SpectralNoiseSuppressor::NOISE_BIAS);
+    const __m128 vEpsilon = _mm_set1_ps(NOISE_EPSILON);
+    const __m128 vAlpha = _mm_set1_ps(SpectralNoiseSuppressor::DD_ALPHA);
+    const __m128 vOneMinusAlpha = _mm_set1_ps(1.0f - SpectralNoiseSuppressor::DD_ALPHA);
+    const __m128 vOne = _mm_set1_ps(1.0f);
+    const __m128 vMinGain = _mm_set1_ps(SpectralNoiseSuppressor::MIN_GAIN);
+    for (; k + 4 <= count; k += 4) {
+        const __m128 re = _mm_loadu_ps(s.re + k);
+        const __m128 im = _mm_loadu_ps(s.im + k);
+        const __m128 power = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+        const __m128 smoothed = _mm_add_ps(_mm_mul_ps(vSmoothing, _mm_loadu_ps(s.smoothedPower + k)),
+                                           _mm_mul_ps(vInput, power));
+        const __m128 noise = _mm_min_ps(smoothed, _mm_mul_ps(_mm_loadu_ps(s.noisePower + k), vRise));
+        const __m128 postSnr = _mm_div_ps(power, _mm_add_ps(_mm_mul_ps(noise, vBias), vEpsilon));
+        const __m128 prioSnr = _mm_add_ps(_mm_mul_ps(vAlpha, _mm_loadu_ps(s.prevSnr + k)),
+                                          _mm_mul_ps(vOneMinusAlpha, _mm_max_ps(_mm_sub_ps(postSnr, vOne), _mm_setzero_ps())));
+        const __m128 gain = _mm_max_ps(_mm_div_ps(prioSnr, _mm_add_ps(vOne, prioSnr)), vMinGain);
+        _mm_storeu_ps(s.smoothedPower + k, smoothed);
+        _mm_storeu_ps(s.noisePower + k, noise);
+        _mm_storeu_ps(s.prevSnr + k, _mm_mul_ps(_mm_mul_ps(gain, gain), postSnr));
+        _mm_storeu_ps(s.gain + k, gain);
+    }
+#elif defined(QUILLSCRIBE_NS_NEON)
+    const float32x4_t vSmoothing = vdupq_n_f32(smoothing);
+    const float32x4_t vInput = vdupq_n_f32(1.0f - smoothing);
+    const float32x4_t vRise = vdupq_n_f32(rise);
+    const float32x4_t vBias = vdupq_n_f32(SpectralNoiseSuppressor::NOISE_BIAS);
+    const float32x4_t vEpsilon = vdupq_n_f32(NOISE_EPSILON);
+    const float32x4_t vAlpha = vdupq_n_f32(SpectralNoiseSuppressor::DD_ALPHA);
+    const float32x4_t vOneMinusAlpha = vdupq_n_f32(1.0f - SpectralNoiseSuppressor::DD_ALPHA);
+    const float32x4_t vOne = vdupq_n_f32(1.0f);
+    const float32x4_t vMinGain = vdupq_n_f32(SpectralNoiseSuppressor::MIN_GAIN);
+    for (; k + 4 <= count; k += 4) {
+        const float32x4_t re = vld1q_f32(s.re + k);
+        const float32x4_t im = vld1q_f32(s.im + k);
+        const float32x4_t power = vmlaq_f32(vmulq_f32(re, re), im, im);
+        const float32x4_t smoothed = vmlaq_f32(vmulq_f32(vInput, power), vSmoothing, vld1q_f32(s.smoothedPower + k));
+        const float32x4_t noise = vminq_f32(smoothed, vmulq_f32(vld1q_f32(s.noisePower + k), vRise));
+        const float32x4_t postSnr = divide(power, vmlaq_f32(vEpsilon, noise, vBias));
+        const float32x4_t prioSnr = vmlaq_f32(vmulq_f32(vOneMinusAlpha, vmaxq_f32(vsubq_f32(postSnr, vOne), vdupq_n_f32(0.0f))),
+                                              vAlpha, vld1q_f32(s.prevSnr + k));
+        const float32x4_t gain = vmaxq_f32(divide(prioSnr, vaddq_f32(vOne, prioSnr)), vMinGain);
+        vst1q_f32(s.smoothedPower + k, smoothed);
+        vst1q_f32(s.noisePower + k, noise);
+        vst1q_f32(s.prevSnr + k, vmulq_f32(vmulq_f32(gain, gain), postSnr));
+        vst1q_f32(s.gain + k, gain);
+    }
+#endif
+    for (; k < count; ++k) {
+        scalarGain(s, k, smoothing, rise);
+    }
+}
+
+} // namespace
+
+SpectralNoiseSuppressor::SpectralNoiseSuppressor()
+    : m_sampleRate(0)
+    , m_frameSize(0)
+    , m_hopSize(0)
+    , m_binCount(0)
+    , m_enabled(true)
+    , m_noiseRise(1.0f)
+    , m_hopPos(0)
+    , m_frameCount(0)
+{
+    configure(16000);
+}
+
+void SpectralNoiseSuppressor::configure(int sampleRate) {
+    m_sampleRate = qMax(1, sampleRate);
+
+    const int target = qMax(8, m_sampleRate * FRAME_MS / 1000);
+    m_frameSize = 8;
+    while (m_frameSize < target) {
+        m_frameSize *= 2;
+    }
+    m_hopSize = m_frameSize / 2;
+    m_binCount = m_frameSize / 2 + 1;
+
+    const double hopSeconds = static_cast<double>(m_hopSize) / m_sampleRate;
+    m_noiseRise = static_cast<float>(std::pow(10.0, NOISE_RISE_DB_PER_SECOND * hopSeconds / 10.0));
+
+    // Periodic Hann, square-rooted for analysis and synthesis: w^2 overlap-adds to 1 at 50%
+    m_window.resize(m_frameSize);
+    for (int n = 0; n < m_frameSize; ++n) {
+        m_window[n] = static_cast<float>(std::sqrt(0.5 * (1.0 - std::cos(2.0 * PI * n / m_frameSize))));
+    }
+
+    m_twiddleRe.resize(m_frameSize - 1);
+    m_twiddleIm.resize(m_frameSize - 1);
+    for (int half = 1; half < m_frameSize; half *= 2) {
+        for (int k = 0; k < half; ++k) {
+            m_twiddleRe[half - 1 + k] = static_cast<float>(std::cos(PI * k / half));
+            m_twiddleIm[half - 1 + k] = static_cast<float>(-std::sin(PI * k / half));
+        }
+    }
+
+    m_bitReverse.resize(m_frameSize);
+    int bits = 0;
+    while ((1 << bits) < m_frameSize) {
+        ++bits;
+    }
+    for (int n = 0; n < m_frameSize; ++n) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            reversed |= ((n >> b) & 1) << (bits - 1 - b);
+        }
+        m_bitReverse[n] = reversed;
+    }
+
+    m_frame.resize(m_frameSize);
+    m_overlap.resize(m_hopSize);
+    m_output.resize(m_hopSize);
+    m_re.resize(m_frameSize);
+    m_im.resize(m_frameSize);
+    m_smoothedPower.resize(m_binCount);
+    m_noisePower.resize(m_binCount);
+    m_prevSnr.resize(m_binCount);
+    m_gain.resize(m_binCount);
+    reset();
+}
+
+void SpectralNoiseSuppressor::reset() {
+    std::fill(m_frame.begin(), m_frame.end(), 0.0f);
+    std::fill(m_overlap.begin(), m_overlap.end(), 0.0f);
+    std::fill(m_output.begin(), m_output.end(), 0.0f);
+    std::fill(m_smoothedPower.begin(), m_smoothedPower.end(), 0.0f);
+    std::fill(m_noisePower.begin(), m_noisePower.end(), INITIAL_NOISE);
+    std::fill(m_prevSnr.begin(), m_prevSnr.end(), 0.0f);
+    m_hopPos = 0;
+    m_frameCount = 0;
+}
+
+void SpectralNoiseSuppressor::process(float* samples, int count) {
+    // The second half of m_frame collects the hop; the output lags it by one frame
+    float* incoming = m_frame.data() + m_hopSize;
+    const float* outgoing = m_output.constData();
+    for (int i = 0; i < count; ++i) {
+        const float sample = samples[i];
+        samples[i] = outgoing[m_hopPos];
+        incoming[m_hopPos] = sample;
+        if (++m_hopPos == m_hopSize) {
+            processFrame();
+            m_hopPos = 0;
+        }
+    }
+}
+
+void SpectralNoiseSuppressor::processFrame() {
+    float* re = m_re.data();
+    float* im = m_im.data();
+    const float* window = m_window.constData();
+    multiply(re, m_frame.constData(), window, m_frameSize);
+
+    if (m_enabled) {
+        std::fill(m_im.begin(), m_im.end(), 0.0f);
+        fft(re, im);
+        applyGains();
+
+        // Inverse through the conjugate; only the real part is needed
+        for (int n = 0; n < m_frameSize; ++n) {
+            im[n] = -im[n];
+        }
+        fft(re, im);
+        const float scale = 1.0f / m_frameSize;
+        for (int n = 0; n < m_frameSize; ++n) {
+            re[n] *= scale;
+        }
+    }
+
+    multiply(re, re, window, m_frameSize);
+    float* output = m_output.data();
+    float* overlap = m_overlap.data();
+    for (int n = 0; n < m_hopSize; ++n) {
+        output[n] = overlap[n] + re[n];
+        overlap[n] = re[m_hopSize + n];
+    }
+    std::copy(m_frame.constBegin() + m_hopSize, m_frame.constEnd(), m_frame.begin());
+}
+
+void SpectralNoiseSuppressor::fft(float* re, float* im) const {
+    const int* reverse = m_bitReverse.constData();
+    for (int n = 0; n < m_frameSize; ++n) {
+        const int r = reverse[n];
+        if (n < r) {
+            std::swap(re[n], re[r]);
+            std::swap(im[n], im[r]);
+        }
+    }
+
+    for (int half = 1; half < m_frameSize; half *= 2) {
+        const float* wRe = m_twiddleRe.constData() + half - 1;
+        const float* wIm = m_twiddleIm.constData() + half - 1;
+        for (int group = 0; group < m_frameSize; group += 2 * half) {
+            butterflies(re + group, im + group, re + group + half, im + group + half, wRe, wIm, half);
+        }
+    }
+}
+
+void SpectralNoiseSuppressor::applyGains() {
+    GainState state{m_re.data(), m_im.data(), m_smoothedPower.data(), m_noisePower.data(),
+                    m_prevSnr.data(), m_gain.data()};
+    // No history to smooth against on the first frame
+    const float smoothing = m_frameCount == 0 ? 0.0f : POWER_SMOOTHING;
+    computeGains(state, m_binCount, smoothing, m_noiseRise);
+    ++m_frameCount;
+
+    float* re = m_re.data();
+    float* im = m_im.data();
+    const float* gain = m_gain.constData();
+    multiply(re, re, gain, m_binCount);
+    multiply(im, im, gain, m_binCount);
+    // The upper half mirrors the lower one for real input
+    for (int k = 1; k < m_binCount - 1; ++k) {
+        re[m_frameSize - k] *= gain[k];
+        im[m_frameSize - k] *= gain[k];
+    }
+}
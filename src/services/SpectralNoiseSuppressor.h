@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief SpectralNoiseSuppressor - Streaming STFT noise suppression for one channel
+ *
+ * Frames of frameSize() samples (the power of two at or above FRAME_MS) are taken
+ * every frameSize()/2 samples with a square-root Hann window, so analysis plus
+ * synthesis overlap-adds back to the input exactly. The noise floor of every bin
+ * is tracked as the slowly rising minimum of its smoothed power, and a
+ * decision-directed Wiener gain, floored at MIN_GAIN, is applied per bin.
+ *
+ * process() works in place on any number of samples and delays the signal by
+ * exactly latency() samples; all buffers are sized by configure(), so it never
+ * allocates. The FFT butterflies, windowing and gain loops use SSE2 or NEON.
+ */
+class SpectralNoiseSuppressor {
+public:
+    SpectralNoiseSuppressor();
+
+    void configure(int sampleRate);
+    void reset();
+
+    // While disabled frames are only windowed and overlap-added: same delay, no FFT
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+    bool isEnabled() const { return m_enabled; }
+
+    void process(float* samples, int count);
+
+    int frameSize() const { return m_frameSize; }
+    int latency() const { return m_frameSize; }
+
+    static constexpr int FRAME_MS = 20;
+    static constexpr float MIN_GAIN = 0.1f;             // -20 dB; deeper floors start to sound watery
+    static constexpr float DD_ALPHA = 0.98f;            // Decision-directed a-priori SNR smoothing
+    static constexpr float POWER_SMOOTHING = 0.7f;      // Recursive averaging of bin power
+    static constexpr float NOISE_BIAS = 1.5f;           // A minimum underestimates the mean noise power
+    static constexpr float NOISE_RISE_DB_PER_SECOND = 3.0f;
+
+private:
+    void processFrame();
+    void fft(float* re, float* im) const;
+    void applyGains();
+
+    int m_sampleRate;
+    int m_frameSize;            // N
+    int m_hopSize;              // N / 2
+    int m_binCount;             // N / 2 + 1
+    bool m_enabled;
+    float m_noiseRise;          // Per-frame growth factor of the noise minimum
+
+    QVector<float> m_window;
+    QVector<float> m_twiddleRe; // Stage by stage, N - 1 entries
+    QVector<float> m_twiddleIm;
+    QVector<int> m_bitReverse;
+
+    QVector<float> m_frame;     // Last N input samples
+    QVector<float> m_overlap;   // Synthesis tail carried into the next hop
+    QVector<float> m_output;    // Completed hop, read out while the next one fills
+    int m_hopPos;
+
+    QVector<float> m_re;
+    QVector<float> m_im;
+    QVector<float> m_smoothedPower;
+    QVector<float> m_noisePower;
+    QVector<float> m_prevSnr;   // |S|^2 / noise of the previous frame
+    QVector<float> m_gain;
+    qint64 m_frameCount;
+};
@@ -0,0 +1,120 @@
+#include "SqliteBackup.h"
+#include "SqliteWriter.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+
+SqliteBackup::SqliteBackup()
+    : m_thread(nullptr)
+{
+}
+
+SqliteBackup::~SqliteBackup() {
+    wait();
+}
+
+bool SqliteBackup::start(const QString& databasePath, const QString& destinationPath,
+                         const QString& connectionName, QObject* context, Completion done) {
+    QMutexLocker locker(&m_mutex);
+    if (m_thread) {
+        return false;
+    }
+
+    m_destinationPath = destinationPath;
+    m_context = context;
+    m_done = std::move(done);
+    m_errorMessage.clear();
+
+    m_thread = QThread::create([this, databasePath, destinationPath, connectionName]() {
+        const QString errorMessage = backupInto(databasePath, destinationPath, connectionName);
+        QMutexLocker locker(&m_mutex);
+        m_errorMessage = errorMessage;
+    });
+    m_thread->setObjectName("SqliteBackup");
+    QObject::connect(m_thread, &QThread::finished, m_thread, [this]() { finish(); }, Qt::DirectConnection);
+    m_thread->start(QThread::LowPriority);
+    return true;
+}
+
+bool SqliteBackup::isRunning() const {
+    QMutexLocker locker(&m_mutex);
+    return m_thread != nullptr;
+}
+
+void SqliteBackup::wait() {
+    QThread* thread = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        thread = m_thread;
+    }
+    if (thread) {
+        thread->wait();
+    }
+}
+
+QString SqliteBackup::destinationPath() const {
+    QMutexLocker locker(&m_mutex);
+    return m_destinationPath;
+}
+
+qint64 SqliteBackup::bytesWritten() const {
+    const QString partialPath = destinationPath() + PARTIAL_FILE_SUFFIX;
+    return QFileInfo(partialPath).size();
+}
+
+QString SqliteBackup::backupInto(const QString& databasePath, const QString& destinationPath,
+                                 const QString& connectionName) {
+    const QString partialPath = destinationPath + PARTIAL_FILE_SUFFIX;
+    QFile::remove(partialPath); // VACUUM INTO refuses to overwrite a leftover
+
+    QString errorMessage;
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        database.setDatabaseName(databasePath);
+        if (!database.open()) {
+            errorMessage = database.lastError().text();
+        } else if (SqliteWriter::configureConnection(database, &errorMessage)) {
+            QSqlQuery query(database);
+            query.prepare("VACUUM INTO ?");
+            query.addBindValue(partialPath);
+            if (!query.exec()) {
+                errorMessage = query.lastError().text();
+            }
+        }
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    if (errorMessage.isEmpty()) {
+        QFile::remove(destinationPath);
+        if (!QFile::rename(partialPath, destinationPath)) {
+            errorMessage = "Cannot move backup into place: " + destinationPath;
+        }
+    }
+    if (!errorMessage.isEmpty()) {
+        QFile::remove(partialPath);
+    }
+    return errorMessage;
+}
+
+void SqliteBackup::finish() {
+    // Runs on the backup thread as it finishes
+    QMutexLocker locker(&m_mutex);
+    QThread* thread = m_thread;
+    m_thread = nullptr;
+    thread->deleteLater();
+
+    Completion done = std::move(m_done);
+    QPointer<QObject> context = m_context;
+    const QString errorMessage = m_errorMessage;
+    locker.unlock();
+
+    if (done && context) {
+        QMetaObject::invokeMethod(context.data(), [done, errorMessage]() {
+            done(errorMessage.isEmpty(), errorMessage);
+        }, Qt::QueuedConnection);
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QThread>
+#include <functional>
+
+/**
+ * @brief SqliteBackup - Consistent online copy of the database on a background thread
+ *
+ * The copy is made with VACUUM INTO on a connection of its own. That reads one WAL
+ * snapshot, so the backup is consistent while the writer keeps committing, and only
+ * holds a read transaction, so neither readers nor the writer wait for it. The copy
+ * is written next to the destination as "<destination>.part" and renamed into place
+ * once complete, so a failed or interrupted backup never replaces a good one.
+ *
+ * QtSql does not expose sqlite3_backup_step(), so there is no page count to report;
+ * progress is the size of the partial file, which VACUUM INTO writes as it goes.
+ */
+class SqliteBackup {
+public:
+    using Completion = std::function<void(bool ok, const QString& errorMessage)>;
+
+    SqliteBackup();
+    ~SqliteBackup();
+
+    // Starts the copy; false if one is already running. @p done runs on the thread
+    // of @p context when the copy has finished or failed.
+    bool start(const QString& databasePath, const QString& destinationPath,
+               const QString& connectionName, QObject* context, Completion done);
+    bool isRunning() const;
+    void wait();
+
+    QString destinationPath() const;
+    qint64 bytesWritten() const;
+
+    // The same copy on the calling thread; returns the error, empty on success
+    static QString backupInto(const QString& databasePath, const QString& destinationPath,
+                              const QString& connectionName);
+
+    static constexpr const char* PARTIAL_FILE_SUFFIX = ".part";
+
+private:
+    void finish();
+
+    QThread* m_thread;
+    mutable QMutex m_mutex;
+    QString m_destinationPath;
+    QPointer<QObject> m_context;
+    Completion m_done;
+    QString m_errorMessage;
+};
@@ -0,0 +1,479 @@
+#include "SqliteWriter.h"
+#include "Telemetry.h"
+#include <QDebug>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <algorithm>
+
+SqliteWriter::SqliteWriter()
+    : m_thread(nullptr)
+    , m_telemetry(nullptr)
+    , m_groupDepth(0)
+    , m_nextSequence(1)
+    , m_committedSequence(0)
+    , m_stopping(false)
+    , m_startFinished(false)
+    , m_startOk(false)
+{
+}
+
+SqliteWriter::~SqliteWriter() {
+    stop();
+
+    // Contexts may outlive the writer; their destroyed() handlers must not reach it
+    QMutexLocker locker(&m_contextsMutex);
+    for (const auto& token : std::as_const(m_contexts)) {
+        QObject::disconnect(token->destroyed);
+    }
+    m_contexts.clear();
+}
+
+bool SqliteWriter::start(const QString& databasePath, const QString& connectionName) {
+    if (m_thread) {
+        return false;
+    }
+
+    m_databasePath = databasePath;
+    m_connectionName = connectionName;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = false;
+        m_startFinished = false;
+        m_startOk = false;
+        m_lastError.clear();
+    }
+
+    // The connection belongs to the thread that opens it, so the writer opens its own
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("SqliteWriter");
+    m_thread->start();
+
+    QMutexLocker locker(&m_mutex);
+    while (!m_startFinished) {
+        m_committed.wait(&m_mutex);
+    }
+    if (!m_startOk) {
+        locker.unlock();
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void SqliteWriter::stop() {
+    if (!m_thread) {
+        return;
+    }
+
+    discardGroup();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_queued.wakeOne();
+    }
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+quint64 SqliteWriter::enqueue(const Statement& statement, QObject* context, Completion done) {
+    return enqueue(QList<Statement>{statement}, context, std::move(done));
+}
+
+quint64 SqliteWriter::enqueue(const QList<Statement>& statements, QObject* context, Completion done) {
+    Write write;
+    write.statements = statements;
+    write.context = contextToken(context);
+    write.done = std::move(done);
+    return enqueueWrite(std::move(write));
+}
+
+quint64 SqliteWriter::enqueueStandalone(const QString& sql, QObject* context, Completion done) {
+    Write write;
+    write.statements = {Statement{sql, {}, {}}};
+    write.context = contextToken(context);
+    write.done = std::move(done);
+    write.standalone = true;
+    return enqueueWrite(std::move(write));
+}
+
+quint64 SqliteWriter::enqueueWrite(Write write) {
+    QMutexLocker locker(&m_mutex);
+    if (!m_thread || m_stopping) {
+        locker.unlock();
+        write.errorMessage = "Database writer is not running";
+        deliver(write);
+        return 0;
+    }
+    if (m_groupDepth > 0 && write.standalone) {
+        locker.unlock();
+        write.errorMessage = "Cannot run " + write.statements.first().sql + " inside a transaction";
+        deliver(write);
+        return 0;
+    }
+    if (m_groupDepth > 0) {
+        m_group.append(std::move(write));
+        return 0; // Sequenced when the group is committed
+    }
+
+    write.sequence = m_nextSequence++;
+    const quint64 sequence = write.sequence;
+    m_queue.append(std::move(write));
+    m_queued.wakeOne();
+    return sequence;
+}
+
+bool SqliteWriter::waitForWrite(quint64 sequence, int timeoutMs) {
+    QMutexLocker locker(&m_mutex);
+    if (!reachedLocked(sequence, QDeadlineTimer(timeoutMs))) {
+        return false;
+    }
+    return !std::binary_search(m_failedSequences.cbegin(), m_failedSequences.cend(), sequence);
+}
+
+bool SqliteWriter::waitForQueuedWrites(int timeoutMs) {
+    QMutexLocker locker(&m_mutex);
+    // The common case is nothing pending, which returns without waiting
+    return reachedLocked(m_nextSequence - 1, QDeadlineTimer(timeoutMs));
+}
+
+bool SqliteWriter::reachedLocked(quint64 sequence, QDeadlineTimer deadline) {
+    while (m_committedSequence < sequence && m_thread) {
+        if (!m_committed.wait(&m_mutex, deadline)) {
+            qWarning() << "SqliteWriter: timed out waiting for write" << sequence;
+            return false;
+        }
+    }
+    return m_committedSequence >= sequence;
+}
+
+quint64 SqliteWriter::committedSequence() const {
+    QMutexLocker locker(&m_mutex);
+    return m_committedSequence;
+}
+
+void SqliteWriter::beginGroup() {
+    QMutexLocker locker(&m_mutex);
+    ++m_groupDepth;
+}
+
+void SqliteWriter::commitGroup() {
+    QList<Write> held;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_groupDepth == 0 || --m_groupDepth > 0) {
+            return;
+        }
+        held.swap(m_group);
+    }
+    if (held.isEmpty()) {
+        return;
+    }
+
+    // One write, so the group is applied together or not at all; each member
+    // still hears back through its own completion
+    QList<Statement> statements;
+    for (const Write& write : held) {
+        statements += write.statements;
+    }
+    enqueue(statements, nullptr, [held](bool ok, const QString& errorMessage) mutable {
+        for (Write& write : held) {
+            write.ok = ok;
+            write.errorMessage = errorMessage;
+            deliver(write);
+        }
+    });
+}
+
+void SqliteWriter::discardGroup() {
+    QList<Write> held;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_groupDepth == 0) {
+            return;
+        }
+        m_groupDepth = 0;
+        held.swap(m_group);
+    }
+    for (Write& write : held) {
+        write.errorMessage = "Transaction rolled back";
+        deliver(write);
+    }
+}
+
+QString SqliteWriter::lastError() const {
+    QMutexLocker locker(&m_mutex);
+    return m_lastError;
+}
+
+void SqliteWriter::setTelemetry(Telemetry* telemetry) {
+    m_telemetry.storeRelease(telemetry);
+}
+
+bool SqliteWriter::configureConnection(QSqlDatabase& database, QString* errorMessage) {
+    // NORMAL is durable across application crashes in WAL mode; only a power loss
+    // can drop the last commits, never corrupt the file
+    const QStringList pragmas = {
+        "PRAGMA journal_mode = WAL",
+        "PRAGMA synchronous = NORMAL",
+        QString("PRAGMA cache_size = -%1").arg(CACHE_SIZE_KIB),
+        QString("PRAGMA mmap_size = %1").arg(MMAP_SIZE_BYTES),
+        "PRAGMA temp_store = MEMORY",
+        QString("PRAGMA busy_timeout = %1").arg(BUSY_TIMEOUT_MS),
+    };
+
+    QSqlQuery query(database);
+    for (const QString& pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            if (errorMessage) {
+                *errorMessage = pragma + ": " + query.lastError().text();
+            }
+            return false;
+        }
+    }
+
+    // Filesystems without shared memory support (some network homes) stay on the rollback journal
+    if (query.exec("PRAGMA journal_mode") && query.next() &&
+        query.value(0).toString().compare("wal", Qt::CaseInsensitive) != 0) {
+        qWarning() << "SQLite WAL mode unavailable, using journal mode" << query.value(0).toString();
+    }
+    return true;
+}
+
+void SqliteWriter::run() {
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+        database.setDatabaseName(m_databasePath);
+        QString errorMessage;
+        bool ok = database.open();
+        if (!ok) {
+            errorMessage = database.lastError().text();
+        } else {
+            ok = configureConnection(database, &errorMessage);
+        }
+        m_statements.setDatabase(database);
+
+        {
+            QMutexLocker locker(&m_mutex);
+            m_startFinished = true;
+            m_startOk = ok;
+            if (!ok) {
+                m_lastError = "Cannot open database writer: " + errorMessage;
+                qWarning() << "SqliteWriter:" << m_lastError;
+            }
+            m_committed.wakeAll();
+        }
+
+        while (ok) {
+            QList<Write> writes;
+            {
+                QMutexLocker locker(&m_mutex);
+                while (m_queue.isEmpty() && !m_stopping) {
+                    m_queued.wait(&m_mutex);
+                }
+                if (m_queue.isEmpty()) {
+                    break; // Stopping with nothing left to commit
+                }
+                // Everything that queued up during the last commit goes into this one,
+                // up to the next standalone write, which runs by itself
+                qsizetype count = 0;
+                if (m_queue.first().standalone) {
+                    count = 1;
+                } else {
+                    while (count < m_queue.size() && count < MAX_GROUP_WRITES && !m_queue.at(count).standalone) {
+                        ++count;
+                    }
+                }
+                if (count == m_queue.size()) {
+                    writes.swap(m_queue);
+                } else {
+                    writes = m_queue.mid(0, count);
+                    m_queue.remove(0, count);
+                }
+            }
+
+            QElapsedTimer commitTimer;
+            commitTimer.start();
+            if (writes.first().standalone) {
+                runStandalone(database, writes.first());
+            } else {
+                commitWrites(database, writes);
+            }
+            if (Telemetry* telemetry = m_telemetry.loadAcquire()) {
+                telemetry->recordStage(Telemetry::STAGE_DB, commitTimer.nsecsElapsed() / 1000);
+            }
+
+            {
+                QMutexLocker locker(&m_mutex);
+                // Done is not committed: waitForWrite() tells the failed ones apart
+                for (const Write& write : std::as_const(writes)) {
+                    if (!write.ok) {
+                        m_failedSequences.append(write.sequence);
+                    }
+                }
+                if (m_failedSequences.size() > MAX_TRACKED_FAILURES) {
+                    m_failedSequences.remove(0, m_failedSequences.size() - MAX_TRACKED_FAILURES);
+                }
+                m_committedSequence = writes.last().sequence;
+                m_committed.wakeAll();
+            }
+            for (Write& write : writes) {
+                deliver(write);
+            }
+        }
+
+        m_statements.clear();
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+void SqliteWriter::commitWrites(QSqlDatabase& database, QList<Write>& writes) {
+    QSqlQuery control(database);
+
+    // IMMEDIATE takes the write lock up front instead of failing on the first write
+    if (!control.exec("BEGIN IMMEDIATE")) {
+        const QString errorMessage = "Cannot begin write transaction: " + control.lastError().text();
+        for (Write& write : writes) {
+            write.errorMessage = errorMessage;
+        }
+        QMutexLocker locker(&m_mutex);
+        m_lastError = errorMessage;
+        return;
+    }
+
+    // A savepoint that cannot be opened fails its write; one that cannot be rolled
+    // back or released leaves the transaction in an unknown state, so all of it goes
+    QString abortMessage;
+    for (Write& write : writes) {
+        if (!control.exec("SAVEPOINT queued_write")) {
+            write.ok = false;
+            write.errorMessage = "Cannot open savepoint: " + control.lastError().text();
+            qWarning() << "SqliteWriter: write failed:" << write.errorMessage;
+            continue;
+        }
+        write.ok = applyWrite(write);
+        if (!write.ok) {
+            qWarning() << "SqliteWriter: write failed:" << write.errorMessage;
+            if (!control.exec("ROLLBACK TO queued_write")) {
+                abortMessage = "Cannot roll back failed write: " + control.lastError().text();
+                break;
+            }
+        }
+        if (!control.exec("RELEASE queued_write")) {
+            abortMessage = "Cannot release savepoint: " + control.lastError().text();
+            break;
+        }
+    }
+
+    if (!abortMessage.isEmpty()) {
+        control.exec("ROLLBACK");
+        for (Write& write : writes) {
+            write.ok = false;
+            write.errorMessage = abortMessage;
+        }
+        QMutexLocker locker(&m_mutex);
+        m_lastError = abortMessage;
+        return;
+    }
+
+    if (!control.exec("COMMIT")) {
+        const QString errorMessage = "Cannot commit writes: " + control.lastError().text();
+        control.exec("ROLLBACK");
+        for (Write& write : writes) {
+            write.ok = false;
+            write.errorMessage = errorMessage;
+        }
+        QMutexLocker locker(&m_mutex);
+        m_lastError = errorMessage;
+    }
+}
+
+void SqliteWriter::runStandalone(QSqlDatabase& database, Write& write) {
+    const QString& sql = write.statements.first().sql;
+    QSqlQuery query(database);
+    write.ok = query.exec(sql);
+    if (!write.ok) {
+        write.errorMessage = query.lastError().text() + " in: " + sql;
+        qWarning() << "SqliteWriter:" << write.errorMessage;
+    }
+}
+
+bool SqliteWriter::applyWrite(Write& write) {
+    for (const Statement& statement : write.statements) {
+        auto query = m_statements.prepare(statement.sql);
+        bool ok = false;
+        if (statement.rows.isEmpty()) {
+            for (int i = 0; i < statement.values.size(); ++i) {
+                query->bindValue(i, statement.values.at(i));
+            }
+            ok = query->exec();
+        } else {
+            // execBatch() binds by column
+            const int columnCount = statement.rows.first().size();
+            for (int column = 0; column < columnCount; ++column) {
+                QVariantList values;
+                values.reserve(statement.rows.size());
+                for (const QVariantList& row : statement.rows) {
+                    values.append(row.value(column));
+                }
+                query->bindValue(column, values);
+            }
+            ok = query->execBatch();
+        }
+        if (!ok) {
+            write.errorMessage = query->lastError().text() + " in: " + statement.sql;
+            return false;
+        }
+    }
+    return true;
+}
+
+void SqliteWriter::deliver(Write& write) {
+    if (!write.done) {
+        return;
+    }
+    if (!write.context) {
+        write.done(write.ok, write.errorMessage);
+        return;
+    }
+
+    // Queued, so storage signals are emitted on the storage's own thread. Posted under the
+    // lock its destroyed() handler takes, so the context cannot go away in between; events
+    // already posted to it are discarded with it.
+    Completion done = std::move(write.done);
+    const bool ok = write.ok;
+    const QString errorMessage = write.errorMessage;
+    QMutexLocker locker(&m_contextsMutex);
+    if (write.context->object) {
+        QMetaObject::invokeMethod(write.context->object, [done, ok, errorMessage]() {
+            done(ok, errorMessage);
+        }, Qt::QueuedConnection);
+    }
+}
+
+std::shared_ptr<SqliteWriter::ContextToken> SqliteWriter::contextToken(QObject* context) {
+    if (!context) {
+        return nullptr;
+    }
+
+    QMutexLocker locker(&m_contextsMutex);
+    std::shared_ptr<ContextToken>& token = m_contexts[context];
+    if (!token) {
+        token = std::make_shared<ContextToken>();
+        token->object = context;
+        // Direct: runs inside the object's destructor, before its address can be reused
+        token->destroyed = QObject::connect(context, &QObject::destroyed, [this, context]() {
+            QMutexLocker locker(&m_contextsMutex);
+            if (const std::shared_ptr<ContextToken> gone = m_contexts.take(context)) {
+                gone->object = nullptr;
+            }
+        });
+    }
+    return token;
+}
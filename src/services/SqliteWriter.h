@@ -0,0 +1,139 @@
+#pragma once
+
+#include "StatementCache.h"
+#include <QAtomicPointer>
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QSqlDatabase>
+#include <QString>
+#include <QThread>
+#include <QVariantList>
+#include <QWaitCondition>
+#include <functional>
+#include <memory>
+
+class Telemetry;
+
+/**
+ * @brief SqliteWriter - Single writer thread that group-commits queued SQL writes
+ *
+ * The storage classes queue their INSERT/UPDATE/DELETE statements here instead of
+ * executing them on the caller's (usually the GUI) thread. The writer owns its own
+ * connection; each time it wakes it takes everything queued so far and commits it
+ * in one transaction, so a burst of writes costs one fsync. Every write runs in a
+ * savepoint of that transaction, so a failing write is rolled back alone.
+ *
+ * With the database in WAL mode the GUI connection keeps reading while the writer
+ * commits. A reader that must see one of its own writes waits for that write's
+ * sequence number (see PendingWrites); waitForQueuedWrites() is for work that needs
+ * everything in, like migrations and backups. Completion callbacks run on the thread
+ * of their context object once the write has been committed (or has failed).
+ */
+class SqliteWriter {
+public:
+    struct Statement {
+        QString sql;
+        QVariantList values;        // Positional bind values
+        QList<QVariantList> rows;   // Instead of values: one list per row, run with execBatch()
+    };
+    using Completion = std::function<void(bool ok, const QString& errorMessage)>;
+
+    SqliteWriter();
+    ~SqliteWriter();
+
+    // Opens the writer connection on the writer thread; false if it cannot be opened
+    bool start(const QString& databasePath, const QString& connectionName);
+    // Commits everything still queued, then closes the connection
+    void stop();
+    bool isRunning() const { return m_thread != nullptr; }
+
+    // Statements of one write are applied together or not at all
+    quint64 enqueue(const QList<Statement>& statements, QObject* context = nullptr, Completion done = {});
+    quint64 enqueue(const Statement& statement, QObject* context = nullptr, Completion done = {});
+    // Runs on its own after the writes queued before it, outside any transaction
+    // (VACUUM cannot run inside one); later writes wait for it instead of timing out
+    quint64 enqueueStandalone(const QString& sql, QObject* context = nullptr, Completion done = {});
+
+    // Blocks until the write with @p sequence is done; false on a timeout, or when the
+    // write failed and was rolled back (its completion has the reason)
+    bool waitForWrite(quint64 sequence, int timeoutMs = DEFAULT_WAIT_MS);
+    // Blocks until everything queued is done, whether or not each write succeeded
+    bool waitForQueuedWrites(int timeoutMs = DEFAULT_WAIT_MS);
+    // Every write up to this one has been committed or has failed
+    quint64 committedSequence() const;
+
+    // Writes enqueued between beginGroup() and commitGroup() commit as one write;
+    // discardGroup() drops them (their completions report failure)
+    void beginGroup();
+    void commitGroup();
+    void discardGroup();
+
+    QString lastError() const;
+    // Times every commit on the writer thread; null stops it
+    void setTelemetry(Telemetry* telemetry);
+    StatementCache::Stats statementStats() const { return m_statements.stats(); }
+
+    // WAL journal plus the cache, mmap and temp-store settings every connection uses
+    static bool configureConnection(QSqlDatabase& database, QString* errorMessage = nullptr);
+
+    static constexpr int MAX_GROUP_WRITES = 256;           // Writes per commit
+    static constexpr int MAX_TRACKED_FAILURES = 1024;      // Older failed sequences are forgotten
+    static constexpr int DEFAULT_WAIT_MS = 10000;
+    static constexpr int BUSY_TIMEOUT_MS = 5000;
+    static constexpr int CACHE_SIZE_KIB = 8192;
+    static constexpr qint64 MMAP_SIZE_BYTES = 256LL * 1024 * 1024;
+
+private:
+    // Where completions for one context object go. The object is cleared, under
+    // m_contextsMutex, from its destroyed() signal, so the writer thread never reads
+    // a pointer to an object that is being destroyed on its own thread.
+    struct ContextToken {
+        QObject* object = nullptr;
+        QMetaObject::Connection destroyed;
+    };
+
+    struct Write {
+        QList<Statement> statements;
+        std::shared_ptr<ContextToken> context;
+        Completion done;
+        quint64 sequence = 0;
+        bool standalone = false;
+        bool ok = false;
+        QString errorMessage;
+    };
+
+    quint64 enqueueWrite(Write write);
+    void run();
+    void commitWrites(QSqlDatabase& database, QList<Write>& writes);
+    void runStandalone(QSqlDatabase& database, Write& write);
+    bool applyWrite(Write& write);
+    bool reachedLocked(quint64 sequence, QDeadlineTimer deadline);
+    std::shared_ptr<ContextToken> contextToken(QObject* context); // On the caller's thread
+    void deliver(Write& write);
+
+    QThread* m_thread;
+    QString m_databasePath;
+    QString m_connectionName;
+    StatementCache m_statements;    // Used only on the writer thread
+    QAtomicPointer<Telemetry> m_telemetry;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_queued;
+    QWaitCondition m_committed;
+    QList<Write> m_queue;
+    QList<Write> m_group;       // Held by beginGroup()
+    int m_groupDepth;
+    quint64 m_nextSequence;
+    quint64 m_committedSequence;
+    QList<quint64> m_failedSequences; // Ascending, at most MAX_TRACKED_FAILURES
+    bool m_stopping;
+    bool m_startFinished;
+    bool m_startOk;
+    QString m_lastError;
+
+    QMutex m_contextsMutex;
+    QHash<QObject*, std::shared_ptr<ContextToken>> m_contexts; // Live contexts only
+};
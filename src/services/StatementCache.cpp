@@ -0,0 +1,116 @@
+#include "StatementCache.h"
+#include <QMutexLocker>
+
+StatementCache::Statement::Statement(StatementCache* cache, const QString& sql, QSqlQuery* query, bool owned)
+    : m_cache(cache)
+    , m_sql(sql)
+    , m_query(query)
+    , m_owned(owned)
+{
+}
+
+StatementCache::Statement::Statement(Statement&& other) noexcept
+    : m_cache(other.m_cache)
+    , m_sql(std::move(other.m_sql))
+    , m_query(other.m_query)
+    , m_owned(other.m_owned)
+{
+    other.m_cache = nullptr;
+    other.m_query = nullptr;
+}
+
+StatementCache::Statement::~Statement() {
+    if (!m_query) {
+        return;
+    }
+    if (m_owned) {
+        delete m_query;
+        return;
+    }
+    // Reset, not finalize: the prepared plan stays for the next lease
+    m_query->finish();
+    m_cache->release(m_sql);
+}
+
+StatementCache::StatementCache(const QSqlDatabase& database)
+    : m_database(database)
+{
+}
+
+StatementCache::~StatementCache() {
+    clear();
+}
+
+void StatementCache::setDatabase(const QSqlDatabase& database) {
+    clear();
+    QMutexLocker locker(&m_mutex);
+    m_database = database;
+}
+
+StatementCache::Statement StatementCache::prepare(const QString& sql) {
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_entries.find(sql);
+    if (it != m_entries.end() && !it->leased) {
+        it->leased = true;
+        it->lastUsed = ++m_useCounter;
+        ++m_stats.hits;
+        return Statement(this, sql, it->query, false);
+    }
+
+    ++m_stats.misses;
+    auto* query = new QSqlQuery(m_database);
+    query->setForwardOnly(true);
+    if (!query->prepare(sql) || it != m_entries.end()) {
+        // Failed statements are not kept; the caller sees the error on exec()
+        return Statement(this, sql, query, true);
+    }
+
+    Entry entry;
+    entry.query = query;
+    entry.lastUsed = ++m_useCounter;
+    entry.leased = true;
+    m_entries.insert(sql, entry);
+    evictIdle();
+    return Statement(this, sql, query, false);
+}
+
+void StatementCache::clear() {
+    QMutexLocker locker(&m_mutex);
+    for (const Entry& entry : std::as_const(m_entries)) {
+        delete entry.query;
+    }
+    m_entries.clear();
+}
+
+StatementCache::Stats StatementCache::stats() const {
+    QMutexLocker locker(&m_mutex);
+    Stats stats = m_stats;
+    stats.size = static_cast<int>(m_entries.size());
+    return stats;
+}
+
+void StatementCache::release(const QString& sql) {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.find(sql);
+    if (it != m_entries.end()) {
+        it->leased = false;
+    }
+}
+
+void StatementCache::evictIdle() {
+    while (m_entries.size() > MAX_STATEMENTS) {
+        auto oldest = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (!it->leased && (oldest == m_entries.end() || it->lastUsed < oldest->lastUsed)) {
+                oldest = it;
+            }
+        }
+        if (oldest == m_entries.end()) {
+            return; // Everything is leased
+        }
+        delete oldest->query;
+        m_entries.erase(oldest);
+        ++m_stats.evictions;
+    }
+}
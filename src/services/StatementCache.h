@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+
+/**
+ * @brief StatementCache - Prepared statements of one connection, reused by SQL text
+ *
+ * prepare() hands out a Statement lease on a query that has already been prepared
+ * for that SQL, so repeated calls skip SQLite's parse and plan step. Bindings are
+ * positional and replaced by the next exec(). When the lease ends the statement is
+ * reset, which also ends the read transaction it held open in WAL mode.
+ *
+ * A statement that is still leased is never shared: asking for the same SQL again
+ * (a nested query) gets a one-off statement. The least recently used idle entries
+ * are dropped beyond MAX_STATEMENTS, so SQL with inlined values cannot grow the
+ * cache without bound. clear() must run, with no statement leased, before the
+ * connection is closed.
+ */
+class StatementCache {
+public:
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+        int size = 0;
+    };
+
+    class Statement {
+    public:
+        Statement(Statement&& other) noexcept;
+        Statement& operator=(Statement&&) = delete;
+        Statement(const Statement&) = delete;
+        ~Statement();
+
+        QSqlQuery& operator*() { return *m_query; }
+        QSqlQuery* operator->() { return m_query; }
+
+    private:
+        friend class StatementCache;
+        Statement(StatementCache* cache, const QString& sql, QSqlQuery* query, bool owned);
+
+        StatementCache* m_cache;
+        QString m_sql;
+        QSqlQuery* m_query;
+        bool m_owned;   // One-off statement, deleted with the lease
+    };
+
+    StatementCache() = default;
+    explicit StatementCache(const QSqlDatabase& database);
+    ~StatementCache();
+
+    // The connection statements are prepared on; clears the cache
+    void setDatabase(const QSqlDatabase& database);
+
+    // Forward-only statement prepared for @p sql; check lastError() if exec() fails
+    Statement prepare(const QString& sql);
+
+    void clear();
+    Stats stats() const;
+
+    static constexpr int MAX_STATEMENTS = 64;
+
+private:
+    struct Entry {
+        QSqlQuery* query = nullptr;
+        quint64 lastUsed = 0;
+        bool leased = false;
+    };
+
+    void release(const QString& sql);
+    void evictIdle();
+
+    QSqlDatabase m_database;
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+    quint64 m_useCounter = 0;
+    Stats m_stats;
+};
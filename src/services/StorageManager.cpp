@@ -2,6 +2,7 @@
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QSqlRecord>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
@@ -12,126 +13,393 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QCryptographicHash>
+#include <QRegularExpression>
+#include <QSet>
+#include <algorithm>
+
+namespace {
+
+// FTS5 query for what the user typed: every word must match, the last one as a
+// prefix so results update while typing. Words are quoted, so FTS5 operators in
+// the input are searched for rather than interpreted.
+QString ftsMatchExpression(const QString& searchTerm) {
+    static const QRegularExpression whitespace("\\s+");
+    QStringList terms;
+    for (const QString& word : searchTerm.split(whitespace, Qt::SkipEmptyParts)) {
+        const bool hasWordCharacter = std::any_of(word.begin(), word.end(), [](QChar c) { return c.isLetterOrNumber(); });
+        if (hasWordCharacter) {
+            terms.append('"' + QString(word).replace('"', "\"\"") + '"');
+        }
+    }
+    if (terms.isEmpty()) {
+        return QString();
+    }
+    terms.last() += '*';
+    return terms.join(' ');
+}
+
+// Keyset page over @p table ordered by (@p keyColumn, id). Only columns the
+// table really has are selected; the key and id are always included.
+void prepareKeysetQuery(QSqlQuery& query, const QSqlDatabase& database, const QString& table,
+                        const QString& keyColumn, const PageRequest& request) {
+    const QSqlRecord tableColumns = request.columns.isEmpty() && request.filters.isEmpty()
+        ? QSqlRecord() : database.record(table);
+    QStringList columns;
+    if (request.columns.isEmpty()) {
+        columns.append("*");
+    } else {
+        columns = {"id", keyColumn};
+        for (const QString& column : request.columns) {
+            if (tableColumns.contains(column) && !columns.contains(column)) {
+                columns.append(column);
+            }
+        }
+    }
+    
+    static const QStringList comparisons = {"=", "!=", ">", "<", ">=", "<="};
+    QStringList conditions;
+    QVariantList values;
+    for (const QueryFilter& filter : request.filters) {
+        if (tableColumns.contains(filter.field) && comparisons.contains(filter.operation)) {
+            conditions.append(QString("%1 %2 ?").arg(filter.field, filter.operation));
+            values.append(filter.value);
+        } else {
+            // An unknown column or operator matches nothing rather than everything
+            conditions.append("0");
+        }
+    }
+    
+    const bool descending = request.sortOrder == SortOrder::Descending;
+    if (request.after.isValid()) {
+        conditions.append(QString("(%1, id) %2 (?, ?)").arg(keyColumn, descending ? "<" : ">"));
+        values.append(request.after.timestamp);
+        values.append(request.after.id);
+    }
+    
+    QString queryStr = QString("SELECT %1 FROM %2").arg(columns.join(", "), table);
+    if (!conditions.isEmpty()) {
+        queryStr += " WHERE " + conditions.join(" AND ");
+    }
+    queryStr += QString(" ORDER BY %1 %2, id %2").arg(keyColumn, descending ? "DESC" : "ASC");
+    if (request.pageSize > 0) {
+        queryStr += QString(" LIMIT %1").arg(request.pageSize);
+    }
+    
+    // Forward-only, so rows are stepped rather than buffered
+    query.setForwardOnly(true);
+    query.prepare(queryStr);
+    for (const QVariant& value : values) {
+        query.addBindValue(value);
+    }
+}
+
+template <typename Model>
+class SqlCursor : public StorageCursor<Model> {
+public:
+    using Decoder = std::function<Model(const QSqlQuery&)>;
+    
+    SqlCursor(QSqlQuery query, const QString& keyColumn, Decoder decode)
+        : m_query(std::move(query))
+        , m_decode(std::move(decode))
+        , m_keyIndex(m_query.record().indexOf(keyColumn))
+        , m_idIndex(m_query.record().indexOf("id"))
+    {
+    }
+    
+    bool next() override { return m_query.isActive() && m_query.next(); }
+    Model current() const override { return m_decode(m_query); }
+    KeysetPosition position() const override {
+        return {m_query.value(m_keyIndex), m_query.value(m_idIndex).toString()};
+    }
+    
+private:
+    QSqlQuery m_query;
+    Decoder m_decode;
+    int m_keyIndex;
+    int m_idIndex;
+};
+
+const char* const RECORDING_INSERT_SQL =
+    "INSERT OR REPLACE INTO recordings "
+    "(id, session_id, timestamp, duration, file_path, file_size, "
+    "sample_rate, language, device_name, status, codec, waveform_peaks, segments, created_at, updated_at) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+
+const char* const RECORDING_UPDATE_SQL =
+    "UPDATE recordings SET session_id = ?, timestamp = ?, duration = ?, "
+    "file_path = ?, file_size = ?, sample_rate = ?, language = ?, "
+    "device_name = ?, status = ?, codec = ?, waveform_peaks = ?, segments = ?, "
+    "updated_at = ? WHERE id = ?";
+
+const char* const TRANSCRIPTION_INSERT_SQL =
+    "INSERT OR REPLACE INTO transcriptions "
+    "(id, recording_id, text, confidence, provider, language, "
+    "processing_time, word_timestamps, created_at, status) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+
+const char* const TRANSCRIPTION_UPDATE_SQL =
+    "UPDATE transcriptions SET recording_id = ?, text = ?, confidence = ?, "
+    "provider = ?, language = ?, processing_time = ?, word_timestamps = ?, "
+    "status = ? WHERE id = ?";
+
+const char* const ENHANCED_TEXT_INSERT_SQL =
+    "INSERT OR REPLACE INTO enhanced_texts "
+    "(id, transcription_id, original_text, enhanced_text, enhancement_mode, provider, "
+    "prompt_template, processing_time, settings, created_at, user_rating) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+
+const char* const ENHANCED_TEXT_UPDATE_SQL =
+    "UPDATE enhanced_texts SET transcription_id = ?, original_text = ?, enhanced_text = ?, "
+    "enhancement_mode = ?, provider = ?, prompt_template = ?, processing_time = ?, "
+    "settings = ?, user_rating = ? WHERE id = ?";
+
+const char* const USER_SESSION_INSERT_SQL =
+    "INSERT OR REPLACE INTO user_sessions "
+    "(id, name, started_at, ended_at, status, notes, recording_count, total_duration) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?)";
+
+const char* const USER_SESSION_UPDATE_SQL =
+    "UPDATE user_sessions SET name = ?, started_at = ?, ended_at = ?, status = ?, "
+    "notes = ?, recording_count = ?, total_duration = ? WHERE id = ?";
+
+// Counters in storage_stats, kept current by triggers (see STATS_METRICS)
+const char* const STATISTIC_SQL = "SELECT value FROM storage_stats WHERE metric = ?";
+
+// Sum metric divided by the matching row-count metric; no row when nothing was counted
+const char* const STATISTIC_AVERAGE_SQL =
+    "SELECT CAST(total.value AS REAL) / counted.value FROM storage_stats total "
+    "JOIN storage_stats counted ON counted.metric = ? WHERE total.metric = ? AND counted.value > 0";
+
+// Schema history after version 1. DDL runs at startup and must be cheap (ADD COLUMN,
+// CREATE INDEX on a new table); rewriting existing rows goes in the backfill,
+// which MigrationRunner does in the background.
+struct SchemaMigration {
+    int version;
+    const char* description;
+    QStringList schema;
+    std::optional<MigrationRunner::Backfill> backfill;
+};
+
+const QList<SchemaMigration>& schemaMigrations() {
+    static const QList<SchemaMigration> migrations = {
+        {2, "Pack word timestamps stored as JSON into the binary format", {},
+         MigrationRunner::Backfill{
+             2, {}, "transcriptions", "word_timestamps",
+             {"UPDATE transcriptions SET word_timestamps = ? WHERE rowid = ?"},
+             [](const QSqlQuery& row) -> std::optional<QVariantList> {
+                 const QByteArray data = row.value(1).toByteArray();
+                 if (data.isEmpty() || WordTimingTable::isBlob(data)) {
+                     return std::nullopt;
+                 }
+                 const WordTimingTable timings = WordTimingTable::fromJson(QJsonDocument::fromJson(data).array());
+                 const QVariant blob = timings.isEmpty() ? QVariant(QMetaType::fromType<QByteArray>())
+                                                         : QVariant(timings.toBlob());
+                 return QVariantList{blob, row.value(0)};
+             }}},
+    };
+    return migrations;
+}
+
+} // namespace
 
 // RecordingStorage Implementation
-RecordingStorage::RecordingStorage(QSqlDatabase* database, QObject* parent)
-    : IRecordingStorage(parent), m_database(database)
+RecordingStorage::RecordingStorage(QSqlDatabase* database, SqliteWriter* writer, ConnectionPool* readers,
+                                   QObject* parent)
+    : IRecordingStorage(parent), m_database(database), m_writer(writer), m_readers(readers),
+      m_fullTextSearch(false), m_pending(writer)
 {
+    // Committed writes drop cached rows too, whichever storage made them
+    connect(this, &IRecordingStorage::recordingCreated, this, [this](const QString& id) { m_cache.remove(id); });
+    connect(this, &IRecordingStorage::recordingUpdated, this, [this](const QString& id) { m_cache.remove(id); });
+    connect(this, &IRecordingStorage::recordingDeleted, this, [this](const QString& id) { m_cache.remove(id); });
+    connect(this, &IRecordingStorage::recordingsCreated, this, &RecordingStorage::invalidateCached);
+    connect(this, &IRecordingStorage::recordingsUpdated, this, &RecordingStorage::invalidateCached);
+    
+    // The files recordings refer to, read once; writes keep the set current after that
+    m_orphans.setKnownFilesLoader([this]() {
+        QHash<QString, QStringList> filesByRecording;
+        auto query = m_readers->statements().prepare("SELECT id, file_path, segments FROM recordings");
+        if (executeQuery(*query)) {
+            while (query->next()) {
+                const Recording recording = recordingFromQuery(*query);
+                filesByRecording.insert(recording.getId(), recordingFiles(recording));
+            }
+        }
+        return filesByRecording;
+    });
 }
 
 QString RecordingStorage::saveRecording(const Recording& recording) {
-    QMutexLocker locker(&m_mutex);
-    
     if (!recording.isValid()) {
         emit recordingCreated(recording.getId());
         return QString();
     }
+    return queueSave(recording, {});
+}
+
+QString RecordingStorage::queueSave(const Recording& recording, SqliteWriter::Completion done) {
+    if (!recording.isValid()) {
+        if (done) {
+            done(false, "Invalid recording");
+        }
+        return QString();
+    }
     
-    QSqlQuery query(*m_database);
-    query.prepare("INSERT OR REPLACE INTO recordings "
-                  "(id, session_id, timestamp, duration, file_path, file_size, "
-                  "sample_rate, language, device_name, status, created_at, updated_at) "
-                  "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-    
-    query.addBindValue(recording.getId());
-    query.addBindValue(recording.getSessionId());
-    query.addBindValue(recording.getTimestamp());
-    query.addBindValue(recording.getDuration());
-    query.addBindValue(recording.getFilePath());
-    query.addBindValue(recording.getFileSize());
-    query.addBindValue(recording.getSampleRate());
-    query.addBindValue(recording.getLanguage());
-    query.addBindValue(recording.getDeviceName());
-    query.addBindValue(recordingStatusToString(recording.getStatus()));
-    query.addBindValue(QDateTime::currentDateTime());
-    query.addBindValue(QDateTime::currentDateTime());
-    
-    if (executeQuery(query)) {
-        emit recordingCreated(recording.getId());
-        return recording.getId();
+    const QString id = recording.getId();
+    m_cache.remove(id);
+    m_orphans.setKnownFiles(id, recordingFiles(recording));
+    m_pending.note(id, queueWrite({RECORDING_INSERT_SQL, insertValues(recording, QDateTime::currentDateTime())},
+                                  [this, id]() { emit recordingCreated(id); }, std::move(done)));
+    return id;
+}
+
+QStringList RecordingStorage::saveRecordings(const QList<Recording>& recordings) {
+    // One batched statement in one write: a single commit for the whole list
+    SqliteWriter::Statement statement;
+    statement.sql = RECORDING_INSERT_SQL;
+    QStringList ids;
+    const QDateTime now = QDateTime::currentDateTime();
+    for (const Recording& recording : recordings) {
+        if (recording.isValid()) {
+            statement.rows.append(insertValues(recording, now));
+            ids.append(recording.getId());
+            m_orphans.setKnownFiles(recording.getId(), recordingFiles(recording));
+        }
     }
     
-    return QString();
+    if (!ids.isEmpty()) {
+        invalidateCached(ids);
+        m_pending.note(ids, queueWrite(statement, [this, ids]() { emit recordingsCreated(ids); }));
+    }
+    return ids;
+}
+
+QVariantList RecordingStorage::insertValues(const Recording& recording, const QDateTime& now) {
+    return {
+        recording.getId(),
+        recording.getSessionId(),
+        recording.getTimestamp(),
+        recording.getDuration(),
+        recording.getFilePath(),
+        recording.getFileSize(),
+        recording.getSampleRate(),
+        recording.getLanguage(),
+        recording.getDeviceName(),
+        recordingStatusToString(recording.getStatus()),
+        audioCodecToString(recording.getCodec()),
+        waveformPeaksToBlob(recording.getWaveformPeaks()),
+        segmentsToColumn(recording),
+        now,
+        now,
+    };
 }
 
 Recording RecordingStorage::getRecording(const QString& id) const {
-    QMutexLocker locker(&m_mutex);
+    quint64 generation = 0;
+    if (std::optional<Recording> cached = m_cache.find(id, &generation)) {
+        return *cached;
+    }
     
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT * FROM recordings WHERE id = ?");
-    query.addBindValue(id);
+    // Sees this storage's own last write of the row once it has committed
+    m_pending.waitFor(id);
+    auto query = m_readers->statements().prepare("SELECT * FROM recordings WHERE id = ?");
+    query->addBindValue(id);
     
-    if (executeQuery(query) && query.next()) {
-        return recordingFromQuery(query);
+    if (executeQuery(*query) && query->next()) {
+        Recording recording = recordingFromQuery(*query);
+        m_cache.insert(id, recording, generation);
+        return recording;
     }
     
     return Recording();
 }
 
 bool RecordingStorage::updateRecording(const Recording& recording) {
-    QMutexLocker locker(&m_mutex);
-    
-    if (!recordingExists(recording.getId())) {
+    if (!rowExists(recording.getId())) {
         return false;
     }
-    
-    QSqlQuery query(*m_database);
-    query.prepare("UPDATE recordings SET session_id = ?, timestamp = ?, duration = ?, "
-                  "file_path = ?, file_size = ?, sample_rate = ?, language = ?, "
-                  "device_name = ?, status = ?, updated_at = ? WHERE id = ?");
-    
-    query.addBindValue(recording.getSessionId());
-    query.addBindValue(recording.getTimestamp());
-    query.addBindValue(recording.getDuration());
-    query.addBindValue(recording.getFilePath());
-    query.addBindValue(recording.getFileSize());
-    query.addBindValue(recording.getSampleRate());
-    query.addBindValue(recording.getLanguage());
-    query.addBindValue(recording.getDeviceName());
-    query.addBindValue(recordingStatusToString(recording.getStatus()));
-    query.addBindValue(QDateTime::currentDateTime());
-    query.addBindValue(recording.getId());
-    
-    if (executeQuery(query)) {
-        emit recordingUpdated(recording.getId());
-        return true;
+    queueUpdate(recording, {});
+    return true;
+}
+
+void RecordingStorage::queueUpdate(const Recording& recording, SqliteWriter::Completion done) {
+    const QString id = recording.getId();
+    m_cache.remove(id);
+    m_orphans.setKnownFiles(id, recordingFiles(recording));
+    m_pending.note(id, queueWrite({RECORDING_UPDATE_SQL, updateValues(recording, QDateTime::currentDateTime())},
+                                  [this, id]() { emit recordingUpdated(id); }, std::move(done)));
+}
+
+bool RecordingStorage::updateRecordings(const QList<Recording>& recordings) {
+    // Rows that no longer exist are left alone by the UPDATE itself
+    SqliteWriter::Statement statement;
+    statement.sql = RECORDING_UPDATE_SQL;
+    QStringList ids;
+    const QDateTime now = QDateTime::currentDateTime();
+    for (const Recording& recording : recordings) {
+        if (recording.isValid()) {
+            statement.rows.append(updateValues(recording, now));
+            ids.append(recording.getId());
+            m_orphans.setKnownFiles(recording.getId(), recordingFiles(recording));
+        }
     }
     
-    return false;
+    if (ids.isEmpty()) {
+        return false;
+    }
+    invalidateCached(ids);
+    m_pending.note(ids, queueWrite(statement, [this, ids]() { emit recordingsUpdated(ids); }));
+    return true;
+}
+
+QVariantList RecordingStorage::updateValues(const Recording& recording, const QDateTime& now) {
+    return {
+        recording.getSessionId(),
+        recording.getTimestamp(),
+        recording.getDuration(),
+        recording.getFilePath(),
+        recording.getFileSize(),
+        recording.getSampleRate(),
+        recording.getLanguage(),
+        recording.getDeviceName(),
+        recordingStatusToString(recording.getStatus()),
+        audioCodecToString(recording.getCodec()),
+        waveformPeaksToBlob(recording.getWaveformPeaks()),
+        segmentsToColumn(recording),
+        now,
+        recording.getId(),
+    };
 }
 
 bool RecordingStorage::deleteRecording(const QString& id) {
-    QMutexLocker locker(&m_mutex);
-    
-    QSqlQuery query(*m_database);
-    query.prepare("DELETE FROM recordings WHERE id = ?");
-    query.addBindValue(id);
-    
-    if (executeQuery(query)) {
-        emit recordingDeleted(id);
-        return true;
-    }
-    
-    return false;
+    queueDelete(id, {});
+    return true;
+}
+
+void RecordingStorage::queueDelete(const QString& id, SqliteWriter::Completion done) {
+    m_cache.remove(id);
+    m_orphans.forgetRecording(id);
+    m_pending.note(id, queueWrite({"DELETE FROM recordings WHERE id = ?", {id}},
+                                  [this, id]() { emit recordingDeleted(id); }, std::move(done)));
 }
 
 bool RecordingStorage::recordingExists(const QString& id) const {
-    QMutexLocker locker(&m_mutex);
-    
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT COUNT(*) FROM recordings WHERE id = ?");
-    query.addBindValue(id);
+    return rowExists(id);
+}
+
+bool RecordingStorage::rowExists(const QString& id) const {
+    m_pending.waitFor(id);
+    auto query = m_readers->statements().prepare("SELECT COUNT(*) FROM recordings WHERE id = ?");
+    query->addBindValue(id);
     
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toInt() > 0;
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt() > 0;
     }
     
     return false;
 }
 
 QList<Recording> RecordingStorage::getAllRecordings(const QueryOptions& options) const {
-    QMutexLocker locker(&m_mutex);
-    
     QString queryStr = "SELECT * FROM recordings";
     
     QString whereClause = buildWhereClause(options);
@@ -148,13 +416,12 @@ QList<Recording> RecordingStorage::getAllRecordings(const QueryOptions& options)
         }
     }
     
-    QSqlQuery query(*m_database);
-    query.prepare(queryStr);
+    auto query = m_readers->statements().prepare(queryStr);
     
     QList<Recording> recordings;
-    if (executeQuery(query)) {
-        while (query.next()) {
-            recordings.append(recordingFromQuery(query));
+    if (executeQuery(*query)) {
+        while (query->next()) {
+            recordings.append(recordingFromQuery(*query));
         }
     }
     
@@ -162,16 +429,13 @@ QList<Recording> RecordingStorage::getAllRecordings(const QueryOptions& options)
 }
 
 QList<Recording> RecordingStorage::getRecordingsBySession(const QString& sessionId, const QueryOptions& options) const {
-    QMutexLocker locker(&m_mutex);
-    
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT * FROM recordings WHERE session_id = ? ORDER BY timestamp DESC");
-    query.addBindValue(sessionId);
+    auto query = m_readers->statements().prepare("SELECT * FROM recordings WHERE session_id = ? ORDER BY timestamp DESC");
+    query->addBindValue(sessionId);
     
     QList<Recording> recordings;
-    if (executeQuery(query)) {
-        while (query.next()) {
-            recordings.append(recordingFromQuery(query));
+    if (executeQuery(*query)) {
+        while (query->next()) {
+            recordings.append(recordingFromQuery(*query));
         }
     }
     
@@ -179,17 +443,14 @@ QList<Recording> RecordingStorage::getRecordingsBySession(const QString& session
 }
 
 QList<Recording> RecordingStorage::getRecordingsByDateRange(const QDateTime& start, const QDateTime& end) const {
-    QMutexLocker locker(&m_mutex);
-    
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT * FROM recordings WHERE timestamp BETWEEN ? AND ? ORDER BY timestamp DESC");
-    query.addBindValue(start);
-    query.addBindValue(end);
+    auto query = m_readers->statements().prepare("SELECT * FROM recordings WHERE timestamp BETWEEN ? AND ? ORDER BY timestamp DESC");
+    query->addBindValue(start);
+    query->addBindValue(end);
     
     QList<Recording> recordings;
-    if (executeQuery(query)) {
-        while (query.next()) {
-            recordings.append(recordingFromQuery(query));
+    if (executeQuery(*query)) {
+        while (query->next()) {
+            recordings.append(recordingFromQuery(*query));
         }
     }
     
@@ -197,133 +458,192 @@ QList<Recording> RecordingStorage::getRecordingsByDateRange(const QDateTime& sta
 }
 
 QList<Recording> RecordingStorage::searchRecordings(const QString& searchTerm, const QueryOptions& options) const {
-    QMutexLocker locker(&m_mutex);
+    QString queryStr;
+    QVariantList values;
+    if (m_fullTextSearch) {
+        const QString match = ftsMatchExpression(searchTerm);
+        if (match.isEmpty()) {
+            return QList<Recording>();
+        }
+        // Limit and offset are bound, so every search shares one cached statement
+        queryStr = "SELECT r.* FROM search_index "
+                   "JOIN search_documents d ON d.doc_id = search_index.rowid "
+                   "JOIN recordings r ON r.id = d.source_id "
+                   "WHERE search_index MATCH ? AND d.kind = 'recording' "
+                   "ORDER BY search_index.rank LIMIT ? OFFSET ?";
+        values = {match, options.limit > 0 ? options.limit : -1, qMax(0, options.offset)};
+    } else {
+        queryStr = "SELECT * FROM recordings WHERE file_path LIKE ? OR device_name LIKE ? ORDER BY timestamp DESC";
+        QString searchPattern = "%" + searchTerm + "%";
+        values = {searchPattern, searchPattern};
+    }
     
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT * FROM recordings WHERE file_path LIKE ? OR device_name LIKE ? ORDER BY timestamp DESC");
-    QString searchPattern = "%" + searchTerm + "%";
-    query.addBindValue(searchPattern);
-    query.addBindValue(searchPattern);
+    auto query = m_readers->statements().prepare(queryStr);
+    for (const QVariant& value : values) {
+        query->addBindValue(value);
+    }
     
     QList<Recording> recordings;
-    if (executeQuery(query)) {
-        while (query.next()) {
-            recordings.append(recordingFromQuery(query));
+    if (executeQuery(*query)) {
+        while (query->next()) {
+            recordings.append(recordingFromQuery(*query));
         }
     }
     
     return recordings;
 }
 
+std::unique_ptr<StorageCursor<Recording>> RecordingStorage::openRecordingCursor(const PageRequest& request) const {
+    const QSqlDatabase database = m_readers->database();
+    QSqlQuery query(database);
+    prepareKeysetQuery(query, database, "recordings", "timestamp", request);
+    executeQuery(query);
+    return std::make_unique<SqlCursor<Recording>>(
+        std::move(query), "timestamp", [this](const QSqlQuery& row) { return recordingFromQuery(row); });
+}
+
 int RecordingStorage::getRecordingCount() const {
-    QMutexLocker locker(&m_mutex);
-    
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT COUNT(*) FROM recordings");
+    auto query = m_readers->statements().prepare(STATISTIC_SQL);
+    query->addBindValue("recordings.count");
     
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toInt();
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt();
     }
     
     return 0;
 }
 
 qint64 RecordingStorage::getTotalRecordingDuration() const {
-    QMutexLocker locker(&m_mutex);
-    
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT SUM(duration) FROM recordings");
+    auto query = m_readers->statements().prepare(STATISTIC_SQL);
+    query->addBindValue("recordings.duration");
     
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toLongLong();
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toLongLong();
     }
     
     return 0;
 }
 
 qint64 RecordingStorage::getTotalStorageUsed() const {
-    QMutexLocker locker(&m_mutex);
+    auto query = m_readers->statements().prepare(STATISTIC_SQL);
+    query->addBindValue("recordings.file_size");
     
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT SUM(file_size) FROM recordings");
-    
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toLongLong();
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toLongLong();
     }
     
     return 0;
 }
 
 QDateTime RecordingStorage::getOldestRecordingDate() const {
-    QMutexLocker locker(&m_mutex);
-    
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT MIN(timestamp) FROM recordings");
+    auto query = m_readers->statements().prepare("SELECT MIN(timestamp) FROM recordings");
     
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toDateTime();
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toDateTime();
     }
     
     return QDateTime();
 }
 
 QDateTime RecordingStorage::getNewestRecordingDate() const {
-    QMutexLocker locker(&m_mutex);
+    auto query = m_readers->statements().prepare("SELECT MAX(timestamp) FROM recordings");
     
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT MAX(timestamp) FROM recordings");
-    
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toDateTime();
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toDateTime();
     }
     
     return QDateTime();
 }
 
 bool RecordingStorage::cleanup() {
-    QMutexLocker locker(&m_mutex);
-    
     // Remove recordings older than 1 year that are not referenced
-    QSqlQuery query(*m_database);
-    query.prepare("DELETE FROM recordings WHERE timestamp < ? AND id NOT IN "
-                  "(SELECT DISTINCT recording_id FROM transcriptions WHERE recording_id IS NOT NULL)");
-    query.addBindValue(QDateTime::currentDateTime().addYears(-1));
-    
-    return executeQuery(query);
+    queueWrite({"DELETE FROM recordings WHERE timestamp < ? AND id NOT IN "
+                "(SELECT DISTINCT recording_id FROM transcriptions WHERE recording_id IS NOT NULL)",
+                {QDateTime::currentDateTime().addYears(-1)}},
+               [this]() {
+                   m_cache.clear();
+                   m_orphans.invalidateKnownFiles(); // Which rows went is not known here
+               });
+    m_cache.clear();
+    return true;
 }
 
 bool RecordingStorage::vacuum() {
-    QMutexLocker locker(&m_mutex);
-    
-    QSqlQuery query(*m_database);
-    return query.exec("VACUUM");
+    // Runs on the writer thread behind the writes already queued, outside any transaction
+    return m_writer->enqueueStandalone("VACUUM", this, [](bool ok, const QString& errorMessage) {
+        if (!ok) {
+            qWarning() << "VACUUM failed:" << errorMessage;
+        }
+    }) != 0;
 }
 
 QStringList RecordingStorage::getOrphanedAudioFiles() const {
-    // This would scan the file system for audio files not in the database
-    // Simplified implementation
-    return QStringList();
+    return m_orphans.scan().orphanedFiles;
+}
+
+QStringList RecordingStorage::recordingFiles(const Recording& recording) {
+    QStringList files = {recording.getFilePath()};
+    for (const RecordingSegment& segment : recording.getSegments()) {
+        files.append(segment.filePath);
+    }
+    return files;
 }
 
 Recording RecordingStorage::recordingFromQuery(const QSqlQuery& query) const {
+    // Columns a projection left out decode as defaults
+    const QSqlRecord record = query.record();
+    auto value = [&](const char* column) { return record.contains(column) ? query.value(column) : QVariant(); };
+    
     Recording recording;
     QJsonObject json;
     
-    json["id"] = query.value("id").toString();
-    json["sessionId"] = query.value("session_id").toString();
-    json["timestamp"] = query.value("timestamp").toDateTime().toString(Qt::ISODate);
-    json["duration"] = query.value("duration").toLongLong();
-    json["filePath"] = query.value("file_path").toString();
-    json["fileSize"] = query.value("file_size").toLongLong();
-    json["sampleRate"] = query.value("sample_rate").toInt();
-    json["language"] = query.value("language").toString();
-    json["deviceName"] = query.value("device_name").toString();
-    json["status"] = query.value("status").toString();
+    json["id"] = value("id").toString();
+    json["sessionId"] = value("session_id").toString();
+    json["timestamp"] = value("timestamp").toDateTime().toString(Qt::ISODate);
+    json["duration"] = value("duration").toLongLong();
+    json["filePath"] = value("file_path").toString();
+    json["fileSize"] = value("file_size").toLongLong();
+    json["sampleRate"] = value("sample_rate").toInt();
+    json["language"] = value("language").toString();
+    json["deviceName"] = value("device_name").toString();
+    json["status"] = value("status").toString();
+    json["codec"] = value("codec").toString();
+    const QByteArray segments = value("segments").toByteArray();
+    if (!segments.isEmpty()) {
+        json["segments"] = QJsonDocument::fromJson(segments).array();
+    }
     
     recording.fromJson(json);
+    recording.setWaveformPeaks(waveformPeaksFromColumn(value("waveform_peaks")));
     return recording;
 }
 
+QVariant RecordingStorage::segmentsToColumn(const Recording& recording) {
+    if (recording.getSegments().isEmpty()) {
+        return QVariant(QMetaType::fromType<QString>());
+    }
+    const QJsonArray segments = recording.toJson().value("segments").toArray();
+    return QString::fromUtf8(QJsonDocument(segments).toJson(QJsonDocument::Compact));
+}
+
+QVariant RecordingStorage::waveformPeaksToBlob(const WaveformPeaks& peaks) {
+    return peaks.isEmpty() ? QVariant(QMetaType::fromType<QByteArray>()) : QVariant(peaks.toBlob());
+}
+
+WaveformPeaks RecordingStorage::waveformPeaksFromColumn(const QVariant& value) {
+    const QByteArray data = value.toByteArray();
+    if (data.isEmpty()) {
+        return WaveformPeaks(); // Recorded before peaks were kept
+    }
+    
+    bool ok = false;
+    WaveformPeaks peaks = WaveformPeaks::fromBlob(data, &ok);
+    if (!ok) {
+        qWarning() << "Ignoring corrupt waveform peak BLOB";
+    }
+    return peaks;
+}
+
 bool RecordingStorage::executeQuery(QSqlQuery& query) const {
     if (!query.exec()) {
         qWarning() << "SQL query failed:" << query.lastError().text();
@@ -333,6 +653,26 @@ bool RecordingStorage::executeQuery(QSqlQuery& query) const {
     return true;
 }
 
+void RecordingStorage::invalidateCached(const QStringList& ids) {
+    for (const QString& id : ids) {
+        m_cache.remove(id);
+    }
+}
+
+quint64 RecordingStorage::queueWrite(const SqliteWriter::Statement& statement, std::function<void()> committed,
+                                     SqliteWriter::Completion done) {
+    return m_writer->enqueue(statement, this, [committed, done](bool ok, const QString& errorMessage) {
+        if (ok && committed) {
+            committed();
+        }
+        if (done) {
+            done(ok, errorMessage); // Reports a failure itself
+        } else if (!ok) {
+            qWarning() << "Recording write failed:" << errorMessage;
+        }
+    });
+}
+
 QString RecordingStorage::buildWhereClause(const QueryOptions& options) const {
     // Simplified implementation
     Q_UNUSED(options)
@@ -358,133 +698,183 @@ QString RecordingStorage::buildOrderClause(const QueryOptions& options) const {
 }
 
 // TranscriptionStorage Implementation
-TranscriptionStorage::TranscriptionStorage(QSqlDatabase* database, QObject* parent)
-    : ITranscriptionStorage(parent), m_database(database)
+TranscriptionStorage::TranscriptionStorage(QSqlDatabase* database, SqliteWriter* writer, ConnectionPool* readers,
+                                           QObject* parent)
+    : ITranscriptionStorage(parent), m_database(database), m_writer(writer), m_readers(readers),
+      m_fullTextSearch(false), m_pending(writer)
 {
+    connect(this, &ITranscriptionStorage::transcriptionCreated, this, [this](const QString& id) { invalidateCached({id}); });
+    connect(this, &ITranscriptionStorage::transcriptionUpdated, this, [this](const QString& id) { invalidateCached({id}); });
+    connect(this, &ITranscriptionStorage::transcriptionDeleted, this, [this](const QString& id) { invalidateCached({id}); });
+    connect(this, &ITranscriptionStorage::transcriptionsCreated, this, &TranscriptionStorage::invalidateCached);
+    connect(this, &ITranscriptionStorage::transcriptionsUpdated, this, &TranscriptionStorage::invalidateCached);
 }
 
 QString TranscriptionStorage::saveTranscription(const Transcription& transcription) {
-    QMutexLocker locker(&m_mutex);
-    
+    return queueSave(transcription, {});
+}
+
+QString TranscriptionStorage::queueSave(const Transcription& transcription, SqliteWriter::Completion done) {
     if (!transcription.isValid()) {
+        if (done) {
+            done(false, "Invalid transcription");
+        }
         return QString();
     }
     
-    QSqlQuery query(*m_database);
-    query.prepare("INSERT OR REPLACE INTO transcriptions "
-                  "(id, recording_id, text, confidence, provider, language, "
-                  "processing_time, word_timestamps, created_at, status) "
-                  "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-    
-    query.addBindValue(transcription.getId());
-    query.addBindValue(transcription.getRecordingId());
-    query.addBindValue(transcription.getText());
-    query.addBindValue(transcription.getConfidence());
-    query.addBindValue(transcription.getProvider());
-    query.addBindValue(transcription.getLanguage());
-    query.addBindValue(transcription.getProcessingTime());
-    
-    // Convert word timestamps to JSON string
-    QJsonDocument doc(transcription.getWordTimestamps());
-    query.addBindValue(doc.toJson(QJsonDocument::Compact));
-    
-    query.addBindValue(transcription.getCreatedAt());
-    query.addBindValue(transcriptionStatusToString(transcription.getStatus()));
-    
-    if (executeQuery(query)) {
-        emit transcriptionCreated(transcription.getId());
-        return transcription.getId();
+    const QString id = transcription.getId();
+    invalidateCached({id});
+    m_pending.note(writeKeys(transcription), queueWrite({TRANSCRIPTION_INSERT_SQL, insertValues(transcription)},
+                                                        [this, id]() { emit transcriptionCreated(id); },
+                                                        std::move(done)));
+    return id;
+}
+
+QStringList TranscriptionStorage::saveTranscriptions(const QList<Transcription>& transcriptions) {
+    SqliteWriter::Statement statement;
+    statement.sql = TRANSCRIPTION_INSERT_SQL;
+    QStringList ids;
+    QStringList keys;
+    for (const Transcription& transcription : transcriptions) {
+        if (transcription.isValid()) {
+            statement.rows.append(insertValues(transcription));
+            ids.append(transcription.getId());
+            keys += writeKeys(transcription);
+        }
     }
     
-    return QString();
+    if (!ids.isEmpty()) {
+        invalidateCached(ids);
+        m_pending.note(keys, queueWrite(statement, [this, ids]() { emit transcriptionsCreated(ids); }));
+    }
+    return ids;
+}
+
+QVariantList TranscriptionStorage::insertValues(const Transcription& transcription) {
+    return {
+        transcription.getId(),
+        transcription.getRecordingId(),
+        transcription.getText(),
+        transcription.getConfidence(),
+        transcription.getProvider(),
+        transcription.getLanguage(),
+        transcription.getProcessingTime(),
+        // Word timestamps are stored as a packed BLOB (see WordTimingTable)
+        wordTimingsToBlob(transcription.getWordTimings()),
+        transcription.getCreatedAt(),
+        transcriptionStatusToString(transcription.getStatus()),
+    };
 }
 
 Transcription TranscriptionStorage::getTranscription(const QString& id) const {
-    QMutexLocker locker(&m_mutex);
+    quint64 generation = 0;
+    if (std::optional<Transcription> cached = m_cache.find(id, &generation)) {
+        return *cached;
+    }
     
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT * FROM transcriptions WHERE id = ?");
-    query.addBindValue(id);
+    m_pending.waitFor(id);
+    auto query = m_readers->statements().prepare("SELECT * FROM transcriptions WHERE id = ?");
+    query->addBindValue(id);
     
-    if (executeQuery(query) && query.next()) {
-        return transcriptionFromQuery(query);
+    if (executeQuery(*query) && query->next()) {
+        Transcription transcription = transcriptionFromQuery(*query);
+        m_cache.insert(id, transcription, generation);
+        return transcription;
     }
     
     return Transcription();
 }
 
 bool TranscriptionStorage::updateTranscription(const Transcription& transcription) {
-    QMutexLocker locker(&m_mutex);
-    
-    if (!transcriptionExists(transcription.getId())) {
+    if (!rowExists(transcription.getId())) {
         return false;
     }
-    
-    QSqlQuery query(*m_database);
-    query.prepare("UPDATE transcriptions SET recording_id = ?, text = ?, confidence = ?, "
-                  "provider = ?, language = ?, processing_time = ?, word_timestamps = ?, "
-                  "status = ? WHERE id = ?");
-    
-    query.addBindValue(transcription.getRecordingId());
-    query.addBindValue(transcription.getText());
-    query.addBindValue(transcription.getConfidence());
-    query.addBindValue(transcription.getProvider());
-    query.addBindValue(transcription.getLanguage());
-    query.addBindValue(transcription.getProcessingTime());
-    
-    QJsonDocument doc(transcription.getWordTimestamps());
-    query.addBindValue(doc.toJson(QJsonDocument::Compact));
-    
-    query.addBindValue(transcriptionStatusToString(transcription.getStatus()));
-    query.addBindValue(transcription.getId());
-    
-    if (executeQuery(query)) {
-        emit transcriptionUpdated(transcription.getId());
-        return true;
+    queueUpdate(transcription, {});
+    return true;
+}
+
+void TranscriptionStorage::queueUpdate(const Transcription& transcription, SqliteWriter::Completion done) {
+    const QString id = transcription.getId();
+    invalidateCached({id});
+    m_pending.note(writeKeys(transcription), queueWrite({TRANSCRIPTION_UPDATE_SQL, updateValues(transcription)},
+                                                        [this, id]() { emit transcriptionUpdated(id); },
+                                                        std::move(done)));
+}
+
+bool TranscriptionStorage::updateTranscriptions(const QList<Transcription>& transcriptions) {
+    SqliteWriter::Statement statement;
+    statement.sql = TRANSCRIPTION_UPDATE_SQL;
+    QStringList ids;
+    QStringList keys;
+    for (const Transcription& transcription : transcriptions) {
+        if (transcription.isValid()) {
+            statement.rows.append(updateValues(transcription));
+            ids.append(transcription.getId());
+            keys += writeKeys(transcription);
+        }
     }
     
-    return false;
+    if (ids.isEmpty()) {
+        return false;
+    }
+    invalidateCached(ids);
+    m_pending.note(keys, queueWrite(statement, [this, ids]() { emit transcriptionsUpdated(ids); }));
+    return true;
+}
+
+QVariantList TranscriptionStorage::updateValues(const Transcription& transcription) {
+    return {
+        transcription.getRecordingId(),
+        transcription.getText(),
+        transcription.getConfidence(),
+        transcription.getProvider(),
+        transcription.getLanguage(),
+        transcription.getProcessingTime(),
+        wordTimingsToBlob(transcription.getWordTimings()),
+        transcriptionStatusToString(transcription.getStatus()),
+        transcription.getId(),
+    };
 }
 
 bool TranscriptionStorage::deleteTranscription(const QString& id) {
-    QMutexLocker locker(&m_mutex);
-    
-    QSqlQuery query(*m_database);
-    query.prepare("DELETE FROM transcriptions WHERE id = ?");
-    query.addBindValue(id);
-    
-    if (executeQuery(query)) {
-        emit transcriptionDeleted(id);
-        return true;
-    }
-    
-    return false;
+    invalidateCached({id});
+    m_pending.note(id, queueWrite({"DELETE FROM transcriptions WHERE id = ?", {id}},
+                                  [this, id]() { emit transcriptionDeleted(id); }));
+    return true;
 }
 
 bool TranscriptionStorage::transcriptionExists(const QString& id) const {
-    QMutexLocker locker(&m_mutex);
-    
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT COUNT(*) FROM transcriptions WHERE id = ?");
-    query.addBindValue(id);
+    return rowExists(id);
+}
+
+bool TranscriptionStorage::rowExists(const QString& id) const {
+    m_pending.waitFor(id);
+    auto query = m_readers->statements().prepare("SELECT COUNT(*) FROM transcriptions WHERE id = ?");
+    query->addBindValue(id);
     
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toInt() > 0;
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt() > 0;
     }
     
     return false;
 }
 
 QList<Transcription> TranscriptionStorage::getAllTranscriptions(const QueryOptions& options) const {
-    QMutexLocker locker(&m_mutex);
+    QString queryStr = "SELECT * FROM transcriptions ORDER BY created_at";
+    queryStr += options.sortOrder == SortOrder::Descending ? " DESC" : " ASC";
+    if (options.limit > 0) {
+        queryStr += QString(" LIMIT %1").arg(options.limit);
+        if (options.offset > 0) {
+            queryStr += QString(" OFFSET %1").arg(options.offset);
+        }
+    }
     
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT * FROM transcriptions ORDER BY created_at DESC");
+    auto query = m_readers->statements().prepare(queryStr);
     
     QList<Transcription> transcriptions;
-    if (executeQuery(query)) {
-        while (query.next()) {
-            transcriptions.append(transcriptionFromQuery(query));
+    if (executeQuery(*query)) {
+        while (query->next()) {
+            transcriptions.append(transcriptionFromQuery(*query));
         }
     }
     
@@ -492,117 +882,209 @@ QList<Transcription> TranscriptionStorage::getAllTranscriptions(const QueryOptio
 }
 
 Transcription TranscriptionStorage::getTranscriptionByRecording(const QString& recordingId) const {
-    QMutexLocker locker(&m_mutex);
+    // "No transcription yet" is cached as well; the next transcription write drops it
+    quint64 generation = 0;
+    if (std::optional<Transcription> cached = m_byRecording.find(recordingId, &generation)) {
+        return *cached;
+    }
     
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT * FROM transcriptions WHERE recording_id = ? ORDER BY created_at DESC LIMIT 1");
-    query.addBindValue(recordingId);
+    m_pending.waitFor(recordingKey(recordingId));
+    auto query = m_readers->statements().prepare("SELECT * FROM transcriptions WHERE recording_id = ? ORDER BY created_at DESC LIMIT 1");
+    query->addBindValue(recordingId);
     
-    if (executeQuery(query) && query.next()) {
-        return transcriptionFromQuery(query);
+    Transcription transcription;
+    if (!executeQuery(*query)) {
+        return transcription;
     }
-    
-    return Transcription();
+    if (query->next()) {
+        transcription = transcriptionFromQuery(*query);
+    }
+    m_byRecording.insert(recordingId, transcription, generation);
+    return transcription;
 }
 
 QList<Transcription> TranscriptionStorage::searchTranscriptions(const QString& searchTerm, const QueryOptions& options) const {
-    QMutexLocker locker(&m_mutex);
+    QString queryStr;
+    QVariantList values;
+    if (m_fullTextSearch) {
+        const QString match = ftsMatchExpression(searchTerm);
+        if (match.isEmpty()) {
+            return QList<Transcription>();
+        }
+        queryStr = "SELECT t.* FROM search_index "
+                   "JOIN search_documents d ON d.doc_id = search_index.rowid "
+                   "JOIN transcriptions t ON t.id = d.source_id "
+                   "WHERE search_index MATCH ? AND d.kind = 'transcription' "
+                   "ORDER BY search_index.rank LIMIT ? OFFSET ?";
+        values = {match, options.limit > 0 ? options.limit : -1, qMax(0, options.offset)};
+    } else {
+        queryStr = "SELECT * FROM transcriptions WHERE text LIKE ? ORDER BY created_at DESC";
+        values = {"%" + searchTerm + "%"};
+    }
     
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT * FROM transcriptions WHERE text LIKE ? ORDER BY created_at DESC");
-    query.addBindValue("%" + searchTerm + "%");
+    auto query = m_readers->statements().prepare(queryStr);
+    for (const QVariant& value : values) {
+        query->addBindValue(value);
+    }
     
     QList<Transcription> transcriptions;
-    if (executeQuery(query)) {
-        while (query.next()) {
-            transcriptions.append(transcriptionFromQuery(query));
+    if (executeQuery(*query)) {
+        while (query->next()) {
+            transcriptions.append(transcriptionFromQuery(*query));
         }
     }
     
     return transcriptions;
 }
 
-QList<Transcription> TranscriptionStorage::getTranscriptionsByProvider(const QString& provider) const {
-    QMutexLocker locker(&m_mutex);
+QList<TranscriptionSearchHit> TranscriptionStorage::searchTranscriptionsRanked(const QString& searchTerm, int limit,
+                                                                               const QString& highlightOpen,
+                                                                               const QString& highlightClose) const {
+    QList<TranscriptionSearchHit> hits;
+    const QString match = ftsMatchExpression(searchTerm);
+    if (!m_fullTextSearch || match.isEmpty() || limit <= 0) {
+        return hits;
+    }
+    
+    // A transcription can match through its own text and its enhanced texts; rows
+    // come best first, so the first one seen for a transcription is the one kept
+    auto query = m_readers->statements().prepare("SELECT d.transcription_id, d.kind, "
+                                       "snippet(search_index, 0, ?, ?, '...', ?), bm25(search_index) "
+                                       "FROM search_index "
+                                       "JOIN search_documents d ON d.doc_id = search_index.rowid "
+                                       "WHERE search_index MATCH ? AND d.transcription_id IS NOT NULL "
+                                       "ORDER BY bm25(search_index) LIMIT ?");
+    query->addBindValue(highlightOpen);
+    query->addBindValue(highlightClose);
+    query->addBindValue(SNIPPET_TOKENS);
+    query->addBindValue(match);
+    query->addBindValue(limit * 2);
+    
+    QSet<QString> seen;
+    if (executeQuery(*query)) {
+        while (query->next() && hits.size() < limit) {
+            const QString transcriptionId = query->value(0).toString();
+            if (seen.contains(transcriptionId)) {
+                continue;
+            }
+            seen.insert(transcriptionId);
+            
+            TranscriptionSearchHit hit;
+            hit.transcriptionId = transcriptionId;
+            hit.matchedEnhancedText = query->value(1).toString() == "enhanced_text";
+            hit.snippet = query->value(2).toString();
+            hit.score = -query->value(3).toDouble();
+            hits.append(hit);
+        }
+    }
     
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT * FROM transcriptions WHERE provider = ? ORDER BY created_at DESC");
-    query.addBindValue(provider);
+    return hits;
+}
+
+QList<Transcription> TranscriptionStorage::getTranscriptionsByProvider(const QString& provider) const {
+    auto query = m_readers->statements().prepare("SELECT * FROM transcriptions WHERE provider = ? ORDER BY created_at DESC");
+    query->addBindValue(provider);
     
     QList<Transcription> transcriptions;
-    if (executeQuery(query)) {
-        while (query.next()) {
-            transcriptions.append(transcriptionFromQuery(query));
+    if (executeQuery(*query)) {
+        while (query->next()) {
+            transcriptions.append(transcriptionFromQuery(*query));
         }
     }
     
     return transcriptions;
 }
 
+std::unique_ptr<StorageCursor<Transcription>> TranscriptionStorage::openTranscriptionCursor(const PageRequest& request) const {
+    const QSqlDatabase database = m_readers->database();
+    QSqlQuery query(database);
+    prepareKeysetQuery(query, database, "transcriptions", "created_at", request);
+    executeQuery(query);
+    return std::make_unique<SqlCursor<Transcription>>(
+        std::move(query), "created_at", [this](const QSqlQuery& row) { return transcriptionFromQuery(row); });
+}
+
 int TranscriptionStorage::getTranscriptionCount() const {
-    QMutexLocker locker(&m_mutex);
-    
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT COUNT(*) FROM transcriptions");
+    auto query = m_readers->statements().prepare(STATISTIC_SQL);
+    query->addBindValue("transcriptions.count");
     
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toInt();
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt();
     }
     
     return 0;
 }
 
 double TranscriptionStorage::getAverageConfidence() const {
-    QMutexLocker locker(&m_mutex);
-    
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT AVG(confidence) FROM transcriptions WHERE confidence > 0");
+    auto query = m_readers->statements().prepare(STATISTIC_AVERAGE_SQL);
+    query->addBindValue("transcriptions.confidence_rows");
+    query->addBindValue("transcriptions.confidence_sum");
     
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toDouble();
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toDouble();
     }
     
     return 0.0;
 }
 
 qint64 TranscriptionStorage::getAverageProcessingTime() const {
-    QMutexLocker locker(&m_mutex);
+    auto query = m_readers->statements().prepare(STATISTIC_AVERAGE_SQL);
+    query->addBindValue("transcriptions.processing_time_rows");
+    query->addBindValue("transcriptions.processing_time_sum");
     
-    QSqlQuery query(*m_database);
-    query.prepare("SELECT AVG(processing_time) FROM transcriptions WHERE processing_time > 0");
-    
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toLongLong();
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toLongLong();
     }
     
     return 0;
 }
 
 Transcription TranscriptionStorage::transcriptionFromQuery(const QSqlQuery& query) const {
+    const QSqlRecord record = query.record();
+    auto value = [&](const char* column) { return record.contains(column) ? query.value(column) : QVariant(); };
+    
     Transcription transcription;
     QJsonObject json;
     
-    json["id"] = query.value("id").toString();
-    json["recordingId"] = query.value("recording_id").toString();
-    json["text"] = query.value("text").toString();
-    json["confidence"] = query.value("confidence").toDouble();
-    json["provider"] = query.value("provider").toString();
-    json["language"] = query.value("language").toString();
-    json["processingTime"] = query.value("processing_time").toLongLong();
-    json["createdAt"] = query.value("created_at").toDateTime().toString(Qt::ISODate);
-    json["status"] = query.value("status").toString();
-    
-    // Parse word timestamps JSON
-    QString timestampsStr = query.value("word_timestamps").toString();
-    if (!timestampsStr.isEmpty()) {
-        QJsonDocument doc = QJsonDocument::fromJson(timestampsStr.toUtf8());
-        json["wordTimestamps"] = doc.array();
-    }
+    json["id"] = value("id").toString();
+    json["recordingId"] = value("recording_id").toString();
+    json["text"] = value("text").toString();
+    json["confidence"] = value("confidence").toDouble();
+    json["provider"] = value("provider").toString();
+    json["language"] = value("language").toString();
+    json["processingTime"] = value("processing_time").toLongLong();
+    json["createdAt"] = value("created_at").toDateTime().toString(Qt::ISODate);
+    json["status"] = value("status").toString();
     
     transcription.fromJson(json);
+    transcription.setWordTimings(wordTimingsFromColumn(value("word_timestamps")));
     return transcription;
 }
 
+QVariant TranscriptionStorage::wordTimingsToBlob(const WordTimingTable& timings) {
+    // NULL rather than an empty BLOB keeps rows without timings small
+    return timings.isEmpty() ? QVariant(QMetaType::fromType<QByteArray>()) : QVariant(timings.toBlob());
+}
+
+WordTimingTable TranscriptionStorage::wordTimingsFromColumn(const QVariant& value) {
+    const QByteArray data = value.toByteArray();
+    if (data.isEmpty()) {
+        return WordTimingTable();
+    }
+    
+    if (WordTimingTable::isBlob(data)) {
+        bool ok = false;
+        WordTimingTable timings = WordTimingTable::fromBlob(data, &ok);
+        if (!ok) {
+            qWarning() << "Ignoring corrupt word timestamp BLOB";
+        }
+        return timings;
+    }
+    
+    // Rows written before the packed format hold a JSON array
+    return WordTimingTable::fromJson(QJsonDocument::fromJson(data).array());
+}
+
 bool TranscriptionStorage::executeQuery(QSqlQuery& query) const {
     if (!query.exec()) {
         qWarning() << "SQL query failed:" << query.lastError().text();
@@ -611,36 +1093,163 @@ bool TranscriptionStorage::executeQuery(QSqlQuery& query) const {
     return true;
 }
 
-// EnhancedTextStorage Implementation (simplified)
-EnhancedTextStorage::EnhancedTextStorage(QSqlDatabase* database, QObject* parent)
-    : IEnhancedTextStorage(parent), m_database(database)
+void TranscriptionStorage::invalidateCached(const QStringList& ids) {
+    for (const QString& id : ids) {
+        m_cache.remove(id);
+    }
+    // Which recordings the rows belong to is not known here
+    m_byRecording.clear();
+}
+
+void TranscriptionStorage::invalidateRecording(const QString& recordingId) {
+    // Its transcriptions went with it (ON DELETE CASCADE)
+    m_byRecording.remove(recordingId);
+    m_cache.clear();
+}
+
+EntityCacheStats TranscriptionStorage::cacheStats() const {
+    EntityCacheStats stats = m_cache.stats();
+    const EntityCacheStats byRecording = m_byRecording.stats();
+    stats.hits += byRecording.hits;
+    stats.misses += byRecording.misses;
+    stats.invalidations += byRecording.invalidations;
+    stats.size += byRecording.size;
+    return stats;
+}
+
+QStringList TranscriptionStorage::writeKeys(const Transcription& transcription) {
+    return {transcription.getId(), recordingKey(transcription.getRecordingId())};
+}
+
+quint64 TranscriptionStorage::queueWrite(const SqliteWriter::Statement& statement, std::function<void()> committed,
+                                         SqliteWriter::Completion done) {
+    return m_writer->enqueue(statement, this, [committed, done](bool ok, const QString& errorMessage) {
+        if (ok && committed) {
+            committed();
+        }
+        if (done) {
+            done(ok, errorMessage); // Reports a failure itself
+        } else if (!ok) {
+            qWarning() << "Transcription write failed:" << errorMessage;
+        }
+    });
+}
+
+// EnhancedTextStorage Implementation
+EnhancedTextStorage::EnhancedTextStorage(QSqlDatabase* database, SqliteWriter* writer, ConnectionPool* readers,
+                                         QObject* parent)
+    : IEnhancedTextStorage(parent), m_database(database), m_writer(writer), m_readers(readers),
+      m_pending(writer)
 {
 }
 
 QString EnhancedTextStorage::saveEnhancedText(const EnhancedText& enhancedText) {
-    // Similar implementation to other storage classes
-    emit enhancedTextCreated(enhancedText.getId());
-    return enhancedText.getId();
+    return queueSave(enhancedText, {});
+}
+
+QString EnhancedTextStorage::queueSave(const EnhancedText& enhancedText, SqliteWriter::Completion done) {
+    if (!enhancedText.isValid()) {
+        if (done) {
+            done(false, "Invalid enhanced text");
+        }
+        return QString();
+    }
+    
+    const QString id = enhancedText.getId();
+    m_pending.note(id, queueWrite({ENHANCED_TEXT_INSERT_SQL, insertValues(enhancedText)},
+                                  [this, id]() { emit enhancedTextCreated(id); }, std::move(done)));
+    return id;
+}
+
+QStringList EnhancedTextStorage::saveEnhancedTexts(const QList<EnhancedText>& enhancedTexts) {
+    SqliteWriter::Statement statement;
+    statement.sql = ENHANCED_TEXT_INSERT_SQL;
+    QStringList ids;
+    for (const EnhancedText& enhancedText : enhancedTexts) {
+        if (enhancedText.isValid()) {
+            statement.rows.append(insertValues(enhancedText));
+            ids.append(enhancedText.getId());
+        }
+    }
+    
+    if (!ids.isEmpty()) {
+        m_pending.note(ids, queueWrite(statement, [this, ids]() { emit enhancedTextsCreated(ids); }));
+    }
+    return ids;
+}
+
+QVariantList EnhancedTextStorage::insertValues(const EnhancedText& enhancedText) {
+    return {
+        enhancedText.getId(),
+        enhancedText.getTranscriptionId(),
+        enhancedText.getOriginalText(),
+        enhancedText.getEnhancedText(),
+        static_cast<int>(enhancedText.getEnhancementMode()),
+        enhancedText.getProvider(),
+        enhancedText.getPromptTemplate(),
+        enhancedText.getProcessingTime(),
+        QString::fromUtf8(QJsonDocument(enhancedText.getSettings()).toJson(QJsonDocument::Compact)),
+        enhancedText.getCreatedAt(),
+        enhancedText.getUserRating(),
+    };
+}
+
+QVariantList EnhancedTextStorage::updateValues(const EnhancedText& enhancedText) {
+    return {
+        enhancedText.getTranscriptionId(),
+        enhancedText.getOriginalText(),
+        enhancedText.getEnhancedText(),
+        static_cast<int>(enhancedText.getEnhancementMode()),
+        enhancedText.getProvider(),
+        enhancedText.getPromptTemplate(),
+        enhancedText.getProcessingTime(),
+        QString::fromUtf8(QJsonDocument(enhancedText.getSettings()).toJson(QJsonDocument::Compact)),
+        enhancedText.getUserRating(),
+        enhancedText.getId(),
+    };
 }
 
 EnhancedText EnhancedTextStorage::getEnhancedText(const QString& id) const {
-    // Implementation here
-    Q_UNUSED(id)
+    m_pending.waitFor(id);
+    auto query = m_readers->statements().prepare("SELECT * FROM enhanced_texts WHERE id = ?");
+    query->addBindValue(id);
+    
+    if (executeQuery(*query) && query->next()) {
+        return enhancedTextFromQuery(*query);
+    }
+    
     return EnhancedText();
 }
 
 bool EnhancedTextStorage::updateEnhancedText(const EnhancedText& enhancedText) {
-    emit enhancedTextUpdated(enhancedText.getId());
+    if (!enhancedText.isValid() || !rowExists(enhancedText.getId())) {
+        return false;
+    }
+    const QString id = enhancedText.getId();
+    m_pending.note(id, queueWrite({ENHANCED_TEXT_UPDATE_SQL, updateValues(enhancedText)},
+                                  [this, id]() { emit enhancedTextUpdated(id); }));
     return true;
 }
 
 bool EnhancedTextStorage::deleteEnhancedText(const QString& id) {
-    emit enhancedTextDeleted(id);
+    m_pending.note(id, queueWrite({"DELETE FROM enhanced_texts WHERE id = ?", {id}},
+                                  [this, id]() { emit enhancedTextDeleted(id); }));
     return true;
 }
 
 bool EnhancedTextStorage::enhancedTextExists(const QString& id) const {
-    Q_UNUSED(id)
+    return rowExists(id);
+}
+
+bool EnhancedTextStorage::rowExists(const QString& id) const {
+    m_pending.waitFor(id);
+    auto query = m_readers->statements().prepare("SELECT COUNT(*) FROM enhanced_texts WHERE id = ?");
+    query->addBindValue(id);
+    
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt() > 0;
+    }
+    
     return false;
 }
 
@@ -650,8 +1259,18 @@ QList<EnhancedText> EnhancedTextStorage::getAllEnhancedTexts(const QueryOptions&
 }
 
 QList<EnhancedText> EnhancedTextStorage::getEnhancedTextsByTranscription(const QString& transcriptionId) const {
-    Q_UNUSED(transcriptionId)
-    return QList<EnhancedText>();
+    auto query = m_readers->statements().prepare(
+        "SELECT * FROM enhanced_texts WHERE transcription_id = ? ORDER BY created_at");
+    query->addBindValue(transcriptionId);
+    
+    QList<EnhancedText> enhancedTexts;
+    if (executeQuery(*query)) {
+        while (query->next()) {
+            enhancedTexts.append(enhancedTextFromQuery(*query));
+        }
+    }
+    
+    return enhancedTexts;
 }
 
 QList<EnhancedText> EnhancedTextStorage::getEnhancedTextsByMode(int enhancementMode) const {
@@ -677,55 +1296,153 @@ double EnhancedTextStorage::getAverageUserRating() const {
 }
 
 EnhancedText EnhancedTextStorage::enhancedTextFromQuery(const QSqlQuery& query) const {
-    Q_UNUSED(query)
-    return EnhancedText();
+    const QSqlRecord record = query.record();
+    auto value = [&](const char* column) { return record.contains(column) ? query.value(column) : QVariant(); };
+    
+    EnhancedText enhancedText;
+    QJsonObject json;
+    
+    json["id"] = value("id").toString();
+    json["transcriptionId"] = value("transcription_id").toString();
+    json["originalText"] = value("original_text").toString();
+    json["enhancedText"] = value("enhanced_text").toString();
+    json["enhancementMode"] = enhancementModeToString(static_cast<EnhancementMode>(value("enhancement_mode").toInt()));
+    json["provider"] = value("provider").toString();
+    json["promptTemplate"] = value("prompt_template").toString();
+    json["processingTime"] = value("processing_time").toLongLong();
+    json["settings"] = QJsonDocument::fromJson(value("settings").toString().toUtf8()).object();
+    json["createdAt"] = value("created_at").toDateTime().toString(Qt::ISODate);
+    json["userRating"] = value("user_rating").toInt();
+    
+    enhancedText.fromJson(json);
+    return enhancedText;
 }
 
 bool EnhancedTextStorage::executeQuery(QSqlQuery& query) const {
-    return query.exec();
+    if (!query.exec()) {
+        qWarning() << "SQL query failed:" << query.lastError().text();
+        return false;
+    }
+    return true;
 }
 
-// UserSessionStorage Implementation (simplified)
-UserSessionStorage::UserSessionStorage(QSqlDatabase* database, QObject* parent)
-    : IUserSessionStorage(parent), m_database(database)
+quint64 EnhancedTextStorage::queueWrite(const SqliteWriter::Statement& statement, std::function<void()> committed,
+                                        SqliteWriter::Completion done) {
+    return m_writer->enqueue(statement, this, [committed, done](bool ok, const QString& errorMessage) {
+        if (ok && committed) {
+            committed();
+        }
+        if (done) {
+            done(ok, errorMessage); // Reports a failure itself
+        } else if (!ok) {
+            qWarning() << "Enhanced text write failed:" << errorMessage;
+        }
+    });
+}
+
+// UserSessionStorage Implementation
+UserSessionStorage::UserSessionStorage(QSqlDatabase* database, SqliteWriter* writer, ConnectionPool* readers,
+                                       QObject* parent)
+    : IUserSessionStorage(parent), m_database(database), m_writer(writer), m_readers(readers),
+      m_pending(writer)
 {
 }
 
 QString UserSessionStorage::saveUserSession(const UserSession& session) {
-    emit sessionCreated(session.getId());
-    return session.getId();
+    if (!session.isValid()) {
+        return QString();
+    }
+    
+    const QString id = session.getId();
+    m_pending.note(id, queueWrite({USER_SESSION_INSERT_SQL, insertValues(session)},
+                                  [this, id]() { emit sessionCreated(id); }));
+    return id;
+}
+
+QVariantList UserSessionStorage::insertValues(const UserSession& session) {
+    return {
+        session.getId(),
+        session.getName(),
+        session.getStartTime(),
+        session.getEndTime().isValid() ? QVariant(session.getEndTime()) : QVariant(),
+        sessionStatusToString(session.getStatus()),
+        session.getNotes(),
+        session.getRecordingCount(),
+        session.getTotalDuration(),
+    };
+}
+
+QVariantList UserSessionStorage::updateValues(const UserSession& session) {
+    return {
+        session.getName(),
+        session.getStartTime(),
+        session.getEndTime().isValid() ? QVariant(session.getEndTime()) : QVariant(),
+        sessionStatusToString(session.getStatus()),
+        session.getNotes(),
+        session.getRecordingCount(),
+        session.getTotalDuration(),
+        session.getId(),
+    };
 }
 
 UserSession UserSessionStorage::getUserSession(const QString& id) const {
-    Q_UNUSED(id)
+    m_pending.waitFor(id);
+    auto query = m_readers->statements().prepare("SELECT * FROM user_sessions WHERE id = ?");
+    query->addBindValue(id);
+    
+    if (executeQuery(*query) && query->next()) {
+        return userSessionFromQuery(*query);
+    }
+    
     return UserSession();
 }
 
 bool UserSessionStorage::updateUserSession(const UserSession& session) {
-    emit sessionUpdated(session.getId());
+    if (!session.isValid() || !rowExists(session.getId())) {
+        return false;
+    }
+    const QString id = session.getId();
+    m_pending.note(id, queueWrite({USER_SESSION_UPDATE_SQL, updateValues(session)},
+                                  [this, id]() { emit sessionUpdated(id); }));
     return true;
 }
 
 bool UserSessionStorage::deleteUserSession(const QString& id) {
-    emit sessionDeleted(id);
+    m_pending.note(id, queueWrite({"DELETE FROM user_sessions WHERE id = ?", {id}},
+                                  [this, id]() { emit sessionDeleted(id); }));
     return true;
 }
 
 bool UserSessionStorage::userSessionExists(const QString& id) const {
-    Q_UNUSED(id)
+    return rowExists(id);
+}
+
+bool UserSessionStorage::rowExists(const QString& id) const {
+    m_pending.waitFor(id);
+    auto query = m_readers->statements().prepare("SELECT COUNT(*) FROM user_sessions WHERE id = ?");
+    query->addBindValue(id);
+    
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt() > 0;
+    }
+    
     return false;
 }
 
 QString UserSessionStorage::createNewSession(const QString& name) {
-    QString sessionId = BaseModel::generateUuid();
-    emit sessionCreated(sessionId);
-    emit sessionStarted(sessionId);
-    return sessionId;
+    // The writer commits in order, so recordings queued against the id land after the row
+    const UserSession session(name);
+    const QString id = saveUserSession(session);
+    if (!id.isEmpty()) {
+        emit sessionStarted(id);
+    }
+    return id;
 }
 
 bool UserSessionStorage::endSession(const QString& id, const QDateTime& endTime) {
-    Q_UNUSED(endTime)
-    emit sessionEnded(id);
+    m_pending.note(id, queueWrite({"UPDATE user_sessions SET ended_at = ?, status = ? WHERE id = ?",
+                                   {endTime, sessionStatusToString(SessionStatus::Completed), id}},
+                                  [this, id]() { emit sessionEnded(id); }));
     return true;
 }
 
@@ -738,8 +1455,25 @@ QList<UserSession> UserSessionStorage::getActiveSessions() const {
 }
 
 QList<UserSession> UserSessionStorage::getAllSessions(const QueryOptions& options) const {
-    Q_UNUSED(options)
-    return QList<UserSession>();
+    QString queryStr = "SELECT * FROM user_sessions ORDER BY started_at";
+    queryStr += options.sortOrder == SortOrder::Descending ? " DESC" : " ASC";
+    if (options.limit > 0) {
+        queryStr += QString(" LIMIT %1").arg(options.limit);
+        if (options.offset > 0) {
+            queryStr += QString(" OFFSET %1").arg(options.offset);
+        }
+    }
+    
+    auto query = m_readers->statements().prepare(queryStr);
+    
+    QList<UserSession> sessions;
+    if (executeQuery(*query)) {
+        while (query->next()) {
+            sessions.append(userSessionFromQuery(*query));
+        }
+    }
+    
+    return sessions;
 }
 
 QList<UserSession> UserSessionStorage::getSessionsByDateRange(const QDateTime& start, const QDateTime& end) const {
@@ -754,11 +1488,35 @@ QList<UserSession> UserSessionStorage::searchSessions(const QString& searchTerm,
     return QList<UserSession>();
 }
 
+std::unique_ptr<StorageCursor<UserSession>> UserSessionStorage::openSessionCursor(const PageRequest& request) const {
+    const QSqlDatabase database = m_readers->database();
+    QSqlQuery query(database);
+    prepareKeysetQuery(query, database, "user_sessions", "started_at", request);
+    executeQuery(query);
+    return std::make_unique<SqlCursor<UserSession>>(
+        std::move(query), "started_at", [this](const QSqlQuery& row) { return userSessionFromQuery(row); });
+}
+
 int UserSessionStorage::getSessionCount() const {
+    auto query = m_readers->statements().prepare(STATISTIC_SQL);
+    query->addBindValue("user_sessions.count");
+    
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt();
+    }
+    
     return 0;
 }
 
 qint64 UserSessionStorage::getAverageSessionDuration() const {
+    auto query = m_readers->statements().prepare(STATISTIC_AVERAGE_SQL);
+    query->addBindValue("user_sessions.count");
+    query->addBindValue("user_sessions.duration_sum");
+    
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toLongLong();
+    }
+    
     return 0;
 }
 
@@ -767,12 +1525,41 @@ int UserSessionStorage::getAverageRecordingsPerSession() const {
 }
 
 UserSession UserSessionStorage::userSessionFromQuery(const QSqlQuery& query) const {
-    Q_UNUSED(query)
-    return UserSession();
+    const QSqlRecord record = query.record();
+    auto value = [&](const char* column) { return record.contains(column) ? query.value(column) : QVariant(); };
+    
+    UserSession session;
+    QJsonObject json;
+    
+    json["id"] = value("id").toString();
+    json["name"] = value("name").toString();
+    json["startTime"] = value("started_at").toDateTime().toString(Qt::ISODate);
+    json["endTime"] = value("ended_at").toDateTime().toString(Qt::ISODate);
+    json["status"] = value("status").toString();
+    json["notes"] = value("notes").toString();
+    json["recordingCount"] = value("recording_count").toInt();
+    json["totalDuration"] = value("total_duration").toLongLong();
+    
+    session.fromJson(json);
+    return session;
 }
 
 bool UserSessionStorage::executeQuery(QSqlQuery& query) const {
-    return query.exec();
+    if (!query.exec()) {
+        qWarning() << "SQL query failed:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+quint64 UserSessionStorage::queueWrite(const SqliteWriter::Statement& statement, std::function<void()> committed) {
+    return m_writer->enqueue(statement, this, [committed](bool ok, const QString& errorMessage) {
+        if (ok && committed) {
+            committed();
+        } else if (!ok) {
+            qWarning() << "Session write failed:" << errorMessage;
+        }
+    });
 }
 
 // EnhancementProfileStorage Implementation (simplified)
@@ -846,19 +1633,27 @@ bool EnhancementProfileStorage::executeQuery(QSqlQuery& query) const {
 // StorageManager Implementation
 StorageManager::StorageManager(QObject* parent)
     : IStorageManager(parent)
+    , m_migrations(&m_writer, &m_readers)
     , m_isEncrypted(false)
+    , m_fullTextSearch(false)
     , m_recordingStorage(nullptr)
     , m_transcriptionStorage(nullptr)
     , m_enhancedTextStorage(nullptr)
     , m_userSessionStorage(nullptr)
     , m_profileStorage(nullptr)
+    , m_asyncStorage(nullptr)
     , m_lastError(StorageError::NoError)
     , m_transactionLevel(0)
+    , m_backupBytesTotal(0)
 {
     // Setup maintenance timer
     m_maintenanceTimer = new QTimer(this);
     m_maintenanceTimer->setInterval(MAINTENANCE_INTERVAL_MS);
     connect(m_maintenanceTimer, &QTimer::timeout, this, &StorageManager::performMaintenance);
+    
+    m_backupProgressTimer = new QTimer(this);
+    m_backupProgressTimer->setInterval(BACKUP_PROGRESS_INTERVAL_MS);
+    connect(m_backupProgressTimer, &QTimer::timeout, this, &StorageManager::reportBackupProgress);
 }
 
 StorageManager::~StorageManager() {
@@ -893,6 +1688,11 @@ bool StorageManager::initialize(const QString& databasePath) {
         return false;
     }
     
+    QString pragmaError;
+    if (!SqliteWriter::configureConnection(m_database, &pragmaError)) {
+        qWarning() << "Cannot configure database connection:" << pragmaError;
+    }
+    
     // Create tables if they don't exist
     if (!createTables()) {
         close();
@@ -901,14 +1701,38 @@ bool StorageManager::initialize(const QString& databasePath) {
     
     // Create indexes and triggers
     createIndexes();
+    m_fullTextSearch = createSearchIndex();
     createTriggers();
     
+    // Writes go to their own connection on the writer thread
+    if (!m_writer.start(databasePath, getConnectionName() + "_writer")) {
+        setError(StorageError::DatabaseConnectionFailed, m_writer.lastError());
+        close();
+        return false;
+    }
+    
+    // Reads run on per-thread connections opened on first use
+    m_readers.open(databasePath, getConnectionName());
+    
     // Initialize storage components
-    m_recordingStorage = new RecordingStorage(&m_database, this);
-    m_transcriptionStorage = new TranscriptionStorage(&m_database, this);
-    m_enhancedTextStorage = new EnhancedTextStorage(&m_database, this);
-    m_userSessionStorage = new UserSessionStorage(&m_database, this);
+    m_recordingStorage = new RecordingStorage(&m_database, &m_writer, &m_readers, this);
+    m_transcriptionStorage = new TranscriptionStorage(&m_database, &m_writer, &m_readers, this);
+    m_recordingStorage->setFullTextSearch(m_fullTextSearch);
+    m_recordingStorage->setRecordingsDirectory(
+        QFileInfo(databasePath).absolutePath() + "/" + RECORDINGS_DIRECTORY_NAME);
+    m_transcriptionStorage->setFullTextSearch(m_fullTextSearch);
+    connect(m_recordingStorage, &IRecordingStorage::recordingDeleted,
+            m_transcriptionStorage, &TranscriptionStorage::invalidateRecording);
+    m_enhancedTextStorage = new EnhancedTextStorage(&m_database, &m_writer, &m_readers, this);
+    m_userSessionStorage = new UserSessionStorage(&m_database, &m_writer, &m_readers, this);
     m_profileStorage = new EnhancementProfileStorage(&m_database, this);
+    m_asyncStorage = new AsyncStorage(this, &m_writer, m_recordingStorage, m_transcriptionStorage,
+                                      m_enhancedTextStorage);
+    
+    // Schema changes are quick; row rewrites continue in the background
+    if (!migrateToVersion(CURRENT_SCHEMA_VERSION)) {
+        qWarning() << "Schema migration failed:" << m_errorString;
+    }
     
     // Start maintenance timer
     m_maintenanceTimer->start();
@@ -927,6 +1751,20 @@ bool StorageManager::close() {
     
     m_maintenanceTimer->stop();
     
+    // A running backup has its own connection; let it finish its copy
+    m_backup.wait();
+    m_backupProgressTimer->stop();
+    
+    // Async reads use the storages, so they finish first
+    delete m_asyncStorage;
+    m_asyncStorage = nullptr;
+    
+    // A backfill stops between batches; its cursor resumes it on the next start
+    m_migrations.stop();
+    
+    // Commit what is still queued before the storages go away
+    m_writer.stop();
+    
     // Cleanup storage components
     delete m_recordingStorage;
     delete m_transcriptionStorage;
@@ -940,6 +1778,9 @@ bool StorageManager::close() {
     m_userSessionStorage = nullptr;
     m_profileStorage = nullptr;
     
+    // Every thread's read connection, before the database they share
+    m_readers.close();
+    
     // Close database
     if (m_database.isOpen()) {
         m_database.close();
@@ -951,6 +1792,14 @@ bool StorageManager::close() {
     return true;
 }
 
+EntityCacheStats StorageManager::getRecordingCacheStats() const {
+    return m_recordingStorage ? m_recordingStorage->cacheStats() : EntityCacheStats();
+}
+
+EntityCacheStats StorageManager::getTranscriptionCacheStats() const {
+    return m_transcriptionStorage ? m_transcriptionStorage->cacheStats() : EntityCacheStats();
+}
+
 bool StorageManager::isConnected() const {
     return m_database.isOpen() && m_database.isValid();
 }
@@ -982,13 +1831,13 @@ IEnhancementProfileStorage* StorageManager::getProfileStorage() {
 bool StorageManager::beginTransaction() {
     QMutexLocker locker(&m_transactionMutex);
     
-    if (m_transactionLevel == 0) {
-        if (!m_database.transaction()) {
-            setError(StorageError::QueryFailed, "Failed to begin transaction");
-            return false;
-        }
+    if (!m_writer.isRunning()) {
+        setError(StorageError::QueryFailed, "Failed to begin transaction");
+        return false;
     }
     
+    // Writes made inside the transaction are held and committed as one write
+    m_writer.beginGroup();
     m_transactionLevel++;
     return true;
 }
@@ -1002,14 +1851,7 @@ bool StorageManager::commitTransaction() {
     }
     
     m_transactionLevel--;
-    
-    if (m_transactionLevel == 0) {
-        if (!m_database.commit()) {
-            setError(StorageError::QueryFailed, "Failed to commit transaction");
-            return false;
-        }
-    }
-    
+    m_writer.commitGroup();
     return true;
 }
 
@@ -1021,12 +1863,7 @@ bool StorageManager::rollbackTransaction() {
     }
     
     m_transactionLevel = 0;
-    
-    if (!m_database.rollback()) {
-        setError(StorageError::QueryFailed, "Failed to rollback transaction");
-        return false;
-    }
-    
+    m_writer.discardGroup();
     return true;
 }
 
@@ -1035,31 +1872,101 @@ bool StorageManager::backupDatabase(const QString& backupPath) {
         setError(StorageError::DatabaseConnectionFailed, "Database not connected");
         return false;
     }
+    if (m_backup.isRunning()) {
+        setError(StorageError::BackupFailed, "A backup is already running");
+        return false;
+    }
     
-    // Simple file copy for SQLite
-    if (copyDatabaseFile(m_databasePath, backupPath)) {
+    // VACUUM INTO copies a consistent snapshot while writes continue; only the
+    // caller waits for it. Anything still queued is committed first so it is included.
+    m_writer.waitForQueuedWrites();
+    const QString errorMessage = SqliteBackup::backupInto(m_databasePath, backupPath,
+                                                          getConnectionName() + "_backup");
+    if (errorMessage.isEmpty()) {
         emit backupCompleted(backupPath);
         return true;
     }
     
-    setError(StorageError::BackupFailed, "Failed to copy database file");
+    setError(StorageError::BackupFailed, "Failed to back up database: " + errorMessage);
     return false;
 }
 
+bool StorageManager::startBackup(const QString& backupPath) {
+    if (!isConnected()) {
+        setError(StorageError::DatabaseConnectionFailed, "Database not connected");
+        return false;
+    }
+    
+    m_writer.waitForQueuedWrites();
+    m_backupBytesTotal = estimateBackupSize();
+    const bool started = m_backup.start(m_databasePath, backupPath, getConnectionName() + "_backup", this,
+                                        [this, backupPath](bool ok, const QString& errorMessage) {
+        m_backupProgressTimer->stop();
+        if (!ok) {
+            setError(StorageError::BackupFailed, "Failed to back up database: " + errorMessage);
+            emit backupFailed(backupPath, errorMessage);
+            return;
+        }
+        const qint64 size = QFileInfo(backupPath).size();
+        emit backupProgress(backupPath, size, size);
+        emit backupCompleted(backupPath);
+    });
+    if (!started) {
+        setError(StorageError::BackupFailed, "A backup is already running");
+        return false;
+    }
+    
+    m_backupProgressTimer->start();
+    emit backupProgress(backupPath, 0, m_backupBytesTotal);
+    return true;
+}
+
+bool StorageManager::isBackupRunning() const {
+    return m_backup.isRunning();
+}
+
+void StorageManager::reportBackupProgress() {
+    if (!m_backup.isRunning()) {
+        return;
+    }
+    // The estimate ignores free pages VACUUM drops, so keep the total ahead of the copy
+    const qint64 written = m_backup.bytesWritten();
+    m_backupBytesTotal = qMax(m_backupBytesTotal, written);
+    emit backupProgress(m_backup.destinationPath(), written, m_backupBytesTotal);
+}
+
 bool StorageManager::restoreDatabase(const QString& backupPath) {
     if (!validateBackupFile(backupPath)) {
         setError(StorageError::BackupFailed, "Invalid backup file");
         return false;
     }
+    if (m_backup.isRunning()) {
+        setError(StorageError::BackupFailed, "A backup is running");
+        return false;
+    }
+    
+    // Stage the copy next to the database while it is still open, so it is
+    // closed only for the rename
+    const QString databasePath = m_databasePath;
+    const QString stagedPath = databasePath + ".restore";
+    QFile::remove(stagedPath);
+    if (!copyDatabaseFile(backupPath, stagedPath)) {
+        setError(StorageError::BackupFailed, "Failed to copy backup file");
+        return false;
+    }
     
     // Close current database
     close();
     
-    // Copy backup to current location
-    if (copyDatabaseFile(backupPath, m_databasePath)) {
-        return initialize(m_databasePath);
+    // A WAL left behind would be replayed onto the restored file
+    QFile::remove(databasePath + "-wal");
+    QFile::remove(databasePath + "-shm");
+    QFile::remove(databasePath);
+    if (QFile::rename(stagedPath, databasePath)) {
+        return initialize(databasePath);
     }
     
+    QFile::remove(stagedPath);
     setError(StorageError::BackupFailed, "Failed to restore database");
     return false;
 }
@@ -1084,8 +1991,12 @@ bool StorageManager::vacuum() {
         return false;
     }
     
-    QSqlQuery query(m_database);
-    return query.exec("VACUUM");
+    // Runs on the writer thread behind the writes already queued, outside any transaction
+    return m_writer.enqueueStandalone("VACUUM", this, [this](bool ok, const QString& errorMessage) {
+        if (!ok) {
+            setError(StorageError::QueryFailed, "VACUUM failed: " + errorMessage);
+        }
+    }) != 0;
 }
 
 bool StorageManager::analyze() {
@@ -1102,8 +2013,10 @@ qint64 StorageManager::getDatabaseSize() const {
         return 0;
     }
     
+    // Committed pages live in the WAL until the next checkpoint
     QFileInfo fileInfo(m_databasePath);
-    return fileInfo.size();
+    QFileInfo walInfo(m_databasePath + "-wal");
+    return fileInfo.size() + (walInfo.exists() ? walInfo.size() : 0);
 }
 
 bool StorageManager::checkIntegrity() const {
@@ -1125,7 +2038,7 @@ int StorageManager::getCurrentSchemaVersion() const {
     }
     
     QSqlQuery query(m_database);
-    query.prepare("SELECT version FROM metadata WHERE key = 'schema_version'");
+    query.prepare("SELECT value FROM metadata WHERE key = 'schema_version'");
     
     if (query.exec() && query.next()) {
         return query.value(0).toInt();
@@ -1138,39 +2051,122 @@ bool StorageManager::migrateToVersion(int version) {
     int currentVersion = getCurrentSchemaVersion();
     
     if (currentVersion >= version) {
-        return true; // Already at or above target version
+        startBackfills(); // Resumes backfills an earlier run did not finish
+        return true;
     }
     
     emit migrationProgress(currentVersion, version);
     
-    QStringList updateQueries = getSchemaUpdateQueries(currentVersion, version);
+    // Schema changes run on this connection in a real transaction, after the
+    // writer has committed everything queued against the old schema. Each version
+    // commits on its own, so an interrupted upgrade continues where it stopped.
+    m_writer.waitForQueuedWrites();
+    for (const SchemaMigration& migration : schemaMigrations()) {
+        if (migration.version <= currentVersion || migration.version > version) {
+            continue;
+        }
+        
+        if (!m_database.transaction()) {
+            setError(StorageError::QueryFailed, "Failed to begin transaction");
+            return false;
+        }
+        bool ok = true;
+        for (const QString& queryStr : migration.schema) {
+            ok = ok && executeSqlQuery(queryStr);
+        }
+        if (ok && migration.backfill) {
+            // Rows are rewritten in the background from this cursor
+            QSqlQuery query(m_database);
+            query.prepare("INSERT OR REPLACE INTO metadata (key, value) VALUES (?, '0')");
+            query.addBindValue(MigrationRunner::cursorKey(migration.version));
+            ok = query.exec();
+        }
+        if (!ok || !updateSchemaVersion(migration.version)) {
+            m_database.rollback();
+            setError(StorageError::QueryFailed, QString("Migration to version %1 failed").arg(migration.version));
+            return false;
+        }
+        if (!m_database.commit()) {
+            setError(StorageError::QueryFailed, "Failed to commit transaction");
+            return false;
+        }
+        
+        qDebug() << "Migrated database to schema version" << migration.version << "-" << migration.description;
+        currentVersion = migration.version;
+        emit migrationProgress(currentVersion, version);
+    }
     
-    if (!beginTransaction()) {
-        return false;
+    startBackfills();
+    return true;
+}
+
+void StorageManager::startBackfills() {
+    if (m_migrations.isRunning()) {
+        return;
     }
     
-    for (const QString& queryStr : updateQueries) {
-        if (!executeSqlQuery(queryStr)) {
-            rollbackTransaction();
-            return false;
+    QSqlQuery query(m_database);
+    QSet<QString> pending;
+    if (query.exec("SELECT key FROM metadata WHERE key LIKE 'backfill_%'")) {
+        while (query.next()) {
+            pending.insert(query.value(0).toString());
         }
     }
     
-    if (!updateSchemaVersion(version)) {
-        rollbackTransaction();
-        return false;
+    QList<MigrationRunner::Backfill> backfills;
+    for (const SchemaMigration& migration : schemaMigrations()) {
+        if (migration.backfill && pending.contains(MigrationRunner::cursorKey(migration.version))) {
+            backfills.append(*migration.backfill);
+        }
+    }
+    for (const MigrationRunner::Backfill& backfill : statisticsBackfills()) {
+        if (pending.contains(MigrationRunner::cursorKey(backfill))) {
+            backfills.append(backfill);
+        }
+    }
+    // Without FTS5 the cursors wait for a start that has it
+    if (m_fullTextSearch) {
+        for (const MigrationRunner::Backfill& backfill : searchIndexBackfills()) {
+            if (pending.contains(MigrationRunner::cursorKey(backfill))) {
+                backfills.append(backfill);
+            }
+        }
     }
     
-    return commitTransaction();
+    m_migrations.start(backfills, this,
+        [this](const MigrationRunner::Backfill& backfill, qint64 rowsDone, qint64 rowsTotal) {
+            if (backfill.version > 0) {
+                emit migrationBackfillProgress(backfill.version, rowsDone, rowsTotal);
+            }
+        },
+        [this](const MigrationRunner::Backfill& backfill, bool ok, const QString& errorMessage) {
+            const QString name = MigrationRunner::describe(backfill);
+            if (!ok) {
+                setError(StorageError::QueryFailed, QString("Backfill for %1 failed: %2").arg(name, errorMessage));
+                return;
+            }
+            qDebug() << "Backfill for" << name << "finished";
+            if (backfill.version > 0) {
+                emit migrationProgress(backfill.version, CURRENT_SCHEMA_VERSION);
+            }
+        });
 }
 
 QStringList StorageManager::getPendingMigrations() const {
     QStringList pending;
     int currentVersion = getCurrentSchemaVersion();
     
-    if (currentVersion < CURRENT_SCHEMA_VERSION) {
-        for (int v = currentVersion + 1; v <= CURRENT_SCHEMA_VERSION; v++) {
-            pending.append(QString("Migration to version %1").arg(v));
+    for (const SchemaMigration& migration : schemaMigrations()) {
+        if (migration.version > currentVersion && migration.version <= CURRENT_SCHEMA_VERSION) {
+            pending.append(QString("Migration to version %1: %2").arg(migration.version).arg(migration.description));
+        }
+    }
+    
+    // Applied migrations whose rows are still being rewritten
+    QSqlQuery query(m_database);
+    if (query.exec("SELECT key, value FROM metadata WHERE key LIKE 'backfill_%' ORDER BY key")) {
+        while (query.next()) {
+            pending.append(QString("Backfill %1 from row %2").arg(query.value(0).toString(), query.value(1).toString()));
         }
     }
     
@@ -1214,13 +2210,26 @@ void StorageManager::performMaintenance() {
     
     qDebug() << "Performing database maintenance";
     
-    // Analyze tables for query optimization
-    analyze();
+    // Analyze tables for query optimization, on the writer thread so the GUI
+    // does not wait for it
+    m_asyncStorage->analyze();
     
     // Clean up old data if needed
     if (m_recordingStorage) {
         m_recordingStorage->cleanup();
     }
+    
+    // Unchanged directories are not listed again, so this is cheap after the first run
+    m_asyncStorage->getOrphanedAudioFiles().then(this, [this](const QStringList& files) {
+        if (!m_recordingStorage) {
+            return;
+        }
+        const OrphanScanner::Result scan = m_recordingStorage->getLastOrphanScan();
+        qDebug() << "Orphan scan:" << files.size() << "files," << scan.reclaimableBytes << "bytes reclaimable,"
+                 << scan.directoriesListed << "directories listed," << scan.directoriesSkipped << "unchanged,"
+                 << scan.elapsedMs << "ms";
+        emit orphanScanCompleted(files, scan.reclaimableBytes);
+    });
 }
 
 bool StorageManager::createTables() {
@@ -1229,7 +2238,8 @@ bool StorageManager::createTables() {
            createEnhancedTextsTable() &&
            createUserSessionsTable() &&
            createEnhancementProfilesTable() &&
-           createMetadataTable();
+           createMetadataTable() &&
+           createStatisticsTable();
 }
 
 bool StorageManager::createRecordingsTable() {
@@ -1247,6 +2257,9 @@ bool StorageManager::createRecordingsTable() {
             language TEXT NOT NULL DEFAULT 'en',
             device_name TEXT,
             status TEXT NOT NULL DEFAULT 'Completed',
+            codec TEXT NOT NULL DEFAULT 'pcm',
+            waveform_peaks BLOB,
+            segments TEXT,
             created_at DATETIME NOT NULL DEFAULT CURRENT_TIMESTAMP,
             updated_at DATETIME NOT NULL DEFAULT CURRENT_TIMESTAMP,
             FOREIGN KEY (session_id) REFERENCES user_sessions(id)
@@ -1258,6 +2271,18 @@ bool StorageManager::createRecordingsTable() {
         return false;
     }
     
+    // Columns added after the first release; existing rows are raw PCM without peaks or segments
+    const QSqlRecord columns = m_database.record("recordings");
+    if ((!columns.contains("codec") &&
+         !query.exec("ALTER TABLE recordings ADD COLUMN codec TEXT NOT NULL DEFAULT 'pcm'")) ||
+        (!columns.contains("waveform_peaks") &&
+         !query.exec("ALTER TABLE recordings ADD COLUMN waveform_peaks BLOB")) ||
+        (!columns.contains("segments") &&
+         !query.exec("ALTER TABLE recordings ADD COLUMN segments TEXT"))) {
+        setError(StorageError::TableCreationFailed, query.lastError().text());
+        return false;
+    }
+    
     return true;
 }
 
@@ -1273,7 +2298,7 @@ bool StorageManager::createTranscriptionsTable() {
             provider TEXT NOT NULL,
             language TEXT NOT NULL DEFAULT 'en',
             processing_time INTEGER NOT NULL DEFAULT 0,
-            word_timestamps TEXT,
+            word_timestamps BLOB,
             created_at DATETIME NOT NULL DEFAULT CURRENT_TIMESTAMP,
             status TEXT NOT NULL DEFAULT 'Completed',
             FOREIGN KEY (recording_id) REFERENCES recordings(id) ON DELETE CASCADE
@@ -1380,8 +2405,9 @@ bool StorageManager::createMetadataTable() {
         return false;
     }
     
-    // Insert initial schema version
-    query.prepare("INSERT OR REPLACE INTO metadata (key, value) VALUES (?, ?)");
+    // A new database is created at the current schema; an existing one keeps its
+    // version so migrateToVersion() can bring it up to date
+    query.prepare("INSERT OR IGNORE INTO metadata (key, value) VALUES (?, ?)");
     query.addBindValue("schema_version");
     query.addBindValue(QString::number(CURRENT_SCHEMA_VERSION));
     
@@ -1390,9 +2416,15 @@ bool StorageManager::createMetadataTable() {
 
 bool StorageManager::createIndexes() {
     QStringList indexQueries = {
-        "CREATE INDEX IF NOT EXISTS idx_recordings_session ON recordings(session_id)",
-        "CREATE INDEX IF NOT EXISTS idx_recordings_timestamp ON recordings(timestamp)",
+        // A session's history seeks on (timestamp, id) within the session; also serves session_id lookups
+        "DROP INDEX IF EXISTS idx_recordings_session",
+        "CREATE INDEX IF NOT EXISTS idx_recordings_session_timestamp_id ON recordings(session_id, timestamp, id)",
+        // Keyset pagination seeks on (sort key, id); these also serve plain timestamp lookups
+        "DROP INDEX IF EXISTS idx_recordings_timestamp",
+        "CREATE INDEX IF NOT EXISTS idx_recordings_timestamp_id ON recordings(timestamp, id)",
         "CREATE INDEX IF NOT EXISTS idx_transcriptions_recording ON transcriptions(recording_id)",
+        "CREATE INDEX IF NOT EXISTS idx_transcriptions_created_id ON transcriptions(created_at, id)",
+        "CREATE INDEX IF NOT EXISTS idx_user_sessions_started_id ON user_sessions(started_at, id)",
         "CREATE INDEX IF NOT EXISTS idx_enhanced_texts_transcription ON enhanced_texts(transcription_id)",
         "CREATE INDEX IF NOT EXISTS idx_user_sessions_status ON user_sessions(status)"
     };
@@ -1406,11 +2438,370 @@ bool StorageManager::createIndexes() {
     return true;
 }
 
+namespace {
+
+// A row that feeds the search index: %1 in the expressions is the row prefix
+// ("new.", "old." or a table alias)
+struct SearchSource {
+    const char* table;
+    const char* kind;
+    const char* body;
+    const char* transcriptionId;
+    const char* columns;        // Columns whose update changes the indexed row
+};
+
+const SearchSource SEARCH_SOURCES[] = {
+    {"transcriptions", "transcription", "%1text", "%1id", "text"},
+    {"enhanced_texts", "enhanced_text", "%1enhanced_text", "%1transcription_id", "enhanced_text, transcription_id"},
+    {"recordings", "recording", "coalesce(%1file_path, '') || ' ' || coalesce(%1device_name, '')", "NULL",
+     "file_path, device_name"},
+};
+
+QString rowExpression(const char* expression, const QString& prefix) {
+    return QString::fromLatin1(expression).replace("%1", prefix);
+}
+
+// Aggregates read by the status bar and dashboards. storage_stats keeps one running
+// value per metric so reading one costs the same however long the history is.
+struct StatsMetric {
+    const char* table;
+    const char* metric;
+    const char* value;          // Row's contribution, %1 is the row prefix
+    const char* columns;        // Columns whose update changes the contribution
+};
+
+const StatsMetric STATS_METRICS[] = {
+    {"recordings", "recordings.count", "1", ""},
+    {"recordings", "recordings.duration", "%1duration", "duration"},
+    {"recordings", "recordings.file_size", "%1file_size", "file_size"},
+    {"transcriptions", "transcriptions.count", "1", ""},
+    {"transcriptions", "transcriptions.confidence_sum", "max(%1confidence, 0)", "confidence"},
+    {"transcriptions", "transcriptions.confidence_rows", "%1confidence > 0", "confidence"},
+    {"transcriptions", "transcriptions.processing_time_sum", "max(%1processing_time, 0)", "processing_time"},
+    {"transcriptions", "transcriptions.processing_time_rows", "%1processing_time > 0", "processing_time"},
+    {"user_sessions", "user_sessions.count", "1", ""},
+    {"user_sessions", "user_sessions.duration_sum", "coalesce(%1total_duration, 0)", "total_duration"},
+};
+
+// Rebuilds every metric from its table
+QStringList statisticsRecomputeQueries() {
+    QStringList queries = {"DELETE FROM storage_stats"};
+    for (const StatsMetric& metric : STATS_METRICS) {
+        queries.append(QString("INSERT INTO storage_stats (metric, value) SELECT '%1', coalesce(SUM(%2), 0) FROM %3 s")
+                           .arg(metric.metric, rowExpression(metric.value, "s."), metric.table));
+    }
+    return queries;
+}
+
+// The tables STATS_METRICS draws on, each once
+QStringList statisticsTables() {
+    QStringList tables;
+    for (const StatsMetric& metric : STATS_METRICS) {
+        if (!tables.contains(metric.table)) {
+            tables.append(metric.table);
+        }
+    }
+    return tables;
+}
+
+// Names the backfill counting the rows of @p table that predate storage_stats
+QString statisticsBackfillName(const QString& table) {
+    return "stats_" + table;
+}
+
+// Highest rowid of @p table the counters include: the backfill's cursor while it runs
+QString statisticsCountedRows(const QString& table) {
+    return QString("coalesce((SELECT CAST(value AS INTEGER) FROM metadata WHERE key = '%1'), 9223372036854775807)")
+        .arg(MigrationRunner::cursorKey(statisticsBackfillName(table)));
+}
+
+} // namespace
+
+bool StorageManager::createSearchIndex() {
+    // One FTS5 index over every searchable text; search_documents maps its rowids
+    // (stable across VACUUM, unlike the implicit rowids of the source tables) to rows
+    QSqlQuery query(m_database);
+    const bool created = !m_database.tables().contains("search_documents");
+    
+    if (!m_database.transaction()) {
+        setError(StorageError::QueryFailed, "Failed to begin transaction");
+        return false;
+    }
+    if (!query.exec("CREATE VIRTUAL TABLE IF NOT EXISTS search_index USING fts5("
+                    "body, tokenize = 'unicode61 remove_diacritics 2', prefix = '2 3')")) {
+        qWarning() << "Full-text search unavailable, falling back to LIKE:" << query.lastError().text();
+        m_database.rollback();
+        return false;
+    }
+    if (!query.exec("CREATE TABLE IF NOT EXISTS search_documents ("
+                    "doc_id INTEGER PRIMARY KEY, "
+                    "kind TEXT NOT NULL, "
+                    "source_id TEXT NOT NULL, "
+                    "transcription_id TEXT, "
+                    "UNIQUE (kind, source_id))")) {
+        setError(StorageError::TableCreationFailed, query.lastError().text());
+        m_database.rollback();
+        return false;
+    }
+    
+    // The rows written before the index existed are indexed in the background. The
+    // cursors commit with the tables, so a run that stops short resumes next start.
+    if (created) {
+        for (const MigrationRunner::Backfill& backfill : searchIndexBackfills()) {
+            query.prepare("INSERT OR IGNORE INTO metadata (key, value) VALUES (?, '0')");
+            query.addBindValue(MigrationRunner::cursorKey(backfill));
+            if (!query.exec()) {
+                setError(StorageError::QueryFailed, "Cannot schedule the search index backfill: " +
+                                                        query.lastError().text());
+                m_database.rollback();
+                return false;
+            }
+        }
+    }
+    if (!m_database.commit()) {
+        setError(StorageError::QueryFailed, "Failed to commit transaction");
+        return false;
+    }
+    return true;
+}
+
+QList<MigrationRunner::Backfill> StorageManager::searchIndexBackfills() const {
+    QList<MigrationRunner::Backfill> backfills;
+    for (const SearchSource& source : SEARCH_SOURCES) {
+        const QString kind = QString::fromLatin1(source.kind);
+        const QString table = QString::fromLatin1(source.table);
+        MigrationRunner::Backfill backfill;
+        backfill.name = "search_" + table;
+        backfill.table = table;
+        backfill.columns = "id";
+        // Both read the row as the batch commits, so one the triggers indexed, changed
+        // or removed in the meantime ends up as it stands
+        backfill.updates = {
+            QString("INSERT OR IGNORE INTO search_documents (kind, source_id, transcription_id) "
+                    "SELECT '%1', s.id, %2 FROM %3 s WHERE s.rowid = ?")
+                .arg(kind, rowExpression(source.transcriptionId, "s."), table),
+            QString("INSERT OR REPLACE INTO search_index (rowid, body) "
+                    "SELECT d.doc_id, %1 FROM %2 s "
+                    "JOIN search_documents d ON d.kind = '%3' AND d.source_id = s.id WHERE s.rowid = ?")
+                .arg(rowExpression(source.body, "s."), table, kind),
+        };
+        backfill.rewrite = [](const QSqlQuery& row) -> std::optional<QVariantList> {
+            return QVariantList{row.value(0)};
+        };
+        backfills.append(backfill);
+    }
+    return backfills;
+}
+
 bool StorageManager::createTriggers() {
-    // Add triggers for automatic timestamp updates, etc.
+    if (!createStatisticsTriggers()) {
+        return false;
+    }
+    if (!m_fullTextSearch) {
+        return true;
+    }
+    
+    // Keep the search index in step with its source tables. The insert trigger
+    // clears any previous entry itself, so INSERT OR REPLACE works without
+    // recursive_triggers.
+    for (const SearchSource& source : SEARCH_SOURCES) {
+        const QString kind = QString::fromLatin1(source.kind);
+        const QString table = QString::fromLatin1(source.table);
+        const QString document = QString("(SELECT doc_id FROM search_documents WHERE kind = '%1' AND source_id = %2id)");
+        const QString remove = QString("DELETE FROM search_index WHERE rowid = %1; "
+                                       "DELETE FROM search_documents WHERE kind = '%2' AND source_id = %3id; ");
+        
+        const QStringList triggers = {
+            QString("CREATE TRIGGER IF NOT EXISTS %1_search_insert AFTER INSERT ON %1 BEGIN ").arg(table) +
+                remove.arg(document.arg(kind, "new."), kind, "new.") +
+                QString("INSERT INTO search_documents (kind, source_id, transcription_id) VALUES ('%1', new.id, %2); ")
+                    .arg(kind, rowExpression(source.transcriptionId, "new.")) +
+                QString("INSERT INTO search_index (rowid, body) VALUES (%1, %2); END")
+                    .arg(document.arg(kind, "new."), rowExpression(source.body, "new.")),
+            QString("CREATE TRIGGER IF NOT EXISTS %1_search_delete AFTER DELETE ON %1 BEGIN ").arg(table) +
+                remove.arg(document.arg(kind, "old."), kind, "old.") + "END",
+            QString("CREATE TRIGGER IF NOT EXISTS %1_search_update AFTER UPDATE OF %2 ON %1 BEGIN ")
+                    .arg(table, source.columns) +
+                QString("UPDATE search_index SET body = %1 WHERE rowid = %2; ")
+                    .arg(rowExpression(source.body, "new."), document.arg(kind, "new.")) +
+                QString("UPDATE search_documents SET transcription_id = %1 WHERE kind = '%2' AND source_id = new.id; END")
+                    .arg(rowExpression(source.transcriptionId, "new."), kind),
+        };
+        for (const QString& trigger : triggers) {
+            if (!executeSqlQuery(trigger)) {
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
+
+bool StorageManager::createStatisticsTable() {
+    QSqlQuery query(m_database);
+    const bool created = !m_database.tables().contains("storage_stats");
+    
+    if (!m_database.transaction()) {
+        setError(StorageError::QueryFailed, "Failed to begin transaction");
+        return false;
+    }
+    if (!query.exec("CREATE TABLE IF NOT EXISTS storage_stats ("
+                    "metric TEXT PRIMARY KEY, "
+                    "value NUMERIC NOT NULL DEFAULT 0)")) {
+        setError(StorageError::TableCreationFailed, query.lastError().text());
+        m_database.rollback();
+        return false;
+    }
+    
+    // Every metric starts at zero, and the rows written before the table existed are
+    // counted in the background; the cursors commit with the table
+    if (created) {
+        bool ok = true;
+        for (const StatsMetric& metric : STATS_METRICS) {
+            query.prepare("INSERT OR IGNORE INTO storage_stats (metric, value) VALUES (?, 0)");
+            query.addBindValue(QString::fromLatin1(metric.metric));
+            ok = ok && query.exec();
+        }
+        for (const MigrationRunner::Backfill& backfill : statisticsBackfills()) {
+            query.prepare("INSERT OR IGNORE INTO metadata (key, value) VALUES (?, '0')");
+            query.addBindValue(MigrationRunner::cursorKey(backfill));
+            ok = ok && query.exec();
+        }
+        if (!ok) {
+            setError(StorageError::QueryFailed, "Cannot schedule the statistics backfill: " + query.lastError().text());
+            m_database.rollback();
+            return false;
+        }
+    }
+    if (!m_database.commit()) {
+        setError(StorageError::QueryFailed, "Failed to commit transaction");
+        return false;
+    }
     return true;
 }
 
+QList<MigrationRunner::Backfill> StorageManager::statisticsBackfills() const {
+    QList<MigrationRunner::Backfill> backfills;
+    for (const QString& table : statisticsTables()) {
+        QStringList metrics;
+        QString contribution = "CASE storage_stats.metric";
+        for (const StatsMetric& metric : STATS_METRICS) {
+            if (table == metric.table) {
+                metrics.append(QString("'%1'").arg(metric.metric));
+                contribution += QString(" WHEN '%1' THEN %2").arg(metric.metric, rowExpression(metric.value, "s."));
+            }
+        }
+        contribution += " END";
+        
+        // Summed when the batch commits, the triggers leaving rows past the cursor alone
+        MigrationRunner::Backfill backfill;
+        backfill.name = statisticsBackfillName(table);
+        backfill.table = table;
+        backfill.columns = "id";
+        backfill.rangeUpdates = {
+            QString("UPDATE storage_stats SET value = value + "
+                    "coalesce((SELECT SUM(%1) FROM %2 s WHERE s.rowid > ? AND s.rowid <= ?), 0) "
+                    "WHERE metric IN (%3)")
+                .arg(contribution, table, metrics.join(", ")),
+        };
+        backfills.append(backfill);
+    }
+    return backfills;
+}
+
+bool StorageManager::createStatisticsTriggers() {
+    // One UPDATE per trigger adjusts every metric of the table. INSERT OR REPLACE
+    // does not fire the delete trigger without recursive_triggers, so the replaced
+    // row is subtracted before the insert instead. While the table's statistics
+    // backfill runs, rows past its cursor are left for it to count.
+    for (const QString& table : statisticsTables()) {
+        const QString counted = statisticsCountedRows(table);
+        QStringList metrics;
+        QStringList updatedMetrics;
+        QStringList columns;
+        QString added = "CASE metric";
+        QString removed = "CASE metric";
+        QString replaced = "CASE storage_stats.metric";
+        for (const StatsMetric& metric : STATS_METRICS) {
+            if (table != metric.table) {
+                continue;
+            }
+            const QString name = QString("'%1'").arg(metric.metric);
+            metrics.append(name);
+            added += QString(" WHEN %1 THEN %2").arg(name, rowExpression(metric.value, "new."));
+            removed += QString(" WHEN %1 THEN %2").arg(name, rowExpression(metric.value, "old."));
+            replaced += QString(" WHEN %1 THEN %2").arg(name, rowExpression(metric.value, "s."));
+            if (*metric.columns) {
+                updatedMetrics.append(name);
+                if (!columns.contains(metric.columns)) {
+                    columns.append(metric.columns);
+                }
+            }
+        }
+        added += " END";
+        removed += " END";
+        replaced += " END";
+        
+        const QString adjust = "UPDATE storage_stats SET value = value %1 WHERE metric IN (%2); END";
+        QStringList triggers = {
+            QString("CREATE TRIGGER IF NOT EXISTS %1_stats_replace BEFORE INSERT ON %1 BEGIN ").arg(table) +
+                adjust.arg(QString("- coalesce((SELECT %1 FROM %2 s WHERE s.id = new.id AND s.rowid <= %3), 0)")
+                               .arg(replaced, table, counted),
+                           metrics.join(", ")),
+            QString("CREATE TRIGGER IF NOT EXISTS %1_stats_insert AFTER INSERT ON %1 WHEN new.rowid <= %2 BEGIN ")
+                    .arg(table, counted) +
+                adjust.arg("+ " + added, metrics.join(", ")),
+            QString("CREATE TRIGGER IF NOT EXISTS %1_stats_delete AFTER DELETE ON %1 WHEN old.rowid <= %2 BEGIN ")
+                    .arg(table, counted) +
+                adjust.arg("- " + removed, metrics.join(", ")),
+        };
+        if (!columns.isEmpty()) {
+            triggers.append(QString("CREATE TRIGGER IF NOT EXISTS %1_stats_update AFTER UPDATE OF %2 ON %1 "
+                                    "WHEN old.rowid <= %3 BEGIN ")
+                                .arg(table, columns.join(", "), counted) +
+                            adjust.arg("+ " + added + " - " + removed, updatedMetrics.join(", ")));
+        }
+        for (const QString& trigger : triggers) {
+            if (!executeSqlQuery(trigger)) {
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
+
+bool StorageManager::recomputeStatistics() {
+    if (!isConnected()) {
+        setError(StorageError::DatabaseConnectionFailed, "Database not connected");
+        return false;
+    }
+    
+    // A backfill still counting would add its remaining rows on top of a rebuild
+    QSqlQuery pending(m_database);
+    if (pending.exec("SELECT 1 FROM metadata WHERE key LIKE 'backfill_stats_%' LIMIT 1") && pending.next()) {
+        return true;
+    }
+    
+    // Like migrations, on the main connection once queued writes are in; the
+    // writer waits on the lock until the rebuild commits
+    m_writer.waitForQueuedWrites();
+    return rebuildStatistics();
+}
+
+bool StorageManager::rebuildStatistics() {
+    QSqlQuery query(m_database);
+    m_database.transaction();
+    for (const QString& statement : statisticsRecomputeQueries()) {
+        if (!query.exec(statement)) {
+            setError(StorageError::QueryFailed, "Failed to recompute statistics: " + query.lastError().text());
+            m_database.rollback();
+            return false;
+        }
+    }
+    return m_database.commit();
+}
+
 bool StorageManager::updateSchemaVersion(int version) {
     QSqlQuery query(m_database);
     query.prepare("UPDATE metadata SET value = ?, updated_at = CURRENT_TIMESTAMP WHERE key = 'schema_version'");
@@ -1420,11 +2811,13 @@ bool StorageManager::updateSchemaVersion(int version) {
 }
 
 QStringList StorageManager::getSchemaUpdateQueries(int fromVersion, int toVersion) {
-    Q_UNUSED(fromVersion)
-    Q_UNUSED(toVersion)
-    
-    // Return migration queries based on version differences
-    return QStringList();
+    QStringList queries;
+    for (const SchemaMigration& migration : schemaMigrations()) {
+        if (migration.version > fromVersion && migration.version <= toVersion) {
+            queries += migration.schema;
+        }
+    }
+    return queries;
 }
 
 void StorageManager::setError(StorageError error, const QString& errorMessage) {
@@ -1499,5 +2892,20 @@ bool StorageManager::copyDatabaseFile(const QString& source, const QString& dest
 
 bool StorageManager::validateBackupFile(const QString& backupPath) const {
     QFileInfo fileInfo(backupPath);
-    return fileInfo.exists() && fileInfo.isReadable() && fileInfo.size() > 0;
+    if (!fileInfo.exists() || !fileInfo.isReadable() || fileInfo.size() == 0) {
+        return false;
+    }
+    
+    // Every SQLite database starts with this header string
+    QFile file(backupPath);
+    return file.open(QIODevice::ReadOnly) && file.read(16) == QByteArray("SQLite format 3\0", 16);
+}
+
+qint64 StorageManager::estimateBackupSize() const {
+    QSqlQuery query(m_database);
+    if (!query.exec("SELECT (page_count - freelist_count) * page_size "
+                    "FROM pragma_page_count, pragma_freelist_count, pragma_page_size") || !query.next()) {
+        return getDatabaseSize();
+    }
+    return query.value(0).toLongLong();
 }
@@ -6,6 +6,14 @@
 #include "../models/EnhancedText.h"
 #include "../models/UserSession.h"
 #include "../models/EnhancementProfile.h"
+#include "SqliteWriter.h"
+#include "SqliteBackup.h"
+#include "AsyncStorage.h"
+#include "ConnectionPool.h"
+#include "EntityCache.h"
+#include "OrphanScanner.h"
+#include "MigrationRunner.h"
+#include "PendingWrites.h"
 #include "../../specs/001-voice-to-text/contracts/storage-interface.h"
 #include <QObject>
 #include <QString>
@@ -25,7 +33,8 @@ class RecordingStorage : public IRecordingStorage {
     Q_OBJECT
 
 public:
-    explicit RecordingStorage(QSqlDatabase* database, QObject* parent = nullptr);
+    RecordingStorage(QSqlDatabase* database, SqliteWriter* writer, ConnectionPool* readers,
+                     QObject* parent = nullptr);
 
     // CRUD Operations
     QString saveRecording(const Recording& recording) override;
@@ -34,11 +43,22 @@ public:
     bool deleteRecording(const QString& id) override;
     bool recordingExists(const QString& id) const override;
 
+    // The writes above, reporting their outcome to @p done on this object's thread;
+    // queueUpdate() skips the existence check, which the caller has made
+    QString queueSave(const Recording& recording, SqliteWriter::Completion done);
+    void queueUpdate(const Recording& recording, SqliteWriter::Completion done);
+    void queueDelete(const QString& id, SqliteWriter::Completion done);
+
+    // Bulk Operations
+    QStringList saveRecordings(const QList<Recording>& recordings) override;
+    bool updateRecordings(const QList<Recording>& recordings) override;
+
     // Query Operations
     QList<Recording> getAllRecordings(const QueryOptions& options = {}) const override;
     QList<Recording> getRecordingsBySession(const QString& sessionId, const QueryOptions& options = {}) const override;
     QList<Recording> getRecordingsByDateRange(const QDateTime& start, const QDateTime& end) const override;
     QList<Recording> searchRecordings(const QString& searchTerm, const QueryOptions& options = {}) const override;
+    std::unique_ptr<StorageCursor<Recording>> openRecordingCursor(const PageRequest& request = {}) const override;
 
     // Statistics
     int getRecordingCount() const override;
@@ -49,17 +69,41 @@ public:
 
     // Maintenance
     bool cleanup() override;
-    bool vacuum() override;
+    bool vacuum() override;     // Queued to the writer; true once queued
     QStringList getOrphanedAudioFiles() const override;
 
+    // Search uses the FTS5 index when the SQLite build has it, LIKE otherwise
+    void setFullTextSearch(bool enabled) { m_fullTextSearch = enabled; }
+    EntityCacheStats cacheStats() const { return m_cache.stats(); }
+
+    // Where getOrphanedAudioFiles() looks; the scan is incremental after the first one
+    void setRecordingsDirectory(const QString& directory) { m_orphans.setRoot(directory); }
+    OrphanScanner::Result getLastOrphanScan() const { return m_orphans.lastResult(); }
+
 private:
-    QSqlDatabase* m_database;
-    mutable QMutex m_mutex;
+    QSqlDatabase* m_database;   // Maintenance only; reads use m_readers, writes m_writer
+    SqliteWriter* m_writer;
+    ConnectionPool* m_readers;
+    bool m_fullTextSearch;
+    mutable EntityCache<Recording> m_cache;     // getRecording() by id
+    mutable OrphanScanner m_orphans;
+    PendingWrites m_pending;                    // By recording id
+
+    void invalidateCached(const QStringList& ids);
+    static QStringList recordingFiles(const Recording& recording);
 
     QString buildWhereClause(const QueryOptions& options) const;
     QString buildOrderClause(const QueryOptions& options) const;
     Recording recordingFromQuery(const QSqlQuery& query) const;
     bool executeQuery(QSqlQuery& query) const;
+    bool rowExists(const QString& id) const;
+    quint64 queueWrite(const SqliteWriter::Statement& statement, std::function<void()> committed,
+                       SqliteWriter::Completion done = {});
+    static QVariant waveformPeaksToBlob(const WaveformPeaks& peaks);
+    static WaveformPeaks waveformPeaksFromColumn(const QVariant& value);
+    static QVariant segmentsToColumn(const Recording& recording); // JSON text, NULL when unsegmented
+    static QVariantList insertValues(const Recording& recording, const QDateTime& now);
+    static QVariantList updateValues(const Recording& recording, const QDateTime& now);
 };
 
 /**
@@ -69,7 +113,8 @@ class TranscriptionStorage : public ITranscriptionStorage {
     Q_OBJECT
 
 public:
-    explicit TranscriptionStorage(QSqlDatabase* database, QObject* parent = nullptr);
+    TranscriptionStorage(QSqlDatabase* database, SqliteWriter* writer, ConnectionPool* readers,
+                         QObject* parent = nullptr);
 
     // CRUD Operations
     QString saveTranscription(const Transcription& transcription) override;
@@ -78,23 +123,59 @@ public:
     bool deleteTranscription(const QString& id) override;
     bool transcriptionExists(const QString& id) const override;
 
+    // As for RecordingStorage::queueSave() and queueUpdate()
+    QString queueSave(const Transcription& transcription, SqliteWriter::Completion done);
+    void queueUpdate(const Transcription& transcription, SqliteWriter::Completion done);
+
+    // Bulk Operations
+    QStringList saveTranscriptions(const QList<Transcription>& transcriptions) override;
+    bool updateTranscriptions(const QList<Transcription>& transcriptions) override;
+
     // Query Operations
     QList<Transcription> getAllTranscriptions(const QueryOptions& options = {}) const override;
     Transcription getTranscriptionByRecording(const QString& recordingId) const override;
     QList<Transcription> searchTranscriptions(const QString& searchTerm, const QueryOptions& options = {}) const override;
     QList<Transcription> getTranscriptionsByProvider(const QString& provider) const override;
+    std::unique_ptr<StorageCursor<Transcription>> openTranscriptionCursor(const PageRequest& request = {}) const override;
+    QList<TranscriptionSearchHit> searchTranscriptionsRanked(const QString& searchTerm, int limit = 50,
+                                                             const QString& highlightOpen = "<b>",
+                                                             const QString& highlightClose = "</b>") const override;
 
     // Statistics
     int getTranscriptionCount() const override;
     double getAverageConfidence() const override;
     qint64 getAverageProcessingTime() const override;
 
+    void setFullTextSearch(bool enabled) { m_fullTextSearch = enabled; }
+    EntityCacheStats cacheStats() const;   // Both caches together
+
+    // Drops what was cached for a deleted recording
+    void invalidateRecording(const QString& recordingId);
+
 private:
-    QSqlDatabase* m_database;
-    mutable QMutex m_mutex;
+    QSqlDatabase* m_database;   // Maintenance only; reads use m_readers, writes m_writer
+    SqliteWriter* m_writer;
+    ConnectionPool* m_readers;
+    bool m_fullTextSearch;
+    mutable EntityCache<Transcription> m_cache;         // getTranscription() by id
+    mutable EntityCache<Transcription> m_byRecording;   // getTranscriptionByRecording() by recording id
+    PendingWrites m_pending;    // By transcription id, and by recordingKey() of its recording
+
+    void invalidateCached(const QStringList& ids);
 
     Transcription transcriptionFromQuery(const QSqlQuery& query) const;
     bool executeQuery(QSqlQuery& query) const;
+    bool rowExists(const QString& id) const;
+    quint64 queueWrite(const SqliteWriter::Statement& statement, std::function<void()> committed,
+                       SqliteWriter::Completion done = {});
+    static QString recordingKey(const QString& recordingId) { return "recording:" + recordingId; }
+    static QStringList writeKeys(const Transcription& transcription);
+    static QVariant wordTimingsToBlob(const WordTimingTable& timings);
+    static WordTimingTable wordTimingsFromColumn(const QVariant& value);
+    static QVariantList insertValues(const Transcription& transcription);
+    static QVariantList updateValues(const Transcription& transcription);
+
+    static constexpr int SNIPPET_TOKENS = 16;   // Words of context in a search snippet
 };
 
 /**
@@ -104,7 +185,8 @@ class EnhancedTextStorage : public IEnhancedTextStorage {
     Q_OBJECT
 
 public:
-    explicit EnhancedTextStorage(QSqlDatabase* database, QObject* parent = nullptr);
+    EnhancedTextStorage(QSqlDatabase* database, SqliteWriter* writer, ConnectionPool* readers,
+                        QObject* parent = nullptr);
 
     // CRUD Operations
     QString saveEnhancedText(const EnhancedText& enhancedText) override;
@@ -113,6 +195,12 @@ public:
     bool deleteEnhancedText(const QString& id) override;
     bool enhancedTextExists(const QString& id) const override;
 
+    // As for RecordingStorage::queueSave()
+    QString queueSave(const EnhancedText& enhancedText, SqliteWriter::Completion done);
+
+    // Bulk Operations
+    QStringList saveEnhancedTexts(const QList<EnhancedText>& enhancedTexts) override;
+
     // Query Operations
     QList<EnhancedText> getAllEnhancedTexts(const QueryOptions& options = {}) const override;
     QList<EnhancedText> getEnhancedTextsByTranscription(const QString& transcriptionId) const override;
@@ -125,11 +213,18 @@ public:
     double getAverageUserRating() const override;
 
 private:
-    QSqlDatabase* m_database;
-    mutable QMutex m_mutex;
+    QSqlDatabase* m_database;   // Maintenance only; reads use m_readers, writes m_writer
+    SqliteWriter* m_writer;
+    ConnectionPool* m_readers;
+    PendingWrites m_pending;    // By enhanced text id
 
     EnhancedText enhancedTextFromQuery(const QSqlQuery& query) const;
     bool executeQuery(QSqlQuery& query) const;
+    bool rowExists(const QString& id) const;
+    quint64 queueWrite(const SqliteWriter::Statement& statement, std::function<void()> committed,
+                       SqliteWriter::Completion done = {});
+    static QVariantList insertValues(const EnhancedText& enhancedText);
+    static QVariantList updateValues(const EnhancedText& enhancedText);
 };
 
 /**
@@ -139,7 +234,8 @@ class UserSessionStorage : public IUserSessionStorage {
     Q_OBJECT
 
 public:
-    explicit UserSessionStorage(QSqlDatabase* database, QObject* parent = nullptr);
+    UserSessionStorage(QSqlDatabase* database, SqliteWriter* writer, ConnectionPool* readers,
+                       QObject* parent = nullptr);
 
     // CRUD Operations
     QString saveUserSession(const UserSession& session) override;
@@ -158,6 +254,7 @@ public:
     QList<UserSession> getAllSessions(const QueryOptions& options = {}) const override;
     QList<UserSession> getSessionsByDateRange(const QDateTime& start, const QDateTime& end) const override;
     QList<UserSession> searchSessions(const QString& searchTerm, const QueryOptions& options = {}) const override;
+    std::unique_ptr<StorageCursor<UserSession>> openSessionCursor(const PageRequest& request = {}) const override;
 
     // Statistics
     int getSessionCount() const override;
@@ -165,11 +262,17 @@ public:
     int getAverageRecordingsPerSession() const override;
 
 private:
-    QSqlDatabase* m_database;
-    mutable QMutex m_mutex;
+    QSqlDatabase* m_database;   // Maintenance only; reads use m_readers, writes m_writer
+    SqliteWriter* m_writer;
+    ConnectionPool* m_readers;
+    PendingWrites m_pending;    // By session id
 
     UserSession userSessionFromQuery(const QSqlQuery& query) const;
     bool executeQuery(QSqlQuery& query) const;
+    bool rowExists(const QString& id) const;
+    quint64 queueWrite(const SqliteWriter::Statement& statement, std::function<void()> committed);
+    static QVariantList insertValues(const UserSession& session);
+    static QVariantList updateValues(const UserSession& session);
 };
 
 /**
@@ -211,6 +314,13 @@ private:
  * 
  * Provides comprehensive data persistence functionality with SQLite backend.
  * Manages database connections, transactions, and coordinates all storage operations.
+ *
+ * The database runs in WAL mode. Reads run on the calling thread's own connection
+ * from a ConnectionPool, so any thread can read and readers do not block each
+ * other; writes are queued to a SqliteWriter that group-commits them on its own
+ * thread, and the created/updated/deleted signals are emitted on the storage's
+ * thread once a write has committed. m_database is kept for schema setup and
+ * maintenance. Transactions hold their writes back and commit them as one write.
  */
 class StorageManager : public IStorageManager {
     Q_OBJECT
@@ -225,6 +335,8 @@ public:
     IEnhancedTextStorage* getEnhancedTextStorage() override;
     IUserSessionStorage* getUserSessionStorage() override;
     IEnhancementProfileStorage* getProfileStorage() override;
+    // QFuture versions of the calls above, for the GUI thread; null while closed
+    AsyncStorage* getAsyncStorage() { return m_asyncStorage; }
 
     // Database Management
     bool initialize(const QString& databasePath) override;
@@ -239,14 +351,19 @@ public:
 
     // Backup & Restore
     bool backupDatabase(const QString& backupPath) override;
+    bool startBackup(const QString& backupPath) override;
+    bool isBackupRunning() const override;
     bool restoreDatabase(const QString& backupPath) override;
     QStringList getAvailableBackups(const QString& backupDir) const override;
 
     // Database Maintenance
+    // Queued to the writer; true once queued, a failure is reported through errorOccurred
     bool vacuum() override;
     bool analyze() override;
     qint64 getDatabaseSize() const override;
     bool checkIntegrity() const override;
+    // Rebuilds storage_stats from the tables, should a counter ever drift
+    bool recomputeStatistics();
 
     // Migration
     int getCurrentSchemaVersion() const override;
@@ -263,14 +380,36 @@ public:
     bool changeEncryptionPassword(const QString& oldPassword, const QString& newPassword) override;
     bool isEncrypted() const override;
 
+    // Diagnostics: prepared-statement reuse on the read and write connections
+    StatementCache::Stats getReadStatementStats() const { return m_readers.statementStats(); }
+    StatementCache::Stats getWriteStatementStats() const { return m_writer.statementStats(); }
+
+    // Diagnostics: identity-map hits for getRecording() and the transcription lookups
+    EntityCacheStats getRecordingCacheStats() const;
+    EntityCacheStats getTranscriptionCacheStats() const;
+
+    // Commit times of the writer go to @p telemetry, which must outlive the manager
+    void setTelemetry(Telemetry* telemetry) { m_writer.setTelemetry(telemetry); }
+
+signals:
+    // After the maintenance scan for audio files no recording refers to
+    void orphanScanCompleted(const QStringList& orphanedFiles, qint64 reclaimableBytes);
+    // Backfill of migration @p version, by rowid; migrationProgress follows when it is done
+    void migrationBackfillProgress(int version, qint64 rowsDone, qint64 rowsTotal);
+
 private slots:
     void performMaintenance();
+    void reportBackupProgress();
 
 private:
     // Database components
     QSqlDatabase m_database;
+    SqliteWriter m_writer;
+    ConnectionPool m_readers;       // Per-thread read connections
+    MigrationRunner m_migrations;   // Backfills of migrated tables
     QString m_databasePath;
     bool m_isEncrypted;
+    bool m_fullTextSearch;      // FTS5 search index available
 
     // Storage implementations
     RecordingStorage* m_recordingStorage;
@@ -278,6 +417,7 @@ private:
     EnhancedTextStorage* m_enhancedTextStorage;
     UserSessionStorage* m_userSessionStorage;
     EnhancementProfileStorage* m_profileStorage;
+    AsyncStorage* m_asyncStorage;
 
     // State management
     StorageError m_lastError;
@@ -287,6 +427,9 @@ private:
 
     // Maintenance
     QTimer* m_maintenanceTimer;
+    SqliteBackup m_backup;
+    QTimer* m_backupProgressTimer;
+    qint64 m_backupBytesTotal;  // Estimated size of the running backup
 
     // Database setup and management
     bool createTables();
@@ -296,12 +439,19 @@ private:
     bool createUserSessionsTable();
     bool createEnhancementProfilesTable();
     bool createMetadataTable();
+    bool createStatisticsTable();
 
     // Schema management
     bool createIndexes();
+    bool createSearchIndex();
+    QList<MigrationRunner::Backfill> searchIndexBackfills() const; // Index rows that predate it
+    QList<MigrationRunner::Backfill> statisticsBackfills() const;  // Count rows that predate storage_stats
     bool createTriggers();
+    bool createStatisticsTriggers();
+    bool rebuildStatistics();
     bool updateSchemaVersion(int version);
     QStringList getSchemaUpdateQueries(int fromVersion, int toVersion);
+    void startBackfills();
 
     // Error handling
     void setError(StorageError error, const QString& errorMessage);
@@ -318,11 +468,14 @@ private:
     // Backup helpers
     bool copyDatabaseFile(const QString& source, const QString& destination);
     bool validateBackupFile(const QString& backupPath) const;
+    qint64 estimateBackupSize() const;
 
     // Constants
-    static constexpr int CURRENT_SCHEMA_VERSION = 1;
+    static constexpr int CURRENT_SCHEMA_VERSION = 2;
     static constexpr int MAINTENANCE_INTERVAL_MS = 3600000; // 1 hour
+    static constexpr int BACKUP_PROGRESS_INTERVAL_MS = 250;
     static constexpr const char* DATABASE_CONNECTION_NAME = "QuillScribeMain";
     static constexpr const char* BACKUP_FILE_EXTENSION = ".backup";
     static constexpr const char* METADATA_TABLE_NAME = "metadata";
+    static constexpr const char* RECORDINGS_DIRECTORY_NAME = "recordings";  // Next to the database
 };
@@ -0,0 +1,178 @@
+#include "Telemetry.h"
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QtAlgorithms>
+#include <cmath>
+#include <limits>
+
+const QString Telemetry::STAGE_CAPTURE = QStringLiteral("capture");
+const QString Telemetry::STAGE_WRITE = QStringLiteral("write");
+const QString Telemetry::STAGE_MEL = QStringLiteral("mel");
+const QString Telemetry::STAGE_ENCODE = QStringLiteral("encode");
+const QString Telemetry::STAGE_DECODE = QStringLiteral("decode");
+const QString Telemetry::STAGE_NETWORK = QStringLiteral("network");
+const QString Telemetry::STAGE_DB = QStringLiteral("db");
+const QString Telemetry::STAGE_MODEL_LOAD = QStringLiteral("model_load");
+const QString Telemetry::STAGE_STARTUP = QStringLiteral("startup");
+
+namespace {
+
+constexpr int HALF_SUB_BUCKETS = LatencyHistogram::SUB_BUCKETS / 2;
+constexpr int SUB_BUCKET_BITS = 6; // log2(SUB_BUCKETS)
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::record(qint64 value) {
+    value = qBound(qint64(0), value, MAX_VALUE);
+    ++m_buckets[bucketIndex(value)];
+    ++m_count;
+    m_min = qMin(m_min, value);
+    m_max = qMax(m_max, value);
+    m_sum += static_cast<double>(value);
+}
+
+void LatencyHistogram::reset() {
+    m_buckets.fill(0);
+    m_count = 0;
+    m_min = std::numeric_limits<qint64>::max();
+    m_max = 0;
+    m_sum = 0.0;
+}
+
+quint64 LatencyHistogram::count() const {
+    return m_count;
+}
+
+qint64 LatencyHistogram::min() const {
+    return m_count ? m_min : 0;
+}
+
+qint64 LatencyHistogram::max() const {
+    return m_max;
+}
+
+double LatencyHistogram::mean() const {
+    return m_count ? m_sum / static_cast<double>(m_count) : 0.0;
+}
+
+qint64 LatencyHistogram::percentile(double quantile) const {
+    if (m_count == 0) {
+        return 0;
+    }
+    const quint64 rank = qMax<quint64>(1, static_cast<quint64>(std::ceil(qBound(0.0, quantile, 1.0) * m_count)));
+    quint64 seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank) {
+            // The extremes are known exactly, so nothing is reported outside them
+            return qBound(m_min, bucketMidpoint(i), m_max);
+        }
+    }
+    return m_max;
+}
+
+QJsonObject LatencyHistogram::toJson() const {
+    QJsonObject json;
+    json["count"] = static_cast<double>(m_count);
+    json["min"] = min();
+    json["max"] = max();
+    json["mean"] = mean();
+    json["p50"] = percentile(0.50);
+    json["p95"] = percentile(0.95);
+    json["p99"] = percentile(0.99);
+    return json;
+}
+
+int LatencyHistogram::bucketIndex(qint64 value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<int>(value);
+    }
+    // Keep the top SUB_BUCKET_BITS bits; the shift picks the power of two
+    const int highestBit = 63 - qCountLeadingZeroBits(static_cast<quint64>(value));
+    const int shift = highestBit - (SUB_BUCKET_BITS - 1);
+    const int mantissa = static_cast<int>(value >> shift);
+    return SUB_BUCKETS + (shift - 1) * HALF_SUB_BUCKETS + (mantissa - HALF_SUB_BUCKETS);
+}
+
+qint64 LatencyHistogram::bucketMidpoint(int index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    const int shift = (index - SUB_BUCKETS) / HALF_SUB_BUCKETS + 1;
+    const qint64 mantissa = (index - SUB_BUCKETS) % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS;
+    return (mantissa << shift) + (qint64(1) << (shift - 1));
+}
+
+Telemetry::Telemetry()
+    : m_startedMs(QDateTime::currentMSecsSinceEpoch())
+{
+}
+
+void Telemetry::recordStage(const QString& stage, qint64 microseconds) {
+    QMutexLocker locker(&m_mutex);
+    m_stages[stage].record(microseconds);
+}
+
+void Telemetry::recordRealTimeFactor(const QString& model, qint64 processingMs, qint64 audioMs) {
+    if (audioMs <= 0 || processingMs < 0) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    m_realTimeFactors[model].record(processingMs * 1000 / audioMs);
+}
+
+LatencyHistogram Telemetry::stageHistogram(const QString& stage) const {
+    QMutexLocker locker(&m_mutex);
+    return m_stages.value(stage);
+}
+
+LatencyHistogram Telemetry::realTimeFactorHistogram(const QString& model) const {
+    QMutexLocker locker(&m_mutex);
+    return m_realTimeFactors.value(model);
+}
+
+void Telemetry::reset() {
+    QMutexLocker locker(&m_mutex);
+    m_stages.clear();
+    m_realTimeFactors.clear();
+    m_startedMs = QDateTime::currentMSecsSinceEpoch();
+}
+
+QJsonObject Telemetry::toJson() const {
+    QMutexLocker locker(&m_mutex);
+    QJsonObject stages;
+    for (auto it = m_stages.constBegin(); it != m_stages.constEnd(); ++it) {
+        stages[it.key()] = it.value().toJson();
+    }
+    QJsonObject realTimeFactors;
+    for (auto it = m_realTimeFactors.constBegin(); it != m_realTimeFactors.constEnd(); ++it) {
+        realTimeFactors[it.key()] = it.value().toJson();
+    }
+
+    QJsonObject json;
+    json["startedAt"] = QDateTime::fromMSecsSinceEpoch(m_startedMs).toString(Qt::ISODateWithMs);
+    json["exportedAt"] = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    json["stagesUs"] = stages;
+    json["realTimeFactorPermille"] = realTimeFactors;
+    return json;
+}
+
+bool Telemetry::exportJson(const QString& filePath, QString* errorMessage) const {
+    const QByteArray data = QJsonDocument(toJson()).toJson(QJsonDocument::Indented);
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        if (errorMessage) {
+            *errorMessage = "Cannot write telemetry to " + filePath + ": " + file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
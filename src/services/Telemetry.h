@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <array>
+
+/**
+ * @brief Fixed-memory latency histogram with percentile queries
+ *
+ * HDR-style log-linear buckets: values below SUB_BUCKETS get a bucket each, and every
+ * power of two above that is split into SUB_BUCKETS / 2 buckets, so a percentile is
+ * within about 3% of the recorded value no matter how many samples went in. Values
+ * are microseconds and anything past MAX_VALUE lands in the last bucket. Not
+ * thread-safe on its own; Telemetry and the services lock around it.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(qint64 value);
+    void reset();
+
+    quint64 count() const;
+    qint64 min() const;
+    qint64 max() const;
+    double mean() const;
+    // @p quantile in [0, 1]; 0 when nothing was recorded
+    qint64 percentile(double quantile) const;
+
+    QJsonObject toJson() const; // count, min, max, mean, p50, p95, p99
+
+    static constexpr int SUB_BUCKETS = 64;
+    static constexpr int MAX_VALUE_BITS = 36;                  // About 19 hours in microseconds
+    static constexpr qint64 MAX_VALUE = (qint64(1) << MAX_VALUE_BITS) - 1;
+    static constexpr int BUCKET_COUNT = SUB_BUCKETS + (MAX_VALUE_BITS - 6) * (SUB_BUCKETS / 2);
+
+private:
+    static int bucketIndex(qint64 value);
+    static qint64 bucketMidpoint(int index);
+
+    std::array<quint64, BUCKET_COUNT> m_buckets;
+    quint64 m_count;
+    qint64 m_min;
+    qint64 m_max;
+    double m_sum;
+};
+
+/**
+ * @brief Latency and throughput figures shared by the services
+ *
+ * One histogram per pipeline stage (capture, write, mel, encode, decode, network,
+ * db) and one real-time factor histogram per whisper model. Services get a pointer
+ * through setTelemetry() and record from whichever thread does the work; without
+ * one they record nothing. The registry only grows by the stage and model names in
+ * use, so its memory stays fixed however long the app runs.
+ */
+class Telemetry {
+public:
+    Telemetry();
+
+    void recordStage(const QString& stage, qint64 microseconds);
+    // Stored in thousandths, so 0.25x real time is 250
+    void recordRealTimeFactor(const QString& model, qint64 processingMs, qint64 audioMs);
+
+    LatencyHistogram stageHistogram(const QString& stage) const;
+    LatencyHistogram realTimeFactorHistogram(const QString& model) const;
+    void reset();
+
+    QJsonObject toJson() const;
+    // Written atomically, so a reader never sees half a file
+    bool exportJson(const QString& filePath, QString* errorMessage = nullptr) const;
+
+    static const QString STAGE_CAPTURE;  // Capture DSP per audio buffer
+    static const QString STAGE_WRITE;    // Recording file writes
+    static const QString STAGE_MEL;      // Up to the encoder: log-mel spectrogram
+    static const QString STAGE_ENCODE;   // Encoder pass, from calibration
+    static const QString STAGE_DECODE;   // Encoder and decoder after the spectrogram
+    static const QString STAGE_NETWORK;  // Enhancement API round trips
+    static const QString STAGE_DB;       // Storage writer commits
+    static const QString STAGE_MODEL_LOAD; // Whisper weights into memory
+    static const QString STAGE_STARTUP;  // Process start to the first event loop turn with the window up
+
+private:
+    mutable QMutex m_mutex;
+    QHash<QString, LatencyHistogram> m_stages;
+    QHash<QString, LatencyHistogram> m_realTimeFactors;
+    qint64 m_startedMs;
+};
@@ -0,0 +1,139 @@
+#include "TextAnalyzer.h"
+#include <QHash>
+#include <QTextBoundaryFinder>
+
+namespace {
+
+// Misspellings worth flagging, with their corrections
+const QHash<QString, QString>& knownMisspellings() {
+    static const QHash<QString, QString> misspellings = {
+        {"teh", "the"},
+        {"recieve", "receive"},
+        {"occured", "occurred"},
+        {"seperate", "separate"},
+        {"definately", "definitely"},
+    };
+    return misspellings;
+}
+
+bool isVowel(QChar c) {
+    switch (c.unicode()) {
+        case 'a': case 'e': case 'i': case 'o': case 'u': case 'y':
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+TextAnalysis TextAnalyzer::analyze(const QString& text) {
+    TextAnalysis analysis;
+    analysis.characterCount = static_cast<int>(text.size());
+    if (text.isEmpty()) {
+        return analysis;
+    }
+
+    // Word boundaries cut the text into words, runs of spaces and single punctuation
+    // marks; the last two are the gaps between words
+    QTextBoundaryFinder finder(QTextBoundaryFinder::Word, text);
+    qsizetype start = 0;
+    int sentenceWords = 0;
+    int newlines = 0;
+    bool inParagraph = false;
+    bool plainGap = false;  // Only spaces since the previous word
+    QString previous;       // Lower case; empty when not directly followed by the current word
+
+    while (finder.toNextBoundary() != -1) {
+        const QStringView segment = QStringView(text).mid(start, finder.position() - start);
+        start = finder.position();
+        if (segment.isEmpty()) {
+            continue;
+        }
+
+        if (!segment.front().isLetterOrNumber()) {
+            for (const QChar c : segment) {
+                if (c == '.' || c == '!' || c == '?') {
+                    ++analysis.sentenceCount;
+                    analysis.longSentenceCount += sentenceWords > LONG_SENTENCE_WORDS ? 1 : 0;
+                    sentenceWords = 0;
+                    plainGap = false;
+                } else if (c == '\n') {
+                    // A blank line ends the paragraph
+                    if (++newlines >= 2) {
+                        inParagraph = false;
+                    }
+                } else if (!c.isSpace()) {
+                    plainGap = false;
+                }
+            }
+            continue;
+        }
+
+        bool hasLetter = false;
+        for (const QChar c : segment) {
+            if (c.isLetter()) {
+                hasLetter = true;
+                break;
+            }
+        }
+        const QString word = hasLetter ? segment.toString().toLower() : QString();
+        if (hasLetter) {
+            ++analysis.wordCount;
+            ++sentenceWords;
+            analysis.syllableCount += countSyllables(word);
+            if (!inParagraph) {
+                inParagraph = true;
+                ++analysis.paragraphCount;
+            }
+
+            if (knownMisspellings().contains(word) && !analysis.misspellings.contains(word)) {
+                analysis.misspellings.append(word);
+            }
+            if (plainGap && word == QLatin1String("own") &&
+                (previous == QLatin1String("it's") || previous == QStringView(u"it\u2019s"))) {
+                analysis.itsOwnMisuse = true;
+            }
+            if (plainGap && (previous == QLatin1String("was") || previous == QLatin1String("were")) &&
+                word.size() > 2 && word.endsWith(QLatin1String("ed"))) {
+                analysis.passiveVoice = true;
+            }
+        }
+
+        previous = word;
+        plainGap = true;
+        newlines = 0;
+    }
+
+    // Text after the last full stop is a sentence for length purposes, too
+    analysis.longSentenceCount += sentenceWords > LONG_SENTENCE_WORDS ? 1 : 0;
+    return analysis;
+}
+
+double TextAnalyzer::readingEase(const TextAnalysis& analysis) {
+    if (analysis.wordCount == 0) {
+        return 100.0;
+    }
+    const double wordsPerSentence = static_cast<double>(analysis.wordCount) / qMax(1, analysis.sentenceCount);
+    const double syllablesPerWord = static_cast<double>(analysis.syllableCount) / analysis.wordCount;
+    return qBound(0.0, 206.835 - 1.015 * wordsPerSentence - 84.6 * syllablesPerWord, 100.0);
+}
+
+QString TextAnalyzer::correctionFor(const QString& misspelling) {
+    return knownMisspellings().value(misspelling);
+}
+
+int TextAnalyzer::countSyllables(QStringView word) {
+    int syllables = 0;
+    bool inVowelGroup = false;
+    for (const QChar c : word) {
+        const bool vowel = isVowel(c);
+        syllables += vowel && !inVowelGroup ? 1 : 0;
+        inVowelGroup = vowel;
+    }
+    // A final silent e ("make") is not a syllable of its own
+    if (syllables > 1 && word.endsWith(u'e') && !word.endsWith(u"le")) {
+        --syllables;
+    }
+    return qMax(1, syllables);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Everything the quality heuristics need from a text, gathered in one pass
+ *
+ * Words are found once with a word boundary finder. Sentence ends, paragraph breaks
+ * and the few patterns the issue checks look for are picked up in the same walk, by
+ * comparing each word with its neighbours. Nothing is split into temporary lists
+ * and no regular expression is built per call.
+ */
+struct TextAnalysis {
+    int characterCount = 0;
+    int wordCount = 0;          // Words holding at least one letter
+    int sentenceCount = 0;      // Sentence-ending punctuation marks
+    int paragraphCount = 0;
+    int syllableCount = 0;      // Vowel groups, for the reading ease score
+    int longSentenceCount = 0;  // Sentences past TextAnalyzer::LONG_SENTENCE_WORDS
+    QStringList misspellings;   // Distinct known misspellings, lower case, in order of appearance
+    bool itsOwnMisuse = false;  // "it's own"
+    bool passiveVoice = false;  // "was/were ...ed"
+};
+
+class TextAnalyzer {
+public:
+    static TextAnalysis analyze(const QString& text);
+
+    // Flesch reading ease, 0 (hard) to 100 (easy)
+    static double readingEase(const TextAnalysis& analysis);
+
+    // The correction for a misspelling in TextAnalysis::misspellings
+    static QString correctionFor(const QString& misspelling);
+
+    static constexpr int LONG_SENTENCE_WORDS = 25;
+
+private:
+    static int countSyllables(QStringView word);
+};
@@ -0,0 +1,164 @@
+#include "TextChunker.h"
+#include <QRegularExpression>
+#include <QTextBoundaryFinder>
+
+namespace {
+
+// Length of @p text without its trailing whitespace
+qsizetype trimmedEnd(const QString& text) {
+    qsizetype end = text.size();
+    while (end > 0 && text.at(end - 1).isSpace()) {
+        --end;
+    }
+    return end;
+}
+
+} // namespace
+
+QList<TextChunker::Chunk> TextChunker::split(const QString& text, int targetLength, int maxLength, int contextLength) {
+    maxLength = qMax(1, maxLength);
+    targetLength = qBound(1, targetLength, maxLength);
+
+    // A blank line, possibly holding spaces, separates paragraphs
+    static const QRegularExpression paragraphBreak("\\n[ \\t]*\\n\\s*");
+
+    QList<Unit> units;
+    QString separator;
+    qsizetype position = 0;
+    QRegularExpressionMatchIterator it = paragraphBreak.globalMatch(text);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch match = it.next();
+        appendParagraph(units, separator, text.mid(position, match.capturedStart() - position), targetLength, maxLength);
+        separator = match.captured();
+        position = match.capturedEnd();
+    }
+    appendParagraph(units, separator, text.mid(position), targetLength, maxLength);
+
+    // Greedy packing; a unit never exceeds maxLength, so neither does a chunk
+    QList<Chunk> chunks;
+    Chunk current;
+    for (const Unit& unit : std::as_const(units)) {
+        if (!current.text.isEmpty() &&
+            current.text.size() + unit.separator.size() + unit.text.size() > targetLength) {
+            chunks.append(current);
+            current = Chunk();
+        }
+        if (current.text.isEmpty()) {
+            current.separator = unit.separator;
+            current.text = unit.text;
+        } else {
+            current.text += unit.separator + unit.text;
+        }
+    }
+    if (!current.text.isEmpty()) {
+        chunks.append(current);
+    }
+
+    for (qsizetype i = 1; i < chunks.size(); ++i) {
+        chunks[i].context = tailContext(chunks.at(i - 1).text, contextLength);
+    }
+    return chunks;
+}
+
+QString TextChunker::join(const QList<Chunk>& chunks, const QStringList& texts) {
+    QString joined;
+    for (qsizetype i = 0; i < chunks.size() && i < texts.size(); ++i) {
+        if (i > 0) {
+            joined += chunks.at(i).separator;
+        }
+        joined += texts.at(i);
+    }
+    return joined;
+}
+
+void TextChunker::appendParagraph(QList<Unit>& units, const QString& separator, const QString& paragraph,
+                                  int targetLength, int maxLength) {
+    if (paragraph.trimmed().isEmpty()) {
+        return;
+    }
+    if (paragraph.size() <= targetLength) {
+        units.append({separator, paragraph});
+        return;
+    }
+
+    // Whitespace after a sentence becomes the separator before the next one
+    QTextBoundaryFinder finder(QTextBoundaryFinder::Sentence, paragraph);
+    QString pendingSeparator = separator;
+    qsizetype start = 0;
+    while (finder.toNextBoundary() != -1) {
+        const QString sentence = paragraph.mid(start, finder.position() - start);
+        start = finder.position();
+        const qsizetype end = trimmedEnd(sentence);
+        if (end == 0) {
+            pendingSeparator += sentence;
+            continue;
+        }
+        appendSentence(units, pendingSeparator, sentence.left(end), maxLength);
+        pendingSeparator = sentence.mid(end);
+    }
+}
+
+void TextChunker::appendSentence(QList<Unit>& units, const QString& separator, const QString& sentence, int maxLength) {
+    if (sentence.size() <= maxLength) {
+        units.append({separator, sentence});
+        return;
+    }
+
+    // A run-on sentence (or a transcript without punctuation) is cut between words
+    QTextBoundaryFinder finder(QTextBoundaryFinder::Word, sentence);
+    QString pendingSeparator = separator;
+    qsizetype start = 0;
+    while (start < sentence.size()) {
+        qsizetype end = qMin<qsizetype>(start + maxLength, sentence.size());
+        if (end < sentence.size()) {
+            finder.setPosition(end);
+            if (!finder.isAtBoundary()) {
+                finder.toPreviousBoundary();
+            }
+            if (finder.position() > start) {
+                end = finder.position();
+            } else if (sentence.at(end).isLowSurrogate() && sentence.at(end - 1).isHighSurrogate()) {
+                // One word longer than the limit: cut between characters, not inside one;
+                // a limit of a single unit keeps the pair whole instead
+                end += end - 1 > start ? -1 : 1;
+            }
+        }
+
+        const QString piece = sentence.mid(start, end - start);
+        start = end;
+        const qsizetype pieceEnd = trimmedEnd(piece);
+        qsizetype pieceStart = 0;
+        while (pieceStart < pieceEnd && piece.at(pieceStart).isSpace()) {
+            ++pieceStart;
+        }
+        pendingSeparator += piece.left(pieceStart);
+        if (pieceEnd > pieceStart) {
+            units.append({pendingSeparator, piece.mid(pieceStart, pieceEnd - pieceStart)});
+            pendingSeparator = piece.mid(pieceEnd);
+        }
+    }
+}
+
+QString TextChunker::tailContext(const QString& text, int contextLength) {
+    if (contextLength <= 0) {
+        return QString();
+    }
+    if (text.size() <= contextLength) {
+        return text;
+    }
+
+    // The last whole sentences that fit; part of one sentence when none does
+    QTextBoundaryFinder finder(QTextBoundaryFinder::Sentence, text);
+    finder.setPosition(text.size());
+    qsizetype start = text.size();
+    while (finder.toPreviousBoundary() != -1 && text.size() - finder.position() <= contextLength) {
+        start = finder.position();
+    }
+    if (start == text.size()) {
+        start = text.size() - contextLength;
+        if (text.at(start).isLowSurrogate()) {
+            ++start;
+        }
+    }
+    return text.mid(start).trimmed();
+}
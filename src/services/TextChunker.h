@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Splits long text into enhancement-sized chunks and joins the results
+ *
+ * Chunks end on paragraph breaks where one fits, otherwise on sentence ends, and
+ * only fall back to word boundaries for a single sentence longer than the maximum.
+ * Each chunk carries the whitespace that separated it from the previous one, so
+ * join() restores the original paragraph structure around the rewritten text, and
+ * the closing sentences of the previous chunk as context for the model.
+ */
+class TextChunker {
+public:
+    struct Chunk {
+        QString text;
+        QString separator; // Whitespace between the previous chunk and this one
+        QString context;   // End of the previous chunk; empty for the first
+    };
+
+    // Chunks of about @p targetLength characters and never more than @p maxLength
+    static QList<Chunk> split(const QString& text, int targetLength, int maxLength, int contextLength);
+
+    // @p texts holds one (rewritten) text per chunk, in order
+    static QString join(const QList<Chunk>& chunks, const QStringList& texts);
+
+private:
+    struct Unit {
+        QString separator;
+        QString text;
+    };
+
+    static void appendParagraph(QList<Unit>& units, const QString& separator, const QString& paragraph,
+                                int targetLength, int maxLength);
+    static void appendSentence(QList<Unit>& units, const QString& separator, const QString& sentence, int maxLength);
+    static QString tailContext(const QString& text, int contextLength);
+};
@@ -6,34 +6,37 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QStandardPaths>
-#include <QRegularExpression>
-#include <QTextBoundaryFinder>
-#include <QCryptographicHash>
 #include <QDateTime>
+#include <QFileInfo>
 #include <QUuid>
 #include <QtMath>
 #include <algorithm>
+#include <chrono>
+#include <limits>
+#if QT_CONFIG(ssl)
+#include <QSslConfiguration>
+#endif
 
 TextEnhancementService::TextEnhancementService(QObject* parent)
     : ITextEnhancementService(parent)
     , m_networkManager(new QNetworkAccessManager(this))
     , m_timeoutTimer(new QTimer(this))
     , m_cleanupTimer(new QTimer(this))
+    , m_dispatchTimer(new QTimer(this))
     , m_settings(new QSettings(this))
     , m_currentProvider(EnhancementProvider::GeminiPro)
     , m_timeoutMs(DEFAULT_TIMEOUT_MS)
     , m_maxConcurrentRequests(DEFAULT_MAX_CONCURRENT)
     , m_cachingEnabled(true)
+    , m_streamingEnabled(true)
     , m_isOnline(true)
+    , m_preferLocal(true)
     , m_requestCounter(0)
-    , m_maxCacheSize(MAX_CACHE_SIZE_MB * 1024 * 1024)
-    , m_cacheExpiryHours(CACHE_EXPIRY_HOURS)
+    , m_telemetry(nullptr)
+    , m_localEngine(QSharedPointer<LocalLlmEngine>::create())
+    , m_localPool(new QThreadPool(this))
     , m_lastError(EnhancementError::NoError)
 {
-    // Setup network manager
-    connect(m_networkManager, &QNetworkAccessManager::finished,
-            this, &TextEnhancementService::handleNetworkReplyFinished);
-
     // Setup timeout timer
     m_timeoutTimer->setSingleShot(true);
     connect(m_timeoutTimer, &QTimer::timeout, this, &TextEnhancementService::handleTimeout);
@@ -43,19 +46,33 @@ TextEnhancementService::TextEnhancementService(QObject* parent)
     connect(m_cleanupTimer, &QTimer::timeout, this, &TextEnhancementService::cleanupCompletedRequests);
     m_cleanupTimer->start();
 
+    // Setup dispatch timer, for requests held back by the quota
+    m_dispatchTimer->setSingleShot(true);
+    connect(m_dispatchTimer, &QTimer::timeout, this, &TextEnhancementService::processNextPendingRequest);
+    m_rateLimiter.setConcurrencyBounds(INITIAL_CONCURRENT, m_maxConcurrentRequests);
+
+    // One local generation at a time until a shared pool is set; each uses several threads
+    m_localPool->setMaxThreadCount(1);
+
     // Load settings and initialize
     loadSettings();
     initializeDefaultSettings();
+    setPersistentCacheEnabled(m_settings->value("persistentCache", true).toBool());
+    warmUpConnection();
 
     qDebug() << "TextEnhancementService initialized with provider:" << static_cast<int>(m_currentProvider);
 }
 
 TextEnhancementService::~TextEnhancementService() {
-    // Cancel all active requests
+    // Cancel all active requests; disconnected first, abort() finishes them synchronously
     QMutexLocker locker(&m_requestsMutex);
     for (auto it = m_activeRequests.begin(); it != m_activeRequests.end(); ++it) {
-        if (it.value().networkReply) {
-            it.value().networkReply->abort();
+        if (QNetworkReply* reply = it.value().networkReply) {
+            reply->disconnect(this);
+            reply->abort();
+        }
+        if (it->abortFlag) {
+            it->abortFlag->storeRelaxed(1);
         }
     }
     m_activeRequests.clear();
@@ -64,10 +81,14 @@ TextEnhancementService::~TextEnhancementService() {
 }
 
 QList<EnhancementProvider> TextEnhancementService::getAvailableProviders() const {
-    return {
+    QList<EnhancementProvider> providers = {
         EnhancementProvider::GeminiPro,
         EnhancementProvider::GeminiFlash
     };
+    if (LocalLlmEngine::isCompiledIn()) {
+        providers.append(EnhancementProvider::LocalLLM);
+    }
+    return providers;
 }
 
 bool TextEnhancementService::setProvider(EnhancementProvider provider) {
@@ -76,7 +97,12 @@ bool TextEnhancementService::setProvider(EnhancementProvider provider) {
         return false;
     }
 
-    if (m_apiKey.isEmpty()) {
+    if (provider == EnhancementProvider::LocalLLM) {
+        if (!m_localEngine->isLoaded()) {
+            setError(EnhancementError::ServiceUnavailable, "No local model loaded");
+            return false;
+        }
+    } else if (m_apiKey.isEmpty()) {
         setError(EnhancementError::InvalidApiKey, "API key not configured");
         return false;
     }
@@ -91,6 +117,9 @@ EnhancementProvider TextEnhancementService::getCurrentProvider() const {
 }
 
 bool TextEnhancementService::isProviderAvailable(EnhancementProvider provider) const {
+    if (provider == EnhancementProvider::LocalLLM) {
+        return m_localEngine->isLoaded();
+    }
     return getAvailableProviders().contains(provider) && !m_apiKey.isEmpty() && m_isOnline;
 }
 
@@ -177,7 +206,7 @@ QString TextEnhancementService::submitEnhancement(const EnhancementRequest& requ
     }
 
     if (isTextTooLong(request.text)) {
-        setError(EnhancementError::TextTooLong, "Text exceeds maximum length");
+        setError(EnhancementError::TextTooLong, "Text exceeds maximum length, even in chunks");
         return QString();
     }
 
@@ -186,17 +215,18 @@ QString TextEnhancementService::submitEnhancement(const EnhancementRequest& requ
         return QString();
     }
 
-    if (!isProviderAvailable(request.preferredProvider)) {
+    // Offline, grammar and formalization still have the local model (FR-008)
+    if (!isProviderAvailable(request.preferredProvider) && !canRunLocally(request)) {
         setError(EnhancementError::ServiceUnavailable, "Enhancement provider not available");
         return QString();
     }
 
     // Check cache first if caching is enabled
+    const QByteArray cacheKey = m_cachingEnabled ? generateCacheKey(request) : QByteArray();
     if (m_cachingEnabled) {
-        QString cacheKey = generateCacheKey(request);
-        if (isRequestCached(cacheKey)) {
+        EnhancementResult cachedResult;
+        if (m_cache.lookup(cacheKey, cachedResult)) {
             QString requestId = generateRequestId();
-            EnhancementResult cachedResult = getCachedResult(cacheKey);
             cachedResult.id = requestId; // Update ID for this request
             
             // Create request info for cached result
@@ -221,8 +251,97 @@ QString TextEnhancementService::submitEnhancement(const EnhancementRequest& requ
 
             return requestId;
         }
+
+        // Not cached yet, but maybe already on its way (a double click, a repeated batch item)
+        const QString followerId = attachToInFlight(cacheKey, request);
+        if (!followerId.isEmpty()) {
+            return followerId;
+        }
     }
 
+    const QString requestId = needsChunking(request.text) ? submitChunkedEnhancement(request)
+                                                          : enqueueRequest(request, QString(), -1, QString());
+    if (m_cachingEnabled && !requestId.isEmpty()) {
+        // Replies are handled on this thread, so the request cannot have finished yet
+        QMutexLocker locker(&m_requestsMutex);
+        auto it = m_activeRequests.find(requestId);
+        if (it != m_activeRequests.end()) {
+            it->flightKey = cacheKey;
+            m_inFlight.insert(cacheKey, requestId);
+        }
+    }
+    return requestId;
+}
+
+QString TextEnhancementService::attachToInFlight(const QByteArray& cacheKey, const EnhancementRequest& request) {
+    QMutexLocker locker(&m_requestsMutex);
+    auto leader = m_activeRequests.find(m_inFlight.value(cacheKey));
+    if (leader == m_activeRequests.end()) {
+        return QString();
+    }
+
+    // The follower never queues or goes to the network; the leader reports to it
+    const QString requestId = generateRequestId();
+    RequestInfo info;
+    info.request = request;
+    info.status = EnhancementStatus::Pending;
+    info.hasResult = false;
+    info.networkReply = nullptr;
+    info.retryCount = 0;
+    info.leaderId = leader.key();
+    info.timer.start();
+    leader->followers.append(requestId);
+
+    if (leader->status == EnhancementStatus::Processing) {
+        const EnhancementProvider provider = leader->provider;
+        QMetaObject::invokeMethod(this, [this, requestId, provider]() {
+            emit enhancementStarted(requestId, provider);
+        }, Qt::QueuedConnection);
+    }
+    m_activeRequests[requestId] = info;
+    return requestId;
+}
+
+QStringList TextEnhancementService::subscribersLocked(const QString& requestId) const {
+    const auto it = m_activeRequests.constFind(requestId);
+    if (it == m_activeRequests.cend()) {
+        return QStringList();
+    }
+    QStringList subscribers = it->followers;
+    if (!it->detached) {
+        subscribers.prepend(requestId);
+    }
+    return subscribers;
+}
+
+QStringList TextEnhancementService::releaseFollowersLocked(const QString& requestId, EnhancementStatus status,
+                                                           const EnhancementResult* result) {
+    const QStringList subscribers = subscribersLocked(requestId);
+    auto it = m_activeRequests.find(requestId);
+    if (it == m_activeRequests.end()) {
+        return subscribers;
+    }
+    if (!it->flightKey.isEmpty() && m_inFlight.value(it->flightKey) == requestId) {
+        m_inFlight.remove(it->flightKey);
+    }
+    for (const QString& followerId : std::as_const(it->followers)) {
+        auto follower = m_activeRequests.find(followerId);
+        if (follower == m_activeRequests.end()) {
+            continue;
+        }
+        follower->status = status;
+        if (result) {
+            follower->result = *result;
+            follower->result.id = followerId;
+            follower->hasResult = true;
+        }
+    }
+    it->followers.clear();
+    return subscribers;
+}
+
+QString TextEnhancementService::enqueueRequest(const EnhancementRequest& request, const QString& parentId,
+                                               int chunkIndex, const QString& context) {
     // Generate request ID and create request info
     QString requestId = generateRequestId();
     RequestInfo info;
@@ -231,60 +350,262 @@ QString TextEnhancementService::submitEnhancement(const EnhancementRequest& requ
     info.hasResult = false;
     info.networkReply = nullptr;
     info.retryCount = 0;
+    info.parentId = parentId;
+    info.chunkIndex = chunkIndex;
+    info.context = context;
     info.timer.start();
 
+    QMutexLocker locker(&m_requestsMutex);
+    m_activeRequests[requestId] = info;
+    m_pendingRequests.enqueue(requestId);
+    dispatchPendingLocked();
+
+    return requestId;
+}
+
+QString TextEnhancementService::submitChunkedEnhancement(const EnhancementRequest& request) {
+    const QList<TextChunker::Chunk> chunks =
+        TextChunker::split(request.text, CHUNK_TARGET_LENGTH, MAX_TEXT_LENGTH, CHUNK_CONTEXT_LENGTH);
+
+    // The parent never goes to the network; its chunks do, as ordinary requests
+    // sharing the concurrency limit, and it completes once the last one is back
+    const QString requestId = generateRequestId();
+    RequestInfo parent;
+    parent.request = request;
+    parent.status = EnhancementStatus::Processing;
+    parent.hasResult = false;
+    parent.networkReply = nullptr;
+    parent.retryCount = 0;
+    parent.provider = chooseProvider(request);
+    parent.chunks = chunks;
+    parent.chunkTexts = QStringList(chunks.size(), QString()); // Null until the chunk is back
+    parent.timer.start();
     {
         QMutexLocker locker(&m_requestsMutex);
-        m_activeRequests[requestId] = info;
+        m_activeRequests[requestId] = parent;
+    }
 
-        // Check if we can process immediately or need to queue
-        int activeCount = 0;
-        for (const auto& req : m_activeRequests) {
-            if (req.status == EnhancementStatus::Processing) {
-                activeCount++;
-            }
+    QStringList chunkIds;
+    bool allCached = true;
+    for (qsizetype i = 0; i < chunks.size(); ++i) {
+        EnhancementRequest chunkRequest = request;
+        chunkRequest.text = chunks.at(i).text;
+        if (request.settings.mode == EnhancementMode::Summarization) {
+            // Each chunk gets its share of the summary's length
+            chunkRequest.settings.maxOutputLength = qMax(MIN_CHUNK_OUTPUT_LENGTH, static_cast<int>(
+                request.settings.maxOutputLength * chunkRequest.text.size() / request.text.size()));
         }
 
-        if (activeCount < m_maxConcurrentRequests) {
-            processEnhancementRequest(requestId);
-        } else {
-            m_pendingRequests.enqueue(requestId);
+        EnhancementResult cachedResult;
+        if (m_cachingEnabled && m_cache.lookup(generateCacheKey(chunkRequest, chunks.at(i).context), cachedResult)) {
+            QMutexLocker locker(&m_requestsMutex);
+            RequestInfo& info = m_activeRequests[requestId];
+            info.chunkTexts[i] = cachedResult.enhancedText;
+            ++info.chunksDone;
+            continue;
         }
+        allCached = false;
+        chunkIds.append(enqueueRequest(chunkRequest, requestId, static_cast<int>(i), chunks.at(i).context));
+    }
+
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        m_activeRequests[requestId].chunkIds = chunkIds;
     }
 
+    const EnhancementProvider provider = parent.provider;
+    QTimer::singleShot(0, this, [this, requestId, provider, allCached]() {
+        emit enhancementStarted(requestId, provider);
+        if (allCached) {
+            finishChunkedRequest(requestId);
+        }
+    });
     return requestId;
 }
 
+void TextEnhancementService::completeChunk(const QString& parentId, int chunkIndex, const QString& enhancedText) {
+    QString partialText;
+    int progressPercent = 0;
+    bool finished = false;
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        auto it = m_activeRequests.find(parentId);
+        if (it == m_activeRequests.end() || it->status != EnhancementStatus::Processing ||
+            chunkIndex < 0 || chunkIndex >= it->chunkTexts.size()) {
+            return;
+        }
+        RequestInfo& parent = it.value();
+        if (parent.chunkTexts.at(chunkIndex).isNull()) {
+            parent.chunkTexts[chunkIndex] = enhancedText.isNull() ? QString("") : enhancedText;
+            ++parent.chunksDone;
+        }
+        finished = parent.chunksDone == parent.chunks.size();
+
+        // The finished prefix reads as text; chunks past a gap are shown once it fills
+        qsizetype ready = 0;
+        while (ready < parent.chunkTexts.size() && !parent.chunkTexts.at(ready).isNull()) {
+            ++ready;
+        }
+        partialText = TextChunker::join(parent.chunks.mid(0, ready), parent.chunkTexts.mid(0, ready));
+        progressPercent = static_cast<int>(parent.chunksDone * 100 / qMax<qsizetype>(1, parent.chunks.size()));
+    }
+
+    if (finished) {
+        finishChunkedRequest(parentId);
+        return;
+    }
+    QStringList subscribers;
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        subscribers = subscribersLocked(parentId);
+    }
+    for (const QString& id : std::as_const(subscribers)) {
+        if (!partialText.isEmpty()) {
+            emit enhancementPartialResult(id, partialText);
+        }
+        emit enhancementProgress(id, qMin(progressPercent, MAX_STREAMING_PROGRESS));
+    }
+}
+
+void TextEnhancementService::finishChunkedRequest(const QString& parentId) {
+    EnhancementRequest request;
+    EnhancementResult result;
+    QStringList subscribers;
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        auto it = m_activeRequests.find(parentId);
+        if (it == m_activeRequests.end() || it->status != EnhancementStatus::Processing) {
+            return;
+        }
+        RequestInfo& parent = it.value();
+        request = parent.request;
+        result.id = parentId;
+        result.originalText = parent.request.text;
+        result.enhancedText = TextChunker::join(parent.chunks, parent.chunkTexts);
+        result.mode = parent.request.settings.mode;
+        result.provider = parent.provider;
+        result.processingTime = parent.timer.elapsed();
+        result.improvementScore = calculateImprovementScore(result.originalText, result.enhancedText);
+        result.changes = analyzeTextChanges(result.originalText, result.enhancedText);
+        QJsonObject metadata;
+        metadata["chunks"] = static_cast<int>(parent.chunks.size());
+        result.metadata = metadata;
+
+        parent.status = EnhancementStatus::Completed;
+        parent.result = result;
+        parent.hasResult = true;
+        subscribers = releaseFollowersLocked(parentId, EnhancementStatus::Completed, &result);
+    }
+
+    cacheResult(generateCacheKey(request), result);
+    for (const QString& id : std::as_const(subscribers)) {
+        EnhancementResult copy = result;
+        copy.id = id;
+        emit enhancementProgress(id, 100);
+        emit enhancementCompleted(id, copy);
+    }
+}
+
+void TextEnhancementService::failChunkedRequest(const QString& parentId, EnhancementError error, const QString& errorMessage) {
+    QStringList subscribers;
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        auto it = m_activeRequests.find(parentId);
+        if (it == m_activeRequests.end() || it->status != EnhancementStatus::Processing) {
+            return;
+        }
+        it->status = EnhancementStatus::Failed;
+        // The document cannot be assembled without the chunk; the others stop too
+        cancelRequestsLocked(it->chunkIds);
+        subscribers = releaseFollowersLocked(parentId, EnhancementStatus::Failed);
+    }
+
+    setError(error, errorMessage);
+    for (const QString& id : std::as_const(subscribers)) {
+        emit enhancementFailed(id, error, errorMessage);
+    }
+    processNextPendingRequest();
+}
+
+void TextEnhancementService::cancelRequestsLocked(const QStringList& requestIds) {
+    for (const QString& requestId : requestIds) {
+        m_pendingRequests.removeAll(requestId);
+        auto it = m_activeRequests.find(requestId);
+        if (it == m_activeRequests.end()) {
+            continue;
+        }
+        if (QNetworkReply* reply = it->networkReply) {
+            // abort() emits finished() right away, and this thread holds the lock
+            it->networkReply = nullptr;
+            reply->disconnect(this);
+            reply->abort();
+            reply->deleteLater();
+        }
+        if (it->abortFlag) {
+            it->abortFlag->storeRelaxed(1);
+        }
+        if (it->status != EnhancementStatus::Completed) {
+            it->status = EnhancementStatus::Cancelled;
+        }
+    }
+}
+
 void TextEnhancementService::cancelEnhancement(const QString& requestId) {
     QMutexLocker locker(&m_requestsMutex);
 
-    if (m_activeRequests.contains(requestId)) {
-        RequestInfo& info = m_activeRequests[requestId];
-        
-        if (info.networkReply) {
-            info.networkReply->abort();
-        }
-        
-        info.status = EnhancementStatus::Cancelled;
-        emit enhancementCancelled(requestId);
+    auto it = m_activeRequests.find(requestId);
+    if (it == m_activeRequests.end()) {
+        m_pendingRequests.removeAll(requestId);
+        return;
     }
 
-    // Remove from pending queue
-    QQueue<QString> newQueue;
-    while (!m_pendingRequests.isEmpty()) {
-        QString id = m_pendingRequests.dequeue();
-        if (id != requestId) {
-            newQueue.enqueue(id);
+    // Shared work only stops once nobody is waiting for it
+    QString toStop = requestId;
+    if (!it->leaderId.isEmpty()) {
+        if (it->status != EnhancementStatus::Completed) {
+            it->status = EnhancementStatus::Cancelled;
+        }
+        auto leader = m_activeRequests.find(it->leaderId);
+        if (leader != m_activeRequests.end()) {
+            leader->followers.removeAll(requestId);
         }
+        if (leader == m_activeRequests.end() || !leader->detached || !leader->followers.isEmpty()) {
+            locker.unlock();
+            emit enhancementCancelled(requestId);
+            return;
+        }
+        toStop = leader.key();
+    } else if (!it->followers.isEmpty()) {
+        it->detached = true;
+        locker.unlock();
+        emit enhancementCancelled(requestId);
+        return;
     }
-    m_pendingRequests = newQueue;
+
+    // A chunked request takes its chunks with it
+    releaseFollowersLocked(toStop, EnhancementStatus::Cancelled);
+    cancelRequestsLocked(QStringList{toStop} + m_activeRequests.value(toStop).chunkIds);
+    
+    // The cancelled request may have freed a slot
+    locker.unlock();
+    emit enhancementCancelled(requestId);
+    processNextPendingRequest();
 }
 
 EnhancementStatus TextEnhancementService::getEnhancementStatus(const QString& requestId) const {
     QMutexLocker locker(&m_requestsMutex);
 
-    if (m_activeRequests.contains(requestId)) {
-        return m_activeRequests.value(requestId).status;
+    const auto it = m_activeRequests.constFind(requestId);
+    if (it != m_activeRequests.cend()) {
+        if (it->detached) {
+            return EnhancementStatus::Cancelled;
+        }
+        // A waiting follower is as far along as its leader
+        const auto leader = m_activeRequests.constFind(it->leaderId);
+        if (it->status == EnhancementStatus::Pending && leader != m_activeRequests.cend()) {
+            return leader->status;
+        }
+        return it->status;
     }
 
     return EnhancementStatus::Failed;
@@ -368,6 +689,10 @@ qint64 TextEnhancementService::estimateProcessingTime(const QString& text, Enhan
 }
 
 bool TextEnhancementService::isTextTooLong(const QString& text) const {
+    return text.length() > MAX_CHUNKED_TEXT_LENGTH;
+}
+
+bool TextEnhancementService::needsChunking(const QString& text) const {
     return text.length() > MAX_TEXT_LENGTH || countWords(text) > MAX_WORD_COUNT;
 }
 
@@ -376,27 +701,17 @@ QString TextEnhancementService::detectLanguage(const QString& text) const {
 }
 
 double TextEnhancementService::assessTextQuality(const QString& text) const {
-    double grammarScore = assessGrammarQuality(text);
-    double styleScore = assessStyleQuality(text);
-    double clarityScore = assessClarityScore(text);
-
-    // Weighted average
-    return (grammarScore * 0.4 + styleScore * 0.3 + clarityScore * 0.3);
+    return qualityScore(analysisFor(text));
 }
 
 QStringList TextEnhancementService::identifyIssues(const QString& text) const {
-    QStringList issues;
-    
-    issues.append(findGrammarIssues(text));
-    issues.append(findStyleIssues(text));
-    issues.append(findReadabilityIssues(text));
-    
-    return issues;
+    return issuesIn(analysisFor(text));
 }
 
 QString TextEnhancementService::suggestBestMode(const QString& text) const {
-    double quality = assessTextQuality(text);
-    QStringList issues = identifyIssues(text);
+    const TextAnalysis analysis = analysisFor(text);
+    double quality = qualityScore(analysis);
+    QStringList issues = issuesIn(analysis);
     
     // Count different types of issues
     int grammarIssues = 0;
@@ -413,7 +728,7 @@ QString TextEnhancementService::suggestBestMode(const QString& text) const {
     
     if (grammarIssues > styleIssues * 2) {
         return "GrammarOnly";
-    } else if (countWords(text) > 500) {
+    } else if (analysis.wordCount > 500) {
         return "Summarization";
     } else if (quality < 0.6) {
         return "StyleImprovement";
@@ -426,6 +741,7 @@ void TextEnhancementService::setApiKey(const QString& apiKey) {
     m_apiKey = apiKey;
     m_settings->setValue("apiKey", apiKey);
     clearErrorState();
+    warmUpConnection();
 }
 
 void TextEnhancementService::setDefaultSettings(const EnhancementSettings& settings) {
@@ -448,20 +764,80 @@ void TextEnhancementService::setTimeout(int timeoutMs) {
 
 void TextEnhancementService::setMaxConcurrentRequests(int maxRequests) {
     m_maxConcurrentRequests = qMax(1, maxRequests);
+    m_rateLimiter.setConcurrencyBounds(qMin(INITIAL_CONCURRENT, m_maxConcurrentRequests), m_maxConcurrentRequests);
 }
 
-qint64 TextEnhancementService::getAverageProcessingTime(EnhancementProvider provider) const {
-    const auto& times = m_processingTimes.value(provider);
-    if (times.isEmpty()) {
-        return 0;
+void TextEnhancementService::setRateLimits(int requestsPerMinute, int tokensPerMinute) {
+    m_rateLimiter.setQuota(requestsPerMinute, tokensPerMinute);
+    m_settings->beginGroup("rateLimits");
+    m_settings->setValue("requestsPerMinute", requestsPerMinute);
+    m_settings->setValue("tokensPerMinute", tokensPerMinute);
+    m_settings->endGroup();
+    processNextPendingRequest();
+}
+
+EnhancementRateLimiter::Metrics TextEnhancementService::getSchedulerMetrics() const {
+    EnhancementRateLimiter::Metrics metrics = m_rateLimiter.metrics();
+    QMutexLocker locker(&m_requestsMutex);
+    metrics.queued = static_cast<int>(m_pendingRequests.size());
+    metrics.inFlight = processingCountLocked();
+    return metrics;
+}
+
+bool TextEnhancementService::setLocalModelPath(const QString& modelPath) {
+    if (modelPath.isEmpty()) {
+        m_localEngine->unload();
+    } else {
+        QString errorMessage;
+        if (!m_localEngine->load(modelPath, &errorMessage)) {
+            setError(EnhancementError::ServiceUnavailable, errorMessage);
+            return false;
+        }
     }
+    m_settings->setValue("localModel/path", modelPath);
+    processNextPendingRequest();
+    return true;
+}
+
+QString TextEnhancementService::getLocalModelPath() const {
+    return m_localEngine->modelPath();
+}
+
+bool TextEnhancementService::isLocalModelLoaded() const {
+    return m_localEngine->isLoaded();
+}
+
+void TextEnhancementService::setPreferLocalForShortText(bool prefer) {
+    m_preferLocal = prefer;
+    m_settings->setValue("localModel/preferForShortText", prefer);
+}
 
-    qint64 sum = 0;
-    for (qint64 time : times) {
-        sum += time;
+void TextEnhancementService::setLocalComputePool(QThreadPool* pool, int threadCount) {
+    if (pool) {
+        m_localPool = pool;
     }
+    m_localEngine->setThreadCount(threadCount);
+}
+
+void TextEnhancementService::setTelemetry(Telemetry* telemetry) {
+    m_telemetry = telemetry;
+}
 
-    return sum / times.size();
+void TextEnhancementService::setStreamingEnabled(bool enable) {
+    m_streamingEnabled = enable;
+    m_settings->setValue("streaming", enable);
+}
+
+bool TextEnhancementService::isStreamingEnabled() const {
+    return m_streamingEnabled;
+}
+
+qint64 TextEnhancementService::getAverageProcessingTime(EnhancementProvider provider) const {
+    return static_cast<qint64>(m_processingTimes.value(provider).mean());
+}
+
+qint64 TextEnhancementService::getProcessingTimePercentile(EnhancementProvider provider, double quantile) const {
+    return m_processingTimes.value(provider).percentile(quantile);
 }
 
 double TextEnhancementService::getProviderReliability(EnhancementProvider provider) const {
@@ -504,26 +880,40 @@ void TextEnhancementService::enableCaching(bool enable) {
 }
 
 void TextEnhancementService::clearCache() {
-    QMutexLocker locker(&m_cacheMutex);
     m_cache.clear();
 }
 
 qint64 TextEnhancementService::getCacheSize() const {
-    QMutexLocker locker(&m_cacheMutex);
-    
-    qint64 totalSize = 0;
-    for (const auto& entry : m_cache) {
-        totalSize += entry.result.originalText.toUtf8().size();
-        totalSize += entry.result.enhancedText.toUtf8().size();
+    return m_cache.sizeBytes();
+}
+
+void TextEnhancementService::setPersistentCacheEnabled(bool enable) {
+    m_settings->setValue("persistentCache", enable);
+    if (!enable) {
+        m_cache.closeDatabase();
+        return;
     }
-    
-    return totalSize;
+    if (!m_cache.isPersistent()) {
+        const QString cacheDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        m_cache.openDatabase(QDir(cacheDirectory).absoluteFilePath(PERSISTENT_CACHE_FILE_NAME));
+    }
+}
+
+bool TextEnhancementService::isPersistentCacheEnabled() const {
+    return m_cache.isPersistent();
+}
+
+EnhancementCache::Stats TextEnhancementService::getCacheStats() const {
+    return m_cache.stats();
 }
 
 void TextEnhancementService::onNetworkStatusChanged(bool online) {
     m_isOnline = online;
     if (online) {
+        warmUpConnection();
         retryFailedEnhancements();
+    } else {
+        processNextPendingRequest(); // Whatever the local model can do need not wait
     }
     emit networkStatusChanged(online);
 }
@@ -536,7 +926,7 @@ void TextEnhancementService::retryFailedEnhancements() {
         if (m_activeRequests.contains(requestId)) {
             RequestInfo& info = m_activeRequests[requestId];
             if (shouldRetryRequest(info)) {
-                scheduleRetry(requestId);
+                scheduleRetry(requestId, m_rateLimiter.retryDelayMs(info.retryCount, info.retryAfterMs));
             }
         }
     }
@@ -552,105 +942,57 @@ QString TextEnhancementService::generateRequestId() {
     return QUuid::createUuid().toString(QUuid::WithoutBraces);
 }
 
-QString TextEnhancementService::generateCacheKey(const EnhancementRequest& request) const {
-    QString keyData = request.text + 
-                     QString::number(static_cast<int>(request.settings.mode)) +
-                     request.settings.customPrompt +
-                     QString::number(request.settings.creativity) +
-                     request.settings.targetAudience +
-                     request.settings.tone;
-    
-    return QCryptographicHash::hash(keyData.toUtf8(), QCryptographicHash::Md5).toHex();
+QByteArray TextEnhancementService::generateCacheKey(const EnhancementRequest& request, const QString& context) const {
+    return EnhancementCache::makeKey(request, context);
 }
 
-bool TextEnhancementService::isRequestCached(const QString& cacheKey) const {
-    QMutexLocker locker(&m_cacheMutex);
-    
-    if (!m_cache.contains(cacheKey)) {
-        return false;
-    }
-    
-    const CacheEntry& entry = m_cache.value(cacheKey);
-    QDateTime expiryTime = entry.timestamp.addSecs(m_cacheExpiryHours * 3600);
-    
-    return QDateTime::currentDateTime() < expiryTime;
+void TextEnhancementService::cacheResult(const QByteArray& cacheKey, const EnhancementResult& result) {
+    if (!m_cachingEnabled) return;
+    m_cache.store(cacheKey, result);
 }
 
-EnhancementResult TextEnhancementService::getCachedResult(const QString& cacheKey) {
-    QMutexLocker locker(&m_cacheMutex);
-    
-    if (m_cache.contains(cacheKey)) {
-        CacheEntry& entry = m_cache[cacheKey];
-        entry.accessCount++;
-        return entry.result;
+TextAnalysis TextEnhancementService::analysisFor(const QString& text) const {
+    // The default analysis is that of the empty text
+    QMutexLocker locker(&m_analysisMutex);
+    if (text != m_analyzedText) {
+        m_analysis = TextAnalyzer::analyze(text);
+        m_analyzedText = text;
     }
-    
-    return EnhancementResult();
+    return m_analysis;
 }
 
-void TextEnhancementService::cacheResult(const QString& cacheKey, const EnhancementResult& result) {
-    if (!m_cachingEnabled) return;
-    
-    QMutexLocker locker(&m_cacheMutex);
-    
-    CacheEntry entry;
-    entry.result = result;
-    entry.timestamp = QDateTime::currentDateTime();
-    entry.accessCount = 1;
-    
-    m_cache[cacheKey] = entry;
-    
-    // Check if we need to evict old entries
-    if (getCacheSize() > m_maxCacheSize) {
-        evictOldCacheEntries();
-    }
+double TextEnhancementService::qualityScore(const TextAnalysis& analysis) const {
+    double grammarScore = assessGrammarQuality(analysis);
+    double styleScore = assessStyleQuality(analysis);
+    double clarityScore = assessClarityScore(analysis);
+
+    // Weighted average
+    return (grammarScore * 0.4 + styleScore * 0.3 + clarityScore * 0.3);
 }
 
-void TextEnhancementService::evictOldCacheEntries() {
-    // Remove oldest entries first
-    QStringList keysToRemove;
-    QDateTime cutoff = QDateTime::currentDateTime().addSecs(-m_cacheExpiryHours * 3600);
-    
-    for (auto it = m_cache.begin(); it != m_cache.end(); ++it) {
-        if (it.value().timestamp < cutoff) {
-            keysToRemove.append(it.key());
-        }
-    }
+QStringList TextEnhancementService::issuesIn(const TextAnalysis& analysis) const {
+    QStringList issues;
     
-    for (const QString& key : keysToRemove) {
-        m_cache.remove(key);
-    }
+    issues.append(findGrammarIssues(analysis));
+    issues.append(findStyleIssues(analysis));
+    issues.append(findReadabilityIssues(analysis));
     
-    // If still over limit, remove least accessed entries
-    while (getCacheSize() > m_maxCacheSize && !m_cache.isEmpty()) {
-        auto minIt = std::min_element(m_cache.begin(), m_cache.end(),
-                                    [](const CacheEntry& a, const CacheEntry& b) {
-                                        return a.accessCount < b.accessCount;
-                                    });
-        m_cache.erase(minIt);
-    }
+    return issues;
 }
 
 int TextEnhancementService::countWords(const QString& text) const {
-    if (text.isEmpty()) return 0;
-    
-    QTextBoundaryFinder finder(QTextBoundaryFinder::Word, text);
-    int wordCount = 0;
-    
-    while (finder.toNextBoundary() != -1) {
-        if (finder.boundaryReasons() & QTextBoundaryFinder::StartOfItem) {
-            QString word = text.mid(finder.position(), 
-                                  finder.toNextBoundary() - finder.position());
-            if (!word.trimmed().isEmpty() && word.contains(QRegularExpression("[a-zA-Z]"))) {
-                wordCount++;
-            }
-        }
-    }
-    
-    return wordCount;
+    return analysisFor(text).wordCount;
 }
 
-QString TextEnhancementService::buildGeminiPrompt(const EnhancementRequest& request) const {
+int TextEnhancementService::countParagraphs(const QString& text) const {
+    return analysisFor(text).paragraphCount;
+}
+
+double TextEnhancementService::calculateReadabilityScore(const QString& text) const {
+    return TextAnalyzer::readingEase(analysisFor(text));
+}
+
+QString TextEnhancementService::buildGeminiPrompt(const EnhancementRequest& request, const QString& context) const {
     QString prompt;
     
     switch (request.settings.mode) {
@@ -684,6 +1026,13 @@ QString TextEnhancementService::buildGeminiPrompt(const EnhancementRequest& requ
         prompt += "\n\nPreserve the original formatting and structure.";
     }
     
+    // Chunks of a longer document see the end of the previous chunk, so the rewrite
+    // continues it smoothly instead of starting over
+    if (!context.isEmpty()) {
+        prompt += "\n\nThe text continues a longer document. For context only, it follows this passage, "
+                  "which must not be repeated or rewritten:\n" + context;
+    }
+    
     prompt += "\n\nText to enhance:\n" + request.text;
     
     return prompt;
@@ -716,6 +1065,141 @@ QString TextEnhancementService::buildCustomPrompt(const EnhancementSettings& set
     return settings.customPrompt;
 }
 
+QJsonObject TextEnhancementService::buildGeminiRequestJson(const EnhancementRequest& request, const QString& context) const {
+    QJsonObject part;
+    part["text"] = buildGeminiPrompt(request, context);
+    
+    QJsonObject content;
+    content["role"] = "user";
+    content["parts"] = QJsonArray{part};
+    
+    // maxOutputLength counts words; at about 1.3 tokens per word, twice as many
+    // tokens leaves room so answers are not cut off mid-sentence
+    QJsonObject generationConfig;
+    generationConfig["temperature"] = request.settings.creativity;
+    generationConfig["maxOutputTokens"] = request.settings.maxOutputLength * 2;
+    generationConfig["candidateCount"] = 1;
+    
+    QJsonObject json;
+    json["contents"] = QJsonArray{content};
+    json["generationConfig"] = generationConfig;
+    return json;
+}
+
+QString TextEnhancementService::getGeminiApiUrl(EnhancementProvider provider, bool streaming) const {
+    QString url = provider == EnhancementProvider::GeminiFlash ? GEMINI_FLASH_ENDPOINT : GEMINI_PRO_ENDPOINT;
+    if (streaming) {
+        url.replace(":generateContent", ":streamGenerateContent?alt=sse");
+    }
+    return url;
+}
+
+QNetworkRequest TextEnhancementService::buildGeminiRequest(EnhancementProvider provider, bool streaming) const {
+    QNetworkRequest request{QUrl(getGeminiApiUrl(provider, streaming))};
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    // In a header rather than the query string, so it stays out of proxy and server logs
+    request.setRawHeader("x-goog-api-key", m_apiKey.toUtf8());
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    if (streaming) {
+        request.setRawHeader("Accept", "text/event-stream");
+    }
+    return request;
+}
+
+void TextEnhancementService::warmUpConnection() {
+    if (m_apiKey.isEmpty() || !m_isOnline) {
+        return;
+    }
+    
+    // DNS, TCP and TLS happen now instead of in the first enhancement's latency; the
+    // manager keeps the connection and multiplexes later requests over it with HTTP/2
+#if QT_CONFIG(ssl)
+    QSslConfiguration sslConfiguration = QSslConfiguration::defaultConfiguration();
+    sslConfiguration.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2,
+                                              QSslConfiguration::NextProtocolHttp1_1});
+    m_networkManager->connectToHostEncrypted(GEMINI_API_HOST, 443, sslConfiguration);
+#endif
+}
+
+EnhancementResult TextEnhancementService::parseGeminiResponse(const GeminiStreamParser& response,
+                                                              const EnhancementRequest& originalRequest,
+                                                              const QString& requestId) const {
+    EnhancementResult result;
+    result.id = requestId;
+    result.originalText = originalRequest.text;
+    result.enhancedText = response.text().trimmed();
+    result.mode = originalRequest.settings.mode;
+    result.provider = originalRequest.preferredProvider;
+    result.processingTime = 0;
+    result.improvementScore = calculateImprovementScore(result.originalText, result.enhancedText);
+    result.changes = analyzeTextChanges(result.originalText, result.enhancedText);
+    
+    QJsonObject metadata;
+    metadata["model"] = response.modelVersion();
+    metadata["finishReason"] = response.finishReason();
+    metadata["usage"] = response.usageMetadata();
+    metadata["chunks"] = response.eventCount();
+    result.metadata = metadata;
+    return result;
+}
+
+EnhancementError TextEnhancementService::classifyGeminiFailure(const GeminiStreamParser& response,
+                                                               QString* errorMessage) const {
+    if (response.hasError()) {
+        *errorMessage = response.errorMessage();
+        switch (response.errorCode()) {
+            case 400:
+                return errorMessage->contains("API key", Qt::CaseInsensitive)
+                           ? EnhancementError::InvalidApiKey : EnhancementError::InvalidPrompt;
+            case 401:
+            case 403:
+                return EnhancementError::AuthenticationError;
+            case 429:
+                return EnhancementError::QuotaExceeded;
+            case 500:
+            case 503:
+                return EnhancementError::ServiceUnavailable;
+            case 504:
+                return EnhancementError::TimeoutError;
+            default:
+                return EnhancementError::UnknownError;
+        }
+    }
+    
+    if (!response.blockReason().isEmpty()) {
+        *errorMessage = "Prompt blocked: " + response.blockReason();
+        return EnhancementError::ContentFiltered;
+    }
+    
+    if (response.text().trimmed().isEmpty()) {
+        static const QStringList filteredReasons = {"SAFETY", "RECITATION", "BLOCKLIST", "PROHIBITED_CONTENT", "SPII"};
+        if (filteredReasons.contains(response.finishReason())) {
+            *errorMessage = "Response filtered: " + response.finishReason();
+            return EnhancementError::ContentFiltered;
+        }
+        *errorMessage = "Empty response from provider";
+        return EnhancementError::UnknownError;
+    }
+    
+    return EnhancementError::NoError;
+}
+
+double TextEnhancementService::calculateImprovementScore(const QString& original, const QString& enhanced) const {
+    // 0.5 means no measurable change in the quality heuristics
+    return qBound(0.0, 0.5 + (assessTextQuality(enhanced) - assessTextQuality(original)), 1.0);
+}
+
+QJsonObject TextEnhancementService::analyzeTextChanges(const QString& original, const QString& enhanced) const {
+    const int originalWords = countWords(original);
+    const int enhancedWords = countWords(enhanced);
+    
+    QJsonObject changes;
+    changes["originalWords"] = originalWords;
+    changes["enhancedWords"] = enhancedWords;
+    changes["lengthRatio"] = originalWords > 0 ? static_cast<double>(enhancedWords) / originalWords : 0.0;
+    return changes;
+}
+
 void TextEnhancementService::setError(EnhancementError error, const QString& errorMessage) {
     m_lastError = error;
     m_errorString = errorMessage;
@@ -724,6 +1208,27 @@ void TextEnhancementService::setError(EnhancementError error, const QString& err
 
 void TextEnhancementService::loadSettings() {
     m_apiKey = m_settings->value("apiKey", "").toString();
+    m_streamingEnabled = m_settings->value("streaming", true).toBool();
+    
+    m_settings->beginGroup("rateLimits");
+    m_rateLimiter.setQuota(m_settings->value("requestsPerMinute", EnhancementRateLimiter::DEFAULT_REQUESTS_PER_MINUTE).toInt(),
+                           m_settings->value("tokensPerMinute", EnhancementRateLimiter::DEFAULT_TOKENS_PER_MINUTE).toInt());
+    m_settings->endGroup();
+    
+    // The model loads in the background; until then requests go to Gemini
+    m_settings->beginGroup("localModel");
+    m_preferLocal = m_settings->value("preferForShortText", true).toBool();
+    const QString localModelPath = m_settings->value("path").toString();
+    m_settings->endGroup();
+    if (!localModelPath.isEmpty() && LocalLlmEngine::isCompiledIn()) {
+        const QSharedPointer<LocalLlmEngine> engine = m_localEngine;
+        m_localPool->start([engine, localModelPath]() {
+            QString errorMessage;
+            if (!engine->load(localModelPath, &errorMessage)) {
+                qWarning() << "TextEnhancementService:" << errorMessage;
+            }
+        });
+    }
     
     m_settings->beginGroup("defaultSettings");
     m_defaultSettings.maxOutputLength = m_settings->value("maxOutputLength", 2000).toInt();
@@ -743,44 +1248,30 @@ void TextEnhancementService::initializeDefaultSettings() {
 }
 
 // Simplified implementations for complex text analysis methods
-double TextEnhancementService::assessGrammarQuality(const QString& text) const {
-    // Simple heuristic - count common grammar issues
-    int issueCount = 0;
-    
-    // Check for basic issues (this is simplified)
-    QStringList commonIssues = {"teh", "recieve", "occured", "seperate", "definately"};
-    for (const QString& issue : commonIssues) {
-        if (text.contains(issue, Qt::CaseInsensitive)) {
-            issueCount++;
-        }
-    }
+double TextEnhancementService::assessGrammarQuality(const TextAnalysis& analysis) const {
+    // Simple heuristic - count common misspellings
+    const int issueCount = static_cast<int>(analysis.misspellings.size());
     
     // Return score based on issues found
     return qMax(0.0, 1.0 - (static_cast<double>(issueCount) / 10.0));
 }
 
-double TextEnhancementService::assessStyleQuality(const QString& text) const {
+double TextEnhancementService::assessStyleQuality(const TextAnalysis& analysis) const {
     // Simple readability assessment
-    int wordCount = countWords(text);
-    int sentenceCount = countSentences(text);
-    
-    if (sentenceCount == 0) return 0.5;
+    if (analysis.sentenceCount == 0) return 0.5;
     
-    double avgWordsPerSentence = static_cast<double>(wordCount) / sentenceCount;
+    double avgWordsPerSentence = static_cast<double>(analysis.wordCount) / analysis.sentenceCount;
     
     // Optimal range is 15-20 words per sentence
     double score = 1.0 - qAbs(avgWordsPerSentence - 17.5) / 17.5;
     return qBound(0.0, score, 1.0);
 }
 
-double TextEnhancementService::assessClarityScore(const QString& text) const {
+double TextEnhancementService::assessClarityScore(const TextAnalysis& analysis) const {
     // Simple clarity metric based on word length and sentence complexity
-    int totalChars = text.length();
-    int wordCount = countWords(text);
-    
-    if (wordCount == 0) return 0.5;
+    if (analysis.wordCount == 0) return 0.5;
     
-    double avgWordLength = static_cast<double>(totalChars) / wordCount;
+    double avgWordLength = static_cast<double>(analysis.characterCount) / analysis.wordCount;
     
     // Optimal average word length is around 4-6 characters
     double score = 1.0 - qAbs(avgWordLength - 5.0) / 5.0;
@@ -788,43 +1279,39 @@ double TextEnhancementService::assessClarityScore(const QString& text) const {
 }
 
 int TextEnhancementService::countSentences(const QString& text) const {
-    return text.count('.') + text.count('!') + text.count('?');
+    return analysisFor(text).sentenceCount;
 }
 
-QStringList TextEnhancementService::findGrammarIssues(const QString& text) const {
+QStringList TextEnhancementService::findGrammarIssues(const TextAnalysis& analysis) const {
     QStringList issues;
     
-    // Simple grammar issue detection (placeholder)
-    if (text.contains(QRegularExpression("\\bteh\\b"))) {
-        issues << "Spelling: 'teh' should be 'the'";
+    for (const QString& misspelling : analysis.misspellings) {
+        issues << QString("Spelling: '%1' should be '%2'").arg(misspelling, TextAnalyzer::correctionFor(misspelling));
     }
     
-    if (text.contains(QRegularExpression("\\bit's\\s+own"))) {
+    if (analysis.itsOwnMisuse) {
         issues << "Grammar: Consider 'its own' instead of 'it's own'";
     }
     
     return issues;
 }
 
-QStringList TextEnhancementService::findStyleIssues(const QString& text) const {
+QStringList TextEnhancementService::findStyleIssues(const TextAnalysis& analysis) const {
     QStringList issues;
     
-    // Check for overly long sentences
-    QStringList sentences = text.split(QRegularExpression("[.!?]"));
-    for (const QString& sentence : sentences) {
-        if (countWords(sentence.trimmed()) > 25) {
-            issues << "Style: Consider breaking up long sentences";
-        }
+    // One per overly long sentence
+    for (int i = 0; i < analysis.longSentenceCount; ++i) {
+        issues << "Style: Consider breaking up long sentences";
     }
     
     return issues;
 }
 
-QStringList TextEnhancementService::findReadabilityIssues(const QString& text) const {
+QStringList TextEnhancementService::findReadabilityIssues(const TextAnalysis& analysis) const {
     QStringList issues;
     
     // Check for passive voice (simplified)
-    if (text.contains(QRegularExpression("\\b(was|were)\\s+\\w+ed\\b"))) {
+    if (analysis.passiveVoice) {
         issues << "Readability: Consider using active voice";
     }
     
@@ -838,36 +1325,148 @@ QString TextEnhancementService::detectTextLanguage(const QString& text) const {
     return "en"; // Default to English
 }
 
-// Network handling methods (simplified)
+// Network handling methods
+void TextEnhancementService::handleStreamReadyRead() {
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply) return;
+    
+    // An error body is one JSON object, not events; it is read when the reply finishes
+    if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() >= 400) {
+        return;
+    }
+    
+    QString requestId;
+    QString partialText;
+    int progressPercent = 0;
+    QStringList subscribers;
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        requestId = findRequestByReply(reply);
+        if (requestId.isEmpty()) {
+            return;
+        }
+        RequestInfo& info = m_activeRequests[requestId];
+        if (info.response.feed(reply->readAll()).isEmpty() || !info.parentId.isEmpty()) {
+            return; // Nothing but a partial event so far, or a chunk; its document reports progress
+        }
+        partialText = info.response.text();
+        // The output is roughly as long as the input, except for summaries
+        progressPercent = qBound(1, static_cast<int>(partialText.size() * 100 / qMax<qsizetype>(1, info.request.text.size())),
+                                 MAX_STREAMING_PROGRESS);
+        subscribers = subscribersLocked(requestId);
+    }
+    
+    for (const QString& id : std::as_const(subscribers)) {
+        emit enhancementPartialResult(id, partialText);
+        emit enhancementProgress(id, progressPercent);
+    }
+}
+
 void TextEnhancementService::handleNetworkReplyFinished() {
     QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
     if (!reply) return;
+    reply->deleteLater();
     
     // Find the corresponding request
     QString requestId;
+    EnhancementRequest request;
+    EnhancementProvider provider = EnhancementProvider::Unknown;
+    GeminiStreamParser response;
+    qint64 estimatedTokens = 0;
+    qint64 retryAfterMs = 0;
     {
         QMutexLocker locker(&m_requestsMutex);
-        for (auto it = m_activeRequests.begin(); it != m_activeRequests.end(); ++it) {
-            if (it.value().networkReply == reply) {
-                requestId = it.key();
-                break;
-            }
+        requestId = findRequestByReply(reply);
+        if (requestId.isEmpty()) {
+            return;
+        }
+        RequestInfo& info = m_activeRequests[requestId];
+        info.networkReply = nullptr;
+        if (m_telemetry) {
+            m_telemetry->recordStage(Telemetry::STAGE_NETWORK, info.timer.nsecsElapsed() / 1000);
+        }
+        
+        const bool httpError = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() >= 400;
+        if (info.streaming && !httpError) {
+            info.response.feed(reply->readAll());
+            info.response.finish();
+        } else {
+            info.response.parseResponse(reply->readAll());
         }
+        info.retryAfterMs = parseRetryAfter(reply, info.response);
+        retryAfterMs = info.retryAfterMs;
+        estimatedTokens = info.estimatedTokens;
+        request = info.request;
+        provider = info.provider;
+        response = info.response;
     }
     
-    if (!requestId.isEmpty()) {
-        if (reply->error() == QNetworkReply::NoError) {
-            // Process successful response
-            QByteArray responseData = reply->readAll();
-            // Parse and handle response (implementation details omitted for brevity)
-        } else {
-            // Handle error
-            EnhancementError error = mapNetworkError(reply->error());
-            handleTaskFailed(requestId, error, reply->errorString());
+    QString errorMessage;
+    EnhancementError error = classifyGeminiFailure(response, &errorMessage);
+    // Without an API error in the body (code 0), the transport error says more
+    if (reply->error() != QNetworkReply::NoError && response.errorCode() == 0) {
+        error = mapNetworkError(reply->error());
+        errorMessage = reply->errorString();
+    }
+    
+    // Settle the estimate charged at dispatch; a success without usage is taken as estimated
+    const QJsonObject usage = response.usageMetadata();
+    m_rateLimiter.recordUsage(estimatedTokens,
+                              usage.contains("totalTokenCount") ? usage.value("totalTokenCount").toInteger()
+                              : error == EnhancementError::NoError ? estimatedTokens : 0);
+    
+    if (error != EnhancementError::NoError) {
+        if (error == EnhancementError::QuotaExceeded || error == EnhancementError::ServiceUnavailable) {
+            m_rateLimiter.onThrottled(retryAfterMs);
         }
+        updateSuccessRate(provider, false);
+        setError(error, errorMessage);
+        handleTaskFailed(requestId, error, errorMessage);
+        processNextPendingRequest();
+        return;
     }
     
-    reply->deleteLater();
+    m_rateLimiter.onSuccess();
+    completeRequest(requestId, parseGeminiResponse(response, request, requestId));
+}
+
+void TextEnhancementService::completeRequest(const QString& requestId, EnhancementResult result) {
+    EnhancementRequest request;
+    QString context;
+    QString parentId;
+    int chunkIndex = -1;
+    QStringList subscribers;
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        auto it = m_activeRequests.find(requestId);
+        if (it == m_activeRequests.end()) {
+            return;
+        }
+        result.provider = it->provider;
+        result.processingTime = it->timer.elapsed();
+        request = it->request;
+        context = it->context;
+        parentId = it->parentId;
+        chunkIndex = it->chunkIndex;
+        setRequestStatus(requestId, EnhancementStatus::Completed);
+        setRequestResult(requestId, result);
+        subscribers = releaseFollowersLocked(requestId, EnhancementStatus::Completed, &result);
+    }
+    cacheResult(generateCacheKey(request, context), result);
+    updateProcessingTime(result.provider, result.processingTime);
+    updateSuccessRate(result.provider, true);
+    
+    if (!parentId.isEmpty()) {
+        completeChunk(parentId, chunkIndex, result.enhancedText);
+    } else {
+        for (const QString& id : std::as_const(subscribers)) {
+            EnhancementResult copy = result;
+            copy.id = id;
+            emit enhancementProgress(id, 100);
+            emit enhancementCompleted(id, copy);
+        }
+    }
+    processNextPendingRequest();
 }
 
 void TextEnhancementService::handleNetworkError(QNetworkReply::NetworkError error) {
@@ -899,11 +1498,158 @@ void TextEnhancementService::cleanupCompletedRequests() {
     }
 }
 
-// Placeholder implementations for complex methods
 void TextEnhancementService::processEnhancementRequest(const QString& requestId) {
-    // This would contain the actual Gemini API call implementation
-    // For now, it's a placeholder
-    Q_UNUSED(requestId)
+    // Called with m_requestsMutex held; signals are queued so no slot runs under it
+    auto it = m_activeRequests.find(requestId);
+    if (it == m_activeRequests.end() || it->status == EnhancementStatus::Cancelled) {
+        return;
+    }
+    
+    RequestInfo& info = it.value();
+    info.provider = chooseProvider(info.request);
+    info.status = EnhancementStatus::Processing;
+    info.timer.restart();
+    if (info.provider == EnhancementProvider::LocalLLM) {
+        startLocalGenerationLocked(requestId, info);
+    } else {
+        info.streaming = m_streamingEnabled;
+        info.response.reset();
+        
+        QNetworkRequest request = buildGeminiRequest(info.provider, info.streaming);
+        // Resets on every chunk, so a long stream is only cut off when it stalls
+        request.setTransferTimeout(info.request.timeoutMs > 0 ? info.request.timeoutMs : m_timeoutMs);
+        
+        const QByteArray body = QJsonDocument(buildGeminiRequestJson(info.request, info.context)).toJson(QJsonDocument::Compact);
+        QNetworkReply* reply = m_networkManager->post(request, body);
+        info.networkReply = reply;
+        if (info.streaming) {
+            connect(reply, &QNetworkReply::readyRead, this, &TextEnhancementService::handleStreamReadyRead);
+        }
+        connect(reply, &QNetworkReply::finished, this, &TextEnhancementService::handleNetworkReplyFinished);
+    }
+    
+    const EnhancementProvider provider = info.provider;
+    const QStringList subscribers = subscribersLocked(requestId);
+    QMetaObject::invokeMethod(this, [this, subscribers, provider]() {
+        for (const QString& id : subscribers) {
+            emit enhancementStarted(id, provider);
+        }
+    }, Qt::QueuedConnection);
+}
+
+void TextEnhancementService::processNextPendingRequest() {
+    QMutexLocker locker(&m_requestsMutex);
+    dispatchPendingLocked();
+}
+
+void TextEnhancementService::dispatchPendingLocked() {
+    // Local generations skip the quota and the network limit, wherever they are queued
+    for (auto pending = m_pendingRequests.begin(); pending != m_pendingRequests.end();) {
+        auto it = m_activeRequests.find(*pending);
+        if (it != m_activeRequests.end() && it->status == EnhancementStatus::Pending &&
+            chooseProvider(it->request) == EnhancementProvider::LocalLLM) {
+            const QString requestId = *pending;
+            pending = m_pendingRequests.erase(pending);
+            processEnhancementRequest(requestId);
+        } else {
+            ++pending;
+        }
+    }
+    
+    int activeCount = processingCountLocked();
+    while (activeCount < m_rateLimiter.concurrencyLimit() && !m_pendingRequests.isEmpty()) {
+        const QString requestId = m_pendingRequests.head();
+        auto it = m_activeRequests.find(requestId);
+        if (it == m_activeRequests.end() || it->status != EnhancementStatus::Pending) {
+            m_pendingRequests.dequeue();
+            continue;
+        }
+        
+        // The head waits for the quota rather than letting smaller requests overtake it
+        const qint64 tokens = estimateTokens(it.value());
+        qint64 waitMs = 0;
+        if (!m_rateLimiter.tryAcquire(tokens, &waitMs)) {
+            if (!m_dispatchTimer->isActive() || m_dispatchTimer->remainingTime() > waitMs) {
+                m_dispatchTimer->start(static_cast<int>(qMin<qint64>(waitMs, std::numeric_limits<int>::max())));
+            }
+            break;
+        }
+        
+        m_pendingRequests.dequeue();
+        it->estimatedTokens = tokens;
+        processEnhancementRequest(requestId);
+        activeCount++;
+    }
+}
+
+qint64 TextEnhancementService::estimateTokens(const RequestInfo& info) const {
+    // Prompt in, about as much text out; the reply's usage corrects this afterwards
+    const qsizetype characters = buildGeminiPrompt(info.request, info.context).size() + info.request.text.size();
+    return qMax<qint64>(1, characters / CHARS_PER_TOKEN);
+}
+
+EnhancementProvider TextEnhancementService::chooseProvider(const EnhancementRequest& request) const {
+    EnhancementProvider remote = request.preferredProvider;
+    if (remote != EnhancementProvider::GeminiPro && remote != EnhancementProvider::GeminiFlash) {
+        remote = m_currentProvider == EnhancementProvider::GeminiFlash ? EnhancementProvider::GeminiFlash
+                                                                       : EnhancementProvider::GeminiPro;
+    }
+    if (!canRunLocally(request)) {
+        return remote;
+    }
+    
+    // Local when asked for, when Gemini cannot be reached, or for a short edit,
+    // where the round trip would take longer than the generation
+    const bool localAsked = request.preferredProvider == EnhancementProvider::LocalLLM ||
+                            m_currentProvider == EnhancementProvider::LocalLLM;
+    const bool remoteReachable = m_isOnline && !m_apiKey.isEmpty();
+    const bool shortEdit = m_preferLocal && request.text.size() <= LOCAL_SHORT_TEXT_LENGTH;
+    return localAsked || !remoteReachable || shortEdit ? EnhancementProvider::LocalLLM : remote;
+}
+
+bool TextEnhancementService::canRunLocally(const EnhancementRequest& request) const {
+    // A small instruction model corrects and rephrases well; rewriting style,
+    // summaries and custom prompts stay with Gemini
+    const EnhancementMode mode = request.settings.mode;
+    return (mode == EnhancementMode::GrammarOnly || mode == EnhancementMode::Formalization) &&
+           request.text.size() <= LOCAL_MAX_TEXT_LENGTH && m_localEngine->isLoaded();
+}
+
+void TextEnhancementService::startLocalGenerationLocked(const QString& requestId, RequestInfo& info) {
+    // Room for the output to run somewhat longer than the input
+    const int maxTokens = static_cast<int>(info.request.text.size() / CHARS_PER_TOKEN) * 2 + LOCAL_OUTPUT_TOKEN_MARGIN;
+    const float temperature = info.request.settings.mode == EnhancementMode::GrammarOnly
+                                  ? 0.0f : static_cast<float>(info.request.settings.creativity);
+    info.abortFlag = QSharedPointer<QAtomicInt>::create(0);
+    
+    auto* task = new LocalEnhancementTask(m_localEngine, requestId, buildGeminiPrompt(info.request, info.context),
+                                          maxTokens, temperature, info.abortFlag);
+    connect(task, &LocalEnhancementTask::taskPartialText, this, &TextEnhancementService::handleLocalPartialText, Qt::QueuedConnection);
+    connect(task, &LocalEnhancementTask::taskCompleted, this, &TextEnhancementService::handleLocalTaskCompleted, Qt::QueuedConnection);
+    connect(task, &LocalEnhancementTask::taskFailed, this, &TextEnhancementService::handleLocalTaskFailed, Qt::QueuedConnection);
+    m_localPool->start(task);
+}
+
+int TextEnhancementService::processingCountLocked() const {
+    // A chunked request only waits for its chunks, which are counted themselves;
+    // local generations are bounded by their pool instead
+    int activeCount = 0;
+    for (const auto& req : m_activeRequests) {
+        if (req.status == EnhancementStatus::Processing && req.chunks.isEmpty() &&
+            req.provider != EnhancementProvider::LocalLLM) {
+            activeCount++;
+        }
+    }
+    return activeCount;
+}
+
+QString TextEnhancementService::findRequestByReply(const QNetworkReply* reply) const {
+    for (auto it = m_activeRequests.cbegin(); it != m_activeRequests.cend(); ++it) {
+        if (reply && it.value().networkReply == reply) {
+            return it.key();
+        }
+    }
+    return QString();
 }
 
 EnhancementError TextEnhancementService::mapNetworkError(QNetworkReply::NetworkError error) const {
@@ -911,11 +1657,13 @@ EnhancementError TextEnhancementService::mapNetworkError(QNetworkReply::NetworkE
         case QNetworkReply::AuthenticationRequiredError:
             return EnhancementError::AuthenticationError;
         case QNetworkReply::TimeoutError:
+        case QNetworkReply::OperationCanceledError: // Transfer timeout; cancelled replies are disconnected first
             return EnhancementError::TimeoutError;
         case QNetworkReply::NetworkSessionFailedError:
         case QNetworkReply::ConnectionRefusedError:
             return EnhancementError::NetworkError;
         case QNetworkReply::ContentNotFoundError:
+        case QNetworkReply::ServiceUnavailableError:
             return EnhancementError::ServiceUnavailable;
         default:
             return EnhancementError::NetworkError;
@@ -928,31 +1676,158 @@ bool TextEnhancementService::shouldRetryRequest(const RequestInfo& info) const {
            m_isOnline;
 }
 
-void TextEnhancementService::scheduleRetry(const QString& requestId, int delayMs) {
-    QTimer::singleShot(delayMs, this, [this, requestId]() {
+void TextEnhancementService::scheduleRetry(const QString& requestId, qint64 delayMs) {
+    // Back at the front of the queue, so the retry still goes through the quota
+    QTimer::singleShot(std::chrono::milliseconds(delayMs), this, [this, requestId]() {
         QMutexLocker locker(&m_requestsMutex);
-        if (m_activeRequests.contains(requestId)) {
-            RequestInfo& info = m_activeRequests[requestId];
-            info.retryCount++;
-            processEnhancementRequest(requestId);
+        auto it = m_activeRequests.find(requestId);
+        if (it == m_activeRequests.end() || it->status != EnhancementStatus::Failed) {
+            return; // Cancelled meanwhile
         }
+        it->retryCount++;
+        it->status = EnhancementStatus::Pending;
+        m_pendingRequests.removeAll(requestId);
+        m_pendingRequests.prepend(requestId);
+        dispatchPendingLocked();
     });
 }
 
+qint64 TextEnhancementService::parseRetryAfter(const QNetworkReply* reply, const GeminiStreamParser& response) {
+    // Retry-After is either delay-seconds or an HTTP date
+    const QByteArray header = reply->rawHeader("Retry-After").trimmed();
+    if (!header.isEmpty()) {
+        bool ok = false;
+        const qint64 seconds = header.toLongLong(&ok);
+        if (ok) {
+            return qMax<qint64>(0, seconds * 1000);
+        }
+        const QDateTime at = QDateTime::fromString(QString::fromLatin1(header), Qt::RFC2822Date);
+        if (at.isValid()) {
+            return qMax<qint64>(0, QDateTime::currentDateTimeUtc().msecsTo(at));
+        }
+    }
+    return response.retryDelayMs();
+}
+
 void TextEnhancementService::handleTaskFailed(const QString& requestId, EnhancementError error, const QString& errorMessage) {
+    QString parentId;
+    QStringList subscribers;
     {
         QMutexLocker locker(&m_requestsMutex);
         if (m_activeRequests.contains(requestId)) {
             RequestInfo& info = m_activeRequests[requestId];
             info.status = EnhancementStatus::Failed;
+            parentId = info.parentId;
             
-            if (shouldRetryRequest(info)) {
+            // Transient failures retry on their own with jittered, growing delays
+            // (or as long as the server asked); only what will not go away is
+            // reported, and for a chunk that fails the whole document
+            const bool transient = error == EnhancementError::NetworkError ||
+                                   error == EnhancementError::TimeoutError ||
+                                   error == EnhancementError::ServiceUnavailable ||
+                                   error == EnhancementError::QuotaExceeded;
+            if (transient && shouldRetryRequest(info)) {
+                scheduleRetry(requestId, m_rateLimiter.retryDelayMs(info.retryCount, info.retryAfterMs));
+                return;
+            }
+            if (parentId.isEmpty() && shouldRetryRequest(info)) {
                 m_failedRequests.enqueue(requestId);
             }
+            // Followers hear about the failure; a later manual retry is the leader's alone
+            subscribers = releaseFollowersLocked(requestId, EnhancementStatus::Failed);
         }
     }
     
-    emit enhancementFailed(requestId, error, errorMessage);
+    if (!parentId.isEmpty()) {
+        failChunkedRequest(parentId, error, errorMessage);
+        return;
+    }
+    for (const QString& id : std::as_const(subscribers)) {
+        emit enhancementFailed(id, error, errorMessage);
+    }
+}
+
+void TextEnhancementService::handleLocalPartialText(const QString& requestId, const QString& text) {
+    int progressPercent = 0;
+    QStringList subscribers;
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        auto it = m_activeRequests.find(requestId);
+        if (it == m_activeRequests.end() || it->status != EnhancementStatus::Processing || !it->parentId.isEmpty()) {
+            return; // Cancelled meanwhile, or a chunk; its document reports progress
+        }
+        progressPercent = qBound(1, static_cast<int>(text.size() * 100 / qMax<qsizetype>(1, it->request.text.size())),
+                                 MAX_STREAMING_PROGRESS);
+        subscribers = subscribersLocked(requestId);
+    }
+    
+    for (const QString& id : std::as_const(subscribers)) {
+        emit enhancementPartialResult(id, text);
+        emit enhancementProgress(id, progressPercent);
+    }
+}
+
+void TextEnhancementService::handleLocalTaskCompleted(const QString& requestId, const QString& text, int tokenCount) {
+    if (text.isEmpty()) {
+        handleLocalTaskFailed(requestId, "Local model returned no text");
+        return;
+    }
+    
+    EnhancementRequest request;
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        auto it = m_activeRequests.find(requestId);
+        if (it == m_activeRequests.end() || it->status != EnhancementStatus::Processing) {
+            return; // Cancelled meanwhile
+        }
+        it->abortFlag.reset();
+        request = it->request;
+    }
+    
+    EnhancementResult result;
+    result.id = requestId;
+    result.originalText = request.text;
+    result.enhancedText = text;
+    result.mode = request.settings.mode;
+    result.improvementScore = calculateImprovementScore(result.originalText, result.enhancedText);
+    result.changes = analyzeTextChanges(result.originalText, result.enhancedText);
+    
+    QJsonObject metadata;
+    metadata["model"] = QFileInfo(m_localEngine->modelPath()).completeBaseName();
+    metadata["local"] = true;
+    metadata["tokens"] = tokenCount;
+    result.metadata = metadata;
+    completeRequest(requestId, result);
+}
+
+void TextEnhancementService::handleLocalTaskFailed(const QString& requestId, const QString& errorMessage) {
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        auto it = m_activeRequests.find(requestId);
+        if (it == m_activeRequests.end() || it->status != EnhancementStatus::Processing) {
+            return; // Cancelled; its callers already know
+        }
+        it->abortFlag.reset();
+    }
+    
+    updateSuccessRate(EnhancementProvider::LocalLLM, false);
+    setError(EnhancementError::UnknownError, errorMessage);
+    handleTaskFailed(requestId, EnhancementError::UnknownError, errorMessage);
+    processNextPendingRequest();
+}
+
+void TextEnhancementService::updateProcessingTime(EnhancementProvider provider, qint64 processingTime) {
+    m_processingTimes[provider].record(processingTime);
+    emit processingTimeUpdated(provider, getAverageProcessingTime(provider));
+}
+
+void TextEnhancementService::updateSuccessRate(EnhancementProvider provider, bool success) {
+    QList<bool>& rates = m_successRates[provider];
+    rates.append(success);
+    while (rates.size() > PERFORMANCE_HISTORY_SIZE) {
+        rates.removeFirst();
+    }
+    emit reliabilityUpdated(provider, getProviderReliability(provider));
 }
 
 void TextEnhancementService::setRequestStatus(const QString& requestId, EnhancementStatus status) {
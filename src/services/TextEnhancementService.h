@@ -1,6 +1,13 @@
 #pragma once
 
 #include "../models/BaseModel.h"
+#include "EnhancementCache.h"
+#include "EnhancementRateLimiter.h"
+#include "GeminiStreamParser.h"
+#include "LocalLlmEngine.h"
+#include "TextAnalyzer.h"
+#include "TextChunker.h"
+#include "Telemetry.h"
 #include "../../specs/001-voice-to-text/contracts/ai-enhancement-interface.h"
 #include <QObject>
 #include <QString>
@@ -14,15 +21,33 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QMap>
+#include <QHash>
 #include <QQueue>
 #include <QAtomicInt>
+#include <QSharedPointer>
 #include <QSettings>
+#include <QThreadPool>
 
 /**
  * @brief TextEnhancementService implementation using Google Gemini API
  * 
  * Provides AI-powered text enhancement functionality using Google's Gemini models.
  * Supports multiple enhancement modes and concurrent processing.
+ *
+ * By default requests go to streamGenerateContent and the text is reported through
+ * enhancementPartialResult as it is generated. The connection to the API host is
+ * opened ahead of the first request and kept alive, with HTTP/2 multiplexing
+ * concurrent requests over it.
+ *
+ * Text beyond MAX_TEXT_LENGTH is split into chunks on paragraph and sentence
+ * boundaries. The chunks run concurrently within the request limit, each cached and
+ * retried on its own, and the result is reassembled in order under the original
+ * request ID.
+ *
+ * Grammar and formalization can also run on-device through LocalLlmEngine: when
+ * LocalLLM is asked for, when Gemini cannot be reached, and for short text when
+ * preferred. Local generations run on a worker pool, normally the transcription
+ * decode pool, and do not count against the Gemini quota or concurrency limit.
  */
 class TextEnhancementService : public ITextEnhancementService {
     Q_OBJECT
@@ -69,9 +94,29 @@ public:
     void setDefaultSettings(const EnhancementSettings& settings) override;
     void setTimeout(int timeoutMs) override;
     void setMaxConcurrentRequests(int maxRequests) override;
+    void setStreamingEnabled(bool enable);
+    bool isStreamingEnabled() const;
+    // Keeps results on disk as well, so repeat enhancements survive a restart
+    void setPersistentCacheEnabled(bool enable);
+    bool isPersistentCacheEnabled() const;
+    EnhancementCache::Stats getCacheStats() const;
+    // The provider's per-minute quotas; dispatch waits rather than exceed them
+    void setRateLimits(int requestsPerMinute, int tokensPerMinute);
+    EnhancementRateLimiter::Metrics getSchedulerMetrics() const;
+    // On-device model (GGUF); an empty path unloads it
+    bool setLocalModelPath(const QString& modelPath);
+    QString getLocalModelPath() const;
+    bool isLocalModelLoaded() const;
+    void setPreferLocalForShortText(bool prefer);
+    // Runs local generations on @p pool, which must outlive the service
+    void setLocalComputePool(QThreadPool* pool, int threadCount);
+
+    // Network round trips go to @p telemetry, which must outlive the service; null stops it
+    void setTelemetry(Telemetry* telemetry);
 
     // Performance Tracking
     qint64 getAverageProcessingTime(EnhancementProvider provider) const override;
+    qint64 getProcessingTimePercentile(EnhancementProvider provider, double quantile) const;
     double getProviderReliability(EnhancementProvider provider) const override;
     int getQueueLength() const override;
 
@@ -92,17 +137,22 @@ public slots:
 
 private slots:
     void handleNetworkReplyFinished();
+    void handleStreamReadyRead();
     void handleNetworkError(QNetworkReply::NetworkError error);
     void handleTimeout();
     void cleanupCompletedRequests();
     void processEnhancementRequest(const QString& requestId);
     void handleTaskFailed(const QString& requestId, EnhancementError error, const QString& errorMessage);
+    void handleLocalPartialText(const QString& requestId, const QString& text);
+    void handleLocalTaskCompleted(const QString& requestId, const QString& text, int tokenCount);
+    void handleLocalTaskFailed(const QString& requestId, const QString& errorMessage);
 
 private:
     // Core components
     QNetworkAccessManager* m_networkManager;
     QTimer* m_timeoutTimer;
     QTimer* m_cleanupTimer;
+    QTimer* m_dispatchTimer; // Fires when the quota has room for the next pending request
     QSettings* m_settings;
 
     // Configuration
@@ -110,9 +160,11 @@ private:
     EnhancementProvider m_currentProvider;
     EnhancementSettings m_defaultSettings;
     int m_timeoutMs;
-    int m_maxConcurrentRequests;
+    int m_maxConcurrentRequests; // Ceiling for the adaptive limit
     bool m_cachingEnabled;
+    bool m_streamingEnabled;
     bool m_isOnline;
+    bool m_preferLocal; // Short grammar and formalization edits go to the local model
 
     // Request management
     struct RequestInfo {
@@ -121,60 +173,90 @@ private:
         EnhancementResult result;
         QElapsedTimer timer;
         QNetworkReply* networkReply;
+        EnhancementProvider provider = EnhancementProvider::Unknown;
+        GeminiStreamParser response; // Chunks received so far
+        bool streaming = false;
         bool hasResult;
         int retryCount;
+        qint64 estimatedTokens = 0; // Charged to the quota at dispatch
+        qint64 retryAfterMs = 0;    // Delay the server asked for on the last failure
+        QSharedPointer<QAtomicInt> abortFlag; // Raised to stop a local generation
+
+        // A chunk of a chunked request
+        QString parentId;
+        int chunkIndex = -1;
+        QString context;
+
+        // A chunked request; chunkTexts holds a null string until the chunk is back
+        QList<TextChunker::Chunk> chunks;
+        QStringList chunkIds;
+        QStringList chunkTexts;
+        qsizetype chunksDone = 0;
+
+        // Identical submissions share one request, which reports to its followers too
+        QByteArray flightKey;   // Cache key while registered in m_inFlight
+        QStringList followers;
+        QString leaderId;       // Set on a follower
+        bool detached = false;  // Cancelled by its caller, still running for its followers
     };
 
     mutable QMutex m_requestsMutex;
     QMap<QString, RequestInfo> m_activeRequests;
     QQueue<QString> m_pendingRequests;
     QQueue<QString> m_failedRequests;
+    QHash<QByteArray, QString> m_inFlight; // Leader per cache key until it finishes
     QAtomicInt m_requestCounter;
 
     // Performance tracking
-    QMap<EnhancementProvider, QList<qint64>> m_processingTimes;
+    QMap<EnhancementProvider, LatencyHistogram> m_processingTimes; // Milliseconds
     QMap<EnhancementProvider, QList<bool>> m_successRates;
+    Telemetry* m_telemetry;
 
     // Caching
-    struct CacheEntry {
-        EnhancementResult result;
-        QDateTime timestamp;
-        qint64 accessCount;
-    };
-    
-    mutable QMutex m_cacheMutex;
-    QMap<QString, CacheEntry> m_cache;
-    qint64 m_maxCacheSize;
-    int m_cacheExpiryHours;
+    EnhancementCache m_cache;
+
+    // Quota and concurrency
+    EnhancementRateLimiter m_rateLimiter;
+
+    // On-device enhancement; queued tasks share the engine
+    QSharedPointer<LocalLlmEngine> m_localEngine;
+    QThreadPool* m_localPool;
 
     // Error handling
     EnhancementError m_lastError;
     QString m_errorString;
 
+    // Last text analysed; the editor asks about the same text several times per change
+    mutable QMutex m_analysisMutex;
+    mutable QString m_analyzedText;
+    mutable TextAnalysis m_analysis;
+
     // Helper methods
     QString generateRequestId();
-    QString generateCacheKey(const EnhancementRequest& request) const;
-    bool isRequestCached(const QString& cacheKey) const;
-    EnhancementResult getCachedResult(const QString& cacheKey);
-    void cacheResult(const QString& cacheKey, const EnhancementResult& result);
-    void evictOldCacheEntries();
+    QByteArray generateCacheKey(const EnhancementRequest& request, const QString& context = QString()) const;
+    void cacheResult(const QByteArray& cacheKey, const EnhancementResult& result);
 
     // Gemini API integration
-    QString buildGeminiPrompt(const EnhancementRequest& request) const;
-    QJsonObject buildGeminiRequestJson(const EnhancementRequest& request) const;
-    QString getGeminiApiUrl(EnhancementProvider provider) const;
-    QNetworkRequest buildGeminiRequest(EnhancementProvider provider) const;
+    QString buildGeminiPrompt(const EnhancementRequest& request, const QString& context = QString()) const;
+    QJsonObject buildGeminiRequestJson(const EnhancementRequest& request, const QString& context = QString()) const;
+    QString getGeminiApiUrl(EnhancementProvider provider, bool streaming) const;
+    QNetworkRequest buildGeminiRequest(EnhancementProvider provider, bool streaming) const;
+    void warmUpConnection();
     
     // Response processing
-    EnhancementResult parseGeminiResponse(const QByteArray& responseData, 
+    EnhancementResult parseGeminiResponse(const GeminiStreamParser& response,
                                         const EnhancementRequest& originalRequest,
                                         const QString& requestId) const;
+    EnhancementError classifyGeminiFailure(const GeminiStreamParser& response, QString* errorMessage) const;
     bool validateGeminiResponse(const QJsonObject& response) const;
     QString extractEnhancedText(const QJsonObject& response) const;
     double calculateImprovementScore(const QString& original, const QString& enhanced) const;
     QJsonObject analyzeTextChanges(const QString& original, const QString& enhanced) const;
 
     // Text analysis helpers
+    TextAnalysis analysisFor(const QString& text) const;
+    double qualityScore(const TextAnalysis& analysis) const;
+    QStringList issuesIn(const TextAnalysis& analysis) const;
     int countWords(const QString& text) const;
     int countSentences(const QString& text) const;
     int countParagraphs(const QString& text) const;
@@ -190,20 +272,45 @@ private:
     QString buildCustomPrompt(const EnhancementSettings& settings) const;
 
     // Quality assessment helpers
-    double assessGrammarQuality(const QString& text) const;
-    double assessStyleQuality(const QString& text) const;
-    double assessClarityScore(const QString& text) const;
-    QStringList findGrammarIssues(const QString& text) const;
-    QStringList findStyleIssues(const QString& text) const;
-    QStringList findReadabilityIssues(const QString& text) const;
+    double assessGrammarQuality(const TextAnalysis& analysis) const;
+    double assessStyleQuality(const TextAnalysis& analysis) const;
+    double assessClarityScore(const TextAnalysis& analysis) const;
+    QStringList findGrammarIssues(const TextAnalysis& analysis) const;
+    QStringList findStyleIssues(const TextAnalysis& analysis) const;
+    QStringList findReadabilityIssues(const TextAnalysis& analysis) const;
 
     // Network and error handling
     void setError(EnhancementError error, const QString& errorMessage);
     EnhancementError mapNetworkError(QNetworkReply::NetworkError error) const;
     bool shouldRetryRequest(const RequestInfo& info) const;
-    void scheduleRetry(const QString& requestId, int delayMs = 5000);
+    void scheduleRetry(const QString& requestId, qint64 delayMs);
+    static qint64 parseRetryAfter(const QNetworkReply* reply, const GeminiStreamParser& response);
 
     // Request lifecycle management
+    QString enqueueRequest(const EnhancementRequest& request, const QString& parentId, int chunkIndex,
+                           const QString& context);
+    int processingCountLocked() const;
+    void dispatchPendingLocked();
+    qint64 estimateTokens(const RequestInfo& info) const;
+    EnhancementProvider chooseProvider(const EnhancementRequest& request) const;
+    bool canRunLocally(const EnhancementRequest& request) const;
+    void startLocalGenerationLocked(const QString& requestId, RequestInfo& info);
+    void completeRequest(const QString& requestId, EnhancementResult result);
+    void cancelRequestsLocked(const QStringList& requestIds);
+    QString findRequestByReply(const QNetworkReply* reply) const;
+
+    // Single-flight: identical requests in flight are coalesced
+    QString attachToInFlight(const QByteArray& cacheKey, const EnhancementRequest& request);
+    QStringList subscribersLocked(const QString& requestId) const;
+    QStringList releaseFollowersLocked(const QString& requestId, EnhancementStatus status,
+                                       const EnhancementResult* result = nullptr);
+
+    // Chunked enhancement of long text
+    bool needsChunking(const QString& text) const;
+    QString submitChunkedEnhancement(const EnhancementRequest& request);
+    void completeChunk(const QString& parentId, int chunkIndex, const QString& enhancedText);
+    void finishChunkedRequest(const QString& parentId);
+    void failChunkedRequest(const QString& parentId, EnhancementError error, const QString& errorMessage);
     void setRequestStatus(const QString& requestId, EnhancementStatus status);
     void setRequestResult(const QString& requestId, const EnhancementResult& result);
     bool isRequestValid(const QString& requestId) const;
@@ -222,15 +329,26 @@ private:
 
     // Constants
     static constexpr int DEFAULT_TIMEOUT_MS = 10000;
-    static constexpr int DEFAULT_MAX_CONCURRENT = 3;
-    static constexpr int MAX_TEXT_LENGTH = 10000; // 10k characters
+    static constexpr int DEFAULT_MAX_CONCURRENT = 8;  // The adaptive limit never goes past this
+    static constexpr int INITIAL_CONCURRENT = 3;      // ...and starts here
+    static constexpr int CHARS_PER_TOKEN = 4;         // Rough estimate until the reply reports usage
+    static constexpr int MAX_TEXT_LENGTH = 10000; // 10k characters per request
     static constexpr int MAX_WORD_COUNT = 2000;   // ~2k words
+    static constexpr int MAX_CHUNKED_TEXT_LENGTH = 200000; // Longer text is split into chunks up to this
+    static constexpr int CHUNK_TARGET_LENGTH = 4000;
+    static constexpr int CHUNK_CONTEXT_LENGTH = 400;
+    static constexpr int MIN_CHUNK_OUTPUT_LENGTH = 50;
+    static constexpr int LOCAL_MAX_TEXT_LENGTH = 4000;   // Fits the local context with its output
+    static constexpr int LOCAL_SHORT_TEXT_LENGTH = 1000; // Preferred locally up to this
+    static constexpr int LOCAL_OUTPUT_TOKEN_MARGIN = 64;
     static constexpr int CLEANUP_INTERVAL_MS = 300000; // 5 minutes
     static constexpr int MAX_RETRY_COUNT = 3;
-    static constexpr int CACHE_EXPIRY_HOURS = 24;
-    static constexpr qint64 MAX_CACHE_SIZE_MB = 50;
+    static constexpr const char* PERSISTENT_CACHE_FILE_NAME = "enhancements.db";
+    static constexpr int PERFORMANCE_HISTORY_SIZE = 50; // Samples kept per provider
+    static constexpr int MAX_STREAMING_PROGRESS = 95;   // Percent shown until the stream ends
 
-    // Gemini API endpoints
+    // Gemini API endpoints; streaming replaces the :generateContent method
+    static constexpr const char* GEMINI_API_HOST = "generativelanguage.googleapis.com";
     static constexpr const char* GEMINI_PRO_ENDPOINT = "https://generativelanguage.googleapis.com/v1beta/models/gemini-pro:generateContent";
     static constexpr const char* GEMINI_FLASH_ENDPOINT = "https://generativelanguage.googleapis.com/v1beta/models/gemini-1.5-flash:generateContent";
 };
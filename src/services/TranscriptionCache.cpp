@@ -0,0 +1,151 @@
+#include "TranscriptionCache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QDebug>
+
+TranscriptionCache::TranscriptionCache(const QString& directory)
+    : m_directory(directory)
+    , m_maxSizeBytes(DEFAULT_MAX_SIZE_BYTES)
+    , m_totalBytes(-1)
+{
+    QDir().mkpath(m_directory);
+}
+
+QByteArray TranscriptionCache::makeKey(const QVector<float>& samples, const QByteArray& parametersKey) {
+    // BLAKE2b is about twice as fast as SHA-1 in software and 128 bits are plenty here
+    QCryptographicHash hash(QCryptographicHash::Blake2b_128);
+    hash.addData(QByteArray::number(FORMAT_VERSION));
+    hash.addData(parametersKey);
+    hash.addData(QByteArrayView(reinterpret_cast<const char*>(samples.constData()),
+                                static_cast<qsizetype>(samples.size() * sizeof(float))));
+    return hash.result().toHex();
+}
+
+bool TranscriptionCache::lookup(const QByteArray& key, TranscriptionResult& result) const {
+    QFile file(entryPath(key));
+    if (key.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+    if (!document.isObject()) {
+        return false;
+    }
+
+    result = resultFromJson(document.object());
+    file.close();
+
+    // Refresh the entry's age so pruning evicts the least recently used results
+    if (file.open(QIODevice::Append)) {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+    return true;
+}
+
+void TranscriptionCache::store(const QByteArray& key, const TranscriptionResult& result) {
+    if (key.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    // Written to a temporary file and renamed, so concurrent lookups never see half an entry
+    const QString path = entryPath(key);
+    const qint64 replacedBytes = QFileInfo(path).size(); // 0 when there is no entry yet
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write transcription cache entry:" << file.errorString();
+        return;
+    }
+    const qint64 written = file.write(QJsonDocument(resultToJson(result)).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qWarning() << "Cannot write transcription cache entry:" << file.errorString();
+        return;
+    }
+
+    if (m_totalBytes >= 0) {
+        m_totalBytes += written - replacedBytes;
+    }
+    if (m_totalBytes < 0 || m_totalBytes > m_maxSizeBytes) {
+        pruneLocked();
+    }
+}
+
+void TranscriptionCache::clear() {
+    QMutexLocker locker(&m_mutex);
+
+    QDir dir(m_directory);
+    for (const QString& name : dir.entryList({"*.json"}, QDir::Files)) {
+        dir.remove(name);
+    }
+    m_totalBytes = 0;
+}
+
+void TranscriptionCache::setMaxSizeBytes(qint64 bytes) {
+    QMutexLocker locker(&m_mutex);
+    m_maxSizeBytes = qMax<qint64>(0, bytes);
+    pruneLocked();
+}
+
+qint64 TranscriptionCache::getMaxSizeBytes() const {
+    QMutexLocker locker(&m_mutex);
+    return m_maxSizeBytes;
+}
+
+QString TranscriptionCache::getDirectory() const {
+    return m_directory;
+}
+
+QJsonObject TranscriptionCache::resultToJson(const TranscriptionResult& result) {
+    QJsonObject json;
+    json["text"] = result.text;
+    json["confidence"] = result.confidence;
+    json["language"] = result.language;
+    json["processingTime"] = result.processingTime;
+    json["wordTimestamps"] = result.wordTimestamps;
+    json["provider"] = static_cast<int>(result.provider);
+    json["metadata"] = result.metadata;
+    return json;
+}
+
+TranscriptionResult TranscriptionCache::resultFromJson(const QJsonObject& json) {
+    TranscriptionResult result;
+    result.text = json.value("text").toString();
+    result.confidence = json.value("confidence").toDouble();
+    result.language = json.value("language").toString();
+    result.processingTime = json.value("processingTime").toVariant().toLongLong();
+    result.wordTimestamps = json.value("wordTimestamps").toArray();
+    result.provider = static_cast<TranscriptionProvider>(json.value("provider").toInt());
+    result.metadata = json.value("metadata").toObject();
+    return result;
+}
+
+QString TranscriptionCache::entryPath(const QByteArray& key) const {
+    return QDir(m_directory).absoluteFilePath(QString::fromLatin1(key) + ".json");
+}
+
+void TranscriptionCache::pruneLocked() {
+    // Oldest entries go first once the directory outgrows the budget
+    const QFileInfoList entries = QDir(m_directory).entryInfoList({"*.json"}, QDir::Files, QDir::Time | QDir::Reversed);
+
+    qint64 total = 0;
+    for (const QFileInfo& entry : entries) {
+        total += entry.size();
+    }
+
+    for (const QFileInfo& entry : entries) {
+        if (total <= m_maxSizeBytes) {
+            break;
+        }
+        total -= entry.size();
+        QFile::remove(entry.absoluteFilePath());
+    }
+    m_totalBytes = total;
+}
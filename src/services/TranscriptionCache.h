@@ -0,0 +1,50 @@
+#pragma once
+
+#include "../../specs/001-voice-to-text/contracts/transcription-service-interface.h"
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Persistent, content-addressed cache of transcription results
+ *
+ * Entries are keyed by a hash of the decoded 16 kHz PCM plus everything that
+ * influences the decode (model, language, options), so the same audio is never
+ * run through whisper twice, whichever file or buffer it arrives from. Each entry
+ * is one JSON file in the cache directory; lookups are safe from worker threads.
+ *
+ * Keys and stores touch the whole PCM or the disk, so both belong on worker
+ * threads. The directory size is tracked as entries are written; it is only
+ * listed again when the total outgrows the budget.
+ */
+class TranscriptionCache {
+public:
+    explicit TranscriptionCache(const QString& directory);
+
+    // One pass over the samples; compute it once per request and pass it along
+    static QByteArray makeKey(const QVector<float>& samples, const QByteArray& parametersKey);
+
+    bool lookup(const QByteArray& key, TranscriptionResult& result) const;
+    void store(const QByteArray& key, const TranscriptionResult& result);
+    void clear();
+
+    void setMaxSizeBytes(qint64 bytes);
+    qint64 getMaxSizeBytes() const;
+    QString getDirectory() const;
+
+    static QJsonObject resultToJson(const TranscriptionResult& result);
+    static TranscriptionResult resultFromJson(const QJsonObject& json);
+
+    static constexpr int FORMAT_VERSION = 2; // Bump when decoding output or the key digest changes
+    static constexpr qint64 DEFAULT_MAX_SIZE_BYTES = 256LL * 1024 * 1024; // 256MB
+
+private:
+    QString entryPath(const QByteArray& key) const;
+    void pruneLocked();
+
+    QString m_directory;
+    qint64 m_maxSizeBytes;
+    qint64 m_totalBytes; // Size of every entry; -1 until the directory is first listed
+    mutable QMutex m_mutex; // Serializes writers with pruning and clearing
+};
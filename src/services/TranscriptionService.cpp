@@ -1,5 +1,7 @@
 #include "TranscriptionService.h"
 #include "StorageManager.h"
+#include "AudioFileReader.h"
+#include "VoiceActivityDetector.h"
 #include "../models/Transcription.h"
 #include <whisper.h>
 #include <QDebug>
@@ -15,19 +17,400 @@
 #include <QProcess>
 #include <QCoreApplication>
 #include <QUuid>
+#include <QCryptographicHash>
+#include <QPromise>
 #include <QtMath>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <cmath>
+
+namespace {
+
+// QThreadPool runs higher values first among queued runnables
+int poolPriority(TranscriptionPriority priority) {
+    switch (priority) {
+        case TranscriptionPriority::Interactive:
+            return 2;
+        case TranscriptionPriority::Normal:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Decode milliseconds allowed per millisecond of audio: generous multiples of the
+// real-time factor a slow CPU reaches with each model
+double decodeAllowance(TranscriptionProvider provider) {
+    switch (provider) {
+        case TranscriptionProvider::WhisperCppTiny:
+            return 0.5;
+        case TranscriptionProvider::WhisperCppSmall:
+            return 2.0;
+        case TranscriptionProvider::WhisperCppMedium:
+            return 4.0;
+        case TranscriptionProvider::WhisperCppLarge:
+            return 8.0;
+        default:
+            return 1.0;
+    }
+}
+
+} // namespace
 
 // TranscriptionTask Implementation
-TranscriptionTask::TranscriptionTask(const TranscriptionRequest& request, const QString& requestId)
-    : m_request(request), m_requestId(requestId)
+TranscriptionTask::TranscriptionTask(const TranscriptionRequest& request, const QString& requestId,
+                                     whisper_context* context, whisper_state* state, int threadCount)
+    : m_request(request)
+    , m_requestId(requestId)
+    , m_context(context)
+    , m_state(state)
+    , m_threadCount(qMax(1, threadCount))
+    , m_lastProgress(-1)
+    , m_sampleOffset(0)
+    , m_sampleCount(-1)
+    , m_chunkingEnabled(false)
+    , m_timeoutBaseMs(0)
+    , m_timeoutPerAudioMs(0.0)
+    , m_deadline(QDeadlineTimer::Forever)
+    , m_timedOut(false)
+    , m_resultCache(nullptr)
+    , m_telemetry(nullptr)
+    , m_melElapsedNs(-1)
 {
-    setAutoDelete(false); // We'll manage deletion ourselves
+    // The pool deletes the task once run() returns; results leave via queued signals
+    setAutoDelete(true);
 }
 
 void TranscriptionTask::run() {
-    // This will be called from a worker thread
-    // The actual whisper.cpp processing will be handled by TranscriptionService
-    // This is a placeholder - the main processing logic is in TranscriptionService::processWithWhisper
+    QElapsedTimer timer;
+    timer.start();
+
+    if (m_abortFlag && m_abortFlag->loadRelaxed()) {
+        emit taskFailed(m_requestId, TranscriptionError::UnknownError, "Transcription cancelled");
+        return;
+    }
+
+    if (!m_context || !m_state) {
+        emit taskFailed(m_requestId, TranscriptionError::ModelLoadError, "Whisper model is not loaded");
+        return;
+    }
+
+    QVector<float> samples = m_samples;
+    if (samples.isEmpty() && !m_request.audioBuffer.isEmpty()) {
+        // Shares the recorder's buffer; only a rate mismatch forces a converted copy
+        samples = m_request.audioBuffer.samples;
+        if (m_request.audioBuffer.sampleRate != AudioFileReader::TARGET_SAMPLE_RATE) {
+            samples = AudioFileReader::resample(samples, m_request.audioBuffer.sampleRate,
+                                                AudioFileReader::TARGET_SAMPLE_RATE);
+        }
+    }
+    
+    QString errorMessage;
+    if (samples.isEmpty() && !AudioFileReader::readSamples(m_request.audioFilePath, samples, &errorMessage)) {
+        emit taskFailed(m_requestId, TranscriptionError::InvalidAudioFile, errorMessage);
+        return;
+    }
+    
+    QByteArray cacheKey;
+    if (m_resultCache) {
+        cacheKey = TranscriptionCache::makeKey(samples, m_cacheParametersKey);
+        TranscriptionResult cached;
+        if (m_resultCache->lookup(cacheKey, cached)) {
+            cached.id = m_requestId;
+            cached.metadata["cacheHit"] = true;
+            cached.metadata["cachedProcessingTime"] = cached.processingTime;
+            cached.processingTime = timer.elapsed();
+            emit taskProgress(m_requestId, 100);
+            emit taskCompleted(m_requestId, cached);
+            return;
+        }
+    }
+    
+    const qint64 offset = qBound<qint64>(0, m_sampleOffset, samples.size());
+    const qint64 count = m_sampleCount < 0 ? samples.size() - offset : qMin(m_sampleCount, samples.size() - offset);
+    
+    // Covers everything from here on, language detection included, measured from the start of run()
+    if (m_timeoutBaseMs > 0) {
+        const qint64 audioMs = count * 1000 / AudioFileReader::TARGET_SAMPLE_RATE;
+        const qint64 budgetMs = m_timeoutBaseMs + static_cast<qint64>(audioMs * m_timeoutPerAudioMs);
+        m_deadline = QDeadlineTimer(qMax<qint64>(0, budgetMs - timer.elapsed()));
+    }
+    
+    // Settle the language once, on a short prefix, instead of letting whisper_full
+    // (and every chunk of a long recording) detect it again over a full window
+    float languageProbability = -1.0f;
+    if (isAutoLanguage(m_request.language)) {
+        const QString detected = detectLanguage(m_context, m_state, samples.constData() + offset, count,
+                                                m_threadCount, &languageProbability);
+        if (!detected.isEmpty()) {
+            m_request.language = detected;
+        }
+    }
+    
+    if (m_chunkingEnabled) {
+        const QList<qint64> splitPoints = VoiceActivityDetector::findSplitPoints(samples, AudioFileReader::TARGET_SAMPLE_RATE);
+        if (!splitPoints.isEmpty()) {
+            // Long audio: the service fans the chunks out over the pool
+            emit taskChunked(m_requestId, samples, splitPoints, m_request.language, cacheKey);
+            return;
+        }
+    }
+    
+    const QByteArray prompt = m_initialPrompt.toUtf8();
+
+    const QByteArray language = isAutoLanguage(m_request.language)
+        ? QByteArray("auto")
+        : m_request.language.left(m_request.language.indexOf('-')).toUtf8();
+
+    whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    params.n_threads = m_threadCount;
+    params.language = language.constData();
+    params.translate = false;
+    params.token_timestamps = true;
+    params.print_progress = false;
+    params.print_realtime = false;
+    params.print_special = false;
+    params.print_timestamps = false;
+    params.progress_callback = &TranscriptionTask::progressCallback;
+    params.progress_callback_user_data = this;
+    params.abort_callback = &TranscriptionTask::abortCallback;
+    params.abort_callback_user_data = this;
+    params.encoder_begin_callback = &TranscriptionTask::encoderBeginCallback;
+    params.encoder_begin_callback_user_data = this;
+    if (!prompt.isEmpty()) {
+        params.initial_prompt = prompt.constData();
+        params.no_context = true; // The prompt already carries the context we want
+    }
+
+    m_decodeTimer.start();
+    const int rc = whisper_full_with_state(m_context, m_state, params, samples.constData() + offset, static_cast<int>(count));
+    if (m_telemetry && rc == 0 && m_melElapsedNs >= 0) {
+        m_telemetry->recordStage(Telemetry::STAGE_MEL, m_melElapsedNs / 1000);
+        m_telemetry->recordStage(Telemetry::STAGE_DECODE, (m_decodeTimer.nsecsElapsed() - m_melElapsedNs) / 1000);
+    }
+    if (m_timedOut) {
+        emit taskFailed(m_requestId, TranscriptionError::TimeoutError,
+                        QString("Transcription timed out after %1 ms").arg(timer.elapsed()));
+        return;
+    }
+    if (m_abortFlag && m_abortFlag->loadRelaxed()) {
+        emit taskFailed(m_requestId, TranscriptionError::UnknownError, "Transcription cancelled");
+        return;
+    }
+    if (rc != 0) {
+        emit taskFailed(m_requestId, TranscriptionError::ProcessingError,
+                        QString("whisper_full failed with code %1").arg(rc));
+        return;
+    }
+
+    TranscriptionResult result = buildResult(m_state);
+    result.provider = m_request.preferredProvider;
+    result.processingTime = timer.elapsed();
+    result.metadata["audioDurationMs"] = count * 1000 / AudioFileReader::TARGET_SAMPLE_RATE;
+    result.metadata["threads"] = m_threadCount;
+    if (languageProbability >= 0.0f) {
+        result.metadata["languageProbability"] = languageProbability;
+    }
+    if (!cacheKey.isEmpty()) {
+        result.metadata["cacheKey"] = QString::fromLatin1(cacheKey);
+    }
+
+    emit taskProgress(m_requestId, 100);
+    emit taskCompleted(m_requestId, result);
+}
+
+void TranscriptionTask::setSamples(const QVector<float>& samples, qint64 offset, qint64 count) {
+    m_samples = samples;
+    m_sampleOffset = offset;
+    m_sampleCount = count;
+}
+
+void TranscriptionTask::setInitialPrompt(const QString& prompt) {
+    m_initialPrompt = prompt;
+}
+
+void TranscriptionTask::setChunkingEnabled(bool enabled) {
+    m_chunkingEnabled = enabled;
+}
+
+void TranscriptionTask::setAbortFlag(const QSharedPointer<QAtomicInt>& abortFlag) {
+    m_abortFlag = abortFlag;
+}
+
+void TranscriptionTask::setResultCache(TranscriptionCache* cache, const QByteArray& parametersKey) {
+    m_resultCache = cache;
+    m_cacheParametersKey = parametersKey;
+}
+
+void TranscriptionTask::setTelemetry(Telemetry* telemetry) {
+    m_telemetry = telemetry;
+}
+
+void TranscriptionTask::setTimeout(int baseMs, double perAudioMs) {
+    m_timeoutBaseMs = baseMs;
+    m_timeoutPerAudioMs = perAudioMs;
+}
+
+void TranscriptionTask::setDeadline(const QDeadlineTimer& deadline) {
+    m_deadline = deadline;
+}
+
+TranscriptionResult TranscriptionTask::buildResult(whisper_state* state) const {
+    TranscriptionResult result;
+    result.id = m_requestId;
+
+    QString text;
+    QJsonArray segmentTimings;
+    const int segmentCount = whisper_full_n_segments_from_state(state);
+    for (int i = 0; i < segmentCount; ++i) {
+        const QString segmentText = QString::fromUtf8(whisper_full_get_segment_text_from_state(state, i));
+        text += segmentText;
+
+        QJsonObject segment;
+        segment["text"] = segmentText.trimmed();
+        segment["startTime"] = whisper_full_get_segment_t0_from_state(state, i) / 100.0;
+        segment["endTime"] = whisper_full_get_segment_t1_from_state(state, i) / 100.0;
+        segmentTimings.append(segment);
+    }
+    result.text = text.trimmed();
+    result.metadata["segmentTimings"] = segmentTimings;
+
+    double averageConfidence = 0.0;
+    result.wordTimestamps = extractWordTimestamps(state, averageConfidence);
+    result.confidence = averageConfidence;
+
+    const int langId = whisper_full_lang_id_from_state(state);
+    result.language = langId >= 0 ? QString::fromUtf8(whisper_lang_str(langId)) : m_request.language;
+    result.metadata["segments"] = segmentCount;
+    return result;
+}
+
+QJsonArray TranscriptionTask::extractWordTimestamps(whisper_state* state, double& averageConfidence) const {
+    QJsonArray words;
+    const whisper_token eot = whisper_token_eot(m_context);
+    double confidenceSum = 0.0;
+    int tokenCount = 0;
+
+    QString word;
+    double wordStart = 0.0;
+    double wordEnd = 0.0;
+    double wordConfidence = 0.0;
+    int wordTokens = 0;
+
+    auto flushWord = [&]() {
+        const QString trimmed = word.trimmed();
+        if (!trimmed.isEmpty()) {
+            QJsonObject entry;
+            entry["word"] = trimmed;
+            entry["startTime"] = wordStart;
+            entry["endTime"] = wordEnd;
+            entry["confidence"] = wordConfidence / wordTokens;
+            words.append(entry);
+        }
+        word.clear();
+        wordConfidence = 0.0;
+        wordTokens = 0;
+    };
+
+    const int segmentCount = whisper_full_n_segments_from_state(state);
+    for (int i = 0; i < segmentCount; ++i) {
+        const int tokens = whisper_full_n_tokens_from_state(state, i);
+        for (int j = 0; j < tokens; ++j) {
+            const whisper_token_data data = whisper_full_get_token_data_from_state(state, i, j);
+            if (data.id >= eot) {
+                continue; // Timestamp and control tokens carry no text
+            }
+
+            const QString piece = QString::fromUtf8(whisper_full_get_token_text_from_state(m_context, state, i, j));
+            // whisper tokens that start a new word carry a leading space
+            if (piece.startsWith(' ') && wordTokens > 0) {
+                flushWord();
+            }
+            if (wordTokens == 0) {
+                wordStart = data.t0 / 100.0; // centiseconds -> seconds
+            }
+
+            word += piece;
+            wordEnd = data.t1 / 100.0;
+            wordConfidence += data.p;
+            ++wordTokens;
+
+            confidenceSum += data.p;
+            ++tokenCount;
+        }
+        if (wordTokens > 0) {
+            flushWord();
+        }
+    }
+
+    averageConfidence = tokenCount > 0 ? qBound(0.0, confidenceSum / tokenCount, 1.0) : 0.0;
+    return words;
+}
+
+void TranscriptionTask::progressCallback(whisper_context* ctx, whisper_state* state, int progress, void* userData) {
+    Q_UNUSED(ctx)
+    Q_UNUSED(state)
+
+    auto* task = static_cast<TranscriptionTask*>(userData);
+    if (progress != task->m_lastProgress) {
+        task->m_lastProgress = progress;
+        emit task->taskProgress(task->m_requestId, qBound(0, progress, 99));
+    }
+}
+
+bool TranscriptionTask::encoderBeginCallback(whisper_context* ctx, whisper_state* state, void* userData) {
+    Q_UNUSED(ctx)
+    Q_UNUSED(state)
+
+    // whisper_full computes the whole spectrogram before the first window is encoded
+    auto* task = static_cast<TranscriptionTask*>(userData);
+    if (task->m_melElapsedNs < 0) {
+        task->m_melElapsedNs = task->m_decodeTimer.nsecsElapsed();
+    }
+    return true;
+}
+
+bool TranscriptionTask::isAutoLanguage(const QString& language) {
+    return language.isEmpty() || language.compare("auto", Qt::CaseInsensitive) == 0;
+}
+
+QString TranscriptionTask::detectLanguage(whisper_context* ctx, whisper_state* state, const float* samples,
+                                          qint64 sampleCount, int threadCount, float* probability) {
+    // Only the prefix is turned into mel frames; whisper pads the rest of the window with silence
+    const qint64 prefix = qMin<qint64>(sampleCount, static_cast<qint64>(LANGUAGE_DETECT_MS) *
+                                                    AudioFileReader::TARGET_SAMPLE_RATE / 1000);
+    if (!ctx || !state || !samples || prefix <= 0) {
+        return QString();
+    }
+    
+    if (whisper_pcm_to_mel_with_state(ctx, state, samples, static_cast<int>(prefix), threadCount) != 0) {
+        return QString();
+    }
+    
+    std::vector<float> probabilities(whisper_lang_max_id() + 1, 0.0f);
+    const int langId = whisper_lang_auto_detect_with_state(ctx, state, 0, threadCount, probabilities.data());
+    if (langId < 0) {
+        return QString();
+    }
+    
+    if (probability) {
+        *probability = probabilities[langId];
+    }
+    return QString::fromUtf8(whisper_lang_str(langId));
+}
+
+bool TranscriptionTask::abortCallback(void* userData) {
+    // Polled by whisper between encoder graph nodes and decoder steps
+    auto* task = static_cast<TranscriptionTask*>(userData);
+    if (task->m_abortFlag && task->m_abortFlag->loadRelaxed()) {
+        return true;
+    }
+    if (task->m_deadline.hasExpired()) {
+        task->m_timedOut = true;
+        return true;
+    }
+    return false;
 }
 
 // TranscriptionService Implementation
@@ -40,11 +423,29 @@ TranscriptionService::TranscriptionService(QObject* parent)
     , m_defaultLanguage("en")
     , m_timeoutMs(DEFAULT_TIMEOUT_MS)
     , m_maxConcurrentRequests(DEFAULT_MAX_CONCURRENT)
+    , m_threadCount(qBound(DEFAULT_THREAD_COUNT, QThread::idealThreadCount() / DEFAULT_MAX_CONCURRENT, MAX_AUTO_THREAD_COUNT))
+    , m_threadCountOverridden(false)
+    , m_decodeSlots(DEFAULT_MAX_CONCURRENT)
     , m_requestCounter(0)
+    , m_pendingCount(0)
+    , m_runningTasks(0)
+    , m_chunksInFlight(0)
+    , m_prefetchPool(new QThreadPool(this))
+    , m_modelMemoryBudget(DEFAULT_MODEL_MEMORY_BUDGET)
+    , m_modelUseCounter(0)
+    , m_modelLoaderPool(new QThreadPool(this))
+    , m_resultCache(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).absoluteFilePath("transcriptions"))
     , m_storageManager(nullptr)
+    , m_telemetry(nullptr)
 {
-    // Configure thread pool
-    m_threadPool->setMaxThreadCount(DEFAULT_THREAD_COUNT);
+    qRegisterMetaType<TranscriptionResult>("TranscriptionResult");
+    qRegisterMetaType<TranscriptionError>("TranscriptionError");
+    qRegisterMetaType<QVector<float>>("QVector<float>");
+    qRegisterMetaType<QList<qint64>>("QList<qint64>");
+
+    updateDecodeSlots();
+    m_modelLoaderPool->setMaxThreadCount(1);
+    m_prefetchPool->setMaxThreadCount(1);
     
     // Setup cleanup timer
     m_cleanupTimer = new QTimer(this);
@@ -58,19 +459,55 @@ TranscriptionService::TranscriptionService(QObject* parent)
     // Create models directory if it doesn't exist
     createModelsDirectory();
     
-    // Initialize default provider if model is available
-    if (isModelDownloaded(m_currentProvider)) {
-        initializeProvider(m_currentProvider);
-    }
+    // No warm-up here: the owner calls preloadModel() once the provider it wants is set,
+    // so startup never loads a model nobody selected
 }
 
 TranscriptionService::~TranscriptionService() {
-    // Stop all active tasks
+    // Abort downloads; their .part files stay on disk for the next resume
+    for (auto it = m_downloads.begin(); it != m_downloads.end(); ++it) {
+        if (it.value().reply) {
+            it.value().reply->disconnect(this);
+            it.value().reply->abort();
+        }
+        delete it.value().partFile;
+        delete it.value().hash;
+    }
+    m_downloads.clear();
+    
+    // Drop queued tasks and wait for running decodes and loads; they still use the contexts
     m_threadPool->clear();
-    m_threadPool->waitForDone(5000); // Wait up to 5 seconds
+    m_threadPool->waitForDone();
+    m_modelLoaderPool->clear();
+    m_modelLoaderPool->waitForDone();
+    m_prefetchPool->clear();
+    m_prefetchPool->waitForDone();
+    
+    // States still leased to requests whose completion will never be delivered
+    for (auto it = m_activeRequests.begin(); it != m_activeRequests.end(); ++it) {
+        if (it.value().state) {
+            whisper_free_state(it.value().state);
+        }
+        for (const ChunkJob& chunk : it.value().chunks) {
+            if (chunk.state) {
+                whisper_free_state(chunk.state);
+            }
+        }
+    }
+    for (auto it = m_streams.begin(); it != m_streams.end(); ++it) {
+        if (it.value().state) {
+            whisper_free_state(it.value().state);
+        }
+    }
     
-    // Cleanup loaded models
+    // Cleanup loaded models together with their state pools
     QMutexLocker locker(&m_modelsMutex);
+    for (auto it = m_statePools.begin(); it != m_statePools.end(); ++it) {
+        for (whisper_state* state : it.value().idleStates) {
+            whisper_free_state(state);
+        }
+    }
+    m_statePools.clear();
     for (auto it = m_loadedModels.begin(); it != m_loadedModels.end(); ++it) {
         if (it.value()) {
             whisper_free(it.value());
@@ -107,19 +544,11 @@ bool TranscriptionService::setProvider(TranscriptionProvider provider) {
     }
     
     if (m_currentProvider != provider) {
-        // Cleanup current provider
-        cleanupProvider(m_currentProvider);
-        
-        // Initialize new provider
-        if (initializeProvider(provider)) {
-            m_currentProvider = provider;
-            clearErrorState();
-            return true;
-        }
-        
-        // If initialization failed, revert to previous provider
-        initializeProvider(m_currentProvider);
-        return false;
+        // The previous model stays resident until the memory budget needs its space;
+        // the new one loads in the background so switching never blocks the caller
+        m_currentProvider = provider;
+        clearErrorState();
+        preloadModel(provider);
     }
     
     return true;
@@ -157,6 +586,10 @@ bool TranscriptionService::isModelDownloaded(TranscriptionProvider model) const
     return !modelPath.isEmpty() && QFile::exists(modelPath) && validateModelFile(modelPath);
 }
 
+bool TranscriptionService::isModelLoaded(TranscriptionProvider model) const {
+    return isWhisperModelLoaded(model);
+}
+
 void TranscriptionService::removeModel(TranscriptionProvider model) {
     QString modelPath = getModelPath(model);
     if (!modelPath.isEmpty() && QFile::exists(modelPath)) {
@@ -213,7 +646,29 @@ QStringList TranscriptionService::getSupportedLanguages() const {
 }
 
 QString TranscriptionService::detectLanguage(const QString& audioFilePath) {
-    return detectLanguageFromAudio(audioFilePath);
+    QFuture<QString> future = detectLanguageAsync(audioFilePath);
+    if (!future.isFinished() && QThread::currentThread() == thread() && !residentModel(m_currentProvider)) {
+        // Waiting here would deadlock: the load it waits for finishes on this thread
+        qWarning() << "Language detection needs the model loaded first; using the default language";
+        return m_defaultLanguage;
+    }
+    return future.result();
+}
+
+QFuture<QString> TranscriptionService::detectLanguageAsync(const QString& audioFilePath) {
+    auto promise = std::make_shared<QPromise<QString>>();
+    QFuture<QString> future = promise->future();
+    promise->start();
+    
+    const TranscriptionProvider provider = m_currentProvider;
+    if (QThread::currentThread() == thread()) {
+        startLanguageDetection(provider, promise, audioFilePath);
+    } else {
+        QMetaObject::invokeMethod(this, [this, provider, promise, audioFilePath]() {
+            startLanguageDetection(provider, promise, audioFilePath);
+        }, Qt::QueuedConnection);
+    }
+    return future;
 }
 
 void TranscriptionService::setDefaultLanguage(const QString& languageCode) {
@@ -225,13 +680,16 @@ void TranscriptionService::setDefaultLanguage(const QString& languageCode) {
 }
 
 QString TranscriptionService::submitTranscription(const TranscriptionRequest& request) {
-    // Validate request
-    if (request.audioFilePath.isEmpty() || !QFile::exists(request.audioFilePath)) {
+    // Validate request; in-memory audio skips the file checks entirely
+    if (!request.audioBuffer.isEmpty()) {
+        if (request.audioBuffer.sampleRate <= 0) {
+            setError(TranscriptionError::AudioFormatError, "Invalid sample rate for in-memory audio");
+            return QString();
+        }
+    } else if (request.audioFilePath.isEmpty() || !QFile::exists(request.audioFilePath)) {
         setError(TranscriptionError::InvalidAudioFile, "Audio file not found: " + request.audioFilePath);
         return QString();
-    }
-    
-    if (!isFormatSupported(QFileInfo(request.audioFilePath).suffix())) {
+    } else if (!isFormatSupported(QFileInfo(request.audioFilePath).suffix())) {
         setError(TranscriptionError::AudioFormatError, "Unsupported audio format");
         return QString();
     }
@@ -253,30 +711,44 @@ QString TranscriptionService::submitTranscription(const TranscriptionRequest& re
     // Create request info
     RequestInfo info;
     info.request = request;
+    info.request.preferredProvider = provider;
+    info.detectLanguage = !applyCachedLanguage(info.request);
     info.status = TranscriptionStatus::Pending;
     info.hasResult = false;
+    info.abortFlag.reset(new QAtomicInt(0));
     info.timer.start();
     
+    // The content hash and the result cache lookup happen in the task, on a pool thread.
+    // The same audio already queued or decoding is joined rather than decoded twice.
+    const bool useCache = request.options.value("useCache").toBool(true);
+    const QByteArray flight = useCache ? flightKey(info.request, info.cacheKey) : QByteArray();
     {
         QMutexLocker locker(&m_requestsMutex);
-        m_activeRequests[requestId] = info;
-        
-        // Check if we can process immediately or need to queue
-        if (m_activeRequests.size() <= m_maxConcurrentRequests) {
-            setRequestStatus(requestId, TranscriptionStatus::Processing);
+        auto leader = flight.isEmpty() ? m_activeRequests.end() : m_activeRequests.find(m_inFlight.value(flight));
+        if (leader != m_activeRequests.end()) {
+            info.leaderId = leader.key();
+            leader->followers.append(requestId);
+            m_activeRequests[requestId] = info;
+        } else {
+            info.flightKey = flight;
+            m_activeRequests[requestId] = info;
             
-            // Process in thread pool
-            QTimer::singleShot(0, this, [this, request, requestId]() {
-                TranscriptionResult result = processWithWhisper(request, requestId);
-                if (result.id.isEmpty()) {
-                    // Error occurred
-                    handleTaskFailed(requestId, m_lastError, m_errorString);
-                } else {
-                    handleTaskCompleted(requestId, result);
+            // Check if we can process immediately or need to queue
+            if (m_runningTasks < m_maxConcurrentRequests) {
+                const TaskStart start = startTranscriptionTask(requestId);
+                if (start == TaskStart::Failed) {
+                    m_activeRequests.remove(requestId);
+                    return QString();
                 }
-            });
-        } else {
-            m_pendingRequests.enqueue(requestId);
+                if (start == TaskStart::AwaitingModel) {
+                    enqueuePendingRequest(requestId);
+                }
+            } else {
+                enqueuePendingRequest(requestId);
+            }
+            if (!flight.isEmpty()) {
+                m_inFlight.insert(flight, requestId);
+            }
         }
     }
     
@@ -284,33 +756,187 @@ QString TranscriptionService::submitTranscription(const TranscriptionRequest& re
     return requestId;
 }
 
-void TranscriptionService::cancelTranscription(const QString& requestId) {
-    QMutexLocker locker(&m_requestsMutex);
+QByteArray TranscriptionService::flightKey(const TranscriptionRequest& request, const QByteArray& cacheKey) const {
+    // The content key when the audio is already at hand; otherwise the file as it is on disk
+    if (!cacheKey.isEmpty()) {
+        return cacheKey;
+    }
+    const QByteArray parametersKey = cacheParametersKey(request);
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!request.audioBuffer.isEmpty()) {
+        // One shared buffer submitted twice, recognized without reading the samples; equal
+        // copies meet in the result cache instead. The leader holds a reference, so the
+        // address cannot be reused while it is registered.
+        const quintptr data = reinterpret_cast<quintptr>(request.audioBuffer.samples.constData());
+        hash.addData(QByteArray::number(static_cast<qulonglong>(data)) + '|' +
+                     QByteArray::number(request.audioBuffer.samples.size()) + '|' +
+                     QByteArray::number(request.audioBuffer.sampleRate) + '|');
+        hash.addData(parametersKey);
+        return hash.result();
+    }
     
-    if (m_activeRequests.contains(requestId)) {
-        RequestInfo& info = m_activeRequests[requestId];
-        if (info.status == TranscriptionStatus::Pending || info.status == TranscriptionStatus::Processing) {
+    const QFileInfo file(request.audioFilePath);
+    hash.addData(file.canonicalFilePath().toUtf8() + '\0');
+    hash.addData(QByteArray::number(file.size()) + '|' +
+                 QByteArray::number(file.lastModified().toMSecsSinceEpoch()) + '|');
+    hash.addData(parametersKey);
+    return hash.result();
+}
+
+QStringList TranscriptionService::subscribersLocked(const QString& requestId) const {
+    const auto it = m_activeRequests.constFind(requestId);
+    if (it == m_activeRequests.cend()) {
+        return QStringList();
+    }
+    QStringList subscribers = it->followers;
+    if (!it->detached) {
+        subscribers.prepend(requestId);
+    }
+    return subscribers;
+}
+
+QStringList TranscriptionService::takeFollowersLocked(const QString& requestId) {
+    auto it = m_activeRequests.find(requestId);
+    if (it == m_activeRequests.end()) {
+        return QStringList();
+    }
+    if (!it->flightKey.isEmpty() && m_inFlight.value(it->flightKey) == requestId) {
+        m_inFlight.remove(it->flightKey);
+    }
+    const QStringList followers = it->followers;
+    it->followers.clear();
+    return followers;
+}
+
+void TranscriptionService::completeFollowers(const QStringList& followers, const TranscriptionResult* result,
+                                             TranscriptionError error, const QString& errorMessage) {
+    for (const QString& followerId : followers) {
+        TranscriptionResult followerResult;
+        QString batchId;
+        QString segmentedSessionId;
+        {
+            QMutexLocker locker(&m_requestsMutex);
+            auto it = m_activeRequests.find(followerId);
+            if (it == m_activeRequests.end() || it->status != TranscriptionStatus::Pending) {
+                continue;
+            }
+            batchId = it->batchId;
+            segmentedSessionId = it->segmentedSessionId;
+            if (result) {
+                followerResult = *result;
+                followerResult.id = followerId;
+                setRequestResult(followerId, followerResult);
+                setRequestStatus(followerId, TranscriptionStatus::Completed);
+            } else {
+                setRequestStatus(followerId, TranscriptionStatus::Failed);
+            }
+            it->request.audioBuffer = AudioSampleBuffer();
+        }
+        
+        // Reported exactly as if the follower had been decoded itself
+        if (!segmentedSessionId.isEmpty()) {
+            handleSegmentResult(segmentedSessionId, followerId, result ? &followerResult : nullptr);
+        } else if (result) {
+            saveRequestTranscriptionToStorage(followerId, followerResult);
+            emit transcriptionCompleted(followerId, followerResult);
+            updateBatchProgress(batchId, true, followerResult.metadata.value("audioDurationMs").toVariant().toLongLong());
+        } else {
+            emit transcriptionFailed(followerId, error, errorMessage);
+            updateBatchProgress(batchId, false, 0);
+        }
+    }
+}
+
+void TranscriptionService::cancelTranscription(const QString& requestId) {
+    QString pendingBatchId;
+    QString followerBatchId;
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        
+        auto it = m_activeRequests.find(requestId);
+        if (it == m_activeRequests.end()) {
+            return;
+        }
+        
+        RequestInfo& info = it.value();
+        if (!info.leaderId.isEmpty()) {
+            // A follower only stops listening; the decode goes on while others wait for it
+            if (info.status != TranscriptionStatus::Pending) {
+                return;
+            }
             info.status = TranscriptionStatus::Cancelled;
+            followerBatchId = info.batchId;
+            const QString leaderId = info.leaderId;
+            emit transcriptionCancelled(requestId);
+            
+            auto leader = m_activeRequests.find(leaderId);
+            if (leader != m_activeRequests.end()) {
+                leader->followers.removeAll(requestId);
+                if (leader->detached && leader->followers.isEmpty()) {
+                    stopRequestLocked(leaderId, &pendingBatchId);
+                }
+            }
+        } else if (!info.followers.isEmpty()) {
+            if (info.status != TranscriptionStatus::Pending && info.status != TranscriptionStatus::Processing) {
+                return;
+            }
+            // Counted in its batch once the decode reports back
+            info.detached = true;
+            emit transcriptionCancelled(requestId);
+        } else {
+            if (!stopRequestLocked(requestId, &pendingBatchId)) {
+                return;
+            }
             emit transcriptionCancelled(requestId);
         }
     }
     
-    // Remove from pending queue
-    QQueue<QString> newQueue;
-    while (!m_pendingRequests.isEmpty()) {
-        QString id = m_pendingRequests.dequeue();
-        if (id != requestId) {
-            newQueue.enqueue(id);
-        }
+    // Running requests are counted once their task reports back
+    updateBatchProgress(followerBatchId, false, 0);
+    updateBatchProgress(pendingBatchId, false, 0);
+}
+
+bool TranscriptionService::stopRequestLocked(const QString& requestId, QString* pendingBatchId) {
+    auto it = m_activeRequests.find(requestId);
+    if (it == m_activeRequests.end()) {
+        return false;
+    }
+    
+    RequestInfo& info = it.value();
+    if (info.status == TranscriptionStatus::Pending) {
+        // The queue entry is skipped when it reaches the front
+        --m_pendingCount;
+        *pendingBatchId = info.batchId;
+    } else if (info.status == TranscriptionStatus::Processing) {
+        // Running decodes stop at whisper's next abort check and report back as failed,
+        // which the completion handlers ignore for cancelled requests
+        info.abortFlag->storeRelaxed(1);
+    } else {
+        return false;
+    }
+    
+    info.status = TranscriptionStatus::Cancelled;
+    info.request.audioBuffer = AudioSampleBuffer(); // Drop prefetched audio
+    if (!info.flightKey.isEmpty() && m_inFlight.value(info.flightKey) == requestId) {
+        m_inFlight.remove(info.flightKey);
     }
-    m_pendingRequests = newQueue;
+    return true;
 }
 
 TranscriptionStatus TranscriptionService::getTranscriptionStatus(const QString& requestId) const {
     QMutexLocker locker(&m_requestsMutex);
     
-    if (m_activeRequests.contains(requestId)) {
-        return m_activeRequests.value(requestId).status;
+    const auto it = m_activeRequests.constFind(requestId);
+    if (it != m_activeRequests.cend()) {
+        if (it->detached) {
+            return TranscriptionStatus::Cancelled;
+        }
+        // A waiting follower is as far along as its leader
+        const auto leader = m_activeRequests.constFind(it->leaderId);
+        if (it->status == TranscriptionStatus::Pending && leader != m_activeRequests.cend()) {
+            return leader->status;
+        }
+        return it->status;
     }
     
     return TranscriptionStatus::Failed;
@@ -329,65 +955,576 @@ TranscriptionResult TranscriptionService::getTranscriptionResult(const QString&
     return TranscriptionResult();
 }
 
-QStringList TranscriptionService::submitBatchTranscription(const QList<TranscriptionRequest>& requests) {
-    QStringList requestIds;
+QString TranscriptionService::startStreamingTranscription(const TranscriptionRequest& request) {
+    TranscriptionProvider provider = request.preferredProvider;
+    if (provider == TranscriptionProvider::Unknown) {
+        provider = m_currentProvider;
+    }
     
-    for (const auto& request : requests) {
-        QString requestId = submitTranscription(request);
-        if (!requestId.isEmpty()) {
-            requestIds.append(requestId);
-        }
+    if (!isProviderAvailable(provider)) {
+        setError(TranscriptionError::ModelNotFound, "Provider not available");
+        return QString();
+    }
+    // Audio is buffered while the model loads; the first window is decoded once it is ready
+    if (!residentModel(provider)) {
+        requestModelLoad(provider);
     }
     
-    return requestIds;
+    StreamingSession session;
+    session.request = request;
+    session.request.preferredProvider = provider;
+    applyCachedLanguage(session.request);
+    session.format.sampleRate = request.options.value("sampleRate").toInt(AudioFileReader::TARGET_SAMPLE_RATE);
+    session.format.channelCount = request.options.value("channelCount").toInt(1);
+    session.format.bytesPerSample = request.options.value("bytesPerSample").toInt(2);
+    session.format.isFloat = request.options.value("isFloat").toBool(false);
+    session.timer.start();
+    
+    const QString streamId = generateRequestId();
+    m_streams.insert(streamId, session);
+    
+    emit transcriptionStarted(streamId, provider);
+    return streamId;
 }
 
-QList<TranscriptionResult> TranscriptionService::getBatchResults(const QStringList& requestIds) const {
-    QList<TranscriptionResult> results;
+void TranscriptionService::appendStreamingAudio(const QString& streamId, const QByteArray& pcmData) {
+    auto it = m_streams.find(streamId);
+    if (it == m_streams.end() || it->finishing || pcmData.isEmpty()) {
+        return;
+    }
     
-    for (const auto& requestId : requestIds) {
-        TranscriptionResult result = getTranscriptionResult(requestId);
-        if (!result.id.isEmpty()) {
-            results.append(result);
-        }
+    QVector<float> samples = AudioFileReader::convertToFloat(pcmData.constData(), pcmData.size(), it->format);
+    if (it->format.sampleRate != AudioFileReader::TARGET_SAMPLE_RATE) {
+        samples = AudioFileReader::resample(samples, it->format.sampleRate, AudioFileReader::TARGET_SAMPLE_RATE);
     }
+    it->pending += samples;
     
-    return results;
-}
-
-void TranscriptionService::setMaxConcurrentRequests(int maxRequests) {
-    m_maxConcurrentRequests = qMax(1, maxRequests);
-}
-
-void TranscriptionService::setTimeout(int timeoutMs) {
-    m_timeoutMs = qMax(1000, timeoutMs);
+    scheduleStreamWindow(streamId);
 }
 
-void TranscriptionService::setThreadCount(int threadCount) {
-    m_threadPool->setMaxThreadCount(qMax(1, threadCount));
+void TranscriptionService::finishStreamingTranscription(const QString& streamId) {
+    auto it = m_streams.find(streamId);
+    if (it == m_streams.end() || it->finishing) {
+        return;
+    }
+    
+    it->finishing = true;
+    scheduleStreamWindow(streamId);
 }
 
-double TranscriptionService::getProviderAccuracy(TranscriptionProvider provider) const {
-    return m_accuracyRatings.value(provider, 0.95); // Default to 95%
+void TranscriptionService::cancelStreamingTranscription(const QString& streamId) {
+    auto it = m_streams.find(streamId);
+    if (it == m_streams.end()) {
+        return;
+    }
+    
+    if (it->decodeInFlight) {
+        // The worker still owns the leased state; drop the session when it reports back
+        it->finishing = true;
+        it->cancelled = true;
+    } else {
+        m_streams.erase(it);
+    }
+    emit transcriptionCancelled(streamId);
 }
 
-qint64 TranscriptionService::getAverageProcessingTime(TranscriptionProvider provider) const {
-    const auto& times = m_processingTimes.value(provider);
-    if (times.isEmpty()) {
-        return 0;
+void TranscriptionService::scheduleStreamWindow(const QString& streamId) {
+    auto it = m_streams.find(streamId);
+    if (it == m_streams.end() || it->decodeInFlight) {
+        return;
     }
     
-    qint64 sum = 0;
-    for (qint64 time : times) {
-        sum += time;
+    StreamingSession& session = it.value();
+    const int samplesPerMs = AudioFileReader::TARGET_SAMPLE_RATE / 1000;
+    const int newSamples = static_cast<int>(session.pending.size()) - session.decodedSamples;
+    
+    if (!session.finishing && newSamples < STREAM_STEP_MS * samplesPerMs) {
+        return;
     }
     
-    return sum / times.size();
-}
-
-int TranscriptionService::getQueueLength() const {
-    QMutexLocker locker(&m_requestsMutex);
-    return m_pendingRequests.size();
+    if (session.finishing && session.pending.size() < STREAM_MIN_DECODE_MS * samplesPerMs) {
+        completeStream(streamId);
+        return;
+    }
+    
+    const TranscriptionProvider provider = session.request.preferredProvider;
+    whisper_context* ctx = residentModel(provider);
+    if (!ctx) {
+        // handleModelReady() schedules the window again
+        requestModelLoad(provider);
+        return;
+    }
+    session.state = acquireWhisperState(provider, ctx);
+    if (!session.state) {
+        emit transcriptionFailed(streamId, m_lastError, m_errorString);
+        m_streams.erase(it);
+        return;
+    }
+    
+    auto* task = new TranscriptionTask(session.request, streamId, ctx, session.state, threadCountFor(provider));
+    task->setSamples(session.pending);
+    task->setInitialPrompt(session.finalizedText.right(STREAM_PROMPT_CHARS));
+    task->setTelemetry(m_telemetry);
+    int timeoutBaseMs = 0;
+    double timeoutPerAudioMs = 0.0;
+    timeoutFor(session.request, &timeoutBaseMs, &timeoutPerAudioMs);
+    task->setTimeout(timeoutBaseMs, timeoutPerAudioMs);
+    connect(task, &TranscriptionTask::taskCompleted, this, &TranscriptionService::handleStreamWindowDecoded, Qt::QueuedConnection);
+    connect(task, &TranscriptionTask::taskFailed, this, &TranscriptionService::handleStreamWindowFailed, Qt::QueuedConnection);
+    
+    session.decodedSamples = static_cast<int>(session.pending.size());
+    session.decodeInFlight = true;
+    m_threadPool->start(task, poolPriority(TranscriptionPriority::Interactive));
+}
+
+void TranscriptionService::handleStreamWindowDecoded(const QString& streamId, const TranscriptionResult& result) {
+    auto it = m_streams.find(streamId);
+    if (it == m_streams.end()) {
+        return;
+    }
+    
+    StreamingSession& session = it.value();
+    releaseWhisperState(session.request.preferredProvider, session.state);
+    session.state = nullptr;
+    session.decodeInFlight = false;
+    
+    if (session.cancelled) {
+        m_streams.erase(it);
+        return;
+    }
+    
+    // The first window settles the language for the rest of the stream
+    if (TranscriptionTask::isAutoLanguage(session.request.language) && !result.language.isEmpty()) {
+        session.request.language = result.language;
+        rememberDetectedLanguage(session.request, result.language);
+    }
+    
+    const int samplesPerMs = AudioFileReader::TARGET_SAMPLE_RATE / 1000;
+    const qint64 windowStartMs = session.windowStartSample / samplesPerMs;
+    const qint64 windowMs = session.decodedSamples / samplesPerMs;
+    
+    // Segments ending inside the overlap tail may still change once more audio arrives,
+    // unless the stream is finishing or the window has grown too long to hold back
+    const bool commitAll = session.finishing || windowMs >= STREAM_MAX_WINDOW_MS;
+    const qint64 commitLimitMs = commitAll ? windowMs : windowMs - STREAM_OVERLAP_MS;
+    
+    qint64 committedMs = 0;
+    QStringList partialText;
+    qint64 partialStartMs = -1;
+    qint64 partialEndMs = 0;
+    
+    const QJsonArray segments = result.metadata.value("segmentTimings").toArray();
+    for (const QJsonValue& value : segments) {
+        const QJsonObject segment = value.toObject();
+        const qint64 startMs = qRound64(segment.value("startTime").toDouble() * 1000.0);
+        const qint64 endMs = qMin(windowMs, qRound64(segment.value("endTime").toDouble() * 1000.0));
+        const QString text = segment.value("text").toString();
+        
+        if (partialStartMs < 0 && endMs <= commitLimitMs) {
+            if (!text.isEmpty()) {
+                session.finalizedText += (session.finalizedText.isEmpty() ? "" : " ") + text;
+                emit segmentFinalized(streamId, text, windowStartMs + startMs, windowStartMs + endMs);
+            }
+            committedMs = endMs;
+        } else {
+            if (partialStartMs < 0) {
+                partialStartMs = startMs;
+            }
+            partialEndMs = endMs;
+            partialText.append(text);
+        }
+    }
+    
+    if (commitAll) {
+        committedMs = windowMs; // Nothing is held back, trailing silence included
+    }
+    
+    // Keep word timings of committed segments, shifted onto the stream timeline
+    for (const QJsonValue& value : result.wordTimestamps) {
+        QJsonObject word = value.toObject();
+        if (word.value("endTime").toDouble() * 1000.0 > committedMs) {
+            continue;
+        }
+        word["startTime"] = word.value("startTime").toDouble() + windowStartMs / 1000.0;
+        word["endTime"] = word.value("endTime").toDouble() + windowStartMs / 1000.0;
+        session.finalizedWords.append(word);
+    }
+    
+    if (!partialText.isEmpty()) {
+        emit partialTranscription(streamId, partialText.join(' ').trimmed(),
+                                  windowStartMs + partialStartMs, windowStartMs + partialEndMs);
+    }
+    
+    // Slide the window past the committed audio
+    const int dropSamples = static_cast<int>(qBound<qint64>(0, committedMs * samplesPerMs, session.pending.size()));
+    session.pending.remove(0, dropSamples);
+    session.windowStartSample += dropSamples;
+    session.decodedSamples = qMax(0, session.decodedSamples - dropSamples);
+    
+    if (session.finishing && session.pending.isEmpty()) {
+        completeStream(streamId);
+        return;
+    }
+    
+    // Audio that arrived during the decode (or the final leftover) gets the next window
+    scheduleStreamWindow(streamId);
+}
+
+void TranscriptionService::handleStreamWindowFailed(const QString& streamId, TranscriptionError error, const QString& errorMessage) {
+    auto it = m_streams.find(streamId);
+    if (it == m_streams.end()) {
+        return;
+    }
+    
+    releaseWhisperState(it->request.preferredProvider, it->state);
+    const bool cancelled = it->cancelled;
+    m_streams.erase(it);
+    
+    if (!cancelled) {
+        setError(error, errorMessage);
+        emit transcriptionFailed(streamId, error, errorMessage);
+    }
+}
+
+void TranscriptionService::completeStream(const QString& streamId) {
+    StreamingSession session = m_streams.take(streamId);
+    
+    TranscriptionResult result;
+    result.id = streamId;
+    result.text = session.finalizedText;
+    result.provider = session.request.preferredProvider;
+    result.language = TranscriptionTask::isAutoLanguage(session.request.language) ? m_defaultLanguage : session.request.language;
+    result.processingTime = session.timer.elapsed();
+    result.wordTimestamps = session.finalizedWords;
+    result.metadata["streaming"] = true;
+    result.metadata["audioDurationMs"] = session.windowStartSample * 1000 / AudioFileReader::TARGET_SAMPLE_RATE;
+    
+    double confidenceSum = 0.0;
+    for (const QJsonValue& word : session.finalizedWords) {
+        confidenceSum += word.toObject().value("confidence").toDouble();
+    }
+    result.confidence = session.finalizedWords.isEmpty() ? 0.0 : confidenceSum / session.finalizedWords.size();
+    
+    emit streamingTranscriptionFinished(streamId, result);
+}
+
+QString TranscriptionService::startSegmentedTranscription(const TranscriptionRequest& request) {
+    TranscriptionProvider provider = request.preferredProvider;
+    if (provider == TranscriptionProvider::Unknown) {
+        provider = m_currentProvider;
+    }
+    
+    if (!isProviderAvailable(provider)) {
+        setError(TranscriptionError::ModelNotFound, "Provider not available");
+        return QString();
+    }
+    
+    SegmentedSession session;
+    session.request = request;
+    session.request.preferredProvider = provider;
+    session.timer.start();
+    
+    const QString sessionId = generateRequestId();
+    m_segmentedSessions.insert(sessionId, session);
+    
+    // Load the model now so the first segment does not wait for it
+    preloadModel(provider);
+    
+    emit transcriptionStarted(sessionId, provider);
+    return sessionId;
+}
+
+bool TranscriptionService::appendTranscriptionSegment(const QString& sessionId, const QString& segmentPath, qint64 startMs) {
+    auto it = m_segmentedSessions.find(sessionId);
+    if (it == m_segmentedSessions.end() || it->finishing) {
+        return false;
+    }
+    
+    TranscriptionRequest request = it->request;
+    request.audioFilePath = segmentPath;
+    QString errorMessage;
+    if (!AudioFileReader::readSamples(segmentPath, request.audioBuffer.samples, &errorMessage)) {
+        setError(TranscriptionError::InvalidAudioFile, errorMessage);
+        qWarning() << "Cannot read recording segment" << segmentPath << ":" << errorMessage;
+        return false;
+    }
+    request.audioBuffer.sampleRate = AudioFileReader::TARGET_SAMPLE_RATE;
+    
+    const QString requestId = submitTranscription(request);
+    if (requestId.isEmpty()) {
+        return false;
+    }
+    
+    // Completions are queued to this thread, so none can arrive before the tag is set
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        m_activeRequests[requestId].segmentedSessionId = sessionId;
+    }
+    it = m_segmentedSessions.find(sessionId);
+    it->requestIds.append(requestId);
+    it->segmentStartMs.append(startMs);
+    return true;
+}
+
+void TranscriptionService::finishSegmentedTranscription(const QString& sessionId) {
+    auto it = m_segmentedSessions.find(sessionId);
+    if (it == m_segmentedSessions.end() || it->finishing) {
+        return;
+    }
+    
+    it->finishing = true;
+    if (it->nextToReport == it->requestIds.size()) {
+        completeSegmentedSession(sessionId);
+    }
+}
+
+void TranscriptionService::cancelSegmentedTranscription(const QString& sessionId) {
+    auto it = m_segmentedSessions.find(sessionId);
+    if (it == m_segmentedSessions.end()) {
+        return;
+    }
+    
+    const QStringList requestIds = it->requestIds;
+    m_segmentedSessions.erase(it);
+    for (const QString& requestId : requestIds) {
+        cancelTranscription(requestId);
+    }
+    emit transcriptionCancelled(sessionId);
+}
+
+void TranscriptionService::handleSegmentResult(const QString& sessionId, const QString& requestId,
+                                               const TranscriptionResult* result) {
+    auto it = m_segmentedSessions.find(sessionId);
+    if (it == m_segmentedSessions.end()) {
+        return; // Cancelled meanwhile
+    }
+    
+    SegmentedSession& session = it.value();
+    if (result) {
+        session.results.insert(requestId, *result);
+    } else {
+        ++session.failedSegments;
+        session.results.insert(requestId, TranscriptionResult());
+    }
+    
+    // Segments can finish out of order when several decode at once; report in recording order
+    while (session.nextToReport < session.requestIds.size() &&
+           session.results.contains(session.requestIds.at(session.nextToReport))) {
+        TranscriptionResult segment = session.results.take(session.requestIds.at(session.nextToReport));
+        const qint64 offsetMs = session.segmentStartMs.at(session.nextToReport);
+        ++session.nextToReport;
+        
+        const QJsonArray timings = segment.metadata.value("segmentTimings").toArray();
+        for (const QJsonValue& value : timings) {
+            const QJsonObject timing = value.toObject();
+            const QString text = timing.value("text").toString();
+            if (!text.isEmpty()) {
+                emit segmentFinalized(sessionId, text, offsetMs + qRound64(timing.value("startTime").toDouble() * 1000.0),
+                                      offsetMs + qRound64(timing.value("endTime").toDouble() * 1000.0));
+            }
+        }
+        if (timings.isEmpty() && !segment.text.isEmpty()) {
+            emit segmentFinalized(sessionId, segment.text, offsetMs,
+                                  offsetMs + segment.metadata.value("audioDurationMs").toVariant().toLongLong());
+        }
+        
+        // Word timings move onto the recording timeline for the merged result
+        QJsonArray words;
+        for (const QJsonValue& value : segment.wordTimestamps) {
+            QJsonObject word = value.toObject();
+            word["startTime"] = word.value("startTime").toDouble() + offsetMs / 1000.0;
+            word["endTime"] = word.value("endTime").toDouble() + offsetMs / 1000.0;
+            words.append(word);
+        }
+        segment.wordTimestamps = words;
+        segment.metadata["segmentStartMs"] = offsetMs;
+        session.reported.append(segment);
+    }
+    
+    if (session.finishing && session.nextToReport == session.requestIds.size()) {
+        completeSegmentedSession(sessionId);
+    }
+}
+
+void TranscriptionService::completeSegmentedSession(const QString& sessionId) {
+    SegmentedSession session = m_segmentedSessions.take(sessionId);
+    
+    TranscriptionResult result;
+    result.id = sessionId;
+    result.provider = session.request.preferredProvider;
+    result.processingTime = session.timer.elapsed();
+    result.confidence = 0.0;
+    
+    QStringList texts;
+    qint64 audioDurationMs = 0;
+    double confidenceSum = 0.0;
+    int decodedSegments = 0;
+    for (const TranscriptionResult& segment : session.reported) {
+        if (!segment.text.trimmed().isEmpty()) {
+            texts.append(segment.text.trimmed());
+        }
+        for (const QJsonValue& word : segment.wordTimestamps) {
+            result.wordTimestamps.append(word);
+        }
+        if (result.language.isEmpty()) {
+            result.language = segment.language;
+        }
+        if (!segment.id.isEmpty()) { // Failed segments are empty placeholders
+            confidenceSum += segment.confidence;
+            ++decodedSegments;
+        }
+        audioDurationMs = qMax(audioDurationMs, segment.metadata.value("segmentStartMs").toVariant().toLongLong() +
+                                                    segment.metadata.value("audioDurationMs").toVariant().toLongLong());
+    }
+    result.text = texts.join(' ');
+    result.confidence = decodedSegments > 0 ? confidenceSum / decodedSegments : 0.0;
+    if (result.language.isEmpty()) {
+        result.language = TranscriptionTask::isAutoLanguage(session.request.language) ? m_defaultLanguage
+                                                                                       : session.request.language;
+    }
+    result.metadata["segmented"] = true;
+    result.metadata["segmentCount"] = session.requestIds.size();
+    result.metadata["failedSegments"] = session.failedSegments;
+    result.metadata["audioDurationMs"] = audioDurationMs;
+    
+    saveTranscriptionToStorage(session.request.options.value("recordingId").toString(), result);
+    emit streamingTranscriptionFinished(sessionId, result);
+}
+
+QStringList TranscriptionService::submitBatchTranscription(const QList<TranscriptionRequest>& requests) {
+    // Group by model so each is loaded once and its warm states are reused across items;
+    // models that are already resident go first
+    QList<TranscriptionProvider> modelOrder;
+    QMap<TranscriptionProvider, QList<int>> groups;
+    for (int i = 0; i < requests.size(); ++i) {
+        TranscriptionProvider provider = requests.at(i).preferredProvider;
+        if (provider == TranscriptionProvider::Unknown) {
+            provider = m_currentProvider;
+        }
+        if (!groups.contains(provider)) {
+            if (isWhisperModelLoaded(provider)) {
+                modelOrder.prepend(provider);
+            } else {
+                modelOrder.append(provider);
+            }
+        }
+        groups[provider].append(i);
+    }
+    
+    const QString batchId = generateRequestId();
+    QVector<QString> idsByIndex(requests.size());
+    int submitted = 0;
+    
+    for (TranscriptionProvider provider : modelOrder) {
+        for (int index : groups.value(provider)) {
+            TranscriptionRequest request = requests.at(index);
+            request.preferredProvider = provider;
+            // Batch work must not hold up dictation unless the caller asked for it
+            if (request.priority == TranscriptionPriority::Normal) {
+                request.priority = TranscriptionPriority::Background;
+            }
+            
+            const QString requestId = submitTranscription(request);
+            if (requestId.isEmpty()) {
+                continue;
+            }
+            
+            // Completions are queued to this thread, so none can arrive before the tag is set
+            QMutexLocker locker(&m_requestsMutex);
+            m_activeRequests[requestId].batchId = batchId;
+            idsByIndex[index] = requestId;
+            ++submitted;
+        }
+    }
+    
+    if (submitted > 0) {
+        BatchInfo batch;
+        batch.total = submitted;
+        batch.timer.start();
+        m_batches.insert(batchId, batch);
+        prefetchPendingAudio();
+    }
+    
+    // Ids keep the caller's order, whatever order the items run in
+    QStringList requestIds;
+    for (const QString& requestId : idsByIndex) {
+        if (!requestId.isEmpty()) {
+            requestIds.append(requestId);
+        }
+    }
+    return requestIds;
+}
+
+QString TranscriptionService::getBatchId(const QString& requestId) const {
+    QMutexLocker locker(&m_requestsMutex);
+    return m_activeRequests.value(requestId).batchId;
+}
+
+QList<TranscriptionResult> TranscriptionService::getBatchResults(const QStringList& requestIds) const {
+    QList<TranscriptionResult> results;
+    
+    for (const auto& requestId : requestIds) {
+        TranscriptionResult result = getTranscriptionResult(requestId);
+        if (!result.id.isEmpty()) {
+            results.append(result);
+        }
+    }
+    
+    return results;
+}
+
+void TranscriptionService::setMaxConcurrentRequests(int maxRequests) {
+    m_maxConcurrentRequests = qMax(1, maxRequests);
+    updateDecodeSlots();
+    trimStatePools();
+    processNextPendingRequest();
+}
+
+void TranscriptionService::setTimeout(int timeoutMs) {
+    m_timeoutMs = qMax(1000, timeoutMs);
+}
+
+void TranscriptionService::timeoutFor(const TranscriptionRequest& request, int* baseMs, double* perAudioMs) const {
+    if (request.timeoutMs >= 0) {
+        *baseMs = request.timeoutMs;
+        *perAudioMs = 0.0;
+    } else {
+        *baseMs = m_timeoutMs;
+        *perAudioMs = decodeAllowance(request.preferredProvider);
+    }
+}
+
+void TranscriptionService::setThreadCount(int threadCount) {
+    // Applies to decodes started after this call and overrides calibrated values
+    m_threadCount = qMax(1, threadCount);
+    m_threadCountOverridden = true;
+    updateDecodeSlots();
+    trimStatePools();
+}
+
+QThreadPool* TranscriptionService::getDecodePool() const {
+    return m_threadPool;
+}
+
+int TranscriptionService::getDecodeThreadCount() const {
+    return threadCountFor(m_currentProvider);
+}
+
+double TranscriptionService::getProviderAccuracy(TranscriptionProvider provider) const {
+    return m_accuracyRatings.value(provider, 0.95); // Default to 95%
+}
+
+qint64 TranscriptionService::getAverageProcessingTime(TranscriptionProvider provider) const {
+    return static_cast<qint64>(m_processingTimes.value(provider).mean());
+}
+
+qint64 TranscriptionService::getProcessingTimePercentile(TranscriptionProvider provider, double quantile) const {
+    return m_processingTimes.value(provider).percentile(quantile);
+}
+
+int TranscriptionService::getQueueLength() const {
+    QMutexLocker locker(&m_requestsMutex);
+    return m_pendingCount;
 }
 
 QStringList TranscriptionService::getSupportedFormats() const {
@@ -416,66 +1553,289 @@ void TranscriptionService::clearErrorState() {
 }
 
 void TranscriptionService::clearCache() {
-    // Whisper.cpp doesn't have a traditional cache to clear
-    // This could be used to clear temporary audio files if needed
-    qDebug() << "Cache cleared (whisper.cpp doesn't use cache)";
+    m_resultCache.clear();
+    qDebug() << "Transcription result cache cleared:" << m_resultCache.getDirectory();
 }
 
 void TranscriptionService::preloadModel(TranscriptionProvider model) {
-    if (isModelDownloaded(model)) {
-        loadWhisperModel(model);
+    if (!isModelDownloaded(model) || isWhisperModelLoaded(model)) {
+        return;
     }
+    
+    // Requests submitted during the warm-up wait for this load instead of starting their own
+    requestModelLoad(model);
+}
+
+void TranscriptionService::setModelMemoryBudget(qint64 bytes) {
+    QMutexLocker locker(&m_modelsMutex);
+    m_modelMemoryBudget = qMax<qint64>(0, bytes);
+    evictModelsLocked(TranscriptionProvider::Unknown, 0);
+}
+
+qint64 TranscriptionService::getModelMemoryBudget() const {
+    QMutexLocker locker(&m_modelsMutex);
+    return m_modelMemoryBudget;
+}
+
+qint64 TranscriptionService::getResidentModelBytes() const {
+    QMutexLocker locker(&m_modelsMutex);
+    qint64 total = 0;
+    for (qint64 bytes : m_residentBytes) {
+        total += bytes;
+    }
+    return total;
 }
 
 void TranscriptionService::handleTaskCompleted(const QString& requestId, const TranscriptionResult& result) {
+    bool cancelled = false;
+    TranscriptionRequest detectedFor;
+    bool languageDetected = false;
+    QString batchId;
+    QString segmentedSessionId;
+    QStringList followers;
+    bool detached = false;
     {
         QMutexLocker locker(&m_requestsMutex);
+        m_runningTasks = qMax(0, m_runningTasks - 1);
+        releaseRequestState(requestId);
         if (m_activeRequests.contains(requestId)) {
-            setRequestResult(requestId, result);
-            setRequestStatus(requestId, TranscriptionStatus::Completed);
+            RequestInfo& info = m_activeRequests[requestId];
+            batchId = info.batchId;
+            segmentedSessionId = info.segmentedSessionId;
+            cancelled = info.status == TranscriptionStatus::Cancelled;
+            if (!cancelled && info.detectLanguage && !result.language.isEmpty()) {
+                info.detectLanguage = false;
+                detectedFor = info.request;
+                languageDetected = true;
+            }
+            if (!cancelled) {
+                detached = info.detached;
+                followers = takeFollowersLocked(requestId);
+                setRequestResult(requestId, result);
+                setRequestStatus(requestId, TranscriptionStatus::Completed);
+            }
+            // The result outlives the request until cleanup; the PCM doesn't need to
+            info.request.audioBuffer = AudioSampleBuffer();
+        }
+    }
+    
+    if (cancelled) {
+        updateBatchProgress(batchId, false, 0);
+        processNextPendingRequest();
+        return;
+    }
+    
+    if (languageDetected) {
+        rememberDetectedLanguage(detectedFor, result.language);
+    }
+    
+    // Cache hits neither count towards decode timings nor need storing again
+    if (!result.metadata.value("cacheHit").toBool()) {
+        updateProcessingTime(result.provider, result.processingTime);
+        if (m_telemetry) {
+            m_telemetry->recordRealTimeFactor(QFileInfo(getModelFileName(result.provider)).completeBaseName(),
+                                              result.processingTime,
+                                              result.metadata.value("audioDurationMs").toVariant().toLongLong());
+        }
+        const QByteArray cacheKey = result.metadata.value("cacheKey").toString().toLatin1();
+        if (!cacheKey.isEmpty()) {
+            // The write, and pruning when it pushes the cache over budget, stay off this thread
+            m_prefetchPool->start([this, cacheKey, result]() { m_resultCache.store(cacheKey, result); });
         }
     }
     
+    completeFollowers(followers, &result, TranscriptionError::NoError, QString());
+    if (detached) {
+        updateBatchProgress(batchId, false, 0);
+        processNextPendingRequest();
+        return;
+    }
+    
+    // A segment is only part of a transcription; the session stores and reports the whole
+    if (!segmentedSessionId.isEmpty()) {
+        handleSegmentResult(segmentedSessionId, requestId, &result);
+        processNextPendingRequest();
+        return;
+    }
+    
     // Save transcription to storage
-    saveTranscriptionToStorage(requestId, result);
+    saveRequestTranscriptionToStorage(requestId, result);
     
     emit transcriptionCompleted(requestId, result);
+    updateBatchProgress(batchId, true, result.metadata.value("audioDurationMs").toVariant().toLongLong());
     
     // Process next pending request
     processNextPendingRequest();
 }
 
 void TranscriptionService::handleTaskFailed(const QString& requestId, TranscriptionError error, const QString& errorMessage) {
+    bool cancelled = false;
+    QString batchId;
+    QString segmentedSessionId;
+    QStringList followers;
+    bool detached = false;
     {
         QMutexLocker locker(&m_requestsMutex);
+        m_runningTasks = qMax(0, m_runningTasks - 1);
+        releaseRequestState(requestId);
         if (m_activeRequests.contains(requestId)) {
-            setRequestStatus(requestId, TranscriptionStatus::Failed);
+            RequestInfo& info = m_activeRequests[requestId];
+            batchId = info.batchId;
+            segmentedSessionId = info.segmentedSessionId;
+            cancelled = info.status == TranscriptionStatus::Cancelled;
+            if (!cancelled) {
+                detached = info.detached;
+                followers = takeFollowersLocked(requestId);
+                setRequestStatus(requestId, TranscriptionStatus::Failed);
+            }
+            info.request.audioBuffer = AudioSampleBuffer();
         }
     }
     
-    emit transcriptionFailed(requestId, error, errorMessage);
+    completeFollowers(followers, nullptr, error, errorMessage);
+    if (detached) {
+        setError(error, errorMessage);
+    } else if (!cancelled && !segmentedSessionId.isEmpty()) {
+        // One lost segment leaves a gap rather than failing the whole recording
+        setError(error, errorMessage);
+        qWarning() << "Segment transcription failed:" << errorMessage;
+        handleSegmentResult(segmentedSessionId, requestId, nullptr);
+    } else if (!cancelled) {
+        setError(error, errorMessage);
+        emit transcriptionFailed(requestId, error, errorMessage);
+    }
+    updateBatchProgress(batchId, false, 0);
     
     // Process next pending request
     processNextPendingRequest();
 }
 
 void TranscriptionService::handleTaskProgress(const QString& requestId, int progressPercent) {
-    emit transcriptionProgress(requestId, progressPercent);
+    QStringList subscribers;
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        subscribers = subscribersLocked(requestId);
+    }
+    for (const QString& id : std::as_const(subscribers)) {
+        emit transcriptionProgress(id, progressPercent);
+    }
+}
+
+void TranscriptionService::handleModelDownloadProgress(qint64 bytesReceived, qint64 bytesTotal) {
+    const TranscriptionProvider model = findDownloadByReply(qobject_cast<QNetworkReply*>(sender()));
+    if (model == TranscriptionProvider::Unknown) {
+        return;
+    }
+    
+    ModelDownload& download = m_downloads[model];
+    if (bytesTotal > 0) {
+        download.totalBytes = download.resumeOffset + bytesTotal;
+    }
+    
+    if (download.totalBytes > 0) {
+        int progress = static_cast<int>(((download.resumeOffset + bytesReceived) * 100) / download.totalBytes);
+        emit modelDownloadProgress(model, qBound(0, progress, 100));
+    }
 }
 
-void TranscriptionService::handleModelDownloadProgress() {
-    // Handle model download progress updates
+void TranscriptionService::handleModelDownloadReadyRead() {
     QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
-    if (reply) {
-        qint64 bytesReceived = reply->bytesAvailable();
-        qint64 bytesTotal = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+    const TranscriptionProvider model = findDownloadByReply(reply);
+    if (model == TranscriptionProvider::Unknown) {
+        return;
+    }
+    
+    ModelDownload& download = m_downloads[model];
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status != 200 && status != 206) {
+        return; // Error bodies and redirects are not model data
+    }
+    
+    if (status == 200 && download.resumeOffset > 0) {
+        // Server ignored the Range header; start the file and digest over
+        download.partFile->resize(0);
+        download.partFile->seek(0);
+        download.hash->reset();
+        download.resumeOffset = 0;
+    }
+    
+    const QByteArray chunk = reply->readAll();
+    if (download.partFile->write(chunk) != chunk.size()) {
+        reply->abort();
+        finishModelDownload(model, "Failed to write model file: " + download.partFile->errorString());
+        return;
+    }
+    download.hash->addData(chunk);
+}
+
+void TranscriptionService::handleModelDownloadFinished() {
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    const TranscriptionProvider model = findDownloadByReply(reply);
+    if (model == TranscriptionProvider::Unknown) {
+        if (reply) {
+            reply->deleteLater();
+        }
+        return;
+    }
+    
+    ModelDownload& download = m_downloads[model];
+    download.reply = nullptr;
+    reply->deleteLater();
+    
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->error() != QNetworkReply::NoError || (status != 200 && status != 206)) {
+        if (reply->error() == QNetworkReply::OperationCanceledError) {
+            return; // Aborted on purpose; whoever aborted already cleaned up
+        }
         
-        if (bytesTotal > 0) {
-            int progress = static_cast<int>((bytesReceived * 100) / bytesTotal);
-            // Emit progress signal based on which model is being downloaded
-            // This would need additional tracking to determine which model
+        if (status == 416) {
+            // Our .part no longer matches the remote file; start it over
+            download.partFile->resize(0);
+            download.partFile->seek(0);
+            download.hash->reset();
         }
+        
+        // Keep the .part file and resume from its end after a back-off
+        if (++download.retries <= MAX_DOWNLOAD_RETRIES && status != 404) {
+            const int delay = DOWNLOAD_RETRY_DELAY_MS << (download.retries - 1);
+            qWarning() << "Model download interrupted, retrying in" << delay << "ms:" << reply->errorString();
+            QTimer::singleShot(delay, this, [this, model]() { sendModelDownloadRequest(model); });
+            return;
+        }
+        
+        finishModelDownload(model, "Model download failed: " + reply->errorString());
+        return;
+    }
+    
+    download.partFile->flush();
+    const QByteArray digest = download.hash->result().toHex();
+    if (!download.expectedSha256.isEmpty() && digest != download.expectedSha256) {
+        download.partFile->remove();
+        finishModelDownload(model, "Model checksum mismatch");
+        return;
+    }
+    
+    // Move the verified file into place and record its digest for later integrity checks
+    const QString finalPath = QDir(getModelsDirectory()).absoluteFilePath(getModelFileName(model));
+    const qint64 size = download.partFile->size();
+    download.partFile->close();
+    QFile::remove(finalPath);
+    if (!download.partFile->rename(finalPath)) {
+        finishModelDownload(model, "Failed to move downloaded model into place");
+        return;
+    }
+    
+    QFile sidecar(finalPath + ".sha256");
+    if (sidecar.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        sidecar.write(digest + ' ' + QByteArray::number(size) + '\n');
     }
+    
+    {
+        QMutexLocker locker(&m_modelsMutex);
+        m_modelPaths[model] = finalPath;
+    }
+    
+    finishModelDownload(model, QString());
 }
 
 void TranscriptionService::cleanupCompletedTasks() {
@@ -488,8 +1848,9 @@ void TranscriptionService::cleanupCompletedTasks() {
             info.status == TranscriptionStatus::Failed ||
             info.status == TranscriptionStatus::Cancelled) {
             
-            // Keep completed requests for a while, then remove old ones
-            if (info.timer.elapsed() > 300000) { // 5 minutes
+            // Keep completed requests for a while, then remove old ones; a cancelled
+            // request stays until its in-flight chunks have returned their states
+            if (info.timer.elapsed() > 300000 && info.chunksInFlight == 0) { // 5 minutes
                 toRemove.append(it.key());
             }
         }
@@ -515,36 +1876,453 @@ void TranscriptionService::cleanupProvider(TranscriptionProvider provider) {
     unloadWhisperModel(provider);
 }
 
-whisper_context* TranscriptionService::loadWhisperModel(TranscriptionProvider provider) {
+whisper_context* TranscriptionService::loadWhisperModel(TranscriptionProvider provider, bool reportErrors) {
+    // Resolve the path first: getModelPath() takes m_modelsMutex itself
+    QString modelPath = getModelPath(provider);
+    
     QMutexLocker locker(&m_modelsMutex);
     
+    // A background preload of the same model finishes instead of loading it twice
+    while (m_loadingModels.contains(provider)) {
+        m_modelLoadFinished.wait(&m_modelsMutex);
+    }
+    
     if (m_loadedModels.contains(provider) && m_loadedModels.value(provider)) {
+        m_statePools[provider].unloadPending = false;
+        touchModelLocked(provider);
         return m_loadedModels.value(provider);
     }
     
-    QString modelPath = getModelPath(provider);
     if (modelPath.isEmpty()) {
-        setError(TranscriptionError::ModelNotFound, "Model file not found");
+        if (reportErrors) {
+            setError(TranscriptionError::ModelNotFound, "Model file not found");
+        }
         return nullptr;
     }
     
-    whisper_context_params params = whisper_context_default_params();
-    whisper_context* ctx = whisper_init_from_file_with_params(modelPath.toUtf8().constData(), params);
+    const qint64 footprint = QFileInfo(modelPath).size();
+    evictModelsLocked(provider, footprint);
+    m_loadingModels.append(provider);
+    
+    // Parse the weights without holding the lock; other models stay usable meanwhile
+    const bool useGpu = m_backendConfigs.value(provider).useGpu;
+    locker.unlock();
+    QElapsedTimer loadTimer;
+    loadTimer.start();
+    whisper_context* ctx = initWhisperContext(modelPath, useGpu);
+    const qint64 loadUs = loadTimer.nsecsElapsed() / 1000;
+    locker.relock();
+    
+    m_loadingModels.removeAll(provider);
+    m_modelLoadFinished.wakeAll();
+    
     if (!ctx) {
-        setError(TranscriptionError::ModelLoadError, "Failed to load whisper model");
+        if (reportErrors) {
+            setError(TranscriptionError::ModelLoadError, "Failed to load whisper model");
+        }
         return nullptr;
     }
     
     m_loadedModels[provider] = ctx;
+    m_residentBytes[provider] = footprint;
+    touchModelLocked(provider);
+    
+    if (m_telemetry) {
+        m_telemetry->recordStage(Telemetry::STAGE_MODEL_LOAD, loadUs);
+    }
+    QMetaObject::invokeMethod(this, [this, provider, loadUs]() {
+        emit modelReady(provider, loadUs / 1000);
+    }, Qt::QueuedConnection);
     return ctx;
 }
 
-void TranscriptionService::unloadWhisperModel(TranscriptionProvider provider) {
+whisper_context* TranscriptionService::residentModel(TranscriptionProvider provider) {
+    QMutexLocker locker(&m_modelsMutex);
+    whisper_context* ctx = m_loadingModels.contains(provider) ? nullptr : m_loadedModels.value(provider);
+    if (ctx) {
+        m_statePools[provider].unloadPending = false;
+        touchModelLocked(provider);
+    }
+    return ctx;
+}
+
+void TranscriptionService::requestModelLoad(TranscriptionProvider provider) {
+    if (m_requestedLoads.contains(provider)) {
+        return;
+    }
+    m_requestedLoads.append(provider);
+    
+    m_modelLoaderPool->start([this, provider]() {
+        const bool loaded = loadWhisperModel(provider, false) != nullptr;
+        // Queued behind modelReady; errors are reported on the GUI thread, which owns the error state
+        QMetaObject::invokeMethod(this, [this, provider, loaded]() {
+            if (loaded) {
+                handleModelReady(provider);
+            } else {
+                handleModelLoadFailed(provider);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void TranscriptionService::handleModelReady(TranscriptionProvider provider) {
+    m_requestedLoads.removeAll(provider);
+    
+    processNextPendingRequest();
+    dispatchChunks();
+    
+    for (const auto& detection : m_pendingDetections.take(provider)) {
+        startLanguageDetection(provider, detection.second, detection.first);
+    }
+    
+    QStringList streamIds;
+    for (auto it = m_streams.cbegin(); it != m_streams.cend(); ++it) {
+        if (it->request.preferredProvider == provider) {
+            streamIds.append(it.key());
+        }
+    }
+    for (const QString& streamId : std::as_const(streamIds)) {
+        scheduleStreamWindow(streamId);
+    }
+}
+
+void TranscriptionService::handleModelLoadFailed(TranscriptionProvider provider) {
+    m_requestedLoads.removeAll(provider);
+    setError(TranscriptionError::ModelLoadError, "Failed to load model: " + getModelFileName(provider));
+    
+    for (const auto& detection : m_pendingDetections.take(provider)) {
+        detection.second->addResult(m_defaultLanguage);
+        detection.second->finish();
+    }
+    
+    // Everything waiting for this model fails; requests for other models keep their places
+    QList<QPair<QString, QString>> failed;
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        for (auto queue = m_pendingRequests.begin(); queue != m_pendingRequests.end(); ++queue) {
+            QQueue<QString> kept;
+            for (const QString& requestId : std::as_const(queue.value())) {
+                auto it = m_activeRequests.find(requestId);
+                if (it != m_activeRequests.end() && it->status == TranscriptionStatus::Pending &&
+                    it->request.preferredProvider == provider) {
+                    it->status = TranscriptionStatus::Failed;
+                    --m_pendingCount;
+                    failed.append(qMakePair(requestId, m_errorString));
+                } else {
+                    kept.enqueue(requestId);
+                }
+            }
+            queue.value() = kept;
+        }
+        
+        for (const QString& requestId : std::as_const(m_chunkedRequests)) {
+            RequestInfo& info = m_activeRequests[requestId];
+            if (info.request.preferredProvider == provider && !info.chunkFailed &&
+                info.nextChunk < info.chunks.size()) {
+                info.chunkFailed = true;
+                info.chunkError = m_lastError;
+                info.chunkErrorMessage = m_errorString;
+            }
+        }
+    }
+    
+    reportFailedToStart(failed);
+    dispatchChunks();
+    
+    QStringList streamIds;
+    for (auto it = m_streams.cbegin(); it != m_streams.cend(); ++it) {
+        if (it->request.preferredProvider == provider && !it->decodeInFlight) {
+            streamIds.append(it.key());
+        }
+    }
+    for (const QString& streamId : std::as_const(streamIds)) {
+        m_streams.remove(streamId);
+        emit transcriptionFailed(streamId, m_lastError, m_errorString);
+    }
+    
+    processNextPendingRequest();
+}
+
+whisper_context* TranscriptionService::initWhisperContext(const QString& modelPath, bool useGpu) const {
+    // Weights only; decoding state comes from the per-model state pool
+    whisper_context_params params = whisper_context_default_params();
+    params.use_gpu = useGpu;
+    
+    // Feed the loader from a read-only mapping, which saves the stdio copy of the file.
+    // whisper.cpp copies the tensors out of the buffer, so resident memory is unchanged.
+    QFile file(modelPath);
+    if (file.open(QIODevice::ReadOnly)) {
+        if (uchar* mapped = file.map(0, file.size())) {
+            whisper_context* ctx = whisper_init_from_buffer_with_params_no_state(
+                mapped, static_cast<size_t>(file.size()), params);
+            file.unmap(mapped);
+            return ctx;
+        }
+    }
+    
+    return whisper_init_from_file_with_params_no_state(modelPath.toUtf8().constData(), params);
+}
+
+int TranscriptionService::threadCountFor(TranscriptionProvider provider) const {
+    if (!m_threadCountOverridden) {
+        QMutexLocker locker(&m_modelsMutex);
+        const int calibrated = m_backendConfigs.value(provider).threadCount;
+        if (calibrated > 0) {
+            return calibrated;
+        }
+    }
+    return m_threadCount;
+}
+
+void TranscriptionService::setBackendConfig(TranscriptionProvider model, const BackendConfig& config) {
+    bool backendChanged = false;
+    {
+        QMutexLocker locker(&m_modelsMutex);
+        backendChanged = m_backendConfigs.value(model).useGpu != config.useGpu && m_loadedModels.value(model);
+        m_backendConfigs[model] = config;
+    }
+    
+    if (backendChanged) {
+        // The backend is fixed when the context is created; reload once idle
+        unloadWhisperModel(model);
+        if (model == m_currentProvider) {
+            preloadModel(model);
+        }
+    }
+    if (model == m_currentProvider) {
+        updateDecodeSlots();
+        trimStatePools();
+    }
+}
+
+TranscriptionService::BackendConfig TranscriptionService::getBackendConfig(TranscriptionProvider model) const {
+    QMutexLocker locker(&m_modelsMutex);
+    return m_backendConfigs.value(model);
+}
+
+bool TranscriptionService::isGpuBackendAvailable() const {
+    // Backends are chosen when whisper.cpp is compiled; the system info string reports them
+    const QString info = QString::fromUtf8(whisper_print_system_info());
+    return info.contains("CUDA = 1") || info.contains("METAL = 1");
+}
+
+void TranscriptionService::calibrateBackend(TranscriptionProvider model) {
+    const QString modelPath = getModelPath(model);
+    if (modelPath.isEmpty()) {
+        setError(TranscriptionError::ModelNotFound, "Cannot calibrate: model not downloaded");
+        return;
+    }
+    if (m_calibratingModels.contains(model)) {
+        return;
+    }
+    m_calibratingModels.append(model);
+    
+    const bool gpuAvailable = isGpuBackendAvailable();
+    const int maxThreads = qMax(1, QThread::idealThreadCount());
+    
+    m_modelLoaderPool->start([this, model, modelPath, gpuAvailable, maxThreads]() {
+        const QVector<float> clip = makeCalibrationClip();
+        
+        // Thread counts to try: powers of two up to the core count, plus the core count
+        QList<int> threadCounts;
+        for (int threads = 1; threads < maxThreads; threads *= 2) {
+            threadCounts.append(threads);
+        }
+        threadCounts.append(maxThreads);
+        
+        QList<bool> backends;
+        if (gpuAvailable) {
+            backends.append(true);
+        }
+        backends.append(false);
+        
+        BackendConfig best;
+        best.encodeMs = std::numeric_limits<double>::max();
+        for (bool useGpu : backends) {
+            whisper_context* ctx = initWhisperContext(modelPath, useGpu);
+            whisper_state* state = ctx ? whisper_init_state(ctx) : nullptr;
+            if (!state ||
+                whisper_pcm_to_mel_with_state(ctx, state, clip.constData(), static_cast<int>(clip.size()), maxThreads) != 0) {
+                if (state) {
+                    whisper_free_state(state);
+                }
+                if (ctx) {
+                    whisper_free(ctx);
+                }
+                continue;
+            }
+            
+            // The encoder pass dominates decode time and does not depend on the audio content
+            for (int threads : threadCounts) {
+                whisper_encode_with_state(ctx, state, 0, threads); // Warm-up
+                double fastest = std::numeric_limits<double>::max();
+                for (int run = 0; run < CALIBRATION_RUNS; ++run) {
+                    QElapsedTimer timer;
+                    timer.start();
+                    if (whisper_encode_with_state(ctx, state, 0, threads) != 0) {
+                        break;
+                    }
+                    fastest = qMin(fastest, timer.nsecsElapsed() / 1e6);
+                }
+                if (m_telemetry && fastest < std::numeric_limits<double>::max()) {
+                    m_telemetry->recordStage(Telemetry::STAGE_ENCODE, static_cast<qint64>(fastest * 1000));
+                }
+                
+                // Prefer fewer threads unless more are clearly faster; spare cores go to chunk fan-out
+                if (fastest < best.encodeMs * (1.0 - CALIBRATION_MIN_GAIN)) {
+                    best.useGpu = useGpu;
+                    best.threadCount = threads;
+                    best.encodeMs = fastest;
+                }
+            }
+            
+            whisper_free_state(state);
+            whisper_free(ctx);
+        }
+        
+        QMetaObject::invokeMethod(this, [this, model, best]() {
+            m_calibratingModels.removeAll(model);
+            if (best.threadCount <= 0) {
+                setError(TranscriptionError::ModelLoadError, "Backend calibration failed for " + getModelFileName(model));
+                return;
+            }
+            setBackendConfig(model, best);
+            emit backendCalibrated(model, best.useGpu, best.threadCount, best.encodeMs);
+        }, Qt::QueuedConnection);
+    });
+}
+
+QVector<float> TranscriptionService::makeCalibrationClip() {
+    // Deterministic speech-band tone bursts over low noise; only the amount of audio matters
+    const int sampleCount = CALIBRATION_CLIP_MS * AudioFileReader::TARGET_SAMPLE_RATE / 1000;
+    QVector<float> clip(sampleCount);
+    quint32 seed = 0x2545F491u;
+    for (int i = 0; i < sampleCount; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        const float noise = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 0.02f;
+        const double t = static_cast<double>(i) / AudioFileReader::TARGET_SAMPLE_RATE;
+        const float envelope = std::fmod(t, 0.5) < 0.3 ? 0.3f : 0.0f;
+        clip[i] = noise + envelope * static_cast<float>(qSin(2.0 * M_PI * 220.0 * t));
+    }
+    return clip;
+}
+
+void TranscriptionService::touchModelLocked(TranscriptionProvider provider) {
+    m_modelLastUsed[provider] = ++m_modelUseCounter;
+}
+
+void TranscriptionService::evictModelsLocked(TranscriptionProvider keep, qint64 requiredBytes) {
+    qint64 resident = 0;
+    for (qint64 bytes : m_residentBytes) {
+        resident += bytes;
+    }
+    
+    while (resident + requiredBytes > m_modelMemoryBudget) {
+        // Pick the least recently used model that no decode is holding
+        TranscriptionProvider victim = TranscriptionProvider::Unknown;
+        quint64 oldest = std::numeric_limits<quint64>::max();
+        for (auto it = m_loadedModels.cbegin(); it != m_loadedModels.cend(); ++it) {
+            const TranscriptionProvider candidate = it.key();
+            if (candidate == keep || m_statePools.value(candidate).statesInUse > 0) {
+                continue;
+            }
+            const quint64 lastUsed = m_modelLastUsed.value(candidate);
+            if (lastUsed < oldest) {
+                oldest = lastUsed;
+                victim = candidate;
+            }
+        }
+        
+        if (victim == TranscriptionProvider::Unknown) {
+            qWarning() << "Model memory budget exceeded; all resident models are in use";
+            return;
+        }
+        
+        resident -= m_residentBytes.value(victim);
+        freeModelLocked(victim);
+    }
+}
+
+void TranscriptionService::unloadWhisperModel(TranscriptionProvider provider) {
+    QMutexLocker locker(&m_modelsMutex);
+    
+    if (!m_loadedModels.contains(provider) || !m_loadedModels.value(provider)) {
+        return;
+    }
+    
+    StatePool& pool = m_statePools[provider];
+    if (pool.statesInUse > 0) {
+        // Running decodes still reference the weights; free them on the last release
+        pool.unloadPending = true;
+        return;
+    }
+    
+    freeModelLocked(provider);
+}
+
+void TranscriptionService::freeModelLocked(TranscriptionProvider provider) {
+    StatePool pool = m_statePools.take(provider);
+    for (whisper_state* state : pool.idleStates) {
+        whisper_free_state(state);
+    }
+    
+    if (whisper_context* ctx = m_loadedModels.take(provider)) {
+        whisper_free(ctx);
+    }
+    m_residentBytes.remove(provider);
+    m_modelLastUsed.remove(provider);
+}
+
+whisper_state* TranscriptionService::acquireWhisperState(TranscriptionProvider provider, whisper_context* ctx,
+                                                         bool reportErrors) {
+    QMutexLocker locker(&m_modelsMutex);
+    
+    StatePool& pool = m_statePools[provider];
+    touchModelLocked(provider);
+    whisper_state* state = nullptr;
+    if (!pool.idleStates.isEmpty()) {
+        state = pool.idleStates.takeLast();
+    } else {
+        state = whisper_init_state(ctx);
+        if (!state) {
+            if (reportErrors) {
+                setError(TranscriptionError::InsufficientMemory, "Failed to allocate whisper state");
+            }
+            return nullptr;
+        }
+    }
+    
+    ++pool.statesInUse;
+    return state;
+}
+
+void TranscriptionService::releaseWhisperState(TranscriptionProvider provider, whisper_state* state) {
+    QMutexLocker locker(&m_modelsMutex);
+    
+    StatePool& pool = m_statePools[provider];
+    pool.statesInUse = qMax(0, pool.statesInUse - 1);
+    
+    // Keep at most one state per decode slot per model
+    if (pool.unloadPending || pool.idleStates.size() + pool.statesInUse >= m_decodeSlots) {
+        whisper_free_state(state);
+    } else {
+        pool.idleStates.append(state);
+    }
+    
+    if (pool.unloadPending && pool.statesInUse == 0) {
+        freeModelLocked(provider);
+    }
+}
+
+void TranscriptionService::trimStatePools() {
     QMutexLocker locker(&m_modelsMutex);
     
-    if (m_loadedModels.contains(provider) && m_loadedModels.value(provider)) {
-        whisper_free(m_loadedModels.value(provider));
-        m_loadedModels.remove(provider);
+    for (auto it = m_statePools.begin(); it != m_statePools.end(); ++it) {
+        StatePool& pool = it.value();
+        while (!pool.idleStates.isEmpty() &&
+               pool.idleStates.size() + pool.statesInUse > m_decodeSlots) {
+            whisper_free_state(pool.idleStates.takeLast());
+        }
     }
 }
 
@@ -589,23 +2367,465 @@ bool TranscriptionService::createModelsDirectory() const {
 
 bool TranscriptionService::validateModelFile(const QString& modelPath) const {
     QFileInfo fileInfo(modelPath);
-    return fileInfo.exists() && fileInfo.isReadable() && fileInfo.size() > 0;
+    return fileInfo.exists() && fileInfo.isReadable() && fileInfo.size() > 0 &&
+           verifyModelIntegrity(modelPath);
+}
+
+TranscriptionService::TaskStart TranscriptionService::startTranscriptionTask(const QString& requestId) {
+    if (!m_activeRequests.contains(requestId)) {
+        return TaskStart::Failed;
+    }
+    
+    RequestInfo& info = m_activeRequests[requestId];
+    // Never parse a model here: this runs on the GUI thread with m_requestsMutex held
+    whisper_context* ctx = residentModel(info.request.preferredProvider);
+    if (!ctx) {
+        requestModelLoad(info.request.preferredProvider);
+        return TaskStart::AwaitingModel;
+    }
+    
+    info.state = acquireWhisperState(info.request.preferredProvider, ctx);
+    if (!info.state) {
+        return TaskStart::Failed;
+    }
+    
+    auto* task = new TranscriptionTask(info.request, requestId, ctx, info.state,
+                                       threadCountFor(info.request.preferredProvider));
+    task->setChunkingEnabled(true);
+    task->setAbortFlag(info.abortFlag);
+    task->setTelemetry(m_telemetry);
+    int timeoutBaseMs = 0;
+    double timeoutPerAudioMs = 0.0;
+    timeoutFor(info.request, &timeoutBaseMs, &timeoutPerAudioMs);
+    task->setTimeout(timeoutBaseMs, timeoutPerAudioMs);
+    if (info.request.options.value("useCache").toBool(true)) {
+        task->setResultCache(&m_resultCache, cacheParametersKey(info.request));
+    }
+    connect(task, &TranscriptionTask::taskCompleted, this, &TranscriptionService::handleTaskCompleted, Qt::QueuedConnection);
+    connect(task, &TranscriptionTask::taskChunked, this, &TranscriptionService::handleTaskChunked, Qt::QueuedConnection);
+    connect(task, &TranscriptionTask::taskFailed, this, &TranscriptionService::handleTaskFailed, Qt::QueuedConnection);
+    connect(task, &TranscriptionTask::taskProgress, this, &TranscriptionService::handleTaskProgress, Qt::QueuedConnection);
+    
+    info.status = TranscriptionStatus::Processing;
+    info.timer.restart();
+    if (info.prefetched) {
+        // The task holds its own reference and drops it when it finishes
+        info.request.audioBuffer = AudioSampleBuffer();
+        info.prefetched = false;
+    }
+    ++m_runningTasks;
+    m_threadPool->start(task, poolPriority(info.request.priority));
+    return TaskStart::Started;
+}
+
+void TranscriptionService::releaseRequestState(const QString& requestId) {
+    if (!m_activeRequests.contains(requestId)) {
+        return;
+    }
+    
+    RequestInfo& info = m_activeRequests[requestId];
+    if (info.state) {
+        releaseWhisperState(info.request.preferredProvider, info.state);
+        info.state = nullptr;
+    }
+}
+
+void TranscriptionService::enqueuePendingRequest(const QString& requestId, bool atFront) {
+    QQueue<QString>& queue = m_pendingRequests[m_activeRequests.value(requestId).request.priority];
+    if (atFront) {
+        queue.prepend(requestId);
+    } else {
+        queue.enqueue(requestId);
+    }
+    ++m_pendingCount;
+}
+
+QString TranscriptionService::takeNextPendingRequest() {
+    // QMap iterates keys in enum order, so Interactive is drained first
+    for (auto it = m_pendingRequests.begin(); it != m_pendingRequests.end(); ++it) {
+        QQueue<QString>& queue = it.value();
+        while (!queue.isEmpty()) {
+            const QString requestId = queue.dequeue();
+            auto request = m_activeRequests.constFind(requestId);
+            if (request != m_activeRequests.constEnd() && request->status == TranscriptionStatus::Pending) {
+                --m_pendingCount;
+                return requestId;
+            }
+        }
+    }
+    return QString();
+}
+
+void TranscriptionService::prefetchPendingAudio() {
+    // Read and convert the next queued files while the current ones decode, so a worker
+    // picking them up goes straight to inference. Only batch items qualify; their queue
+    // position is stable enough for the read-ahead not to be wasted.
+    QList<QPair<QString, QString>> jobs;
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        // Queues are keyed by priority, so iteration follows the order they will be started in.
+        // Audio read ahead for a request that has since been pushed out of the window (by
+        // more urgent work) is dropped again, so at most PREFETCH_DEPTH recordings are held.
+        int inspected = 0;
+        for (auto queue = m_pendingRequests.cbegin(); queue != m_pendingRequests.cend(); ++queue) {
+            for (const QString& requestId : queue.value()) {
+                auto it = m_activeRequests.find(requestId);
+                if (it == m_activeRequests.end() || it->status != TranscriptionStatus::Pending) {
+                    continue;
+                }
+                if (inspected++ >= PREFETCH_DEPTH) {
+                    if (it->prefetched) {
+                        it->request.audioBuffer = AudioSampleBuffer();
+                        it->prefetched = false;
+                    }
+                    continue;
+                }
+                if (!it->batchId.isEmpty() && !it->prefetching && it->request.audioBuffer.isEmpty()) {
+                    it->prefetching = true;
+                    jobs.append(qMakePair(requestId, it->request.audioFilePath));
+                }
+            }
+        }
+    }
+    
+    for (const auto& job : jobs) {
+        const QString requestId = job.first;
+        const QString audioPath = job.second;
+        m_prefetchPool->start([this, requestId, audioPath]() {
+            AudioSampleBuffer buffer;
+            const bool ok = AudioFileReader::readSamples(audioPath, buffer.samples);
+            buffer.sampleRate = AudioFileReader::TARGET_SAMPLE_RATE;
+            
+            QMutexLocker locker(&m_requestsMutex);
+            auto it = m_activeRequests.find(requestId);
+            // Too late if the request has started; its task reads the file itself. Failed reads
+            // stay flagged so they are not retried, and the task reports the error.
+            if (ok && it != m_activeRequests.end() && it->status == TranscriptionStatus::Pending) {
+                it->prefetching = false;
+                it->prefetched = true;
+                it->request.audioBuffer = buffer;
+            }
+        });
+    }
+}
+
+void TranscriptionService::updateBatchProgress(const QString& batchId, bool succeeded, qint64 audioMs) {
+    auto it = m_batches.find(batchId);
+    if (batchId.isEmpty() || it == m_batches.end()) {
+        return;
+    }
+    
+    BatchInfo& batch = it.value();
+    if (succeeded) {
+        ++batch.succeeded;
+        batch.audioMs += audioMs;
+    } else {
+        ++batch.failed;
+    }
+    
+    const int finished = batch.succeeded + batch.failed;
+    const qint64 elapsedMs = qMax<qint64>(1, batch.timer.elapsed());
+    emit batchProgress(batchId, finished, batch.total, static_cast<double>(batch.audioMs) / elapsedMs);
+    
+    if (finished >= batch.total) {
+        qDebug() << "Batch" << batchId << "finished:" << batch.succeeded << "ok," << batch.failed << "failed,"
+                 << batch.audioMs / 1000 << "s of audio in" << elapsedMs / 1000 << "s";
+        emit batchCompleted(batchId, batch.succeeded, batch.failed, batch.audioMs, elapsedMs);
+        m_batches.erase(it);
+    }
+}
+
+bool TranscriptionService::isWhisperModelLoaded(TranscriptionProvider provider) const {
+    QMutexLocker locker(&m_modelsMutex);
+    return m_loadedModels.value(provider) != nullptr;
+}
+
+void TranscriptionService::updateDecodeSlots() {
+    // A lone long recording should be able to keep every core busy with its chunks
+    const int chunkParallelism = qMax(1, QThread::idealThreadCount() / threadCountFor(m_currentProvider));
+    m_decodeSlots = qMax(m_maxConcurrentRequests, chunkParallelism);
+    m_threadPool->setMaxThreadCount(m_decodeSlots);
+}
+
+void TranscriptionService::handleTaskChunked(const QString& requestId, const QVector<float>& samples,
+                                             const QList<qint64>& splitPoints, const QString& language,
+                                             const QByteArray& cacheKey) {
+    TranscriptionRequest detectedFor;
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        if (!m_activeRequests.contains(requestId)) {
+            return;
+        }
+        
+        // The analysis pass is done with its state; each chunk leases its own
+        releaseRequestState(requestId);
+        RequestInfo& info = m_activeRequests[requestId];
+        info.cacheKey = cacheKey;
+        
+        // Every chunk decodes in the language detected on the recording's prefix
+        if (info.detectLanguage && !TranscriptionTask::isAutoLanguage(language)) {
+            info.request.language = language;
+            info.detectLanguage = false;
+            detectedFor = info.request;
+        }
+        
+        qint64 chunkStart = 0;
+        for (int i = 0; i <= splitPoints.size(); ++i) {
+            ChunkJob chunk;
+            chunk.startSample = chunkStart;
+            chunk.endSample = i < splitPoints.size() ? splitPoints.at(i) : samples.size();
+            info.chunks.append(chunk);
+            chunkStart = chunk.endSample;
+        }
+        info.chunkAudio = samples;
+        
+        // One budget for the whole recording, counted from when the request started decoding
+        int timeoutBaseMs = 0;
+        double timeoutPerAudioMs = 0.0;
+        timeoutFor(info.request, &timeoutBaseMs, &timeoutPerAudioMs);
+        if (timeoutBaseMs > 0) {
+            const qint64 audioMs = samples.size() * 1000 / AudioFileReader::TARGET_SAMPLE_RATE;
+            const qint64 budgetMs = timeoutBaseMs + static_cast<qint64>(audioMs * timeoutPerAudioMs);
+            info.deadline = QDeadlineTimer(qMax<qint64>(0, budgetMs - info.timer.elapsed()));
+        } else {
+            info.deadline = QDeadlineTimer(QDeadlineTimer::Forever);
+        }
+        
+        // Chunks of interactive requests are dispatched ahead of background ones
+        int position = 0;
+        while (position < m_chunkedRequests.size() &&
+               m_activeRequests.value(m_chunkedRequests.at(position)).request.priority <= info.request.priority) {
+            ++position;
+        }
+        m_chunkedRequests.insert(position, requestId);
+    }
+    
+    if (!detectedFor.language.isEmpty()) {
+        rememberDetectedLanguage(detectedFor, detectedFor.language);
+    }
+    dispatchChunks();
+}
+
+void TranscriptionService::dispatchChunks() {
+    QStringList finished;
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        
+        for (const QString& requestId : m_chunkedRequests) {
+            RequestInfo& info = m_activeRequests[requestId];
+            const TranscriptionProvider provider = info.request.preferredProvider;
+            
+            while (m_chunksInFlight < m_decodeSlots && info.nextChunk < info.chunks.size() &&
+                   !info.chunkFailed && info.status == TranscriptionStatus::Processing) {
+                whisper_context* ctx = residentModel(provider);
+                if (!ctx) {
+                    // Evicted since the analysis pass; the remaining chunks resume on handleModelReady()
+                    requestModelLoad(provider);
+                    break;
+                }
+                whisper_state* state = acquireWhisperState(provider, ctx);
+                if (!state) {
+                    info.chunkFailed = true;
+                    info.chunkError = m_lastError;
+                    info.chunkErrorMessage = m_errorString;
+                    break;
+                }
+                
+                const int index = info.nextChunk++;
+                ChunkJob& chunk = info.chunks[index];
+                chunk.state = state;
+                
+                auto* task = new TranscriptionTask(info.request, requestId, ctx, state, threadCountFor(provider));
+                task->setSamples(info.chunkAudio, chunk.startSample, chunk.endSample - chunk.startSample);
+                task->setAbortFlag(info.abortFlag);
+                task->setTelemetry(m_telemetry);
+                task->setDeadline(info.deadline);
+                connect(task, &TranscriptionTask::taskCompleted, this,
+                        [this, index](const QString& id, const TranscriptionResult& result) {
+                            handleChunkCompleted(id, index, result);
+                        }, Qt::QueuedConnection);
+                connect(task, &TranscriptionTask::taskFailed, this,
+                        [this, index](const QString& id, TranscriptionError error, const QString& message) {
+                            handleChunkFailed(id, index, error, message);
+                        }, Qt::QueuedConnection);
+                
+                ++info.chunksInFlight;
+                ++m_chunksInFlight;
+                m_threadPool->start(task, poolPriority(info.request.priority));
+            }
+            
+            const bool stopped = info.chunkFailed || info.status != TranscriptionStatus::Processing;
+            if (info.chunksInFlight == 0 && (stopped || info.nextChunk >= info.chunks.size())) {
+                finished.append(requestId);
+            }
+        }
+    }
+    
+    for (const QString& requestId : finished) {
+        finishChunkedRequest(requestId);
+    }
+}
+
+void TranscriptionService::handleChunkCompleted(const QString& requestId, int chunkIndex, const TranscriptionResult& result) {
+    int progress = -1;
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        if (!m_activeRequests.contains(requestId)) {
+            return;
+        }
+        
+        RequestInfo& info = m_activeRequests[requestId];
+        ChunkJob& chunk = info.chunks[chunkIndex];
+        releaseWhisperState(info.request.preferredProvider, chunk.state);
+        chunk.state = nullptr;
+        chunk.result = result;
+        chunk.done = true;
+        --info.chunksInFlight;
+        --m_chunksInFlight;
+        
+        if (info.status == TranscriptionStatus::Processing) {
+            int doneCount = 0;
+            for (const ChunkJob& job : info.chunks) {
+                doneCount += job.done ? 1 : 0;
+            }
+            progress = doneCount * 99 / info.chunks.size();
+        }
+    }
+    
+    if (progress >= 0) {
+        handleTaskProgress(requestId, progress);
+    }
+    dispatchChunks();
+}
+
+void TranscriptionService::handleChunkFailed(const QString& requestId, int chunkIndex,
+                                             TranscriptionError error, const QString& errorMessage) {
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        if (!m_activeRequests.contains(requestId)) {
+            return;
+        }
+        
+        RequestInfo& info = m_activeRequests[requestId];
+        ChunkJob& chunk = info.chunks[chunkIndex];
+        releaseWhisperState(info.request.preferredProvider, chunk.state);
+        chunk.state = nullptr;
+        --info.chunksInFlight;
+        --m_chunksInFlight;
+        
+        // Chunks already running finish normally; no new ones are started
+        if (!info.chunkFailed) {
+            info.chunkFailed = true;
+            info.chunkError = error;
+            info.chunkErrorMessage = QString("Chunk %1 failed: %2").arg(chunkIndex + 1).arg(errorMessage);
+        }
+    }
+    
+    dispatchChunks();
+}
+
+void TranscriptionService::finishChunkedRequest(const QString& requestId) {
+    TranscriptionResult result;
+    bool failed = false;
+    TranscriptionError error = TranscriptionError::NoError;
+    QString errorMessage;
+    {
+        QMutexLocker locker(&m_requestsMutex);
+        m_chunkedRequests.removeAll(requestId);
+        
+        RequestInfo& info = m_activeRequests[requestId];
+        failed = info.chunkFailed;
+        error = info.chunkError;
+        errorMessage = info.chunkErrorMessage;
+        if (!failed && info.status == TranscriptionStatus::Processing) {
+            result = stitchChunkResults(requestId, info);
+        }
+        
+        // Release the recording; only the stitched result is kept
+        info.chunkAudio = QVector<float>();
+        info.request.audioBuffer = AudioSampleBuffer();
+        info.chunks.clear();
+    }
+    
+    // Cancelled requests are recognised (and dropped) by the regular completion path
+    if (failed) {
+        handleTaskFailed(requestId, error, errorMessage);
+    } else {
+        handleTaskCompleted(requestId, result);
+    }
 }
 
-TranscriptionResult TranscriptionService::processWithWhisper(const TranscriptionRequest& request, const QString& requestId) {
-    // This is a simplified implementation
-    // Full implementation would include actual whisper.cpp processing
+TranscriptionResult TranscriptionService::stitchChunkResults(const QString& requestId, const RequestInfo& info) const {
     TranscriptionResult result;
     result.id = requestId;
-    result.provider = request.preferredProvider;
-    result.confidence = 0.95;
-    result.language = request.language.isEmpty() ? m_defaultLanguage : request.language;
-    result.processingTime = 1000; // Placeholder
-    result.text = "Sample transcription text"; // Placeholder
+    result.provider = info.request.preferredProvider;
+    result.processingTime = info.timer.elapsed();
+    
+    QStringList texts;
+    QJsonArray segmentTimings;
+    QJsonArray words;
+    QMap<QString, qint64> languageDurations;
+    double weightedConfidence = 0.0;
+    qint64 totalSamples = 0;
+    
+    for (const ChunkJob& chunk : info.chunks) {
+        const TranscriptionResult& part = chunk.result;
+        const double offsetSeconds = static_cast<double>(chunk.startSample) / AudioFileReader::TARGET_SAMPLE_RATE;
+        const qint64 chunkSamples = chunk.endSample - chunk.startSample;
+        
+        if (!part.text.isEmpty()) {
+            texts.append(part.text);
+        }
+        
+        // Timings are relative to the chunk; move them onto the recording's timeline
+        for (const QJsonValue& value : part.metadata.value("segmentTimings").toArray()) {
+            QJsonObject segment = value.toObject();
+            segment["startTime"] = segment.value("startTime").toDouble() + offsetSeconds;
+            segment["endTime"] = segment.value("endTime").toDouble() + offsetSeconds;
+            segmentTimings.append(segment);
+        }
+        for (const QJsonValue& value : part.wordTimestamps) {
+            QJsonObject word = value.toObject();
+            word["startTime"] = word.value("startTime").toDouble() + offsetSeconds;
+            word["endTime"] = word.value("endTime").toDouble() + offsetSeconds;
+            words.append(word);
+        }
+        
+        weightedConfidence += part.confidence * chunkSamples;
+        totalSamples += chunkSamples;
+        if (!part.language.isEmpty()) {
+            languageDurations[part.language] += chunkSamples;
+        }
+    }
+    
+    // The language spoken for most of the recording wins
+    qint64 longestLanguage = -1;
+    for (auto it = languageDurations.cbegin(); it != languageDurations.cend(); ++it) {
+        if (it.value() > longestLanguage) {
+            longestLanguage = it.value();
+            result.language = it.key();
+        }
+    }
     
+    result.text = texts.join(' ');
+    result.wordTimestamps = words;
+    result.confidence = totalSamples > 0 ? weightedConfidence / totalSamples : 0.0;
+    result.metadata["segmentTimings"] = segmentTimings;
+    result.metadata["segments"] = segmentTimings.size();
+    result.metadata["chunks"] = info.chunks.size();
+    result.metadata["audioDurationMs"] = totalSamples * 1000 / AudioFileReader::TARGET_SAMPLE_RATE;
+    result.metadata["threads"] = threadCountFor(info.request.preferredProvider);
+    if (!info.cacheKey.isEmpty()) {
+        result.metadata["cacheKey"] = QString::fromLatin1(info.cacheKey);
+    }
     return result;
 }
 
+void TranscriptionService::updateProcessingTime(TranscriptionProvider provider, qint64 processingTime) {
+    m_processingTimes[provider].record(processingTime);
+    emit processingTimeUpdated(provider, getAverageProcessingTime(provider));
+}
+
 void TranscriptionService::setError(TranscriptionError error, const QString& errorMessage) {
     m_lastError = error;
     m_errorString = errorMessage;
@@ -626,39 +2846,267 @@ void TranscriptionService::setRequestResult(const QString& requestId, const Tran
 }
 
 void TranscriptionService::processNextPendingRequest() {
-    QMutexLocker locker(&m_requestsMutex);
-    
-    if (!m_pendingRequests.isEmpty() && 
-        m_activeRequests.size() <= m_maxConcurrentRequests) {
+    QList<QPair<QString, QString>> failedToStart;
+    {
+        QMutexLocker locker(&m_requestsMutex);
         
-        QString requestId = m_pendingRequests.dequeue();
-        if (m_activeRequests.contains(requestId)) {
-            const TranscriptionRequest& request = m_activeRequests[requestId].request;
-            setRequestStatus(requestId, TranscriptionStatus::Processing);
+        while (m_runningTasks < m_maxConcurrentRequests) {
+            const QString requestId = takeNextPendingRequest();
+            if (requestId.isEmpty()) {
+                break;
+            }
             
-            // Process the request
-            QTimer::singleShot(0, this, [this, request, requestId]() {
-                TranscriptionResult result = processWithWhisper(request, requestId);
-                if (result.id.isEmpty()) {
-                    handleTaskFailed(requestId, m_lastError, m_errorString);
-                } else {
-                    handleTaskCompleted(requestId, result);
-                }
-            });
+            const TaskStart start = startTranscriptionTask(requestId);
+            if (start == TaskStart::AwaitingModel) {
+                // Keeps its place; handleModelReady() resumes the queue
+                enqueuePendingRequest(requestId, true);
+                break;
+            }
+            if (start == TaskStart::Failed) {
+                setRequestStatus(requestId, TranscriptionStatus::Failed);
+                m_activeRequests[requestId].request.audioBuffer = AudioSampleBuffer();
+                failedToStart.append(qMakePair(requestId, m_errorString));
+            }
+        }
+    }
+    
+    reportFailedToStart(failedToStart);
+    prefetchPendingAudio();
+}
+
+void TranscriptionService::reportFailedToStart(const QList<QPair<QString, QString>>& failures) {
+    for (const auto& failure : failures) {
+        QStringList followers;
+        bool detached = false;
+        QString segmentedSessionId;
+        {
+            QMutexLocker locker(&m_requestsMutex);
+            detached = m_activeRequests.value(failure.first).detached;
+            segmentedSessionId = m_activeRequests.value(failure.first).segmentedSessionId;
+            followers = takeFollowersLocked(failure.first);
+        }
+        completeFollowers(followers, nullptr, m_lastError, failure.second);
+        if (!detached && !segmentedSessionId.isEmpty()) {
+            handleSegmentResult(segmentedSessionId, failure.first, nullptr);
+        } else if (!detached) {
+            emit transcriptionFailed(failure.first, m_lastError, failure.second);
         }
+        updateBatchProgress(getBatchId(failure.first), false, 0);
     }
 }
 
 void TranscriptionService::downloadModelAsync(TranscriptionProvider model) {
-    // Placeholder for model download implementation
-    // In a full implementation, this would download models from appropriate sources
-    emit modelDownloadCompleted(model);
+    if (m_downloads.contains(model)) {
+        return; // Already downloading
+    }
+    
+    if (!createModelsDirectory()) {
+        emit modelDownloadFailed(model, "Cannot create models directory");
+        return;
+    }
+    
+    const QString partPath = QDir(getModelsDirectory()).absoluteFilePath(getModelFileName(model) + ".part");
+    ModelDownload download;
+    download.partFile = new QFile(partPath);
+    if (!download.partFile->open(QIODevice::ReadWrite)) {
+        const QString error = download.partFile->errorString();
+        delete download.partFile;
+        emit modelDownloadFailed(model, "Cannot open download file: " + error);
+        return;
+    }
+    
+    // A leftover .part from an earlier session is hashed once so the download can resume
+    download.hash = new QCryptographicHash(QCryptographicHash::Sha256);
+    download.hash->addData(download.partFile);
+    download.partFile->seek(download.partFile->size());
+    
+    m_downloads.insert(model, download);
+    sendModelDownloadRequest(model);
+}
+
+void TranscriptionService::sendModelDownloadRequest(TranscriptionProvider model) {
+    if (!m_downloads.contains(model)) {
+        return;
+    }
+    
+    ModelDownload& download = m_downloads[model];
+    download.resumeOffset = download.partFile->size();
+    
+    QNetworkRequest request{QUrl(getModelDownloadUrl(model))};
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    if (download.resumeOffset > 0) {
+        request.setRawHeader("Range", "bytes=" + QByteArray::number(download.resumeOffset) + "-");
+    }
+    
+    QNetworkReply* reply = m_networkManager->get(request);
+    reply->setReadBufferSize(DOWNLOAD_READ_BUFFER_SIZE);
+    download.reply = reply;
+    
+    // Hugging Face exposes the SHA-256 of LFS objects on the final (post-redirect) response
+    connect(reply, &QNetworkReply::metaDataChanged, this, [this, model, reply]() {
+        if (!m_downloads.contains(model)) {
+            return;
+        }
+        QByteArray linkedEtag = reply->rawHeader("X-Linked-Etag");
+        linkedEtag.replace('"', "");
+        if (linkedEtag.size() == 64) {
+            m_downloads[model].expectedSha256 = linkedEtag.toLower();
+        }
+    });
+    connect(reply, &QNetworkReply::readyRead, this, &TranscriptionService::handleModelDownloadReadyRead);
+    connect(reply, &QNetworkReply::downloadProgress, this, &TranscriptionService::handleModelDownloadProgress);
+    connect(reply, &QNetworkReply::finished, this, &TranscriptionService::handleModelDownloadFinished);
+}
+
+void TranscriptionService::finishModelDownload(TranscriptionProvider model, const QString& errorMessage) {
+    ModelDownload download = m_downloads.take(model);
+    if (download.reply) {
+        download.reply->disconnect(this);
+        download.reply->abort();
+        download.reply->deleteLater();
+    }
+    delete download.partFile;
+    delete download.hash;
+    
+    if (errorMessage.isEmpty()) {
+        emit modelDownloadCompleted(model);
+    } else {
+        setError(TranscriptionError::ModelNotFound, errorMessage);
+        emit modelDownloadFailed(model, errorMessage);
+    }
+}
+
+TranscriptionProvider TranscriptionService::findDownloadByReply(QNetworkReply* reply) const {
+    for (auto it = m_downloads.cbegin(); it != m_downloads.cend(); ++it) {
+        if (reply && it.value().reply == reply) {
+            return it.key();
+        }
+    }
+    return TranscriptionProvider::Unknown;
+}
+
+QString TranscriptionService::getModelDownloadUrl(TranscriptionProvider model) const {
+    return QString("https://huggingface.co/ggerganov/whisper.cpp/resolve/main/%1").arg(getModelFileName(model));
+}
+
+bool TranscriptionService::verifyModelIntegrity(const QString& modelPath) const {
+    QFile file(modelPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    
+    // whisper.cpp model files start with the GGML magic 0x67676d6c (little endian)
+    if (file.read(4) != QByteArray("lmgg", 4)) {
+        return false;
+    }
+    
+    // Downloads record "<sha256> <size>"; a size mismatch means truncation or tampering.
+    // The digest itself was checked while the bytes streamed in.
+    QFile sidecar(modelPath + ".sha256");
+    if (sidecar.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = sidecar.readLine().trimmed().split(' ');
+        if (fields.size() == 2 && fields.at(1).toLongLong() != file.size()) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+void TranscriptionService::startLanguageDetection(TranscriptionProvider provider,
+                                                  const std::shared_ptr<QPromise<QString>>& promise,
+                                                  const QString& audioPath) {
+    // Same route to the model as a transcription: never parsed here, and not twice at once
+    whisper_context* ctx = residentModel(provider);
+    if (!ctx) {
+        m_pendingDetections[provider].append(qMakePair(audioPath, promise));
+        requestModelLoad(provider);
+        return;
+    }
+    
+    whisper_state* state = acquireWhisperState(provider, ctx);
+    if (!state) {
+        promise->addResult(m_defaultLanguage);
+        promise->finish();
+        return;
+    }
+    // Back to the pool even when the destructor drops the task before it runs
+    std::shared_ptr<whisper_state> lease(state, [this, provider](whisper_state* leased) {
+        releaseWhisperState(provider, leased);
+    });
+    
+    const int threadCount = threadCountFor(provider);
+    const QString defaultLanguage = m_defaultLanguage;
+    m_threadPool->start([this, promise, audioPath, ctx, lease, threadCount, defaultLanguage]() {
+        QVector<float> samples;
+        QString errorMessage;
+        QString language;
+        if (AudioFileReader::readSamples(audioPath, samples, &errorMessage)) {
+            language = TranscriptionTask::detectLanguage(ctx, lease.get(), samples.constData(),
+                                                         samples.size(), threadCount);
+        } else {
+            // The error state belongs to the GUI thread
+            QMetaObject::invokeMethod(this, [this, errorMessage]() {
+                setError(TranscriptionError::InvalidAudioFile, errorMessage);
+            }, Qt::QueuedConnection);
+        }
+        // Resolved here, so a blocking detectLanguage() on the GUI thread can't deadlock on it
+        promise->addResult(language.isEmpty() ? defaultLanguage : language);
+        promise->finish();
+    }, poolPriority(TranscriptionPriority::Interactive));
+}
+
+QString TranscriptionService::languageCacheKey(const TranscriptionRequest& request) const {
+    const QString sessionId = request.options.value("sessionId").toString();
+    return sessionId.isEmpty() ? request.options.value("deviceId").toString() : sessionId;
+}
+
+QByteArray TranscriptionService::cacheParametersKey(const TranscriptionRequest& request) const {
+    // Everything that changes the decoded text; bookkeeping options are left out
+    QJsonObject options = request.options;
+    for (const char* key : {"recordingId", "sessionId", "deviceId", "useCache"}) {
+        options.remove(QLatin1String(key));
+    }
+    
+    return getModelFileName(request.preferredProvider).toUtf8() + '|' +
+           request.language.toUtf8() + '|' +
+           QJsonDocument(options).toJson(QJsonDocument::Compact);
+}
+
+bool TranscriptionService::applyCachedLanguage(TranscriptionRequest& request) const {
+    if (!TranscriptionTask::isAutoLanguage(request.language)) {
+        return true;
+    }
+    
+    const QString cached = m_sessionLanguages.value(languageCacheKey(request));
+    if (cached.isEmpty()) {
+        return false;
+    }
+    request.language = cached;
+    return true;
+}
+
+void TranscriptionService::rememberDetectedLanguage(const TranscriptionRequest& request, const QString& languageCode) {
+    const QString key = languageCacheKey(request);
+    if (key.isEmpty() || languageCode.isEmpty() || m_sessionLanguages.value(key) == languageCode) {
+        return;
+    }
+    
+    m_sessionLanguages[key] = languageCode;
+    emit sessionLanguageDetected(key, languageCode);
+}
+
+void TranscriptionService::setSessionLanguage(const QString& sessionId, const QString& languageCode) {
+    if (languageCode.isEmpty() || TranscriptionTask::isAutoLanguage(languageCode)) {
+        m_sessionLanguages.remove(sessionId);
+    } else {
+        m_sessionLanguages[sessionId] = languageCode;
+    }
 }
 
-QString TranscriptionService::detectLanguageFromAudio(const QString& audioPath) {
-    Q_UNUSED(audioPath)
-    // Placeholder - would use whisper.cpp language detection
-    return m_defaultLanguage;
+QString TranscriptionService::getSessionLanguage(const QString& sessionId) const {
+    return m_sessionLanguages.value(sessionId);
 }
 
 // Helper function to convert provider enum to string
@@ -682,28 +3130,39 @@ IStorageManager* TranscriptionService::getStorageManager() const {
     return m_storageManager;
 }
 
-void TranscriptionService::saveTranscriptionToStorage(const QString& requestId, const TranscriptionResult& result) {
-    if (!m_storageManager) {
-        return;
-    }
-
-    auto* transcriptionStorage = m_storageManager->getTranscriptionStorage();
-    if (!transcriptionStorage) {
-        return;
-    }
+void TranscriptionService::setTelemetry(Telemetry* telemetry) {
+    m_telemetry = telemetry;
+}
 
+void TranscriptionService::saveRequestTranscriptionToStorage(const QString& requestId, const TranscriptionResult& result) {
     // Get recording ID from the request context
     QString recordingId;
     {
         QMutexLocker locker(&m_requestsMutex);
         if (m_activeRequests.contains(requestId)) {
             const TranscriptionRequest& request = m_activeRequests[requestId].request;
-            // Extract recording ID from audio file path or use a default approach
-            QFileInfo fileInfo(request.audioFilePath);
-            recordingId = fileInfo.baseName(); // Use filename as recording ID for now
+            recordingId = request.options.value("recordingId").toString();
+            if (recordingId.isEmpty()) {
+                // Fall back to the audio file name as recording ID
+                QFileInfo fileInfo(request.audioFilePath);
+                recordingId = fileInfo.baseName();
+            }
         }
     }
     
+    saveTranscriptionToStorage(recordingId, result);
+}
+
+void TranscriptionService::saveTranscriptionToStorage(const QString& recordingId, const TranscriptionResult& result) {
+    if (!m_storageManager) {
+        return;
+    }
+
+    auto* transcriptionStorage = m_storageManager->getTranscriptionStorage();
+    if (!transcriptionStorage) {
+        return;
+    }
+    
     if (recordingId.isEmpty()) {
         return; // Cannot save without recording ID
     }
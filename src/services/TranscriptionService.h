@@ -1,6 +1,9 @@
 #pragma once
 
 #include "../models/BaseModel.h"
+#include "AudioFileReader.h"
+#include "TranscriptionCache.h"
+#include "Telemetry.h"
 #include "../../specs/001-voice-to-text/contracts/transcription-service-interface.h"
 #include "../../specs/001-voice-to-text/contracts/storage-interface.h"
 #include <QObject>
@@ -15,32 +18,100 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QElapsedTimer>
+#include <QDeadlineTimer>
 #include <QMap>
+#include <QHash>
 #include <QQueue>
 #include <QAtomicInt>
+#include <QSharedPointer>
+#include <QFuture>
+#include <QPromise>
+#include <memory>
+
+class QCryptographicHash;
 
 // Forward declaration for whisper.cpp
 struct whisper_context;
+struct whisper_state;
 struct whisper_full_params;
 
 /**
  * @brief Transcription task for threaded processing
+ *
+ * Runs whisper_full on a QThreadPool worker. The context holds the shared, read-only
+ * model weights; the whisper_state (KV cache, mel buffers) is leased to the task by
+ * the service so several tasks can decode concurrently against one loaded model.
+ * Results are delivered through queued signals to the owning service.
  */
 class TranscriptionTask : public QObject, public QRunnable {
     Q_OBJECT
 
 public:
-    TranscriptionTask(const TranscriptionRequest& request, const QString& requestId);
+    TranscriptionTask(const TranscriptionRequest& request, const QString& requestId,
+                      whisper_context* context, whisper_state* state, int threadCount);
     void run() override;
+    
+    // Decode these samples (16 kHz mono float) instead of reading m_request.audioFilePath.
+    // offset/count select a chunk without copying the shared buffer.
+    void setSamples(const QVector<float>& samples, qint64 offset = 0, qint64 count = -1);
+    // Text fed to the decoder as prior context (streaming prompt carry-over)
+    void setInitialPrompt(const QString& prompt);
+    // Split long audio on silence and hand it back via taskChunked instead of decoding it
+    void setChunkingEnabled(bool enabled);
+    // Raised by the service to stop a running decode (cancellation)
+    void setAbortFlag(const QSharedPointer<QAtomicInt>& abortFlag);
+    // Answer from the result cache when the same audio was decoded with the same parameters
+    void setResultCache(TranscriptionCache* cache, const QByteArray& parametersKey);
+    // Records the mel and decode stages of whisper_full
+    void setTelemetry(Telemetry* telemetry);
+    // Fail with TimeoutError once the task has run baseMs plus perAudioMs for every millisecond
+    // of audio it decodes; baseMs <= 0 disables the limit
+    void setTimeout(int baseMs, double perAudioMs);
+    // A fixed deadline instead, shared by every chunk of one request
+    void setDeadline(const QDeadlineTimer& deadline);
+    
+    static bool isAutoLanguage(const QString& language);
+    // Runs whisper's language detector on the first LANGUAGE_DETECT_MS of audio
+    static QString detectLanguage(whisper_context* ctx, whisper_state* state, const float* samples,
+                                  qint64 sampleCount, int threadCount, float* probability = nullptr);
+    
+    static constexpr int LANGUAGE_DETECT_MS = 6000;
 
 signals:
     void taskCompleted(const QString& requestId, const TranscriptionResult& result);
+    void taskChunked(const QString& requestId, const QVector<float>& samples, const QList<qint64>& splitPoints,
+                     const QString& language, const QByteArray& cacheKey);
     void taskFailed(const QString& requestId, TranscriptionError error, const QString& errorMessage);
     void taskProgress(const QString& requestId, int progressPercent);
 
 private:
     TranscriptionRequest m_request;
     QString m_requestId;
+    whisper_context* m_context;
+    whisper_state* m_state;
+    int m_threadCount;
+    int m_lastProgress;
+    QVector<float> m_samples;
+    qint64 m_sampleOffset;
+    qint64 m_sampleCount;
+    QString m_initialPrompt;
+    bool m_chunkingEnabled;
+    QSharedPointer<QAtomicInt> m_abortFlag;
+    QElapsedTimer m_decodeTimer;
+    int m_timeoutBaseMs;
+    double m_timeoutPerAudioMs;
+    QDeadlineTimer m_deadline;
+    bool m_timedOut;
+    TranscriptionCache* m_resultCache;
+    QByteArray m_cacheParametersKey;
+    Telemetry* m_telemetry;
+    qint64 m_melElapsedNs; // Into the decode at the first encoder pass; -1 before it
+
+    TranscriptionResult buildResult(whisper_state* state) const;
+    QJsonArray extractWordTimestamps(whisper_state* state, double& averageConfidence) const;
+    static void progressCallback(whisper_context* ctx, whisper_state* state, int progress, void* userData);
+    static bool abortCallback(void* userData);
+    static bool encoderBeginCallback(whisper_context* ctx, whisper_state* state, void* userData);
 };
 
 /**
@@ -60,6 +131,27 @@ public:
     // Storage management
     void setStorageManager(IStorageManager* storageManager);
     IStorageManager* getStorageManager() const;
+    
+    // Stage timings and real-time factors go to @p telemetry, which must outlive the service
+    void setTelemetry(Telemetry* telemetry);
+    
+    // Model residency: least recently used idle models are evicted to stay within the budget
+    void setModelMemoryBudget(qint64 bytes);
+    qint64 getModelMemoryBudget() const;
+    qint64 getResidentModelBytes() const;
+    
+    // Decode backend per model. threadCount 0 means "not calibrated": fall back to setThreadCount()
+    struct BackendConfig {
+        bool useGpu = true;      // Only has an effect when whisper.cpp was built with CUDA or Metal
+        int threadCount = 0;
+        double encodeMs = 0.0;   // Encoder time measured during calibration
+    };
+    void setBackendConfig(TranscriptionProvider model, const BackendConfig& config);
+    BackendConfig getBackendConfig(TranscriptionProvider model) const;
+    bool isGpuBackendAvailable() const;
+    // Benchmarks backends and thread counts in the background; reports via backendCalibrated
+    void calibrateBackend(TranscriptionProvider model);
+    QString getModelFileName(TranscriptionProvider provider) const;
 
     // Provider Management
     QList<TranscriptionProvider> getAvailableProviders() const override;
@@ -71,14 +163,26 @@ public:
     // Model Management (whisper.cpp specific)
     bool downloadModel(TranscriptionProvider model) override;
     bool isModelDownloaded(TranscriptionProvider model) const override;
+    // Resident and ready to decode; preloadModel() reports through modelReady when it gets there
+    bool isModelLoaded(TranscriptionProvider model) const;
     void removeModel(TranscriptionProvider model) override;
     qint64 getModelSize(TranscriptionProvider model) const override;
     QString getModelPath(TranscriptionProvider model) const override;
 
     // Language Support
     QStringList getSupportedLanguages() const override;
+    // Blocks until detectLanguageAsync() resolves. On the GUI thread that is only safe with the
+    // current model resident; otherwise it returns the default language at once.
     QString detectLanguage(const QString& audioFilePath) override;
+    // Reads and detects on the decode pool, loading the model through requestModelLoad() first if
+    // needed; resolves to the default language when detection fails
+    QFuture<QString> detectLanguageAsync(const QString& audioFilePath);
     void setDefaultLanguage(const QString& languageCode) override;
+    
+    // Languages detected for "auto" requests, keyed by options["sessionId"] (or "deviceId").
+    // Later requests of the same session skip detection; seed from UserSession::getDetectedLanguage().
+    void setSessionLanguage(const QString& sessionId, const QString& languageCode);
+    QString getSessionLanguage(const QString& sessionId) const;
 
     // Transcription Operations
     QString submitTranscription(const TranscriptionRequest& request) override;
@@ -89,15 +193,36 @@ public:
     // Batch Operations
     QStringList submitBatchTranscription(const QList<TranscriptionRequest>& requests) override;
     QList<TranscriptionResult> getBatchResults(const QStringList& requestIds) const override;
+    QString getBatchId(const QString& requestId) const;
+
+    // Streaming Operations
+    QString startStreamingTranscription(const TranscriptionRequest& request) override;
+    void appendStreamingAudio(const QString& streamId, const QByteArray& pcmData) override;
+    void finishStreamingTranscription(const QString& streamId) override;
+    void cancelStreamingTranscription(const QString& streamId) override;
+    
+    // Segmented recordings: each finished segment file is decoded as soon as it is
+    // appended, while recording continues. Results are reported like a stream
+    // (segmentFinalized in recording order, then streamingTranscriptionFinished) and
+    // the merged transcription is stored once for options["recordingId"].
+    QString startSegmentedTranscription(const TranscriptionRequest& request);
+    // Reads the segment right away, so the file may be removed once this returns
+    bool appendTranscriptionSegment(const QString& sessionId, const QString& segmentPath, qint64 startMs);
+    void finishSegmentedTranscription(const QString& sessionId);
+    void cancelSegmentedTranscription(const QString& sessionId);
 
     // Configuration
     void setMaxConcurrentRequests(int maxRequests) override;
     void setTimeout(int timeoutMs) override;
     void setThreadCount(int threadCount) override;
+    // Shared with other in-process inference, so it all stays within the decode slots
+    QThreadPool* getDecodePool() const;
+    int getDecodeThreadCount() const;
 
     // Quality & Performance
     double getProviderAccuracy(TranscriptionProvider provider) const override;
     qint64 getAverageProcessingTime(TranscriptionProvider provider) const override;
+    qint64 getProcessingTimePercentile(TranscriptionProvider provider, double quantile) const;
     int getQueueLength() const override;
 
     // Audio Format Support
@@ -110,6 +235,15 @@ public:
     QString getErrorString() const override;
     void clearErrorState() override;
 
+signals:
+    void sessionLanguageDetected(const QString& sessionId, const QString& languageCode);
+    void backendCalibrated(TranscriptionProvider model, bool useGpu, int threadCount, double encodeMs);
+    // A model finished loading, on whichever thread needed it first
+    void modelReady(TranscriptionProvider model, qint64 loadMs);
+    // Aggregate throughput of a submitBatchTranscription() call; audioPerSecond is the realtime factor
+    void batchProgress(const QString& batchId, int finished, int total, double audioPerSecond);
+    void batchCompleted(const QString& batchId, int succeeded, int failed, qint64 audioMs, qint64 elapsedMs);
+
 public slots:
     void clearCache() override;
     void preloadModel(TranscriptionProvider model) override;
@@ -118,7 +252,13 @@ private slots:
     void handleTaskCompleted(const QString& requestId, const TranscriptionResult& result);
     void handleTaskFailed(const QString& requestId, TranscriptionError error, const QString& errorMessage);
     void handleTaskProgress(const QString& requestId, int progressPercent);
-    void handleModelDownloadProgress();
+    void handleTaskChunked(const QString& requestId, const QVector<float>& samples, const QList<qint64>& splitPoints,
+                           const QString& language, const QByteArray& cacheKey);
+    void handleStreamWindowDecoded(const QString& streamId, const TranscriptionResult& result);
+    void handleStreamWindowFailed(const QString& streamId, TranscriptionError error, const QString& errorMessage);
+    void handleModelDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
+    void handleModelDownloadReadyRead();
+    void handleModelDownloadFinished();
     void cleanupCompletedTasks();
     void initializeModelInfo();
     void processNextPendingRequest();
@@ -135,6 +275,18 @@ private:
     QString m_defaultLanguage;
     int m_timeoutMs;
     int m_maxConcurrentRequests;
+    int m_threadCount;
+    bool m_threadCountOverridden; // setThreadCount() wins over calibrated values
+    int m_decodeSlots; // Pool threads: enough for every concurrent request and for chunk fan-out
+    
+    // One VAD chunk of a long recording, decoded independently and stitched back by offset
+    struct ChunkJob {
+        qint64 startSample = 0;
+        qint64 endSample = 0;
+        whisper_state* state = nullptr;
+        TranscriptionResult result;
+        bool done = false;
+    };
     
     // Request tracking
     struct RequestInfo {
@@ -143,21 +295,136 @@ private:
         TranscriptionResult result;
         QElapsedTimer timer;
         bool hasResult;
+        whisper_state* state = nullptr; // Leased from the model's state pool while processing
+        QSharedPointer<QAtomicInt> abortFlag; // Shared with every decode task of this request
+        bool detectLanguage = false;          // Language was "auto" and not cached for the session
+        QByteArray cacheKey;                  // Result cache entry to fill once decoded
+        QString batchId;
+        QString segmentedSessionId;           // Set for one segment of a segmented recording
+        bool prefetching = false;             // Audio is being read ahead into request.audioBuffer
+        bool prefetched = false;              // request.audioBuffer was read ahead, not given by the caller
+        QDeadlineTimer deadline;              // Shared by a chunked request's chunks; Forever when unlimited
+        
+        // Identical submissions share one decode, which reports to its followers too
+        QByteArray flightKey;                 // Set while registered in m_inFlight
+        QStringList followers;
+        QString leaderId;                     // Set on a follower, which is never queued
+        bool detached = false;                // Cancelled by its caller, still decoding for followers
+        
+        // Chunked decode of long audio (empty for single-pass requests)
+        QVector<float> chunkAudio;      // Whole recording, shared by the chunk tasks
+        QList<ChunkJob> chunks;
+        int nextChunk = 0;
+        int chunksInFlight = 0;
+        bool chunkFailed = false;
+        TranscriptionError chunkError = TranscriptionError::NoError;
+        QString chunkErrorMessage;
     };
     
     mutable QMutex m_requestsMutex;
     QMap<QString, RequestInfo> m_activeRequests;
-    QQueue<QString> m_pendingRequests;
+    // One FIFO per priority class, served Interactive first. Cancelled entries are
+    // left in place and skipped at dequeue time, so cancelling never scans a queue.
+    QMap<TranscriptionPriority, QQueue<QString>> m_pendingRequests;
+    int m_pendingCount;
     QAtomicInt m_requestCounter;
+    int m_runningTasks;
+    QList<QString> m_chunkedRequests; // Dispatch order for chunk tasks
+    int m_chunksInFlight;
+    QHash<QByteArray, QString> m_inFlight; // Leader per flight key until it reports back
+    
+    // Batches submitted together (GUI thread only)
+    struct BatchInfo {
+        int total = 0;
+        int succeeded = 0;
+        int failed = 0;
+        qint64 audioMs = 0;
+        QElapsedTimer timer;
+    };
+    QMap<QString, BatchInfo> m_batches;
+    QThreadPool* m_prefetchPool; // Background file I/O: upcoming audio and result cache writes
     
     // Model management
     mutable QMutex m_modelsMutex;
     QMap<TranscriptionProvider, whisper_context*> m_loadedModels;
     QMap<TranscriptionProvider, QString> m_modelPaths;
+    
+    // Per-model whisper_state pool; one context is shared by up to m_maxConcurrentRequests states
+    struct StatePool {
+        QList<whisper_state*> idleStates;
+        int statesInUse = 0;
+        bool unloadPending = false; // Free the context once the last leased state returns
+    };
+    QMap<TranscriptionProvider, StatePool> m_statePools;
+    
+    // Residency tracking (guarded by m_modelsMutex)
+    qint64 m_modelMemoryBudget;
+    QMap<TranscriptionProvider, qint64> m_residentBytes;
+    QMap<TranscriptionProvider, quint64> m_modelLastUsed;
+    quint64 m_modelUseCounter;
+    QList<TranscriptionProvider> m_loadingModels;
+    QWaitCondition m_modelLoadFinished;
+    QThreadPool* m_modelLoaderPool; // Model loads, kept off the GUI thread and the decode pool
+    QList<TranscriptionProvider> m_requestedLoads; // Posted to m_modelLoaderPool (GUI thread only)
+    // Language detections waiting for their model: audio path and promise (GUI thread only)
+    QMap<TranscriptionProvider, QList<QPair<QString, std::shared_ptr<QPromise<QString>>>>> m_pendingDetections;
     QMap<TranscriptionProvider, qint64> m_modelSizes;
+    QMap<TranscriptionProvider, BackendConfig> m_backendConfigs;
+    QList<TranscriptionProvider> m_calibratingModels; // GUI thread only
+    
+    // Streaming sessions (GUI thread only). Audio after the last finalized segment is
+    // kept in 'pending' and re-decoded as a sliding window until it is committed.
+    struct StreamingSession {
+        TranscriptionRequest request;
+        AudioFileReader::Format format;
+        QVector<float> pending;
+        qint64 windowStartSample = 0;   // Absolute index of pending[0]
+        int decodedSamples = 0;         // Size of 'pending' at the last decode
+        QString finalizedText;
+        QJsonArray finalizedWords;
+        whisper_state* state = nullptr;
+        bool decodeInFlight = false;
+        bool finishing = false;
+        bool cancelled = false;
+        QElapsedTimer timer;
+    };
+    QMap<QString, StreamingSession> m_streams;
+    
+    // Segmented recordings (GUI thread only); one request per segment, merged in order
+    struct SegmentedSession {
+        TranscriptionRequest request;
+        QStringList requestIds;                     // In segment order
+        QList<qint64> segmentStartMs;
+        QMap<QString, TranscriptionResult> results; // Decoded but not yet reported
+        QList<TranscriptionResult> reported;        // Shifted onto the recording timeline
+        int nextToReport = 0;
+        int failedSegments = 0;
+        bool finishing = false;
+        QElapsedTimer timer;
+    };
+    QMap<QString, SegmentedSession> m_segmentedSessions;
+    
+    // Model downloads in flight. Bytes stream into "<model>.part" and are hashed as they
+    // arrive, so a completed download never has to be read back for verification.
+    struct ModelDownload {
+        QFile* partFile = nullptr;
+        QCryptographicHash* hash = nullptr;
+        QNetworkReply* reply = nullptr;
+        qint64 resumeOffset = 0;    // Bytes already on disk when the current request started
+        qint64 totalBytes = -1;
+        QByteArray expectedSha256;  // Hex digest announced by the server, if any
+        int retries = 0;
+    };
+    QMap<TranscriptionProvider, ModelDownload> m_downloads;
+    
+    // Decoded results by audio content and decode parameters; survives restarts
+    TranscriptionCache m_resultCache;
+    
+    // Detected language per session/device (GUI thread only)
+    QMap<QString, QString> m_sessionLanguages;
     
     // Performance tracking
-    QMap<TranscriptionProvider, QList<qint64>> m_processingTimes;
+    QMap<TranscriptionProvider, LatencyHistogram> m_processingTimes; // Milliseconds
     QMap<TranscriptionProvider, double> m_accuracyRatings;
     
     // Cleanup timer
@@ -165,10 +432,11 @@ private:
     
     // Storage integration
     IStorageManager* m_storageManager;
+    Telemetry* m_telemetry;
     
     // Storage integration methods
-    void saveTranscriptionToStorage(const TranscriptionResult& result);
-    void saveTranscriptionToStorage(const QString& requestId, const TranscriptionResult& result);
+    void saveTranscriptionToStorage(const QString& recordingId, const TranscriptionResult& result);
+    void saveRequestTranscriptionToStorage(const QString& requestId, const TranscriptionResult& result);
     void updateTranscriptionInStorage(const QString& transcriptionId, const TranscriptionResult& result);
     
     // Helper methods
@@ -177,13 +445,67 @@ private:
     void cleanupProvider(TranscriptionProvider provider);
     
     // Whisper.cpp integration
-    whisper_context* loadWhisperModel(TranscriptionProvider provider);
+    whisper_context* loadWhisperModel(TranscriptionProvider provider, bool reportErrors = true);
+    // The loaded context, or nullptr without waiting for a load in progress
+    whisper_context* residentModel(TranscriptionProvider provider);
+    // Loads on m_modelLoaderPool; handleModelReady() or handleModelLoadFailed() follows (GUI thread only)
+    void requestModelLoad(TranscriptionProvider provider);
+    void handleModelReady(TranscriptionProvider provider);
+    void handleModelLoadFailed(TranscriptionProvider provider);
+    whisper_context* initWhisperContext(const QString& modelPath, bool useGpu) const;
+    int threadCountFor(TranscriptionProvider provider) const;
+    // A request's own timeoutMs, or m_timeoutMs plus an allowance per millisecond of audio
+    // that grows with the model's size
+    void timeoutFor(const TranscriptionRequest& request, int* baseMs, double* perAudioMs) const;
+    static QVector<float> makeCalibrationClip();
+    void touchModelLocked(TranscriptionProvider provider);
+    void evictModelsLocked(TranscriptionProvider keep, qint64 requiredBytes);
     void unloadWhisperModel(TranscriptionProvider provider);
     bool isWhisperModelLoaded(TranscriptionProvider provider) const;
-    TranscriptionResult processWithWhisper(const TranscriptionRequest& request, const QString& requestId);
+    // AwaitingModel leaves the request pending; it is started again once its model is loaded
+    enum class TaskStart { Started, AwaitingModel, Failed };
+    TaskStart startTranscriptionTask(const QString& requestId); // Caller holds m_requestsMutex
+    void releaseRequestState(const QString& requestId);     // Caller holds m_requestsMutex
+    void enqueuePendingRequest(const QString& requestId, bool atFront = false); // Caller holds m_requestsMutex
+    QString takeNextPendingRequest();                       // Caller holds m_requestsMutex
+    bool stopRequestLocked(const QString& requestId, QString* pendingBatchId);
+    // Reports requests that failed before reaching a worker; pairs are (id, message)
+    void reportFailedToStart(const QList<QPair<QString, QString>>& failures);
+    
+    // Single-flight: identical requests queued or decoding are coalesced
+    QByteArray flightKey(const TranscriptionRequest& request, const QByteArray& cacheKey) const;
+    QStringList subscribersLocked(const QString& requestId) const;
+    QStringList takeFollowersLocked(const QString& requestId);
+    void completeFollowers(const QStringList& followers, const TranscriptionResult* result,
+                           TranscriptionError error, const QString& errorMessage);
+    void updateDecodeSlots();
+    
+    // Batch execution
+    void prefetchPendingAudio();
+    void updateBatchProgress(const QString& batchId, bool succeeded, qint64 audioMs);
+    
+    // Chunked decoding
+    void dispatchChunks();
+    void handleChunkCompleted(const QString& requestId, int chunkIndex, const TranscriptionResult& result);
+    void handleChunkFailed(const QString& requestId, int chunkIndex, TranscriptionError error, const QString& errorMessage);
+    void finishChunkedRequest(const QString& requestId);
+    TranscriptionResult stitchChunkResults(const QString& requestId, const RequestInfo& info) const;
+    
+    // Streaming helpers
+    void scheduleStreamWindow(const QString& streamId);
+    void completeStream(const QString& streamId);
+    
+    // Segmented recording helpers
+    void handleSegmentResult(const QString& sessionId, const QString& requestId, const TranscriptionResult* result);
+    void completeSegmentedSession(const QString& sessionId);
+    
+    // whisper_state pool (guarded by m_modelsMutex)
+    whisper_state* acquireWhisperState(TranscriptionProvider provider, whisper_context* ctx, bool reportErrors = true);
+    void releaseWhisperState(TranscriptionProvider provider, whisper_state* state);
+    void trimStatePools();
+    void freeModelLocked(TranscriptionProvider provider);
     
     // Model file management
-    QString getModelFileName(TranscriptionProvider provider) const;
     QString getModelsDirectory() const;
     bool validateModelFile(const QString& modelPath) const;
     bool createModelsDirectory() const;
@@ -194,8 +516,12 @@ private:
     bool validateAudioFormat(const QString& audioPath);
     
     // Language detection and processing
-    QString detectLanguageFromAudio(const QString& audioPath);
-    QStringList extractWordTimestamps(whisper_context* ctx, int segmentCount);
+    void startLanguageDetection(TranscriptionProvider provider, const std::shared_ptr<QPromise<QString>>& promise,
+                                const QString& audioPath);
+    QString languageCacheKey(const TranscriptionRequest& request) const;
+    QByteArray cacheParametersKey(const TranscriptionRequest& request) const;
+    bool applyCachedLanguage(TranscriptionRequest& request) const; // False if detection is still needed
+    void rememberDetectedLanguage(const TranscriptionRequest& request, const QString& languageCode);
     
     // Performance tracking
     void updateProcessingTime(TranscriptionProvider provider, qint64 processingTime);
@@ -213,6 +539,9 @@ private:
     
     // Model download helpers
     void downloadModelAsync(TranscriptionProvider model);
+    void sendModelDownloadRequest(TranscriptionProvider model);
+    void finishModelDownload(TranscriptionProvider model, const QString& errorMessage);
+    TranscriptionProvider findDownloadByReply(QNetworkReply* reply) const;
     QString getModelDownloadUrl(TranscriptionProvider model) const;
     bool verifyModelIntegrity(const QString& modelPath) const;
     
@@ -220,8 +549,26 @@ private:
     static constexpr int DEFAULT_TIMEOUT_MS = 30000;
     static constexpr int DEFAULT_MAX_CONCURRENT = 2;
     static constexpr int DEFAULT_THREAD_COUNT = 2;
+    static constexpr int MAX_AUTO_THREAD_COUNT = 8;  // whisper scales poorly past this per decode
+    static constexpr int CALIBRATION_CLIP_MS = 5000;
+    static constexpr int CALIBRATION_RUNS = 2;       // Best of N after one warm-up pass
+    static constexpr double CALIBRATION_MIN_GAIN = 0.05; // More threads must be 5% faster to win
     static constexpr int CLEANUP_INTERVAL_MS = 60000; // 1 minute
     static constexpr int MAX_COMPLETED_REQUESTS = 100;
+    static constexpr int PREFETCH_DEPTH = 2; // Pending requests whose audio is read ahead
+    
+    // Model download parameters
+    static constexpr qint64 DOWNLOAD_READ_BUFFER_SIZE = 1024 * 1024; // Cap in-memory reply data at 1MB
+    static constexpr int MAX_DOWNLOAD_RETRIES = 5;
+    static constexpr int DOWNLOAD_RETRY_DELAY_MS = 2000;   // Doubles with each retry
+    static constexpr qint64 DEFAULT_MODEL_MEMORY_BUDGET = 2048LL * 1024 * 1024; // 2GB
+    
+    // Streaming window parameters
+    static constexpr int STREAM_STEP_MS = 2000;        // New audio needed before re-decoding
+    static constexpr int STREAM_OVERLAP_MS = 1000;     // Tail kept unstable for the next window
+    static constexpr int STREAM_MAX_WINDOW_MS = 15000; // Force-commit once the window grows this long
+    static constexpr int STREAM_MIN_DECODE_MS = 200;   // Shorter leftovers are not worth a decode
+    static constexpr int STREAM_PROMPT_CHARS = 200;    // Finalized text carried into the prompt
     
     // Model size constants (approximate sizes in bytes)
     static constexpr qint64 WHISPER_TINY_SIZE = 39 * 1024 * 1024;    // ~39MB
@@ -0,0 +1,96 @@
+#include "VoiceActivityDetector.h"
+#include <QtGlobal>
+#include <algorithm>
+
+QVector<bool> VoiceActivityDetector::classifyFrames(const QVector<float>& samples, int sampleRate,
+                                                    QVector<float>* frameEnergy) {
+    const int frameSize = qMax(1, sampleRate * FRAME_MS / 1000);
+    const int frameCount = static_cast<int>(samples.size() / frameSize);
+
+    QVector<float> energy(frameCount);
+    const float* data = samples.constData();
+    for (int f = 0; f < frameCount; ++f) {
+        const float* frame = data + static_cast<qint64>(f) * frameSize;
+        float sum = 0.0f;
+        for (int i = 0; i < frameSize; ++i) {
+            sum += frame[i] * frame[i];
+        }
+        energy[f] = sum / frameSize;
+    }
+
+    QVector<bool> silence(frameCount, false);
+    if (frameCount > 0) {
+        // Adapt to the recording: speech is whatever stands well above its quietest frames
+        QVector<float> sorted = energy;
+        const int floorIndex = static_cast<int>(frameCount * NOISE_FLOOR_PERCENTILE);
+        std::nth_element(sorted.begin(), sorted.begin() + floorIndex, sorted.end());
+        const float threshold = qMax(MIN_SPEECH_ENERGY, sorted[floorIndex] * SPEECH_OVER_FLOOR_RATIO);
+
+        for (int f = 0; f < frameCount; ++f) {
+            silence[f] = energy[f] < threshold;
+        }
+    }
+
+    if (frameEnergy) {
+        *frameEnergy = energy;
+    }
+    return silence;
+}
+
+QList<qint64> VoiceActivityDetector::findSplitPoints(const QVector<float>& samples, int sampleRate,
+                                                     int targetChunkMs, int maxChunkMs) {
+    QList<qint64> splits;
+    const qint64 totalMs = sampleRate > 0 ? samples.size() * 1000 / sampleRate : 0;
+    if (totalMs <= maxChunkMs) {
+        return splits;
+    }
+
+    QVector<float> energy;
+    const QVector<bool> silence = classifyFrames(samples, sampleRate, &energy);
+    const int frameSize = qMax(1, sampleRate * FRAME_MS / 1000);
+    const int frameCount = silence.size();
+    const int targetFrames = targetChunkMs / FRAME_MS;
+    const int maxFrames = maxChunkMs / FRAME_MS;
+    const int minSilenceFrames = MIN_SILENCE_MS / FRAME_MS;
+
+    int chunkStart = 0;
+    while (frameCount - chunkStart > maxFrames) {
+        const int searchBegin = chunkStart + targetFrames;
+        const int searchEnd = qMin(frameCount, chunkStart + maxFrames);
+
+        // Longest silence run inside [target, max) of the current chunk
+        int bestRunStart = -1;
+        int bestRunLength = 0;
+        int runStart = -1;
+        for (int f = searchBegin; f <= searchEnd; ++f) {
+            const bool isSilent = f < searchEnd && silence[f];
+            if (isSilent && runStart < 0) {
+                runStart = f;
+            } else if (!isSilent && runStart >= 0) {
+                if (f - runStart > bestRunLength) {
+                    bestRunLength = f - runStart;
+                    bestRunStart = runStart;
+                }
+                runStart = -1;
+            }
+        }
+
+        int cutFrame;
+        if (bestRunLength >= minSilenceFrames) {
+            cutFrame = bestRunStart + bestRunLength / 2;
+        } else {
+            // No real pause: cut at the quietest frame so the damage is smallest
+            cutFrame = searchBegin;
+            for (int f = searchBegin; f < searchEnd; ++f) {
+                if (energy[f] < energy[cutFrame]) {
+                    cutFrame = f;
+                }
+            }
+        }
+
+        splits.append(static_cast<qint64>(cutFrame) * frameSize);
+        chunkStart = cutFrame;
+    }
+
+    return splits;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QList>
+#include <QVector>
+
+/**
+ * @brief VoiceActivityDetector - Energy-based speech/silence segmentation
+ *
+ * Finds pauses in 16 kHz mono float audio so long recordings can be cut into
+ * chunks that are decoded independently. Cuts land in the middle of the longest
+ * silence near the target chunk length, so no word is split across chunks.
+ */
+class VoiceActivityDetector {
+public:
+    // Sample indices at which to cut; empty when the audio fits in one chunk
+    static QList<qint64> findSplitPoints(const QVector<float>& samples, int sampleRate,
+                                         int targetChunkMs = DEFAULT_TARGET_CHUNK_MS,
+                                         int maxChunkMs = DEFAULT_MAX_CHUNK_MS);
+
+    // Per-frame "is silence" flags for FRAME_MS frames
+    static QVector<bool> classifyFrames(const QVector<float>& samples, int sampleRate,
+                                        QVector<float>* frameEnergy = nullptr);
+
+    static constexpr int FRAME_MS = 30;
+    static constexpr int MIN_SILENCE_MS = 300;
+    static constexpr int DEFAULT_TARGET_CHUNK_MS = 30000;
+    static constexpr int DEFAULT_MAX_CHUNK_MS = 60000;
+
+private:
+    static constexpr float NOISE_FLOOR_PERCENTILE = 0.10f;
+    static constexpr float SPEECH_OVER_FLOOR_RATIO = 4.0f; // ~6 dB above the noise floor
+    static constexpr float MIN_SPEECH_ENERGY = 1e-5f;      // ~-50 dBFS
+};
@@ -76,6 +76,15 @@ public:
         return false; // Fail by default for TDD
     }
 
+    bool startBackup(const QString& backupPath) override {
+        Q_UNUSED(backupPath)
+        return false; // Fail by default for TDD
+    }
+
+    bool isBackupRunning() const override {
+        return false;
+    }
+
     bool restoreDatabase(const QString& backupPath) override {
         Q_UNUSED(backupPath)
         return false; // Fail by default for TDD
@@ -119,6 +119,25 @@ public:
         return {};
     }
 
+    // Streaming Operations
+    QString startStreamingTranscription(const TranscriptionRequest& request) override {
+        Q_UNUSED(request)
+        return QString(); // Should return stream ID
+    }
+
+    void appendStreamingAudio(const QString& streamId, const QByteArray& pcmData) override {
+        Q_UNUSED(streamId)
+        Q_UNUSED(pcmData)
+    }
+
+    void finishStreamingTranscription(const QString& streamId) override {
+        Q_UNUSED(streamId)
+    }
+
+    void cancelStreamingTranscription(const QString& streamId) override {
+        Q_UNUSED(streamId)
+    }
+
     // Configuration
     void setMaxConcurrentRequests(int maxRequests) override {
         Q_UNUSED(maxRequests)
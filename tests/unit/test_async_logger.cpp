@@ -0,0 +1,220 @@
+// Unit Test for AsyncLogger
+// Logs into a temporary directory: everything queued is written by flush(), stop()
+// and destruction, a full queue drops and reports, repeats are summarized, and the
+// file rotates past its size limit keeping a bounded number of files
+
+#include <gtest/gtest.h>
+#include <QFile>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <memory>
+
+#include "../../src/services/AsyncLogger.h"
+
+namespace {
+
+QStringList readLines(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    QStringList lines = QString::fromUtf8(file.readAll()).split('\n');
+    if (!lines.isEmpty() && lines.last().isEmpty()) {
+        lines.removeLast();
+    }
+    return lines;
+}
+
+// The message part of "[timestamp] TYPE category: message" lines
+QStringList messages(const QStringList& lines) {
+    QStringList result;
+    for (const QString& line : lines) {
+        result.append(line.section(": ", 1));
+    }
+    return result;
+}
+
+QStringList numbered(int count) {
+    QStringList list;
+    for (int i = 0; i < count; ++i) {
+        list.append(QString("message %1").arg(i));
+    }
+    return list;
+}
+
+Q_LOGGING_CATEGORY(lcLoggerTest, "quillscribe.test")
+
+class AsyncLoggerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_dir.isValid());
+        m_path = m_dir.filePath("logs/app.log");
+    }
+
+    std::unique_ptr<AsyncLogger> makeLogger() {
+        auto logger = std::make_unique<AsyncLogger>(m_path);
+        logger->setEchoToConsole(false);
+        return logger;
+    }
+
+    QTemporaryDir m_dir;
+    QString m_path;
+};
+
+} // namespace
+
+TEST_F(AsyncLoggerTest, StopWritesEverythingQueued) {
+    std::unique_ptr<AsyncLogger> logger = makeLogger();
+    // Queued before the flush thread exists
+    ASSERT_TRUE(logger->log(QtInfoMsg, "early", "before start"));
+    ASSERT_TRUE(logger->start());
+    EXPECT_TRUE(logger->isRunning());
+    for (const QString& message : numbered(2000)) {
+        ASSERT_TRUE(logger->log(QtDebugMsg, "test", message));
+    }
+    logger->stop();
+    EXPECT_FALSE(logger->isRunning());
+
+    const QStringList lines = readLines(m_path);
+    ASSERT_EQ(lines.size(), 2001);
+    EXPECT_TRUE(lines.first().endsWith("] INFO early: before start")) << lines.first().toStdString();
+    EXPECT_EQ(messages(lines).mid(1), numbered(2000));
+    EXPECT_EQ(logger->droppedCount(), 0u);
+}
+
+TEST_F(AsyncLoggerTest, DestructionWritesEverythingQueued) {
+    {
+        std::unique_ptr<AsyncLogger> logger = makeLogger();
+        ASSERT_TRUE(logger->start());
+        for (const QString& message : numbered(100)) {
+            logger->log(QtWarningMsg, nullptr, message);
+        }
+    }
+    const QStringList lines = readLines(m_path);
+    EXPECT_EQ(messages(lines), numbered(100));
+    EXPECT_TRUE(lines.last().contains("] WARNING default: ")) << lines.last().toStdString();
+}
+
+TEST_F(AsyncLoggerTest, FlushWaitsForTheWrite) {
+    std::unique_ptr<AsyncLogger> logger = makeLogger();
+    ASSERT_TRUE(logger->start());
+    logger->log(QtCriticalMsg, "test", "written by now");
+    logger->flush();
+    EXPECT_EQ(messages(readLines(m_path)), QStringList{"written by now"});
+
+    // A restart appends to the same file
+    logger->stop();
+    ASSERT_TRUE(logger->start());
+    logger->log(QtCriticalMsg, "test", "after restart");
+    logger->flush();
+    EXPECT_EQ(messages(readLines(m_path)), (QStringList{"written by now", "after restart"}));
+}
+
+TEST_F(AsyncLoggerTest, FullQueueDropsAndReportsTheCount) {
+    std::unique_ptr<AsyncLogger> logger = makeLogger();
+    // Nothing drains before start(), so the queue fills
+    const QStringList queued = numbered(AsyncLogger::QUEUE_CAPACITY);
+    for (const QString& message : queued) {
+        ASSERT_TRUE(logger->log(QtDebugMsg, "test", message));
+    }
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_FALSE(logger->log(QtDebugMsg, "test", "no room"));
+    }
+    EXPECT_EQ(logger->droppedCount(), 10u);
+
+    ASSERT_TRUE(logger->start());
+    logger->stop();
+    const QStringList written = messages(readLines(m_path));
+    ASSERT_EQ(written.size(), AsyncLogger::QUEUE_CAPACITY + 1);
+    EXPECT_EQ(written.mid(0, AsyncLogger::QUEUE_CAPACITY), queued);
+    EXPECT_EQ(written.last(), "10 messages dropped, the log queue was full");
+}
+
+TEST_F(AsyncLoggerTest, RepeatsWithinTheWindowAreSummarized) {
+    std::unique_ptr<AsyncLogger> logger = makeLogger();
+    logger->setRepeatWindow(60000);
+    ASSERT_TRUE(logger->start());
+    for (int i = 0; i < 5; ++i) {
+        logger->log(QtWarningMsg, "audio", "buffer underrun");
+    }
+    logger->log(QtCriticalMsg, "audio", "buffer underrun");  // Another type
+    logger->log(QtWarningMsg, "storage", "buffer underrun"); // Another category
+    logger->stop(); // Closes every open window
+
+    EXPECT_EQ(logger->suppressedCount(), 4u);
+    const QStringList lines = readLines(m_path);
+    ASSERT_EQ(lines.size(), 4);
+    EXPECT_EQ(lines.filter("WARNING audio: buffer underrun").size(), 1);
+    EXPECT_EQ(lines.filter("CRITICAL audio: buffer underrun").size(), 1);
+    EXPECT_EQ(lines.filter("WARNING storage: buffer underrun").size(), 1);
+    EXPECT_EQ(lines.filter("WARNING audio: (repeated 4 more times) buffer underrun").size(), 1);
+}
+
+TEST_F(AsyncLoggerTest, ZeroRepeatWindowWritesEveryRepeat) {
+    std::unique_ptr<AsyncLogger> logger = makeLogger();
+    logger->setRepeatWindow(0);
+    ASSERT_TRUE(logger->start());
+    for (int i = 0; i < 5; ++i) {
+        logger->log(QtWarningMsg, "audio", "buffer underrun");
+    }
+    logger->stop();
+    EXPECT_EQ(readLines(m_path).size(), 5);
+    EXPECT_EQ(logger->suppressedCount(), 0u);
+}
+
+TEST_F(AsyncLoggerTest, RotatesPastTheSizeLimitAndKeepsMaxFiles) {
+    std::unique_ptr<AsyncLogger> logger = makeLogger();
+    logger->setMaxFileBytes(1024);
+    logger->setMaxFiles(3);
+    ASSERT_TRUE(logger->start());
+    const QString padding(60, 'x');
+    for (int i = 0; i < 80; ++i) {
+        logger->log(QtInfoMsg, "test", QString("line %1 %2").arg(i).arg(padding));
+        logger->flush();
+    }
+    logger->stop();
+
+    EXPECT_TRUE(QFileInfo::exists(AsyncLogger::rotatedPath(m_path, 1)));
+    EXPECT_TRUE(QFileInfo::exists(AsyncLogger::rotatedPath(m_path, 2)));
+    EXPECT_FALSE(QFileInfo::exists(AsyncLogger::rotatedPath(m_path, 3)));
+
+    // Oldest first across the kept files, every one within the limit, the newest line last
+    QStringList kept;
+    for (int index = 2; index >= 0; --index) {
+        const QString path = AsyncLogger::rotatedPath(m_path, index);
+        EXPECT_LE(QFileInfo(path).size(), 1024) << path.toStdString();
+        kept += messages(readLines(path));
+    }
+    ASSERT_FALSE(kept.isEmpty());
+    EXPECT_LT(kept.size(), 80);
+    EXPECT_TRUE(kept.last().startsWith("line 79 "));
+    const int first = kept.first().section(' ', 1, 1).toInt();
+    for (int i = 0; i < kept.size(); ++i) {
+        EXPECT_TRUE(kept[i].startsWith(QString("line %1 ").arg(first + i))) << kept[i].toStdString();
+    }
+}
+
+TEST_F(AsyncLoggerTest, InstalledHandlerTakesQtMessages) {
+    std::unique_ptr<AsyncLogger> logger = makeLogger();
+    ASSERT_TRUE(logger->start());
+    logger->install();
+    qWarning("plain warning");
+    qCWarning(lcLoggerTest) << "categorized warning";
+    logger->uninstall();
+    qWarning("after uninstall");
+    logger->flush();
+
+    const QStringList lines = readLines(m_path);
+    ASSERT_EQ(lines.size(), 2);
+    EXPECT_TRUE(lines[0].endsWith("WARNING default: plain warning")) << lines[0].toStdString();
+    EXPECT_TRUE(lines[1].endsWith("WARNING quillscribe.test: categorized warning")) << lines[1].toStdString();
+}
+
+TEST(AsyncLoggerStaticTest, RotatedPathsNumberBeforeTheSuffix) {
+    EXPECT_EQ(AsyncLogger::rotatedPath("/var/log/app.log", 0), "/var/log/app.log");
+    EXPECT_EQ(AsyncLogger::rotatedPath("/var/log/app.log", 2), "/var/log/app.2.log");
+    EXPECT_EQ(AsyncLogger::rotatedPath("/var/log/app.debug.log", 1), "/var/log/app.debug.1.log");
+    EXPECT_EQ(AsyncLogger::rotatedPath("/var/log/app", 1), "/var/log/app.1");
+}
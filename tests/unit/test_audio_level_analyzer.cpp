@@ -0,0 +1,138 @@
+// Unit Test for AudioLevelAnalyzer
+// Checks whichever vector kernel this machine dispatches to against a scalar
+// reference, across lengths that leave tails, and each supported sample format
+
+#include <gtest/gtest.h>
+#include <QStringList>
+#include <QVector>
+#include <cmath>
+
+#include "../../src/services/AudioLevelAnalyzer.h"
+
+namespace {
+
+AudioFileReader::Format formatOf(int bytesPerSample, bool isFloat = false) {
+    AudioFileReader::Format format;
+    format.bytesPerSample = bytesPerSample;
+    format.isFloat = isFloat;
+    return format;
+}
+
+template <typename T>
+AudioLevelStats analyze(const QVector<T>& samples, const AudioFileReader::Format& format) {
+    return AudioLevelAnalyzer::analyze(reinterpret_cast<const char*>(samples.constData()),
+                                       samples.size() * static_cast<qint64>(sizeof(T)), format);
+}
+
+// Deterministic pseudo-random 16-bit audio that sometimes hits full scale
+QVector<qint16> noise(int count) {
+    QVector<qint16> samples(count);
+    quint32 state = 12345;
+    for (int i = 0; i < count; ++i) {
+        state = state * 1664525u + 1013904223u;
+        samples[i] = (i % 97 == 0) ? qint16(-32768) : static_cast<qint16>(state >> 16);
+    }
+    return samples;
+}
+
+} // namespace
+
+TEST(AudioLevelAnalyzerTest, EmptyInputGivesSilence) {
+    const AudioLevelStats stats = AudioLevelAnalyzer::analyze(nullptr, 0, formatOf(2));
+    EXPECT_EQ(stats.sampleCount, 0);
+    EXPECT_EQ(stats.rms, 0.0);
+    EXPECT_EQ(stats.peak, 0.0);
+    EXPECT_FALSE(stats.isClipping());
+}
+
+TEST(AudioLevelAnalyzerTest, Int16MatchesTheScalarReferenceAtEveryTailLength) {
+    // Covers every remainder of the 8- and 16-lane kernels, and more than one 4096-sample block
+    QList<int> lengths;
+    for (int length = 1; length <= 40; ++length) {
+        lengths.append(length);
+    }
+    lengths << 4095 << 4096 << 4097 << 10001;
+
+    for (const int length : lengths) {
+        const QVector<qint16> samples = noise(length);
+        double sumSquares = 0.0;
+        double peak = 0.0;
+        qint64 clipped = 0;
+        for (const qint16 sample : samples) {
+            const double x = sample / 32768.0;
+            sumSquares += x * x;
+            peak = qMax(peak, std::fabs(x));
+            clipped += std::fabs(x) >= AudioLevelAnalyzer::CLIP_THRESHOLD ? 1 : 0;
+        }
+
+        const AudioLevelStats stats = analyze(samples, formatOf(2));
+        EXPECT_EQ(stats.sampleCount, length);
+        EXPECT_NEAR(stats.rms, std::sqrt(sumSquares / length), 1e-5) << "length " << length;
+        EXPECT_NEAR(stats.peak, peak, 1e-6) << "length " << length;
+        EXPECT_EQ(stats.clippedSamples, clipped) << "length " << length;
+    }
+}
+
+TEST(AudioLevelAnalyzerTest, FullScaleSquareWave) {
+    QVector<qint16> samples(1000);
+    for (int i = 0; i < samples.size(); ++i) {
+        samples[i] = (i / 10) % 2 ? qint16(32767) : qint16(-32768);
+    }
+    const AudioLevelStats stats = analyze(samples, formatOf(2));
+    EXPECT_NEAR(stats.rms, 1.0, 1e-4);
+    EXPECT_DOUBLE_EQ(stats.peak, 1.0);
+    EXPECT_EQ(stats.clippedSamples, 1000);
+}
+
+TEST(AudioLevelAnalyzerTest, QuietSineIsNotClipping) {
+    QVector<qint16> samples(16000);
+    for (int i = 0; i < samples.size(); ++i) {
+        samples[i] = static_cast<qint16>(16384 * std::sin(2.0 * M_PI * 440.0 * i / 16000.0));
+    }
+    const AudioLevelStats stats = analyze(samples, formatOf(2));
+    EXPECT_NEAR(stats.rms, 0.5 / std::sqrt(2.0), 1e-3);
+    EXPECT_NEAR(stats.peak, 0.5, 1e-3);
+    EXPECT_FALSE(stats.isClipping());
+}
+
+TEST(AudioLevelAnalyzerTest, FloatSamplesAreClampedAndCounted) {
+    const QVector<float> samples{0.0f, 0.5f, -0.5f, 0.9995f, -1.0f, 1.5f, 0.25f, -0.25f, 0.1f};
+    const AudioLevelStats stats = analyze(samples, formatOf(4, true));
+    EXPECT_EQ(stats.sampleCount, samples.size());
+    EXPECT_DOUBLE_EQ(stats.peak, 1.0); // 1.5 is over full scale; the result stays normalized
+    EXPECT_EQ(stats.clippedSamples, 3);
+    EXPECT_LE(stats.rms, 1.0);
+}
+
+TEST(AudioLevelAnalyzerTest, Int32AndUnsigned8BitAreNormalized) {
+    const QVector<qint32> wide{1 << 30, -(1 << 30), 0, 2147483647};
+    const AudioLevelStats wideStats = analyze(wide, formatOf(4));
+    EXPECT_EQ(wideStats.sampleCount, 4);
+    EXPECT_NEAR(wideStats.peak, 1.0, 1e-6);
+    EXPECT_EQ(wideStats.clippedSamples, 1);
+    EXPECT_NEAR(wideStats.rms, std::sqrt((0.25 + 0.25 + 0.0 + 1.0) / 4.0), 1e-5);
+
+    // Unsigned 8-bit is centred on 128; 0 is negative full scale, 255 just short of positive
+    const QVector<quint8> narrow{128, 128, 0, 255, 192};
+    const AudioLevelStats narrowStats = analyze(narrow, formatOf(1));
+    EXPECT_EQ(narrowStats.sampleCount, 5);
+    EXPECT_DOUBLE_EQ(narrowStats.peak, 1.0);
+    EXPECT_EQ(narrowStats.clippedSamples, 1);
+}
+
+TEST(AudioLevelAnalyzerTest, PartialSamplesAndUnknownFormatsAreIgnored) {
+    const QVector<qint16> samples{16384, -16384, 0};
+    // Two whole samples and half of the third
+    const AudioLevelStats partial = AudioLevelAnalyzer::analyze(reinterpret_cast<const char*>(samples.constData()),
+                                                                5, formatOf(2));
+    EXPECT_EQ(partial.sampleCount, 2);
+    EXPECT_NEAR(partial.rms, 0.5, 1e-6);
+
+    const AudioLevelStats packed24 = AudioLevelAnalyzer::analyze(reinterpret_cast<const char*>(samples.constData()),
+                                                                 6, formatOf(3));
+    EXPECT_EQ(packed24.sampleCount, 0);
+}
+
+TEST(AudioLevelAnalyzerTest, ReportsAKnownKernel) {
+    EXPECT_TRUE((QStringList{"avx2", "sse2", "neon", "scalar"}).contains(AudioLevelAnalyzer::activeKernel()));
+}
@@ -0,0 +1,167 @@
+// Unit Test for AudioRingBuffer
+// Covers capacity rounding, the full and empty edges, wraparound and one
+// producer racing one consumer
+
+#include <gtest/gtest.h>
+#include <QByteArray>
+#include <QThread>
+#include <memory>
+
+#include "../../src/services/AudioRingBuffer.h"
+
+namespace {
+
+// Byte @p index of an endless, never-repeating-within-256 sequence
+char patternByte(quint64 index) {
+    return static_cast<char>((index * 7 + 3) & 0xFF);
+}
+
+QByteArray pattern(quint64 first, int len) {
+    QByteArray bytes(len, Qt::Uninitialized);
+    for (int i = 0; i < len; ++i) {
+        bytes[i] = patternByte(first + i);
+    }
+    return bytes;
+}
+
+} // namespace
+
+TEST(AudioRingBufferTest, CapacityRoundsUpToAPowerOfTwo) {
+    EXPECT_EQ(AudioRingBuffer(1000).capacity(), 1024);
+    EXPECT_EQ(AudioRingBuffer(4096).capacity(), 4096);
+    EXPECT_EQ(AudioRingBuffer(1).capacity(), 1);
+
+    AudioRingBuffer ring(10);
+    ring.reset(3000);
+    EXPECT_EQ(ring.capacity(), 4096);
+}
+
+TEST(AudioRingBufferTest, UnallocatedRingAcceptsNothing) {
+    AudioRingBuffer ring;
+    char byte = 0;
+    EXPECT_EQ(ring.capacity(), 0);
+    EXPECT_EQ(ring.write("abc", 3), 0);
+    EXPECT_EQ(ring.read(&byte, 1), 0);
+    EXPECT_EQ(ring.availableToRead(), 0);
+}
+
+TEST(AudioRingBufferTest, EmptyRingReadsNothing) {
+    AudioRingBuffer ring(64);
+    char buffer[16];
+    EXPECT_EQ(ring.availableToRead(), 0);
+    EXPECT_EQ(ring.availableToWrite(), 64);
+    EXPECT_EQ(ring.read(buffer, sizeof(buffer)), 0);
+
+    // Drained after a write: empty again, with the indices no longer at zero
+    ASSERT_EQ(ring.write("hello", 5), 5);
+    EXPECT_EQ(ring.read(buffer, sizeof(buffer)), 5);
+    EXPECT_EQ(QByteArray(buffer, 5), QByteArray("hello"));
+    EXPECT_EQ(ring.read(buffer, sizeof(buffer)), 0);
+    EXPECT_EQ(ring.availableToWrite(), 64);
+}
+
+TEST(AudioRingBufferTest, FullRingDropsAndCountsTheExcess) {
+    AudioRingBuffer ring(16);
+    const QByteArray data = pattern(0, 16);
+    ASSERT_EQ(ring.write(data.constData(), data.size()), 16);
+    EXPECT_EQ(ring.availableToWrite(), 0);
+    EXPECT_EQ(ring.availableToRead(), 16);
+
+    // Nothing fits: the whole write is dropped
+    EXPECT_EQ(ring.write("0123456789", 10), 0);
+    EXPECT_EQ(ring.droppedBytes(), 10u);
+
+    // Room for part of the next write only
+    char buffer[4];
+    ASSERT_EQ(ring.read(buffer, 4), 4);
+    EXPECT_EQ(ring.write("0123456789", 10), 4);
+    EXPECT_EQ(ring.droppedBytes(), 16u);
+
+    // What was accepted follows what was already queued
+    QByteArray drained(16, Qt::Uninitialized);
+    ASSERT_EQ(ring.read(drained.data(), drained.size()), 16);
+    EXPECT_EQ(drained, data.mid(4) + QByteArray("0123"));
+}
+
+TEST(AudioRingBufferTest, WrapsAroundWithoutLosingOrder) {
+    AudioRingBuffer ring(16);
+    quint64 written = 0;
+    quint64 read = 0;
+
+    // Sizes that do not divide the capacity, so writes and reads straddle the end
+    const int writeSizes[] = {5, 7, 3, 11, 1, 9};
+    const int readSizes[] = {3, 8, 6, 2, 10};
+    for (int round = 0; round < 200; ++round) {
+        const int toWrite = writeSizes[round % 6];
+        if (ring.availableToWrite() >= toWrite) {
+            const QByteArray bytes = pattern(written, toWrite);
+            ASSERT_EQ(ring.write(bytes.constData(), toWrite), toWrite);
+            written += toWrite;
+        }
+
+        char buffer[16];
+        const qsizetype got = ring.read(buffer, readSizes[round % 5]);
+        ASSERT_EQ(QByteArray(buffer, static_cast<int>(got)), pattern(read, static_cast<int>(got)))
+            << "at byte " << read;
+        read += got;
+        EXPECT_EQ(ring.availableToRead(), static_cast<qsizetype>(written - read));
+    }
+
+    EXPECT_GT(written, 16u * 20) << "The indices should have wrapped many times";
+    EXPECT_EQ(ring.droppedBytes(), 0u);
+}
+
+TEST(AudioRingBufferTest, ResetEmptiesTheRing) {
+    AudioRingBuffer ring(8);
+    ring.write("0123456789", 10);
+    ASSERT_EQ(ring.droppedBytes(), 2u);
+
+    ring.reset(8);
+    EXPECT_EQ(ring.availableToRead(), 0);
+    EXPECT_EQ(ring.availableToWrite(), 8);
+    EXPECT_EQ(ring.droppedBytes(), 0u);
+}
+
+TEST(AudioRingBufferTest, ConsumerSeesEveryByteTheProducerWrote) {
+    AudioRingBuffer ring(1024);
+    constexpr quint64 TOTAL_BYTES = 4 * 1024 * 1024;
+
+    // The producer only writes what fits, as RecordingFileWriter does, so nothing drops
+    std::unique_ptr<QThread> producer(QThread::create([&ring]() {
+        quint64 written = 0;
+        while (written < TOTAL_BYTES) {
+            const int chunk = static_cast<int>(qMin<quint64>(TOTAL_BYTES - written, 1 + written % 700));
+            if (ring.availableToWrite() < chunk) {
+                QThread::yieldCurrentThread();
+                continue;
+            }
+            const QByteArray bytes = pattern(written, chunk);
+            written += ring.write(bytes.constData(), chunk);
+        }
+    }));
+    producer->start();
+
+    // Keeps draining after a mismatch so the producer can finish
+    quint64 read = 0;
+    quint64 firstMismatch = TOTAL_BYTES;
+    bool inOrder = true;
+    char buffer[512];
+    while (read < TOTAL_BYTES) {
+        const qsizetype got = ring.read(buffer, sizeof(buffer));
+        for (qsizetype i = 0; i < got && inOrder; ++i) {
+            inOrder = buffer[i] == patternByte(read + i);
+            if (!inOrder) {
+                firstMismatch = read + i;
+            }
+        }
+        read += got;
+        if (got == 0) {
+            QThread::yieldCurrentThread();
+        }
+    }
+    producer->wait();
+
+    EXPECT_TRUE(inOrder) << "Byte " << firstMismatch << " arrived out of order";
+    EXPECT_EQ(read, TOTAL_BYTES);
+    EXPECT_EQ(ring.droppedBytes(), 0u);
+}
@@ -0,0 +1,189 @@
+// Unit Test for ConfigurationManager
+// Settings live in a temporary directory: reads are served from memory, writes reach
+// the file in one debounced batch (or on flush and destruction), and change
+// notifications arrive once per category on the next event loop turn
+
+#include <gtest/gtest.h>
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QList>
+#include <QPair>
+#include <QSettings>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "../../src/services/ConfigurationManager.h"
+
+namespace {
+
+using Category = ConfigurationManager::SettingsCategory;
+
+class ConfigurationManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_dir.isValid());
+        // Keeps the user's own settings out of reach
+        QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, m_dir.path());
+        QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, m_dir.path());
+    }
+
+    // What a fresh reader finds in the file, not in the manager's memory
+    static QVariant stored(const QString& path, const QString& key) {
+        QSettings file(path, QSettings::IniFormat);
+        return file.value(key);
+    }
+
+    QTemporaryDir m_dir;
+};
+
+} // namespace
+
+TEST_F(ConfigurationManagerTest, DefaultsAreServedWithoutTouchingTheDisk) {
+    ConfigurationManager config;
+    const QString path = config.getConfigFilePath();
+    EXPECT_TRUE(path.startsWith(m_dir.path())) << path.toStdString();
+
+    EXPECT_EQ(config.getInputGain(), 100);
+    EXPECT_EQ(config.getAudioSetting("Format").toString(), "flac");
+    EXPECT_TRUE(config.contains("UI/Theme"));
+    EXPECT_EQ(config.getValue<int>("Application/Missing", 7), 7);
+    EXPECT_FALSE(QFileInfo::exists(path)); // Defaults go out with the first flush
+
+    config.flush();
+    EXPECT_EQ(stored(path, "Audio/InputGain").toInt(), 100);
+}
+
+TEST_F(ConfigurationManagerTest, WritesAreReadBackAtOnceAndWrittenOnFlush) {
+    ConfigurationManager config;
+    config.flush();
+    const QString path = config.getConfigFilePath();
+    QSignalSpy saved(&config, &ConfigurationManager::configurationSaved);
+
+    config.setInputGain(150);
+    config.setUISetting("Theme", "dark");
+    EXPECT_EQ(config.getInputGain(), 150);
+    EXPECT_EQ(config.getUISetting("Theme").toString(), "dark");
+    EXPECT_EQ(stored(path, "Audio/InputGain").toInt(), 100);
+
+    config.flush();
+    EXPECT_EQ(saved.count(), 1);
+    EXPECT_EQ(stored(path, "Audio/InputGain").toInt(), 150);
+    EXPECT_EQ(stored(path, "UI/Theme").toString(), "dark");
+
+    // Nothing left to write
+    config.flush();
+    EXPECT_EQ(saved.count(), 1);
+}
+
+TEST_F(ConfigurationManagerTest, ChangesAreFlushedInOneDebouncedBatch) {
+    ConfigurationManager config;
+    config.flush();
+    const QString path = config.getConfigFilePath();
+    QSignalSpy saved(&config, &ConfigurationManager::configurationSaved);
+
+    for (int gain = 101; gain <= 120; ++gain) {
+        config.setInputGain(gain); // A slider drag
+    }
+    config.setTranscriptionProvider(3);
+    EXPECT_EQ(saved.count(), 0);
+
+    EXPECT_TRUE(QTest::qWaitFor([&saved]() { return saved.count() > 0; }, 3000));
+    EXPECT_EQ(saved.count(), 1);
+    EXPECT_EQ(stored(path, "Audio/InputGain").toInt(), 120);
+    EXPECT_EQ(stored(path, "Transcription/Provider").toInt(), 3);
+}
+
+TEST_F(ConfigurationManagerTest, DestructionWritesWhatIsPendingAndTheNextStartReadsIt) {
+    QString path;
+    {
+        ConfigurationManager config;
+        path = config.getConfigFilePath();
+        config.setApiKey("Gemini", "key-0123456789");
+        config.setBackendCalibration("base", QVariantMap{{"backend", "cpu"}, {"realtimeFactor", 0.4}});
+    }
+    EXPECT_EQ(stored(path, "Enhancement/ApiKey_Gemini").toString(), "key-0123456789");
+
+    ConfigurationManager restarted;
+    EXPECT_EQ(restarted.getApiKey("Gemini"), "key-0123456789");
+    EXPECT_EQ(restarted.getBackendCalibration("base").value("backend").toString(), "cpu");
+}
+
+TEST_F(ConfigurationManagerTest, NotificationsAreBatchedPerCategory) {
+    ConfigurationManager config;
+    QList<QPair<Category, QStringList>> changes;
+    QObject::connect(&config, &ConfigurationManager::settingsChanged,
+                     [&changes](Category category, const QStringList& keys) { changes.append({category, keys}); });
+
+    config.setInputGain(110);
+    config.setAudioSetting("DeviceName", "USB Microphone");
+    config.setInputGain(120);
+    config.setUISetting("Theme", "dark");
+    config.setUISetting("Theme", "dark"); // Unchanged: no notification
+    EXPECT_TRUE(changes.isEmpty());
+
+    QCoreApplication::processEvents();
+    ASSERT_EQ(changes.size(), 2);
+    EXPECT_EQ(changes[0].first, Category::Audio);
+    EXPECT_EQ(changes[0].second, (QStringList{"Audio/InputGain", "Audio/DeviceName"}));
+    EXPECT_EQ(changes[1].first, Category::UI);
+    EXPECT_EQ(changes[1].second, QStringList{"UI/Theme"});
+
+    config.setUISetting("Theme", "dark");
+    QCoreApplication::processEvents();
+    EXPECT_EQ(changes.size(), 2);
+}
+
+TEST_F(ConfigurationManagerTest, InvalidValuesAreRejected) {
+    ConfigurationManager config;
+    config.setInputGain(500);
+    EXPECT_EQ(config.getInputGain(), 100);
+    config.setApiKey("Gemini", "short");
+    EXPECT_TRUE(config.getApiKey("Gemini").isEmpty());
+    config.setAudioSetting("SampleRate", 4000);
+    EXPECT_EQ(config.getAudioSetting("SampleRate").toInt(), 16000);
+}
+
+TEST_F(ConfigurationManagerTest, RemovalsAndResetsReachTheFile) {
+    ConfigurationManager config;
+    const QString path = config.getConfigFilePath();
+    config.setAudioSetting("Custom", 1);
+    config.setInputGain(150);
+    config.setUISetting("Custom", 2);
+    config.setStorageSetting("Custom", 3);
+    config.flush();
+    ASSERT_EQ(stored(path, "Storage/Custom").toInt(), 3);
+
+    config.remove("Storage/Custom");
+    EXPECT_FALSE(config.contains("Storage/Custom"));
+    config.flush();
+    EXPECT_FALSE(stored(path, "Storage/Custom").isValid());
+
+    // Custom keys go, defaults come back, other categories are untouched
+    config.resetCategory(Category::Audio);
+    EXPECT_FALSE(config.contains("Audio/Custom"));
+    EXPECT_EQ(config.getInputGain(), 100);
+    EXPECT_EQ(config.getUISetting("Custom").toInt(), 2);
+    config.flush();
+    EXPECT_FALSE(stored(path, "Audio/Custom").isValid());
+    EXPECT_EQ(stored(path, "Audio/InputGain").toInt(), 100);
+
+    config.resetAll();
+    EXPECT_FALSE(config.contains("UI/Custom"));
+    config.flush();
+    EXPECT_FALSE(stored(path, "UI/Custom").isValid());
+    EXPECT_EQ(stored(path, "UI/Theme").toString(), "default");
+}
+
+TEST_F(ConfigurationManagerTest, BackupIncludesChangesNotFlushedYet) {
+    ConfigurationManager config;
+    config.setInputGain(130);
+    const QString backup = m_dir.filePath("backup.conf");
+    ASSERT_TRUE(config.backupSettings(backup));
+    EXPECT_EQ(stored(backup, "Audio/InputGain").toInt(), 130);
+
+    // Restoring drops what was changed since
+    config.setInputGain(170);
+    ASSERT_TRUE(config.restoreSettings(backup));
+    EXPECT_EQ(config.getInputGain(), 130);
+}
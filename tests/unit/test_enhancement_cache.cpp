@@ -0,0 +1,284 @@
+// Unit Test for EnhancementCache
+// Covers request keys, hits and misses, the byte-bounded LRU of the memory tier,
+// and the disk tier: surviving a restart, promotion, pruning, expiry and clearing
+
+#include <gtest/gtest.h>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <functional>
+
+#include "../../src/services/EnhancementCache.h"
+
+namespace {
+
+EnhancementRequest makeRequest(const QString& text) {
+    EnhancementRequest request;
+    request.text = text;
+    request.settings.mode = EnhancementMode::GrammarOnly;
+    request.settings.preserveFormatting = true;
+    request.settings.maxOutputLength = 2000;
+    request.settings.creativity = 0.2;
+    request.settings.targetAudience = "general";
+    request.settings.tone = "professional";
+    request.preferredProvider = EnhancementProvider::GeminiFlash;
+    return request;
+}
+
+EnhancementResult makeResult(const QString& text) {
+    EnhancementResult result;
+    result.originalText = text;
+    result.enhancedText = text.toUpper();
+    result.mode = EnhancementMode::GrammarOnly;
+    result.provider = EnhancementProvider::GeminiFlash;
+    result.processingTime = 420;
+    result.improvementScore = 0.5;
+    result.metadata = QJsonObject{{"model", "flash"}};
+    result.reasoning = "Capitalized";
+    return result;
+}
+
+QByteArray keyFor(const QString& text) {
+    return EnhancementCache::makeKey(makeRequest(text));
+}
+
+// The same length for every text, so every entry costs the same
+QString textNamed(char name) {
+    return QString(100, QChar(name));
+}
+
+bool sameResult(const EnhancementResult& a, const EnhancementResult& b) {
+    return a.originalText == b.originalText && a.enhancedText == b.enhancedText && a.mode == b.mode &&
+           a.provider == b.provider && a.processingTime == b.processingTime &&
+           a.improvementScore == b.improvementScore && a.changes == b.changes && a.metadata == b.metadata &&
+           a.reasoning == b.reasoning;
+}
+
+bool hits(EnhancementCache& cache, char name) {
+    EnhancementResult result;
+    return cache.lookup(keyFor(textNamed(name)), result) && result.originalText == textNamed(name);
+}
+
+void storeNamed(EnhancementCache& cache, char name) {
+    cache.store(keyFor(textNamed(name)), makeResult(textNamed(name)));
+}
+
+class EnhancementCacheDiskTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_dir.isValid());
+        m_path = m_dir.filePath("cache/enhancements.db");
+    }
+
+    // Runs @p sql on a connection of the test's own, while no cache has the file open
+    void execute(const QString& sql) {
+        {
+            QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "enhancement_cache_test");
+            database.setDatabaseName(m_path);
+            ASSERT_TRUE(database.open());
+            QSqlQuery query(database);
+            EXPECT_TRUE(query.exec(sql)) << sql.toStdString();
+        }
+        QSqlDatabase::removeDatabase("enhancement_cache_test");
+    }
+
+    QTemporaryDir m_dir;
+    QString m_path;
+};
+
+} // namespace
+
+TEST(EnhancementCacheTest, KeysCoverEveryFieldThatShapesTheOutput) {
+    const EnhancementRequest base = makeRequest("hello world");
+    const QByteArray key = EnhancementCache::makeKey(base);
+    EXPECT_EQ(key.size(), 32);
+    EXPECT_EQ(EnhancementCache::makeKey(makeRequest("hello world")), key);
+
+    const QList<std::function<void(EnhancementRequest&)>> changes = {
+        [](EnhancementRequest& r) { r.text += "!"; },
+        [](EnhancementRequest& r) { r.settings.mode = EnhancementMode::Summarization; },
+        [](EnhancementRequest& r) { r.settings.customPrompt = "Rhyme"; },
+        [](EnhancementRequest& r) { r.settings.preserveFormatting = false; },
+        [](EnhancementRequest& r) { r.settings.maxOutputLength = 100; },
+        [](EnhancementRequest& r) { r.settings.creativity = 0.9; },
+        [](EnhancementRequest& r) { r.settings.tone = "casual"; },
+        [](EnhancementRequest& r) { r.settings.preserveTerms = {"QuillScribe"}; },
+        [](EnhancementRequest& r) { r.preferredProvider = EnhancementProvider::GeminiPro; },
+        [](EnhancementRequest& r) { r.language = "de"; },
+    };
+    for (int i = 0; i < changes.size(); ++i) {
+        EnhancementRequest changed = base;
+        changes[i](changed);
+        EXPECT_NE(EnhancementCache::makeKey(changed), key) << "change " << i;
+    }
+    EXPECT_NE(EnhancementCache::makeKey(base, "Earlier paragraph."), key);
+
+    // Lengths are encoded, so moving text from one field to the next is a different key
+    EnhancementRequest left = base;
+    left.settings.targetAudience = "ab";
+    left.settings.tone = "c";
+    EnhancementRequest right = base;
+    right.settings.targetAudience = "a";
+    right.settings.tone = "bc";
+    EXPECT_NE(EnhancementCache::makeKey(left), EnhancementCache::makeKey(right));
+}
+
+TEST(EnhancementCacheTest, HitsReturnWhatWasStored) {
+    EnhancementCache cache;
+    EXPECT_FALSE(cache.isPersistent());
+
+    EnhancementResult result;
+    EXPECT_FALSE(cache.lookup(keyFor("hello"), result));
+
+    const EnhancementResult stored = makeResult("hello");
+    cache.store(keyFor("hello"), stored);
+    ASSERT_TRUE(cache.lookup(keyFor("hello"), result));
+    EXPECT_TRUE(sameResult(result, stored));
+    EXPECT_FALSE(cache.lookup(keyFor("goodbye"), result));
+
+    const EnhancementCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.memoryHits, 1u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.diskHits, 0u);
+    EXPECT_EQ(stats.memoryEntries, 1);
+    EXPECT_GT(stats.memoryBytes, 0);
+
+    // An empty key is never stored
+    cache.store(QByteArray(), stored);
+    EXPECT_EQ(cache.stats().memoryEntries, 1);
+}
+
+TEST(EnhancementCacheTest, MemoryEvictsTheLeastRecentlyUsedPastItsByteBudget) {
+    EnhancementCache cache;
+    storeNamed(cache, 'a');
+    const qint64 entryBytes = cache.stats().memoryBytes;
+    cache.clear();
+    cache.setMaxMemoryBytes(entryBytes * 3);
+
+    storeNamed(cache, 'a');
+    storeNamed(cache, 'b');
+    storeNamed(cache, 'c');
+    EXPECT_TRUE(hits(cache, 'a')); // Now the most recently used; b is the oldest
+    storeNamed(cache, 'd');
+
+    EXPECT_EQ(cache.stats().memoryEntries, 3);
+    EXPECT_EQ(cache.stats().memoryBytes, entryBytes * 3);
+    EXPECT_FALSE(hits(cache, 'b'));
+    EXPECT_TRUE(hits(cache, 'a'));
+    EXPECT_TRUE(hits(cache, 'c'));
+    EXPECT_TRUE(hits(cache, 'd'));
+
+    // Shrinking the budget evicts right away
+    cache.setMaxMemoryBytes(entryBytes);
+    EXPECT_EQ(cache.stats().memoryEntries, 1);
+    EXPECT_EQ(cache.sizeBytes(), entryBytes);
+
+    // A result bigger than the whole budget is not kept at all
+    cache.store(keyFor("huge"), makeResult(QString(10000, 'x')));
+    EnhancementResult result;
+    EXPECT_FALSE(cache.lookup(keyFor("huge"), result));
+    EXPECT_LE(cache.stats().memoryBytes, entryBytes);
+}
+
+TEST(EnhancementCacheTest, ResultsRoundTripThroughJson) {
+    EnhancementResult result = makeResult("café");
+    result.changes = QJsonObject{{"replaced", 2}};
+    result.processingTime = 1LL << 40;
+    EXPECT_TRUE(sameResult(EnhancementCache::resultFromJson(EnhancementCache::resultToJson(result)), result));
+}
+
+TEST_F(EnhancementCacheDiskTest, DiskTierSurvivesARestartAndPromotesHits) {
+    {
+        EnhancementCache cache;
+        ASSERT_TRUE(cache.openDatabase(m_path));
+        EXPECT_TRUE(cache.isPersistent());
+        storeNamed(cache, 'a');
+        storeNamed(cache, 'b');
+        EXPECT_GT(cache.stats().diskBytes, 0);
+    } // Commits the queued stores
+
+    EnhancementCache restarted;
+    ASSERT_TRUE(restarted.openDatabase(m_path));
+    const qint64 diskBytes = restarted.stats().diskBytes;
+    EXPECT_GT(diskBytes, 0);
+    EXPECT_EQ(restarted.stats().memoryEntries, 0);
+
+    EXPECT_TRUE(hits(restarted, 'a'));
+    EXPECT_EQ(restarted.stats().diskHits, 1u);
+    EXPECT_TRUE(hits(restarted, 'a'));
+    EXPECT_EQ(restarted.stats().memoryHits, 1u); // Promoted to memory
+    EXPECT_EQ(restarted.stats().memoryEntries, 1);
+
+    // A key the disk index does not know is a miss
+    EXPECT_FALSE(hits(restarted, 'z'));
+    EXPECT_EQ(restarted.stats().misses, 1u);
+    EXPECT_EQ(restarted.sizeBytes(), restarted.stats().memoryBytes + diskBytes);
+}
+
+TEST_F(EnhancementCacheDiskTest, DiskPrunesTheLeastRecentlyUsedPastItsBudget) {
+    qint64 entryBytes = 0;
+    {
+        EnhancementCache cache;
+        ASSERT_TRUE(cache.openDatabase(m_path));
+        storeNamed(cache, 'a');
+        entryBytes = cache.stats().diskBytes;
+        cache.setMaxDiskBytes(entryBytes * 2);
+        storeNamed(cache, 'b');
+        storeNamed(cache, 'c');
+
+        const EnhancementCache::Stats stats = cache.stats();
+        EXPECT_EQ(stats.evictions, 1u);
+        EXPECT_EQ(stats.diskBytes, entryBytes * 2);
+    }
+
+    EnhancementCache restarted;
+    ASSERT_TRUE(restarted.openDatabase(m_path));
+    EXPECT_EQ(restarted.stats().diskBytes, entryBytes * 2);
+    EXPECT_FALSE(hits(restarted, 'a'));
+    EXPECT_TRUE(hits(restarted, 'b'));
+    EXPECT_TRUE(hits(restarted, 'c'));
+}
+
+TEST_F(EnhancementCacheDiskTest, ExpiredAndOtherFormatRowsAreDroppedOnOpen) {
+    {
+        EnhancementCache cache;
+        ASSERT_TRUE(cache.openDatabase(m_path));
+        storeNamed(cache, 'a');
+        storeNamed(cache, 'b');
+    }
+    const qint64 twoDaysAgo = QDateTime::currentDateTime().addDays(-2).toSecsSinceEpoch();
+    execute(QString("UPDATE enhancement_cache SET stored_at = %1 WHERE result LIKE '%\"originalText\":\"a%'")
+                .arg(twoDaysAgo));
+
+    {
+        EnhancementCache cache;
+        ASSERT_TRUE(cache.openDatabase(m_path));
+        EXPECT_FALSE(hits(cache, 'a'));
+        EXPECT_TRUE(hits(cache, 'b'));
+    }
+
+    // Rows written by an older format cannot be decoded into today's results
+    execute(QString("PRAGMA user_version = %1").arg(EnhancementCache::FORMAT_VERSION - 1));
+    EnhancementCache cache;
+    ASSERT_TRUE(cache.openDatabase(m_path));
+    EXPECT_EQ(cache.stats().diskBytes, 0);
+    EXPECT_FALSE(hits(cache, 'b'));
+}
+
+TEST_F(EnhancementCacheDiskTest, ClearEmptiesBothTiers) {
+    {
+        EnhancementCache cache;
+        ASSERT_TRUE(cache.openDatabase(m_path));
+        storeNamed(cache, 'a');
+        cache.clear();
+        EXPECT_EQ(cache.sizeBytes(), 0);
+        EXPECT_FALSE(hits(cache, 'a'));
+    }
+
+    EnhancementCache restarted;
+    ASSERT_TRUE(restarted.openDatabase(m_path));
+    EXPECT_EQ(restarted.stats().diskBytes, 0);
+    EXPECT_FALSE(hits(restarted, 'a'));
+}
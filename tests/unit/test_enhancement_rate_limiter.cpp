@@ -0,0 +1,171 @@
+// Unit Test for EnhancementRateLimiter
+// Covers the request and token buckets draining, reporting their wait and
+// refilling with time, usage settlement, and the AIMD concurrency limit
+
+#include <gtest/gtest.h>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include "../../src/services/EnhancementRateLimiter.h"
+
+TEST(EnhancementRateLimiterTest, FullBucketAllowsABurstOfTheQuota) {
+    EnhancementRateLimiter limiter;
+    limiter.setQuota(5, 1000000);
+
+    qint64 waitMs = -1;
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(limiter.tryAcquire(100, &waitMs)) << "request " << i;
+        EXPECT_EQ(waitMs, 0);
+    }
+
+    // One request refills every 12 s at 5 per minute
+    EXPECT_FALSE(limiter.tryAcquire(100, &waitMs));
+    EXPECT_GT(waitMs, 11000);
+    EXPECT_LE(waitMs, 12000);
+}
+
+TEST(EnhancementRateLimiterTest, TokenShortfallSetsTheWait) {
+    EnhancementRateLimiter limiter;
+    limiter.setQuota(1000, 6000); // 100 tokens a second
+
+    qint64 waitMs = -1;
+    ASSERT_TRUE(limiter.tryAcquire(6000, &waitMs));
+    EXPECT_FALSE(limiter.tryAcquire(600, &waitMs));
+    EXPECT_GT(waitMs, 5800);
+    EXPECT_LE(waitMs, 6000);
+}
+
+TEST(EnhancementRateLimiterTest, RefillsContinuously) {
+    EnhancementRateLimiter limiter;
+    limiter.setQuota(60000, 1000000); // One request a millisecond
+
+    // Drain the bucket; it refills as the loop runs, so stop at the first refusal
+    qint64 waitMs = 0;
+    int drained = 0;
+    while (limiter.tryAcquire(0, &waitMs) && drained < 1000000) {
+        ++drained;
+    }
+    ASSERT_GE(drained, 60000);
+    EXPECT_GE(waitMs, 1);
+    EXPECT_LE(waitMs, 1);
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    QThread::msleep(100);
+
+    // About one request per elapsed millisecond has come back, never more
+    int refilled = 0;
+    while (limiter.tryAcquire(0, &waitMs)) {
+        ++refilled;
+    }
+    EXPECT_GE(refilled, 90);
+    EXPECT_LE(refilled, elapsed.elapsed() + 2);
+}
+
+TEST(EnhancementRateLimiterTest, BucketNeverHoldsMoreThanAMinute) {
+    EnhancementRateLimiter limiter;
+    limiter.setQuota(60000, 1000000);
+    QThread::msleep(20);
+
+    const EnhancementRateLimiter::Metrics metrics = limiter.metrics();
+    EXPECT_DOUBLE_EQ(metrics.availableRequests, 60000.0);
+    EXPECT_DOUBLE_EQ(metrics.availableTokens, 1000000.0);
+}
+
+TEST(EnhancementRateLimiterTest, LoweringTheQuotaTrimsTheBucket) {
+    EnhancementRateLimiter limiter;
+    limiter.setQuota(10, 500);
+
+    const EnhancementRateLimiter::Metrics metrics = limiter.metrics();
+    EXPECT_DOUBLE_EQ(metrics.availableRequests, 10.0);
+    EXPECT_DOUBLE_EQ(metrics.availableTokens, 500.0);
+}
+
+TEST(EnhancementRateLimiterTest, OversizedRequestWaitsForAFullBucket) {
+    EnhancementRateLimiter limiter;
+    limiter.setQuota(60, 1000);
+
+    // More than a minute's tokens: admitted on a full bucket instead of never
+    qint64 waitMs = -1;
+    ASSERT_TRUE(limiter.tryAcquire(5000, &waitMs));
+    EXPECT_FALSE(limiter.tryAcquire(5000, &waitMs));
+    EXPECT_GT(waitMs, 59000);
+    EXPECT_LE(waitMs, 60000);
+}
+
+TEST(EnhancementRateLimiterTest, RecordUsageSettlesTheEstimate) {
+    EnhancementRateLimiter limiter;
+    limiter.setQuota(60, 6000); // 0.1 tokens a millisecond
+
+    qint64 waitMs = -1;
+    ASSERT_TRUE(limiter.tryAcquire(4000, &waitMs));
+
+    // Overestimated by 3000: refunded
+    limiter.recordUsage(4000, 1000);
+    EXPECT_NEAR(limiter.metrics().availableTokens, 5000.0, 50.0);
+
+    // Underestimated by 7000: the bucket goes into debt, and the wait covers it
+    limiter.recordUsage(1000, 8000);
+    EXPECT_NEAR(limiter.metrics().availableTokens, -2000.0, 50.0);
+    EXPECT_FALSE(limiter.tryAcquire(1000, &waitMs));
+    EXPECT_NEAR(static_cast<double>(waitMs), 30000.0, 500.0);
+
+    const EnhancementRateLimiter::Metrics metrics = limiter.metrics();
+    EXPECT_EQ(metrics.requestsLastMinute, 2);
+    EXPECT_EQ(metrics.tokensLastMinute, 9000);
+}
+
+TEST(EnhancementRateLimiterTest, ConcurrencyIsAdditiveIncreaseMultiplicativeDecrease) {
+    EnhancementRateLimiter limiter;
+    limiter.setConcurrencyBounds(1, 8);
+    EXPECT_EQ(limiter.concurrencyLimit(), 1);
+
+    // +1/limit per success: one takes 1 to 2, three more reach 3.24
+    limiter.onSuccess();
+    EXPECT_EQ(limiter.concurrencyLimit(), 2);
+    limiter.onSuccess();
+    limiter.onSuccess();
+    EXPECT_EQ(limiter.concurrencyLimit(), 2);
+    limiter.onSuccess();
+    EXPECT_EQ(limiter.concurrencyLimit(), 3);
+    for (int i = 0; i < 100; ++i) {
+        limiter.onSuccess();
+    }
+    EXPECT_EQ(limiter.concurrencyLimit(), 8);
+
+    // A burst of rejections within the cooldown halves the limit once
+    limiter.onThrottled(0);
+    limiter.onThrottled(0);
+    limiter.onThrottled(0);
+    EXPECT_EQ(limiter.concurrencyLimit(), 4);
+    EXPECT_EQ(limiter.metrics().throttledResponses, 3u);
+}
+
+TEST(EnhancementRateLimiterTest, RetryAfterPausesDispatch) {
+    EnhancementRateLimiter limiter;
+    limiter.onThrottled(5000);
+
+    qint64 waitMs = -1;
+    EXPECT_FALSE(limiter.tryAcquire(1, &waitMs));
+    EXPECT_GT(waitMs, 4900);
+    EXPECT_LE(waitMs, 5000);
+    EXPECT_GT(limiter.metrics().pausedForMs, 4900);
+}
+
+TEST(EnhancementRateLimiterTest, RetryDelayIsJitteredExponentialBackoff) {
+    EnhancementRateLimiter limiter;
+    for (int attempt = 0; attempt < 10; ++attempt) {
+        const qint64 ceiling = qMin(EnhancementRateLimiter::MAX_BACKOFF_MS,
+                                    EnhancementRateLimiter::BASE_BACKOFF_MS << attempt);
+        for (int sample = 0; sample < 20; ++sample) {
+            const qint64 delay = limiter.retryDelayMs(attempt, 0);
+            EXPECT_GE(delay, ceiling / 2);
+            EXPECT_LE(delay, ceiling);
+        }
+    }
+
+    // The server's delay wins, with a little jitter on top
+    const qint64 delay = limiter.retryDelayMs(3, 7000);
+    EXPECT_GE(delay, 7000);
+    EXPECT_LT(delay, 7000 + EnhancementRateLimiter::RETRY_AFTER_JITTER_MS);
+}
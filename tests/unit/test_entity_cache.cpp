@@ -0,0 +1,120 @@
+// Unit Test for EntityCache
+// Covers least-recently-used eviction, invalidation, the generation token that
+// keeps a stale read out, and the hit statistics
+
+#include <gtest/gtest.h>
+#include <QString>
+
+#include "../../src/services/EntityCache.h"
+
+namespace {
+
+// A miss followed by the insert a storage read would make
+void load(EntityCache<QString>& cache, const QString& key) {
+    quint64 generation = 0;
+    ASSERT_FALSE(cache.find(key, &generation).has_value()) << key.toStdString();
+    cache.insert(key, "value of " + key, generation);
+}
+
+bool cached(EntityCache<QString>& cache, const QString& key) {
+    quint64 generation = 0;
+    return cache.find(key, &generation).has_value();
+}
+
+} // namespace
+
+TEST(EntityCacheTest, HitReturnsTheInsertedValue) {
+    EntityCache<QString> cache;
+    load(cache, "a");
+
+    quint64 generation = 0;
+    const std::optional<QString> value = cache.find("a", &generation);
+    ASSERT_TRUE(value.has_value());
+    EXPECT_EQ(*value, "value of a");
+}
+
+TEST(EntityCacheTest, EvictsTheLeastRecentlyUsed) {
+    EntityCache<QString> cache(3);
+    load(cache, "a");
+    load(cache, "b");
+    load(cache, "c");
+
+    // A hit makes "a" the most recent, leaving "b" the oldest
+    EXPECT_TRUE(cached(cache, "a"));
+    load(cache, "d");
+
+    EXPECT_FALSE(cached(cache, "b"));
+    EXPECT_TRUE(cached(cache, "a"));
+    EXPECT_TRUE(cached(cache, "c"));
+    EXPECT_TRUE(cached(cache, "d"));
+    EXPECT_EQ(cache.stats().size, 3);
+
+    // Now "a" is the oldest again: the lookups above touched it first
+    load(cache, "e");
+    EXPECT_FALSE(cached(cache, "a"));
+    EXPECT_EQ(cache.stats().size, 3);
+}
+
+TEST(EntityCacheTest, ReinsertingAKeyReplacesItsValue) {
+    EntityCache<QString> cache(2);
+    quint64 generation = 0;
+    cache.find("a", &generation);
+    cache.insert("a", "old", generation);
+    cache.insert("a", "new", generation);
+
+    EXPECT_EQ(cache.stats().size, 1);
+    EXPECT_EQ(cache.find("a", &generation).value_or(QString()), "new");
+}
+
+TEST(EntityCacheTest, RemoveAndClearInvalidate) {
+    EntityCache<QString> cache;
+    load(cache, "a");
+    load(cache, "b");
+
+    cache.remove("a");
+    EXPECT_FALSE(cached(cache, "a"));
+    EXPECT_TRUE(cached(cache, "b"));
+
+    cache.clear();
+    EXPECT_FALSE(cached(cache, "b"));
+    EXPECT_EQ(cache.stats().size, 0);
+    EXPECT_EQ(cache.stats().invalidations, 2u);
+}
+
+TEST(EntityCacheTest, ReadRacingAnInvalidationIsNotKept) {
+    EntityCache<QString> cache;
+    quint64 generation = 0;
+    ASSERT_FALSE(cache.find("a", &generation).has_value());
+
+    // A write lands while the row is being read: the read may predate it
+    cache.remove("a");
+    cache.insert("a", "stale", generation);
+    EXPECT_FALSE(cached(cache, "a"));
+
+    // Any invalidation counts, not only one for the same key
+    ASSERT_FALSE(cache.find("a", &generation).has_value());
+    cache.remove("other");
+    cache.insert("a", "maybe stale", generation);
+    EXPECT_FALSE(cached(cache, "a"));
+
+    // A read with nothing in between is kept
+    ASSERT_FALSE(cache.find("a", &generation).has_value());
+    cache.insert("a", "fresh", generation);
+    EXPECT_TRUE(cached(cache, "a"));
+}
+
+TEST(EntityCacheTest, StatsCountHitsAndMisses) {
+    EntityCache<QString> cache;
+    EXPECT_DOUBLE_EQ(cache.stats().hitRate(), 0.0);
+
+    load(cache, "a");          // Miss
+    cached(cache, "a");        // Hit
+    cached(cache, "a");        // Hit
+    cached(cache, "missing");  // Miss
+
+    const EntityCacheStats stats = cache.stats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.size, 1);
+    EXPECT_DOUBLE_EQ(stats.hitRate(), 0.5);
+}
@@ -0,0 +1,271 @@
+// Unit Test for FlacEncoder / FlacDecoder
+// Round-trips PCM through the streaming encoder and decoder and checks the
+// decoder's recovery from truncated and corrupted streams
+
+#include <gtest/gtest.h>
+#include <QBuffer>
+#include <QByteArray>
+#include <QRandomGenerator>
+#include <QVector>
+#include <QtEndian>
+#include <cmath>
+#include <functional>
+
+#include "../../src/services/FlacCodec.h"
+
+namespace {
+
+using SampleFunction = std::function<qint32(int frame, int channel)>;
+
+AudioFileReader::Format makeFormat(int channelCount, int bytesPerSample) {
+    AudioFileReader::Format format;
+    format.sampleRate = 16000;
+    format.channelCount = channelCount;
+    format.bytesPerSample = bytesPerSample;
+    return format;
+}
+
+qint32 maxSample(int bytesPerSample) {
+    return bytesPerSample == 4 ? 0x7FFFFFFF : (1 << (bytesPerSample * 8 - 1)) - 1;
+}
+
+// Capture bytes for @p frames frames; @p sample gives signed values, 8-bit is stored unsigned
+QByteArray makePcm(const AudioFileReader::Format& format, int frames, const SampleFunction& sample) {
+    QByteArray pcm(frames * format.channelCount * format.bytesPerSample, Qt::Uninitialized);
+    char* p = pcm.data();
+    for (int frame = 0; frame < frames; ++frame) {
+        for (int ch = 0; ch < format.channelCount; ++ch, p += format.bytesPerSample) {
+            const qint32 value = sample(frame, ch);
+            if (format.bytesPerSample == 2) {
+                qToLittleEndian<qint16>(static_cast<qint16>(value), p);
+            } else if (format.bytesPerSample == 4) {
+                qToLittleEndian<qint32>(value, p);
+            } else {
+                *p = static_cast<char>(value + 128);
+            }
+        }
+    }
+    return pcm;
+}
+
+QVector<qint32> expectedSamples(const AudioFileReader::Format& format, int frames, const SampleFunction& sample) {
+    QVector<qint32> samples;
+    samples.reserve(frames * format.channelCount);
+    for (int frame = 0; frame < frames; ++frame) {
+        for (int ch = 0; ch < format.channelCount; ++ch) {
+            samples.append(sample(frame, ch));
+        }
+    }
+    return samples;
+}
+
+// Encodes in deliberately odd-sized chunks so frames straddle encode() calls;
+// @p frameEnds receives the stream offset after each FLAC frame
+QByteArray encodeStream(const AudioFileReader::Format& format, const QByteArray& pcm,
+                        QVector<qint64>* frameEnds = nullptr) {
+    FlacEncoder encoder;
+    EXPECT_TRUE(encoder.configure(format));
+
+    QByteArray frames;
+    const int chunkBytes = 1000 * format.channelCount * format.bytesPerSample + 1;
+    for (int offset = 0; offset < pcm.size(); offset += chunkBytes) {
+        const int len = qMin(chunkBytes, static_cast<int>(pcm.size()) - offset);
+        const qint64 before = frames.size();
+        encoder.encode(pcm.constData() + offset, len, frames);
+        if (frameEnds && frames.size() > before) {
+            frameEnds->append(FlacEncoder::HEADER_SIZE + frames.size());
+        }
+    }
+    const qint64 before = frames.size();
+    encoder.flush(frames);
+    if (frameEnds && frames.size() > before) {
+        frameEnds->append(FlacEncoder::HEADER_SIZE + frames.size());
+    }
+
+    const QByteArray header = encoder.streamHeader();
+    EXPECT_EQ(header.size(), FlacEncoder::HEADER_SIZE);
+    return header + frames;
+}
+
+struct Decoded {
+    bool headerRead = false;
+    int lastResult = 0;
+    QVector<qint32> samples;
+    quint64 totalSamples = 0;
+    qint64 lastFrameEnd = 0;
+    int bitsPerSample = 0;
+};
+
+Decoded decodeStream(const QByteArray& stream) {
+    QByteArray data = stream;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+
+    Decoded decoded;
+    FlacDecoder decoder(&buffer);
+    decoded.headerRead = decoder.readHeader();
+    if (!decoded.headerRead) {
+        return decoded;
+    }
+    decoded.totalSamples = decoder.totalSamples();
+    decoded.bitsPerSample = decoder.bitsPerSample();
+
+    QVector<qint32> frame;
+    while ((decoded.lastResult = decoder.readFrame(frame)) > 0) {
+        decoded.samples += frame;
+    }
+    decoded.lastFrameEnd = decoder.lastFrameEnd();
+    return decoded;
+}
+
+// Speech-like content: a few partials plus noise, a little louder on the left
+SampleFunction tone(int bytesPerSample, int seed) {
+    const double amplitude = maxSample(bytesPerSample) * 0.4;
+    return [amplitude, seed](int frame, int channel) {
+        const double t = frame / 16000.0;
+        double value = std::sin(2 * M_PI * 220 * t) + 0.5 * std::sin(2 * M_PI * 1330 * t + channel);
+        value *= channel == 0 ? 1.0 : 0.8;
+        // Deterministic per-sample noise, the same for every call
+        QRandomGenerator noise(static_cast<quint32>(seed * 1000003 + frame * 8 + channel));
+        value += (noise.generateDouble() - 0.5) * 0.05;
+        return static_cast<qint32>(std::lround(value * amplitude / 1.55));
+    };
+}
+
+void expectRoundTrip(int channelCount, int bytesPerSample, int frames, const SampleFunction& sample) {
+    const AudioFileReader::Format format = makeFormat(channelCount, bytesPerSample);
+    const QByteArray stream = encodeStream(format, makePcm(format, frames, sample));
+    const Decoded decoded = decodeStream(stream);
+
+    ASSERT_TRUE(decoded.headerRead);
+    EXPECT_EQ(decoded.lastResult, 0) << "Stream should end cleanly";
+    EXPECT_EQ(decoded.bitsPerSample, bytesPerSample * 8);
+    EXPECT_EQ(decoded.totalSamples, static_cast<quint64>(frames));
+    EXPECT_EQ(decoded.lastFrameEnd, stream.size());
+    EXPECT_TRUE(decoded.samples == expectedSamples(format, frames, sample))
+        << channelCount << " channel(s), " << bytesPerSample * 8 << "-bit";
+}
+
+// Three whole blocks and an odd final one
+constexpr int ODD_LENGTH = 3 * FlacEncoder::BLOCK_SIZE + 1237;
+
+} // namespace
+
+TEST(FlacCodecTest, MonoRoundTripsAtEverySampleWidth) {
+    for (int bytesPerSample : {1, 2, 4}) {
+        expectRoundTrip(1, bytesPerSample, ODD_LENGTH, tone(bytesPerSample, 1));
+    }
+}
+
+TEST(FlacCodecTest, StereoRoundTripsAtEverySampleWidth) {
+    for (int bytesPerSample : {1, 2, 4}) {
+        expectRoundTrip(2, bytesPerSample, ODD_LENGTH, tone(bytesPerSample, 2));
+    }
+}
+
+TEST(FlacCodecTest, TwentyFourBitSamplesInThirtyTwoBitContainersRoundTrip) {
+    // 24-bit capture arrives left-justified in 32 bits: the low byte is always zero
+    const SampleFunction sample24 = tone(3, 3);
+    const SampleFunction justified = [sample24](int frame, int channel) {
+        return static_cast<qint32>(static_cast<quint32>(sample24(frame, channel)) << 8);
+    };
+    expectRoundTrip(1, 4, ODD_LENGTH, justified);
+    expectRoundTrip(2, 4, ODD_LENGTH, justified);
+}
+
+TEST(FlacCodecTest, IdenticalStereoChannelsRoundTrip) {
+    // Side channel all zero; exercises the decorrelated channel assignments
+    const SampleFunction mono = tone(2, 4);
+    expectRoundTrip(2, 2, ODD_LENGTH, [mono](int frame, int) { return mono(frame, 0); });
+}
+
+TEST(FlacCodecTest, SilenceRoundTripsAndCompresses) {
+    const SampleFunction silence = [](int, int) { return qint32(0); };
+    for (int channelCount : {1, 2}) {
+        for (int bytesPerSample : {1, 2, 4}) {
+            expectRoundTrip(channelCount, bytesPerSample, ODD_LENGTH, silence);
+        }
+    }
+
+    // Constant subframes: a few bytes per frame whatever the block size
+    const AudioFileReader::Format format = makeFormat(2, 2);
+    const QByteArray pcm = makePcm(format, ODD_LENGTH, silence);
+    const QByteArray stream = encodeStream(format, pcm);
+    EXPECT_LT(stream.size(), 200) << "Silence should encode as constant subframes";
+}
+
+TEST(FlacCodecTest, FullScaleInputRoundTrips) {
+    for (int bytesPerSample : {1, 2, 4}) {
+        const qint32 high = maxSample(bytesPerSample);
+        const qint32 low = -high - 1;
+        // Square wave between the extremes, then full-range noise that no predictor helps
+        const SampleFunction square = [high, low](int frame, int channel) {
+            return ((frame / 7 + channel) & 1) ? high : low;
+        };
+        const int bits = bytesPerSample * 8;
+        const SampleFunction noise = [bits](int frame, int channel) {
+            QRandomGenerator generator(static_cast<quint32>(frame * 8 + channel + 1));
+            const quint32 raw = generator.generate();
+            return bits == 32 ? static_cast<qint32>(raw)
+                              : static_cast<qint32>(raw << (32 - bits)) >> (32 - bits);
+        };
+        for (int channelCount : {1, 2}) {
+            expectRoundTrip(channelCount, bytesPerSample, ODD_LENGTH, square);
+            expectRoundTrip(channelCount, bytesPerSample, ODD_LENGTH, noise);
+        }
+    }
+}
+
+TEST(FlacCodecTest, ShortAndSingleSampleFinalBlocksRoundTrip) {
+    expectRoundTrip(1, 2, FlacEncoder::BLOCK_SIZE + 1, tone(2, 5));
+    expectRoundTrip(2, 2, 2 * FlacEncoder::BLOCK_SIZE + 17, tone(2, 6));
+    expectRoundTrip(2, 1, 1, tone(1, 7));
+    expectRoundTrip(1, 4, FlacEncoder::BLOCK_SIZE - 1, tone(4, 8));
+}
+
+TEST(FlacCodecTest, TruncatedStreamEndsAfterTheLastWholeFrame) {
+    const AudioFileReader::Format format = makeFormat(2, 2);
+    const SampleFunction sample = tone(2, 9);
+    QVector<qint64> frameEnds;
+    const QByteArray stream = encodeStream(format, makePcm(format, ODD_LENGTH, sample), &frameEnds);
+    ASSERT_EQ(frameEnds.size(), 4);
+
+    // An interrupted recording: the last frame is cut short
+    const qint64 cut = frameEnds[2] + (frameEnds[3] - frameEnds[2]) / 2;
+    const Decoded decoded = decodeStream(stream.left(static_cast<int>(cut)));
+
+    ASSERT_TRUE(decoded.headerRead);
+    EXPECT_EQ(decoded.lastResult, 0) << "A truncated final frame should end the stream, not fail it";
+    EXPECT_EQ(decoded.lastFrameEnd, frameEnds[2]);
+    EXPECT_TRUE(decoded.samples == expectedSamples(format, 3 * FlacEncoder::BLOCK_SIZE, sample));
+}
+
+TEST(FlacCodecTest, FrameFailingItsCrcIsSkipped) {
+    const AudioFileReader::Format format = makeFormat(2, 2);
+    const SampleFunction sample = tone(2, 10);
+    QVector<qint64> frameEnds;
+    QByteArray stream = encodeStream(format, makePcm(format, ODD_LENGTH, sample), &frameEnds);
+    ASSERT_EQ(frameEnds.size(), 4);
+
+    // Damage the second frame's CRC-16 footer: it decodes, then fails the check
+    const int footer = static_cast<int>(frameEnds[1]) - 1;
+    stream[footer] = static_cast<char>(stream.at(footer) ^ 0x01);
+    const Decoded decoded = decodeStream(stream);
+
+    ASSERT_TRUE(decoded.headerRead);
+    EXPECT_EQ(decoded.lastResult, 0);
+    EXPECT_EQ(decoded.lastFrameEnd, stream.size());
+
+    // Every frame but the damaged one, the decoder having resynced on the third
+    const QVector<qint32> all = expectedSamples(format, ODD_LENGTH, sample);
+    const int blockValues = FlacEncoder::BLOCK_SIZE * format.channelCount;
+    const QVector<qint32> expected = all.mid(0, blockValues) + all.mid(2 * blockValues);
+    EXPECT_TRUE(decoded.samples == expected);
+}
+
+TEST(FlacCodecTest, DecoderRejectsOtherStreams) {
+    const Decoded decoded = decodeStream(QByteArray("RIFF\0\0\0\0WAVEfmt ", 16));
+    EXPECT_FALSE(decoded.headerRead);
+    EXPECT_FALSE(FlacDecoder::isFlac("fLa"));
+    EXPECT_TRUE(FlacDecoder::isFlac(FlacEncoder::makeStreamHeader(makeFormat(1, 2), 0, 0, 0)));
+}
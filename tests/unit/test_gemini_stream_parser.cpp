@@ -0,0 +1,137 @@
+// Unit Test for GeminiStreamParser
+// Feeds server-sent events split at every byte, across line endings and inside
+// UTF-8 sequences, and checks the text and final-chunk metadata
+
+#include <gtest/gtest.h>
+#include <QByteArray>
+#include <QString>
+
+#include "../../src/services/GeminiStreamParser.h"
+
+namespace {
+
+QByteArray textEvent(const QByteArray& text) {
+    return "data: {\"candidates\": [{\"content\": {\"parts\": [{\"text\": \"" + text
+        + "\"}], \"role\": \"model\"}}]}\n\n";
+}
+
+// Three chunks as the API streams them; "café" ends in a two-byte UTF-8 sequence
+QByteArray sampleStream() {
+    return textEvent("Hello, ")
+        + textEvent("caf\xC3\xA9 ")
+        + "data: {\"candidates\": [{\"content\": {\"parts\": [{\"text\": \"world.\"}]},"
+          " \"finishReason\": \"STOP\"}], \"usageMetadata\": {\"promptTokenCount\": 12,"
+          " \"candidatesTokenCount\": 5, \"totalTokenCount\": 17}, \"modelVersion\": \"gemini-test\"}\n\n";
+}
+
+const QString SAMPLE_TEXT = QString::fromUtf8("Hello, caf\xC3\xA9 world.");
+
+} // namespace
+
+TEST(GeminiStreamParserTest, WholeStreamInOneRead) {
+    GeminiStreamParser parser;
+    EXPECT_EQ(parser.feed(sampleStream()), SAMPLE_TEXT);
+    EXPECT_TRUE(parser.finish().isEmpty());
+
+    EXPECT_EQ(parser.text(), SAMPLE_TEXT);
+    EXPECT_EQ(parser.eventCount(), 3);
+    EXPECT_EQ(parser.finishReason(), "STOP");
+    EXPECT_EQ(parser.usageMetadata().value("totalTokenCount").toInt(), 17);
+    EXPECT_EQ(parser.modelVersion(), "gemini-test");
+    EXPECT_FALSE(parser.hasError());
+}
+
+TEST(GeminiStreamParserTest, JsonSplitMidFrameWaitsForTheRest) {
+    const QByteArray event = textEvent("split");
+    const qsizetype middle = event.indexOf("\"text\"") + 3;
+
+    GeminiStreamParser parser;
+    EXPECT_TRUE(parser.feed(event.left(middle)).isEmpty());
+    EXPECT_EQ(parser.eventCount(), 0);
+    EXPECT_FALSE(parser.hasError());
+
+    EXPECT_EQ(parser.feed(event.mid(middle)), "split");
+    EXPECT_EQ(parser.eventCount(), 1);
+}
+
+TEST(GeminiStreamParserTest, EverySplitPointGivesTheSameResult) {
+    const QByteArray stream = sampleStream();
+    for (qsizetype split = 1; split < stream.size(); ++split) {
+        GeminiStreamParser parser;
+        QString text = parser.feed(stream.left(split));
+        text += parser.feed(stream.mid(split));
+        text += parser.finish();
+
+        ASSERT_EQ(text, SAMPLE_TEXT) << "split at byte " << split;
+        ASSERT_EQ(parser.eventCount(), 3) << "split at byte " << split;
+        ASSERT_FALSE(parser.hasError()) << "split at byte " << split;
+    }
+}
+
+TEST(GeminiStreamParserTest, OneByteAtATime) {
+    // CRLF line endings, with a byte-wise feed splitting every pair
+    QByteArray stream = sampleStream();
+    stream.replace("\n", "\r\n");
+
+    GeminiStreamParser parser;
+    QString text;
+    for (const char byte : stream) {
+        text += parser.feed(QByteArray(1, byte));
+    }
+    text += parser.finish();
+
+    EXPECT_EQ(text, SAMPLE_TEXT);
+    EXPECT_EQ(parser.eventCount(), 3);
+    EXPECT_EQ(parser.finishReason(), "STOP");
+}
+
+TEST(GeminiStreamParserTest, PayloadOverSeveralDataLines) {
+    GeminiStreamParser parser;
+    const QByteArray event = "data: {\"candidates\": [{\"content\":\n"
+                             "data: {\"parts\": [{\"text\": \"joined\"}]}}]}\n"
+                             ": keep-alive comment\n\n";
+    EXPECT_EQ(parser.feed(event), "joined");
+    EXPECT_FALSE(parser.hasError());
+}
+
+TEST(GeminiStreamParserTest, FinishParsesAnUnterminatedLastEvent) {
+    QByteArray event = textEvent("last");
+    event.chop(2);
+
+    GeminiStreamParser parser;
+    EXPECT_TRUE(parser.feed(event).isEmpty());
+    EXPECT_EQ(parser.finish(), "last");
+    EXPECT_EQ(parser.text(), "last");
+}
+
+TEST(GeminiStreamParserTest, ThoughtPartsAreNotText) {
+    GeminiStreamParser parser;
+    const QByteArray event = "data: {\"candidates\": [{\"content\": {\"parts\": ["
+                             "{\"text\": \"Thinking it over\", \"thought\": true},"
+                             "{\"text\": \"Answer\"}]}}]}\n\n";
+    EXPECT_EQ(parser.feed(event), "Answer");
+}
+
+TEST(GeminiStreamParserTest, ErrorMidStreamKeepsTheRetryDelay) {
+    GeminiStreamParser parser;
+    parser.feed(textEvent("partial "));
+    parser.feed("data: {\"error\": {\"code\": 429, \"message\": \"Quota exceeded\", \"details\": ["
+                "{\"@type\": \"type.googleapis.com/google.rpc.RetryInfo\", \"retryDelay\": \"37s\"}]}}\n\n");
+
+    EXPECT_TRUE(parser.hasError());
+    EXPECT_EQ(parser.errorCode(), 429);
+    EXPECT_EQ(parser.errorMessage(), "Quota exceeded");
+    EXPECT_EQ(parser.retryDelayMs(), 37000);
+    EXPECT_EQ(parser.text(), "partial ");
+}
+
+TEST(GeminiStreamParserTest, MalformedEventIsAnError) {
+    GeminiStreamParser parser;
+    EXPECT_TRUE(parser.feed("data: {\"candidates\": [\n\n").isEmpty());
+    EXPECT_TRUE(parser.hasError());
+    EXPECT_EQ(parser.eventCount(), 0);
+
+    parser.reset();
+    EXPECT_FALSE(parser.hasError());
+    EXPECT_TRUE(parser.text().isEmpty());
+}
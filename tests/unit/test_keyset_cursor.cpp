@@ -0,0 +1,199 @@
+// Unit Test for keyset cursors
+// Pages sessions through openSessionCursor() on a real database: rows with equal
+// sort keys are split across pages without repeats or gaps, in both orders, and
+// rows added between pages neither shift nor duplicate what is still to come
+
+#include <gtest/gtest.h>
+#include <QDateTime>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <memory>
+
+#include "../../src/services/StorageManager.h"
+#include "../../src/models/UserSession.h"
+
+namespace {
+
+class KeysetCursorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_dir.isValid());
+        m_storage = std::make_unique<StorageManager>();
+        ASSERT_TRUE(m_storage->initialize(m_dir.filePath("cursor.db")))
+            << m_storage->getErrorString().toStdString();
+        m_sessions = m_storage->getUserSessionStorage();
+    }
+
+    void TearDown() override {
+        m_storage.reset();
+    }
+
+    QString addSession(const QString& name, const QDateTime& startedAt) {
+        UserSession session(name);
+        session.setStartTime(startedAt);
+        const QString id = m_sessions->saveUserSession(session);
+        EXPECT_FALSE(id.isEmpty());
+        m_ids.append(id);
+        m_startTimes.insert(id, startedAt);
+        return id;
+    }
+
+    // Reads wait for the session's queued write; the writer commits in order
+    void waitForWrites() {
+        ASSERT_FALSE(m_ids.isEmpty());
+        ASSERT_TRUE(m_sessions->userSessionExists(m_ids.last()));
+    }
+
+    // Every id, paging @p pageSize rows at a time from @p after
+    QStringList pageThrough(int pageSize, SortOrder order, int* pages = nullptr, KeysetPosition after = {}) {
+        QStringList ids;
+        int pageCount = 0;
+        for (;;) {
+            PageRequest request;
+            request.pageSize = pageSize;
+            request.sortOrder = order;
+            request.after = after;
+            std::unique_ptr<StorageCursor<UserSession>> cursor = m_sessions->openSessionCursor(request);
+            int rows = 0;
+            while (cursor->next()) {
+                ids.append(cursor->current().getId());
+                after = cursor->position();
+                ++rows;
+            }
+            if (rows == 0) {
+                break;
+            }
+            ++pageCount;
+            if (rows < pageSize) {
+                break;
+            }
+        }
+        if (pages) {
+            *pages = pageCount;
+        }
+        return ids;
+    }
+
+    // The order the listing promises: by start time, ties broken by id, both the same way
+    QStringList expectedOrder(SortOrder order) const {
+        QStringList ids = m_ids;
+        std::sort(ids.begin(), ids.end(), [this, order](const QString& a, const QString& b) {
+            const QDateTime startA = m_startTimes.value(a);
+            const QDateTime startB = m_startTimes.value(b);
+            const bool less = startA != startB ? startA < startB : a < b;
+            const bool greater = startA != startB ? startA > startB : a > b;
+            return order == SortOrder::Ascending ? less : greater;
+        });
+        return ids;
+    }
+
+    QTemporaryDir m_dir;
+    std::unique_ptr<StorageManager> m_storage;
+    IUserSessionStorage* m_sessions = nullptr;
+    QStringList m_ids;
+    QHash<QString, QDateTime> m_startTimes;
+};
+
+const QDateTime BASE(QDate(2026, 3, 1), QTime(9, 0));
+
+} // namespace
+
+TEST_F(KeysetCursorTest, TiesAreSplitAcrossPagesWithoutRepeats) {
+    addSession("Earliest", BASE);
+    for (int i = 0; i < 5; ++i) {
+        addSession(QString("Tied %1").arg(i), BASE.addSecs(60)); // Same minute for all five
+    }
+    addSession("Latest", BASE.addSecs(120));
+    waitForWrites();
+
+    for (const SortOrder order : {SortOrder::Descending, SortOrder::Ascending}) {
+        for (const int pageSize : {1, 2, 3, 4, 7, 100}) {
+            int pages = 0;
+            const QStringList ids = pageThrough(pageSize, order, &pages);
+            EXPECT_EQ(ids, expectedOrder(order)) << "page size " << pageSize;
+            EXPECT_EQ(pages, (m_ids.size() + pageSize - 1) / pageSize) << "page size " << pageSize;
+        }
+    }
+}
+
+TEST_F(KeysetCursorTest, PositionResumesInsideARunOfTies) {
+    for (int i = 0; i < 6; ++i) {
+        addSession(QString("Tied %1").arg(i), BASE);
+    }
+    waitForWrites();
+    const QStringList order = expectedOrder(SortOrder::Descending);
+
+    // Stop after the third row, then continue from its position
+    PageRequest first;
+    first.pageSize = 3;
+    std::unique_ptr<StorageCursor<UserSession>> cursor = m_sessions->openSessionCursor(first);
+    KeysetPosition position;
+    while (cursor->next()) {
+        position = cursor->position();
+    }
+    EXPECT_EQ(position.id, order.at(2));
+
+    EXPECT_EQ(pageThrough(100, SortOrder::Descending, nullptr, position), order.mid(3));
+}
+
+TEST_F(KeysetCursorTest, RowsAddedBetweenPagesDoNotShiftTheListing) {
+    for (int i = 0; i < 6; ++i) {
+        addSession(QString("Session %1").arg(i), BASE.addSecs(60 * (i / 2))); // Pairs of ties
+    }
+    waitForWrites();
+    const QStringList before = expectedOrder(SortOrder::Descending);
+
+    PageRequest request;
+    request.pageSize = 3;
+    std::unique_ptr<StorageCursor<UserSession>> cursor = m_sessions->openSessionCursor(request);
+    QStringList seen;
+    KeysetPosition position;
+    while (cursor->next()) {
+        seen.append(cursor->current().getId());
+        position = cursor->position();
+    }
+    cursor.reset();
+    ASSERT_EQ(seen, before.mid(0, 3));
+
+    // A new newest row would push an OFFSET page down by one; the keyset page ignores it,
+    // while an older one lands where it sorts among the rows still to come
+    addSession("Newest", BASE.addSecs(3600));
+    const QString older = addSession("Older", BASE.addSecs(-3600));
+    waitForWrites();
+
+    QStringList rest = pageThrough(3, SortOrder::Descending, nullptr, position);
+    QStringList expectedRest = before.mid(3);
+    expectedRest.append(older);
+    EXPECT_EQ(rest, expectedRest);
+}
+
+TEST_F(KeysetCursorTest, ProjectionDecodesOnlyTheColumnsAsked) {
+    const QString id = addSession("Projected", BASE);
+    waitForWrites();
+
+    PageRequest request;
+    request.columns = {"name", "no_such_column"};
+    std::unique_ptr<StorageCursor<UserSession>> cursor = m_sessions->openSessionCursor(request);
+    ASSERT_TRUE(cursor->next());
+    const UserSession session = cursor->current();
+    EXPECT_EQ(session.getId(), id);
+    EXPECT_EQ(session.getName(), "Projected");
+    EXPECT_TRUE(session.getNotes().isEmpty());
+    EXPECT_EQ(cursor->position().id, id);
+    EXPECT_FALSE(cursor->next());
+}
+
+TEST_F(KeysetCursorTest, UnknownFilterColumnsMatchNothing) {
+    addSession("Filtered", BASE);
+    waitForWrites();
+
+    PageRequest known;
+    known.filters = {QueryFilter{"name", "=", "Filtered"}};
+    EXPECT_TRUE(m_sessions->openSessionCursor(known)->next());
+
+    PageRequest unknown;
+    unknown.filters = {QueryFilter{"name; DROP TABLE user_sessions", "=", "Filtered"}};
+    EXPECT_FALSE(m_sessions->openSessionCursor(unknown)->next());
+    EXPECT_TRUE(m_sessions->userSessionExists(m_ids.first()));
+}
@@ -0,0 +1,252 @@
+// Unit Test for MigrationRunner
+// Runs a backfill over a temporary database: batches commit with their cursor, a
+// failed or stopped run leaves the cursor at the last committed batch, and the next
+// start resumes from it without rewriting a row twice
+
+#include <gtest/gtest.h>
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QObject>
+#include <QPair>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QThread>
+#include <atomic>
+#include <functional>
+
+#include "../../src/services/ConnectionPool.h"
+#include "../../src/services/MigrationRunner.h"
+#include "../../src/services/SqliteWriter.h"
+
+namespace {
+
+constexpr int ROWS = MigrationRunner::BATCH_ROWS * 5 / 2;
+constexpr int VERSION = 3;
+
+// Callbacks are queued to the context; pump events until @p condition holds
+bool waitUntil(const std::function<bool()>& condition) {
+    const QDeadlineTimer deadline(SqliteWriter::DEFAULT_WAIT_MS);
+    while (!condition()) {
+        if (deadline.hasExpired()) {
+            return false;
+        }
+        QCoreApplication::processEvents();
+        QThread::msleep(1);
+    }
+    return true;
+}
+
+class MigrationRunnerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_dir.isValid());
+        const QString path = m_dir.filePath("migration.db");
+        ASSERT_TRUE(m_writer.start(path, "migration_runner_test"));
+
+        QList<SqliteWriter::Statement> schema = {
+            {"CREATE TABLE metadata (key TEXT PRIMARY KEY, value TEXT, updated_at TEXT)", {}, {}},
+            {"CREATE TABLE items (id INTEGER PRIMARY KEY, text TEXT NOT NULL, upper TEXT, ranged INTEGER)", {}, {}},
+            // Stands in for a disk error partway through a batch
+            {"CREATE TABLE failing (low INTEGER, high INTEGER)", {}, {}},
+            {"CREATE TRIGGER fail_backfill BEFORE UPDATE OF upper ON items "
+             "WHEN EXISTS (SELECT 1 FROM failing WHERE NEW.id BETWEEN low AND high) "
+             "BEGIN SELECT RAISE(ABORT, 'disk went away'); END", {}, {}},
+        };
+        SqliteWriter::Statement rows{"INSERT INTO items (id, text) VALUES (?, ?)", {}, {}};
+        for (int id = 1; id <= ROWS; ++id) {
+            rows.rows.append({id, QString("item %1").arg(id)});
+        }
+        schema.append(rows);
+        ASSERT_TRUE(m_writer.waitForWrite(m_writer.enqueue(schema)));
+
+        m_readers.open(path, "migration_runner_test_reader");
+        m_backfill.version = VERSION;
+        m_backfill.table = "items";
+        m_backfill.columns = "text";
+        m_backfill.updates = {"UPDATE items SET upper = ? WHERE id = ?"};
+        m_backfill.rangeUpdates = {"UPDATE items SET ranged = 1 WHERE id > ? AND id <= ?"};
+        m_backfill.rewrite = [this](const QSqlQuery& row) -> std::optional<QVariantList> {
+            const qint64 rowId = row.value(0).toLongLong();
+            m_onRewrite(rowId);
+            QMutexLocker locker(&m_mutex);
+            m_rewritten.append(rowId);
+            return QVariantList{row.value(1).toString().toUpper(), rowId};
+        };
+    }
+
+    void TearDown() override {
+        m_runner.stop();
+        m_readers.close();
+        m_writer.stop();
+    }
+
+    void execute(const QString& sql, const QVariantList& values = {}) {
+        ASSERT_TRUE(m_writer.waitForWrite(m_writer.enqueue(SqliteWriter::Statement{sql, values, {}})));
+    }
+
+    void setCursor(qint64 rowId) {
+        execute("INSERT OR REPLACE INTO metadata (key, value) VALUES (?, ?)",
+                {MigrationRunner::cursorKey(VERSION), QString::number(rowId)});
+    }
+
+    // -1 once the backfill has finished and deleted it
+    qint64 storedCursor() {
+        QSqlQuery query(m_readers.database());
+        query.prepare("SELECT value FROM metadata WHERE key = ?");
+        query.addBindValue(MigrationRunner::cursorKey(VERSION));
+        EXPECT_TRUE(query.exec());
+        return query.next() ? query.value(0).toLongLong() : -1;
+    }
+
+    int countWhere(const QString& condition) {
+        QSqlQuery query(m_readers.database());
+        EXPECT_TRUE(query.exec("SELECT count(*) FROM items WHERE " + condition));
+        return query.next() ? query.value(0).toInt() : -1;
+    }
+
+    bool start() {
+        m_finished = false;
+        {
+            QMutexLocker locker(&m_mutex);
+            m_rewritten.clear();
+        }
+        return m_runner.start(
+            {m_backfill}, &m_context,
+            [this](const MigrationRunner::Backfill&, qint64 rowsDone, qint64 rowsTotal) {
+                m_progress.append({rowsDone, rowsTotal});
+            },
+            [this](const MigrationRunner::Backfill&, bool ok, const QString& errorMessage) {
+                m_ok = ok;
+                m_errorMessage = errorMessage;
+                m_finished = true;
+            });
+    }
+
+    QList<qint64> rewritten() {
+        QMutexLocker locker(&m_mutex);
+        return m_rewritten;
+    }
+
+    static QList<qint64> range(qint64 first, qint64 last) {
+        QList<qint64> ids;
+        for (qint64 id = first; id <= last; ++id) {
+            ids.append(id);
+        }
+        return ids;
+    }
+
+    QTemporaryDir m_dir;
+    SqliteWriter m_writer;
+    ConnectionPool m_readers;
+    MigrationRunner m_runner{&m_writer, &m_readers};
+    MigrationRunner::Backfill m_backfill;
+    QObject m_context;
+
+    std::function<void(qint64)> m_onRewrite = [](qint64) {};
+    QMutex m_mutex;
+    QList<qint64> m_rewritten;
+    QList<QPair<qint64, qint64>> m_progress;
+    bool m_finished = false;
+    bool m_ok = false;
+    QString m_errorMessage;
+};
+
+} // namespace
+
+TEST_F(MigrationRunnerTest, RewritesEveryRowInBatchesAndDeletesTheCursor) {
+    setCursor(0);
+    ASSERT_TRUE(start());
+    ASSERT_TRUE(waitUntil([this]() { return m_finished; }));
+
+    EXPECT_TRUE(m_ok) << m_errorMessage.toStdString();
+    EXPECT_EQ(rewritten(), range(1, ROWS));
+    EXPECT_EQ(countWhere("upper = upper(text)"), ROWS);
+    EXPECT_EQ(countWhere("ranged = 1"), ROWS);
+    EXPECT_EQ(storedCursor(), -1);
+
+    const int batch = MigrationRunner::BATCH_ROWS;
+    EXPECT_EQ(m_progress, (QList<QPair<qint64, qint64>>{{batch, ROWS}, {2 * batch, ROWS}, {ROWS, ROWS}}));
+}
+
+TEST_F(MigrationRunnerTest, FailedBatchRollsBackAndTheNextStartResumesFromTheCursor) {
+    const int batch = MigrationRunner::BATCH_ROWS;
+    execute("INSERT INTO failing (low, high) VALUES (?, ?)", {batch + 1, 2 * batch});
+    setCursor(0);
+    ASSERT_TRUE(start());
+    ASSERT_TRUE(waitUntil([this]() { return m_finished; }));
+
+    // The first batch committed with its cursor; none of the second did
+    EXPECT_FALSE(m_ok);
+    EXPECT_TRUE(m_errorMessage.contains("disk went away")) << m_errorMessage.toStdString();
+    EXPECT_EQ(storedCursor(), batch);
+    EXPECT_EQ(countWhere("upper IS NOT NULL"), batch);
+    EXPECT_EQ(countWhere("upper IS NOT NULL AND id > " + QString::number(batch)), 0);
+    EXPECT_EQ(countWhere("ranged = 1"), batch);
+
+    execute("DELETE FROM failing");
+    ASSERT_TRUE(start());
+    ASSERT_TRUE(waitUntil([this]() { return m_finished; }));
+
+    EXPECT_TRUE(m_ok) << m_errorMessage.toStdString();
+    EXPECT_EQ(rewritten(), range(batch + 1, ROWS)); // Nothing before the cursor again
+    EXPECT_EQ(countWhere("upper = upper(text)"), ROWS);
+    EXPECT_EQ(countWhere("ranged = 1"), ROWS);
+    EXPECT_EQ(storedCursor(), -1);
+}
+
+TEST_F(MigrationRunnerTest, StopFinishesTheBatchInFlight) {
+    const int batch = MigrationRunner::BATCH_ROWS;
+    std::atomic<bool> inSecondBatch{false};
+    m_onRewrite = [&inSecondBatch](qint64 rowId) {
+        if (rowId == batch + 1) {
+            inSecondBatch = true;
+            QThread::msleep(100); // Long enough for stop() to be called meanwhile
+        }
+    };
+    setCursor(0);
+    ASSERT_TRUE(start());
+    ASSERT_TRUE(waitUntil([&inSecondBatch]() { return inSecondBatch.load(); }));
+    m_runner.stop();
+    EXPECT_FALSE(m_runner.isRunning());
+
+    EXPECT_EQ(rewritten(), range(1, 2 * batch));
+    EXPECT_EQ(storedCursor(), 2 * batch);
+    EXPECT_EQ(countWhere("upper IS NOT NULL"), 2 * batch);
+    // Stopping is not a failure, so nothing is reported
+    QCoreApplication::processEvents();
+    EXPECT_FALSE(m_finished);
+
+    m_onRewrite = [](qint64) {};
+    ASSERT_TRUE(start());
+    ASSERT_TRUE(waitUntil([this]() { return m_finished; }));
+    EXPECT_TRUE(m_ok) << m_errorMessage.toStdString();
+    EXPECT_EQ(rewritten(), range(2 * batch + 1, ROWS));
+    EXPECT_EQ(countWhere("upper = upper(text)"), ROWS);
+    EXPECT_EQ(storedCursor(), -1);
+}
+
+TEST_F(MigrationRunnerTest, FinishedBackfillDoesNothing) {
+    // No cursor: finished on an earlier start
+    ASSERT_TRUE(start());
+    ASSERT_TRUE(waitUntil([this]() { return m_finished; }));
+    EXPECT_TRUE(m_ok);
+    EXPECT_TRUE(rewritten().isEmpty());
+    EXPECT_EQ(countWhere("upper IS NULL"), ROWS);
+}
+
+TEST_F(MigrationRunnerTest, CursorKeysAndDescriptions) {
+    EXPECT_EQ(MigrationRunner::cursorKey(7), "backfill_7");
+    EXPECT_EQ(MigrationRunner::cursorKey(QString("fts_rebuild")), "backfill_fts_rebuild");
+
+    MigrationRunner::Backfill named;
+    named.name = "fts_rebuild";
+    EXPECT_EQ(MigrationRunner::cursorKey(named), "backfill_fts_rebuild");
+    EXPECT_EQ(MigrationRunner::describe(named), "fts_rebuild");
+    named.version = 7;
+    EXPECT_EQ(MigrationRunner::cursorKey(named), "backfill_7");
+    EXPECT_EQ(MigrationRunner::describe(named), "schema version 7");
+
+    EXPECT_FALSE(m_runner.start({}, &m_context, {}, {}));
+}
@@ -0,0 +1,157 @@
+// Unit Test for OrphanScanner
+// Scans a temporary recordings tree: audio files no recording refers to are reported,
+// unchanged directories reuse their listing, and the known files follow storage writes
+
+#include <gtest/gtest.h>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include "../../src/services/OrphanScanner.h"
+
+namespace {
+
+class OrphanScannerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_dir.isValid());
+        ASSERT_TRUE(QDir(m_dir.path()).mkpath("session"));
+        write("owned.wav", 100);
+        write("stray.flac", 250);
+        write("notes.txt", 50);
+        write("session/stray.MP3", 400);
+        write("session/segment.wav", 75);
+
+        m_known = {{"recording-1", {path("owned.wav"), path("session/segment.wav")}}};
+        m_scanner.setRoot(m_dir.path());
+        m_scanner.setKnownFilesLoader([this]() {
+            ++m_loads;
+            return m_known;
+        });
+    }
+
+    QString path(const QString& relative) const {
+        return QDir::cleanPath(m_dir.filePath(relative));
+    }
+
+    void write(const QString& relative, int bytes) {
+        QFile file(path(relative));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Append));
+        file.write(QByteArray(bytes, 'x'));
+    }
+
+    // Directory mtimes tick coarsely; leave room so the next change is seen
+    static void waitForNewMtime() {
+        QThread::msleep(20);
+    }
+
+    QTemporaryDir m_dir;
+    OrphanScanner m_scanner;
+    QHash<QString, QStringList> m_known;
+    int m_loads = 0;
+};
+
+} // namespace
+
+TEST_F(OrphanScannerTest, ReportsAudioFilesNoRecordingOwns) {
+    const OrphanScanner::Result result = m_scanner.scan();
+    EXPECT_EQ(result.orphanedFiles, (QStringList{path("session/stray.MP3"), path("stray.flac")}));
+    EXPECT_EQ(result.reclaimableBytes, 650);
+    EXPECT_EQ(result.directoriesListed, 2);
+    EXPECT_EQ(result.directoriesSkipped, 0);
+    EXPECT_EQ(m_scanner.lastResult().orphanedFiles, result.orphanedFiles);
+}
+
+TEST_F(OrphanScannerTest, UnchangedDirectoriesAreNotListedAgain) {
+    m_scanner.scan();
+
+    // Growing a file leaves its directory's mtime alone; the size is still read fresh
+    write("stray.flac", 50);
+    OrphanScanner::Result result = m_scanner.scan();
+    EXPECT_EQ(result.directoriesListed, 0);
+    EXPECT_EQ(result.directoriesSkipped, 2);
+    EXPECT_EQ(result.orphanedFiles.size(), 2);
+    EXPECT_EQ(result.reclaimableBytes, 700);
+
+    waitForNewMtime();
+    write("session/late.opus", 10);
+    result = m_scanner.scan();
+    EXPECT_EQ(result.directoriesListed, 1);
+    EXPECT_EQ(result.directoriesSkipped, 1);
+    EXPECT_TRUE(result.orphanedFiles.contains(path("session/late.opus")));
+}
+
+TEST_F(OrphanScannerTest, RemovedDirectoriesDropOut) {
+    m_scanner.scan();
+
+    waitForNewMtime();
+    ASSERT_TRUE(QDir(path("session")).removeRecursively());
+    const OrphanScanner::Result result = m_scanner.scan();
+    EXPECT_EQ(result.orphanedFiles, QStringList{path("stray.flac")});
+    EXPECT_EQ(result.directoriesListed, 1);
+    EXPECT_EQ(result.directoriesSkipped, 0);
+}
+
+TEST_F(OrphanScannerTest, KnownFilesFollowStorageWrites) {
+    m_scanner.scan();
+    ASSERT_EQ(m_loads, 1);
+
+    m_scanner.setKnownFiles("recording-2", {path("stray.flac"), path("owned.wav")});
+    EXPECT_EQ(m_scanner.scan().orphanedFiles, QStringList{path("session/stray.MP3")});
+
+    // owned.wav is still referred to by the second recording
+    m_scanner.forgetRecording("recording-1");
+    EXPECT_EQ(m_scanner.scan().orphanedFiles,
+              (QStringList{path("session/segment.wav"), path("session/stray.MP3")}));
+
+    // Replacing a recording's files releases the ones it no longer lists
+    m_scanner.setKnownFiles("recording-2", {path("stray.flac")});
+    EXPECT_TRUE(m_scanner.scan().orphanedFiles.contains(path("owned.wav")));
+    EXPECT_EQ(m_loads, 1);
+}
+
+TEST_F(OrphanScannerTest, InvalidatedKnownFilesAreReloaded) {
+    m_scanner.scan();
+    m_known.insert("recording-2", {path("stray.flac")});
+    EXPECT_EQ(m_scanner.scan().orphanedFiles.size(), 2); // Still the first load
+    EXPECT_EQ(m_loads, 1);
+
+    m_scanner.invalidateKnownFiles();
+    EXPECT_EQ(m_scanner.scan().orphanedFiles, QStringList{path("session/stray.MP3")});
+    EXPECT_EQ(m_loads, 2);
+}
+
+TEST_F(OrphanScannerTest, WritesRacingTheLoadTriggerAReload) {
+    m_scanner.setKnownFilesLoader([this]() {
+        ++m_loads;
+        if (m_loads == 1) {
+            // Saved after the loader read the table, before it returned
+            m_scanner.setKnownFiles("recording-2", {path("stray.flac")});
+            return m_known;
+        }
+        QHash<QString, QStringList> reread = m_known;
+        reread.insert("recording-2", {path("stray.flac")});
+        return reread;
+    });
+
+    EXPECT_EQ(m_scanner.scan().orphanedFiles, QStringList{path("session/stray.MP3")});
+    EXPECT_EQ(m_loads, 2);
+}
+
+TEST_F(OrphanScannerTest, MissingRootFindsNothing) {
+    m_scanner.setRoot(path("missing"));
+    const OrphanScanner::Result result = m_scanner.scan();
+    EXPECT_TRUE(result.orphanedFiles.isEmpty());
+    EXPECT_EQ(result.directoriesListed, 0);
+    EXPECT_EQ(m_loads, 0);
+}
+
+TEST(OrphanScannerStaticTest, RecognizesAudioSuffixes) {
+    EXPECT_TRUE(OrphanScanner::isAudioFile("take.wav"));
+    EXPECT_TRUE(OrphanScanner::isAudioFile("TAKE.FLAC"));
+    EXPECT_TRUE(OrphanScanner::isAudioFile("/a/b/segment.opus"));
+    EXPECT_FALSE(OrphanScanner::isAudioFile("transcript.txt"));
+    EXPECT_FALSE(OrphanScanner::isAudioFile("wav"));
+}
@@ -0,0 +1,120 @@
+// Unit Test for PolyphaseResampler
+// Covers the output length for common capture rates, unity gain at DC and
+// streaming in chunks matching a single whole-buffer call
+
+#include <gtest/gtest.h>
+#include <QVector>
+#include <cmath>
+#include <numeric>
+
+#include "../../src/services/PolyphaseResampler.h"
+
+namespace {
+
+struct RatePair {
+    int inputRate;
+    int outputRate;
+};
+
+const RatePair RATE_PAIRS[] = {
+    {48000, 16000},
+    {44100, 16000},
+    {22050, 16000},
+    {8000, 16000},
+    {16000, 48000},
+};
+
+// Output n reads input floor(n * M / L), so N inputs give ceil(N * L / M) outputs
+qint64 expectedLength(qint64 inputLength, int inputRate, int outputRate) {
+    const int divisor = std::gcd(inputRate, outputRate);
+    const qint64 up = outputRate / divisor;
+    const qint64 down = inputRate / divisor;
+    return (inputLength * up + down - 1) / down;
+}
+
+QVector<float> sine(int length, double frequency, int sampleRate) {
+    QVector<float> samples(length);
+    for (int i = 0; i < length; ++i) {
+        samples[i] = static_cast<float>(0.5 * std::sin(2.0 * 3.14159265358979323846 * frequency * i / sampleRate));
+    }
+    return samples;
+}
+
+} // namespace
+
+TEST(PolyphaseResamplerTest, OutputLengthFollowsTheRateRatio) {
+    for (const RatePair& rates : RATE_PAIRS) {
+        for (int length : {1, 2, 3, 31, 32, 441, 1000, 4800, 44100}) {
+            const QVector<float> output = PolyphaseResampler::resample(QVector<float>(length, 0.25f),
+                                                                       rates.inputRate, rates.outputRate);
+            EXPECT_EQ(output.size(), expectedLength(length, rates.inputRate, rates.outputRate))
+                << rates.inputRate << " -> " << rates.outputRate << ", " << length << " samples";
+        }
+    }
+
+    // One second in is one second out
+    EXPECT_EQ(PolyphaseResampler::resample(QVector<float>(48000), 48000, 16000).size(), 16000);
+    EXPECT_EQ(PolyphaseResampler::resample(QVector<float>(44100), 44100, 16000).size(), 16000);
+}
+
+TEST(PolyphaseResamplerTest, SameRateIsPassthrough) {
+    const QVector<float> input = sine(1000, 440.0, 16000);
+    PolyphaseResampler resampler(16000, 16000);
+    EXPECT_TRUE(resampler.isPassthrough());
+
+    QVector<float> output;
+    resampler.process(input.constData(), input.size(), output);
+    EXPECT_EQ(output, input);
+    EXPECT_EQ(PolyphaseResampler::resample(input, 16000, 16000), input);
+}
+
+TEST(PolyphaseResamplerTest, DcPassesAtUnityGain) {
+    for (const RatePair& rates : RATE_PAIRS) {
+        const int length = rates.inputRate / 10;
+        const QVector<float> output = PolyphaseResampler::resample(QVector<float>(length, 1.0f),
+                                                                   rates.inputRate, rates.outputRate);
+
+        // Skip the outputs whose taps still reach into the leading silence
+        const qint64 settled = expectedLength(PolyphaseResampler::TAPS_PER_PHASE,
+                                              rates.inputRate, rates.outputRate);
+        ASSERT_GT(output.size(), settled);
+        for (qint64 i = settled; i < output.size(); ++i) {
+            ASSERT_NEAR(output[i], 1.0f, 1e-3f)
+                << rates.inputRate << " -> " << rates.outputRate << ", output " << i;
+        }
+    }
+}
+
+TEST(PolyphaseResamplerTest, ChunkedInputMatchesOneCall) {
+    const QVector<float> input = sine(44100 / 4, 300.0, 44100);
+    const QVector<float> whole = PolyphaseResampler::resample(input, 44100, 16000);
+
+    // Chunk sizes that do not line up with the ratio's period or the filter length
+    PolyphaseResampler resampler(44100, 16000);
+    QVector<float> chunked;
+    const int chunkSizes[] = {1, 7, 160, 441, 1023, 5};
+    int offset = 0;
+    for (int chunk = 0; offset < input.size(); ++chunk) {
+        const int count = qMin(chunkSizes[chunk % 6], static_cast<int>(input.size()) - offset);
+        resampler.process(input.constData() + offset, count, chunked);
+        offset += count;
+    }
+
+    ASSERT_EQ(chunked.size(), whole.size());
+    for (int i = 0; i < whole.size(); ++i) {
+        ASSERT_FLOAT_EQ(chunked[i], whole[i]) << "at output " << i;
+    }
+}
+
+TEST(PolyphaseResamplerTest, ResetStartsFromSilence) {
+    const QVector<float> input(4800, 1.0f);
+    PolyphaseResampler resampler(48000, 16000);
+
+    QVector<float> first;
+    resampler.process(input.constData(), input.size(), first);
+    resampler.reset();
+    QVector<float> second;
+    resampler.process(input.constData(), input.size(), second);
+
+    EXPECT_EQ(first, second);
+}
@@ -0,0 +1,271 @@
+// Unit Test for SqliteWriter
+// Covers per-write savepoints: a failing write inside a group commit rolls back
+// alone, grouped writes succeed or fail together, and discarded groups write nothing
+
+#include <gtest/gtest.h>
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "../../src/services/SqliteWriter.h"
+
+namespace {
+
+// Completions run on the writer thread, after waitForQueuedWrites() has returned
+class Completions {
+public:
+    SqliteWriter::Completion track(const QString& name) {
+        return [this, name](bool ok, const QString& errorMessage) {
+            QMutexLocker locker(&m_mutex);
+            m_results.insert(name, {ok, errorMessage});
+            m_changed.wakeAll();
+        };
+    }
+
+    bool waitFor(int count) {
+        QMutexLocker locker(&m_mutex);
+        const QDeadlineTimer deadline(SqliteWriter::DEFAULT_WAIT_MS);
+        while (m_results.size() < count) {
+            if (!m_changed.wait(&m_mutex, deadline)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ok(const QString& name) {
+        QMutexLocker locker(&m_mutex);
+        return m_results.value(name).ok;
+    }
+
+    QString errorMessage(const QString& name) {
+        QMutexLocker locker(&m_mutex);
+        return m_results.value(name).errorMessage;
+    }
+
+private:
+    struct Result {
+        bool ok = false;
+        QString errorMessage;
+    };
+
+    QMutex m_mutex;
+    QWaitCondition m_changed;
+    QHash<QString, Result> m_results;
+};
+
+SqliteWriter::Statement insertItem(int id, const QString& name) {
+    return SqliteWriter::Statement{"INSERT INTO items (id, name) VALUES (?, ?)", {id, name}, {}};
+}
+
+class SqliteWriterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_dir.isValid());
+        m_path = m_dir.filePath("writer.db");
+        ASSERT_TRUE(m_writer.start(m_path, "sqlite_writer_test"));
+        const quint64 created = m_writer.enqueue(
+            SqliteWriter::Statement{"CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT NOT NULL)", {}, {}});
+        ASSERT_TRUE(m_writer.waitForWrite(created));
+    }
+
+    void TearDown() override {
+        m_writer.stop();
+        QSqlDatabase::removeDatabase("sqlite_writer_test_reader");
+    }
+
+    // Ids in the table, read on a connection of the test's own
+    QList<int> storedIds() {
+        QList<int> ids;
+        {
+            QSqlDatabase database = QSqlDatabase::database("sqlite_writer_test_reader", false);
+            if (!database.isValid()) {
+                database = QSqlDatabase::addDatabase("QSQLITE", "sqlite_writer_test_reader");
+                database.setDatabaseName(m_path);
+            }
+            EXPECT_TRUE(database.open());
+            QSqlQuery query(database);
+            EXPECT_TRUE(query.exec("SELECT id FROM items ORDER BY id"));
+            while (query.next()) {
+                ids.append(query.value(0).toInt());
+            }
+        }
+        return ids;
+    }
+
+    QTemporaryDir m_dir;
+    QString m_path;
+    SqliteWriter m_writer;
+    Completions m_completions;
+};
+
+} // namespace
+
+TEST_F(SqliteWriterTest, FailingWriteInAGroupCommitRollsBackAlone) {
+    // Hold the write lock from another connection so the writer stalls on its first
+    // batch; everything queued meanwhile then shares the next group-commit transaction
+    quint64 first = 0;
+    quint64 failing = 0;
+    quint64 after = 0;
+    {
+        QSqlDatabase blocker = QSqlDatabase::addDatabase("QSQLITE", "sqlite_writer_test_blocker");
+        blocker.setDatabaseName(m_path);
+        ASSERT_TRUE(blocker.open());
+        QSqlQuery lock(blocker);
+        ASSERT_TRUE(lock.exec("BEGIN IMMEDIATE"));
+
+        first = m_writer.enqueue(insertItem(1, "first"), nullptr, m_completions.track("first"));
+        // Its own first statement succeeds before the duplicate key fails; both go
+        failing = m_writer.enqueue(QList<SqliteWriter::Statement>{insertItem(2, "partial"), insertItem(1, "duplicate")},
+                                   nullptr, m_completions.track("failing"));
+        after = m_writer.enqueue(insertItem(3, "after"), nullptr, m_completions.track("after"));
+
+        ASSERT_TRUE(lock.exec("COMMIT"));
+    }
+    QSqlDatabase::removeDatabase("sqlite_writer_test_blocker");
+
+    EXPECT_TRUE(m_writer.waitForWrite(first));
+    EXPECT_FALSE(m_writer.waitForWrite(failing));
+    EXPECT_TRUE(m_writer.waitForWrite(after));
+    ASSERT_TRUE(m_completions.waitFor(3));
+
+    EXPECT_TRUE(m_completions.ok("first"));
+    EXPECT_FALSE(m_completions.ok("failing"));
+    EXPECT_FALSE(m_completions.errorMessage("failing").isEmpty());
+    EXPECT_TRUE(m_completions.ok("after"));
+    EXPECT_EQ(storedIds(), (QList<int>{1, 3}));
+    EXPECT_TRUE(m_writer.lastError().isEmpty()) << m_writer.lastError().toStdString();
+}
+
+TEST_F(SqliteWriterTest, GroupedWritesFailTogetherAndAlone) {
+    const quint64 before = m_writer.enqueue(insertItem(1, "before"), nullptr, m_completions.track("before"));
+
+    m_writer.beginGroup();
+    EXPECT_EQ(m_writer.enqueue(insertItem(10, "member"), nullptr, m_completions.track("member")), 0u);
+    EXPECT_EQ(m_writer.enqueue(insertItem(1, "duplicate"), nullptr, m_completions.track("duplicate")), 0u);
+    m_writer.commitGroup();
+
+    const quint64 after = m_writer.enqueue(insertItem(2, "after"), nullptr, m_completions.track("after"));
+    EXPECT_TRUE(m_writer.waitForWrite(before));
+    EXPECT_TRUE(m_writer.waitForWrite(after));
+    ASSERT_TRUE(m_writer.waitForQueuedWrites());
+    ASSERT_TRUE(m_completions.waitFor(4));
+
+    // The group is one write: its good member goes with its bad one, and nothing else does
+    EXPECT_FALSE(m_completions.ok("member"));
+    EXPECT_FALSE(m_completions.ok("duplicate"));
+    EXPECT_EQ(m_completions.errorMessage("member"), m_completions.errorMessage("duplicate"));
+    EXPECT_TRUE(m_completions.ok("before"));
+    EXPECT_TRUE(m_completions.ok("after"));
+    EXPECT_EQ(storedIds(), (QList<int>{1, 2}));
+}
+
+TEST_F(SqliteWriterTest, NestedGroupCommitsWithTheOutermost) {
+    m_writer.beginGroup();
+    m_writer.enqueue(insertItem(1, "outer"), nullptr, m_completions.track("outer"));
+    m_writer.beginGroup();
+    m_writer.enqueue(insertItem(2, "inner"), nullptr, m_completions.track("inner"));
+    m_writer.commitGroup();
+
+    // Still held by the outer group
+    ASSERT_TRUE(m_writer.waitForQueuedWrites());
+    EXPECT_TRUE(storedIds().isEmpty());
+
+    m_writer.commitGroup();
+    ASSERT_TRUE(m_writer.waitForQueuedWrites());
+    ASSERT_TRUE(m_completions.waitFor(2));
+    EXPECT_TRUE(m_completions.ok("outer"));
+    EXPECT_TRUE(m_completions.ok("inner"));
+    EXPECT_EQ(storedIds(), (QList<int>{1, 2}));
+}
+
+TEST_F(SqliteWriterTest, DiscardedGroupWritesNothing) {
+    m_writer.beginGroup();
+    m_writer.enqueue(insertItem(1, "dropped"), nullptr, m_completions.track("dropped"));
+    m_writer.discardGroup();
+
+    ASSERT_TRUE(m_completions.waitFor(1));
+    EXPECT_FALSE(m_completions.ok("dropped"));
+    EXPECT_EQ(m_completions.errorMessage("dropped"), "Transaction rolled back");
+    ASSERT_TRUE(m_writer.waitForQueuedWrites());
+    EXPECT_TRUE(storedIds().isEmpty());
+}
+
+TEST_F(SqliteWriterTest, StandaloneWriteIsRefusedInsideAGroup) {
+    m_writer.beginGroup();
+    EXPECT_EQ(m_writer.enqueueStandalone("VACUUM", nullptr, m_completions.track("vacuum")), 0u);
+    m_writer.discardGroup();
+
+    ASSERT_TRUE(m_completions.waitFor(1));
+    EXPECT_FALSE(m_completions.ok("vacuum"));
+
+    // Outside a group it runs after the writes queued before it
+    m_writer.enqueue(insertItem(1, "queued"));
+    EXPECT_TRUE(m_writer.waitForWrite(m_writer.enqueueStandalone("VACUUM")));
+    EXPECT_EQ(storedIds(), (QList<int>{1}));
+}
+
+TEST_F(SqliteWriterTest, StoppedWriterRefusesWrites) {
+    m_writer.enqueue(insertItem(1, "committed"));
+    m_writer.stop();
+    EXPECT_FALSE(m_writer.isRunning());
+    EXPECT_EQ(storedIds(), (QList<int>{1}));
+
+    EXPECT_EQ(m_writer.enqueue(insertItem(2, "late"), nullptr, m_completions.track("late")), 0u);
+    ASSERT_TRUE(m_completions.waitFor(1));
+    EXPECT_FALSE(m_completions.ok("late"));
+    EXPECT_EQ(storedIds(), (QList<int>{1}));
+}
+
+TEST_F(SqliteWriterTest, CompletionRunsOnTheContextThread) {
+    QObject context;
+    QThread* completedOn = nullptr;
+    const quint64 sequence = m_writer.enqueue(insertItem(1, "queued"), &context,
+                                              [&completedOn](bool ok, const QString&) {
+        EXPECT_TRUE(ok);
+        completedOn = QThread::currentThread();
+    });
+    ASSERT_TRUE(m_writer.waitForWrite(sequence));
+
+    const QDeadlineTimer deadline(SqliteWriter::DEFAULT_WAIT_MS);
+    while (!completedOn && !deadline.hasExpired()) {
+        QCoreApplication::processEvents();
+    }
+    EXPECT_EQ(completedOn, context.thread());
+}
+
+TEST_F(SqliteWriterTest, CompletionIsDroppedWithItsContext) {
+    bool completed = false;
+    quint64 sequence = 0;
+    {
+        QObject context;
+        sequence = m_writer.enqueue(insertItem(1, "orphaned"), &context,
+                                    [&completed](bool, const QString&) { completed = true; });
+        ASSERT_TRUE(m_writer.waitForWrite(sequence));
+    }
+
+    // Posted before the context went, and discarded with it; the write itself still stands
+    QCoreApplication::processEvents();
+    EXPECT_FALSE(completed);
+    EXPECT_EQ(storedIds(), (QList<int>{1}));
+
+    // A new object, possibly at the same address, gets only its own completions
+    QObject next;
+    bool nextCompleted = false;
+    sequence = m_writer.enqueue(insertItem(2, "next"), &next,
+                                [&nextCompleted](bool ok, const QString&) { nextCompleted = ok; });
+    ASSERT_TRUE(m_writer.waitForWrite(sequence));
+    const QDeadlineTimer deadline(SqliteWriter::DEFAULT_WAIT_MS);
+    while (!nextCompleted && !deadline.hasExpired()) {
+        QCoreApplication::processEvents();
+    }
+    EXPECT_TRUE(nextCompleted);
+    EXPECT_FALSE(completed);
+}
@@ -0,0 +1,154 @@
+// Unit Test for LatencyHistogram and Telemetry
+// Covers exact small values, percentile ranks and the relative error bound of
+// the log-linear buckets, clamping, and the per-stage registry and export
+
+#include <gtest/gtest.h>
+#include <QFile>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+#include <cmath>
+
+#include "../../src/services/Telemetry.h"
+
+namespace {
+
+// Half a bucket over the value at the start of a power of two, rounded up
+constexpr double MAX_RELATIVE_ERROR = 1.0 / LatencyHistogram::SUB_BUCKETS + 1e-9;
+
+} // namespace
+
+TEST(LatencyHistogramTest, EmptyHistogramReportsZeros) {
+    const LatencyHistogram histogram;
+    EXPECT_EQ(histogram.count(), 0u);
+    EXPECT_EQ(histogram.min(), 0);
+    EXPECT_EQ(histogram.max(), 0);
+    EXPECT_DOUBLE_EQ(histogram.mean(), 0.0);
+    EXPECT_EQ(histogram.percentile(0.5), 0);
+    EXPECT_EQ(histogram.percentile(0.99), 0);
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+    LatencyHistogram histogram;
+    for (qint64 value = 1; value <= 50; ++value) {
+        histogram.record(value);
+    }
+
+    // Rank is ceil(quantile * count), the nearest-rank definition
+    EXPECT_EQ(histogram.percentile(0.0), 1);
+    EXPECT_EQ(histogram.percentile(0.5), 25);
+    EXPECT_EQ(histogram.percentile(0.9), 45);
+    EXPECT_EQ(histogram.percentile(0.99), 50);
+    EXPECT_EQ(histogram.percentile(1.0), 50);
+    EXPECT_EQ(histogram.min(), 1);
+    EXPECT_EQ(histogram.max(), 50);
+    EXPECT_DOUBLE_EQ(histogram.mean(), 25.5);
+}
+
+TEST(LatencyHistogramTest, UniformPercentilesWithinTheBucketError) {
+    LatencyHistogram histogram;
+    for (qint64 value = 1; value <= 100000; ++value) {
+        histogram.record(value);
+    }
+
+    for (const double quantile : {0.25, 0.5, 0.9, 0.95, 0.99, 0.999}) {
+        const double expected = quantile * 100000;
+        EXPECT_NEAR(static_cast<double>(histogram.percentile(quantile)), expected, expected * MAX_RELATIVE_ERROR)
+            << "p" << quantile * 100;
+    }
+    EXPECT_EQ(histogram.count(), 100000u);
+    EXPECT_DOUBLE_EQ(histogram.mean(), 50000.5);
+}
+
+TEST(LatencyHistogramTest, RelativeErrorHoldsAtEveryMagnitude) {
+    // A large companion sample keeps the max from clamping the value under test
+    for (qint64 value = 64; value < LatencyHistogram::MAX_VALUE / 2; value = value * 3 / 2 + 1) {
+        LatencyHistogram histogram;
+        histogram.record(value);
+        histogram.record(LatencyHistogram::MAX_VALUE);
+        const qint64 reported = histogram.percentile(0.5);
+        EXPECT_NEAR(static_cast<double>(reported), static_cast<double>(value), value * MAX_RELATIVE_ERROR)
+            << "value " << value;
+    }
+}
+
+TEST(LatencyHistogramTest, TailPercentilesSeeTheSlowSamples) {
+    LatencyHistogram histogram;
+    for (int i = 0; i < 990; ++i) {
+        histogram.record(1000);
+    }
+    for (int i = 0; i < 10; ++i) {
+        histogram.record(250000);
+    }
+
+    EXPECT_NEAR(histogram.percentile(0.5), 1000, 1000 * MAX_RELATIVE_ERROR);
+    EXPECT_NEAR(histogram.percentile(0.99), 1000, 1000 * MAX_RELATIVE_ERROR);
+    EXPECT_EQ(histogram.percentile(0.995), 250000); // Clamped to the exact max
+    EXPECT_EQ(histogram.max(), 250000);
+}
+
+TEST(LatencyHistogramTest, OutOfRangeValuesAreClamped) {
+    LatencyHistogram histogram;
+    histogram.record(-5);
+    histogram.record(LatencyHistogram::MAX_VALUE * 4);
+
+    EXPECT_EQ(histogram.min(), 0);
+    EXPECT_EQ(histogram.max(), LatencyHistogram::MAX_VALUE);
+    EXPECT_EQ(histogram.percentile(0.0), 0);
+    EXPECT_EQ(histogram.percentile(1.0), LatencyHistogram::MAX_VALUE);
+}
+
+TEST(LatencyHistogramTest, ResetForgetsEverything) {
+    LatencyHistogram histogram;
+    histogram.record(123);
+    histogram.reset();
+    EXPECT_EQ(histogram.count(), 0u);
+    EXPECT_EQ(histogram.percentile(0.5), 0);
+
+    histogram.record(7);
+    EXPECT_EQ(histogram.min(), 7);
+    EXPECT_EQ(histogram.max(), 7);
+}
+
+TEST(TelemetryTest, RecordsPerStageAndPerModel) {
+    Telemetry telemetry;
+    telemetry.recordStage(Telemetry::STAGE_NETWORK, 1500);
+    telemetry.recordStage(Telemetry::STAGE_NETWORK, 2500);
+    telemetry.recordStage(Telemetry::STAGE_DB, 40);
+    telemetry.recordRealTimeFactor("base", 250, 1000);
+    telemetry.recordRealTimeFactor("base", 100, 0); // No audio: ignored
+
+    EXPECT_EQ(telemetry.stageHistogram(Telemetry::STAGE_NETWORK).count(), 2u);
+    EXPECT_DOUBLE_EQ(telemetry.stageHistogram(Telemetry::STAGE_NETWORK).mean(), 2000.0);
+    EXPECT_EQ(telemetry.stageHistogram(Telemetry::STAGE_DB).percentile(0.5), 40);
+    EXPECT_EQ(telemetry.stageHistogram(Telemetry::STAGE_CAPTURE).count(), 0u);
+
+    const LatencyHistogram realTimeFactor = telemetry.realTimeFactorHistogram("base");
+    EXPECT_EQ(realTimeFactor.count(), 1u);
+    EXPECT_EQ(realTimeFactor.percentile(0.5), 250);
+
+    telemetry.reset();
+    EXPECT_EQ(telemetry.stageHistogram(Telemetry::STAGE_NETWORK).count(), 0u);
+}
+
+TEST(TelemetryTest, ExportsJson) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString path = dir.filePath("telemetry.json");
+
+    Telemetry telemetry;
+    telemetry.recordStage(Telemetry::STAGE_DECODE, 800);
+    QString error;
+    ASSERT_TRUE(telemetry.exportJson(path, &error)) << error.toStdString();
+
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    const QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+    const QJsonObject decode = json.value("stagesUs").toObject().value(Telemetry::STAGE_DECODE).toObject();
+    EXPECT_EQ(decode.value("count").toInt(), 1);
+    EXPECT_EQ(decode.value("p50").toInt(), 800);
+    EXPECT_TRUE(json.contains("startedAt"));
+    EXPECT_TRUE(json.contains("realTimeFactorPermille"));
+
+    EXPECT_FALSE(telemetry.exportJson(dir.filePath("missing/dir/telemetry.json"), &error));
+    EXPECT_FALSE(error.isEmpty());
+}
@@ -0,0 +1,111 @@
+// Unit Test for TextAnalyzer
+// Covers the single-pass counts (words, sentences, paragraphs, syllables, long
+// sentences), the issue patterns found between neighbouring words, and reading ease
+
+#include <gtest/gtest.h>
+#include <QString>
+#include <QStringList>
+
+#include "../../src/services/TextAnalyzer.h"
+
+namespace {
+
+QString words(int count) {
+    QStringList list;
+    for (int i = 0; i < count; ++i) {
+        list.append("word");
+    }
+    return list.join(' ');
+}
+
+} // namespace
+
+TEST(TextAnalyzerTest, EmptyTextHasNothingToCount) {
+    const TextAnalysis analysis = TextAnalyzer::analyze(QString());
+    EXPECT_EQ(analysis.characterCount, 0);
+    EXPECT_EQ(analysis.wordCount, 0);
+    EXPECT_EQ(analysis.sentenceCount, 0);
+    EXPECT_EQ(analysis.paragraphCount, 0);
+    EXPECT_TRUE(analysis.misspellings.isEmpty());
+    EXPECT_DOUBLE_EQ(TextAnalyzer::readingEase(analysis), 100.0);
+}
+
+TEST(TextAnalyzerTest, CountsWordsSentencesAndParagraphs) {
+    const QString text = "The cat sat on 3 mats. The dog ran!\n\nA new paragraph starts here?";
+    const TextAnalysis analysis = TextAnalyzer::analyze(text);
+    EXPECT_EQ(analysis.characterCount, text.size());
+    EXPECT_EQ(analysis.wordCount, 13); // "3" has no letter
+    EXPECT_EQ(analysis.sentenceCount, 3);
+    EXPECT_EQ(analysis.paragraphCount, 2);
+
+    // A single line break continues the paragraph; contractions are one word
+    const TextAnalysis lines = TextAnalyzer::analyze("Line one isn't done.\nLine two.\n\n\nThird.");
+    EXPECT_EQ(lines.wordCount, 7);
+    EXPECT_EQ(lines.paragraphCount, 2);
+}
+
+TEST(TextAnalyzerTest, CountsVowelGroupsAsSyllables) {
+    EXPECT_EQ(TextAnalyzer::analyze("hello").syllableCount, 2);
+    EXPECT_EQ(TextAnalyzer::analyze("make").syllableCount, 1);    // Silent final e
+    EXPECT_EQ(TextAnalyzer::analyze("table").syllableCount, 2);   // But not in "-le"
+    EXPECT_EQ(TextAnalyzer::analyze("queue").syllableCount, 1);
+    EXPECT_EQ(TextAnalyzer::analyze("rhythm").syllableCount, 1);
+    EXPECT_EQ(TextAnalyzer::analyze("beautiful day").syllableCount, 4);
+}
+
+TEST(TextAnalyzerTest, FlagsSentencesPastTheLongLimit) {
+    const int limit = TextAnalyzer::LONG_SENTENCE_WORDS;
+    EXPECT_EQ(TextAnalyzer::analyze(words(limit) + ".").longSentenceCount, 0);
+    EXPECT_EQ(TextAnalyzer::analyze(words(limit + 1) + ".").longSentenceCount, 1);
+    EXPECT_EQ(TextAnalyzer::analyze(words(limit + 1) + ". " + words(limit + 1) + "! Short.").longSentenceCount, 2);
+    // Without a closing full stop
+    EXPECT_EQ(TextAnalyzer::analyze("Short. " + words(limit + 5)).longSentenceCount, 1);
+}
+
+TEST(TextAnalyzerTest, ListsKnownMisspellingsOnceInOrder) {
+    const TextAnalysis analysis = TextAnalyzer::analyze("Teh parcel? I did recieve teh parcel, it occured to me.");
+    EXPECT_EQ(analysis.misspellings, (QStringList{"teh", "recieve", "occured"}));
+    EXPECT_EQ(TextAnalyzer::correctionFor("recieve"), "receive");
+    EXPECT_TRUE(TextAnalyzer::correctionFor("receive").isEmpty());
+    EXPECT_TRUE(TextAnalyzer::analyze("The parcel arrived.").misspellings.isEmpty());
+}
+
+TEST(TextAnalyzerTest, FindsItsOwnOnlyBetweenAdjacentWords) {
+    EXPECT_TRUE(TextAnalyzer::analyze("The team has it's own rules.").itsOwnMisuse);
+    EXPECT_TRUE(TextAnalyzer::analyze(QString::fromUtf8("The team has it’s own rules.")).itsOwnMisuse);
+    EXPECT_TRUE(TextAnalyzer::analyze("IT'S  OWN").itsOwnMisuse);
+    EXPECT_FALSE(TextAnalyzer::analyze("The team has its own rules.").itsOwnMisuse);
+    EXPECT_FALSE(TextAnalyzer::analyze("Whatever it's, own it.").itsOwnMisuse);
+    EXPECT_FALSE(TextAnalyzer::analyze("So it's. Own it.").itsOwnMisuse);
+}
+
+TEST(TextAnalyzerTest, FindsPassiveVoiceAfterWasOrWere) {
+    EXPECT_TRUE(TextAnalyzer::analyze("The report was reviewed by the board.").passiveVoice);
+    EXPECT_TRUE(TextAnalyzer::analyze("They were signed yesterday.").passiveVoice);
+    EXPECT_FALSE(TextAnalyzer::analyze("The board reviewed the report.").passiveVoice);
+    EXPECT_FALSE(TextAnalyzer::analyze("It was happy.").passiveVoice);
+    EXPECT_FALSE(TextAnalyzer::analyze("That was. Needed more.").passiveVoice);
+}
+
+TEST(TextAnalyzerTest, ReadingEaseFollowsTheFleschFormula) {
+    TextAnalysis analysis;
+    analysis.wordCount = 10;
+    analysis.sentenceCount = 2;
+    analysis.syllableCount = 15;
+    EXPECT_NEAR(TextAnalyzer::readingEase(analysis), 206.835 - 1.015 * 5.0 - 84.6 * 1.5, 1e-9);
+
+    // No sentence end counts as one sentence; the score stays within 0 to 100
+    analysis.sentenceCount = 0;
+    EXPECT_NEAR(TextAnalyzer::readingEase(analysis), 206.835 - 1.015 * 10.0 - 84.6 * 1.5, 1e-9);
+    analysis.syllableCount = 60;
+    EXPECT_DOUBLE_EQ(TextAnalyzer::readingEase(analysis), 0.0);
+    analysis.syllableCount = 10;
+    analysis.sentenceCount = 10;
+    EXPECT_DOUBLE_EQ(TextAnalyzer::readingEase(analysis), 100.0);
+
+    const double simple = TextAnalyzer::readingEase(TextAnalyzer::analyze("The cat sat. The dog ran. We had fun."));
+    const double dense = TextAnalyzer::readingEase(TextAnalyzer::analyze(
+        "Institutional considerations necessitate comprehensive organizational evaluation, "
+        "particularly regarding administrative responsibilities."));
+    EXPECT_GT(simple, dense);
+}
@@ -0,0 +1,143 @@
+// Unit Test for TextChunker
+// Covers paragraph, sentence and word breaks, the context carried between
+// chunks, and lengths counted in UTF-16 units around surrogate pairs
+
+#include <gtest/gtest.h>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <string>
+
+#include "../../src/services/TextChunker.h"
+
+namespace {
+
+QStringList textsOf(const QList<TextChunker::Chunk>& chunks) {
+    QStringList texts;
+    for (const TextChunker::Chunk& chunk : chunks) {
+        texts.append(chunk.text);
+    }
+    return texts;
+}
+
+// "Sentence number 0 is here. Sentence number 1 is here. ..."; 26 characters each
+QString sentences(int count) {
+    QStringList parts;
+    for (int i = 0; i < count; ++i) {
+        parts.append(QString("Sentence number %1 is here.").arg(i));
+    }
+    return parts.join(' ');
+}
+
+QString repeated(char32_t codePoint, int count) {
+    const std::u32string codePoints(count, codePoint);
+    return QString::fromUcs4(codePoints.data(), static_cast<qsizetype>(codePoints.size()));
+}
+
+} // namespace
+
+TEST(TextChunkerTest, ShortTextIsOneChunk) {
+    const QString text = "Just one short sentence.";
+    const QList<TextChunker::Chunk> chunks = TextChunker::split(text, 100, 200, 50);
+
+    ASSERT_EQ(chunks.size(), 1);
+    EXPECT_EQ(chunks[0].text, text);
+    EXPECT_TRUE(chunks[0].separator.isEmpty());
+    EXPECT_TRUE(chunks[0].context.isEmpty());
+    EXPECT_EQ(TextChunker::join(chunks, textsOf(chunks)), text);
+}
+
+TEST(TextChunkerTest, BlankOrEmptyTextHasNoChunks) {
+    EXPECT_TRUE(TextChunker::split(QString(), 100, 200, 50).isEmpty());
+    EXPECT_TRUE(TextChunker::split(" \n\n\t ", 100, 200, 50).isEmpty());
+}
+
+TEST(TextChunkerTest, BreaksOnSentenceEnds) {
+    const QString text = sentences(10);
+    const QList<TextChunker::Chunk> chunks = TextChunker::split(text, 60, 100, 0);
+
+    // Two 26-character sentences and their space fit in 60; a third does not
+    ASSERT_EQ(chunks.size(), 5);
+    EXPECT_EQ(chunks[0].text, "Sentence number 0 is here. Sentence number 1 is here.");
+    for (qsizetype i = 0; i < chunks.size(); ++i) {
+        EXPECT_LE(chunks[i].text.size(), 60);
+        EXPECT_TRUE(chunks[i].text.endsWith('.')) << chunks[i].text.toStdString();
+        if (i > 0) {
+            EXPECT_EQ(chunks[i].separator, " ");
+        }
+    }
+    EXPECT_EQ(TextChunker::join(chunks, textsOf(chunks)), text);
+}
+
+TEST(TextChunkerTest, ParagraphBreaksSurviveTheRewrite) {
+    const QString text = "First paragraph.\n  \nSecond paragraph.\n\nThird one.";
+    const QList<TextChunker::Chunk> chunks = TextChunker::split(text, 20, 100, 0);
+
+    ASSERT_EQ(chunks.size(), 3);
+    EXPECT_EQ(chunks[1].separator, "\n  \n");
+    EXPECT_EQ(chunks[2].separator, "\n\n");
+    EXPECT_EQ(TextChunker::join(chunks, {"ONE", "TWO", "THREE"}), "ONE\n  \nTWO\n\nTHREE");
+}
+
+TEST(TextChunkerTest, ContextIsTheLastSentencesThatFit) {
+    const QList<TextChunker::Chunk> chunks = TextChunker::split(sentences(4), 60, 100, 30);
+
+    ASSERT_EQ(chunks.size(), 2);
+    EXPECT_TRUE(chunks[0].context.isEmpty());
+    EXPECT_EQ(chunks[1].context, "Sentence number 1 is here.");
+}
+
+TEST(TextChunkerTest, RunOnSentenceIsCutBetweenWords) {
+    QStringList words;
+    for (int i = 0; i < 50; ++i) {
+        words.append(QString("word%1").arg(i));
+    }
+    const QString text = words.join(' ');
+    const QSet<QString> known(words.cbegin(), words.cend());
+
+    const QList<TextChunker::Chunk> chunks = TextChunker::split(text, 23, 23, 0);
+    ASSERT_GT(chunks.size(), 1);
+    for (const TextChunker::Chunk& chunk : chunks) {
+        EXPECT_LE(chunk.text.size(), 23);
+        for (const QString& word : chunk.text.split(' ')) {
+            EXPECT_TRUE(known.contains(word)) << "Cut inside a word: " << word.toStdString();
+        }
+    }
+    EXPECT_EQ(TextChunker::join(chunks, textsOf(chunks)), text);
+}
+
+TEST(TextChunkerTest, NeverSplitsASurrogatePair) {
+    // A single word of astral letters with no break inside, and a run of emoji that
+    // breaks after each one; both are two UTF-16 units per character
+    const QString texts[] = {repeated(U'\U0001D400', 20), repeated(U'\U0001F600', 20)};
+    for (const QString& text : texts) {
+        const QList<TextChunker::Chunk> chunks = TextChunker::split(text, 7, 7, 3);
+        ASSERT_GT(chunks.size(), 1);
+        for (const TextChunker::Chunk& chunk : chunks) {
+            ASSERT_FALSE(chunk.text.isEmpty());
+            EXPECT_LE(chunk.text.size(), 7);
+            EXPECT_FALSE(chunk.text.front().isLowSurrogate());
+            EXPECT_FALSE(chunk.text.back().isHighSurrogate());
+            EXPECT_LE(chunk.context.size(), 3);
+            if (!chunk.context.isEmpty()) {
+                EXPECT_FALSE(chunk.context.front().isLowSurrogate());
+            }
+        }
+        EXPECT_EQ(TextChunker::join(chunks, textsOf(chunks)), text);
+    }
+}
+
+TEST(TextChunkerTest, LengthsCountUtf16Units) {
+    // Each sentence is 12 characters but 13 UTF-16 units
+    const QString sentence = QString::fromUtf8("Smile \xF0\x9F\x98\x80 now.");
+    ASSERT_EQ(sentence.size(), 13);
+    const QString text = sentence + ' ' + sentence + ' ' + sentence;
+
+    // Two sentences and a space are 25 characters but 27 units, so they do not share a chunk
+    const QList<TextChunker::Chunk> chunks = TextChunker::split(text, 25, 25, 0);
+    ASSERT_EQ(chunks.size(), 3);
+    for (const TextChunker::Chunk& chunk : chunks) {
+        EXPECT_EQ(chunk.text, sentence);
+    }
+    EXPECT_EQ(TextChunker::join(chunks, textsOf(chunks)), text);
+}
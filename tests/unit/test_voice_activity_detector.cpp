@@ -0,0 +1,103 @@
+// Unit Test for VoiceActivityDetector
+// Covers frame classification and where long recordings are cut: in the middle of
+// the longest pause past the target length, on frame boundaries, within the maximum
+
+#include <gtest/gtest.h>
+#include <QList>
+#include <QPair>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+
+#include "../../src/services/VoiceActivityDetector.h"
+
+namespace {
+
+constexpr int RATE = 16000;
+constexpr int FRAME_SAMPLES = RATE * VoiceActivityDetector::FRAME_MS / 1000;
+
+qint64 samplesAt(double seconds) {
+    return static_cast<qint64>(seconds * RATE);
+}
+
+// A 1 kHz tone standing in for speech, with digital silence over each [start, end) second range
+QVector<float> speechWithPauses(double seconds, const QList<QPair<double, double>>& pauses) {
+    QVector<float> samples(samplesAt(seconds));
+    for (qint64 i = 0; i < samples.size(); ++i) {
+        samples[i] = 0.3f * static_cast<float>(std::sin(2.0 * M_PI * 1000.0 * i / RATE));
+    }
+    for (const auto& pause : pauses) {
+        std::fill(samples.begin() + samplesAt(pause.first), samples.begin() + samplesAt(pause.second), 0.0f);
+    }
+    return samples;
+}
+
+// Short 0.4 s breaths every 3 s, as between phrases, plus whatever else is given
+QList<QPair<double, double>> phrasePauses(double seconds, QList<QPair<double, double>> extra = {}) {
+    for (double start = 2.6; start + 0.4 < seconds; start += 3.0) {
+        extra.append(qMakePair(start, start + 0.4));
+    }
+    return extra;
+}
+
+} // namespace
+
+TEST(VoiceActivityDetectorTest, ClassifiesWholeFramesBySpeechEnergy) {
+    // Two frames of tone, two of silence, and a partial frame that is dropped
+    QVector<float> samples = speechWithPauses(4.0 * FRAME_SAMPLES / RATE, {});
+    std::fill(samples.begin() + 2 * FRAME_SAMPLES, samples.end(), 0.0f);
+    samples.append(QVector<float>(FRAME_SAMPLES / 2, 0.5f));
+
+    QVector<float> energy;
+    const QVector<bool> silence = VoiceActivityDetector::classifyFrames(samples, RATE, &energy);
+    ASSERT_EQ(silence.size(), 4);
+    EXPECT_EQ(silence, (QVector<bool>{false, false, true, true}));
+    EXPECT_NEAR(energy[0], 0.3f * 0.3f / 2.0f, 1e-3f); // Mean square of a sine
+    EXPECT_EQ(energy[3], 0.0f);
+}
+
+TEST(VoiceActivityDetectorTest, AudioWithinTheMaximumIsNotSplit) {
+    const QVector<float> samples = speechWithPauses(59.0, phrasePauses(59.0));
+    EXPECT_TRUE(VoiceActivityDetector::findSplitPoints(samples, RATE).isEmpty());
+    EXPECT_TRUE(VoiceActivityDetector::findSplitPoints({}, RATE).isEmpty());
+}
+
+TEST(VoiceActivityDetectorTest, CutsInTheMiddleOfTheLongestPause) {
+    // The 1.5 s pause is the longest between the 30 s target and the 60 s maximum
+    const QVector<float> samples = speechWithPauses(90.0, phrasePauses(90.0, {qMakePair(44.0, 45.5)}));
+    const QList<qint64> splits = VoiceActivityDetector::findSplitPoints(samples, RATE);
+
+    // What is left after the cut fits in one chunk
+    ASSERT_EQ(splits.size(), 1);
+    EXPECT_GT(splits[0], samplesAt(44.0));
+    EXPECT_LT(splits[0], samplesAt(45.5));
+    EXPECT_NEAR(static_cast<double>(splits[0]) / RATE, 44.75, 2.0 * VoiceActivityDetector::FRAME_MS / 1000.0);
+    EXPECT_EQ(splits[0] % FRAME_SAMPLES, 0);
+}
+
+TEST(VoiceActivityDetectorTest, PausesBeforeTheTargetAreNotUsed) {
+    // A long pause at 10 s would make a short first chunk; the later breath wins
+    const QVector<float> samples = speechWithPauses(90.0, phrasePauses(90.0, {qMakePair(10.0, 13.0)}));
+    const QList<qint64> splits = VoiceActivityDetector::findSplitPoints(samples, RATE);
+
+    ASSERT_FALSE(splits.isEmpty());
+    EXPECT_GE(splits[0], samplesAt(VoiceActivityDetector::DEFAULT_TARGET_CHUNK_MS / 1000.0));
+}
+
+TEST(VoiceActivityDetectorTest, EveryChunkStaysBetweenTheTargetAndTheMaximum) {
+    const double seconds = 300.0;
+    const QVector<float> samples = speechWithPauses(seconds, phrasePauses(seconds));
+    const QList<qint64> splits = VoiceActivityDetector::findSplitPoints(samples, RATE);
+    ASSERT_GE(splits.size(), 4);
+
+    const qint64 target = samplesAt(VoiceActivityDetector::DEFAULT_TARGET_CHUNK_MS / 1000.0);
+    const qint64 maximum = samplesAt(VoiceActivityDetector::DEFAULT_MAX_CHUNK_MS / 1000.0);
+    qint64 chunkStart = 0;
+    for (const qint64 split : splits) {
+        EXPECT_EQ(split % FRAME_SAMPLES, 0);
+        EXPECT_GE(split - chunkStart, target);
+        EXPECT_LE(split - chunkStart, maximum);
+        chunkStart = split;
+    }
+    EXPECT_LE(samples.size() - chunkStart, maximum);
+}
@@ -0,0 +1,189 @@
+// Unit Test for WaveformPeaks
+// Covers the min/max pyramid built incrementally while recording, range queries
+// at any zoom, and the BLOB encoding that keeps only level 0
+
+#include <gtest/gtest.h>
+#include <QByteArray>
+#include <QVector>
+#include <QtEndian>
+#include <cmath>
+
+#include "../../src/models/WaveformPeaks.h"
+
+namespace {
+
+constexpr int RATE = 16000;
+constexpr int BIN = RATE * WaveformPeaks::BASE_BIN_MS / 1000;
+// After magic, version, reserved, sample rate, samples per bin and sample count
+constexpr int BIN_COUNT_OFFSET = 24;
+
+// A sweep whose envelope changes from bin to bin, so merged bins are distinguishable
+QVector<float> sweep(qint64 count) {
+    QVector<float> samples(count);
+    for (qint64 i = 0; i < count; ++i) {
+        const double envelope = 0.2 + 0.7 * std::fabs(std::sin(i / 5000.0));
+        samples[i] = static_cast<float>(envelope * std::sin(2.0 * M_PI * 300.0 * i / RATE) + 0.05 * std::sin(i / 777.0));
+    }
+    return samples;
+}
+
+bool samePeaks(const QVector<WaveformPeaks::Peak>& a, const QVector<WaveformPeaks::Peak>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (int i = 0; i < a.size(); ++i) {
+        if (a[i].min != b[i].min || a[i].max != b[i].max) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool samePyramid(const WaveformPeaks& a, const WaveformPeaks& b) {
+    if (a.levelCount() != b.levelCount() || a.sampleCount() != b.sampleCount()) {
+        return false;
+    }
+    for (int level = 0; level < a.levelCount(); ++level) {
+        if (!samePeaks(a.level(level), b.level(level))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+WaveformPeaks::Peak mergedOf(const QVector<WaveformPeaks::Peak>& bins, int begin, int end) {
+    WaveformPeaks::Peak peak = bins.at(begin);
+    for (int i = begin + 1; i < end; ++i) {
+        peak.min = qMin(peak.min, bins.at(i).min);
+        peak.max = qMax(peak.max, bins.at(i).max);
+    }
+    return peak;
+}
+
+} // namespace
+
+TEST(WaveformPeaksTest, BaseBinsCoverEveryTwentyMilliseconds) {
+    QVector<float> samples(3 * BIN + 100, 0.0f);
+    samples[10] = 0.5f;
+    samples[BIN + 1] = -1.0f;
+    samples[2 * BIN + 5] = 2.0f;          // Out of range; clamped
+    samples[3 * BIN + 50] = -0.25f;       // In the partial last bin
+
+    const WaveformPeaks peaks = WaveformPeaks::fromSamples(samples, RATE);
+    ASSERT_EQ(peaks.levelCount(), WaveformPeaks::LEVEL_COUNT);
+    EXPECT_EQ(peaks.sampleCount(), samples.size());
+    EXPECT_EQ(peaks.samplesPerBin(0), BIN);
+    EXPECT_EQ(peaks.samplesPerBin(2), BIN * WaveformPeaks::LEVEL_FACTOR * WaveformPeaks::LEVEL_FACTOR);
+
+    const QVector<WaveformPeaks::Peak>& base = peaks.level(0);
+    ASSERT_EQ(base.size(), 4);
+    EXPECT_EQ(base[0].min, 0);
+    EXPECT_EQ(base[0].max, 64);
+    EXPECT_EQ(base[1].min, -127);
+    EXPECT_EQ(base[2].max, 127);
+    EXPECT_EQ(base[3].min, -32);
+    EXPECT_EQ(base[3].max, 0);
+}
+
+TEST(WaveformPeaksTest, EveryLevelMergesTheBinsBelowIt) {
+    const WaveformPeaks peaks = WaveformPeaks::fromSamples(sweep(BIN * 1000 + 7), RATE);
+    ASSERT_EQ(peaks.level(0).size(), 1001);
+
+    for (int level = 1; level < peaks.levelCount(); ++level) {
+        const QVector<WaveformPeaks::Peak>& below = peaks.level(level - 1);
+        const QVector<WaveformPeaks::Peak>& bins = peaks.level(level);
+        ASSERT_EQ(bins.size(), (below.size() + WaveformPeaks::LEVEL_FACTOR - 1) / WaveformPeaks::LEVEL_FACTOR)
+            << "level " << level;
+        for (int i = 0; i < bins.size(); ++i) {
+            const int begin = i * WaveformPeaks::LEVEL_FACTOR;
+            const int end = qMin<int>(below.size(), begin + WaveformPeaks::LEVEL_FACTOR);
+            const WaveformPeaks::Peak expected = mergedOf(below, begin, end);
+            EXPECT_EQ(bins[i].min, expected.min) << "level " << level << " bin " << i;
+            EXPECT_EQ(bins[i].max, expected.max) << "level " << level << " bin " << i;
+        }
+    }
+}
+
+TEST(WaveformPeaksTest, IncrementalChunksMatchOnePass) {
+    const QVector<float> samples = sweep(BIN * 300 + 123);
+
+    WaveformPeaks incremental;
+    incremental.reset(RATE);
+    qint64 offset = 0;
+    // Uneven buffers, as the recorder delivers them, ending mid-bin
+    for (int size = 1; offset < samples.size(); size = size * 3 % 1021 + 1) {
+        const qint64 count = qMin<qint64>(size, samples.size() - offset);
+        incremental.addSamples(samples.constData() + offset, count);
+        offset += count;
+    }
+    incremental.finish();
+
+    EXPECT_TRUE(samePyramid(incremental, WaveformPeaks::fromSamples(samples, RATE)));
+}
+
+TEST(WaveformPeaksTest, RangeQueriesKeepTheEnvelope) {
+    const QVector<float> samples = sweep(BIN * 5000);
+    const WaveformPeaks peaks = WaveformPeaks::fromSamples(samples, RATE);
+    const WaveformPeaks::Peak overall = mergedOf(peaks.level(0), 0, peaks.level(0).size());
+
+    for (const int maxBins : {1, 7, 100, 640, 5000, 20000}) {
+        const QVector<WaveformPeaks::Peak> view = peaks.peaksForRange(0, samples.size(), maxBins);
+        ASSERT_FALSE(view.isEmpty()) << maxBins << " bins";
+        EXPECT_LE(view.size(), maxBins);
+        // However far it is zoomed out, the loudest moments survive
+        const WaveformPeaks::Peak merged = mergedOf(view, 0, view.size());
+        EXPECT_EQ(merged.min, overall.min) << maxBins << " bins";
+        EXPECT_EQ(merged.max, overall.max) << maxBins << " bins";
+    }
+
+    // Enough room for every base bin: level 0 itself
+    EXPECT_TRUE(samePeaks(peaks.peaksForRange(BIN * 10, BIN * 20, 10), peaks.level(0).mid(10, 10)));
+}
+
+TEST(WaveformPeaksTest, EmptyAndOutOfRangeQueries) {
+    const WaveformPeaks peaks = WaveformPeaks::fromSamples(sweep(BIN * 10), RATE);
+    EXPECT_TRUE(peaks.peaksForRange(0, BIN * 10, 0).isEmpty());
+    EXPECT_TRUE(peaks.peaksForRange(BIN * 5, BIN * 5, 10).isEmpty());
+    EXPECT_TRUE(peaks.peaksForRange(BIN * 20, BIN * 30, 10).isEmpty());
+    EXPECT_EQ(peaks.peaksForRange(-BIN, BIN * 100, 100).size(), 10); // Clamped to the recording
+
+    EXPECT_TRUE(WaveformPeaks().isEmpty());
+    EXPECT_TRUE(WaveformPeaks().peaksForRange(0, 100, 10).isEmpty());
+}
+
+TEST(WaveformPeaksTest, BlobRoundTripsAndRebuildsTheLevels) {
+    const WaveformPeaks peaks = WaveformPeaks::fromSamples(sweep(BIN * 777 + 11), RATE);
+    const QByteArray blob = peaks.toBlob();
+    ASSERT_TRUE(WaveformPeaks::isBlob(blob));
+    EXPECT_EQ(blob.left(4), QByteArray("QSWP"));
+
+    bool ok = false;
+    const WaveformPeaks decoded = WaveformPeaks::fromBlob(blob, &ok);
+    ASSERT_TRUE(ok);
+    EXPECT_EQ(decoded.sampleRate(), RATE);
+    EXPECT_EQ(decoded.samplesPerBin(0), BIN);
+    EXPECT_TRUE(samePyramid(decoded, peaks));
+}
+
+TEST(WaveformPeaksTest, CorruptBlobIsRejected) {
+    const QByteArray blob = WaveformPeaks::fromSamples(sweep(BIN * 50), RATE).toBlob();
+
+    for (const int length : {0, 3, 8, 20, 31, static_cast<int>(blob.size()) - 1}) {
+        bool ok = true;
+        EXPECT_TRUE(WaveformPeaks::fromBlob(blob.left(length), &ok).isEmpty()) << length << " bytes";
+        EXPECT_FALSE(ok) << length << " bytes";
+    }
+
+    // A bin count larger than the data could hold
+    QByteArray inflated = blob;
+    qToLittleEndian<quint32>(0x7fffffff, inflated.data() + BIN_COUNT_OFFSET);
+    bool ok = true;
+    WaveformPeaks::fromBlob(inflated, &ok);
+    EXPECT_FALSE(ok);
+
+    QByteArray futureVersion = blob;
+    qToLittleEndian<quint16>(WaveformPeaks::BLOB_VERSION + 1, futureVersion.data() + 4);
+    ok = true;
+    WaveformPeaks::fromBlob(futureVersion, &ok);
+    EXPECT_FALSE(ok);
+}
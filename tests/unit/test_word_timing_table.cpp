@@ -0,0 +1,151 @@
+// Unit Test for WordTimingTable
+// Covers the shared string table, the versioned BLOB encoding and its rejection
+// of truncated or corrupt data, and the explicit JSON conversion
+
+#include <gtest/gtest.h>
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QtEndian>
+
+#include "../../src/models/WordTimingTable.h"
+
+namespace {
+
+WordTimingTable sampleTable() {
+    WordTimingTable table;
+    table.append("the", 0.0, 0.25, 0.9);
+    table.append("café", 0.25, 0.5, 0.75);
+    table.append("the", 0.5, 0.75, 0.5);
+    table.append(QString(), 0.75, 1.0, 0.0);
+    table.append("naïve", 1.0, 1.5, 1.0);
+    return table;
+}
+
+// Offset of the word count in the header (magic, version, reserved, string count)
+constexpr int WORD_COUNT_OFFSET = 12;
+constexpr int STRING_COUNT_OFFSET = 8;
+
+} // namespace
+
+TEST(WordTimingTableTest, RepeatedWordsShareOneString) {
+    const WordTimingTable table = sampleTable();
+    ASSERT_EQ(table.size(), 5);
+    EXPECT_EQ(table.distinctWordCount(), 4);
+
+    EXPECT_EQ(table.word(0), "the");
+    EXPECT_EQ(table.word(2), "the");
+    EXPECT_EQ(table.word(1), QString("café"));
+    EXPECT_TRUE(table.word(3).isEmpty());
+    EXPECT_DOUBLE_EQ(table.startTime(2), 0.5);
+    EXPECT_DOUBLE_EQ(table.endTime(4), 1.5);
+    EXPECT_DOUBLE_EQ(table.confidence(1), 0.75);
+
+    WordTimingTable cleared = table;
+    cleared.clear();
+    EXPECT_TRUE(cleared.isEmpty());
+    EXPECT_EQ(cleared.distinctWordCount(), 0);
+}
+
+TEST(WordTimingTableTest, BlobRoundTrips) {
+    const WordTimingTable table = sampleTable();
+    const QByteArray blob = table.toBlob();
+
+    ASSERT_TRUE(WordTimingTable::isBlob(blob));
+    EXPECT_EQ(blob.left(4), QByteArray("QSWT"));
+    EXPECT_EQ(qFromLittleEndian<quint16>(blob.constData() + 4), WordTimingTable::BLOB_VERSION);
+    EXPECT_EQ(qFromLittleEndian<quint32>(blob.constData() + STRING_COUNT_OFFSET), 4u);
+    EXPECT_EQ(qFromLittleEndian<quint32>(blob.constData() + WORD_COUNT_OFFSET), 5u);
+
+    bool ok = false;
+    const WordTimingTable decoded = WordTimingTable::fromBlob(blob, &ok);
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(decoded, table);
+    EXPECT_EQ(decoded.distinctWordCount(), table.distinctWordCount());
+
+    // The decoded string table is usable for further appends
+    WordTimingTable extended = decoded;
+    extended.append("the", 2.0, 2.5, 0.5);
+    EXPECT_EQ(extended.distinctWordCount(), 4);
+}
+
+TEST(WordTimingTableTest, EmptyTableRoundTrips) {
+    bool ok = false;
+    const WordTimingTable decoded = WordTimingTable::fromBlob(WordTimingTable().toBlob(), &ok);
+    EXPECT_TRUE(ok);
+    EXPECT_TRUE(decoded.isEmpty());
+}
+
+TEST(WordTimingTableTest, TruncatedBlobIsRejected) {
+    const QByteArray blob = sampleTable().toBlob();
+    for (int length = 0; length < blob.size(); ++length) {
+        bool ok = true;
+        const WordTimingTable decoded = WordTimingTable::fromBlob(blob.left(length), &ok);
+        EXPECT_FALSE(ok) << "accepted " << length << " of " << blob.size() << " bytes";
+        EXPECT_TRUE(decoded.isEmpty());
+    }
+}
+
+TEST(WordTimingTableTest, CorruptHeaderIsRejected) {
+    const QByteArray blob = sampleTable().toBlob();
+    bool ok = true;
+
+    EXPECT_FALSE(WordTimingTable::isBlob("[{\"word\":\"the\"}]"));
+    WordTimingTable::fromBlob("[{\"word\":\"the\"}]", &ok);
+    EXPECT_FALSE(ok);
+
+    QByteArray futureVersion = blob;
+    qToLittleEndian<quint16>(WordTimingTable::BLOB_VERSION + 1, futureVersion.data() + 4);
+    ok = true;
+    WordTimingTable::fromBlob(futureVersion, &ok);
+    EXPECT_FALSE(ok);
+
+    // Counts far beyond what the data could hold fail before anything is allocated
+    QByteArray huge = blob;
+    qToLittleEndian<quint32>(0x7fffffff, huge.data() + WORD_COUNT_OFFSET);
+    ok = true;
+    EXPECT_TRUE(WordTimingTable::fromBlob(huge, &ok).isEmpty());
+    EXPECT_FALSE(ok);
+}
+
+TEST(WordTimingTableTest, OutOfRangeStringReferenceIsRejected) {
+    WordTimingTable table;
+    table.append("only", 0.0, 1.0, 1.0);
+    QByteArray blob = table.toBlob();
+
+    // Header, then one string (u32 length + 4 bytes), then the word's string index
+    const int refOffset = 16 + 4 + 4;
+    ASSERT_EQ(qFromLittleEndian<quint32>(blob.constData() + refOffset), 0u);
+    qToLittleEndian<quint32>(1, blob.data() + refOffset);
+
+    bool ok = true;
+    EXPECT_TRUE(WordTimingTable::fromBlob(blob, &ok).isEmpty());
+    EXPECT_FALSE(ok);
+}
+
+TEST(WordTimingTableTest, JsonRoundTripsAndSkipsNonObjects) {
+    const WordTimingTable table = sampleTable();
+    const QJsonArray json = table.toJson();
+    ASSERT_EQ(json.size(), table.size());
+    EXPECT_EQ(json.at(1).toObject().value("word").toString(), QString("café"));
+    EXPECT_DOUBLE_EQ(json.at(4).toObject().value("endTime").toDouble(), 1.5);
+
+    QJsonArray withNoise = json;
+    withNoise.insert(2, QJsonValue("not a word"));
+    withNoise.append(QJsonValue(42));
+    EXPECT_EQ(WordTimingTable::fromJson(withNoise), table);
+}
+
+TEST(WordTimingTableTest, TimesAreStoredAsFloats) {
+    // The columns are f32; equality compares what was stored, not the doubles passed in
+    WordTimingTable a;
+    a.append("word", 0.1, 0.2, 0.3);
+    WordTimingTable b;
+    b.append("word", static_cast<float>(0.1), static_cast<float>(0.2), static_cast<float>(0.3));
+    EXPECT_EQ(a, b);
+    EXPECT_FLOAT_EQ(static_cast<float>(a.startTime(0)), 0.1f);
+
+    b.append("other", 0.2, 0.3, 0.4);
+    EXPECT_NE(a, b);
+}